@@ -26,6 +26,7 @@
 #include "am_zlg_ili9341_3wire_spi.h"
 #include "zlg217_regbase.h"
 #include "zlg217_clk.h"
+#include "zlg217_dma_chan.h"
 #include "am_zlg217_inst_init.h"
 
 /**
@@ -54,6 +55,7 @@ static const am_zlg_ili9341_intfc_3wire_devinfo_t __g_ili9341_intfc_devinfo = {
         ZLG217_SPI2,                             /**< \brief SPI2Ļַ */
         CLK_SPI2,                                /**< \brief SPIʱӺ */
         24000000,                                /**< \brief ٶΪ24MHz */
+        DMA_CHAN_SPI2_TX,                        /**< \brief SPI2DMAͨ */
 };
 
 /** \brief ILI9341 豸ʵ */
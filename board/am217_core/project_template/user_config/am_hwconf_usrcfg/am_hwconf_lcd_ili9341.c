@@ -27,6 +27,7 @@
 #include "am_zlg217_inst_init.h"
 #include "zlg217_periph_map.h"
 #include "zlg217_clk.h"
+#include "zlg217_dma_chan.h"
 
 /**
  * \addtogroup am_if_src_hwconf_lcd_ili9341
@@ -54,6 +55,7 @@ static const am_zlg_ili9341_intfc_3wire_devinfo_t __g_ili9341_intfc_devinfo = {
         ZLG217_SPI2,                             /**< \brief SPI2Ļַ */
         CLK_SPI2,                                /**< \brief SPIʱӺ */
         24000000,                                /**< \brief ٶΪ24MHz */
+        DMA_CHAN_SPI2_TX,                        /**< \brief SPI2DMAͨ */
 };
 
 /** \brief ILI9341 豸ʵ */
@@ -17,6 +17,13 @@
  * EP24CXX ָ볣CAT24C02CAT24C08һϵEEPROMоƬоƬ
  * 1kbit  1Mbit
  *
+ * ÿҳдͨӦѯACK pollingȴоƬڲдڽоƬ
+ * Ӧ󼴿ɼʣٹ̶ʱдʱ䡣
+ *
+ * ʹ am_ep24cxx_wbuf_init() Ϊ豸ṩһд壺Сд
+ *  RAM аҳϲʱʱ䵽 am_ep24cxx_sync() ʱҳ
+ * ҳдоƬӶдڵĴ
+ *
  * \internal
  * \par modification history:
  * - 1.00 16-08-03  tee, first implementation
@@ -34,6 +41,8 @@ extern "C" {
 #include "am_types.h"
 #include "am_i2c.h"
 #include "am_nvram.h"
+#include "am_softimer.h"
+#include "am_jobq.h"
 
 /**
  * @addtogroup am_if_ep24cxx
@@ -208,6 +217,26 @@ typedef struct am_ep24cxx_devinfo {
     
 } am_ep24cxx_devinfo_t;
  
+/**
+ * \brief дһҳĻϢ
+ */
+struct am_ep24cxx_wpage {
+    uint32_t  addr;    /**< \brief ҳʼַ0xFFFFFFFF ʾ   */
+    uint32_t  seq;     /**< \brief ţʱдҳ    */
+    uint16_t  lo;      /**< \brief ҳڴдʼƫ            */
+    uint16_t  hi;      /**< \brief ҳڴдĽƫƣ    */
+};
+
+/**
+ * \brief д RAM С
+ *
+ * \param[in] type   : оƬͺţ #AM_EP24CXX_AT24C02
+ * \param[in] npages : ɻҳ
+ */
+#define AM_EP24CXX_WBUF_SIZE_GET(type, npages)                      \
+    ((npages) * (sizeof(struct am_ep24cxx_wpage) +                  \
+                 AM_ROUND_UP(((type) & 0xFFFF), 4)))
+
 /**
  * \brief ep24cxx豸ṹ嶨
  */
@@ -221,7 +250,34 @@ typedef struct am_ep24cxx_dev {
     
     /** \brief ָ豸Ϣָ      */
     const am_ep24cxx_devinfo_t    *p_devinfo;
-    
+
+    /** \brief дҳϢΪ NULL ʱʹд */
+    struct am_ep24cxx_wpage       *p_wpage;
+
+    /** \brief д          */
+    uint8_t                       *p_wdata;
+
+    /** \brief дҳ            */
+    uint16_t                       npages;
+
+    /** \brief дддҳ    */
+    uint16_t                       ndirty;
+
+    /** \brief һ          */
+    uint32_t                       wseq;
+
+    /** \brief д嶨ʱдʱ䣨ms0 ʾʱд */
+    uint32_t                       flush_ms;
+
+    /** \brief ʱдʹõ  */
+    am_jobq_handle_t               jobq;
+
+    /** \brief ʱдʱ    */
+    am_softimer_t                  flush_timer;
+
+    /** \brief ʱд          */
+    am_jobq_job_t                  flush_job;
+
 } am_ep24cxx_dev_t;
 
 /** \brief ep24cxx  */
@@ -300,10 +356,54 @@ int am_ep24cxx_read (am_ep24cxx_handle_t handle,
                      uint8_t            *p_buf, 
                      int                 len);
                               
+/**
+ * \brief Ϊ ep24cxx 豸ṩд
+ *
+ *     ʹдam_ep24cxx_write()Լ NVRAM ׼ӿ am_nvram_set()
+ * д벻һҳʱȱдУͬһҳĶдϲΪһҳ
+ * д룻ҳֱдоƬȡʱϲдδдоƬݡ
+ *
+ *     доƬ
+ * - дҪµҳʱд绺ҳ
+ * - һҳȫ壻
+ * - һҳݻ󾭹 flush_ms 루ʱʱ䵽 jobq д룩
+ * -  am_ep24cxx_sync()  am_ep24cxx_deinit()
+ *
+ * \param[in] handle   : ep24cxx
+ * \param[in] p_buf    : дʹõ RAMӦ4ֽڶ
+ * \param[in] len      : RAM ĴС AM_EP24CXX_WBUF_SIZE_GET() õ
+ * \param[in] flush_ms : ʱдʱ䣨msΪ0ʱʱд
+ * \param[in] jobq     : ʱдʹõУΪNULLʱʱд
+ *
+ * \retval AM_OK       : óɹ
+ * \retval -AM_EINVAL  : 󣬻 RAM һҳ
+ * \retval -AM_ENOTSUP : оƬ޷ҳдʱ䣨 FRAMд
+ * \retval -AM_EPERM   : ʱģδʼ
+ *
+ * \note ʱдִУӦóҪڷжϻµ
+ *       am_jobq_process() СǰδдоƬݽʧ
+ *       ݿɿҪʱӦʵʱ am_ep24cxx_sync()
+ */
+int am_ep24cxx_wbuf_init (am_ep24cxx_handle_t  handle,
+                          uint8_t             *p_buf,
+                          size_t               len,
+                          uint32_t             flush_ms,
+                          am_jobq_handle_t     jobq);
+
+/**
+ * \brief деȫдоƬ
+ *
+ * \param[in] handle : ep24cxx
+ *
+ * \return AM_OK, дɹδʹд壩ֵдʧܡ
+ */
+int am_ep24cxx_sync (am_ep24cxx_handle_t handle);
+
 /**
  * \brief ep24cxxʼ
  *
- * ʹָep24cxx豸ʱʹøúʼ豸ͷԴ
+ * ʹָep24cxx豸ʱʹøúʼ豸ͷԴ
+ * деݻдоƬ
  *
  * \param[in] handle : ep24cxx
  *
@@ -40,7 +40,8 @@ extern "C" {
 /**
  * \brief ili9341 
  *
- * \note дд8λ16λ
+ * \note дд8λ16λСд亯Ϊ NULL
+ *       ʱ pfn_ili9341_data_u16_write() 
  */
 struct am_ili9341_drv_funcs {
 
@@ -59,6 +60,14 @@ struct am_ili9341_drv_funcs {
     /** \briefȡ16λ */
     int (*pfn_ili9341_data_u16_read)(void *p_drv, uint16_t *p_data);
 
+    /** \brief  count 16λ */
+    int (*pfn_ili9341_data_u16_write_buf)(void           *p_drv,
+                                          const uint16_t *p_buf,
+                                          uint32_t        count);
+
+    /** \brief ظ count ͬ16λ */
+    int (*pfn_ili9341_data_u16_fill)(void *p_drv, uint16_t data, uint32_t count);
+
 };
 
 /**
@@ -89,6 +98,60 @@ typedef struct am_ili9341_devinfo {
 
 }am_ili9341_devinfo_t;
 
+/**
+ * \brief ֡εʱѡ
+ *
+ * θﵽֵµλٵľκϲֵԽ
+ * ˢʱ෢͵Խ٣Խࡣ
+ */
+#ifndef AM_ILI9341_FB_DIRTY_NUM
+#define AM_ILI9341_FB_DIRTY_NUM    4
+#endif
+
+/**
+ * \brief (x0,y0)(x1,y1)ΪԽ꣬x0 <= x1y0 <= y1
+ */
+typedef struct am_ili9341_rect {
+    uint16_t x0;
+    uint16_t y0;
+    uint16_t x1;
+    uint16_t y1;
+} am_ili9341_rect_t;
+
+/**
+ * \brief ILI9341 ֲ֡
+ *
+ * ֡ӦĻϵһ򣺿ȵʱΪд棬Ҳֻ
+ * ҪƵˢµһ򣬴Сõ RAM ѡ񡣽ṹػڴ
+ * ûṩԱ am_ili9341_fb_attach() ʼûӦֱӷʡ
+ */
+typedef struct am_ili9341_fb {
+
+    /** \brief ػw * h أд */
+    uint16_t          *p_buf;
+
+    uint16_t           x;         /**< \brief ϽǵX */
+    uint16_t           y;         /**< \brief ϽǵY */
+    uint16_t           w;         /**< \brief Ŀ */
+    uint16_t           h;         /**< \brief ĸ */
+
+    /** \brief Ļݲһ¡ȴˢµ */
+    am_ili9341_rect_t  dirty[AM_ILI9341_FB_DIRTY_NUM];
+
+    /** \brief εĸ */
+    uint8_t            dirty_num;
+
+    /** \brief ǰдGRAM֡Ĺϵ */
+    uint8_t            win_mode;
+
+    /** \brief ǰдGRAM */
+    am_ili9341_rect_t  win;
+
+    uint16_t           cur_x;     /**< \brief һصX */
+    uint16_t           cur_y;     /**< \brief һصY */
+
+} am_ili9341_fb_t;
+
 /**
  * \brief ILI9341豸ṹ
  */
@@ -109,6 +172,8 @@ typedef struct am_ili9341_dev {
 
     const am_ili9341_devinfo_t *p_devinfo;  /* ָ豸Ϣָ */
 
+    am_ili9341_fb_t            *p_fb;       /* ֲ֡棬NULL ʾֱд */
+
 } am_ili9341_dev_t;
 
 typedef am_ili9341_dev_t *am_ili9341_handle_t;
@@ -244,8 +309,8 @@ int am_ili9341_draw_circle(am_ili9341_handle_t handle,
  * \param[in] y        : y
  * \param[in] num      : Ҫʾַ
  * \param[in] size     : ַС   ֵȡΪ 121624
- * \param[in] mode     : ӷʽ mode =1
- *                       ǵӷʽ mode =0
+ * \param[in] mode     : ӷʽ mode =1ַֻıʻ
+ *                       ǵӷʽ mode =0ַڵ䱳ɫ
  *
  * \retval AM_OK     : ɹ
  *         AM_EINVAL : Ч
@@ -335,6 +400,55 @@ void am_ili9341_area_draw_color(am_ili9341_handle_t handle,
                                   uint8_t *buf,uint8_t data_len,
                                   uint8_t reverse );
 
+/**
+ * \brief ʹþֲ֡
+ *
+ * ʹúȫ֡ڵĻֻд RAM¼ݸı
+ * ԭͬزˢ£Խ߽Ļֱдͬʱ
+ * ֡صĲ֡ am_ili9341_fb_flush() ıʾĻ
+ * ϣַֻһθ£ַˢ˸
+ *
+ * ֡ʼΪǰıɫһˢʱǸĻݡ
+ *
+ * \param[in] handle : ָILI9341ľ
+ * \param[in] p_fb   : ָ֡ṹָ
+ * \param[in] p_buf  : ػ w * h 
+ * \param[in] x, y   : Ͻǵ
+ * \param[in] w, h   : Ŀ͸
+ *
+ * \retval AM_OK      : ɹ
+ * \retval -AM_EINVAL : 󣬻򳬳ĻΧ
+ */
+int am_ili9341_fb_attach (am_ili9341_handle_t handle,
+                          am_ili9341_fb_t    *p_fb,
+                          uint16_t           *p_buf,
+                          uint16_t            x,
+                          uint16_t            y,
+                          uint16_t            w,
+                          uint16_t            h);
+
+/**
+ * \brief ֡иıˢµĻ
+ *
+ * ÿֻһδڣ֡ͬľһд͡
+ *
+ * \param[in] handle : ָILI9341ľ
+ *
+ * \retval AM_OK      : ɹ
+ * \retval -AM_EINVAL : 󣬻δʹ֡
+ */
+int am_ili9341_fb_flush (am_ili9341_handle_t handle);
+
+/**
+ * \brief ˢ²ֹͣʹþֲ֡棬֮Ļֱд
+ *
+ * \param[in] handle : ָILI9341ľ
+ *
+ * \retval AM_OK      : ɹ
+ * \retval -AM_EINVAL : 󣬻δʹ֡
+ */
+int am_ili9341_fb_detach (am_ili9341_handle_t handle);
+
 /**
  * \brief Ļ
  */
@@ -35,6 +35,7 @@ extern "C" {
 #include "am_spi.h"
 #include "am_gpio.h"
 #include "am_mtd.h"
+#include "am_softimer.h"
     
 /**
  * \addtogroup am_if_mx25xx
@@ -104,6 +105,14 @@ typedef struct am_mx25xx_devinfo {
  
 } am_mx25xx_devinfo_t;
      
+/**
+ * \brief 첽/ɻص
+ *
+ * \param[in] p_arg  : û
+ * \param[in] result : AM_OKɹ-AM_EIOSPIͨų
+ */
+typedef void (*am_mx25xx_async_cb_t) (void *p_arg, int result);
+
 /**
  * \brief MX25XX ʵ
  */
@@ -111,6 +120,25 @@ typedef struct am_mx25xx_dev {
     am_spi_device_t            spi_dev;        /**< \brief SPI豸              */
     uint32_t                   addr_offset;    /**< \brief ַռ  */
     const am_mx25xx_devinfo_t *p_devinfo;      /**< \brief ʵϢ            */
+
+    /* ³Ա첽/ӦóӦֱӷ */
+    am_softimer_t              poll_timer;     /**< \brief ״̬ѯʱ     */
+    am_spi_message_t           msg[2];         /**< \brief ʹõSPIϢ  */
+    am_spi_transfer_t          trans[2][2];    /**< \brief ϢеĴ       */
+    uint8_t                    cmd[4];         /**< \brief ַ         */
+    uint8_t                    stat;           /**< \brief ȡ״̬Ĵ   */
+    uint8_t                    msg_idx;        /**< \brief һʹõϢ   */
+    volatile uint8_t           async_op;       /**< \brief ǰ첽     */
+    uint8_t                    async_step;     /**< \brief 첽Ĳ     */
+    uint8_t                    async_tm;       /**< \brief ǰĺʱ */
+    const uint8_t             *p_async_buf;    /**< \brief д       */
+    uint32_t                   async_addr;     /**< \brief ׵ַ     */
+    uint32_t                   async_len;      /**< \brief ĳ       */
+    uint32_t                   async_nbytes;   /**< \brief ǰĳ */
+    uint32_t                   wait_ms;        /**< \brief ǰѵȴʱ */
+    uint32_t                   est_ms[4];      /**< \brief ĺʱ */
+    am_mx25xx_async_cb_t       pfn_async_cb;   /**< \brief ɻص       */
+    void                      *p_async_arg;    /**< \brief ص       */
 } am_mx25xx_dev_t;
 
 /** \brief  MX25XX ʵ */
@@ -133,7 +161,8 @@ am_mx25xx_handle_t am_mx25xx_init(am_mx25xx_dev_t            *p_dev,
 /**
  * \brief MX25xx MTD ܳʼ
  *
- * ʼ󣬼ʹMTD׼ӿڶ MX25xxв
+ * ʼ󣬼ʹMTD׼ӿڶ MX25xxвʹ am_mtd_erase_start()
+ * ʱ첽ɣ am_mx25xx_erase_async()
  *
  * \param[in] handle         : MX25XX 
  * \param[in] p_mtd          : ָ MTD ʵָ
@@ -203,6 +232,71 @@ int am_mx25xx_write(am_mx25xx_handle_t  handle,
                     uint8_t            *p_buf,
                     uint32_t            len);
 
+/**
+ * \brief 첽д
+ *
+ *     һأ֮SPIɻصʱص
+ * ɸҳı̡ڼ䲻ٳȡ״̬ĴǸεʵ
+ * ʱȷѯCPUSPI߿豸ȫдɺ
+ * pfn_cb
+ *
+ * \param[in] handle : MX25XX 
+ * \param[in] addr   : дݵ׵ַ
+ * \param[in] p_buf  : дݴŵĻǰ뱣Ч
+ * \param[in] len    : дĳ
+ * \param[in] pfn_cb : ɻصжеã
+ * \param[in] p_arg  : ص
+ *
+ * \retval  AM_OK     : 
+ * \retval -AM_EINVAL : 
+ * \retval -AM_EBUSY  : һ첽δ
+ * \retval -AM_EPERM  : ʱģδʼ
+ * \retval -AM_EIO    : SPIͨų
+ *
+ * \note 첽ǰд -AM_EBUSY
+ */
+int am_mx25xx_write_async(am_mx25xx_handle_t    handle,
+                          uint32_t              addr,
+                          const uint8_t        *p_buf,
+                          uint32_t              len,
+                          am_mx25xx_async_cb_t  pfn_cb,
+                          void                 *p_arg);
+
+/**
+ * \brief 첽
+ *
+ *      am_mx25xx_write_async() ƣҪ am_mx25xx_erase()
+ * ͬĺʱֱΪʮٺ룬첽ڼCPU
+ * ȴ
+ *
+ * \param[in] handle : MX25XX 
+ * \param[in] addr   : ׵ַΪĳʼַ
+ * \param[in] len    : ĳȣΪС
+ * \param[in] pfn_cb : ɻصжеã
+ * \param[in] p_arg  : ص
+ *
+ * \retval  AM_OK     : 
+ * \retval -AM_EINVAL : 
+ * \retval -AM_EBUSY  : һ첽δ
+ * \retval -AM_EPERM  : ʱģδʼ
+ * \retval -AM_EIO    : SPIͨų
+ */
+int am_mx25xx_erase_async(am_mx25xx_handle_t    handle,
+                          uint32_t              addr,
+                          uint32_t              len,
+                          am_mx25xx_async_cb_t  pfn_cb,
+                          void                 *p_arg);
+
+/**
+ * \brief жǷ첽ڽ
+ *
+ * \param[in] handle : MX25XX 
+ *
+ * \retval AM_TRUE  : 첽ڽ
+ * \retval AM_FALSE : 
+ */
+am_bool_t am_mx25xx_async_busy(am_mx25xx_handle_t handle);
+
 /**
  * \brief ȡ JEDEC ID
  *
@@ -29,6 +29,8 @@
 #include "ametal.h"
 #include "am_vdebug.h"
 #include "am_mx25xx.h"
+#include "am_wait.h"
+#include "am_int.h"
 #include <string.h>
 
 /*******************************************************************************
@@ -90,6 +92,41 @@
 
 /** @} */
 
+/** \brief ɢ/ۼдʱһ SPI Ϣݶ */
+#define __MX25XX_IOV_MAX        8
+
+/**
+ * \name 첽䲽
+ * @{
+ */
+
+#define __MX25XX_ASYNC_NONE     0      /**< \brief 첽            */
+#define __MX25XX_ASYNC_WRITE    1      /**< \brief 첽д              */
+#define __MX25XX_ASYNC_ERASE    2      /**< \brief 첽              */
+
+#define __MX25XX_STEP_POLL      0      /**< \brief ȡ״̬ȴ    */
+#define __MX25XX_STEP_WREN      1      /**< \brief ѷдʹ      */
+#define __MX25XX_STEP_CMD       2      /**< \brief ѷͱ̻  */
+
+/** @} */
+
+/**
+ * \name ĺʱest_ms[] ±꣩ʼֵֵms
+ * @{
+ */
+
+#define __MX25XX_TM_PP          0      /**< \brief ҳ                */
+#define __MX25XX_TM_SE          1      /**< \brief               */
+#define __MX25XX_TM_BE          2      /**< \brief                 */
+#define __MX25XX_TM_CE          3      /**< \brief оƬ              */
+
+#define __MX25XX_EST_PP_MS      1
+#define __MX25XX_EST_SE_MS      60
+#define __MX25XX_EST_BE_MS      700
+#define __MX25XX_EST_CE_MS      14000
+
+/** @} */
+
 /*******************************************************************************
   غ
 *******************************************************************************/
@@ -304,6 +341,10 @@ static int __mx25xx_rw (am_mx25xx_dev_t        *p_dev,
         return -AM_EINVAL;
     }
 
+    if (p_dev->async_op != __MX25XX_ASYNC_NONE) {
+        return -AM_EBUSY;
+    }
+
     /* start address beyond this chip's capacity */
     if (start > maxaddr) {
         return -AM_ENXIO;
@@ -457,6 +498,324 @@ static int __mx25xx_chip_erase (am_mx25xx_handle_t handle)
     return __mx25xx_wait_busy_and_wel(handle);
 }
 
+/******************************************************************************/
+static void __mx25xx_msg_complete (void *p_arg)
+{
+    am_wait_done((am_wait_t *)p_arg);
+}
+
+/******************************************************************************/
+
+/*
+ * ƬѡЧζȡдݶΣ
+ * ݶ __MX25XX_IOV_MAX
+ */
+static int __mx25xx_cmd_xfer (am_mx25xx_dev_t      *p_dev,
+                              const uint8_t        *p_cmd,
+                              uint32_t              cmd_len,
+                              const am_mtd_iovec_t *p_iov,
+                              int                   iovcnt,
+                              am_bool_t             is_read)
+{
+    am_spi_transfer_t trans[__MX25XX_IOV_MAX + 1];
+    am_wait_t         msg_wait;
+    am_spi_message_t  spi_msg;
+    int               i;
+
+    am_wait_init(&msg_wait);
+
+    am_spi_msg_init(&spi_msg,
+                    __mx25xx_msg_complete,
+                    (void *)&msg_wait);
+
+    am_spi_mktrans(&trans[0], p_cmd, NULL, cmd_len, 0, 0, 0, 0, 0);
+    am_spi_trans_add_tail(&spi_msg, &trans[0]);
+
+    for (i = 0; i < iovcnt; i++) {
+
+        if (is_read) {
+            am_spi_mktrans(&trans[i + 1],
+                           NULL,
+                           p_iov[i].p_buf,
+                           p_iov[i].len,
+                           0, 0, 0, 0, 0);
+        } else {
+            am_spi_mktrans(&trans[i + 1],
+                           p_iov[i].p_buf,
+                           NULL,
+                           p_iov[i].len,
+                           0, 0, 0, 0, 0);
+        }
+
+        am_spi_trans_add_tail(&spi_msg, &trans[i + 1]);
+    }
+
+    am_spi_msg_start(&(p_dev->spi_dev), &spi_msg);
+
+    am_wait_on(&msg_wait);
+
+    return spi_msg.status;
+}
+
+/******************************************************************************/
+static void __mx25xx_async_msg_done (void *p_arg);
+
+/* 첽һSPIϢcmd[]ѡ */
+static int __mx25xx_async_msg_start (am_mx25xx_dev_t *p_dev,
+                                     uint32_t         cmd_len,
+                                     const void      *p_txbuf,
+                                     void            *p_rxbuf,
+                                     uint32_t         len)
+{
+    am_spi_message_t  *p_msg   = &p_dev->msg[p_dev->msg_idx];
+    am_spi_transfer_t *p_trans =  p_dev->trans[p_dev->msg_idx];
+
+    /* ɻصһϢϢʹ */
+    p_dev->msg_idx ^= 1;
+
+    am_spi_msg_init(p_msg, __mx25xx_async_msg_done, (void *)p_dev);
+
+    am_spi_mktrans(&p_trans[0], p_dev->cmd, NULL, cmd_len, 0, 0, 0, 0, 0);
+    am_spi_trans_add_tail(p_msg, &p_trans[0]);
+
+    if (len != 0) {
+        am_spi_mktrans(&p_trans[1], p_txbuf, p_rxbuf, len, 0, 0, 0, 0, 0);
+        am_spi_trans_add_tail(p_msg, &p_trans[1]);
+    }
+
+    return am_spi_msg_start(&(p_dev->spi_dev), p_msg);
+}
+
+/******************************************************************************/
+static void __mx25xx_async_finish (am_mx25xx_dev_t *p_dev, int result)
+{
+    am_mx25xx_async_cb_t  pfn_cb = p_dev->pfn_async_cb;
+    void                 *p_arg  = p_dev->p_async_arg;
+
+    am_softimer_stop(&p_dev->poll_timer);
+
+    /* صпµ첽 */
+    p_dev->async_op = __MX25XX_ASYNC_NONE;
+
+    if (pfn_cb) {
+        pfn_cb(p_arg, result);
+    }
+}
+
+/******************************************************************************/
+
+/* ȡ״̬Ĵ */
+static int __mx25xx_async_poll (am_mx25xx_dev_t *p_dev)
+{
+    p_dev->async_step = __MX25XX_STEP_POLL;
+    p_dev->cmd[0]     = __MX25XX_CMD_RDSR;
+
+    return __mx25xx_async_msg_start(p_dev, 1, NULL, &p_dev->stat, 1);
+}
+
+/******************************************************************************/
+
+/* ͱ̻ҳ̲ҳ߽磬ʱʹÿ */
+static int __mx25xx_async_cmd (am_mx25xx_dev_t *p_dev)
+{
+    const am_mx25xx_type_t *p_type = &p_dev->p_devinfo->type;
+
+    uint32_t addr    = p_dev->async_addr;
+    uint32_t len     = p_dev->async_len;
+    uint32_t cmd_len = 4;
+    uint32_t n;
+
+    if (p_dev->async_op == __MX25XX_ASYNC_WRITE) {
+        n = __MX25XX_PAGE_SIZE_GET(*p_type);
+        n = AM_ROUND_DOWN(addr + n, n) - addr;
+        if (n > len) {
+            n = len;
+        }
+        p_dev->cmd[0]   = __MX25XX_CMD_PP;
+        p_dev->async_tm = __MX25XX_TM_PP;
+
+    } else if ((addr == 0) && (len == __MX25XX_CHIP_SIZE_GET(*p_type))) {
+        n               = len;
+        cmd_len         = 1;
+        p_dev->cmd[0]   = __MX25XX_CMD_CE;
+        p_dev->async_tm = __MX25XX_TM_CE;
+
+    } else if (((addr & (__MX25XX_BLCOK_SIZE_GET(*p_type) - 1)) == 0) &&
+               (len >= __MX25XX_BLCOK_SIZE_GET(*p_type))) {
+        n               = __MX25XX_BLCOK_SIZE_GET(*p_type);
+        p_dev->cmd[0]   = __MX25XX_CMD_BE;
+        p_dev->async_tm = __MX25XX_TM_BE;
+
+    } else {
+        n               = __MX25XX_SECTOR_SIZE_GET(*p_type);
+        p_dev->cmd[0]   = __MX25XX_CMD_SE;
+        p_dev->async_tm = __MX25XX_TM_SE;
+    }
+
+    p_dev->cmd[1]       = (addr >> 16) & 0xFF;
+    p_dev->cmd[2]       = (addr >> 8 ) & 0xFF;
+    p_dev->cmd[3]       = addr & 0xFF;
+    p_dev->async_nbytes = n;
+    p_dev->async_step   = __MX25XX_STEP_CMD;
+
+    if (p_dev->async_op == __MX25XX_ASYNC_WRITE) {
+        return __mx25xx_async_msg_start(p_dev,
+                                        cmd_len,
+                                        p_dev->p_async_buf,
+                                        NULL,
+                                        n);
+    }
+
+    return __mx25xx_async_msg_start(p_dev, cmd_len, NULL, NULL, 0);
+}
+
+/******************************************************************************/
+
+/*
+ * ȴɣ״ڹƺʱ 3/4 ѯ֮ÿƺʱ 1/16 ѯһΣ
+ * Լٲѯͬʱɺĵȴƺʱ 1/16
+ */
+static void __mx25xx_async_wait (am_mx25xx_dev_t *p_dev, am_bool_t first)
+{
+    uint32_t est = p_dev->est_ms[p_dev->async_tm];
+    uint32_t ms  = first ? (est - est / 4) : (est / 16);
+
+    if (ms == 0) {
+        ms = 1;
+    }
+
+    p_dev->async_step = __MX25XX_STEP_POLL;
+    p_dev->wait_ms   += ms;
+
+    am_softimer_start(&p_dev->poll_timer, ms);
+}
+
+/******************************************************************************/
+static void __mx25xx_poll_timer_cb (void *p_arg)
+{
+    am_mx25xx_dev_t *p_dev = (am_mx25xx_dev_t *)p_arg;
+
+    am_softimer_stop(&p_dev->poll_timer);
+
+    if (__mx25xx_async_poll(p_dev) != AM_OK) {
+        __mx25xx_async_finish(p_dev, -AM_EIO);
+    }
+}
+
+/******************************************************************************/
+
+/* 첽SPIϢɻص״̬ */
+static void __mx25xx_async_msg_done (void *p_arg)
+{
+    am_mx25xx_dev_t *p_dev = (am_mx25xx_dev_t *)p_arg;
+    uint32_t        *p_est;
+    int              ret   = AM_OK;
+
+    if (p_dev->msg[p_dev->msg_idx ^ 1].status != AM_OK) {
+        __mx25xx_async_finish(p_dev, -AM_EIO);
+        return;
+    }
+
+    switch (p_dev->async_step) {
+
+    case __MX25XX_STEP_WREN:
+        ret = __mx25xx_async_cmd(p_dev);
+        break;
+
+    case __MX25XX_STEP_CMD:
+        p_dev->wait_ms = 0;
+        __mx25xx_async_wait(p_dev, AM_TRUE);
+        break;
+
+    case __MX25XX_STEP_POLL:
+
+        /* ڱ̻ */
+        if (p_dev->stat & 0x01) {
+            __mx25xx_async_wait(p_dev, p_dev->async_nbytes == 0);
+            break;
+        }
+
+        /* ǰɣݱκʱֵ */
+        if (p_dev->async_nbytes != 0) {
+            p_est  = &p_dev->est_ms[p_dev->async_tm];
+            *p_est = (*p_est * 3 + p_dev->wait_ms + 3) / 4;
+
+            if (p_dev->async_op == __MX25XX_ASYNC_WRITE) {
+                p_dev->p_async_buf += p_dev->async_nbytes;
+            }
+            p_dev->async_addr  += p_dev->async_nbytes;
+            p_dev->async_len   -= p_dev->async_nbytes;
+            p_dev->async_nbytes = 0;
+        }
+
+        if (p_dev->async_len == 0) {
+            __mx25xx_async_finish(p_dev, AM_OK);
+            break;
+        }
+
+        p_dev->async_step = __MX25XX_STEP_WREN;
+        p_dev->cmd[0]     = __MX25XX_CMD_WREN;
+
+        ret = __mx25xx_async_msg_start(p_dev, 1, NULL, NULL, 0);
+        break;
+
+    default:
+        break;
+    }
+
+    if (ret != AM_OK) {
+        __mx25xx_async_finish(p_dev, -AM_EIO);
+    }
+}
+
+/******************************************************************************/
+static int __mx25xx_async_start (am_mx25xx_dev_t      *p_dev,
+                                 uint8_t               op,
+                                 uint32_t              addr,
+                                 const uint8_t        *p_buf,
+                                 uint32_t              len,
+                                 am_mx25xx_async_cb_t  pfn_cb,
+                                 void                 *p_arg)
+{
+    int key;
+    int ret;
+
+    key = am_int_cpu_lock();
+
+    if (p_dev->async_op != __MX25XX_ASYNC_NONE) {
+        am_int_cpu_unlock(key);
+        return -AM_EBUSY;
+    }
+    p_dev->async_op = op;
+
+    am_int_cpu_unlock(key);
+
+    ret = am_softimer_init(&p_dev->poll_timer, __mx25xx_poll_timer_cb, p_dev);
+
+    if (ret != AM_OK) {
+        p_dev->async_op = __MX25XX_ASYNC_NONE;
+        return ret;
+    }
+
+    p_dev->p_async_buf  = p_buf;
+    p_dev->async_addr   = addr;
+    p_dev->async_len    = len;
+    p_dev->async_nbytes = 0;
+    p_dev->async_tm     = (op == __MX25XX_ASYNC_WRITE) ? __MX25XX_TM_PP :
+                                                         __MX25XX_TM_SE;
+    p_dev->wait_ms      = 0;
+    p_dev->pfn_async_cb = pfn_cb;
+    p_dev->p_async_arg  = p_arg;
+
+    /* ȷУͬȴɣ */
+    if (__mx25xx_async_poll(p_dev) != AM_OK) {
+        p_dev->async_op = __MX25XX_ASYNC_NONE;
+        return -AM_EIO;
+    }
+
+    return AM_OK;
+}
+
 /*******************************************************************************
   
 *******************************************************************************/
@@ -473,6 +832,13 @@ am_mx25xx_handle_t am_mx25xx_init (am_mx25xx_dev_t           *p_dev,
     am_gpio_pin_cfg(p_devinfo->spi_cs_pin, AM_GPIO_OUTPUT_INIT_HIGH);
     
     p_dev->p_devinfo = p_devinfo;
+    p_dev->async_op  = __MX25XX_ASYNC_NONE;
+    p_dev->msg_idx   = 0;
+
+    p_dev->est_ms[__MX25XX_TM_PP] = __MX25XX_EST_PP_MS;
+    p_dev->est_ms[__MX25XX_TM_SE] = __MX25XX_EST_SE_MS;
+    p_dev->est_ms[__MX25XX_TM_BE] = __MX25XX_EST_BE_MS;
+    p_dev->est_ms[__MX25XX_TM_CE] = __MX25XX_EST_CE_MS;
 
     am_spi_mkdev(&(p_dev->spi_dev),
                  spi_handle,
@@ -526,6 +892,10 @@ int am_mx25xx_erase (am_mx25xx_handle_t  handle,
         return -AM_EINVAL;
     }
 
+    if (handle->async_op != __MX25XX_ASYNC_NONE) {
+        return -AM_EBUSY;
+    }
+
     sector_size = __MX25XX_SECTOR_SIZE_GET(handle->p_devinfo->type);
     block_size  = __MX25XX_BLCOK_SIZE_GET(handle->p_devinfo->type);
     chip_size   = __MX25XX_CHIP_SIZE_GET(handle->p_devinfo->type);
@@ -592,10 +962,96 @@ int am_mx25xx_write (am_mx25xx_handle_t  handle,
     return __mx25xx_rw(handle, addr, p_buf, len, AM_FALSE);
 }
 
+/******************************************************************************/
+int am_mx25xx_write_async (am_mx25xx_handle_t    handle,
+                           uint32_t              addr,
+                           const uint8_t        *p_buf,
+                           uint32_t              len,
+                           am_mx25xx_async_cb_t  pfn_cb,
+                           void                 *p_arg)
+{
+    uint32_t chip_size;
+
+    if ((handle == NULL) || (p_buf == NULL)) {
+        return -AM_EINVAL;
+    }
+
+    chip_size = __MX25XX_CHIP_SIZE_GET(handle->p_devinfo->type);
+
+    if ((addr > chip_size) || (len > chip_size - addr)) {
+        return -AM_EINVAL;
+    }
+
+    return __mx25xx_async_start(handle,
+                                __MX25XX_ASYNC_WRITE,
+                                addr,
+                                p_buf,
+                                len,
+                                pfn_cb,
+                                p_arg);
+}
+
+/******************************************************************************/
+int am_mx25xx_erase_async (am_mx25xx_handle_t    handle,
+                           uint32_t              addr,
+                           uint32_t              len,
+                           am_mx25xx_async_cb_t  pfn_cb,
+                           void                 *p_arg)
+{
+    uint32_t sector_size, chip_size;
+
+    if (handle == NULL) {
+        return -AM_EINVAL;
+    }
+
+    sector_size = __MX25XX_SECTOR_SIZE_GET(handle->p_devinfo->type);
+    chip_size   = __MX25XX_CHIP_SIZE_GET(handle->p_devinfo->type);
+
+    /* Start address and length must align on sector boundary */
+    if ((addr & (sector_size - 1)) || (len & (sector_size - 1))) {
+        return -AM_EINVAL;
+    }
+
+    /* Do not allow past end of device */
+    if ((addr > chip_size) || (len > chip_size - addr)) {
+        return -AM_EINVAL;
+    }
+
+    return __mx25xx_async_start(handle,
+                                __MX25XX_ASYNC_ERASE,
+                                addr,
+                                NULL,
+                                len,
+                                pfn_cb,
+                                p_arg);
+}
+
+/******************************************************************************/
+am_bool_t am_mx25xx_async_busy (am_mx25xx_handle_t handle)
+{
+    if (handle == NULL) {
+        return AM_FALSE;
+    }
+
+    return (am_bool_t)(handle->async_op != __MX25XX_ASYNC_NONE);
+}
+
 /*******************************************************************************
   ṩMTDʼӿں
 *******************************************************************************/
 
+/* 첽 */
+static void __mx25xx_mtd_erase_done (void *p_arg, int result)
+{
+    struct am_mtd_erase_info *p_info = (struct am_mtd_erase_info *)p_arg;
+
+    p_info->state = (result == AM_OK) ? AM_MTD_ERASE_DONE :
+                                        AM_MTD_ERASE_FAILED;
+
+    p_info->pfn_callback(p_info);
+}
+
+/******************************************************************************/
 static int __mx25xx_mtd_erase (void                        *p_cookie,
                                struct am_mtd_erase_info    *p_info)
 {
@@ -617,6 +1073,19 @@ static int __mx25xx_mtd_erase (void                        *p_cookie,
 
     len = p_info->len;
 
+    /* лصʱ첽ɺڻص֪ͨ */
+    if (p_info->pfn_callback) {
+        err = am_mx25xx_erase_async(p_dev,
+                                    addr,
+                                    len,
+                                    __mx25xx_mtd_erase_done,
+                                    p_info);
+        if (err != AM_OK) {
+            p_info->state = AM_MTD_ERASE_FAILED;
+        }
+        return err;
+    }
+
     err = am_mx25xx_erase(p_dev, addr, len);
 
     p_info->state = AM_MTD_ERASE_DONE;
@@ -680,12 +1149,188 @@ static int __mx25xx_mtd_write (void                 *p_cookie,
     return err;
 }
 
+/******************************************************************************/
+
+/* ɢÿ __MX25XX_IOV_MAX ݶֻһοٶ */
+static int __mx25xx_mtd_readv (void                 *p_cookie,
+                               uint32_t              addr,
+                               const am_mtd_iovec_t *p_iov,
+                               int                   iovcnt)
+{
+    am_mx25xx_dev_t *p_dev = (am_mx25xx_dev_t *)p_cookie;
+
+    uint8_t  cmd_buf[5];
+    uint32_t maxsize;
+    uint32_t len;
+    uint32_t nbytes = 0;
+    int      n;
+    int      i;
+    int      ret;
+
+    if (p_cookie == NULL || p_iov == NULL || iovcnt < 0) {
+        return -AM_EINVAL;
+    }
+
+    if (p_dev->async_op != __MX25XX_ASYNC_NONE) {
+        return -AM_EBUSY;
+    }
+
+    maxsize = __MX25XX_CHIP_SIZE_GET(p_dev->p_devinfo->type);
+    addr   += p_dev->addr_offset;
+
+    while (iovcnt > 0) {
+
+        n   = (iovcnt > __MX25XX_IOV_MAX) ? __MX25XX_IOV_MAX : iovcnt;
+        len = 0;
+        for (i = 0; i < n; i++) {
+            len += p_iov[i].len;
+        }
+
+        if ((addr > maxsize) || (len > maxsize - addr)) {
+            return -AM_ENXIO;
+        }
+
+        if (len != 0) {
+
+            cmd_buf[0] = __MX25XX_CMD_FAST_READ;
+            cmd_buf[1] = (addr >> 16) & 0xFF;
+            cmd_buf[2] = (addr >> 8 ) & 0xFF;
+            cmd_buf[3] = addr & 0xFF;
+            cmd_buf[4] = 0xFF;             /* Dummy Byte */
+
+            ret = __mx25xx_wait_busy(p_dev);
+
+            if (ret != AM_OK) {
+                return ret;
+            }
+
+            ret = __mx25xx_cmd_xfer(p_dev, cmd_buf, 5, p_iov, n, AM_TRUE);
+
+            if (ret != AM_OK) {
+                return -AM_EIO;
+            }
+        }
+
+        addr   += len;
+        nbytes += len;
+        p_iov  += n;
+        iovcnt -= n;
+    }
+
+    return nbytes;
+}
+
+/******************************************************************************/
+
+/* ۼдͬһҳڵݶһҳ̲д */
+static int __mx25xx_mtd_writev (void                 *p_cookie,
+                                uint32_t              addr,
+                                const am_mtd_iovec_t *p_iov,
+                                int                   iovcnt)
+{
+    am_mx25xx_dev_t *p_dev = (am_mx25xx_dev_t *)p_cookie;
+
+    am_mtd_iovec_t iov[__MX25XX_IOV_MAX];
+    uint8_t        cmd_buf[4];
+    uint32_t       maxsize;
+    uint32_t       page;
+    uint32_t       room;
+    uint32_t       offset = 0;    /* ǰݶдֽ */
+    uint32_t       nbytes = 0;
+    int            n;
+    int            ret;
+
+    if (p_cookie == NULL || p_iov == NULL || iovcnt < 0) {
+        return -AM_EINVAL;
+    }
+
+    if (p_dev->async_op != __MX25XX_ASYNC_NONE) {
+        return -AM_EBUSY;
+    }
+
+    maxsize = __MX25XX_CHIP_SIZE_GET(p_dev->p_devinfo->type);
+    page    = __MX25XX_PAGE_SIZE_GET(p_dev->p_devinfo->type);
+    addr   += p_dev->addr_offset;
+
+    if (addr > maxsize) {
+        return -AM_ENXIO;
+    }
+
+    while (iovcnt > 0) {
+
+        /* ռҳڵݶ */
+        room = AM_ROUND_DOWN(addr + page, page) - addr;
+        n    = 0;
+
+        while ((iovcnt > 0) && (room > 0) && (n < __MX25XX_IOV_MAX)) {
+
+            iov[n].p_buf = (uint8_t *)p_iov->p_buf + offset;
+            iov[n].len   = p_iov->len - offset;
+
+            if (iov[n].len > room) {
+                iov[n].len = room;
+            }
+
+            room   -= iov[n].len;
+            offset += iov[n].len;
+
+            if (iov[n].len != 0) {
+                n++;
+            }
+
+            if (offset == p_iov->len) {
+                offset = 0;
+                p_iov++;
+                iovcnt--;
+            }
+        }
+
+        if (n == 0) {
+            break;
+        }
+
+        room = AM_ROUND_DOWN(addr + page, page) - addr - room;
+
+        if (room > maxsize - addr) {
+            return -AM_ENXIO;
+        }
+
+        __mx25xx_wait_busy(p_dev);
+        __mx25xx_write_en(p_dev);
+        __mx25xx_wait_busy(p_dev);
+
+        cmd_buf[0] = __MX25XX_CMD_PP;
+        cmd_buf[1] = (addr >> 16) & 0xFF;
+        cmd_buf[2] = (addr >> 8 ) & 0xFF;
+        cmd_buf[3] = addr & 0xFF;
+
+        ret = __mx25xx_cmd_xfer(p_dev, cmd_buf, 4, iov, n, AM_FALSE);
+
+        if (ret != AM_OK) {
+            return -AM_EIO;
+        }
+
+        /* ȴд */
+        ret = __mx25xx_wait_busy_and_wel(p_dev);
+
+        if (ret != AM_OK) {
+            return -AM_EIO;
+        }
+
+        addr   += room;
+        nbytes += room;
+    }
+
+    return nbytes;
+}
+
 /******************************************************************************/
 static const struct am_mtd_ops __g_mtd_ops = {
     __mx25xx_mtd_erase,       /* mtd_erase */
     __mx25xx_mtd_read,        /* mtd_read */
     __mx25xx_mtd_write,       /* mtd_write */
-
+    __mx25xx_mtd_readv,       /* mtd_readv */
+    __mx25xx_mtd_writev,      /* mtd_writev */
 };
 
 am_mtd_handle_t am_mx25xx_mtd_init(am_mx25xx_handle_t  handle,
@@ -32,6 +32,21 @@
 #define __ili9341_SET_Y_CMD             0X2B      /**< \brief Y  */
 #define __ili9341_WRITE_GRAM_CMD        0X2C      /**< \brief дGRAM  */
 
+/**
+ * \brief дGRAM֡Ĺϵ
+ */
+#define __ILI9341_FB_WIN_NONE           0         /**< \brief صֱд */
+#define __ILI9341_FB_WIN_RAM            1         /**< \brief ֡ڣֻдRAM */
+#define __ILI9341_FB_WIN_THROUGH        2         /**< \brief صдRAM */
+
+/**
+ * \brief ϲʱ෢͵
+ *
+ * һδ跢 3  8 ֽݣԼ൱ 6 أ෢͵
+ * ֵʱϲԼܵĴ
+ */
+#define __ILI9341_FB_MERGE_PIXELS       6
+
 
 /**
  * \brief ili9341 LCD
@@ -65,6 +80,44 @@ static void __ili9341_data_u16_sent(am_ili9341_dev_t *p_dev, uint16_t data)
     }
 }
 
+/**
+ * \brief ili9341 LCD count ֽڵ
+ */
+static void __ili9341_data_u16_buf_sent (am_ili9341_dev_t *p_dev,
+                                         const uint16_t   *p_buf,
+                                         uint32_t          count)
+{
+    if (p_dev->p_serv->p_funcs->pfn_ili9341_data_u16_write_buf) {
+        p_dev->p_serv->p_funcs->pfn_ili9341_data_u16_write_buf(p_dev->p_serv->p_drv,
+                                                               p_buf,
+                                                               count);
+        return;
+    }
+
+    while (count--) {
+        __ili9341_data_u16_sent(p_dev, *p_buf++);
+    }
+}
+
+/**
+ * \brief ili9341 LCDظ count ֽͬ
+ */
+static void __ili9341_data_u16_fill_sent (am_ili9341_dev_t *p_dev,
+                                          uint16_t          data,
+                                          uint32_t          count)
+{
+    if (p_dev->p_serv->p_funcs->pfn_ili9341_data_u16_fill) {
+        p_dev->p_serv->p_funcs->pfn_ili9341_data_u16_fill(p_dev->p_serv->p_drv,
+                                                          data,
+                                                          count);
+        return;
+    }
+
+    while (count--) {
+        __ili9341_data_u16_sent(p_dev, data);
+    }
+}
+
 
 
 /**
@@ -101,14 +154,378 @@ static void __ili9341_window_set(am_ili9341_dev_t *p_dev,
 }
 
 /**
- * \biref 
+ * \brief ε
+ */
+am_static_inline
+int32_t __ili9341_rect_area (const am_ili9341_rect_t *p_rect)
+{
+    return (int32_t)(p_rect->x1 - p_rect->x0 + 1) * (p_rect->y1 - p_rect->y0 + 1);
+}
+
+/**
+ * \brief  p_src ϲ p_dstΪߵС
+ */
+static void __ili9341_rect_union (am_ili9341_rect_t       *p_dst,
+                                  const am_ili9341_rect_t *p_src)
+{
+    if (p_src->x0 < p_dst->x0) p_dst->x0 = p_src->x0;
+    if (p_src->y0 < p_dst->y0) p_dst->y0 = p_src->y0;
+    if (p_src->x1 > p_dst->x1) p_dst->x1 = p_src->x1;
+    if (p_src->y1 > p_dst->y1) p_dst->y1 = p_src->y1;
+}
+
+/**
+ * \brief ϲκ෢͵
  */
-static void __ili9341_draw_point (am_ili9341_handle_t handle, uint16_t x, uint16_t y)
+static int32_t __ili9341_rect_merge_cost (const am_ili9341_rect_t *p_a,
+                                          const am_ili9341_rect_t *p_b)
 {
-    __ili9341_cursor_set( handle,x,y);
-    __ili9341_cmd_sent( handle,__ili9341_WRITE_GRAM_CMD);
-    __ili9341_data_u16_sent(handle,handle->point_color);
+    am_ili9341_rect_t u     = *p_a;
+    int32_t           cost;
+    int               w, h;
+
+    __ili9341_rect_union(&u, p_b);
+    cost = __ili9341_rect_area(&u) -
+           __ili9341_rect_area(p_a) - __ili9341_rect_area(p_b);
+
+    /* صֱȥ */
+    w = min(p_a->x1, p_b->x1) - max(p_a->x0, p_b->x0) + 1;
+    h = min(p_a->y1, p_b->y1) - max(p_a->y0, p_b->y0) + 1;
+    if ((w > 0) && (h > 0)) {
+        cost += w * h;
+    }
+
+    return cost;
+}
+
+/**
+ * \brief һ
+ *
+ * еľκϲ෢͵زʱϲʱϲС
+ */
+static void __ili9341_fb_dirty_add (am_ili9341_fb_t         *p_fb,
+                                    const am_ili9341_rect_t *p_rect)
+{
+    am_ili9341_rect_t r = *p_rect;
+    int32_t           cost, best;
+    int               i, j, best_i, best_j;
+
+    /* ϲľοڣ¼ */
+    i = 0;
+    while (i < p_fb->dirty_num) {
+        if (__ili9341_rect_merge_cost(&p_fb->dirty[i], &r) <=
+                                                 __ILI9341_FB_MERGE_PIXELS) {
+            __ili9341_rect_union(&r, &p_fb->dirty[i]);
+            p_fb->dirty[i] = p_fb->dirty[--p_fb->dirty_num];
+            i = 0;
+        } else {
+            i++;
+        }
+    }
 
+    if (p_fb->dirty_num < AM_ILI9341_FB_DIRTY_NUM) {
+        p_fb->dirty[p_fb->dirty_num++] = r;
+        return;
+    }
+
+    /* j  AM_ILI9341_FB_DIRTY_NUM ʱʾ¾ */
+    best   = INT32_MAX;
+    best_i = 0;
+    best_j = AM_ILI9341_FB_DIRTY_NUM;
+    for (i = 0; i < AM_ILI9341_FB_DIRTY_NUM; i++) {
+        for (j = i + 1; j <= AM_ILI9341_FB_DIRTY_NUM; j++) {
+            cost = __ili9341_rect_merge_cost(&p_fb->dirty[i],
+                                             (j == AM_ILI9341_FB_DIRTY_NUM) ?
+                                             &r : &p_fb->dirty[j]);
+            if (cost < best) {
+                best   = cost;
+                best_i = i;
+                best_j = j;
+            }
+        }
+    }
+
+    if (best_j != AM_ILI9341_FB_DIRTY_NUM) {
+        __ili9341_rect_union(&p_fb->dirty[best_i], &p_fb->dirty[best_j]);
+        p_fb->dirty[best_j] = r;
+    } else {
+        __ili9341_rect_union(&p_fb->dirty[best_i], &r);
+    }
+
+    /* ȡϲľ¼룬ʱһпλ */
+    r = p_fb->dirty[best_i];
+    p_fb->dirty[best_i] = p_fb->dirty[--p_fb->dirty_num];
+    __ili9341_fb_dirty_add(p_fb, &r);
+}
+
+/**
+ * \brief ʼдGRAMʱȷ֡Ĺϵ
+ *
+ * \retval AM_TRUE  : ȫ֡ڣҪд
+ * \retval AM_FALSE : Ҫд
+ */
+static am_bool_t __ili9341_fb_begin (am_ili9341_dev_t *p_dev,
+                                     uint16_t x0, uint16_t y0,
+                                     uint16_t x1, uint16_t y1)
+{
+    am_ili9341_fb_t *p_fb = p_dev->p_fb;
+
+    if (NULL == p_fb) {
+        return AM_FALSE;
+    }
+
+    if ((x0 >= p_fb->x + p_fb->w) || (x1 < p_fb->x) ||
+        (y0 >= p_fb->y + p_fb->h) || (y1 < p_fb->y)) {
+        p_fb->win_mode = __ILI9341_FB_WIN_NONE;
+        return AM_FALSE;
+    }
+
+    p_fb->win.x0 = x0;
+    p_fb->win.y0 = y0;
+    p_fb->win.x1 = x1;
+    p_fb->win.y1 = y1;
+    p_fb->cur_x  = x0;
+    p_fb->cur_y  = y0;
+
+    if ((x0 >= p_fb->x) && (x1 < p_fb->x + p_fb->w) &&
+        (y0 >= p_fb->y) && (y1 < p_fb->y + p_fb->h)) {
+        p_fb->win_mode = __ILI9341_FB_WIN_RAM;
+        return AM_TRUE;
+    }
+
+    p_fb->win_mode = __ILI9341_FB_WIN_THROUGH;
+    return AM_FALSE;
+}
+
+/**
+ * \brief дGRAMڵͬд֡棬p_buf Ϊ NULL ʱд count  color
+ *
+ * ȫ֡ʱ¼ݸı
+ *
+ * \retval AM_TRUE  : ֻд֡棬Ҫд
+ * \retval AM_FALSE : Ҫд
+ */
+static am_bool_t __ili9341_fb_write (am_ili9341_dev_t *p_dev,
+                                     const uint16_t   *p_buf,
+                                     uint16_t          color,
+                                     uint32_t          count)
+{
+    am_ili9341_fb_t   *p_fb = p_dev->p_fb;
+    am_ili9341_rect_t  chg  = {0xFFFF, 0xFFFF, 0, 0};   /* ı */
+    uint16_t          *p_row;
+    uint32_t           n;
+    int                x, x0, x1;
+
+    if ((NULL == p_fb) || (__ILI9341_FB_WIN_NONE == p_fb->win_mode)) {
+        return AM_FALSE;
+    }
+
+    while (count) {
+
+        /* ڵǰʣ */
+        n = p_fb->win.x1 - p_fb->cur_x + 1;
+        if (n > count) {
+            n = count;
+        }
+
+        /* ֡صĲ */
+        x0 = max(p_fb->cur_x, p_fb->x);
+        x1 = min(p_fb->cur_x + (int)n, p_fb->x + p_fb->w) - 1;
+
+        if ((p_fb->cur_y >= p_fb->y) && (p_fb->cur_y < p_fb->y + p_fb->h)) {
+
+            p_row = &p_fb->p_buf[(uint32_t)(p_fb->cur_y - p_fb->y) * p_fb->w];
+
+            for (x = x0; x <= x1; x++) {
+                uint16_t c = p_buf ? p_buf[x - p_fb->cur_x] : color;
+
+                if (p_row[x - p_fb->x] != c) {
+                    p_row[x - p_fb->x] = c;
+                    if (x < chg.x0) chg.x0 = x;
+                    if (x > chg.x1) chg.x1 = x;
+                    if (p_fb->cur_y < chg.y0) chg.y0 = p_fb->cur_y;
+                    chg.y1 = p_fb->cur_y;
+                }
+            }
+        }
+
+        if (p_buf) {
+            p_buf += n;
+        }
+        count       -= n;
+        p_fb->cur_x += n;
+
+        /* GRAMͬдںص */
+        if (p_fb->cur_x > p_fb->win.x1) {
+            p_fb->cur_x = p_fb->win.x0;
+            if (++p_fb->cur_y > p_fb->win.y1) {
+                p_fb->cur_y = p_fb->win.y0;
+            }
+        }
+    }
+
+    if (__ILI9341_FB_WIN_RAM != p_fb->win_mode) {
+        return AM_FALSE;
+    }
+
+    if (chg.x0 <= chg.x1) {
+        __ili9341_fb_dirty_add(p_fb, &chg);
+    }
+    return AM_TRUE;
+}
+
+/**
+ * \brief ôڲʼдGRAM
+ *
+ * \note (x0,y0)(x1,y1)ΪڵĶԽ꣬x0 <= x1y0 <= y1
+ */
+static void __ili9341_area_begin (am_ili9341_dev_t *p_dev,
+                                  uint16_t x0, uint16_t y0,
+                                  uint16_t x1, uint16_t y1)
+{
+    if (__ili9341_fb_begin(p_dev, x0, y0, x1, y1)) {
+        return;
+    }
+
+    __ili9341_cmd_sent(p_dev, __ili9341_SET_X_CMD);
+    __ili9341_data_u16_sent(p_dev, x0);
+    __ili9341_data_u16_sent(p_dev, x1);
+
+    __ili9341_cmd_sent(p_dev, __ili9341_SET_Y_CMD);
+    __ili9341_data_u16_sent(p_dev, y0);
+    __ili9341_data_u16_sent(p_dev, y1);
+
+    __ili9341_cmd_sent(p_dev, __ili9341_WRITE_GRAM_CMD);
+}
+
+/**
+ * \brief  __ili9341_area_begin() õĴд count 
+ */
+static void __ili9341_area_write (am_ili9341_dev_t *p_dev,
+                                  const uint16_t   *p_buf,
+                                  uint32_t          count)
+{
+    if (!__ili9341_fb_write(p_dev, p_buf, 0, count)) {
+        __ili9341_data_u16_buf_sent(p_dev, p_buf, count);
+    }
+}
+
+/**
+ * \brief  __ili9341_area_begin() õĴд count ͬ
+ */
+static void __ili9341_area_fill (am_ili9341_dev_t *p_dev,
+                                 uint16_t          color,
+                                 uint32_t          count)
+{
+    if (!__ili9341_fb_write(p_dev, NULL, color, count)) {
+        __ili9341_data_u16_fill_sent(p_dev, color, count);
+    }
+}
+
+/**
+ * \brief 
+ */
+static void __ili9341_point_write (am_ili9341_dev_t *p_dev,
+                                   uint16_t          x,
+                                   uint16_t          y,
+                                   uint16_t          color)
+{
+    if (__ili9341_fb_begin(p_dev, x, y, x, y)) {
+        __ili9341_fb_write(p_dev, NULL, color, 1);
+        return;
+    }
+
+    __ili9341_cursor_set(p_dev, x, y);
+    __ili9341_cmd_sent(p_dev, __ili9341_WRITE_GRAM_CMD);
+    __ili9341_data_u16_sent(p_dev, color);
+}
+
+/**
+ * \brief ͬһɫֻһδ
+ */
+static void __ili9341_rect_fill (am_ili9341_dev_t *p_dev,
+                                 uint16_t x0, uint16_t y0,
+                                 uint16_t x1, uint16_t y1,
+                                 uint16_t color)
+{
+    __ili9341_area_begin(p_dev, x0, y0, x1, y1);
+    __ili9341_area_fill(p_dev,
+                        color,
+                        (uint32_t)(x1 - x0 + 1) * (y1 - y0 + 1));
+}
+
+/**
+ * \brief ˮƽֱĵ㣬ϲΪһڷ
+ */
+typedef struct __ili9341_run {
+    int x0, y0;     /**< \brief һ */
+    int x1, y1;     /**< \brief һ */
+    int len;        /**< \brief ĸ0ʾûе */
+} __ili9341_run_t;
+
+/**
+ * \brief Իɫϲĵ
+ */
+static void __ili9341_run_flush (am_ili9341_dev_t *p_dev, __ili9341_run_t *p_run)
+{
+    if (p_run->len == 0) {
+        return;
+    }
+
+    if (p_run->len == 1) {
+        __ili9341_point_write(p_dev, p_run->x0, p_run->y0, p_dev->point_color);
+    } else {
+        __ili9341_rect_fill(p_dev,
+                            p_run->x0 < p_run->x1 ? p_run->x0 : p_run->x1,
+                            p_run->y0 < p_run->y1 ? p_run->y0 : p_run->y1,
+                            p_run->x0 < p_run->x1 ? p_run->x1 : p_run->x0,
+                            p_run->y0 < p_run->y1 ? p_run->y1 : p_run->y0,
+                            p_dev->point_color);
+    }
+
+    p_run->len = 0;
+}
+
+/**
+ * \brief һ㣬һͬһʱϲȻѺϲĵ
+ */
+static void __ili9341_run_add (am_ili9341_dev_t *p_dev,
+                               __ili9341_run_t  *p_run,
+                               int               x,
+                               int               y)
+{
+    int dx = x - p_run->x1;
+    int dy = y - p_run->y1;
+
+    if (p_run->len != 0) {
+
+        /* ظĵ */
+        if ((dx == 0) && (dy == 0)) {
+            return;
+        }
+
+        /* ˮƽڣҷѺϲĵһ */
+        if ((dy == 0) && (y == p_run->y0) && ((dx == 1) || (dx == -1)) &&
+            ((p_run->len == 1) || ((p_run->x1 - p_run->x0) * dx > 0))) {
+            p_run->x1 = x;
+            p_run->len++;
+            return;
+        }
+
+        /* ֱڣҷѺϲĵһ */
+        if ((dx == 0) && (x == p_run->x0) && ((dy == 1) || (dy == -1)) &&
+            ((p_run->len == 1) || ((p_run->y1 - p_run->y0) * dy > 0))) {
+            p_run->y1 = y;
+            p_run->len++;
+            return;
+        }
+
+        __ili9341_run_flush(p_dev, p_run);
+    }
+
+    p_run->x0  = p_run->x1 = x;
+    p_run->y0  = p_run->y1 = y;
+    p_run->len = 1;
 }
 /**
  * \brief mnη
@@ -294,6 +711,7 @@ am_ili9341_handle_t am_ili9341_init(am_ili9341_dev_t                   *p_dev,
 
     p_dev->back_color  = AM_ILI9341_COLOR_WHITE;
     p_dev->point_color = AM_ILI9341_COLOR_BLACK;
+    p_dev->p_fb        = NULL;
 
 
     /* ʼGPIO */
@@ -377,24 +795,12 @@ int am_ili9341_clear (am_ili9341_handle_t handle)
     if ( NULL == handle) {
         return -AM_EINVAL;
     }
-    uint16_t i     = 0;
-    uint16_t count = 0;
-    __ili9341_window_set( handle, 0, 0, handle->width,  handle->heigh);
-    __ili9341_cmd_sent( handle,0x2c);
-
-    count = (handle->width  *  handle->heigh) / 8;
-
-    for(i = 0; i < count; i++) {
-        __ili9341_data_u16_sent(handle,handle->back_color);
-        __ili9341_data_u16_sent(handle,handle->back_color);
-        __ili9341_data_u16_sent(handle,handle->back_color);
-        __ili9341_data_u16_sent(handle,handle->back_color);
-
-        __ili9341_data_u16_sent(handle,handle->back_color);
-        __ili9341_data_u16_sent(handle,handle->back_color);
-        __ili9341_data_u16_sent(handle,handle->back_color);
-        __ili9341_data_u16_sent(handle,handle->back_color);
-    }
+    __ili9341_rect_fill(handle,
+                        0,
+                        0,
+                        handle->width - 1,
+                        handle->heigh - 1,
+                        handle->back_color);
     return AM_OK;
 }
 
@@ -417,6 +823,8 @@ int am_ili9341_draw_line(am_ili9341_handle_t handle,
     int  xerr = 0, yerr = 0, delta_x, delta_y, distance;
     int  incx, incy, uRow, uCol;
 
+    __ili9341_run_t run = {0, 0, 0, 0, 0};
+
     delta_x  = x2 - x1;
     delta_y  = y2 - y1;
     uRow     = x1;
@@ -448,7 +856,7 @@ int am_ili9341_draw_line(am_ili9341_handle_t handle,
 
     for( t=0; t <= distance + 1; t++ ) {
 
-        __ili9341_draw_point( handle, uRow, uCol);  /*  */
+        __ili9341_run_add(handle, &run, uRow, uCol);  /* 㣬ڵĵϲ */
 
         xerr += delta_x;
         yerr += delta_y;
@@ -462,6 +870,8 @@ int am_ili9341_draw_line(am_ili9341_handle_t handle,
         }
     }
 
+    __ili9341_run_flush(handle, &run);
+
    return AM_OK;
 }
 
@@ -498,19 +908,27 @@ int am_ili9341_draw_circle(am_ili9341_handle_t handle,
     }
     int a, b;
     int di;
+    int i;
+
+    /* ÿ˷Բϵĵֱϲ */
+    __ili9341_run_t run[8];
+
+    for (i = 0; i < 8; i++) {
+        run[i].len = 0;
+    }
 
     a=0;b=r;
     di=3-(r<<1);
 
     while(a<=b) {
-        __ili9341_draw_point(handle,x0+a,y0-b);             //5
-        __ili9341_draw_point(handle,x0+b,y0-a);             //0
-        __ili9341_draw_point(handle,x0+b,y0+a);             //4
-        __ili9341_draw_point(handle,x0+a,y0+b);             //6
-        __ili9341_draw_point(handle,x0-a,y0+b);             //1
-        __ili9341_draw_point(handle,x0-b,y0+a);
-        __ili9341_draw_point(handle,x0-a,y0-b);             //2
-        __ili9341_draw_point(handle,x0-b,y0-a);             //7
+        __ili9341_run_add(handle, &run[5], x0+a, y0-b);
+        __ili9341_run_add(handle, &run[0], x0+b, y0-a);
+        __ili9341_run_add(handle, &run[4], x0+b, y0+a);
+        __ili9341_run_add(handle, &run[6], x0+a, y0+b);
+        __ili9341_run_add(handle, &run[1], x0-a, y0+b);
+        __ili9341_run_add(handle, &run[3], x0-b, y0+a);
+        __ili9341_run_add(handle, &run[2], x0-a, y0-b);
+        __ili9341_run_add(handle, &run[7], x0-b, y0-a);
         a++;
 
         if( di < 0) {
@@ -520,6 +938,10 @@ int am_ili9341_draw_circle(am_ili9341_handle_t handle,
             b--;
         }
     }
+
+    for (i = 0; i < 8; i++) {
+        __ili9341_run_flush(handle, &run[i]);
+    }
     return AM_OK;
 }
 
@@ -534,51 +956,61 @@ int am_ili9341_draw_circle(am_ili9341_handle_t handle,
 int am_ili9341_show_char(am_ili9341_handle_t handle,
         uint16_t x, uint16_t y, uint8_t num, uint8_t size, uint8_t mode)
 {
-    uint8_t temp, t1, t;
-    uint16_t y0 = y;
-    uint8_t csize= (size / 8 + (( size % 8) ? 1 : 0 )) * (size / 2);
-    num=num-' ';
+    const uint8_t *p_font;
+    uint8_t  col_bytes = size / 8 + (( size % 8) ? 1 : 0 );   /* ÿеֽ */
+    uint8_t  w         = size / 2;                            /* ַ */
+    uint8_t  col, row;
+    uint16_t line[12];                                        /* һе */
+
+    __ili9341_run_t run = {0, 0, 0, 0, 0};
 
-    if ( NULL ==handle || x > handle->width  ||
-         y > handle->heigh  ) {
+    if ( NULL ==handle || x + w > handle->width  ||
+         y + size > handle->heigh || num < ' ' || num > '~') {
         return -AM_EINVAL;
     }
 
-    for(t = 0; t < csize; t++){
+    num=num-' ';
 
-        /* жС */
-        if( size == 12) {
-            temp = asc2_1206[num][t];
-        } else if (size == 16) {
-            temp=asc2_1608[num][t];
-        } else if (size == 24) {
-            temp=asc2_2412[num][t];
-        }  else return -AM_EINVAL;
+    /* жС */
+    if( size == 12) {
+        p_font = asc2_1206[num];
+    } else if (size == 16) {
+        p_font = asc2_1608[num];
+    } else if (size == 24) {
+        p_font = asc2_2412[num];
+    }  else return -AM_EINVAL;
 
-        for(t1=0;t1<8;t1++) {
-            if(temp & 0x80) {
-                __ili9341_draw_point( handle, x, y);
-            } else if(mode == 0) {
-             //   am_ili9341_point_draw_color(handle, x, y,handle->p_devinfo->back_color);
-            }
+    /* ģдţÿдϵ£λǰ */
+#define __FONT_BIT(col, row) \
+    (p_font[(col) * col_bytes + (row) / 8] & (0x80 >> ((row) % 8)))
+
+    if (mode == 0) {
+
+        /* ǵӷʽַֻһڣз */
+        __ili9341_area_begin(handle, x, y, x + w - 1, y + size - 1);
 
-            temp <<= 1;
-            y++;
-            if( y>= handle->heigh) {
-                 return -AM_EINVAL;
+        for (row = 0; row < size; row++) {
+            for (col = 0; col < w; col++) {
+                line[col] = __FONT_BIT(col, row) ? handle->point_color :
+                                                   handle->back_color;
             }
+            __ili9341_area_write(handle, line, w);
+        }
+    } else {
 
-            if((y - y0) == size) {
-                y = y0;
-                x++;
-                if( x>= handle->width ) {
-                    return -AM_EINVAL;
+        /* ӷʽÿıʻϲΪһ */
+        for (col = 0; col < w; col++) {
+            for (row = 0; row < size; row++) {
+                if (__FONT_BIT(col, row)) {
+                    __ili9341_run_add(handle, &run, x + col, y + row);
                 }
-                break;
             }
+            __ili9341_run_flush(handle, &run);
         }
-
     }
+
+#undef __FONT_BIT
+
     return AM_OK;
 }
 /**
@@ -657,9 +1089,7 @@ int am_ili9341_show_string (am_ili9341_handle_t handle,
 void am_ili9341_draw_point (am_ili9341_handle_t handle, uint16_t x, uint16_t y, uint16_t color)
 {
 
-    __ili9341_cursor_set( handle,x,y);
-    __ili9341_cmd_sent( handle,__ili9341_WRITE_GRAM_CMD);
-    __ili9341_data_u16_sent(handle,color);
+    __ili9341_point_write(handle, x, y, color);
 }
 
 /**
@@ -669,17 +1099,11 @@ void am_ili9341_color_fill(am_ili9341_handle_t handle,
         uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t color)
 {
 
-    uint16_t i,j;
-    uint16_t xlen=0;
-    xlen = x2 - x1 + 1;
-
-    for( i = y1; i <= y2; i++) {
-        __ili9341_cursor_set(handle, x1,i);
-        __ili9341_cmd_sent( handle,__ili9341_WRITE_GRAM_CMD);
-        for( j=0; j < xlen;j++) {
-            __ili9341_data_u16_sent(handle,color);
-        }
+    if ((x1 > x2) || (y1 > y2)) {
+        return;
     }
+
+    __ili9341_rect_fill(handle, x1, y1, x2, y2, color);
 }
 
 /**
@@ -692,18 +1116,17 @@ void am_ili9341_area_draw_color(am_ili9341_handle_t handle,
 {
     int8_t addr_step = 0;
     int val = 0;
+    uint32_t count = (uint32_t)(x1 - x0 + 1) * (y1 - y0 + 1);
+    uint32_t n     = 0;
+    uint16_t line[16];
 
-    /*ã */
-    __ili9341_cmd_sent( handle,__ili9341_SET_X_CMD);
-    __ili9341_data_u16_sent( handle, x0);
-    __ili9341_data_u16_sent( handle, x1);
-
-    /*Y */
-    __ili9341_cmd_sent( handle,__ili9341_SET_Y_CMD);
-    __ili9341_data_u16_sent( handle, y0);
-    __ili9341_data_u16_sent( handle, y1);
+    __ili9341_area_begin(handle, x0, y0, x1, y1);
 
-    __ili9341_cmd_sent( handle,__ili9341_WRITE_GRAM_CMD);
+    /* Ϊŵ16λɫֱ */
+    if ((data_len == 2) && (!reverse) && (((uint32_t)buf & 0x1) == 0)) {
+        __ili9341_area_write(handle, (const uint16_t *)buf, count);
+        return;
+    }
 
     /*
      * addr_step ַĽķʽصڴ
@@ -715,7 +1138,7 @@ void am_ili9341_area_draw_color(am_ili9341_handle_t handle,
         addr_step = data_len;
     }
 
-    for (int i = 0; i < (x1 - x0 + 1) * (y1 - y0 + 1); i++) {
+    for (uint32_t i = 0; i < count; i++) {
 
         switch(data_len) {
         case 1:
@@ -734,8 +1157,120 @@ void am_ili9341_area_draw_color(am_ili9341_handle_t handle,
         }
 
         buf += addr_step;
-        __ili9341_data_u16_sent(handle, val); /* ɫдȥ */
+
+        /* תɫÿһ */
+        line[n++] = (uint16_t)val;
+        if (n == AM_NELEMENTS(line)) {
+            __ili9341_area_write(handle, line, n);
+            n = 0;
+        }
+    }
+
+    if (n != 0) {
+        __ili9341_area_write(handle, line, n);
+    }
+}
+
+/**
+ * \brief ʹþֲ֡
+ */
+int am_ili9341_fb_attach (am_ili9341_handle_t handle,
+                          am_ili9341_fb_t    *p_fb,
+                          uint16_t           *p_buf,
+                          uint16_t            x,
+                          uint16_t            y,
+                          uint16_t            w,
+                          uint16_t            h)
+{
+    uint32_t i;
+
+    if ((NULL == handle) || (NULL == p_fb) || (NULL == p_buf) ||
+        (0 == w) || (0 == h) ||
+        ((uint32_t)x + w > handle->width) || ((uint32_t)y + h > handle->heigh)) {
+        return -AM_EINVAL;
+    }
+
+    for (i = 0; i < (uint32_t)w * h; i++) {
+        p_buf[i] = handle->back_color;
     }
+
+    p_fb->p_buf    = p_buf;
+    p_fb->x        = x;
+    p_fb->y        = y;
+    p_fb->w        = w;
+    p_fb->h        = h;
+    p_fb->win_mode = __ILI9341_FB_WIN_NONE;
+
+    /* Ļϸδ֪һˢʱ鸲 */
+    p_fb->dirty[0].x0 = x;
+    p_fb->dirty[0].y0 = y;
+    p_fb->dirty[0].x1 = x + w - 1;
+    p_fb->dirty[0].y1 = y + h - 1;
+    p_fb->dirty_num   = 1;
+
+    handle->p_fb = p_fb;
+
+    return AM_OK;
+}
+
+/**
+ * \brief ֡иıˢµĻ
+ */
+int am_ili9341_fb_flush (am_ili9341_handle_t handle)
+{
+    am_ili9341_fb_t         *p_fb;
+    const am_ili9341_rect_t *p_rect;
+    const uint16_t          *p_pix;
+    uint16_t                 w, h, row;
+    int                      i;
+
+    if ((NULL == handle) || (NULL == handle->p_fb)) {
+        return -AM_EINVAL;
+    }
+
+    p_fb = handle->p_fb;
+
+    for (i = 0; i < p_fb->dirty_num; i++) {
+        p_rect = &p_fb->dirty[i];
+        w      = p_rect->x1 - p_rect->x0 + 1;
+        h      = p_rect->y1 - p_rect->y0 + 1;
+        p_pix  = &p_fb->p_buf[(uint32_t)(p_rect->y0 - p_fb->y) * p_fb->w +
+                              (p_rect->x0 - p_fb->x)];
+
+        __ili9341_window_set(handle, p_rect->x0, p_rect->y0, w, h);
+        __ili9341_cmd_sent(handle, __ili9341_WRITE_GRAM_CMD);
+
+        /* ֡ȿʱڴ */
+        if (w == p_fb->w) {
+            __ili9341_data_u16_buf_sent(handle, p_pix, (uint32_t)w * h);
+            continue;
+        }
+
+        for (row = 0; row < h; row++) {
+            __ili9341_data_u16_buf_sent(handle, p_pix, w);
+            p_pix += p_fb->w;
+        }
+    }
+
+    p_fb->dirty_num = 0;
+
+    return AM_OK;
+}
+
+/**
+ * \brief ˢ²ֹͣʹþֲ֡
+ */
+int am_ili9341_fb_detach (am_ili9341_handle_t handle)
+{
+    int ret = am_ili9341_fb_flush(handle);
+
+    if (AM_OK != ret) {
+        return ret;
+    }
+
+    handle->p_fb = NULL;
+
+    return AM_OK;
 }
 
 /**
@@ -137,6 +137,8 @@ static struct am_ili9341_drv_funcs __g_ili9341_funcs = {
         __ili9341_3wire_data_u16_write,
         NULL,
         NULL,
+        NULL,
+        NULL,
 };
 
 
@@ -21,7 +21,9 @@
  */
 #include "ametal.h"
 #include "am_ep24cxx.h"
-#include "am_delay.h"
+#include "am_wait.h"
+#include "am_system.h"
+#include <string.h>
 
 /*******************************************************************************
   forward declarations
@@ -69,10 +71,66 @@ am_local am_const struct am_nvram_drv_funcs  __g_ep24cxx_nvram_drvfuncs = {
 #define __EP24CXX_TP_WRITE_TIME_GET(type) \
     AM_BITS_GET(type, 24, 8)
 
+/** \brief the write buffer page is free */
+#define __EP24CXX_WPAGE_FREE   0xFFFFFFFF
+
+/** \brief get the data of a write buffer page */
+#define __EP24CXX_WPAGE_DATA(p_dev, idx)                                  \
+    ((p_dev)->p_wdata +                                                   \
+     (idx) * AM_ROUND_UP(__EP24CXX_TP_PGSIZE_GET((p_dev)->p_devinfo->type), 4))
+
 /*******************************************************************************
     local functions
 *******************************************************************************/
 
+/* acknowledge polling message complete */
+am_local void __ep24cxx_poll_complete (void *p_arg)
+{
+    am_wait_done((am_wait_t *)p_arg);
+}
+
+/******************************************************************************/
+
+/*
+ * wait for the internal write cycle by acknowledge polling, the device
+ * doesn't acknowledge its slave address until the write cycle is completed
+ */
+am_local int __ep24cxx_ack_poll (am_ep24cxx_dev_t *p_dev, unsigned twr)
+{
+    am_i2c_transfer_t trans;
+    am_i2c_message_t  msg;
+    am_wait_t         wait;
+    uint8_t           dummy;
+    am_tick_t         start   = am_sys_tick_get();
+    am_tick_t         timeout = am_ms_to_ticks(twr + 1);
+    am_bool_t         expired;
+
+    do {
+        expired = am_sys_tick_diff(start, am_sys_tick_get()) > timeout;
+
+        /* current address read, doesn't change the data */
+        am_i2c_mktrans(&trans,
+                        p_dev->i2c_dev.dev_addr,
+                        AM_I2C_M_7BIT | AM_I2C_M_RD,
+                       &dummy,
+                        1);
+        am_i2c_mkmsg(&msg, &trans, 1, __ep24cxx_poll_complete, &wait);
+
+        am_wait_init(&wait);
+
+        if (am_i2c_msg_start(p_dev->i2c_dev.handle, &msg) == AM_OK) {
+            am_wait_on(&wait);
+            if (msg.status == AM_OK) {
+                return AM_OK;
+            }
+        }
+    } while (!expired);
+
+    return -AM_ETIMEDOUT;
+}
+
+/******************************************************************************/
+
 /* program ep24cxx */
 am_local int __ep24cxx_program_data (am_ep24cxx_dev_t        *p_dev,
                                      uint32_t                 subaddr,
@@ -120,12 +178,9 @@ am_local int __ep24cxx_program_data (am_ep24cxx_dev_t        *p_dev,
         return ret;
     }
 
-    /* waiting for program done */
-    /* todo: this delay should add a systick time ? */
+    /* waiting for program done, at most twr + 1 ms */
     if ((is_read == AM_FALSE) && (twr)) {
-        
-        /* add one ms to make sure has enough time to program */
-        am_mdelay(twr + 1);
+        return __ep24cxx_ack_poll(p_dev, twr);
     }
 
     return AM_OK;
@@ -210,6 +265,314 @@ am_local int __ep24cxx_rw (am_ep24cxx_dev_t        *p_dev,
     return ret;
 }
 
+/*******************************************************************************
+    write buffer
+*******************************************************************************/
+
+/* find the buffered page */
+am_local int __ep24cxx_wpage_find (am_ep24cxx_dev_t *p_dev, uint32_t addr)
+{
+    int i;
+
+    for (i = 0; i < p_dev->npages; i++) {
+        if (p_dev->p_wpage[i].addr == addr) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/******************************************************************************/
+
+/* release a buffered page */
+am_local void __ep24cxx_wpage_free (am_ep24cxx_dev_t *p_dev, int idx)
+{
+    p_dev->p_wpage[idx].addr = __EP24CXX_WPAGE_FREE;
+
+    if ((--p_dev->ndirty == 0) && (p_dev->jobq != NULL)) {
+        am_softimer_stop(&p_dev->flush_timer);
+    }
+}
+
+/******************************************************************************/
+
+/* write a buffered page to the device */
+am_local int __ep24cxx_wpage_flush (am_ep24cxx_dev_t *p_dev, int idx)
+{
+    struct am_ep24cxx_wpage *p_wpage = &p_dev->p_wpage[idx];
+
+    int ret;
+
+    if (p_wpage->addr == __EP24CXX_WPAGE_FREE) {
+        return AM_OK;
+    }
+
+    ret = __ep24cxx_program_data(p_dev,
+                                 p_wpage->addr + p_wpage->lo,
+                                 __EP24CXX_WPAGE_DATA(p_dev, idx) + p_wpage->lo,
+                                 p_wpage->hi - p_wpage->lo,
+                                 AM_FALSE);
+
+    /* keep the data buffered, it can be written again */
+    if (ret != AM_OK) {
+        return -AM_EIO;
+    }
+
+    __ep24cxx_wpage_free(p_dev, idx);
+
+    return AM_OK;
+}
+
+/******************************************************************************/
+
+/* allocate a page, the oldest buffered page is written if no free page */
+am_local int __ep24cxx_wpage_alloc (am_ep24cxx_dev_t *p_dev,
+                                    uint32_t          addr,
+                                    uint32_t          off,
+                                    uint32_t          len)
+{
+    struct am_ep24cxx_wpage *p_wpage = p_dev->p_wpage;
+
+    int idx    = -1;
+    int oldest = 0;
+    int ret;
+    int i;
+
+    for (i = 0; i < p_dev->npages; i++) {
+        if (p_wpage[i].addr == __EP24CXX_WPAGE_FREE) {
+            idx = i;
+            break;
+        }
+        if ((int32_t)(p_wpage[i].seq - p_wpage[oldest].seq) < 0) {
+            oldest = i;
+        }
+    }
+
+    if (idx < 0) {
+        ret = __ep24cxx_wpage_flush(p_dev, oldest);
+        if (ret != AM_OK) {
+            return ret;
+        }
+        idx = oldest;
+    }
+
+    p_wpage[idx].addr = addr;
+    p_wpage[idx].seq  = p_dev->wseq++;
+    p_wpage[idx].lo   = off;
+    p_wpage[idx].hi   = off + len;
+
+    if ((p_dev->ndirty++ == 0) && (p_dev->jobq != NULL)) {
+        am_softimer_start(&p_dev->flush_timer, p_dev->flush_ms);
+    }
+
+    return idx;
+}
+
+/******************************************************************************/
+
+/*
+ * extend the buffered area of a page to cover [off, off + len), the gap
+ * between the two areas is filled with the data in the device
+ */
+am_local int __ep24cxx_wpage_merge (am_ep24cxx_dev_t *p_dev,
+                                    int               idx,
+                                    uint32_t          off,
+                                    uint32_t          len)
+{
+    struct am_ep24cxx_wpage *p_wpage = &p_dev->p_wpage[idx];
+
+    uint8_t *p_data = __EP24CXX_WPAGE_DATA(p_dev, idx);
+    int      ret;
+
+    if (off > p_wpage->hi) {
+        ret = __ep24cxx_program_data(p_dev,
+                                     p_wpage->addr + p_wpage->hi,
+                                     p_data + p_wpage->hi,
+                                     off - p_wpage->hi,
+                                     AM_TRUE);
+        if (ret != AM_OK) {
+            return -AM_EIO;
+        }
+    }
+
+    if (off + len < p_wpage->lo) {
+        ret = __ep24cxx_program_data(p_dev,
+                                     p_wpage->addr + off + len,
+                                     p_data + off + len,
+                                     p_wpage->lo - (off + len),
+                                     AM_TRUE);
+        if (ret != AM_OK) {
+            return -AM_EIO;
+        }
+    }
+
+    if (off < p_wpage->lo) {
+        p_wpage->lo = off;
+    }
+    if (off + len > p_wpage->hi) {
+        p_wpage->hi = off + len;
+    }
+
+    return AM_OK;
+}
+
+/******************************************************************************/
+
+/* write through the write buffer */
+am_local int __ep24cxx_wbuf_write (am_ep24cxx_dev_t *p_dev,
+                                   int               start,
+                                   uint8_t          *p_buf,
+                                   size_t            len)
+{
+    uint32_t type    = p_dev->p_devinfo->type;
+    uint32_t maxsize = __EP24CXX_TP_MAXSIZE_GET(type);
+    uint32_t page    = __EP24CXX_TP_PGSIZE_GET(type);
+    uint32_t addr;
+    uint32_t off;
+    uint32_t n;
+    int      idx;
+    int      ret;
+
+    /* start address beyond this eeprom's capacity */
+    if ((uint32_t)start >= maxsize) {
+        return -AM_ENXIO;
+    }
+
+    /* adjust len that will not beyond eeprom's capacity */
+    if ((start + len) > maxsize) {
+        len = maxsize - start;
+    }
+
+    while (len) {
+        addr = AM_ROUND_DOWN((uint32_t)start, page);
+        off  = start - addr;
+        n    = page - off;
+        if (n > len) {
+            n = len;
+        }
+
+        idx = __ep24cxx_wpage_find(p_dev, addr);
+
+        if (n == page) {
+
+            /* a whole page, write it directly, the buffered data is stale */
+            if (idx >= 0) {
+                __ep24cxx_wpage_free(p_dev, idx);
+            }
+
+            ret = __ep24cxx_program_data(p_dev, start, p_buf, n, AM_FALSE);
+            if (ret != AM_OK) {
+                return -AM_EIO;
+            }
+
+        } else {
+
+            if (idx < 0) {
+                idx = __ep24cxx_wpage_alloc(p_dev, addr, off, n);
+                if (idx < 0) {
+                    return idx;
+                }
+            } else {
+                ret = __ep24cxx_wpage_merge(p_dev, idx, off, n);
+                if (ret != AM_OK) {
+                    return ret;
+                }
+            }
+
+            memcpy(__EP24CXX_WPAGE_DATA(p_dev, idx) + off, p_buf, n);
+
+            /* the whole page is buffered, no more to merge */
+            if ((p_dev->p_wpage[idx].lo == 0) &&
+                (p_dev->p_wpage[idx].hi == page)) {
+                ret = __ep24cxx_wpage_flush(p_dev, idx);
+                if (ret != AM_OK) {
+                    return ret;
+                }
+            }
+        }
+
+        len   -= n;
+        start += n;
+        p_buf += n;
+    }
+
+    return AM_OK;
+}
+
+/******************************************************************************/
+
+/* read the device, and then update with the data in the write buffer */
+am_local int __ep24cxx_wbuf_read (am_ep24cxx_dev_t *p_dev,
+                                  int               start,
+                                  uint8_t          *p_buf,
+                                  size_t            len)
+{
+    struct am_ep24cxx_wpage *p_wpage;
+
+    uint32_t begin;
+    uint32_t end;
+    int      ret;
+    int      i;
+
+    ret = __ep24cxx_rw(p_dev, start, p_buf, len, AM_TRUE);
+
+    if ((ret != AM_OK) || (p_dev->ndirty == 0)) {
+        return ret;
+    }
+
+    for (i = 0; i < p_dev->npages; i++) {
+
+        p_wpage = &p_dev->p_wpage[i];
+
+        if (p_wpage->addr == __EP24CXX_WPAGE_FREE) {
+            continue;
+        }
+
+        begin = p_wpage->addr + p_wpage->lo;
+        end   = p_wpage->addr + p_wpage->hi;
+
+        if (begin < (uint32_t)start) {
+            begin = start;
+        }
+        if (end > start + len) {
+            end = start + len;
+        }
+
+        if (begin < end) {
+            memcpy(p_buf + (begin - start),
+                   __EP24CXX_WPAGE_DATA(p_dev, i) + (begin - p_wpage->addr),
+                   end - begin);
+        }
+    }
+
+    return AM_OK;
+}
+
+/******************************************************************************/
+
+/* write the buffer in job queue */
+am_local void __ep24cxx_flush_job (void *p_arg)
+{
+    am_ep24cxx_dev_t *p_dev = (am_ep24cxx_dev_t *)p_arg;
+
+    /* failed, try again later */
+    if ((am_ep24cxx_sync(p_dev) != AM_OK) && (p_dev->ndirty != 0)) {
+        am_softimer_start(&p_dev->flush_timer, p_dev->flush_ms);
+    }
+}
+
+/******************************************************************************/
+
+/* flush timer callback, the writing is deferred to the job queue */
+am_local void __ep24cxx_flush_timer_cb (void *p_arg)
+{
+    am_ep24cxx_dev_t *p_dev = (am_ep24cxx_dev_t *)p_arg;
+
+    am_softimer_stop(&p_dev->flush_timer);
+    am_jobq_post(p_dev->jobq, &p_dev->flush_job);
+}
+
 /*******************************************************************************
     standard nvram driver functions
 *******************************************************************************/
@@ -259,6 +622,11 @@ am_ep24cxx_handle_t am_ep24cxx_init (am_ep24cxx_dev_t           *p_dev,
  
     p_dev->p_devinfo = p_devinfo;
     p_dev->p_serv    = NULL;
+    p_dev->p_wpage   = NULL;
+    p_dev->p_wdata   = NULL;
+    p_dev->npages    = 0;
+    p_dev->ndirty    = 0;
+    p_dev->jobq      = NULL;
  
     return p_dev;
 }
@@ -268,6 +636,19 @@ am_ep24cxx_handle_t am_ep24cxx_init (am_ep24cxx_dev_t           *p_dev,
 /* ep24cxx deinit  */
 int am_ep24cxx_deinit (am_ep24cxx_handle_t handle)
 {
+    int ret = am_ep24cxx_sync(handle);
+
+    if (ret != AM_OK) {
+        return ret;
+    }
+
+    if (handle->jobq != NULL) {
+        am_softimer_stop(&handle->flush_timer);
+    }
+
+    handle->p_wpage = NULL;
+    handle->npages  = 0;
+
     if (handle->p_serv != NULL) {
         am_nvram_dev_unregister(handle->p_serv);
     }
@@ -283,6 +664,10 @@ int am_ep24cxx_read (am_ep24cxx_handle_t  handle,
                      uint8_t             *p_buf, 
                      int                  len)
 {    
+    if ((handle != NULL) && (handle->p_wpage != NULL)) {
+        return __ep24cxx_wbuf_read(handle, start_addr, p_buf, len);
+    }
+
     return __ep24cxx_rw(handle,
                         start_addr,
                         p_buf,
@@ -297,6 +682,10 @@ int am_ep24cxx_write (am_ep24cxx_handle_t handle,
                       uint8_t            *p_buf, 
                       int                 len)
 {
+    if ((handle != NULL) && (handle->p_wpage != NULL)) {
+        return __ep24cxx_wbuf_write(handle, start_addr, p_buf, len);
+    }
+
     return __ep24cxx_rw(handle,
                         start_addr,
                         p_buf,
@@ -304,6 +693,94 @@ int am_ep24cxx_write (am_ep24cxx_handle_t handle,
                         AM_FALSE);
 }
 
+/******************************************************************************/
+int am_ep24cxx_wbuf_init (am_ep24cxx_handle_t  handle,
+                          uint8_t             *p_buf,
+                          size_t               len,
+                          uint32_t             flush_ms,
+                          am_jobq_handle_t     jobq)
+{
+    uint32_t type;
+    uint32_t npages;
+    int      ret;
+    int      i;
+
+    if ((handle == NULL) || (p_buf == NULL)) {
+        return -AM_EINVAL;
+    }
+
+    type = handle->p_devinfo->type;
+
+    if ((__EP24CXX_TP_PGSIZE_GET(type) == 0) ||
+        (__EP24CXX_TP_WRITE_TIME_GET(type) == 0)) {
+        return -AM_ENOTSUP;
+    }
+
+    npages = len / AM_EP24CXX_WBUF_SIZE_GET(type, 1);
+    if (npages == 0) {
+        return -AM_EINVAL;
+    }
+    if (npages > 0xFFFF) {
+        npages = 0xFFFF;
+    }
+
+    /* write the data buffered before */
+    ret = am_ep24cxx_sync(handle);
+    if (ret != AM_OK) {
+        return ret;
+    }
+
+    if ((jobq != NULL) && (flush_ms != 0)) {
+        ret = am_softimer_init(&handle->flush_timer,
+                                __ep24cxx_flush_timer_cb,
+                               (void *)handle);
+        if (ret != AM_OK) {
+            return ret;
+        }
+        am_jobq_job_init(&handle->flush_job,
+                          __ep24cxx_flush_job,
+                         (void *)handle,
+                          0);
+    } else {
+        jobq = NULL;
+    }
+
+    handle->p_wpage  = (struct am_ep24cxx_wpage *)p_buf;
+    handle->p_wdata  = p_buf + npages * sizeof(struct am_ep24cxx_wpage);
+    handle->npages   = npages;
+    handle->ndirty   = 0;
+    handle->wseq     = 0;
+    handle->flush_ms = flush_ms;
+    handle->jobq     = jobq;
+
+    for (i = 0; i < npages; i++) {
+        handle->p_wpage[i].addr = __EP24CXX_WPAGE_FREE;
+    }
+
+    return AM_OK;
+}
+
+/******************************************************************************/
+int am_ep24cxx_sync (am_ep24cxx_handle_t handle)
+{
+    int err = AM_OK;
+    int ret;
+    int i;
+
+    if (handle == NULL) {
+        return -AM_EINVAL;
+    }
+
+    for (i = 0; i < handle->npages; i++) {
+        ret = __ep24cxx_wpage_flush(handle, i);
+        if (ret != AM_OK) {
+            err = ret;
+        }
+    }
+
+    return err;
+}
+
 /******************************************************************************/
 
 /* provide standard nvram service for system */
@@ -419,7 +419,8 @@ am_local am_err_t __pfn_data_get (void            *p_drv,
 
     uint8_t status_val = 0;
 
-    uint8_t reg_data[2] = {0};
+    uint8_t reg_data[4] = {0};
+    uint8_t *p_tem_data = reg_data + 2;
 
     int16_t hum_data = 0;
     int16_t tem_data = 0;
@@ -461,6 +462,12 @@ am_local am_err_t __pfn_data_get (void            *p_drv,
     } while (__HTS221_GET_HUM_STATUS(status_val) != 0x1 ||
              __HTS221_GET_TEM_STATUS(status_val) != 0x1 );
 
+    /* ʪ¶ݼĴַһͻȡȫͨߴ */
+    ret = __hts221_read(p_this, __HTS221_REG_H_OUT_L, reg_data, 4);
+    if (ret != AM_OK) {
+        return ret;
+    }
+
     for (i = 0; i < num; i++) {
 
         cur_id = p_ids[i];
@@ -468,10 +475,6 @@ am_local am_err_t __pfn_data_get (void            *p_drv,
         if (cur_id == 0) {
 
             /** \brief ȡʪ*/
-            ret = __hts221_read(p_this, __HTS221_REG_H_OUT_L, reg_data, 2);
-            if (ret != AM_OK) {
-                return ret;
-            }
             hum_data = __HTS221_UINT8_TO_UINT16(reg_data);
             p_buf[i].val  = __GET_VALUE(hum_data,
                                         hum->x0,
@@ -483,11 +486,7 @@ am_local am_err_t __pfn_data_get (void            *p_drv,
         } else if (cur_id == 1) {
 
             /** \brief ȡ¶ */
-            ret = __hts221_read(p_this, __HTS221_REG_T_OUT_L, reg_data, 2);
-            if (ret != AM_OK) {
-                return ret;
-            }
-            tem_data = __HTS221_UINT8_TO_UINT16(reg_data);
+            tem_data = __HTS221_UINT8_TO_UINT16(p_tem_data);
             p_buf[i].val  = __GET_VALUE(tem_data,
                                         tem->x0,
                                         tem->y0,
@@ -119,16 +119,11 @@ am_local am_bool_t am_zm516x_send_cmd (am_uart_rngbuf_handle_t  rngbuf_handle,
     uint16_t  i;
     int32_t   len   = 0;
     int32_t   index = 0;
-    int32_t   key;
     am_bool_t flag  = AM_FALSE;
 
     am_uart_rngbuf_send(rngbuf_handle, p_cmd, cmd_len);
 
-    key = am_int_cpu_lock();
-
-    am_rngbuf_flush(&rngbuf_handle->rx_rngbuf);
-
-    am_int_cpu_unlock(key);
+    am_uart_rngbuf_ioctl(rngbuf_handle, AM_UART_RNGBUF_RFLUSH, NULL);
 
     if (p_rsp == NULL) {
         return AM_TRUE;   /* Ӧ޷ֱֵӷ AM_TRUE */
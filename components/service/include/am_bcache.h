@@ -0,0 +1,226 @@
+/*******************************************************************************
+*                                 AMetal
+*                       ----------------------------
+*                       innovating embedded platform
+*
+* Copyright (c) 2001-2018 Guangzhou ZHIYUAN Electronics Co., Ltd.
+* All rights reserved.
+*
+* Contact information:
+* web site:    http://www.zlg.cn/
+*******************************************************************************/
+/**
+ * \file
+ * \brief 洢棨黺棩
+ *
+ *     黺Թ̶СĿ飨һΪҳСΪλ洢еݣ
+ * ʹ LRU 㷨滻ظȡͬһʱٷ⵽˳
+ * ȡʱδеĿͬɿ飨Ԥͨһ
+ *
+ *     ֻݣдͲֱʹǵĻ
+ * ʧЧеʼµġ
+ *
+ *     黺Ե MTD 豸֮ϣõһµ MTD 豸繩 FTL ʹã
+ * ҲԵ NVRAM 洢豸֮ϣעΪһµ NVRAM 洢豸
+ *
+ * \par ʾEEPROM
+ * \code
+ * static am_nvram_dev_t   g_ep24c02_raw;
+ * static am_nvram_dev_t   g_ep24c02_cached;
+ * static am_bcache_t      g_cache;
+ * static uint8_t          g_cache_buf[AM_BCACHE_RAM_SIZE_GET(8, 8)];
+ * static const am_bcache_info_t g_cache_info = {
+ *     g_cache_buf, sizeof(g_cache_buf), 8, 2
+ * };
+ *
+ * am_ep24cxx_nvram_init(ep24cxx_handle, &g_ep24c02_raw, "ep24c02_raw");
+ * am_bcache_nvram_init(&g_cache,
+ *                      &g_cache_info,
+ *                      &g_ep24c02_raw,
+ *                       256,
+ *                      &g_ep24c02_cached,
+ *                      "ep24c02");        // 洢ʹø豸
+ * \endcode
+ *
+ * \internal
+ * \par Modification history
+ * - 1.00 26-10-18  agent, first implementation.
+ * \endinternal
+ */
+#ifndef __AM_BCACHE_H
+#define __AM_BCACHE_H
+
+#include "ametal.h"
+#include "am_mtd.h"
+#include "am_nvram.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \addtogroup am_if_bcache
+ * \copydoc am_bcache.h
+ * @{
+ */
+
+/**
+ * \brief ĿϢ
+ */
+struct am_bcache_entry {
+    uint32_t  blk;         /**< \brief ĿţλΪԤ־  */
+    uint16_t  prev;        /**< \brief LRU нµһ            */
+    uint16_t  next;        /**< \brief LRU нϾɵһ            */
+};
+
+/**
+ * \brief 黺Ҫʹõڴ棨RAMռС
+ *
+ * \param[in] nblks    : ĸ 655340xFFFF ־
+ * \param[in] blk_size : ĴС
+ *
+ * \return 黺Ҫʹõڴ棨RAMռС
+ */
+#define AM_BCACHE_RAM_SIZE_GET(nblks, blk_size) \
+    ((nblks) * (sizeof(struct am_bcache_entry) + AM_ROUND_UP((blk_size), 4)))
+
+/**
+ * \brief 黺ʵϢ
+ */
+typedef struct am_bcache_info {
+
+    /** \brief RAM  4 ֽڶ */
+    uint8_t  *p_buf;
+
+    /**
+     * \brief RAM ĳȣΪ
+     * len / AM_BCACHE_RAM_SIZE_GET(1, blk_size)
+     */
+    size_t    len;
+
+    /** \brief ĴСһҳС */
+    uint32_t  blk_size;
+
+    /**
+     * \brief ˳ȡʱԤĿΪ0ʱԤ
+     *
+     * ԤĿһ
+     */
+    uint32_t  ra_blks;
+
+} am_bcache_info_t;
+
+/**
+ * \brief 黺ͳϢ
+ */
+typedef struct am_bcache_stat {
+    uint32_t  hits;        /**< \brief еĿ                       */
+    uint32_t  misses;      /**< \brief δеĿ                     */
+    uint32_t  dev_reads;   /**< \brief ƹĶ */
+    uint32_t  ra_blks;     /**< \brief ԤĿ                       */
+    uint32_t  ra_hits;     /**< \brief ԤеĿ               */
+    uint32_t  invalidates; /**< \brief дʧЧĿ           */
+} am_bcache_stat_t;
+
+/**
+ * \brief 黺ʵӦóӦֱӲṹԱ
+ */
+typedef struct am_bcache {
+
+    const am_bcache_info_t   *p_info;     /**< \brief ʵϢ            */
+    struct am_bcache_entry   *p_entry;    /**< \brief Ϣ      */
+    uint8_t                  *p_data;     /**< \brief           */
+    uint32_t                  blk_size;   /**< \brief С*/
+    uint16_t                  nblks;      /**< \brief           */
+    uint16_t                  mru;        /**< \brief ʹõĿ        */
+    uint16_t                  lru;        /**< \brief δʹõĿ      */
+    uint32_t                  size;       /**< \brief             */
+    uint32_t                  next_blk;   /**< \brief ˳ȡһ    */
+
+    /** \brief ȡݵ */
+    int (*pfn_readv) (struct am_bcache       *p_cache,
+                      uint32_t                addr,
+                      const am_mtd_iovec_t   *p_iov,
+                      int                     iovcnt);
+
+    am_mtd_handle_t           mtd;        /**< \brief ² MTD 豸       */
+    am_nvram_dev_t           *p_nvram;    /**< \brief ² NVRAM 豸     */
+
+    am_bcache_stat_t          stat;       /**< \brief ͳϢ            */
+
+} am_bcache_t;
+
+/**
+ * \brief  MTD 豸֮Ͻ黺棬õһ MTD 豸
+ *
+ *     µ MTD 豸С²豸ͬ棬д
+ *  am_mtd_erase_start() 첽ֱӽ²豸Ԥʹ
+ * am_mtd_readv()²豸ַ֧ɢʱ am_mx25xxδеĿԤĿ
+ * ֻһ
+ *
+ * \param[in] p_cache : 黺ʵ
+ * \param[in] p_info  : 黺ʵϢ
+ * \param[in] mtd     : ² MTD 豸
+ * \param[in] p_mtd   : µ MTD 豸ʵ
+ *
+ * \return µ MTD 豸Ϊ NULL ʱʾʼʧ
+ */
+am_mtd_handle_t am_bcache_mtd_init (am_bcache_t            *p_cache,
+                                    const am_bcache_info_t *p_info,
+                                    am_mtd_handle_t         mtd,
+                                    am_mtd_serv_t          *p_mtd);
+
+/**
+ * \brief  NVRAM 洢豸֮Ͻ黺棬עΪһµ NVRAM 洢豸
+ *
+ *     ²豸һ NVRAM ʼ am_ep24cxx_nvram_init()䣬
+ * 洢Ӧʹ豸֡ͨ²豸ֱдݲʹʧЧ
+ *
+ * \param[in] p_cache    : 黺ʵ
+ * \param[in] p_info     : 黺ʵϢ
+ * \param[in] p_lower    : ² NVRAM 洢豸
+ * \param[in] size       : ²豸Ԥᳬ÷Χ
+ * \param[in] p_dev      : µ NVRAM 洢豸
+ * \param[in] p_dev_name : 豸
+ *
+ * \retval AM_OK      : ʼɹ
+ * \retval -AM_EINVAL : Ч
+ */
+int am_bcache_nvram_init (am_bcache_t            *p_cache,
+                          const am_bcache_info_t *p_info,
+                          am_nvram_dev_t         *p_lower,
+                          uint32_t                size,
+                          am_nvram_dev_t         *p_dev,
+                          const char             *p_dev_name);
+
+/**
+ * \brief ʹȫʧЧ
+ *
+ * ƹ黺޸еݺ
+ *
+ * \param[in] p_cache : 黺ʵ
+ *
+ * \return 
+ */
+void am_bcache_invalidate_all (am_bcache_t *p_cache);
+
+/**
+ * \brief ȡ黺ͳϢ
+ *
+ * \param[in]  p_cache : 黺ʵ
+ * \param[out] p_stat  : ͳϢ
+ *
+ * \retval AM_OK      : ȡɹ
+ * \retval -AM_EINVAL : Ч
+ */
+int am_bcache_stat_get (am_bcache_t *p_cache, am_bcache_stat_t *p_stat);
+
+/** @} am_if_bcache */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __AM_BCACHE_H */
+
+/* end of file */
@@ -58,6 +58,15 @@ typedef struct am_crc_table {
      */
     const void *p_data;
 
+    /**
+     * \brief p_data аӱ14  8Ϊ 0 ʱΪ 1
+     *
+     * ӱ1ʱp_data δ slices Ϊ256ӱ0ӱ
+     * ֽڼʹõͨ k ӱΪ0ӱֵٴ k ȫ0ֽڵ
+     * CRCݴÿδ48ֽڣڿȴ8CRC
+     */
+    uint8_t     slices;
+
 } am_crc_table_t;
 
 /**
@@ -109,6 +118,35 @@ int am_crc_table_create (am_crc_table_t  *p_table,
                          am_bool_t        refin,
                          void            *p_data);
 
+/**
+ * \brief һڰ֣4ֽڻ8ֽڣ CRC table
+ *
+ *      am_crc_table_create() ȣñ slices - 1 ӱCRC
+ * ʹøñʱÿοԴֽڣٶߣǱĴСΪͨ
+ * slices ڹ̼У顢洢Уȴĳϡ
+ *
+ * \param[in] p_table : TABLEʵ
+ * \param[in] width   : CRCȣ8
+ * \param[in] poly    : ɶʽ
+ * \param[in] refin   : ֽbit
+ * \param[in] slices  : ӱ14  8
+ * \param[in] p_data  : 洢ݵռ䣬ʵ widthֵء
+ *                     - 9  16λָ TABLE ԭΪuint16_t data[256 * slices]
+ *                     - 17 32λָ TABLE ԭΪuint32_t data[256 * slices]
+ *
+ * \retval AM_OK      : ɳɹ
+ * \retval -AM_EINVAL : ʧܣڴ
+ *
+ * \note ģѾṩ˰ּ table  _s4  _s8 β
+ * \ref am_if_crc_table_def.
+ */
+int am_crc_table_slice_create (am_crc_table_t  *p_table,
+                               uint8_t          width,
+                               uint32_t         poly,
+                               am_bool_t        refin,
+                               uint8_t          slices,
+                               void            *p_data);
+
 /**
  * \brief ʼһ CRC 
  *
@@ -123,7 +161,8 @@ int am_crc_table_create (am_crc_table_t  *p_table,
  * \warning ﴫTABLE˸ CRC ֵ֧CRCģֵ֧ͣCRCģ \n
  * Уwidthpolyrefin ֵ TABLE ֵһ¡
  *
- * \note ʹøúʼCRCԱֲֶ֧ͬģ͵CRC
+ * \note ʹøúʼCRCԱֲֶ֧ͬģ͵CRC TABLE
+ * ӱslices Ϊ 4  8Զʹðּķʽ
  */
 am_crc_handle_t am_crc_soft_init (am_crc_soft_t         *p_crc,
                                   const am_crc_table_t  *p_table);
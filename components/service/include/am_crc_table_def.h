@@ -120,6 +120,32 @@ am_import am_const am_crc_table_t g_crc_table_32_04c11db7;
 
 /** @} */
 
+/**
+ * \name ּcrc table
+ *
+ * аӱCRCʹЩʱÿδ4_s48_s8ֽڣ
+ * ٶȸ죬ĴСΪͨ48ͨͬ
+ * ӱ׺ģͲУʹ am_crc_table_slice_create() 
+ * @{
+ */
+
+/** \brief crc16  poly = 0x8005, refin = TRUE4ӱ */
+am_import am_const am_crc_table_t g_crc_table_16_8005_ref_s4;
+
+/** \brief crc16  poly = 0x1021, refin = TRUE4ӱ */
+am_import am_const am_crc_table_t g_crc_table_16_1021_ref_s4;
+
+/** \brief crc16  poly = 0x1021, refin = FALSE4ӱ */
+am_import am_const am_crc_table_t g_crc_table_16_1021_s4;
+
+/** \brief crc32  poly = 0x04c11db7, refin = TRUE8ӱ */
+am_import am_const am_crc_table_t g_crc_table_32_04c11db7_ref_s8;
+
+/** \brief crc32  poly = 0x04c11db7, refin = FALSE8ӱ */
+am_import am_const am_crc_table_t g_crc_table_32_04c11db7_s8;
+
+/** @} */
+
 /**
  * @}
  */
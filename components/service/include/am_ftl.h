@@ -24,6 +24,7 @@
 #include "ametal.h"
 #include "am_mtd.h"
 #include "am_nvram.h"
+#include "am_jobq.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -46,6 +47,50 @@ extern "C" {
      + ((nb_log_blocks) * ((erase_size) / (logic_blk_size)))                 \
      + (((((size) / (erase_size)) + 31) / 32) * sizeof(uint32_t)))
  
+/**
+ * \name ̨ãʱѡ
+ * @{
+ */
+
+/**
+ * \brief ̨ҪֵĿ־
+ *
+ * ־ڸֵ־дʱ̨սϲһ־顣
+ * ڱд־δдʱᱻϲ
+ */
+#ifndef AM_FTL_GC_FREE_LOGS
+#define AM_FTL_GC_FREE_LOGS    1
+#endif
+
+/**
+ * \brief ̬ĥļڣÿٴһĥ
+ */
+#ifndef AM_FTL_WL_CHECK_ERASES
+#define AM_FTL_WL_CHECK_ERASES 32
+#endif
+
+/**
+ * \brief Ч
+ *
+ * дϢʱ磬ϢеĲֻд˵λֽڣ 0xFFFF02B9
+ * ڸֵĲΪЧĥĥͳƣٴβʱ
+ * ĲֵӦԶڴ洢Ķ
+ */
+#ifndef AM_FTL_WEAR_MAX
+#define AM_FTL_WEAR_MAX        0x00FFFFFF
+#endif
+
+/** @} */
+
+/**
+ * \brief ߼ӳ䣨L2P¼һ߼鵱ǰڵλ
+ */
+typedef struct am_ftl_l2p {
+    uint32_t  lbn;         /**< \brief ߼ţ0xFFFFFFFF ʾЧ */
+    uint16_t  pbn;         /**< \brief                          */
+    uint16_t  sec;         /**< \brief е                 */
+} am_ftl_l2p_t;
+
 typedef struct am_ftl_info {
 
     /** \brief RAM    */
@@ -72,8 +117,77 @@ typedef struct am_ftl_info {
     /** \brief 飨Ԫʼļ齫ᱻʹ     */
     size_t     reserved_blocks;
 
+    /**
+     * \brief ߼ӳ䣨L2P棬ѡΪ NULL ʱʹ
+     *
+     * ȡһ߼ʱҪȶȡ־ݿеǩȷڵ
+     * λá¼д߼ڵλãʱֻһ MTD 
+     * ɶݡ水߼ֱӳ䣬С߼
+     * \sa am_ftl_max_lbn_get()ʱΪӳ
+     */
+    am_ftl_l2p_t *p_l2p;
+
+    /** \brief L2P ÿռ sizeof(am_ftl_l2p_t) ֽ       */
+    size_t        l2p_num;
+
+    /**
+     * \brief 㣨checkpointʹõΪ0ʱʹü
+     *
+     * ʹüʱÿγʼҪȡĿϢؽӳ
+     * ʹüʱFTL ӳпϢĿգCRCУ飩д洢
+     * ĩβЩУʼʱЧֱӼؿգֻɨ
+     * ־飬Խɨ裬ɨɺдµĿա
+     *
+     * ֵΪżΪʹãÿĴССһյ
+     * СԼΪ  * 2 +  / 8 + ־ * 4 + 28 ֽڣ
+     * Щ鲻ڴ洢ݣ޸ĸֵҪ¸ʽ洢
+     */
+    size_t        ckpt_blocks;
+
+    /**
+     * \brief ѡΪ NULL ʱʹ
+     *
+     * ڸĿϢУñĲ
+     * ̬ĥ am_ftl_wear_stat_get() ÿζȡĿϢ
+     * С 洢 / ԪС
+     */
+    uint32_t     *p_wear;
+
+    /**
+     * \brief ̬ĥֵΪ0ʱо̬ĥ
+     *
+     * ֻݣٸдݣ鼸ᱻд붼
+     * ϡÿ AM_FTL_WL_CHECK_ERASES 飬һβ
+     * ݵвٵֵ
+     * 򽫺еǨƵĿпУʹд롣
+     *
+     * Ǩ־ϲһֲУ˺̨գ\sa am_ftl_gc_jobq_set()
+     * ʱں̨ɣдʱͬɡ
+     */
+    uint32_t      wl_threshold;
+
 } am_ftl_info_t ;
 
+/**
+ * \brief ĥͳϢ
+ */
+typedef struct am_ftl_wear_stat {
+    uint32_t  blocks;       /**< \brief                            */
+    uint32_t  min;          /**< \brief ٲ                         */
+    uint32_t  max;          /**< \brief                          */
+    uint32_t  mean;         /**< \brief ƽ                         */
+    uint32_t  total;        /**< \brief ܺ                         */
+
+    /** \brief ʣǰĥԤƵʣ */
+    uint32_t  remain;
+
+    /** \brief ʱʣ - ƽ                */
+    uint32_t  remain_ideal;
+
+    /** \brief Ч AM_FTL_WEAR_MAXͳ */
+    uint32_t  invalid;
+} am_ftl_wear_stat_t;
+
 
 /**
  * FTL ṹ嶨
@@ -119,6 +233,51 @@ typedef struct am_ftl_serv {
     }*p_log_buf;
 
     const   am_ftl_info_t  *p_info;
+
+    /** \brief sequence number of the current checkpoint   */
+    uint32_t        ckpt_seq;
+
+    /** \brief address of the current checkpoint header     */
+    uint32_t        ckpt_addr;
+
+    /** \brief address to write the next checkpoint         */
+    uint32_t        ckpt_next;
+
+    /** \brief the current checkpoint matches the tables    */
+    am_bool_t       ckpt_valid;
+
+    /** \brief merge state, see __FTL_GC_*                  */
+    uint8_t         gc_state;
+
+    /** \brief next sector to copy                          */
+    uint8_t         gc_sec;
+
+    /** \brief the logic block being merged                 */
+    uint16_t        gc_lbn;
+
+    /** \brief the new data block of the merge              */
+    uint16_t        gc_new;
+
+    /** \brief the old data block of the merge              */
+    uint16_t        gc_direct;
+
+    /** \brief the logic block written most recently        */
+    uint16_t        gc_hot_lbn;
+
+    /** \brief the log buffer being merged                  */
+    struct log_buf *gc_p_log;
+
+    /** \brief sectors already copied to the new block      */
+    uint32_t        gc_copied[8];
+
+    /** \brief the job queue to run background gc           */
+    am_jobq_handle_t gc_jobq;
+
+    /** \brief the background gc job                        */
+    am_jobq_job_t   gc_job;
+
+    /** \brief erases since the last wear leveling check    */
+    uint32_t        wl_erases;
  
 } am_ftl_serv_t;
 
@@ -171,6 +330,134 @@ int am_ftl_write (am_ftl_handle_t handle, unsigned int lbn, void *p_buf);
  */
 int am_ftl_read (am_ftl_handle_t handle, unsigned int lbn, void *p_buf);
 
+/**
+ * \brief дĶ
+ *
+ *  am_ftl_write() Ľͬݿеǩ
+ * ֱͨһ MTD дɣSPI FLASH ͵ַ֮١
+ *
+ * \param[in] handle : FTL ʵ
+ * \param[in] lbn    : ʼ߼
+ * \param[in] p_buf  : ݴŵĻΪ nblks ߼С
+ * \param[in] nblks  : ߼
+ *
+ * \retval AM_OK      : дݳɹ
+ * \retval -AM_EINVAL : Ч߼鳬Χ
+ * \retval  < 0       : дʧ
+ */
+int am_ftl_write_blocks (am_ftl_handle_t  handle,
+                         unsigned int     lbn,
+                         const void      *p_buf,
+                         unsigned int     nblks);
+
+/**
+ * \brief ȡĶ
+ *
+ *  am_ftl_read() Ľͬδʹ־߼飬ǩ
+ * ݷֱͨһ MTD ɣңϲΪһ
+ * MTD 
+ *
+ * \param[in] handle : FTL ʵ
+ * \param[in] lbn    : ʼ߼
+ * \param[in] p_buf  : ݴŵĻΪ nblks ߼С
+ * \param[in] nblks  : ߼
+ *
+ * \retval AM_OK      : ȡݳɹ
+ * \retval -AM_EINVAL : Ч߼鳬Χ
+ * \retval  < 0       : ȡʧ
+ */
+int am_ftl_read_blocks (am_ftl_handle_t  handle,
+                        unsigned int     lbn,
+                        void            *p_buf,
+                        unsigned int     nblks);
+
+/**
+ * \brief д㣨ӳգ
+ *
+ * ӳһд仯¿顢ϲ־飩ʱд
+ * µĿգֱӷءڿʱǰԵصãԱ´γʼ
+ * ʱֱӼؿա
+ *
+ * \param[in] handle : FTL ʵ
+ *
+ * \retval AM_OK       : дɹд
+ * \retval -AM_EINVAL  : Ч
+ * \retval -AM_ENOTSUP : δü
+ * \retval  < 0        : дʧ
+ */
+int am_ftl_checkpoint (am_ftl_handle_t handle);
+
+/**
+ * \brief ų́գ־ϲʹõ
+ *
+ * δʱ־д am_ftl_write() ͬϲ־飨
+ * ݲ飩дʱܺܳкÿд
+ * Ҫգ AM_FTL_GC_FREE_LOGSӻÿ
+ * ִֻһһһ飩¼УӶǰ׼
+ * ־飬ʹдҪͬϲ
+ *
+ * չдںϲ߼飬ûпе־ʱд
+ * ͬʣĻղ衣
+ *
+ * \param[in] handle : FTL ʵ
+ * \param[in] jobq   : оΪ NULL ʱʹų́
+ * \param[in] pri    : ȼʹöеȼ
+ *
+ * \retval AM_OK      : óɹ
+ * \retval -AM_EINVAL : Ч
+ *
+ * \note б am_ftl_read()am_ftl_write() ͬһд
+ *       ѭʱ am_jobq_process()жд
+ */
+int am_ftl_gc_jobq_set (am_ftl_handle_t   handle,
+                        am_jobq_handle_t  jobq,
+                        uint16_t          pri);
+
+/**
+ * \brief ִһգ־ϲ
+ *
+ * ʹʱڿʱйӺУѭøúֱ
+ * 0ÿεิһһ顣
+ *
+ * \param[in] handle : FTL ʵ
+ *
+ * \retval  0 : 
+ * \retval  1 : 
+ * \retval <0 : ʧ
+ */
+int am_ftl_gc_step (am_ftl_handle_t handle);
+
+/**
+ * \brief ȡһĲ
+ *
+ * \param[in]  handle  : FTL ʵ
+ * \param[in]  pbn     : ţЧΧΪ 0 ~ (nb_blocks - 1)
+ *                       ͼʹõ
+ * \param[out] p_count : ȡĲ
+ *
+ * \retval AM_OK       : ȡɹ
+ * \retval -AM_EINVAL  : Ч
+ * \retval -AM_EBADMSG : ϢеĲЧ AM_FTL_WEAR_MAX
+ * \retval  < 0        : ȡϢʧ
+ */
+int am_ftl_wear_get (am_ftl_handle_t handle, unsigned int pbn, uint32_t *p_count);
+
+/**
+ * \brief ȡĥͳϢ
+ *
+ * \param[in]  handle    : FTL ʵ
+ * \param[in]  endurance : 洢Ķ磺NOR FLASH һΪ100000
+ * \param[out] p_stat    : ȡͳϢ
+ *
+ * \retval AM_OK      : ȡɹ
+ * \retval -AM_EINVAL : Ч
+ *
+ * \note δòp_wearʱҪȡĿϢ
+ */
+int am_ftl_wear_stat_get (am_ftl_handle_t     handle,
+                          uint32_t            endurance,
+                          am_ftl_wear_stat_t *p_stat);
+
 /**
  * \brief ʼ NVRAM ܣԱʹNVRAMӿڷʴ洢
  *
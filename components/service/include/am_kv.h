@@ -0,0 +1,335 @@
+/*******************************************************************************
+*                                 AMetal
+*                       ----------------------------
+*                       innovating embedded platform
+*
+* Copyright (c) 2001-2018 Guangzhou ZHIYUAN Electronics Co., Ltd.
+* All rights reserved.
+*
+* Contact information:
+* web site:    http://www.zlg.cn/
+*******************************************************************************/
+/**
+ * \file
+ * \brief ֵKey-Value洢
+ *
+ *     ֵ洢ÿдļֵΪһ¼׷д MTD 豸Ĳ
+ * Уͬһ¼¼ʹɼ¼ʧЧдһ4ֽڵļֻдʮֽڣ
+ *  NVRAM 洢д߼ҳ
+ *
+ *     RAM бɢÿ8ֽڣֵȡʱֻ
+ * һ MTD ɶλ¼ʼʱɨв飬ط
+ * ¼ؽ
+ *
+ *     в鲻ʱѡʧЧĿ飬Чļ¼Ƶǰ
+ * дĿУȻÿ飨ѹѹֲУÿһ¼
+ * һ飬к̨ɣ\sa am_kv_gc_jobq_set()
+ *
+ *     ÿ¼ CRC У顣деʱļ¼ڳʼʱ
+ * üԭֵѹеʱƵļ¼жڣ
+ * ʼʱԽµĿΪ׼κʱ̵綼ᶪʧѾдɵļ¼
+ *
+ * \note ֧д뵥ԪΪ1ֽڵ MTD 豸 SPI NOR FLASHҪ3
+ *       飬һʼձѹʹá
+ *
+ * \par ʾ
+ * \code
+ * #include "am_kv.h"
+ *
+ * static uint8_t      g_kv_ram[AM_KV_RAM_SIZE_GET(64 * 1024, 4096, 128)];
+ * static am_kv_info_t g_kv_info = {g_kv_ram, sizeof(g_kv_ram), 128};
+ * static am_kv_serv_t g_kv;
+ *
+ * am_kv_handle_t kv = am_kv_init(&g_kv, &g_kv_info, mtd_handle);
+ * uint32_t       boot_cnt = 0;
+ *
+ * am_kv_get(kv, "boot_cnt", &boot_cnt, sizeof(boot_cnt));
+ * boot_cnt++;
+ * am_kv_set(kv, "boot_cnt", &boot_cnt, sizeof(boot_cnt));
+ * \endcode
+ *
+ * \internal
+ * \par Modification history
+ * - 1.00 26-10-18  agent, first implementation.
+ * \endinternal
+ */
+#ifndef __AM_KV_H
+#define __AM_KV_H
+
+#include "ametal.h"
+#include "am_mtd.h"
+#include "am_jobq.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \name ֵ洢ãʱѡ
+ * @{
+ */
+
+/** \brief ַ󳤶ȣô254 */
+#ifndef AM_KV_KEY_MAX
+#define AM_KV_KEY_MAX          32
+#endif
+
+/**
+ * \brief ֵ󳤶
+ *
+ * ÿĩβзŲһ¼ʣռ䣬Ϊ֤洢ռӽʱ
+ * ܸдеļÿ鰴¼Ԥⲿֿռ䡣һļ¼
+ * ԼΪ AM_KV_KEY_MAX + AM_KV_VAL_MAX + 8 ֽڣóһ롣
+ */
+#ifndef AM_KV_VAL_MAX
+#define AM_KV_VAL_MAX          256
+#endif
+
+/**
+ * \brief ̨ѹҪֵĿвѹʹõһ飩
+ *
+ * вڸֵʱдѹ
+ */
+#ifndef AM_KV_GC_FREE_BLOCKS
+#define AM_KV_GC_FREE_BLOCKS   3
+#endif
+
+/** @} */
+
+/**
+ * \brief Ϣ
+ */
+struct am_kv_block {
+    uint32_t  seq;    /**< \brief ţ0ʾп                          */
+    uint32_t  used;   /**< \brief ʹõֽпΪ0ʱʾѲ        */
+    uint32_t  live;   /**< \brief Ч¼ֽ                             */
+};
+
+/**
+ * \brief 
+ */
+struct am_kv_index {
+    uint32_t  hash;   /**< \brief ɢֵ                                   */
+    uint32_t  addr;   /**< \brief ¼ַλΪɾ־ȫ1ʾ        */
+};
+
+/**
+ * \brief ֵ洢Ҫʹõڴ棨RAMռС
+ *
+ * \param[in] size       : MTD 豸
+ * \param[in] erase_size : ԪС
+ * \param[in] nindex     : Ϊ2
+ */
+#define AM_KV_RAM_SIZE_GET(size, erase_size, nindex)                         \
+    (((size) / (erase_size)) * sizeof(struct am_kv_block) +                  \
+     (nindex) * sizeof(struct am_kv_index))
+
+/**
+ * \brief ֵ洢ʵϢ
+ */
+typedef struct am_kv_info {
+
+    /** \brief RAM Ӧ4ֽڶ */
+    uint8_t  *p_buf;
+
+    /** \brief RAM ĳȣС AM_KV_RAM_SIZE_GET() õֵ */
+    size_t    len;
+
+    /**
+     * \brief Ϊ2
+     *
+     * ʹ 3/4Ա nindex * 3 / 4 ɾδ
+     * ѹļҲռ
+     */
+    uint32_t  nindex;
+
+} am_kv_info_t;
+
+/**
+ * \brief ֵ洢ͳϢ
+ */
+typedef struct am_kv_stat {
+    uint32_t  nkeys;        /**< \brief еļɾļ       */
+    uint32_t  live_bytes;   /**< \brief Ч¼ֽ                   */
+    uint32_t  capacity;     /**< \brief Ч¼ֽ               */
+    uint32_t  free_blocks;  /**< \brief в                       */
+    uint32_t  user_bytes;   /**< \brief ûдļֵֽ           */
+    uint32_t  flash_bytes;  /**< \brief д MTD 豸ֽ              */
+    uint32_t  erases;       /**< \brief                              */
+    uint32_t  gc_copies;    /**< \brief ѹʱƵļ¼                   */
+} am_kv_stat_t;
+
+/**
+ * \brief ֵ洢ʵӦóӦֱӲṹԱ
+ */
+typedef struct am_kv_serv {
+
+    /** \brief the MTD handle                               */
+    am_mtd_handle_t      mtd;
+
+    /** \brief instance information                         */
+    const am_kv_info_t  *p_info;
+
+    /** \brief block information table                      */
+    struct am_kv_block  *p_blk;
+
+    /** \brief hash index                                   */
+    struct am_kv_index  *p_idx;
+
+    /** \brief number of erase blocks                       */
+    uint32_t             nblocks;
+
+    /** \brief size of an erase block                       */
+    uint32_t             blk_size;
+
+    /** \brief index entries in use                         */
+    uint32_t             nkeys;
+
+    /** \brief bytes of all live records                    */
+    uint32_t             live;
+
+    /** \brief sequence number of the newest block          */
+    uint32_t             seq;
+
+    /** \brief the block being written, -1 if none          */
+    int                  active;
+
+    /** \brief the block being compacted, -1 if none        */
+    int                  gc_blk;
+
+    /** \brief next record to check in the compacted block  */
+    uint32_t             gc_off;
+
+    /** \brief the job queue to run background compaction  */
+    am_jobq_handle_t     gc_jobq;
+
+    /** \brief the background compaction job               */
+    am_jobq_job_t        gc_job;
+
+    /** \brief statistics                                   */
+    am_kv_stat_t         stat;
+
+} am_kv_serv_t;
+
+/** \brief ֵ洢Ͷ */
+typedef am_kv_serv_t *am_kv_handle_t;
+
+/**
+ * \brief ֵ洢ʼ
+ *
+ * ɨ MTD 豸ев飬ؽδʽĲΪп飬
+ * ʹǰ
+ *
+ * \param[in] p_kv   : ֵ洢ʵ
+ * \param[in] p_info : ֵ洢ʵϢ
+ * \param[in] mtd    :  MTD 洢豸
+ *
+ * \return ֵ洢ֵΪNULLʱʾʼʧܣЧMTD 豸֧
+ *         㣩
+ */
+am_kv_handle_t am_kv_init (am_kv_serv_t       *p_kv,
+                           const am_kv_info_t *p_info,
+                           am_mtd_handle_t     mtd);
+
+/**
+ * \brief дһֵ
+ *
+ * \param[in] handle : ֵ洢
+ * \param[in] p_key  : '\0'βַΪ 1 ~ AM_KV_KEY_MAX
+ * \param[in] p_val  : ֵ
+ * \param[in] len    : ֵĳȣ0 ~ AM_KV_VAL_MAX
+ *
+ * \retval AM_OK      : дɹ
+ * \retval -AM_EINVAL : Ч
+ * \retval -AM_ENOSPC : 洢ռ䲻㣨Ч¼ֽޣ
+ * \retval -AM_ENOMEM : 
+ * \retval  < 0       : 
+ */
+int am_kv_set (am_kv_handle_t  handle,
+               const char     *p_key,
+               const void     *p_val,
+               size_t          len);
+
+/**
+ * \brief ȡһֵ
+ *
+ * \param[in]  handle : ֵ洢
+ * \param[in]  p_key  : 
+ * \param[out] p_buf  : ֵĻ
+ * \param[in]  len    : ȣֵĳȳֵʱֻȡǰ len ֽ
+ *
+ * \retval >= 0       : ֵʵʳ
+ * \retval -AM_ENOENT : 
+ * \retval -AM_EINVAL : Ч
+ * \retval  < 0       : 
+ */
+int am_kv_get (am_kv_handle_t  handle,
+               const char     *p_key,
+               void           *p_buf,
+               size_t          len);
+
+/**
+ * \brief ɾһ
+ *
+ * \param[in] handle : ֵ洢
+ * \param[in] p_key  : 
+ *
+ * \retval AM_OK      : ɾɹ
+ * \retval -AM_ENOENT : 
+ * \retval  < 0       : 
+ */
+int am_kv_del (am_kv_handle_t handle, const char *p_key);
+
+/**
+ * \brief ų́ѹʹõ
+ *
+ * δʱֻдʱв鲻ͬѹк
+ * дв AM_KV_GC_FREE_BLOCKSѹ
+ * ÿִֻһ¼С
+ *
+ * \param[in] handle : ֵ洢
+ * \param[in] jobq   : оΪ NULL ʱʹų́ѹ
+ * \param[in] pri    : ѹȼʹöеȼ
+ *
+ * \retval AM_OK      : óɹ
+ * \retval -AM_EINVAL : Ч
+ *
+ * \note б am_kv_set() Ⱥͬһдж
+ *       
+ */
+int am_kv_gc_jobq_set (am_kv_handle_t    handle,
+                       am_jobq_handle_t  jobq,
+                       uint16_t          pri);
+
+/**
+ * \brief ִһѹ
+ *
+ * ʹʱڿʱѭøúֱ0ÿε
+ * һ¼һ顣
+ *
+ * \param[in] handle : ֵ洢
+ *
+ * \retval  0 : ѹ
+ * \retval  1 : ѹ
+ * \retval <0 : ѹʧ
+ */
+int am_kv_gc_step (am_kv_handle_t handle);
+
+/**
+ * \brief ȡͳϢ
+ *
+ * \param[in]  handle : ֵ洢
+ * \param[out] p_stat : ȡͳϢ
+ *
+ * \retval AM_OK      : ȡɹ
+ * \retval -AM_EINVAL : Ч
+ */
+int am_kv_stat_get (am_kv_handle_t handle, am_kv_stat_t *p_stat);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __AM_KV_H */
+
+/* end of file */
@@ -109,6 +109,14 @@ struct am_mtd_erase_info {
     enum am_mtd_erase_status    state;
 };
 
+/**
+ * \brief ɢ/ۼдĻ am_mtd_readv()  am_mtd_writev()
+ */
+typedef struct am_mtd_iovec {
+    void      *p_buf;                /**< \brief        */
+    uint32_t   len;                  /**< \brief ĳ */
+} am_mtd_iovec_t;
+
 /** \brief MTD driver operations */
 struct am_mtd_ops {
     
@@ -126,6 +134,26 @@ struct am_mtd_ops {
                           uint32_t            addr,
                           const void         *p_buf,
                           uint32_t            len);
+
+    /**
+     * \brief ɢѡĵַжȡݵ
+     *
+     * Ϊ NULL ʱam_mtd_readv() ÿֱ pfn_mtd_read()
+     */
+    int (*pfn_mtd_readv)  (void                 *p_drv,
+                           uint32_t              addr,
+                           const am_mtd_iovec_t *p_iov,
+                           int                   iovcnt);
+
+    /**
+     * \brief ۼдѡедĵַ
+     *
+     * Ϊ NULL ʱam_mtd_writev() ÿֱ pfn_mtd_write()
+     */
+    int (*pfn_mtd_writev) (void                 *p_drv,
+                           uint32_t              addr,
+                           const am_mtd_iovec_t *p_iov,
+                           int                   iovcnt);
 };
 
 /** 
@@ -195,6 +223,25 @@ int am_mtd_erase (am_mtd_handle_t     handle,
                   uint32_t            addr,
                   uint32_t            len);
 
+/**
+ * \brief ɺ p_info->pfn_callback
+ *
+ *      p_info->addr  p_info->len ָɺ p_info->state Ϊ
+ * AM_MTD_ERASE_DONE  AM_MTD_ERASE_FAILED֧첽ʱ
+ * أصжеãɺںǰ
+ * ص
+ *
+ * \param[in] handle : MTD׼豸ʵľ
+ * \param[in] p_info : Ϣǰ뱣Чpfn_callback Ϊ NULL
+ *
+ * \retval  AM_OK      : ɣ
+ * \retval -AM_EINVAL  : 
+ * \retval -AM_EROFS   : 豸д
+ * \retval  ֵ   : ʧܣûص
+ */
+int am_mtd_erase_start (am_mtd_handle_t            handle,
+                        struct am_mtd_erase_info  *p_info);
+
 /**
  * \brief ȡ
  *
@@ -227,6 +274,43 @@ int am_mtd_write (am_mtd_handle_t     handle,
                   const void         *p_buf,
                   uint32_t            len);
 
+/**
+ * \brief ɢĵַζȡݵ
+ *
+ * ֧ʱлһɣ SPI FLASH ֻ跢һζ
+ * ͵ַζȡ
+ *
+ * \param[in] handle : MTD׼豸ʵľ
+ * \param[in] addr   : ȡݵ׵ַ
+ * \param[in] p_iov  : 
+ * \param[in] iovcnt : 
+ *
+ * \retval  Ǹ : ɹȡֽ
+ * \retval     : ȡʧ
+ */
+int am_mtd_readv (am_mtd_handle_t       handle,
+                  uint32_t              addr,
+                  const am_mtd_iovec_t *p_iov,
+                  int                   iovcnt);
+
+/**
+ * \brief ۼдедĵַ
+ *
+ * ֧ʱͬһҳڵһα̲ɣд
+ *
+ * \param[in] handle : MTD׼豸ʵľ
+ * \param[in] addr   : дݵ׵ַ
+ * \param[in] p_iov  : 
+ * \param[in] iovcnt : 
+ *
+ * \retval  Ǹ : ɹдֽ
+ * \retval     : дʧ
+ */
+int am_mtd_writev (am_mtd_handle_t       handle,
+                   uint32_t              addr,
+                   const am_mtd_iovec_t *p_iov,
+                   int                   iovcnt);
+
 #ifdef __cplusplus
 }
 #endif
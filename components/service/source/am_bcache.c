@@ -0,0 +1,658 @@
+/*******************************************************************************
+*                                 AMetal
+*                       ----------------------------
+*                       innovating embedded platform
+*
+* Copyright (c) 2001-2018 Guangzhou ZHIYUAN Electronics Co., Ltd.
+* All rights reserved.
+*
+* Contact information:
+* web site:    http://www.zlg.cn/
+*******************************************************************************/
+/**
+ * \file
+ * \brief 洢棨黺棩ʵ
+ *
+ * \internal
+ * \par Modification history
+ * - 1.00 26-10-18  agent, first implementation.
+ * \endinternal
+ */
+#include "ametal.h"
+#include "am_bcache.h"
+#include <string.h>
+
+/*******************************************************************************
+    Local defines
+*******************************************************************************/
+
+#define __BCACHE_NIL         0xFFFF       /* end of the LRU list          */
+#define __BCACHE_BLK_NONE    0xFFFFFFFF   /* the entry is invalid         */
+#define __BCACHE_RA_FLAG     0x80000000   /* read ahead, not be hit yet   */
+
+/* max blocks read from the device at once */
+#define __BCACHE_IOV_MAX     16
+
+#define __BCACHE_DATA(p_cache, idx) \
+    ((p_cache)->p_data + (uint32_t)(idx) * (p_cache)->blk_size)
+
+/*******************************************************************************
+    LRU list
+*******************************************************************************/
+
+static void __bcache_unlink (am_bcache_t *p_cache, uint16_t idx)
+{
+    struct am_bcache_entry *p_e = &p_cache->p_entry[idx];
+
+    if (p_e->prev != __BCACHE_NIL) {
+        p_cache->p_entry[p_e->prev].next = p_e->next;
+    } else {
+        p_cache->mru = p_e->next;
+    }
+
+    if (p_e->next != __BCACHE_NIL) {
+        p_cache->p_entry[p_e->next].prev = p_e->prev;
+    } else {
+        p_cache->lru = p_e->prev;
+    }
+}
+
+/******************************************************************************/
+
+/* move the entry to the head (most recently used) */
+static void __bcache_mru_set (am_bcache_t *p_cache, uint16_t idx)
+{
+    struct am_bcache_entry *p_e = &p_cache->p_entry[idx];
+
+    if (p_cache->mru == idx) {
+        return;
+    }
+
+    __bcache_unlink(p_cache, idx);
+
+    p_e->prev = __BCACHE_NIL;
+    p_e->next = p_cache->mru;
+
+    if (p_cache->mru != __BCACHE_NIL) {
+        p_cache->p_entry[p_cache->mru].prev = idx;
+    }
+    p_cache->mru = idx;
+
+    if (p_cache->lru == __BCACHE_NIL) {
+        p_cache->lru = idx;
+    }
+}
+
+/******************************************************************************/
+
+/* move the entry to the tail, it will be reused first */
+static void __bcache_lru_set (am_bcache_t *p_cache, uint16_t idx)
+{
+    struct am_bcache_entry *p_e = &p_cache->p_entry[idx];
+
+    if (p_cache->lru == idx) {
+        return;
+    }
+
+    __bcache_unlink(p_cache, idx);
+
+    p_e->next = __BCACHE_NIL;
+    p_e->prev = p_cache->lru;
+
+    if (p_cache->lru != __BCACHE_NIL) {
+        p_cache->p_entry[p_cache->lru].next = idx;
+    }
+    p_cache->lru = idx;
+
+    if (p_cache->mru == __BCACHE_NIL) {
+        p_cache->mru = idx;
+    }
+}
+
+/******************************************************************************/
+static int __bcache_find (am_bcache_t *p_cache, uint32_t blk)
+{
+    uint32_t e_blk;
+    int      i;
+
+    for (i = 0; i < p_cache->nblks; i++) {
+        e_blk = p_cache->p_entry[i].blk;
+        if ((e_blk != __BCACHE_BLK_NONE) && ((e_blk & ~__BCACHE_RA_FLAG) == blk)) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/*******************************************************************************
+    Cache operations
+*******************************************************************************/
+
+static void __bcache_invalidate (am_bcache_t *p_cache,
+                                 uint32_t     addr,
+                                 uint32_t     len)
+{
+    uint32_t first;
+    uint32_t last;
+    uint32_t e_blk;
+    int      i;
+
+    if (len == 0) {
+        return;
+    }
+
+    first = addr / p_cache->p_info->blk_size;
+    last  = (addr + len - 1) / p_cache->p_info->blk_size;
+
+    for (i = 0; i < p_cache->nblks; i++) {
+        e_blk = p_cache->p_entry[i].blk;
+        if (e_blk == __BCACHE_BLK_NONE) {
+            continue;
+        }
+        e_blk &= ~__BCACHE_RA_FLAG;
+        if ((e_blk >= first) && (e_blk <= last)) {
+            p_cache->p_entry[i].blk = __BCACHE_BLK_NONE;
+            __bcache_lru_set(p_cache, i);
+            p_cache->stat.invalidates++;
+        }
+    }
+
+    /* the data changed, restart the sequential detection */
+    p_cache->next_blk = __BCACHE_BLK_NONE;
+}
+
+/******************************************************************************/
+
+/*
+ * Read the missed block blk (and the following missed blocks of the request,
+ * and the read ahead blocks) to the cache with one device read, the demand
+ * blocks are copied to p_buf
+ *
+ * return the number of demand blocks
+ */
+static int __bcache_fill (am_bcache_t *p_cache,
+                          uint32_t     blk,
+                          uint32_t     end_blk,
+                          uint8_t     *p_buf,
+                          uint32_t     off,
+                          uint32_t     len)
+{
+    am_mtd_iovec_t iov[__BCACHE_IOV_MAX];
+    uint16_t       idx[__BCACHE_IOV_MAX];
+    uint32_t       bs      = p_cache->p_info->blk_size;
+    uint32_t       max     = p_cache->nblks / 2;
+    uint32_t       ra_max  = 0;
+    uint32_t       k       = 1;
+    uint32_t       ra      = 0;
+    uint32_t       n;
+    uint32_t       i;
+    int            ret;
+
+    if (max > __BCACHE_IOV_MAX) {
+        max = __BCACHE_IOV_MAX;
+    }
+    if (max == 0) {
+        max = 1;
+    }
+
+    /* the following missed blocks of the request */
+    while ((k < max) && (blk + k <= end_blk) &&
+           (__bcache_find(p_cache, blk + k) < 0)) {
+        k++;
+    }
+
+    /* sequential read, read ahead */
+    if (blk == p_cache->next_blk) {
+        ra_max = p_cache->p_info->ra_blks;
+    }
+
+    while ((ra < ra_max) && (k + ra < max) &&
+           ((blk + k + ra) * bs < p_cache->size) &&
+           (__bcache_find(p_cache, blk + k + ra) < 0)) {
+        ra++;
+    }
+
+    for (i = 0; i < k + ra; i++) {
+        idx[i] = p_cache->lru;
+
+        p_cache->p_entry[idx[i]].blk = (i < k) ? (blk + i) :
+                                                 ((blk + i) | __BCACHE_RA_FLAG);
+        __bcache_mru_set(p_cache, idx[i]);
+
+        n = p_cache->size - (blk + i) * bs;
+
+        iov[i].p_buf = __BCACHE_DATA(p_cache, idx[i]);
+        iov[i].len   = (n < bs) ? n : bs;
+    }
+
+    ret = p_cache->pfn_readv(p_cache, blk * bs, iov, k + ra);
+
+    if (ret < 0) {
+        for (i = 0; i < k + ra; i++) {
+            p_cache->p_entry[idx[i]].blk = __BCACHE_BLK_NONE;
+            __bcache_lru_set(p_cache, idx[i]);
+        }
+        return ret;
+    }
+
+    p_cache->stat.misses  += k;
+    p_cache->stat.ra_blks += ra;
+
+    /* copy the demand blocks */
+    for (i = 0; (i < k) && (len != 0); i++) {
+        n = bs - off;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(p_buf, __BCACHE_DATA(p_cache, idx[i]) + off, n);
+        p_buf += n;
+        len   -= n;
+        off    = 0;
+    }
+
+    return k;
+}
+
+/******************************************************************************/
+static int __bcache_read (am_bcache_t *p_cache,
+                          uint32_t     addr,
+                          uint8_t     *p_buf,
+                          uint32_t     len)
+{
+    am_mtd_iovec_t iov;
+    uint32_t       bs = p_cache->p_info->blk_size;
+    uint32_t       blk;
+    uint32_t       end_blk;
+    uint32_t       off;
+    uint32_t       n;
+    int            idx;
+    int            ret;
+
+    if (len == 0) {
+        return AM_OK;
+    }
+
+    if ((addr > p_cache->size) || (len > p_cache->size - addr)) {
+        return -AM_EINVAL;
+    }
+
+    end_blk = (addr + len - 1) / bs;
+
+    /* large read, don't pollute the cache */
+    if (len >= (p_cache->nblks / 2 + 1) * bs) {
+        iov.p_buf = p_buf;
+        iov.len   = len;
+
+        ret = p_cache->pfn_readv(p_cache, addr, &iov, 1);
+        if (ret < 0) {
+            return ret;
+        }
+
+        p_cache->next_blk = end_blk + 1;
+        return AM_OK;
+    }
+
+    while (len) {
+
+        blk = addr / bs;
+        off = addr % bs;
+        idx = __bcache_find(p_cache, blk);
+
+        if (idx >= 0) {
+            n = bs - off;
+            if (n > len) {
+                n = len;
+            }
+
+            if (p_cache->p_entry[idx].blk & __BCACHE_RA_FLAG) {
+                p_cache->p_entry[idx].blk &= ~__BCACHE_RA_FLAG;
+                p_cache->stat.ra_hits++;
+            }
+            p_cache->stat.hits++;
+
+            __bcache_mru_set(p_cache, idx);
+            memcpy(p_buf, __BCACHE_DATA(p_cache, idx) + off, n);
+
+        } else {
+            ret = __bcache_fill(p_cache, blk, end_blk, p_buf, off, len);
+            if (ret < 0) {
+                return ret;
+            }
+
+            /* the demand blocks have been copied */
+            n = (blk + ret) * bs - addr;
+            if (n > len) {
+                n = len;
+            }
+        }
+
+        addr  += n;
+        p_buf += n;
+        len   -= n;
+    }
+
+    p_cache->next_blk = end_blk + 1;
+
+    return AM_OK;
+}
+
+/******************************************************************************/
+static int __bcache_init (am_bcache_t            *p_cache,
+                          const am_bcache_info_t *p_info,
+                          uint32_t                size)
+{
+    uint32_t nblks;
+    uint32_t i;
+
+    if ((p_cache == NULL) || (p_info == NULL) || (p_info->p_buf == NULL) ||
+        (p_info->blk_size == 0) || (size == 0)) {
+        return -AM_EINVAL;
+    }
+
+    nblks = p_info->len / AM_BCACHE_RAM_SIZE_GET(1, p_info->blk_size);
+
+    if (nblks == 0) {
+        return -AM_EINVAL;
+    }
+
+    /* 0xFFFF is used as the end of list */
+    if (nblks > 0xFFFE) {
+        nblks = 0xFFFE;
+    }
+
+    p_cache->p_info   = p_info;
+    p_cache->nblks    = nblks;
+    p_cache->blk_size = AM_ROUND_UP(p_info->blk_size, 4);
+    p_cache->p_entry  = (struct am_bcache_entry *)p_info->p_buf;
+    p_cache->p_data   = p_info->p_buf + nblks * sizeof(struct am_bcache_entry);
+    p_cache->size     = size;
+    p_cache->next_blk = __BCACHE_BLK_NONE;
+    p_cache->mru      = 0;
+    p_cache->lru      = nblks - 1;
+
+    for (i = 0; i < nblks; i++) {
+        p_cache->p_entry[i].blk  = __BCACHE_BLK_NONE;
+        p_cache->p_entry[i].prev = (i == 0)         ? __BCACHE_NIL : (i - 1);
+        p_cache->p_entry[i].next = (i == nblks - 1) ? __BCACHE_NIL : (i + 1);
+    }
+
+    memset(&p_cache->stat, 0, sizeof(p_cache->stat));
+
+    return AM_OK;
+}
+
+/*******************************************************************************
+    MTD device
+*******************************************************************************/
+
+static int __bcache_mtd_readv_dev (am_bcache_t          *p_cache,
+                                   uint32_t              addr,
+                                   const am_mtd_iovec_t *p_iov,
+                                   int                   iovcnt)
+{
+    /* the device without scatter read does one read per buffer */
+    p_cache->stat.dev_reads += p_cache->mtd->p_ops->pfn_mtd_readv ? 1 : iovcnt;
+
+    return am_mtd_readv(p_cache->mtd, addr, p_iov, iovcnt);
+}
+
+/******************************************************************************/
+static int __bcache_mtd_erase (void *p_drv, struct am_mtd_erase_info *p_info)
+{
+    am_bcache_t *p_cache = (am_bcache_t *)p_drv;
+
+    __bcache_invalidate(p_cache, p_info->addr, p_info->len);
+
+    return p_cache->mtd->p_ops->pfn_mtd_erase(p_cache->mtd->p_drv, p_info);
+}
+
+/******************************************************************************/
+static int __bcache_mtd_read (void      *p_drv,
+                              uint32_t   addr,
+                              void      *p_buf,
+                              uint32_t   len)
+{
+    int ret = __bcache_read((am_bcache_t *)p_drv, addr, (uint8_t *)p_buf, len);
+
+    return (ret < 0) ? ret : (int)len;
+}
+
+/******************************************************************************/
+static int __bcache_mtd_write (void       *p_drv,
+                               uint32_t    addr,
+                               const void *p_buf,
+                               uint32_t    len)
+{
+    am_bcache_t *p_cache = (am_bcache_t *)p_drv;
+
+    __bcache_invalidate(p_cache, addr, len);
+
+    return am_mtd_write(p_cache->mtd, addr, p_buf, len);
+}
+
+/******************************************************************************/
+static int __bcache_mtd_readv (void                 *p_drv,
+                               uint32_t              addr,
+                               const am_mtd_iovec_t *p_iov,
+                               int                   iovcnt)
+{
+    uint32_t nbytes = 0;
+    int      ret;
+    int      i;
+
+    for (i = 0; i < iovcnt; i++) {
+        ret = __bcache_read((am_bcache_t *)p_drv,
+                             addr,
+                            (uint8_t *)p_iov[i].p_buf,
+                             p_iov[i].len);
+        if (ret < 0) {
+            return ret;
+        }
+        addr   += p_iov[i].len;
+        nbytes += p_iov[i].len;
+    }
+
+    return nbytes;
+}
+
+/******************************************************************************/
+static int __bcache_mtd_writev (void                 *p_drv,
+                                uint32_t              addr,
+                                const am_mtd_iovec_t *p_iov,
+                                int                   iovcnt)
+{
+    am_bcache_t *p_cache = (am_bcache_t *)p_drv;
+
+    uint32_t len = 0;
+    int      i;
+
+    for (i = 0; i < iovcnt; i++) {
+        len += p_iov[i].len;
+    }
+
+    __bcache_invalidate(p_cache, addr, len);
+
+    return am_mtd_writev(p_cache->mtd, addr, p_iov, iovcnt);
+}
+
+/******************************************************************************/
+static const struct am_mtd_ops __g_bcache_mtd_ops = {
+    __bcache_mtd_erase,       /* mtd_erase */
+    __bcache_mtd_read,        /* mtd_read */
+    __bcache_mtd_write,       /* mtd_write */
+    __bcache_mtd_readv,       /* mtd_readv */
+    __bcache_mtd_writev,      /* mtd_writev */
+};
+
+/*******************************************************************************
+    NVRAM device
+*******************************************************************************/
+
+static int __bcache_nvram_readv_dev (am_bcache_t          *p_cache,
+                                     uint32_t              addr,
+                                     const am_mtd_iovec_t *p_iov,
+                                     int                   iovcnt)
+{
+    am_nvram_dev_t *p_lower = p_cache->p_nvram;
+
+    uint8_t  *p_buf = NULL;
+    uint32_t  len   = 0;
+    int       ret;
+    int       i;
+
+    /* the buffers adjacent in RAM are read at once */
+    for (i = 0; i <= iovcnt; i++) {
+
+        if ((i < iovcnt) && (len != 0) && (p_buf + len == p_iov[i].p_buf)) {
+            len += p_iov[i].len;
+            continue;
+        }
+
+        if (len != 0) {
+            p_cache->stat.dev_reads++;
+
+            ret = p_lower->p_funcs->pfn_nvram_get(p_lower->p_drv,
+                                                  addr,
+                                                  p_buf,
+                                                  len);
+            if (ret < 0) {
+                return ret;
+            }
+            addr += len;
+        }
+
+        if (i < iovcnt) {
+            p_buf = (uint8_t *)p_iov[i].p_buf;
+            len   = p_iov[i].len;
+        }
+    }
+
+    return AM_OK;
+}
+
+/******************************************************************************/
+static int __bcache_nvram_get (void     *p_drv,
+                               int       offset,
+                               uint8_t  *p_buf,
+                               int       len)
+{
+    if ((offset < 0) || (len < 0)) {
+        return -AM_EINVAL;
+    }
+
+    return __bcache_read((am_bcache_t *)p_drv, offset, p_buf, len);
+}
+
+/******************************************************************************/
+static int __bcache_nvram_set (void     *p_drv,
+                               int       offset,
+                               uint8_t  *p_buf,
+                               int       len)
+{
+    am_bcache_t    *p_cache = (am_bcache_t *)p_drv;
+    am_nvram_dev_t *p_lower = p_cache->p_nvram;
+
+    if ((offset < 0) || (len < 0)) {
+        return -AM_EINVAL;
+    }
+
+    __bcache_invalidate(p_cache, offset, len);
+
+    return p_lower->p_funcs->pfn_nvram_set(p_lower->p_drv, offset, p_buf, len);
+}
+
+/******************************************************************************/
+static const struct am_nvram_drv_funcs __g_bcache_nvram_funcs = {
+    __bcache_nvram_get,
+    __bcache_nvram_set
+};
+
+/*******************************************************************************
+    Public functions
+*******************************************************************************/
+
+am_mtd_handle_t am_bcache_mtd_init (am_bcache_t            *p_cache,
+                                    const am_bcache_info_t *p_info,
+                                    am_mtd_handle_t         mtd,
+                                    am_mtd_serv_t          *p_mtd)
+{
+    if ((mtd == NULL) || (p_mtd == NULL)) {
+        return NULL;
+    }
+
+    if (__bcache_init(p_cache, p_info, mtd->size) != AM_OK) {
+        return NULL;
+    }
+
+    p_cache->mtd       = mtd;
+    p_cache->p_nvram   = NULL;
+    p_cache->pfn_readv = __bcache_mtd_readv_dev;
+
+    p_mtd->p_ops          = &__g_bcache_mtd_ops;
+    p_mtd->p_drv          = (void *)p_cache;
+    p_mtd->type           = mtd->type;
+    p_mtd->flags          = mtd->flags;
+    p_mtd->size           = mtd->size;
+    p_mtd->erase_size     = mtd->erase_size;
+    p_mtd->write_size     = mtd->write_size;
+    p_mtd->write_buf_size = mtd->write_buf_size;
+
+    return p_mtd;
+}
+
+/******************************************************************************/
+int am_bcache_nvram_init (am_bcache_t            *p_cache,
+                          const am_bcache_info_t *p_info,
+                          am_nvram_dev_t         *p_lower,
+                          uint32_t                size,
+                          am_nvram_dev_t         *p_dev,
+                          const char             *p_dev_name)
+{
+    int ret;
+
+    if ((p_lower == NULL) || (p_lower->p_funcs == NULL) || (p_dev == NULL)) {
+        return -AM_EINVAL;
+    }
+
+    ret = __bcache_init(p_cache, p_info, size);
+
+    if (ret != AM_OK) {
+        return ret;
+    }
+
+    p_cache->mtd       = NULL;
+    p_cache->p_nvram   = p_lower;
+    p_cache->pfn_readv = __bcache_nvram_readv_dev;
+
+    p_dev->p_next     = NULL;
+    p_dev->p_funcs    = &__g_bcache_nvram_funcs;
+    p_dev->p_drv      = (void *)p_cache;
+    p_dev->p_dev_name = p_dev_name;
+
+    return am_nvram_dev_register(p_dev);
+}
+
+/******************************************************************************/
+void am_bcache_invalidate_all (am_bcache_t *p_cache)
+{
+    if (p_cache == NULL) {
+        return;
+    }
+
+    __bcache_invalidate(p_cache, 0, p_cache->size);
+}
+
+/******************************************************************************/
+int am_bcache_stat_get (am_bcache_t *p_cache, am_bcache_stat_t *p_stat)
+{
+    if ((p_cache == NULL) || (p_stat == NULL)) {
+        return -AM_EINVAL;
+    }
+
+    *p_stat = p_cache->stat;
+
+    return AM_OK;
+}
+
+/* end of file */
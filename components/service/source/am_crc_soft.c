@@ -175,6 +175,111 @@ static int __crc_soft_cal_32_ref (void *p_drv, const uint8_t *p_data, uint32_t n
     return AM_OK;
 }
 
+/******************************************************************************/
+
+/* Сˣrefin = TRUEˣrefin = FALSE˳ȡ4ֽڣڲʹã */
+#define __CRC_LE32(p)  ((uint32_t)(p)[0]         | ((uint32_t)(p)[1] << 8) | \
+                       ((uint32_t)(p)[2] << 16) | ((uint32_t)(p)[3] << 24))
+
+#define __CRC_BE32(p)  (((uint32_t)(p)[0] << 24) | ((uint32_t)(p)[1] << 16) | \
+                        ((uint32_t)(p)[2] << 8)  |  (uint32_t)(p)[3])
+
+/*
+ * ּĹ֣T Ϊӱ͡
+ *
+ * ʱǰCRCֵ뵽32λĸλ4ֽݣˣ32λ
+ * ֵÿֽڷֱӦӱʱCRCֵλ룬ֱ4ֽ
+ * Сˣ򼴿ɡslices Ϊ 8 ʱÿδֽֽ֣ڴ
+ */
+#define __CRC_SOFT_CAL_SLICE(T, ref)                                           \
+    am_crc_soft_t *p_crc   = (am_crc_soft_t *)p_drv;                           \
+    uint8_t        width   = p_crc->p_pattern->width;                          \
+    uint32_t       crc     = p_crc->value;                                     \
+    const T       *t       = (const T *)(p_crc->p_table->p_data);              \
+    uint32_t       a, b;                                                       \
+                                                                               \
+    if (p_crc->p_table->slices == 8) {                                         \
+        while (nbytes >= 8) {                                                  \
+            if (ref) {                                                         \
+                a   = crc ^ __CRC_LE32(p_data);                                \
+                b   = __CRC_LE32(p_data + 4);                                  \
+                crc = t[0x700 + (a & 0xff)] ^ t[0x600 + ((a >> 8) & 0xff)] ^   \
+                      t[0x500 + ((a >> 16) & 0xff)] ^ t[0x400 + (a >> 24)] ^   \
+                      t[0x300 + (b & 0xff)] ^ t[0x200 + ((b >> 8) & 0xff)] ^   \
+                      t[0x100 + ((b >> 16) & 0xff)] ^ t[b >> 24];              \
+            } else {                                                           \
+                a   = (crc << (32 - width)) ^ __CRC_BE32(p_data);              \
+                b   = __CRC_BE32(p_data + 4);                                  \
+                crc = t[0x700 + (a >> 24)] ^ t[0x600 + ((a >> 16) & 0xff)] ^   \
+                      t[0x500 + ((a >> 8) & 0xff)] ^ t[0x400 + (a & 0xff)] ^   \
+                      t[0x300 + (b >> 24)] ^ t[0x200 + ((b >> 16) & 0xff)] ^   \
+                      t[0x100 + ((b >> 8) & 0xff)] ^ t[b & 0xff];              \
+            }                                                                  \
+            p_data += 8;                                                       \
+            nbytes -= 8;                                                       \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    while (nbytes >= 4) {                                                      \
+        if (ref) {                                                             \
+            a   = crc ^ __CRC_LE32(p_data);                                    \
+            crc = t[0x300 + (a & 0xff)] ^ t[0x200 + ((a >> 8) & 0xff)] ^       \
+                  t[0x100 + ((a >> 16) & 0xff)] ^ t[a >> 24];                  \
+        } else {                                                               \
+            a   = (crc << (32 - width)) ^ __CRC_BE32(p_data);                  \
+            crc = t[0x300 + (a >> 24)] ^ t[0x200 + ((a >> 16) & 0xff)] ^       \
+                  t[0x100 + ((a >> 8) & 0xff)] ^ t[a & 0xff];                  \
+        }                                                                      \
+        p_data += 4;                                                           \
+        nbytes -= 4;                                                           \
+    }                                                                          \
+                                                                               \
+    while (nbytes) {                                                           \
+        if (ref) {                                                             \
+            crc = (crc >> 8) ^ t[(crc ^ *p_data++) & 0xff];                    \
+        } else {                                                               \
+            crc = (crc << 8) ^ t[((crc >> (width - 8)) ^ *p_data++) & 0xff];   \
+            crc &= ((((1ul << (width - 1)) - 1) << 1) | 1);                    \
+        }                                                                      \
+        nbytes--;                                                              \
+    }                                                                          \
+                                                                               \
+    p_crc->value = crc;                                                        \
+                                                                               \
+    return AM_OK;
+
+/* CRC 16λּ */
+static int __crc_soft_cal_16_slice (void          *p_drv,
+                                    const uint8_t *p_data,
+                                    uint32_t       nbytes)
+{
+    __CRC_SOFT_CAL_SLICE(uint16_t, 0)
+}
+
+/* CRC 16λREFּ */
+static int __crc_soft_cal_16_ref_slice (void          *p_drv,
+                                        const uint8_t *p_data,
+                                        uint32_t       nbytes)
+{
+    __CRC_SOFT_CAL_SLICE(uint16_t, 1)
+}
+
+/* CRC 32λּ */
+static int __crc_soft_cal_32_slice (void          *p_drv,
+                                    const uint8_t *p_data,
+                                    uint32_t       nbytes)
+{
+    __CRC_SOFT_CAL_SLICE(uint32_t, 0)
+}
+
+/* CRC 32λREFּ */
+static int __crc_soft_cal_32_ref_slice (void          *p_drv,
+                                        const uint8_t *p_data,
+                                        uint32_t       nbytes)
+{
+    __CRC_SOFT_CAL_SLICE(uint32_t, 1)
+}
+
 /******************************************************************************/
 static int __crc_soft_init (void *p_drv, am_crc_pattern_t *p_pattern)
 {
@@ -279,6 +384,34 @@ static const struct am_crc_drv_funcs  __g_crc_soft_drv_funcs_32_ref = {
     __crc_soft_final
 };
 
+/******************************************************************************/
+static const struct am_crc_drv_funcs  __g_crc_soft_drv_funcs_16_slice = {
+    __crc_soft_init,
+    __crc_soft_cal_16_slice,
+    __crc_soft_final
+};
+
+/******************************************************************************/
+static const struct am_crc_drv_funcs  __g_crc_soft_drv_funcs_16_ref_slice = {
+    __crc_soft_init,
+    __crc_soft_cal_16_ref_slice,
+    __crc_soft_final
+};
+
+/******************************************************************************/
+static const struct am_crc_drv_funcs  __g_crc_soft_drv_funcs_32_slice = {
+    __crc_soft_init,
+    __crc_soft_cal_32_slice,
+    __crc_soft_final
+};
+
+/******************************************************************************/
+static const struct am_crc_drv_funcs  __g_crc_soft_drv_funcs_32_ref_slice = {
+    __crc_soft_init,
+    __crc_soft_cal_32_ref_slice,
+    __crc_soft_final
+};
+
 /*******************************************************************************
   Public functions
 *******************************************************************************/
@@ -300,9 +433,10 @@ int am_crc_table_create (am_crc_table_t  *p_table,
         return -AM_EINVAL;                                    /* ǷĿ     */
     }
 
-    p_table->width = width;
-    p_table->poly  = poly;
-    p_table->refin = refin;
+    p_table->width  = width;
+    p_table->poly   = poly;
+    p_table->refin  = refin;
+    p_table->slices = 1;
 
     /* CRC ȴ8ʱ  */
     if (width >= 8) {
@@ -382,6 +516,71 @@ int am_crc_table_create (am_crc_table_t  *p_table,
     return AM_OK;
 }
 
+/******************************************************************************/
+int am_crc_table_slice_create (am_crc_table_t  *p_table,
+                               uint8_t          width,
+                               uint32_t         poly,
+                               am_bool_t        refin,
+                               uint8_t          slices,
+                               void            *p_data)
+{
+    uint32_t bit_mask;
+    uint32_t data;
+    uint32_t i, k;
+    int      ret;
+
+    if ((width <= 8) || ((slices != 1) && (slices != 4) && (slices != 8))) {
+        return -AM_EINVAL;
+    }
+
+    /* 0ӱͨ */
+    ret = am_crc_table_create(p_table, width, poly, refin, p_data);
+    if (ret != AM_OK) {
+        return ret;
+    }
+
+    bit_mask = ((((1ul << (width - 1)) - 1) << 1) | 1);
+
+    /*  k ӱɵ k - 1 ӱֵٴһȫ0ֽڵõ */
+    for (k = 1; k < slices; k++) {
+        for (i = 0; i < 256; i++) {
+
+            if (width <= 16) {
+                data = ((uint16_t *)p_data)[(k - 1) * 256 + i];
+            } else {
+                data = ((uint32_t *)p_data)[(k - 1) * 256 + i];
+            }
+
+            if (refin == AM_TRUE) {
+                if (width <= 16) {
+                    data = (data >> 8) ^ ((uint16_t *)p_data)[data & 0xff];
+                } else {
+                    data = (data >> 8) ^ ((uint32_t *)p_data)[data & 0xff];
+                }
+            } else {
+                if (width <= 16) {
+                    data = (data << 8) ^
+                           ((uint16_t *)p_data)[(data >> (width - 8)) & 0xff];
+                } else {
+                    data = (data << 8) ^
+                           ((uint32_t *)p_data)[(data >> (width - 8)) & 0xff];
+                }
+                data &= bit_mask;
+            }
+
+            if (width <= 16) {
+                ((uint16_t *)p_data)[k * 256 + i] = data;
+            } else {
+                ((uint32_t *)p_data)[k * 256 + i] = data;
+            }
+        }
+    }
+
+    p_table->slices = slices;
+
+    return AM_OK;
+}
+
 /******************************************************************************/
 am_crc_handle_t am_crc_soft_init (am_crc_soft_t         *p_crc,
                                   const am_crc_table_t  *p_table)
@@ -403,6 +602,16 @@ am_crc_handle_t am_crc_soft_init (am_crc_soft_t         *p_crc,
 
     if (p_table->width <= 8) {
         p_funcs = &__g_crc_soft_drv_funcs_8;
+    } else if (p_table->slices > 1) {
+
+        /* ӱּ */
+        if (p_table->width <= 16) {
+            p_funcs = p_table->refin ? &__g_crc_soft_drv_funcs_16_ref_slice :
+                                       &__g_crc_soft_drv_funcs_16_slice;
+        } else {
+            p_funcs = p_table->refin ? &__g_crc_soft_drv_funcs_32_ref_slice :
+                                       &__g_crc_soft_drv_funcs_32_slice;
+        }
     } else if (p_table->width <= 16) {
 
         if (p_table->refin) {
@@ -54,6 +54,9 @@ struct __ftl_bci {
     uint32_t      wear_info;      /* wear infomation */
 };
 
+/* the erase count is torn or can't be read, see AM_FTL_WEAR_MAX */
+#define __FTL_WEAR_INVALID      0xFFFFFFFE
+
 #define __FTL_SECTOR_STAT_START    0x11
 #define __FTL_SECTOR_STAT_DATA     0x22
 #define __FTL_SECTOR_STAT_DATA_DEL 0x00    /* deleted by user */
@@ -66,6 +69,21 @@ struct __ftl_sci {
     uint8_t  locgic_sec1;       /* logic sector         */
 };
 
+#define __FTL_CKPT_MAGIC      0x4b435446u
+
+/* Checkpoint header (28 bytes), followed by the eun table, free table and log */
+struct __ftl_ckpt_hdr {
+    uint32_t  magic;            /* magic num                              */
+    uint32_t  seq;              /* sequence number                        */
+    uint16_t  nb_blocks;        /* physical blocks                        */
+    uint16_t  last_free;        /* last used free block                   */
+    uint16_t  log_blocks;       /* log blocks                             */
+    uint16_t  sectors_per_blk;  /* sectors per block                      */
+    uint32_t  len;              /* length of the tables                   */
+    uint32_t  crc;              /* crc of the above fields and the tables */
+    uint32_t  stale;            /* cleared to 0 once the tables changed   */
+};
+
 /*******************************************************************************
     Local defines
 *******************************************************************************/
@@ -94,6 +112,20 @@ struct __ftl_sci {
  */
 #define __FTL_FOLD_MARK_IN_PROGRESS 0x5555
 
+/**
+ * Merge (gc) steps
+ */
+#define __FTL_GC_IDLE           0
+#define __FTL_GC_COPY_LOG       1
+#define __FTL_GC_COPY_DIRECT    2
+#define __FTL_GC_COMMIT         3
+#define __FTL_GC_ERASE_DIRECT   4
+#define __FTL_GC_ERASE_LOG      5
+#define __FTL_GC_DONE           6
+
+#define __FTL_GC_COPIED(p_ftl, sec) \
+    (((p_ftl)->gc_copied[(sec) >> 5] >> ((sec) & 0x1F)) & 0x01)
+
 #define __FTL_PHY_BLOCK_START_ADDR_GET(p_ftl, pbn) \
     ((pbn + p_ftl->p_info->reserved_blocks) *      \
      (AM_MTD_ERASE_UNIT_SIZE_GET(p_ftl->mtd)))
@@ -103,6 +135,14 @@ struct __ftl_sci {
 *******************************************************************************/
 static int __ftl_log_buf_victim_switch (am_ftl_serv_t  *p_ftl,
                                         struct log_buf *p_log);
+static int __ftl_ckpt_invalidate (am_ftl_serv_t *p_ftl);
+static int __ftl_merge_finish (am_ftl_serv_t *p_ftl);
+static void __ftl_gc_job (void *p_arg);
+static uint32_t __ftl_wear_max_get (am_ftl_serv_t *p_ftl, uint16_t pbn);
+static int __ftl_sci_range_read (am_ftl_serv_t *p_ftl,
+                                 uint16_t       pbn,
+                                 uint16_t       sec,
+                                 unsigned int   n);
 
 /*******************************************************************************
     The base utility fuctions
@@ -118,6 +158,17 @@ static int __ftl_memcmpb (void *a, int c, int n)
     return 0;
 }
 
+/* the erase count in the block info, 0 for a block never used */
+static uint32_t __ftl_bci_wear_get (const struct __ftl_bci *p_bci)
+{
+    if (p_bci->magic_num != __FTL_MAGIC_NUM) {
+        return 0;
+    }
+
+    return (p_bci->wear_info > AM_FTL_WEAR_MAX) ? __FTL_WEAR_INVALID :
+                                                  p_bci->wear_info;
+}
+
 /*******************************************************************************
     The MTD base handle fuctions
 *******************************************************************************/
@@ -136,9 +187,14 @@ static int __ftl_bci_read (am_ftl_serv_t    *p_ftl,
 
     ret = am_mtd_read(p_ftl->mtd, addr, p_bci, sizeof(struct __ftl_bci));
 
-    if (ret < sizeof(struct __ftl_bci)) {
+    if (ret < (int)sizeof(struct __ftl_bci)) {
         AM_DBG_INFO("ftl: __ftl_bci_read error, ret is: %d\n", ret);
-        return ret;
+        return (ret < 0) ? ret : -AM_EIO;
+    }
+
+    /* cache the wear info */
+    if (p_ftl->p_info->p_wear != NULL) {
+        p_ftl->p_info->p_wear[pbn] = __ftl_bci_wear_get(p_bci);
     }
 
     return 0;
@@ -155,13 +211,19 @@ static int __ftl_bci_write (am_ftl_serv_t    *p_ftl,
     int       ret = 0;
     uint32_t  addr;
 
+    /* the tables are going to change */
+    ret = __ftl_ckpt_invalidate(p_ftl);
+    if (ret < 0) {
+        return ret;
+    }
+
     addr = __FTL_PHY_BLOCK_START_ADDR_GET(p_ftl, pbn);
 
     ret = am_mtd_write(p_ftl->mtd, addr, p_bci, sizeof(struct __ftl_bci));
 
-    if (ret < sizeof(struct __ftl_bci)) {
+    if (ret < (int)sizeof(struct __ftl_bci)) {
         AM_DBG_INFO("ftl: __ftl_bci_write error, ret is: %d\n", ret);
-        return ret;
+        return (ret < 0) ? ret : -AM_EIO;
     }
 
     return 0;
@@ -186,9 +248,9 @@ static int __ftl_sci_read (am_ftl_serv_t    *p_ftl,
 
     ret = am_mtd_read(p_ftl->mtd, addr, p_sci, sizeof(struct __ftl_sci));
 
-    if (ret < sizeof(struct __ftl_sci)) {
+    if (ret < (int)sizeof(struct __ftl_sci)) {
         AM_DBG_INFO("ftl: __ftl_sci_read error, ret is: %d\n", ret);
-        return ret;
+        return (ret < 0) ? ret : -AM_EIO;
     }
 
     return 0;
@@ -212,9 +274,9 @@ static int __ftl_sci_write (am_ftl_serv_t    *p_ftl,
 
     ret = am_mtd_write(p_ftl->mtd, addr, p_sci, sizeof(struct __ftl_sci));
 
-    if (ret < sizeof(struct __ftl_sci)) {
+    if (ret < (int)sizeof(struct __ftl_sci)) {
         AM_DBG_INFO("ftl: __ftl_sci_write error, ret is: %d\n", ret);
-        return ret;
+        return (ret < 0) ? ret : -AM_EIO;
     }
 
     return 0;
@@ -263,22 +325,20 @@ static int __ftl_block_erase (am_ftl_serv_t     *p_ftl,
 {
     int                 ret;
     struct __ftl_bci    bci;
-    uint32_t            wear_info;
+    uint32_t            wear_info = __FTL_WEAR_INVALID;
 
     if (__ftl_bci_read(p_ftl, pbn, &bci) >= 0) {
+        wear_info = __ftl_bci_wear_get(&bci);
+    }
 
-        if (bci.magic_num != __FTL_MAGIC_NUM) {  /* first use */
-            bci.wear_info = 1;
-        } else {
-            bci.wear_info++;
-            /* wrap (almost impossible with current flash) or free block */
-            if (bci.wear_info == 0) {
-                bci.wear_info = 1;
-            }
-        }
+    /* the count is lost, assume it is the most worn block */
+    if (wear_info == __FTL_WEAR_INVALID) {
+        wear_info = __ftl_wear_max_get(p_ftl, pbn);
     }
 
-    wear_info = bci.wear_info;
+    if (wear_info < AM_FTL_WEAR_MAX) {
+        wear_info++;
+    }
 
     memset(&bci, 0xFF, sizeof(bci));
 
@@ -287,6 +347,12 @@ static int __ftl_block_erase (am_ftl_serv_t     *p_ftl,
 
     AM_DBG_INFO("Erase block : %d \n", pbn);
 
+    /* the tables are going to change */
+    ret = __ftl_ckpt_invalidate(p_ftl);
+    if (ret < 0) {
+        return ret;
+    }
+
     ret = am_mtd_erase(p_ftl->mtd,
                        __FTL_PHY_BLOCK_START_ADDR_GET(p_ftl, pbn),
                        AM_MTD_ERASE_UNIT_SIZE_GET(p_ftl->mtd));
@@ -295,9 +361,74 @@ static int __ftl_block_erase (am_ftl_serv_t     *p_ftl,
         return ret;
     }
 
+    p_ftl->wl_erases++;
+
+    if (p_ftl->p_info->p_wear != NULL) {
+        p_ftl->p_info->p_wear[pbn] = wear_info;
+    }
+
     return __ftl_bci_write(p_ftl, pbn, &bci);
 }
 
+/******************************************************************************/
+
+/* read the erase count of a block */
+static int __ftl_wear_read (am_ftl_serv_t *p_ftl,
+                            uint16_t       pbn,
+                            uint32_t      *p_count)
+{
+    struct __ftl_bci  bci;
+    uint32_t         *p_wear = p_ftl->p_info->p_wear;
+    int               ret;
+
+    if ((p_wear != NULL) && (p_wear[pbn] != 0xFFFFFFFF)) {
+        *p_count = p_wear[pbn];
+        return 0;
+    }
+
+    ret = __ftl_bci_read(p_ftl, pbn, &bci);
+    if (ret < 0) {
+        return ret;
+    }
+
+    *p_count = __ftl_bci_wear_get(&bci);
+
+    return 0;
+}
+
+/******************************************************************************/
+
+/* get the erase count of a block, __FTL_WEAR_INVALID if it's unknown */
+static uint32_t __ftl_wear_get (am_ftl_serv_t *p_ftl, uint16_t pbn)
+{
+    uint32_t count;
+
+    if (__ftl_wear_read(p_ftl, pbn, &count) < 0) {
+        return __FTL_WEAR_INVALID;
+    }
+
+    return count;
+}
+
+/******************************************************************************/
+
+/* the largest valid erase count of the other blocks */
+static uint32_t __ftl_wear_max_get (am_ftl_serv_t *p_ftl, uint16_t pbn)
+{
+    uint32_t     wear;
+    uint32_t     wear_max = 0;
+    unsigned int i;
+
+    for (i = 0; i < p_ftl->nb_blocks; i++) {
+        wear = (i == pbn) ? __FTL_WEAR_INVALID : __ftl_wear_get(p_ftl, i);
+        if ((wear != __FTL_WEAR_INVALID) && (wear > wear_max)) {
+            wear_max = wear;
+        }
+    }
+
+    return wear_max;
+}
+
 /*******************************************************************************
     free block manage
 *******************************************************************************/
@@ -356,6 +487,89 @@ static int __free_block_next_get (am_ftl_serv_t *p_ftl, uint16_t pbn)
     return -1;
 }
 
+/*******************************************************************************
+    L2P cache manage
+*******************************************************************************/
+
+/* invalidate all entries */
+static void __ftl_l2p_init (am_ftl_serv_t *p_ftl)
+{
+    if (p_ftl->p_info->p_l2p != NULL) {
+        memset(p_ftl->p_info->p_l2p,
+               0xFF,
+               sizeof(am_ftl_l2p_t) * p_ftl->p_info->l2p_num);
+    }
+}
+
+/******************************************************************************/
+
+/* look up the physical location of a lbn, return 0 if hit */
+static int __ftl_l2p_get (am_ftl_serv_t *p_ftl,
+                          unsigned       lbn,
+                          uint16_t      *p_pbn,
+                          uint16_t      *p_sec)
+{
+    am_ftl_l2p_t *p_l2p = p_ftl->p_info->p_l2p;
+
+    if (p_l2p == NULL) {
+        return -1;
+    }
+
+    p_l2p = &p_l2p[lbn % p_ftl->p_info->l2p_num];
+
+    if (p_l2p->lbn != lbn) {
+        return -1;
+    }
+
+    *p_pbn = p_l2p->pbn;
+    *p_sec = p_l2p->sec;
+
+    return 0;
+}
+
+/******************************************************************************/
+
+/* the lbn has been written to (pbn, sec) */
+static void __ftl_l2p_set (am_ftl_serv_t *p_ftl,
+                           unsigned       lbn,
+                           uint16_t       pbn,
+                           uint16_t       sec)
+{
+    am_ftl_l2p_t *p_l2p = p_ftl->p_info->p_l2p;
+
+    if (p_l2p == NULL) {
+        return;
+    }
+
+    p_l2p = &p_l2p[lbn % p_ftl->p_info->l2p_num];
+
+    p_l2p->lbn = lbn;
+    p_l2p->pbn = pbn;
+    p_l2p->sec = sec;
+}
+
+/******************************************************************************/
+
+/* all sectors of the logic block have been moved, drop them */
+static void __ftl_l2p_vuc_invalidate (am_ftl_serv_t *p_ftl, uint16_t vuc)
+{
+    am_ftl_l2p_t *p_l2p = p_ftl->p_info->p_l2p;
+    unsigned int  lbn;
+    unsigned int  i;
+
+    if (p_l2p == NULL) {
+        return;
+    }
+
+    lbn = vuc * p_ftl->sectors_per_blk;
+
+    for (i = 0; i < p_ftl->sectors_per_blk; i++, lbn++) {
+        if (p_l2p[lbn % p_ftl->p_info->l2p_num].lbn == lbn) {
+            p_l2p[lbn % p_ftl->p_info->l2p_num].lbn = 0xFFFFFFFF;
+        }
+    }
+}
+
 /******************************************************************************/
 static int __ftl_mem_init (am_ftl_serv_t          *p_ftl,
                            uint8_t                *p_buf,
@@ -430,10 +644,12 @@ static int __ftl_init (am_ftl_serv_t *p_ftl)
     p_ftl->max_lbn         = ((p_ftl->nb_blocks
                                - 1
                                - p_info->reserved_blocks
+                               - p_info->ckpt_blocks
                                - p_info->nb_log_blocks)
                               * p_ftl->sectors_per_blk) - 1;
 
-    p_ftl->nb_blocks       -= p_info->reserved_blocks;
+    /* the checkpoint blocks are at the end */
+    p_ftl->nb_blocks       -= p_info->reserved_blocks + p_info->ckpt_blocks;
 
 
     AM_DBG_INFO("The sectors hdr is %d \n", p_ftl->sectors_hdr);
@@ -447,6 +663,25 @@ static int __ftl_init (am_ftl_serv_t *p_ftl)
         return -1;
     }
 
+    p_ftl->ckpt_seq   = 0;
+    p_ftl->ckpt_addr  = 0xFFFFFFFF;
+    p_ftl->ckpt_next  = 0xFFFFFFFF;
+    p_ftl->ckpt_valid = AM_FALSE;
+
+    p_ftl->gc_state   = __FTL_GC_IDLE;
+    p_ftl->gc_lbn     = 0xFFFF;
+    p_ftl->gc_hot_lbn = 0xFFFF;
+    p_ftl->gc_p_log   = NULL;
+    p_ftl->gc_jobq    = NULL;
+    p_ftl->wl_erases  = 0;
+
+    /* the wear info is unknown until read */
+    if (p_info->p_wear != NULL) {
+        memset(p_info->p_wear, 0xFF, sizeof(uint32_t) * p_ftl->nb_blocks);
+    }
+
+    am_jobq_job_init(&p_ftl->gc_job, __ftl_gc_job, p_ftl, 0);
+
     return 0;
 }
 
@@ -454,6 +689,7 @@ static int __ftl_init (am_ftl_serv_t *p_ftl)
 static int __ftl_log_block_process (am_ftl_serv_t *p_ftl)
 {
     int               i,j;
+    int               ret;
     size_t            log_blocks = p_ftl->p_info->nb_log_blocks;
 
     for (i = 0; i < log_blocks; i++) {
@@ -469,7 +705,10 @@ static int __ftl_log_block_process (am_ftl_serv_t *p_ftl)
             }
 
             if (j == p_ftl->sectors_per_blk) {
-                __ftl_log_buf_victim_switch(p_ftl, &p_ftl->p_log_buf[i]);
+                ret = __ftl_log_buf_victim_switch(p_ftl, &p_ftl->p_log_buf[i]);
+                if (ret < 0) {
+                    return ret;
+                }
             }
         }
     }
@@ -525,6 +764,8 @@ static int __ftl_copy_block_process (am_ftl_serv_t *p_ftl, uint16_t copy_block)
 
     p_ftl->p_eun_table[bci.lbn1] = copy_block;  /* new relationship */
 
+    __ftl_l2p_vuc_invalidate(p_ftl, bci.lbn1);
+
     return 0;
 }
 
@@ -536,6 +777,11 @@ static int __ftl_free_update (uint16_t *p_free_now,
                               uint16_t  new_pbn,
                               uint32_t  wear_new)
 {
+    /* the torn count is not a less erase block */
+    if (wear_new > AM_FTL_WEAR_MAX) {
+        return 0;
+    }
+
     if (*p_wear_min > wear_new) {   /* find a less erase block */
         *p_free_now = new_pbn;
         *p_wear_min = wear_new;
@@ -558,145 +804,534 @@ static int __ftl_erase_at_mount (am_ftl_serv_t *p_ftl,
 }
 
 /******************************************************************************/
-static int __nfl_mount (am_ftl_serv_t *p_ftl)
-{
-    unsigned int i,j,k;
-    unsigned int log_num  = 0;
-    unsigned int sec_used = 0;
 
-    size_t   log_blocks = p_ftl->p_info->nb_log_blocks;
-    uint16_t max_lbn    = p_ftl->nb_blocks - log_blocks - 1;
+/* rebuild the sector map of a log buffer, return the used sectors */
+static unsigned int __ftl_log_buf_scan (am_ftl_serv_t  *p_ftl,
+                                        uint16_t        pbn,
+                                        struct log_buf *p_log)
+{
+    unsigned int      j, k, n;
+    unsigned int      sec_used = 0;
+    unsigned int      max = p_ftl->p_info->logic_blk_size /
+                            sizeof(struct __ftl_sci);
+    struct __ftl_sci *p_sci = (struct __ftl_sci *)p_ftl->p_wr_buf;
 
+    /*
+     * a write that failed before programming its tag leaves a free sector
+     * between used ones, the sectors after the last used one are free. the
+     * tags are read as many as the buffer holds at a time
+     */
+    for (j = 0; j < p_ftl->sectors_per_blk; j += n) {
 
-    uint16_t copy_block = 0xFFFF;
-    uint32_t wear_min   = 0xFFFFFFFF;
+        n = p_ftl->sectors_per_blk - j;
+        if (n > max) {
+            n = max;
+        }
 
-    struct __ftl_bci  bci;
-    struct __ftl_sci  sci;
+        if (__ftl_sci_range_read(p_ftl, pbn, j, n) < 0) {
+            memset(&p_log->p_map[j], 0xFF, n);
+            sec_used = j + n;             /* don't write them again */
+            continue;
+        }
 
-    /* after init, all block mask as free block */
-    __free_block_init(p_ftl);
+        for (k = 0; k < n; k++) {
 
-    p_ftl->last_free = 0;
+            p_log->p_map[j + k] = 0xFF;
 
-    for (i = 0; i < log_blocks; i++) {
-        p_ftl->p_log_buf[i].lbn  = 0xFFFF;
-        p_ftl->p_log_buf[i].pbn  = 0xFFFF;
-        p_ftl->p_log_buf[i].used = 0;
-        memset(p_ftl->p_log_buf[i].p_map, 0xFF, p_ftl->sectors_per_blk);
+            if (__ftl_memcmpb(&p_sci[k], 0xFF, sizeof(p_sci[k])) == 0) {
+                continue;
+            }
 
+            /* the data is valid, otherwise the sector data should be ignore */
+            if ((p_sci[k].stat_data   == __FTL_SECTOR_STAT_DATA) &&
+                (p_sci[k].locgic_sec0 == p_sci[k].locgic_sec1)) {
+                p_log->p_map[j + k] = p_sci[k].locgic_sec0;
+            }
+            sec_used = j + k + 1;
+        }
     }
 
-    /* init the logical to physical table */
-    for (i = 0; i < p_ftl->nb_blocks; i++) {
-        p_ftl->p_eun_table[i] = __FTL_BLOCK_NIL;
-    }
+    return sec_used;
+}
 
-    for (i = 0; i < p_ftl->nb_blocks; i++) {
+/*******************************************************************************
+    Checkpoint
+*******************************************************************************/
 
-        if (__ftl_bci_read(p_ftl, i, &bci) < 0) {
-            __free_block_set(p_ftl, i, 0);    /* mask it as not free */
-        }
+/* crc32 (poly 0x04c11db7, reflected), 4 bits per step to keep the table small */
+static uint32_t __ftl_crc32 (uint32_t crc, const void *p_data, size_t len)
+{
+    static const uint32_t table[16] = {
+        0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac,
+        0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+        0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c,
+        0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c,
+    };
 
-        if (bci.magic_num != __FTL_MAGIC_NUM) {
-            __ftl_erase_at_mount(p_ftl, i, &wear_min, 0);
-            continue;
-        }
+    const uint8_t *p = (const uint8_t *)p_data;
 
-        /* power failed, erase the block */
-        if ((bci.lbn1  != bci.lbn2) ||
-            ((bci.lbn1 != 0xFFFF) && (bci.lbn1 > max_lbn))) {
-            __ftl_erase_at_mount(p_ftl, i, &wear_min, bci.wear_info);
-            continue;
-        }
+    while (len--) {
+        crc ^= *p++;
+        crc  = (crc >> 4) ^ table[crc & 0x0F];
+        crc  = (crc >> 4) ^ table[crc & 0x0F];
+    }
 
-        /* power failed while try to set it as a log buffer */
-        if ((bci.type_log != __FTL_BLOCK_TYPE_LOG) &&
-            (bci.type_log != 0xFF)) {
-            __ftl_erase_at_mount(p_ftl, i, &wear_min, bci.wear_info);
-            continue;
-        }
+    return crc;
+}
 
-        /* the block is a data buffer */
-        if (bci.type_data != 0xFF) {
+/******************************************************************************/
 
-            if (bci.lbn1 > max_lbn) {
-                __ftl_erase_at_mount(p_ftl, i, &wear_min, bci.wear_info);
-                continue;
-            } else {
+/* the length of the tables saved in a checkpoint */
+static uint32_t __ftl_ckpt_len_get (am_ftl_serv_t *p_ftl)
+{
+    return sizeof(uint16_t) * p_ftl->nb_blocks +
+           sizeof(uint32_t) * p_ftl->free_size +
+           sizeof(uint16_t) * 2 * p_ftl->p_info->nb_log_blocks;
+}
 
-                if (p_ftl->p_eun_table[bci.lbn1] != 0xFFFF) { 
+/******************************************************************************/
 
-                    AM_DBG_INFO("The lbn is already exist, just erase\n");
-                    __ftl_erase_at_mount(p_ftl, i, &wear_min, bci.wear_info);
-                    continue;
-                }
-                p_ftl->p_eun_table[bci.lbn1] = i;
-                __free_block_set(p_ftl, i, 0);       /* mask it as not free */
-            }
+/* the start address and the size of a checkpoint area */
+static uint32_t __ftl_ckpt_area_get (am_ftl_serv_t *p_ftl,
+                                     unsigned int   area,
+                                     uint32_t      *p_size)
+{
+    uint32_t erase_size = AM_MTD_ERASE_UNIT_SIZE_GET(p_ftl->mtd);
 
-        } else if (bci.type_log  == __FTL_BLOCK_TYPE_LOG) {
+    *p_size = p_ftl->p_info->ckpt_blocks / 2 * erase_size;
 
-            if (bci.lbn1 > max_lbn) {
-                __ftl_erase_at_mount(p_ftl, i, &wear_min, bci.wear_info);
-                continue;
-            } else {                                 /* a log buffer */
+    return __FTL_PHY_BLOCK_START_ADDR_GET(p_ftl, p_ftl->nb_blocks) +
+           area * (*p_size);
+}
 
-                if (log_num >= log_blocks) {
-                    AM_DBG_INFO("too much log buffer?? \n");
-                    __ftl_erase_at_mount(p_ftl, i, &wear_min, bci.wear_info);
-                    continue;
-                }
+/******************************************************************************/
+static int __ftl_ckpt_hdr_read (am_ftl_serv_t         *p_ftl,
+                                uint32_t               addr,
+                                struct __ftl_ckpt_hdr *p_hdr)
+{
+    int ret;
 
-                sec_used = 0;
-                for (j = 0; j < p_ftl->sectors_per_blk; j++) {
+    ret = am_mtd_read(p_ftl->mtd, addr, p_hdr, sizeof(struct __ftl_ckpt_hdr));
 
-                    if (__ftl_sci_read(p_ftl, i, j, &sci) >= 0) {
+    if (ret < (int)sizeof(struct __ftl_ckpt_hdr)) {
+        return -1;
+    }
 
-                        if (__ftl_memcmpb(&sci, 0xFF, sizeof(sci)) == 0) {
-                            break;
-                        }
+    return 0;
+}
 
-                        /* The data didn't write */
-                        if ((sci.stat_data   != __FTL_SECTOR_STAT_DATA) ||
-                            (sci.locgic_sec0 != sci.locgic_sec1)) {
+/******************************************************************************/
 
-                            /* the sector data should be ignore */
-                            p_ftl->p_log_buf[log_num].p_map[j] = 0xFF;
+/*
+ * mark the current checkpoint stale, must be called before the tables change.
+ * if the mark can't be written, the tables must not change, otherwise the
+ * next mount would load the stale checkpoint
+ */
+static int __ftl_ckpt_invalidate (am_ftl_serv_t *p_ftl)
+{
+    uint32_t stale = 0;
+    int      ret;
 
-                        } else {                      /* valid data */
+    if (!p_ftl->ckpt_valid) {
+        return 0;
+    }
 
-                            p_ftl->p_log_buf[log_num].p_map[j] = sci.locgic_sec0;
-                        }
-                        sec_used++;
-                    }
-                }
+    ret = am_mtd_write(p_ftl->mtd,
+                       p_ftl->ckpt_addr + offsetof(struct __ftl_ckpt_hdr, stale),
+                       &stale,
+                       sizeof(stale));
 
-                /* not used */
-                if (sec_used == 0) {
+    if (ret < (int)sizeof(stale)) {
+        AM_DBG_INFO("ftl: __ftl_ckpt_invalidate error, ret is: %d\n", ret);
+        return (ret < 0) ? ret : -AM_EIO;
+    }
 
-                    AM_DBG_INFO("The log buffer %d is not used! erase it \r\n",i);
-                    __free_block_set(p_ftl, i, 1);        /* mask it as free */
-                    __ftl_erase_at_mount(p_ftl, i, &wear_min, bci.wear_info);
+    p_ftl->ckpt_valid = AM_FALSE;
 
-                    continue;
-                }
+    return 0;
+}
 
-                __free_block_set(p_ftl, i, 0);         /* mask it as not free */
+/******************************************************************************/
 
-                p_ftl->p_log_buf[log_num].pbn  = i;
-                p_ftl->p_log_buf[log_num].lbn  = bci.lbn1;
-                p_ftl->p_log_buf[log_num].used = sec_used;
+/* write a new checkpoint */
+static int __ftl_ckpt_write (am_ftl_serv_t *p_ftl)
+{
+    struct __ftl_ckpt_hdr hdr;
+    uint16_t              log_info[2];
+    uint32_t              addr;
+    uint32_t              size;
+    uint32_t              base;
+    unsigned int          area;
+    unsigned int          i;
+    int                   ret;
+
+    uint32_t  erase_size = AM_MTD_ERASE_UNIT_SIZE_GET(p_ftl->mtd);
+    size_t    log_blocks = p_ftl->p_info->nb_log_blocks;
+
+    hdr.magic           = __FTL_CKPT_MAGIC;
+    hdr.seq             = p_ftl->ckpt_seq + 1;
+    hdr.nb_blocks       = p_ftl->nb_blocks;
+    hdr.last_free       = p_ftl->last_free;
+    hdr.log_blocks      = log_blocks;
+    hdr.sectors_per_blk = p_ftl->sectors_per_blk;
+    hdr.len             = __ftl_ckpt_len_get(p_ftl);
+    hdr.stale           = 0xFFFFFFFF;
+
+    /* append to the current area, or switch to the other one */
+    addr = p_ftl->ckpt_next;
+    area = 0;
+    if (p_ftl->ckpt_addr != 0xFFFFFFFF) {
+        base = __ftl_ckpt_area_get(p_ftl, 0, &size);
+        area = (p_ftl->ckpt_addr - base) / size;
+    }
+    base = __ftl_ckpt_area_get(p_ftl, area, &size);
+
+    if ((addr == 0xFFFFFFFF) ||
+        (addr + sizeof(hdr) + hdr.len > base + size)) {
+
+        area = !area;
+        base = __ftl_ckpt_area_get(p_ftl, area, &size);
+        addr = base;
+
+        if (sizeof(hdr) + hdr.len > size) {
+            return -AM_ENOMEM;
+        }
 
-                AM_DBG_INFO("Find a log buffer! (%d, %d) : ", bci.lbn1, i);
+        for (i = 0; i < size; i += erase_size) {
+            ret = am_mtd_erase(p_ftl->mtd, base + i, erase_size);
+            if (ret < 0) {
+                return ret;
+            }
+        }
+    }
 
-                for (k = 0; k < sec_used; k++) {
-                    AM_DBG_INFO("%d  ", p_ftl->p_log_buf[log_num].p_map[k]);
-                }
+    /* the tables first, the header last */
+    hdr.crc = __ftl_crc32(0xFFFFFFFF, &hdr, offsetof(struct __ftl_ckpt_hdr, crc));
 
-                AM_DBG_INFO("\n");
+    size = addr + sizeof(hdr);
 
-                log_num++;
+    ret = am_mtd_write(p_ftl->mtd,
+                       size,
+                       p_ftl->p_eun_table,
+                       sizeof(uint16_t) * p_ftl->nb_blocks);
+    if (ret < 0) {
+        return ret;
+    }
+    hdr.crc = __ftl_crc32(hdr.crc,
+                          p_ftl->p_eun_table,
+                          sizeof(uint16_t) * p_ftl->nb_blocks);
+    size += sizeof(uint16_t) * p_ftl->nb_blocks;
+
+    ret = am_mtd_write(p_ftl->mtd,
+                       size,
+                       p_ftl->p_free,
+                       sizeof(uint32_t) * p_ftl->free_size);
+    if (ret < 0) {
+        return ret;
+    }
+    hdr.crc = __ftl_crc32(hdr.crc,
+                          p_ftl->p_free,
+                          sizeof(uint32_t) * p_ftl->free_size);
+    size += sizeof(uint32_t) * p_ftl->free_size;
+
+    for (i = 0; i < log_blocks; i++) {
+        log_info[0] = p_ftl->p_log_buf[i].lbn;
+        log_info[1] = p_ftl->p_log_buf[i].pbn;
+
+        ret = am_mtd_write(p_ftl->mtd, size, log_info, sizeof(log_info));
+        if (ret < 0) {
+            return ret;
+        }
+        hdr.crc = __ftl_crc32(hdr.crc, log_info, sizeof(log_info));
+        size += sizeof(log_info);
+    }
+
+    ret = am_mtd_write(p_ftl->mtd, addr, &hdr, sizeof(hdr));
+    if (ret < (int)sizeof(hdr)) {
+        return -AM_EIO;
+    }
+
+    p_ftl->ckpt_seq   = hdr.seq;
+    p_ftl->ckpt_addr  = addr;
+    p_ftl->ckpt_next  = AM_ROUND_UP(size, 4);
+    p_ftl->ckpt_valid = AM_TRUE;
+
+    AM_DBG_INFO("ftl: checkpoint %d saved at 0x%x\n", hdr.seq, addr);
+
+    return AM_OK;
+}
+
+/******************************************************************************/
+
+/* find the latest checkpoint and load the tables from it */
+static int __ftl_ckpt_mount (am_ftl_serv_t *p_ftl)
+{
+    struct __ftl_ckpt_hdr hdr;
+    uint16_t              log_info[2];
+    uint32_t              addr;
+    uint32_t              base;
+    uint32_t              size;
+    uint32_t              crc;
+    unsigned int          area;
+    unsigned int          i;
+    am_bool_t             found = AM_FALSE;
+
+    size_t    log_blocks = p_ftl->p_info->nb_log_blocks;
+
+    /* find the header with the largest sequence number in both areas */
+    for (area = 0; area < 2; area++) {
+
+        base = __ftl_ckpt_area_get(p_ftl, area, &size);
+        addr = base;
+
+        while (addr + sizeof(hdr) <= base + size) {
+
+            if ((__ftl_ckpt_hdr_read(p_ftl, addr, &hdr) < 0) ||
+                (hdr.magic != __FTL_CKPT_MAGIC)               ||
+                (hdr.len > size)) {
+                break;
+            }
+
+            if ((!found) || ((int32_t)(hdr.seq - p_ftl->ckpt_seq) > 0)) {
+                found            = AM_TRUE;
+                p_ftl->ckpt_seq  = hdr.seq;
+                p_ftl->ckpt_addr = addr;
+                p_ftl->ckpt_next = AM_ROUND_UP(addr + sizeof(hdr) + hdr.len, 4);
+            }
+
+            addr = AM_ROUND_UP(addr + sizeof(hdr) + hdr.len, 4);
+        }
+    }
+
+    if (!found) {
+        return -1;
+    }
+
+    __ftl_ckpt_hdr_read(p_ftl, p_ftl->ckpt_addr, &hdr);
+
+    /* the tables have changed after the checkpoint */
+    if (hdr.stale != 0xFFFFFFFF) {
+        AM_DBG_INFO("ftl: checkpoint %d is stale\n", hdr.seq);
+        return -1;
+    }
+
+    /* it must be marked stale if failed to load it */
+    p_ftl->ckpt_valid = AM_TRUE;
+
+    if ((hdr.nb_blocks       != p_ftl->nb_blocks)       ||
+        (hdr.log_blocks      != log_blocks)             ||
+        (hdr.sectors_per_blk != p_ftl->sectors_per_blk) ||
+        (hdr.len             != __ftl_ckpt_len_get(p_ftl))) {
+        return -1;
+    }
+
+    crc  = __ftl_crc32(0xFFFFFFFF, &hdr, offsetof(struct __ftl_ckpt_hdr, crc));
+    addr = p_ftl->ckpt_addr + sizeof(hdr);
+
+    am_mtd_read(p_ftl->mtd,
+                addr,
+                p_ftl->p_eun_table,
+                sizeof(uint16_t) * p_ftl->nb_blocks);
+    crc   = __ftl_crc32(crc,
+                        p_ftl->p_eun_table,
+                        sizeof(uint16_t) * p_ftl->nb_blocks);
+    addr += sizeof(uint16_t) * p_ftl->nb_blocks;
+
+    am_mtd_read(p_ftl->mtd,
+                addr,
+                p_ftl->p_free,
+                sizeof(uint32_t) * p_ftl->free_size);
+    crc   = __ftl_crc32(crc,
+                        p_ftl->p_free,
+                        sizeof(uint32_t) * p_ftl->free_size);
+    addr += sizeof(uint32_t) * p_ftl->free_size;
+
+    for (i = 0; i < log_blocks; i++) {
+        am_mtd_read(p_ftl->mtd, addr, log_info, sizeof(log_info));
+        crc   = __ftl_crc32(crc, log_info, sizeof(log_info));
+        addr += sizeof(log_info);
+
+        p_ftl->p_log_buf[i].lbn  = log_info[0];
+        p_ftl->p_log_buf[i].pbn  = log_info[1];
+        p_ftl->p_log_buf[i].used = 0;
+        memset(p_ftl->p_log_buf[i].p_map, 0xFF, p_ftl->sectors_per_blk);
+    }
+
+    if (crc != hdr.crc) {
+        AM_DBG_INFO("ftl: checkpoint %d crc error\n", hdr.seq);
+        return -1;
+    }
+
+    /* replay the log buffers, the sectors may be written after checkpoint */
+    for (i = 0; i < log_blocks; i++) {
+
+        if (p_ftl->p_log_buf[i].lbn == 0xFFFF) {
+            continue;
+        }
+
+        if ((p_ftl->p_log_buf[i].pbn >= p_ftl->nb_blocks) ||
+            (p_ftl->p_log_buf[i].lbn >= p_ftl->nb_blocks)) {
+            return -1;
+        }
+
+        p_ftl->p_log_buf[i].used = __ftl_log_buf_scan(p_ftl,
+                                                      p_ftl->p_log_buf[i].pbn,
+                                                      &p_ftl->p_log_buf[i]);
+        if (p_ftl->p_log_buf[i].used == 0) {
+            return -1;
+        }
+    }
+
+    p_ftl->last_free = hdr.last_free;
+
+    AM_DBG_INFO("ftl: mount from checkpoint %d\n", hdr.seq);
+
+    return 0;
+}
+
+/******************************************************************************/
+static int __nfl_mount (am_ftl_serv_t *p_ftl)
+{
+    unsigned int i,k;
+    unsigned int log_num  = 0;
+    unsigned int sec_used = 0;
+
+    size_t   log_blocks = p_ftl->p_info->nb_log_blocks;
+    uint16_t max_lbn    = p_ftl->nb_blocks - log_blocks - 1;
+
+
+    uint16_t copy_block = 0xFFFF;
+    uint32_t wear_min   = 0xFFFFFFFF;
+
+    struct __ftl_bci  bci;
+
+    /* try to load the tables from the checkpoint first */
+    if (p_ftl->p_info->ckpt_blocks != 0) {
+
+        __ftl_l2p_init(p_ftl);
+
+        if (__ftl_ckpt_mount(p_ftl) == 0) {
+            __ftl_log_block_process(p_ftl);
+            return 0;
+        }
+
+        /*
+         * never use it again, and the next checkpoint use the other area. if
+         * the stale mark can't be written, the next mount rejects it the same
+         * way and falls back to a full scan
+         */
+        if (__ftl_ckpt_invalidate(p_ftl) < 0) {
+            p_ftl->ckpt_valid = AM_FALSE;
+        }
+        p_ftl->ckpt_next = 0xFFFFFFFF;
+    }
+
+    /* after init, all block mask as free block */
+    __free_block_init(p_ftl);
+
+    /* the cache will be rebuilt while reading and writing */
+    __ftl_l2p_init(p_ftl);
+
+    p_ftl->last_free = 0;
+
+    for (i = 0; i < log_blocks; i++) {
+        p_ftl->p_log_buf[i].lbn  = 0xFFFF;
+        p_ftl->p_log_buf[i].pbn  = 0xFFFF;
+        p_ftl->p_log_buf[i].used = 0;
+        memset(p_ftl->p_log_buf[i].p_map, 0xFF, p_ftl->sectors_per_blk);
+
+    }
+
+    /* init the logical to physical table */
+    for (i = 0; i < p_ftl->nb_blocks; i++) {
+        p_ftl->p_eun_table[i] = __FTL_BLOCK_NIL;
+    }
+
+    for (i = 0; i < p_ftl->nb_blocks; i++) {
+
+        if (__ftl_bci_read(p_ftl, i, &bci) < 0) {
+            __free_block_set(p_ftl, i, 0);    /* mask it as not free */
+        }
+
+        if (bci.magic_num != __FTL_MAGIC_NUM) {
+            __ftl_erase_at_mount(p_ftl, i, &wear_min, 0);
+            continue;
+        }
+
+        /* power failed, erase the block */
+        if ((bci.lbn1  != bci.lbn2) ||
+            ((bci.lbn1 != 0xFFFF) && (bci.lbn1 > max_lbn))) {
+            __ftl_erase_at_mount(p_ftl, i, &wear_min, bci.wear_info);
+            continue;
+        }
+
+        /* power failed while try to set it as a log buffer */
+        if ((bci.type_log != __FTL_BLOCK_TYPE_LOG) &&
+            (bci.type_log != 0xFF)) {
+            __ftl_erase_at_mount(p_ftl, i, &wear_min, bci.wear_info);
+            continue;
+        }
+
+        /* the block is a data buffer */
+        if (bci.type_data != 0xFF) {
+
+            if (bci.lbn1 > max_lbn) {
+                __ftl_erase_at_mount(p_ftl, i, &wear_min, bci.wear_info);
+                continue;
+            } else {
+
+                if (p_ftl->p_eun_table[bci.lbn1] != 0xFFFF) { 
+
+                    AM_DBG_INFO("The lbn is already exist, just erase\n");
+                    __ftl_erase_at_mount(p_ftl, i, &wear_min, bci.wear_info);
+                    continue;
+                }
+                p_ftl->p_eun_table[bci.lbn1] = i;
+                __free_block_set(p_ftl, i, 0);       /* mask it as not free */
+            }
+
+        } else if (bci.type_log  == __FTL_BLOCK_TYPE_LOG) {
+
+            if (bci.lbn1 > max_lbn) {
+                __ftl_erase_at_mount(p_ftl, i, &wear_min, bci.wear_info);
+                continue;
+            } else {                                 /* a log buffer */
+
+                if (log_num >= log_blocks) {
+                    AM_DBG_INFO("too much log buffer?? \n");
+                    __ftl_erase_at_mount(p_ftl, i, &wear_min, bci.wear_info);
+                    continue;
+                }
+
+                sec_used = __ftl_log_buf_scan(p_ftl,
+                                              i,
+                                              &p_ftl->p_log_buf[log_num]);
+
+                /* not used */
+                if (sec_used == 0) {
+
+                    AM_DBG_INFO("The log buffer %d is not used! erase it \r\n",i);
+                    __free_block_set(p_ftl, i, 1);        /* mask it as free */
+                    __ftl_erase_at_mount(p_ftl, i, &wear_min, bci.wear_info);
+
+                    continue;
+                }
+
+                __free_block_set(p_ftl, i, 0);         /* mask it as not free */
+
+                p_ftl->p_log_buf[log_num].pbn  = i;
+                p_ftl->p_log_buf[log_num].lbn  = bci.lbn1;
+                p_ftl->p_log_buf[log_num].used = sec_used;
+
+                AM_DBG_INFO("Find a log buffer! (%d, %d) : ", bci.lbn1, i);
+
+                for (k = 0; k < sec_used; k++) {
+                    AM_DBG_INFO("%d  ", p_ftl->p_log_buf[log_num].p_map[k]);
+                }
+
+                AM_DBG_INFO("\n");
+
+                log_num++;
             }
         } else if (bci.type_copy != 0xFF) {  /* there is a copy block */
 
@@ -722,11 +1357,30 @@ static int __nfl_mount (am_ftl_serv_t *p_ftl)
 
     AM_DBG_INFO("last free is %d \n", p_ftl->last_free);
 
+    /* save the tables, the next mount will be fast */
+    if (p_ftl->p_info->ckpt_blocks != 0) {
+        __ftl_ckpt_write(p_ftl);
+    }
+
     return 0;
 }
 
 /******************************************************************************/
 
+/*
+ * the block info of a free block could not be written, erase it again so it
+ * stays free. if that fails too, the block is not used until the next mount,
+ * which erases it because its block info is incomplete
+ */
+static void __ftl_free_block_restore (am_ftl_serv_t *p_ftl, uint16_t pbn)
+{
+    if (__ftl_block_erase(p_ftl, pbn) < 0) {
+        __free_block_set(p_ftl, pbn, 0);    /* mask the block is not free */
+    }
+}
+
+/******************************************************************************/
+
 /*
  * NFTL_findfreeblock: Find a free Erase Unit on the NFTL partition.
  * This function is used when the give Virtual Unit Chain
@@ -735,6 +1389,12 @@ static uint16_t __ftl_freeblock_find (am_ftl_serv_t *p_ftl)
 {
     int free = __free_block_next_get(p_ftl, p_ftl->last_free);
 
+    /* the blocks of the merge in progress will be free after it done */
+    if ((free == -1) && (p_ftl->gc_state != __FTL_GC_IDLE) &&
+        (__ftl_merge_finish(p_ftl) == 0)) {
+        free = __free_block_next_get(p_ftl, p_ftl->last_free);
+    }
+
     if (free == -1) {
         AM_DBG_INFO("__ftl_freeblock_find: there are too few free EUNs\n");
         return __FTL_BLOCK_NIL;
@@ -753,27 +1413,47 @@ static int __ftl_log_buf_victim_switch (am_ftl_serv_t  *p_ftl,
                                         struct log_buf *p_log)
 {
     struct __ftl_bci  bci;
+    int               ret;
 
     uint16_t direct_eun = p_ftl->p_eun_table[p_log->lbn];
 
     AM_DBG_INFO("only need switch!\n");
 
-    /* may be erase last power up. because of power failed.*/
-    if (direct_eun == 0xFFFF) {
-         // do nothing
-    } else {
-        if (__ftl_block_erase(p_ftl, direct_eun) >= 0) {
-            __free_block_set(p_ftl, direct_eun, 1);    /* mask it free */
+    /*
+     * may be erase last power up. because of power failed. all the data is
+     * in the log buffer, so the data block is dropped once it's erased, a
+     * failed step is retried the next time
+     */
+    if (direct_eun != 0xFFFF) {
+
+        __ftl_l2p_vuc_invalidate(p_ftl, p_log->lbn);
+
+        ret = __ftl_block_erase(p_ftl, direct_eun);
+        if (ret < 0) {
+            return ret;
         }
+
+        p_ftl->p_eun_table[p_log->lbn] = 0xFFFF;
+        __free_block_set(p_ftl, direct_eun, 1);        /* mask it free */
     }
 
     /* change to data block */
-    __ftl_bci_read(p_ftl, p_log->pbn, &bci);
+    ret = __ftl_bci_read(p_ftl, p_log->pbn, &bci);
+    if (ret < 0) {
+        return ret;
+    }
+
     bci.type_data =  __FTL_BLOCK_TYPE_DATA;
-    __ftl_bci_write(p_ftl, p_log->pbn, &bci);
+
+    ret = __ftl_bci_write(p_ftl, p_log->pbn, &bci);
+    if (ret < 0) {
+        return ret;
+    }
 
     p_ftl->p_eun_table[p_log->lbn] = p_log->pbn;    /* new relationship */
 
+    __ftl_l2p_vuc_invalidate(p_ftl, p_log->lbn);
+
     p_log->pbn      = 0xFFFF;
     p_log->lbn      = 0xFFFF;
     p_log->used     = 0;
@@ -784,19 +1464,24 @@ static int __ftl_log_buf_victim_switch (am_ftl_serv_t  *p_ftl,
 }
 /******************************************************************************/
 
-static int __ftl_log_buf_victim_normal (am_ftl_serv_t  *p_ftl,
-                                        struct log_buf *p_log)
+/*
+ * Merge a log buffer and the data block into a new block. The merge is split
+ * into steps, each step copies one sector or erases one block, so it can be
+ * run in background. The steps write the flash in the same order as a merge
+ * done at once, so the mount process is not changed.
+ */
+static int __ftl_merge_begin (am_ftl_serv_t  *p_ftl,
+                              uint16_t        lbn,
+                              struct log_buf *p_log,
+                              uint16_t        new_eun)
 {
-    int               i;
     struct __ftl_bci  bci;
-    struct __ftl_sci  sci;
-    uint16_t          new_eun;
-    unsigned char     status;
     int               ret;
-    uint16_t          direct_eun;
 
     /* Try to find an already-free block */
-    new_eun  = __ftl_freeblock_find(p_ftl);
+    if (new_eun == 0xFFFF) {
+        new_eun  = __ftl_freeblock_find(p_ftl);
+    }
 
     if (new_eun == 0xFFFF) {
         return -1;
@@ -805,161 +1490,546 @@ static int __ftl_log_buf_victim_normal (am_ftl_serv_t  *p_ftl,
     AM_DBG_INFO("The new victim log buffer is %d \n", new_eun);
 
     /* Save the this_vuc, the first node in the chain (8 ,8) */
-    __ftl_bci_read(p_ftl, new_eun, &bci);
-    bci.lbn1      = p_log->lbn;                 /* The logic block  */
-    __ftl_bci_write(p_ftl, new_eun, &bci);
+    ret = __ftl_bci_read(p_ftl, new_eun, &bci);
+    if (ret >= 0) {
+        bci.lbn1 = lbn;                             /* The logic block  */
+        ret      = __ftl_bci_write(p_ftl, new_eun, &bci);
+    }
 
-    memset(p_log->p_map, 0xFF, p_ftl->sectors_per_blk);
+    if (ret < 0) {
+        __ftl_free_block_restore(p_ftl, new_eun);
+        return ret;
+    }
+
+    __free_block_set(p_ftl, new_eun, 0);     /* mask the block is not free */
+
+    p_ftl->gc_p_log  = p_log;
+    p_ftl->gc_lbn    = lbn;
+    p_ftl->gc_new    = new_eun;
+    p_ftl->gc_direct = p_ftl->p_eun_table[lbn];
+
+    /* without log buffer, only move the data block */
+    if (p_log == NULL) {
+        p_ftl->gc_sec   = 0;
+        p_ftl->gc_state = __FTL_GC_COPY_DIRECT;
+    } else {
+        p_ftl->gc_sec   = (p_log->used != 0) ? (p_log->used - 1) : 0;
+        p_ftl->gc_state = __FTL_GC_COPY_LOG;
+    }
+
+    memset(p_ftl->gc_copied, 0, sizeof(p_ftl->gc_copied));
+
+    return 0;
+}
+
+/******************************************************************************/
+
+/*
+ * copy a valid sector which haven't been copied into the new block. if it
+ * fails, the sector is copied again with the same data by the next try
+ */
+static int __ftl_merge_sector_copy (am_ftl_serv_t *p_ftl,
+                                    uint16_t       eun,
+                                    uint16_t       sec,
+                                    am_bool_t      is_log)
+{
+    struct __ftl_sci  sci;
+    uint16_t          new_sec;
+    int               ret;
+
+    /* ȡһsectorǩϢԲ鿴sector״̬(bci)  */
+    ret = __ftl_sci_read(p_ftl, eun, sec, &sci);
+    if (ret < 0) {
+        return ret;
+    }
+
+    if ((sci.stat_start != __FTL_SECTOR_STAT_START) ||
+        (sci.stat_data  != __FTL_SECTOR_STAT_DATA)) {
+        return 0;
+    }
+
+    /* the sector in the data block is directly mapped */
+    new_sec = is_log ? sci.locgic_sec0 : sec;
+
+    /* The data haven't be copied, the newer one in the log buffer is first */
+    if ((new_sec >= p_ftl->sectors_per_blk) ||
+        (__FTL_GC_COPIED(p_ftl, new_sec))) {
+        return 0;
+    }
+
+    ret = __ftl_data_read(p_ftl, eun, sec, p_ftl->p_wr_buf);
+    if (ret < 0) {
+        return ret;
+    }
+
+    sci.stat_start = __FTL_SECTOR_STAT_START;
+    sci.stat_data  = 0xFF;
+
+    ret = __ftl_sci_write(p_ftl, p_ftl->gc_new, new_sec, &sci);
+    if (ret < 0) {
+        return ret;
+    }
+
+    /* write the data */
+    ret = __ftl_data_write(p_ftl, p_ftl->gc_new, new_sec, p_ftl->p_wr_buf);
+    if (ret < 0) {
+        return ret;
+    }
+
+    /* make the data is valid */
+    sci.stat_data = __FTL_SECTOR_STAT_DATA;
+    ret = __ftl_sci_write(p_ftl, p_ftl->gc_new, new_sec, &sci);
+    if (ret < 0) {
+        return ret;
+    }
+
+    p_ftl->gc_copied[new_sec >> 5] |= 1ul << (new_sec & 0x1F);
+
+    return 0;
+}
+
+/******************************************************************************/
+
+/*
+ * run one step of the merge. a step that fails is retried by the next call,
+ * the tables are only changed after the flash has been written
+ */
+static int __ftl_merge_step (am_ftl_serv_t *p_ftl)
+{
+    struct __ftl_bci  bci;
+    struct log_buf   *p_log = p_ftl->gc_p_log;
+    uint16_t          pbn;
+    int               ret;
+
+    switch (p_ftl->gc_state) {
 
     /* copy the data into new block, log buffer first  */
-    for (i = p_ftl->sectors_per_blk - 1; i >= 0; i--) {
+    case __FTL_GC_COPY_LOG:
+        ret = __ftl_merge_sector_copy(p_ftl, p_log->pbn, p_ftl->gc_sec, AM_TRUE);
+        if (ret < 0) {
+            return ret;
+        }
 
-        status = __FTL_SECTOR_IGNORE;
+        if (p_ftl->gc_sec-- == 0) {
+            p_ftl->gc_sec   = 0;
+            p_ftl->gc_state = __FTL_GC_COPY_DIRECT;
+        }
+        break;
 
-        /* ȡһsectorǩϢԲ鿴sector״̬(bci)  */
-        if (__ftl_sci_read(p_ftl, p_log->pbn, i, &sci) >= 0) {
+    /* copy the data into new block, directly buffer   */
+    case __FTL_GC_COPY_DIRECT:
 
-             if ((sci.stat_start == __FTL_SECTOR_STAT_START) &&
-                 (sci.stat_data  == __FTL_SECTOR_STAT_DATA)) {
-                status = __FTL_SECTOR_USED;
-             }
+        /* skip the sectors copied from log buffer */
+        while ((p_ftl->gc_direct != 0xFFFF) &&
+               (p_ftl->gc_sec < p_ftl->sectors_per_blk) &&
+               (__FTL_GC_COPIED(p_ftl, p_ftl->gc_sec))) {
+            p_ftl->gc_sec++;
         }
 
-        /* The data is valid and the data haven't be copied */
-        if ((status                        == __FTL_SECTOR_USED) &&
-            (p_log->p_map[sci.locgic_sec0] != 1)) {
+        if ((p_ftl->gc_direct == 0xFFFF) ||
+            (p_ftl->gc_sec >= p_ftl->sectors_per_blk)) {
+            p_ftl->gc_state = __FTL_GC_COMMIT;
+            break;
+        }
 
-            ret = __ftl_data_read(p_ftl, p_log->pbn, i, p_ftl->p_wr_buf);
+        ret = __ftl_merge_sector_copy(p_ftl,
+                                      p_ftl->gc_direct,
+                                      p_ftl->gc_sec,
+                                      AM_FALSE);
+        if (ret < 0) {
+            return ret;
+        }
+        p_ftl->gc_sec++;
+        break;
 
-            if (ret >= 0) {
+    case __FTL_GC_COMMIT:
+        ret = __ftl_bci_read(p_ftl, p_ftl->gc_new, &bci);
+        if (ret < 0) {
+            return ret;
+        }
+
+        /* 1. copy done, set the type is copy  */
+        bci.type_copy = __FTL_BLOCK_TYPE_COPY;
+        ret = __ftl_bci_write(p_ftl, p_ftl->gc_new, &bci);
+        if (ret < 0) {
+            return ret;
+        }
 
-                sci.stat_start = __FTL_SECTOR_STAT_START;
-                sci.stat_data  = 0xFF;
+        /* 2. set the lbn1 equal to lbn2, make it valid  */
+        bci.lbn1 = bci.lbn2 = p_ftl->gc_lbn;
+        ret = __ftl_bci_write(p_ftl, p_ftl->gc_new, &bci);
+        if (ret < 0) {
+            return ret;
+        }
 
-                __ftl_sci_write(p_ftl, new_eun, sci.locgic_sec0, &sci);
+        /* new relationship, the log buffer is still readable until erased */
+        p_ftl->p_eun_table[p_ftl->gc_lbn] = p_ftl->gc_new;
 
-                /* write the data */
-                __ftl_data_write(p_ftl, 
-                                 new_eun, 
-                                 sci.locgic_sec0, 
-                                 p_ftl->p_wr_buf);
+        __ftl_l2p_vuc_invalidate(p_ftl, p_ftl->gc_lbn);
 
-                /* make the data is valid */
-                sci.stat_data = __FTL_SECTOR_STAT_DATA;
-                __ftl_sci_write(p_ftl, new_eun, sci.locgic_sec0, &sci);
+        p_ftl->gc_state = __FTL_GC_ERASE_DIRECT;
+        break;
 
-                p_log->p_map[sci.locgic_sec0] = 1;  /* mark the sector be copied */
+    /* 3.erase the directly buffer, no longer used after commit */
+    case __FTL_GC_ERASE_DIRECT:
+        if (p_ftl->gc_direct != 0xFFFF) {
+            ret = __ftl_block_erase(p_ftl, p_ftl->gc_direct);
+            if (ret < 0) {
+                return ret;
             }
+            __free_block_set(p_ftl, p_ftl->gc_direct, 1);     /* mask it free */
         }
-    }
+        p_ftl->gc_state = __FTL_GC_ERASE_LOG;
+        break;
 
-    direct_eun = p_ftl->p_eun_table[p_log->lbn];
+    /* 4. erase the log buffer   */
+    case __FTL_GC_ERASE_LOG:
+        if (p_log == NULL) {
+            p_ftl->gc_state = __FTL_GC_DONE;
+            break;
+        }
 
-    /* copy the data into new block, directly buffer   */
-    for (i = 0; (direct_eun != 0xFFFF) && (i < p_ftl->sectors_per_blk); i++) {
+        pbn = p_log->pbn;
 
-        /* The data havn't copy from log buffer */
-        if (p_log->p_map[i] != 1) {
+        p_log->pbn      = 0xFFFF;
+        p_log->lbn      = 0xFFFF;
+        p_log->used     = 0;
 
-            status = __FTL_SECTOR_IGNORE;
+        memset(p_log->p_map, 0xFF, p_ftl->sectors_per_blk);
 
-            /* ȡһsectorǩϢԲ鿴sector״̬(bci)  */
-            if (__ftl_sci_read(p_ftl, direct_eun, i, &sci) >= 0) {
+        /* the sectors in the log buffer may be cached after commit */
+        __ftl_l2p_vuc_invalidate(p_ftl, p_ftl->gc_lbn);
 
-                 if ((sci.stat_start == __FTL_SECTOR_STAT_START) &&
-                     (sci.stat_data  == __FTL_SECTOR_STAT_DATA)) {
-                    status = __FTL_SECTOR_USED;
-                 }
+        p_ftl->gc_state = __FTL_GC_DONE;
+
+        /*
+         * the log buffer is detached already, if it can't be erased it's not
+         * used until the next mount, which erases it or finds the same data
+         */
+        if (pbn != 0xFFFF) {
+            ret = __ftl_block_erase(p_ftl, pbn);
+            if (ret < 0) {
+                return ret;
             }
+            __free_block_set(p_ftl, pbn, 1);    /* mask it free */
+        }
+        break;
 
-            /* The data is valid and the data haven't be copied */
-            if (status == __FTL_SECTOR_USED) {
+    /* 5. set the new block to data block */
+    case __FTL_GC_DONE:
+        ret = __ftl_bci_read(p_ftl, p_ftl->gc_new, &bci);
+        if (ret < 0) {
+            return ret;
+        }
 
-                ret = __ftl_data_read(p_ftl, direct_eun, i, p_ftl->p_wr_buf);
+        bci.type_data = __FTL_BLOCK_TYPE_DATA;
+        ret = __ftl_bci_write(p_ftl, p_ftl->gc_new, &bci);
+        if (ret < 0) {
+            return ret;
+        }
 
-                if (ret >= 0) {
+        p_ftl->gc_p_log = NULL;
+        p_ftl->gc_lbn   = 0xFFFF;
+        p_ftl->gc_state = __FTL_GC_IDLE;
+        break;
 
-                    sci.stat_start = __FTL_SECTOR_STAT_START;
-                    sci.stat_data  = 0xFF;
+    default:
+        p_ftl->gc_state = __FTL_GC_IDLE;
+        break;
+    }
 
-                    __ftl_sci_write(p_ftl, new_eun, i, &sci);
+    return 0;
+}
 
-                    /* write the data */
-                    __ftl_data_write(p_ftl, new_eun, i, p_ftl->p_wr_buf);
+/******************************************************************************/
 
-                    /* mark the sector be copied */
-                    sci.stat_data = __FTL_SECTOR_STAT_DATA;
-                    __ftl_sci_write(p_ftl, new_eun, i, &sci);
+/* complete the merge in progress, stop at the first error */
+static int __ftl_merge_finish (am_ftl_serv_t *p_ftl)
+{
+    int ret;
 
-                    p_log->p_map[sci.locgic_sec0] = 1;
-                }
-            }
+    while (p_ftl->gc_state != __FTL_GC_IDLE) {
+        ret = __ftl_merge_step(p_ftl);
+        if (ret < 0) {
+            return ret;
         }
     }
 
-    /* 1. copy done, set the type is copy  */
-    bci.type_copy = __FTL_BLOCK_TYPE_COPY;
-    __ftl_bci_write(p_ftl, new_eun, &bci);
+    return 0;
+}
 
-    /* 2. set the lbn1 equal to lbn2, make it valid  */
-    bci.lbn1 = bci.lbn2 = p_log->lbn;
-    __ftl_bci_write(p_ftl, new_eun, &bci);
+/******************************************************************************/
 
-    /* 3.erase the directly buffer   */
-    if (direct_eun != 0xFFFF) {
-        if (__ftl_block_erase(p_ftl, direct_eun) >= 0) {
-            __free_block_set(p_ftl, direct_eun, 1);    /* mask it free */
+static int __ftl_log_buf_victim_normal (am_ftl_serv_t  *p_ftl,
+                                        struct log_buf *p_log)
+{
+    if (__ftl_merge_begin(p_ftl, p_log->lbn, p_log, 0xFFFF) < 0) {
+        return -1;
+    }
+
+    return __ftl_merge_finish(p_ftl);
+}
+
+/******************************************************************************/
+
+/* the log buffer is full and all sectors are in order, can be switched */
+static am_bool_t __ftl_log_buf_ordered (am_ftl_serv_t  *p_ftl,
+                                        struct log_buf *p_log)
+{
+    int i;
+
+    if (p_log->used != p_ftl->sectors_per_blk) {
+        return AM_FALSE;
+    }
+
+    for (i = 0; i < p_ftl->sectors_per_blk; i++) {
+        if (p_log->p_map[i] != i) {
+            return AM_FALSE;
         }
     }
 
-    /* 4. erase the log buffer   */
-    if (p_log->pbn != 0xFFFF) {
-        if (__ftl_block_erase(p_ftl, p_log->pbn) >= 0) {
-            __free_block_set(p_ftl, p_log->pbn, 1);    /* mask it free */
+    return AM_TRUE;
+}
+
+/******************************************************************************/
+static int __ftl_log_buf_victim (am_ftl_serv_t *p_ftl, struct log_buf *p_log)
+{
+    int ret;
+
+    AM_DBG_INFO("try to victim the block, lbn(%d)->pbn(%d)\n", p_log->lbn, 
+                                                               p_log->pbn);
+
+    /* only one merge at a time */
+    ret = __ftl_merge_finish(p_ftl);
+    if (ret < 0) {
+        return ret;
+    }
+
+    if (__ftl_log_buf_ordered(p_ftl, p_log)) {
+
+        AM_DBG_INFO("The log buffer is full!\n");
+
+        return __ftl_log_buf_victim_switch(p_ftl, p_log);
+    }
+
+    return __ftl_log_buf_victim_normal(p_ftl, p_log);
+}
+
+/******************************************************************************/
+
+/* find a log buffer to merge in background, NULL if no need */
+static struct log_buf *__ftl_gc_victim_get (am_ftl_serv_t *p_ftl)
+{
+    struct log_buf *p_log      = p_ftl->p_log_buf;
+    struct log_buf *p_victim   = NULL;
+    size_t          log_blocks = p_ftl->p_info->nb_log_blocks;
+    size_t          empty      = 0;
+    size_t          i;
+
+    for (i = 0; i < log_blocks; i++, p_log++) {
+
+        if (p_log->lbn == 0xFFFF) {
+            empty++;
+            continue;
+        }
+
+        /* the next write to a full log buffer need a merge, do it first */
+        if (p_log->used == p_ftl->sectors_per_blk) {
+            return p_log;
+        }
+
+        /* the log buffer being written is likely to be written again */
+        if (p_log->lbn == p_ftl->gc_hot_lbn) {
+            continue;
+        }
+
+        /* victim use most */
+        if ((p_victim == NULL) || (p_victim->used < p_log->used)) {
+            p_victim = p_log;
+        }
+    }
+
+    return (empty < AM_FTL_GC_FREE_LOGS) ? p_victim : NULL;
+}
+
+/******************************************************************************/
+
+/* it's time to check the wear */
+#define __FTL_WL_DUE(p_ftl, n)                                               \
+    (((p_ftl)->p_info->wl_threshold != 0) &&                                 \
+     ((p_ftl)->wl_erases >= (n) * AM_FTL_WL_CHECK_ERASES))
+
+/*
+ * Static wear leveling. If the wear spread exceeds the threshold, move the
+ * data of the least worn data block (cold data) to the most worn free block,
+ * then the least worn block will be free and used by the following writes.
+ * A cold block with a log buffer is merged with the log buffer.
+ */
+static int __ftl_wl_begin (am_ftl_serv_t *p_ftl)
+{
+    uint32_t  wear;
+    uint32_t  wear_max  = 0;
+    uint32_t  wear_hot  = 0;
+    uint32_t  wear_cold = 0xFFFFFFFF;
+    uint16_t  pbn_hot   = 0xFFFF;        /* the most worn free block  */
+    uint16_t  vuc_cold  = 0xFFFF;        /* the least worn data block */
+    size_t    log_blocks = p_ftl->p_info->nb_log_blocks;
+
+    struct log_buf *p_log;
+    struct log_buf *p_log_cold = NULL;
+    unsigned  i, j;
+
+    p_ftl->wl_erases = 0;
+
+    for (i = 0; i < p_ftl->nb_blocks; i++) {
+
+        /* a torn count would look like the most worn block */
+        wear = __ftl_wear_get(p_ftl, i);
+        if (wear == __FTL_WEAR_INVALID) {
+            continue;
+        }
+
+        if (wear > wear_max) {
+            wear_max = wear;
+        }
+
+        if ((p_ftl->p_free[i >> 5] & (1 << (i & 0x1F))) &&     /* It's free */
+            ((pbn_hot == 0xFFFF) || (wear > wear_hot))) {
+            pbn_hot  = i;
+            wear_hot = wear;
         }
     }
 
-    /* 5. set the new block to data block */
-    bci.type_data = __FTL_BLOCK_TYPE_DATA;
-    __ftl_bci_write(p_ftl, new_eun, &bci);
+    for (i = 0; i < p_ftl->nb_blocks; i++) {
+
+        if (p_ftl->p_eun_table[i] == 0xFFFF) {
+            continue;
+        }
+
+        wear  = __ftl_wear_get(p_ftl, p_ftl->p_eun_table[i]);
+        p_log = NULL;
+
+        if (wear == __FTL_WEAR_INVALID) {
+            continue;
+        }
+
+        for (j = 0; j < log_blocks; j++) {
+            if (p_ftl->p_log_buf[j].lbn == i) {
+                p_log = &p_ftl->p_log_buf[j];
+                break;
+            }
+        }
+
+        /* the log buffer being written is not cold */
+        if ((p_log != NULL) && (p_log->lbn == p_ftl->gc_hot_lbn)) {
+            continue;
+        }
+
+        /* __FTL_WEAR_INVALID is never less */
+        if ((p_log != NULL) && (__ftl_wear_get(p_ftl, p_log->pbn) < wear)) {
+            wear = __ftl_wear_get(p_ftl, p_log->pbn);
+        }
+
+        if (wear < wear_cold) {
+            vuc_cold   = i;
+            wear_cold  = wear;
+            p_log_cold = p_log;
+        }
+    }
+
+    if ((vuc_cold  == 0xFFFF) ||
+        (pbn_hot   == 0xFFFF) ||
+        (wear_hot  <= wear_cold) ||
+        (wear_max - wear_cold <= p_ftl->p_info->wl_threshold)) {
+        return 0;
+    }
+
+    AM_DBG_INFO("wear leveling: move lbn %d (%d) to %d (%d)\n",
+                vuc_cold, wear_cold, pbn_hot, wear_hot);
+
+    return __ftl_merge_begin(p_ftl, vuc_cold, p_log_cold, pbn_hot);
+}
+
+/******************************************************************************/
+
+/* run one gc step, return 1 if there is more work to do */
+static int __ftl_gc_step (am_ftl_serv_t *p_ftl)
+{
+    struct log_buf *p_log;
+
+    if (p_ftl->gc_state != __FTL_GC_IDLE) {
+
+        if (__ftl_merge_step(p_ftl) < 0) {
+            return -1;
+        }
+
+    } else {
+
+        p_log = __ftl_gc_victim_get(p_ftl);
 
-    p_ftl->p_eun_table[p_log->lbn] = new_eun;  /* new relationship */
+        if (p_log == NULL) {
 
-    p_log->pbn      = 0xFFFF;
-    p_log->lbn      = 0xFFFF;
-    p_log->used     = 0;
+            if (!__FTL_WL_DUE(p_ftl, 1)) {
+                return 0;
+            }
 
-    memset(p_log->p_map, 0xFF, p_ftl->sectors_per_blk);
+            if (__ftl_wl_begin(p_ftl) < 0) {
+                return -1;
+            }
 
-    __free_block_set(p_ftl, new_eun, 0);     /* mask the block is not free */
+        } else if (__ftl_log_buf_ordered(p_ftl, p_log)) {
+            if (__ftl_log_buf_victim_switch(p_ftl, p_log) < 0) {
+                return -1;
+            }
+        } else if (__ftl_merge_begin(p_ftl, p_log->lbn, p_log, 0xFFFF) < 0) {
+            return -1;
+        }
+    }
+
+    if ((p_ftl->gc_state != __FTL_GC_IDLE) ||
+        (__ftl_gc_victim_get(p_ftl) != NULL) ||
+        (__FTL_WL_DUE(p_ftl, 1))) {
+        return 1;
+    }
 
     return 0;
 }
 
 /******************************************************************************/
-static int __ftl_log_buf_victim (am_ftl_serv_t *p_ftl, struct log_buf *p_log)
+
+/* the background gc job, one step each time */
+static void __ftl_gc_job (void *p_arg)
 {
-    int i;
+    am_ftl_serv_t *p_ftl = (am_ftl_serv_t *)p_arg;
 
-    AM_DBG_INFO("try to victim the block, lbn(%d)->pbn(%d)\n", p_log->lbn, 
-                                                               p_log->pbn);
+    if ((p_ftl->gc_jobq != NULL) && (__ftl_gc_step(p_ftl) > 0)) {
+        am_jobq_post(p_ftl->gc_jobq, &p_ftl->gc_job);
+    }
+}
 
-    if (p_log->used == p_ftl->sectors_per_blk) {
+/******************************************************************************/
 
-        AM_DBG_INFO("The log buffer is full!\n");
+/* start the background gc if need */
+static void __ftl_gc_kick (am_ftl_serv_t *p_ftl)
+{
+    if (p_ftl->gc_jobq == NULL) {
 
-        for (i = 0; i < p_ftl->sectors_per_blk; i++) {
-            if (p_log->p_map[i] != i) {
-                break;
+        /* nobody check the wear in background, do it now */
+        if ((p_ftl->gc_state == __FTL_GC_IDLE) && __FTL_WL_DUE(p_ftl, 2)) {
+            if (__ftl_wl_begin(p_ftl) == 0) {
+                __ftl_merge_finish(p_ftl);
             }
         }
-
-        if (i == p_ftl->sectors_per_blk) {
-            return __ftl_log_buf_victim_switch(p_ftl, p_log);
-        }
+        return;
     }
 
-    return __ftl_log_buf_victim_normal(p_ftl, p_log);
+    if ((p_ftl->gc_state != __FTL_GC_IDLE) ||
+        (__ftl_gc_victim_get(p_ftl) != NULL) ||
+        (__FTL_WL_DUE(p_ftl, 1))) {
+
+        /* -AM_EBUSY if already in the queue */
+        am_jobq_post(p_ftl->gc_jobq, &p_ftl->gc_job);
+    }
 }
 
 /******************************************************************************/
@@ -986,6 +2056,42 @@ static int __ftl_writeunit_find (am_ftl_serv_t *p_ftl,
     uint8_t           log_num      = 0;
     size_t            log_blocks   = p_ftl->p_info->nb_log_blocks;
 
+    /*
+     * The block is being merged, or the log buffer being merged may be
+     * chosen as victim, complete the merge first
+     */
+    if (p_ftl->gc_state != __FTL_GC_IDLE) {
+        for (i = 0; i < log_blocks; i++) {
+            if (p_ftl->p_log_buf[i].lbn == 0xFFFF) {
+                break;
+            }
+        }
+        if ((p_ftl->gc_lbn == this_vuc) || (i == log_blocks)) {
+            ret = __ftl_merge_finish(p_ftl);
+            if (ret < 0) {
+                return ret;
+            }
+        }
+    }
+
+    p_ftl->gc_hot_lbn = this_vuc;
+
+    /*
+     * the data block was dropped by a failed switch, the full log buffer
+     * still holds all the data, finish the switch first
+     */
+    if (p_ftl->p_eun_table[this_vuc] == 0xFFFF) {
+        for (i = 0; i < log_blocks; i++) {
+            if ((p_ftl->p_log_buf[i].lbn  == this_vuc) &&
+                (p_ftl->p_log_buf[i].used == p_ftl->sectors_per_blk)) {
+                ret = __ftl_log_buf_victim_switch(p_ftl, &p_ftl->p_log_buf[i]);
+                if (ret < 0) {
+                    return ret;
+                }
+                break;
+            }
+        }
+    }
 
     if (p_ftl->p_eun_table[this_vuc] == 0xFFFF) {   /* no related blocks */
 
@@ -998,13 +2104,20 @@ static int __ftl_writeunit_find (am_ftl_serv_t *p_ftl,
 
         AM_DBG_INFO("The new data block is %d .\n", write_eun);
 
-        p_ftl->p_eun_table[this_vuc] = write_eun;
-
         /* tag the block is a data buffer */
-        __ftl_bci_read(p_ftl, write_eun, &bci);
-        bci.lbn1      = bci.lbn2 = this_vuc;
-        bci.type_data = __FTL_BLOCK_TYPE_DATA;
-        __ftl_bci_write(p_ftl, write_eun, &bci);
+        ret = __ftl_bci_read(p_ftl, write_eun, &bci);
+        if (ret >= 0) {
+            bci.lbn1      = bci.lbn2 = this_vuc;
+            bci.type_data = __FTL_BLOCK_TYPE_DATA;
+            ret           = __ftl_bci_write(p_ftl, write_eun, &bci);
+        }
+
+        if (ret < 0) {
+            __ftl_free_block_restore(p_ftl, write_eun);
+            return ret;
+        }
+
+        p_ftl->p_eun_table[this_vuc] = write_eun;
 
          *p_pbn = write_eun;
          *p_sec = idx;
@@ -1018,7 +2131,10 @@ static int __ftl_writeunit_find (am_ftl_serv_t *p_ftl,
         write_eun = p_ftl->p_eun_table[this_vuc];
 
         /* Read the sci TAG */
-        __ftl_sci_read(p_ftl, write_eun, idx, &sci);
+        ret = __ftl_sci_read(p_ftl, write_eun, idx, &sci);
+        if (ret < 0) {
+            return ret;
+        }
 
         if ((sci.stat_data == 0xFF) && (sci.stat_start == 0xFF)) {
             *p_pbn = write_eun;
@@ -1082,8 +2198,15 @@ static int __ftl_writeunit_find (am_ftl_serv_t *p_ftl,
     /* check can directly write ? */
     write_eun = p_ftl->p_eun_table[this_vuc];
 
-    /* Read the sci TAG */
-    __ftl_sci_read(p_ftl, write_eun, idx, &sci);
+    /* Read the sci TAG, the data block may be dropped by the victim switch */
+    if (write_eun != 0xFFFF) {
+        ret = __ftl_sci_read(p_ftl, write_eun, idx, &sci);
+        if (ret < 0) {
+            return ret;
+        }
+    } else {
+        sci.stat_data = sci.stat_start = 0;
+    }
 
     if ((sci.stat_data == 0xFF) && (sci.stat_start == 0xFF)) {
         *p_pbn = write_eun;
@@ -1102,6 +2225,19 @@ static int __ftl_writeunit_find (am_ftl_serv_t *p_ftl,
 
     AM_DBG_INFO("The new log block is %d .\n", write_eun);
 
+    /* Save the this_vuc, the first node in the chain (8 ,8) */
+    ret = __ftl_bci_read(p_ftl, write_eun, &bci);
+    if (ret >= 0) {
+        bci.lbn1     = bci.lbn2 = this_vuc;
+        bci.type_log = __FTL_BLOCK_TYPE_LOG;   /* The block is log buffer   */
+        ret          = __ftl_bci_write(p_ftl, write_eun, &bci);
+    }
+
+    if (ret < 0) {
+        __ftl_free_block_restore(p_ftl, write_eun);
+        return ret;
+    }
+
     p_log_victim->pbn      = write_eun;
     p_log_victim->lbn      = this_vuc;
     p_log_victim->p_map[0] = idx;
@@ -1111,12 +2247,6 @@ static int __ftl_writeunit_find (am_ftl_serv_t *p_ftl,
     *p_pbn = p_log_victim->pbn;
     *p_sec = 0;
 
-    /* Save the this_vuc, the first node in the chain (8 ,8) */
-    __ftl_bci_read(p_ftl, write_eun, &bci);
-    bci.lbn1     = bci.lbn2 = this_vuc;
-    bci.type_log = __FTL_BLOCK_TYPE_LOG;       /* The block is log buffer   */
-    __ftl_bci_write(p_ftl, write_eun, &bci);
-
     __free_block_set(p_ftl, write_eun, 0);     /* mask the block is not free */
 
     return 0;
@@ -1148,91 +2278,394 @@ static int __ftl_readunit_check (am_ftl_serv_t *p_ftl,
         return 0;
     }
 
-    return -1;
+    return -1;
+}
+
+
+/*
+ * Get the unit number into which we can write for this block.
+ * Make it available if it isn't already
+ */
+static int __ftl_readunit_find (am_ftl_serv_t *p_ftl,
+                                unsigned       lbn,
+                                uint16_t      *p_eun,
+                                uint16_t      *p_sec)
+{
+    uint16_t logic_sec;
+    uint16_t logic_block;
+
+    size_t   log_blocks  = p_ftl->p_info->nb_log_blocks;
+
+    int      i, j;
+
+    /* hit in the cache, no need to read the tags */
+    if (__ftl_l2p_get(p_ftl, lbn, p_eun, p_sec) == 0) {
+        return 0;
+    }
+
+    logic_block = lbn / p_ftl->sectors_per_blk;
+    logic_sec   = lbn % p_ftl->sectors_per_blk;
+
+    /* check if in the log buffer */
+    for (i = 0; i < log_blocks; i++) {
+        if (p_ftl->p_log_buf[i].lbn == logic_block) {  /* find it */
+            break;
+        }
+    }
+
+    if (i < log_blocks) {   /* find it in log buffer */
+         for (j = p_ftl->p_log_buf[i].used - 1; j >= 0; j--) {
+
+             /* at start up, if the logic_sector error, the p_map[j] is 0xFF */
+             if (p_ftl->p_log_buf[i].p_map[j] == logic_sec) {
+
+                 /* It's valid */
+                 if (__ftl_readunit_check(p_ftl,
+                                          p_ftl->p_log_buf[i].pbn,
+                                          j) == 0) {
+
+                     *p_eun = p_ftl->p_log_buf[i].pbn;
+                     *p_sec = j;
+
+                     __ftl_l2p_set(p_ftl, lbn, *p_eun, *p_sec);
+
+                     return 0;
+                 }
+             }
+         }
+    }
+
+    /* can't find it in log buffer, read out from directly buffer */
+    if (p_ftl->p_eun_table[logic_block] != 0xFFFF) {
+
+        /* It's valid */
+        if (__ftl_readunit_check(p_ftl,
+                                 p_ftl->p_eun_table[logic_block],
+                                 logic_sec) == 0) {        /* directly map */
+
+            *p_eun = p_ftl->p_eun_table[logic_block];
+            *p_sec = logic_sec;
+
+            __ftl_l2p_set(p_ftl, lbn, *p_eun, *p_sec);
+
+            return 0;
+        }
+    }
+
+    /* can't find it */
+    return -1;
+}
+
+/******************************************************************************/
+
+int __ftl_format_all (am_ftl_serv_t *p_ftl)
+{
+    unsigned int i;
+
+    for (i = 0; i < p_ftl->nb_blocks; i++) {
+        if (__ftl_block_erase(p_ftl, i) < 0) {
+            __free_block_set(p_ftl, i, 0);    /* mask it as not free */
+        }
+    }
+
+    return 0;
+}
+
+/******************************************************************************/
+
+/* write a block, the gc is not kicked */
+static int __ftl_block_write (am_ftl_serv_t *p_ftl,
+                              unsigned int   lbn,
+                              const void    *p_buf)
+{
+    uint16_t         write_eun;
+    uint16_t         write_sec;
+    struct __ftl_sci sci;
+    int              ret;
+
+    /* find a space to write */
+    ret = __ftl_writeunit_find(p_ftl, lbn, &write_eun, &write_sec);
+    if (ret < 0) {
+
+        AM_DBG_INFO("am_ftl_write(): Cannot find block to write to\n");
+
+        /* If we _still_ haven't got a block to use, we're screwed */
+        return ret;
+    }
+
+    AM_DBG_INFO("Write lbn %d to (%d, %d)!\n", lbn, write_eun, write_sec);
+
+    /* Set the TAG to __FTL_SECTOR_USED */
+    memset(&sci, 0xFF, sizeof(struct __ftl_sci));
+
+    sci.stat_start = __FTL_SECTOR_STAT_START;
+
+    /* the logic sector */
+    sci.locgic_sec0 = sci.locgic_sec1 = lbn % p_ftl->sectors_per_blk;
+
+    ret = __ftl_sci_write(p_ftl, write_eun, write_sec, &sci);
+    if (ret < 0) {
+        return ret;
+    }
+
+#if 0
+    /* check the data is 0xFF */
+    __ftl_data_read(p_ftl, write_eun, write_sec, p_ftl->p_wr_buf);
+
+    if (__ftl_memcmpb(p_ftl->p_wr_buf,
+                      0xFF,
+                      p_ftl->p_info->logic_blk_size) != 0) {
+        AM_DBG_INFO("The block is error ! write failed! \n");
+        while(1);
+    }
+#endif
+
+    /* the sector without the data tag is skipped, the old data is kept */
+    ret = __ftl_data_write(p_ftl, write_eun, write_sec, (void *)p_buf);
+    if (ret < 0) {
+        return ret;
+    }
+
+    /* otherwise the data is invalid */
+    sci.stat_data = __FTL_SECTOR_STAT_DATA;
+    ret = __ftl_sci_write(p_ftl, write_eun, write_sec, &sci);
+    if (ret < 0) {
+
+        /* the tag may be written, find the sector again by the next read */
+        __ftl_l2p_vuc_invalidate(p_ftl, lbn / p_ftl->sectors_per_blk);
+        return ret;
+    }
+
+    __ftl_l2p_set(p_ftl, lbn, write_eun, write_sec);
+
+    return 0;
+}
+
+/******************************************************************************/
+
+/* the sectors of a logic block processed at once, limited by the sci buffer */
+static unsigned int __ftl_run_get (am_ftl_serv_t *p_ftl,
+                                   unsigned int   lbn,
+                                   unsigned int   nblks)
+{
+    unsigned int n   = p_ftl->sectors_per_blk - (lbn % p_ftl->sectors_per_blk);
+    unsigned int max = p_ftl->p_info->logic_blk_size / sizeof(struct __ftl_sci);
+
+    if (n > nblks) {
+        n = nblks;
+    }
+
+    return (n > max) ? max : n;
+}
+
+/******************************************************************************/
+
+/* read n sci from the sector sec of the block pbn to p_wr_buf */
+static int __ftl_sci_range_read (am_ftl_serv_t *p_ftl,
+                                 uint16_t       pbn,
+                                 uint16_t       sec,
+                                 unsigned int   n)
+{
+    uint32_t addr;
+    int      ret;
+
+    addr = __FTL_PHY_BLOCK_START_ADDR_GET(p_ftl, pbn) +
+           sizeof(struct __ftl_bci) +
+           (sizeof(struct __ftl_sci) * sec);
+
+    ret = am_mtd_read(p_ftl->mtd, addr, p_ftl->p_wr_buf,
+                      sizeof(struct __ftl_sci) * n);
+
+    return (ret < 0) ? ret : 0;
+}
+
+/******************************************************************************/
+
+/*
+ * Read n sectors of a logic block which has no log buffer, the tags and data
+ * are read out with one MTD read respectively
+ */
+static int __ftl_run_direct_read (am_ftl_serv_t *p_ftl,
+                                  unsigned int   lbn,
+                                  uint8_t       *p_buf,
+                                  unsigned int   n)
+{
+    size_t            lbs = p_ftl->p_info->logic_blk_size;
+    uint16_t          eun = p_ftl->p_eun_table[lbn / p_ftl->sectors_per_blk];
+    uint16_t          sec = lbn % p_ftl->sectors_per_blk;
+    struct __ftl_sci *p_sci;
+    unsigned int      i;
+    int               ret;
+
+    if (eun == 0xFFFF) {
+        memset(p_buf, 0, lbs * n);
+        return 0;
+    }
+
+    ret = __ftl_sci_range_read(p_ftl, eun, sec, n);
+    if (ret < 0) {
+        return ret;
+    }
+
+    ret = am_mtd_read(p_ftl->mtd,
+                      __FTL_PHY_BLOCK_START_ADDR_GET(p_ftl, eun) +
+                      (sec + p_ftl->sectors_hdr) * lbs,
+                      p_buf,
+                      lbs * n);
+    if (ret < 0) {
+        return ret;
+    }
+
+    /* the requested block is not on the media, return all 0x00 */
+    p_sci = (struct __ftl_sci *)p_ftl->p_wr_buf;
+    for (i = 0; i < n; i++) {
+        if ((p_sci[i].stat_start != __FTL_SECTOR_STAT_START) ||
+            (p_sci[i].stat_data  != __FTL_SECTOR_STAT_DATA)) {
+            memset(p_buf + i * lbs, 0, lbs);
+        }
+    }
+
+    return 0;
 }
 
+/******************************************************************************/
 
 /*
- * Get the unit number into which we can write for this block.
- * Make it available if it isn't already
+ * Read n sectors one by one, the sectors which are physically contiguous are
+ * read out with one MTD read
  */
-static int __ftl_readunit_find (am_ftl_serv_t *p_ftl,
-                                unsigned       lbn,
-                                uint16_t      *p_eun,
-                                uint16_t      *p_sec)
+static int __ftl_run_mapped_read (am_ftl_serv_t *p_ftl,
+                                  unsigned int   lbn,
+                                  uint8_t       *p_buf,
+                                  unsigned int   n)
 {
-    uint16_t logic_sec;
-    uint16_t logic_block;
+    size_t       lbs     = p_ftl->p_info->logic_blk_size;
+    uint16_t     run_eun = 0xFFFF;
+    uint16_t     run_sec = 0;
+    uint8_t     *p_run   = p_buf;
+    unsigned int run_len = 0;
+    uint16_t     eun;
+    uint16_t     sec;
+    unsigned int i;
+    int          ret;
 
-    size_t   log_blocks  = p_ftl->p_info->nb_log_blocks;
+    for (i = 0; i <= n; i++) {
 
-    int      i, j;
+        if (i == n) {
+            eun = 0xFFFF;                    /* flush the last run */
+        } else if (__ftl_readunit_find(p_ftl, lbn + i, &eun, &sec) < 0) {
+            eun = 0xFFFF;
+            memset(p_buf + i * lbs, 0, lbs);
+        }
 
-    logic_block = lbn / p_ftl->sectors_per_blk;
-    logic_sec   = lbn % p_ftl->sectors_per_blk;
+        /* continue the run */
+        if ((run_len != 0) && (eun == run_eun) && (sec == run_sec + run_len)) {
+            run_len++;
+            continue;
+        }
 
-    /* check if in the log buffer */
-    for (i = 0; i < log_blocks; i++) {
-        if (p_ftl->p_log_buf[i].lbn == logic_block) {  /* find it */
-            break;
+        if (run_len != 0) {
+            ret = am_mtd_read(p_ftl->mtd,
+                              __FTL_PHY_BLOCK_START_ADDR_GET(p_ftl, run_eun) +
+                              (run_sec + p_ftl->sectors_hdr) * lbs,
+                              p_run,
+                              lbs * run_len);
+            if (ret < 0) {
+                return ret;
+            }
+        }
+
+        run_len = 0;
+
+        if (eun != 0xFFFF) {
+            run_eun = eun;
+            run_sec = sec;
+            p_run   = p_buf + i * lbs;
+            run_len = 1;
         }
     }
 
-    if (i < log_blocks) {   /* find it in log buffer */
-         for (j = p_ftl->p_log_buf[i].used - 1; j >= 0; j--) {
+    return 0;
+}
 
-             /* at start up, if the logic_sector error, the p_map[j] is 0xFF */
-             if (p_ftl->p_log_buf[i].p_map[j] == logic_sec) {
+/******************************************************************************/
 
-                 /* It's valid */
-                 if (__ftl_readunit_check(p_ftl,
-                                          p_ftl->p_log_buf[i].pbn,
-                                          j) == 0) {
+/*
+ * Write the leading free sectors of the data block directly, the tags and data
+ * are written with one MTD write respectively, the order is the same as
+ * __ftl_block_write(): start tags, data, data tags.
+ *
+ * return the sectors written, 0 if the first sector is not free
+ */
+static int __ftl_run_direct_write (am_ftl_serv_t *p_ftl,
+                                   unsigned int   lbn,
+                                   const uint8_t *p_buf,
+                                   unsigned int   n)
+{
+    size_t            lbs = p_ftl->p_info->logic_blk_size;
+    uint16_t          eun = p_ftl->p_eun_table[lbn / p_ftl->sectors_per_blk];
+    uint16_t          sec = lbn % p_ftl->sectors_per_blk;
+    uint32_t          addr;
+    struct __ftl_sci *p_sci;
+    unsigned int      i;
+    int               ret;
 
-                     *p_eun = p_ftl->p_log_buf[i].pbn;
-                     *p_sec = j;
+    ret = __ftl_sci_range_read(p_ftl, eun, sec, n);
+    if (ret < 0) {
+        return ret;
+    }
 
-                     return 0;
-                 }
-             }
-         }
+    p_sci = (struct __ftl_sci *)p_ftl->p_wr_buf;
+    for (i = 0; i < n; i++) {
+        if ((p_sci[i].stat_data != 0xFF) || (p_sci[i].stat_start != 0xFF)) {
+            break;
+        }
+        p_sci[i].stat_start  = __FTL_SECTOR_STAT_START;
+        p_sci[i].locgic_sec0 = p_sci[i].locgic_sec1 = sec + i;
     }
 
-    /* can't find it in log buffer, read out from directly buffer */
-    if (p_ftl->p_eun_table[logic_block] != 0xFFFF) {
+    if ((n = i) == 0) {
+        return 0;
+    }
 
-        /* It's valid */
-        if (__ftl_readunit_check(p_ftl,
-                                 p_ftl->p_eun_table[logic_block],
-                                 logic_sec) == 0) {        /* directly map */
+    addr = __FTL_PHY_BLOCK_START_ADDR_GET(p_ftl, eun) +
+           sizeof(struct __ftl_bci) +
+           (sizeof(struct __ftl_sci) * sec);
 
-            *p_eun = p_ftl->p_eun_table[logic_block];
-            *p_sec = logic_sec;
+    ret = am_mtd_write(p_ftl->mtd, addr, p_sci, sizeof(struct __ftl_sci) * n);
+    if (ret < 0) {
+        return ret;
+    }
 
-            return 0;
-        }
+    ret = am_mtd_write(p_ftl->mtd,
+                       __FTL_PHY_BLOCK_START_ADDR_GET(p_ftl, eun) +
+                       (sec + p_ftl->sectors_hdr) * lbs,
+                       p_buf,
+                       lbs * n);
+    if (ret < 0) {
+        return ret;
     }
 
-    /* can't find it */
-    return -1;
-}
+    /* otherwise the data is invalid */
+    for (i = 0; i < n; i++) {
+        p_sci[i].stat_data = __FTL_SECTOR_STAT_DATA;
+    }
 
-/******************************************************************************/
+    ret = am_mtd_write(p_ftl->mtd, addr, p_sci, sizeof(struct __ftl_sci) * n);
+    if (ret < 0) {
 
-int __ftl_format_all (am_ftl_serv_t *p_ftl)
-{
-    unsigned int i;
+        /* the tags may be written, find the sectors again by the next read */
+        __ftl_l2p_vuc_invalidate(p_ftl, lbn / p_ftl->sectors_per_blk);
+        return ret;
+    }
 
-    for (i = 0; i < p_ftl->nb_blocks; i++) {
-        if (__ftl_block_erase(p_ftl, i) < 0) {
-            __free_block_set(p_ftl, i, 0);    /* mask it as not free */
-        }
+    for (i = 0; i < n; i++) {
+        __ftl_l2p_set(p_ftl, lbn + i, eun, sec + i);
     }
 
-    return 0;
+    return n;
 }
 
- 
 /*******************************************************************************
     Public fuctions
 *******************************************************************************/
@@ -1278,9 +2711,7 @@ int am_ftl_write (am_ftl_handle_t handle, unsigned int lbn, void *p_buf)
 {
     am_ftl_serv_t *p_ftl = (am_ftl_serv_t *)handle;
 
-    uint16_t         write_eun;
-    uint16_t         write_sec;
-    struct __ftl_sci sci;
+    int ret;
 
     if (handle == NULL) {
         return -1;
@@ -1293,47 +2724,136 @@ int am_ftl_write (am_ftl_handle_t handle, unsigned int lbn, void *p_buf)
 
         return -1;
     }
- 
-    /* find a space to write */
-    if (__ftl_writeunit_find(p_ftl, lbn, &write_eun, &write_sec) < 0) {
 
-        AM_DBG_INFO("am_ftl_write(): Cannot find block to write to\n");
+    ret = __ftl_block_write(p_ftl, lbn, p_buf);
 
-        /* If we _still_ haven't got a block to use, we're screwed */
-        return -1;
+    __ftl_gc_kick(p_ftl);
+
+    return ret;
+}
+
+/******************************************************************************/
+int am_ftl_read_blocks (am_ftl_handle_t  handle,
+                        unsigned int     lbn,
+                        void            *p_buf,
+                        unsigned int     nblks)
+{
+    am_ftl_serv_t *p_ftl = (am_ftl_serv_t *)handle;
+
+    uint8_t       *p_data = (uint8_t *)p_buf;
+    size_t         log_blocks;
+    uint16_t       vuc;
+    unsigned int   n;
+    int            i;
+    int            ret;
+
+    if ((handle == NULL) || (p_buf == NULL)) {
+        return -AM_EINVAL;
     }
 
-    AM_DBG_INFO("Write lbn %d to (%d, %d)!\n", lbn, write_eun, write_sec);
+    if ((nblks == 0) || (lbn > p_ftl->max_lbn) ||
+        (nblks - 1 > p_ftl->max_lbn - lbn)) {
+        return -AM_EINVAL;
+    }
 
-    /* Set the TAG to __FTL_SECTOR_USED */
-    memset(&sci, 0xFF, sizeof(struct __ftl_sci));
+    log_blocks = p_ftl->p_info->nb_log_blocks;
 
-    sci.stat_start = __FTL_SECTOR_STAT_START;
+    while (nblks) {
 
-    /* the logic sector */
-    sci.locgic_sec0 = sci.locgic_sec1 = lbn % p_ftl->sectors_per_blk;
+        vuc = lbn / p_ftl->sectors_per_blk;
+        n   = __ftl_run_get(p_ftl, lbn, nblks);
+
+        for (i = 0; i < log_blocks; i++) {
+            if (p_ftl->p_log_buf[i].lbn == vuc) {
+                break;
+            }
+        }
 
-    __ftl_sci_write(p_ftl, write_eun, write_sec, &sci);
+        /* only the data block hold the sectors, read them at once */
+        if ((i == log_blocks) &&
+            ((p_ftl->gc_state == __FTL_GC_IDLE) || (p_ftl->gc_lbn != vuc))) {
+            ret = __ftl_run_direct_read(p_ftl, lbn, p_data, n);
+        } else {
+            ret = __ftl_run_mapped_read(p_ftl, lbn, p_data, n);
+        }
 
-#if 0
-    /* check the data is 0xFF */
-    __ftl_data_read(p_ftl, write_eun, write_sec, p_ftl->p_wr_buf);
+        if (ret < 0) {
+            return ret;
+        }
 
-    if (__ftl_memcmpb(p_ftl->p_wr_buf,
-                      0xFF,
-                      p_ftl->p_info->logic_blk_size) != 0) {
-        AM_DBG_INFO("The block is error ! write failed! \n");
-        while(1);
+        lbn    += n;
+        nblks  -= n;
+        p_data += n * p_ftl->p_info->logic_blk_size;
     }
-#endif
 
-    __ftl_data_write(p_ftl, write_eun, write_sec, p_buf);
+    return AM_OK;
+}
+
+/******************************************************************************/
+int am_ftl_write_blocks (am_ftl_handle_t  handle,
+                         unsigned int     lbn,
+                         const void      *p_buf,
+                         unsigned int     nblks)
+{
+    am_ftl_serv_t *p_ftl = (am_ftl_serv_t *)handle;
 
-    /* otherwise the data is invalid */
-    sci.stat_data = __FTL_SECTOR_STAT_DATA;
-    __ftl_sci_write(p_ftl, write_eun, write_sec, &sci);
+    const uint8_t *p_data = (const uint8_t *)p_buf;
+    uint16_t       vuc;
+    int            n;
+    int            ret = AM_OK;
 
-    return 0;
+    if ((handle == NULL) || (p_buf == NULL)) {
+        return -AM_EINVAL;
+    }
+
+    if ((nblks == 0) || (lbn > p_ftl->max_lbn) ||
+        (nblks - 1 > p_ftl->max_lbn - lbn)) {
+        return -AM_EINVAL;
+    }
+
+    while (nblks) {
+
+        vuc = lbn / p_ftl->sectors_per_blk;
+        n   = 0;
+
+        /* the block is being merged, complete the merge first */
+        if ((p_ftl->gc_state != __FTL_GC_IDLE) && (p_ftl->gc_lbn == vuc)) {
+            ret = __ftl_merge_finish(p_ftl);
+            if (ret < 0) {
+                break;
+            }
+        }
+
+        if (p_ftl->p_eun_table[vuc] != 0xFFFF) {
+            p_ftl->gc_hot_lbn = vuc;
+
+            n = __ftl_run_direct_write(p_ftl,
+                                       lbn,
+                                       p_data,
+                                       __ftl_run_get(p_ftl, lbn, nblks));
+            if (n < 0) {
+                ret = n;
+                break;
+            }
+        }
+
+        /* not free in the data block (or no data block), use the log buffer */
+        if (n == 0) {
+            ret = __ftl_block_write(p_ftl, lbn, p_data);
+            if (ret < 0) {
+                break;
+            }
+            n = 1;
+        }
+
+        lbn    += n;
+        nblks  -= n;
+        p_data += n * p_ftl->p_info->logic_blk_size;
+    }
+
+    __ftl_gc_kick(p_ftl);
+
+    return ret;
 }
  
 /******************************************************************************/
@@ -1346,6 +2866,8 @@ am_ftl_handle_t am_ftl_init (am_ftl_serv_t          *p_ftl,
         (p_info                == NULL)  ||
         (p_info->p_buf         == NULL)  ||
         (p_info->nb_log_blocks < 2)      ||
+        ((p_info->p_l2p != NULL) && (p_info->l2p_num == 0)) ||
+        ((p_info->ckpt_blocks & 0x01) != 0) ||
         (mtd_handle == NULL)) {
 
         return NULL;
@@ -1378,6 +2900,134 @@ am_ftl_handle_t am_ftl_init (am_ftl_serv_t          *p_ftl,
     return p_ftl;
 }
 
+/******************************************************************************/
+int am_ftl_checkpoint (am_ftl_handle_t handle)
+{
+    am_ftl_serv_t *p_ftl = (am_ftl_serv_t *)handle;
+    int            ret;
+
+    if (handle == NULL) {
+        return -AM_EINVAL;
+    }
+
+    if (p_ftl->p_info->ckpt_blocks == 0) {
+        return -AM_ENOTSUP;
+    }
+
+    /* the blocks of the merge in progress are not recorded in the tables */
+    ret = __ftl_merge_finish(p_ftl);
+    if (ret < 0) {
+        return ret;
+    }
+
+    /* the tables haven't changed */
+    if (p_ftl->ckpt_valid) {
+        return AM_OK;
+    }
+
+    return __ftl_ckpt_write(p_ftl);
+}
+
+/******************************************************************************/
+int am_ftl_gc_jobq_set (am_ftl_handle_t   handle,
+                        am_jobq_handle_t  jobq,
+                        uint16_t          pri)
+{
+    am_ftl_serv_t *p_ftl = (am_ftl_serv_t *)handle;
+
+    if (handle == NULL) {
+        return -AM_EINVAL;
+    }
+
+    /* the job may be in the queue, only the priority of next post changed */
+    p_ftl->gc_job.pri = pri;
+    p_ftl->gc_jobq    = jobq;
+
+    __ftl_gc_kick(p_ftl);
+
+    return AM_OK;
+}
+
+/******************************************************************************/
+int am_ftl_gc_step (am_ftl_handle_t handle)
+{
+    if (handle == NULL) {
+        return -AM_EINVAL;
+    }
+
+    return __ftl_gc_step((am_ftl_serv_t *)handle);
+}
+
+/******************************************************************************/
+int am_ftl_wear_get (am_ftl_handle_t handle, unsigned int pbn, uint32_t *p_count)
+{
+    am_ftl_serv_t *p_ftl = (am_ftl_serv_t *)handle;
+    int            ret;
+
+    if ((handle == NULL) || (p_count == NULL) || (pbn >= p_ftl->nb_blocks)) {
+        return -AM_EINVAL;
+    }
+
+    ret = __ftl_wear_read(p_ftl, pbn, p_count);
+    if ((ret == 0) && (*p_count == __FTL_WEAR_INVALID)) {
+        return -AM_EBADMSG;
+    }
+
+    return ret;
+}
+
+/******************************************************************************/
+int am_ftl_wear_stat_get (am_ftl_handle_t     handle,
+                          uint32_t            endurance,
+                          am_ftl_wear_stat_t *p_stat)
+{
+    am_ftl_serv_t *p_ftl = (am_ftl_serv_t *)handle;
+    uint64_t       total = 0;
+    uint32_t       wear;
+    unsigned int   i, n;
+
+    if ((handle == NULL) || (p_stat == NULL) || (p_ftl->nb_blocks == 0)) {
+        return -AM_EINVAL;
+    }
+
+    p_stat->blocks  = p_ftl->nb_blocks;
+    p_stat->min     = 0xFFFFFFFF;
+    p_stat->max     = 0;
+    p_stat->invalid = 0;
+
+    for (i = 0; i < p_ftl->nb_blocks; i++) {
+
+        wear = __ftl_wear_get(p_ftl, i);
+        if (wear == __FTL_WEAR_INVALID) {
+            p_stat->invalid++;
+            continue;
+        }
+
+        total += wear;
+
+        if (wear < p_stat->min) {
+            p_stat->min = wear;
+        }
+        if (wear > p_stat->max) {
+            p_stat->max = wear;
+        }
+    }
+
+    n = p_ftl->nb_blocks - p_stat->invalid;
+    if (n == 0) {
+        p_stat->min = 0;
+    }
+
+    p_stat->total        = (total > 0xFFFFFFFF) ? 0xFFFFFFFF : (uint32_t)total;
+    p_stat->mean         = n ? (uint32_t)(total / n) : 0;
+    p_stat->remain       = (endurance > p_stat->max) ?
+                           (endurance - p_stat->max) : 0;
+    p_stat->remain_ideal = (endurance > p_stat->mean) ?
+                           (endurance - p_stat->mean) : 0;
+
+    return AM_OK;
+}
+
 /******************************************************************************/
 size_t am_ftl_max_lbn_get (am_ftl_serv_t *p_ftl)
 {
@@ -1488,6 +3138,10 @@ am_local int __ftl_nvram_program_data (am_ftl_serv_t        *p_ftl,
         /* the data data save complete */
         sci.stat_data = __FTL_SECTOR_STAT_DATA;
         __ftl_sci_write(p_ftl, write_eun, write_sec, &sci);
+
+        __ftl_l2p_set(p_ftl, lbn, write_eun, write_sec);
+
+        __ftl_gc_kick(p_ftl);
     }
 
     return AM_OK;
@@ -24,6 +24,9 @@
 
 #include "am_i2c.h"
 #include "am_wait.h"
+#include "am_int.h"
+#include "am_system.h"
+#include <limits.h>
 
 /******************************************************************************/
 
@@ -35,50 +38,48 @@ static void __i2c_callback (void *p_arg)
 
 /******************************************************************************/
 
-static int __i2c_rw_sync (am_i2c_device_t *p_dev,
-                          uint32_t         sub_addr,
-                          uint8_t         *p_buf,
-                          uint32_t         nbytes,
-                          am_bool_t        is_read)
+/* ӵַݴɵϢ */
+static int __i2c_msg_build (am_i2c_device_t   *p_dev,
+                            uint32_t           sub_addr,
+                            uint8_t           *p_buf,
+                            uint32_t           nbytes,
+                            am_bool_t          is_read,
+                            am_i2c_transfer_t *p_trans,
+                            uint8_t           *p_subaddr_buf,
+                            am_i2c_message_t  *p_msg,
+                            am_pfnvoid_t       pfn_complete,
+                            void              *p_arg)
 {
     uint16_t subaddr_len = AM_I2C_SUBADDR_LEN_GET(p_dev->dev_flags);
-    
-    am_i2c_transfer_t trans[3];
-    am_wait_t         trans_wait;
-    am_i2c_message_t  msg;
-    uint8_t           subaddr_buf[2];  /* ڴ2bytesڼӵַ */
-    int               ret;
-    
-    am_wait_init(&trans_wait);
-    
+
     /* if no sub address just send the data */
     if (subaddr_len == 0) {
         
-        am_i2c_mktrans(&trans[0],
+        am_i2c_mktrans(&p_trans[0],
                        p_dev->dev_addr,
                        p_dev->dev_flags |
                        ((is_read == AM_TRUE) ? AM_I2C_M_RD : AM_I2C_M_WR),
                        p_buf, 
                        nbytes);
         
-        am_i2c_mkmsg( &msg, &trans[0], 1, __i2c_callback, &trans_wait);
+        am_i2c_mkmsg(p_msg, &p_trans[0], 1, pfn_complete, p_arg);
                        
                        
     } else {
         
         /* one byte sub address */
         if (subaddr_len == 1) {
-             subaddr_buf[0] = (uint8_t)sub_addr;
+             p_subaddr_buf[0] = (uint8_t)sub_addr;
 
         /* two byte byte address */
         } else if (subaddr_len == 2) {
 
             if (p_dev->dev_flags & AM_I2C_SUBADDR_LSB_FIRST) {
-                subaddr_buf[0] = (uint8_t)(sub_addr & 0xFF);
-                subaddr_buf[1] = (uint8_t)(sub_addr >> 8);
+                p_subaddr_buf[0] = (uint8_t)(sub_addr & 0xFF);
+                p_subaddr_buf[1] = (uint8_t)(sub_addr >> 8);
             } else {
-                subaddr_buf[0] = (uint8_t)(sub_addr >> 8);
-                subaddr_buf[1] = (uint8_t)(sub_addr & 0xFF);
+                p_subaddr_buf[0] = (uint8_t)(sub_addr >> 8);
+                p_subaddr_buf[1] = (uint8_t)(sub_addr & 0xFF);
             }
 
         /* this case can't happen */
@@ -87,13 +88,13 @@ static int __i2c_rw_sync (am_i2c_device_t *p_dev,
         }
         
 
-        am_i2c_mktrans(&trans[0],
+        am_i2c_mktrans(&p_trans[0],
                        p_dev->dev_addr,
                        p_dev->dev_flags | AM_I2C_M_WR,
-                       &subaddr_buf[0], 
+                       &p_subaddr_buf[0], 
                        subaddr_len);
         
-        am_i2c_mktrans(&trans[1],
+        am_i2c_mktrans(&p_trans[1],
                        p_dev->dev_addr,
                        p_dev->dev_flags | 
                        ((is_read == AM_TRUE) ? \
@@ -101,7 +102,40 @@ static int __i2c_rw_sync (am_i2c_device_t *p_dev,
                        p_buf, 
                        nbytes);
         
-        am_i2c_mkmsg( &msg, &trans[0], 2, __i2c_callback, &trans_wait);
+        am_i2c_mkmsg(p_msg, &p_trans[0], 2, pfn_complete, p_arg);
+    }
+
+    return AM_OK;
+}
+
+/******************************************************************************/
+
+static int __i2c_rw_sync (am_i2c_device_t *p_dev,
+                          uint32_t         sub_addr,
+                          uint8_t         *p_buf,
+                          uint32_t         nbytes,
+                          am_bool_t        is_read)
+{
+    am_i2c_transfer_t trans[2];
+    am_wait_t         trans_wait;
+    am_i2c_message_t  msg;
+    uint8_t           subaddr_buf[2];  /* ڴ2bytesڼӵַ */
+    int               ret;
+    
+    am_wait_init(&trans_wait);
+
+    ret = __i2c_msg_build(p_dev,
+                          sub_addr,
+                          p_buf,
+                          nbytes,
+                          is_read,
+                          trans,
+                          subaddr_buf,
+                          &msg,
+                          __i2c_callback,
+                          &trans_wait);
+    if (ret != AM_OK) {
+        return ret;
     }
     
     ret = am_i2c_msg_start(p_dev->handle, &msg);
@@ -149,4 +183,294 @@ int am_i2c_read (am_i2c_device_t *p_dev,
                          AM_TRUE);
 }
 
+/******************************************************************************/
+
+/* 첽ɻصжģ */
+static void __i2c_async_callback (void *p_arg)
+{
+    am_i2c_async_trans_t *p_trans = (am_i2c_async_trans_t *)p_arg;
+    am_i2c_queue_t       *p_queue = p_trans->p_queue;
+    am_tick_t             latency;
+    int                   key;
+
+    latency = am_sys_tick_diff(p_trans->start_tick, am_sys_tick_get());
+
+    key = am_int_cpu_lock();
+
+    p_queue->depth--;
+    p_queue->done_cnt++;
+    p_queue->latency_sum += latency;
+    if (latency > p_queue->latency_max) {
+        p_queue->latency_max = latency;
+    }
+    if (p_trans->msg.status != AM_OK) {
+        p_queue->err_cnt++;
+    }
+
+    am_int_cpu_unlock(key);
+
+    if (p_trans->pfn_done != NULL) {
+        p_trans->pfn_done(p_trans->p_arg, p_trans->msg.status);
+    }
+}
+
+/******************************************************************************/
+
+static int __i2c_rw_async (am_i2c_queue_t       *p_queue,
+                           am_i2c_async_trans_t *p_trans,
+                           am_i2c_device_t      *p_dev,
+                           uint32_t              sub_addr,
+                           uint8_t              *p_buf,
+                           uint32_t              nbytes,
+                           am_bool_t             is_read,
+                           am_i2c_async_cb_t     pfn_done,
+                           void                 *p_arg)
+{
+    int ret;
+    int key;
+
+    if ((p_queue == NULL) || (p_trans == NULL) || (p_dev == NULL)) {
+        return -AM_EINVAL;
+    }
+
+    ret = __i2c_msg_build(p_dev,
+                          sub_addr,
+                          p_buf,
+                          nbytes,
+                          is_read,
+                          p_trans->trans,
+                          p_trans->subaddr_buf,
+                          &p_trans->msg,
+                          __i2c_async_callback,
+                          p_trans);
+    if (ret != AM_OK) {
+        return ret;
+    }
+
+    p_trans->p_queue    = p_queue;
+    p_trans->pfn_done   = pfn_done;
+    p_trans->p_arg      = p_arg;
+    p_trans->start_tick = am_sys_tick_get();
+
+    /* ȼŶȣϢʱ */
+    key = am_int_cpu_lock();
+    p_queue->depth++;
+    if (p_queue->depth > p_queue->max_depth) {
+        p_queue->max_depth = p_queue->depth;
+    }
+    am_int_cpu_unlock(key);
+
+    ret = am_i2c_msg_start(p_queue->handle, &p_trans->msg);
+
+    if (ret != AM_OK) {
+        key = am_int_cpu_lock();
+        p_queue->depth--;
+        am_int_cpu_unlock(key);
+    }
+
+    return ret;
+}
+
+/******************************************************************************/
+int am_i2c_queue_init (am_i2c_queue_t *p_queue, am_i2c_handle_t handle)
+{
+    if ((p_queue == NULL) || (handle == NULL)) {
+        return -AM_EINVAL;
+    }
+
+    p_queue->handle      = handle;
+    p_queue->depth       = 0;
+    p_queue->max_depth   = 0;
+    p_queue->done_cnt    = 0;
+    p_queue->err_cnt     = 0;
+    p_queue->latency_max = 0;
+    p_queue->latency_sum = 0;
+
+    return AM_OK;
+}
+
+/******************************************************************************/
+int am_i2c_write_async (am_i2c_queue_t       *p_queue,
+                        am_i2c_async_trans_t *p_trans,
+                        am_i2c_device_t      *p_dev,
+                        uint32_t              sub_addr,
+                        const uint8_t        *p_buf,
+                        uint32_t              nbytes,
+                        am_i2c_async_cb_t     pfn_done,
+                        void                 *p_arg)
+{
+    return __i2c_rw_async(p_queue,
+                          p_trans,
+                          p_dev,
+                          sub_addr,
+                          (uint8_t *)p_buf,
+                          nbytes,
+                          AM_FALSE,
+                          pfn_done,
+                          p_arg);
+}
+
+/******************************************************************************/
+int am_i2c_read_async (am_i2c_queue_t       *p_queue,
+                       am_i2c_async_trans_t *p_trans,
+                       am_i2c_device_t      *p_dev,
+                       uint32_t              sub_addr,
+                       uint8_t              *p_buf,
+                       uint32_t              nbytes,
+                       am_i2c_async_cb_t     pfn_done,
+                       void                 *p_arg)
+{
+    return __i2c_rw_async(p_queue,
+                          p_trans,
+                          p_dev,
+                          sub_addr,
+                          p_buf,
+                          nbytes,
+                          AM_TRUE,
+                          pfn_done,
+                          p_arg);
+}
+
+/******************************************************************************/
+int am_i2c_queue_stat_get (am_i2c_queue_t *p_queue, am_i2c_queue_stat_t *p_stat)
+{
+    int key;
+
+    if ((p_queue == NULL) || (p_stat == NULL)) {
+        return -AM_EINVAL;
+    }
+
+    key = am_int_cpu_lock();
+
+    p_stat->depth       = p_queue->depth;
+    p_stat->max_depth   = p_queue->max_depth;
+    p_stat->done_cnt    = p_queue->done_cnt;
+    p_stat->err_cnt     = p_queue->err_cnt;
+    p_stat->latency_max = p_queue->latency_max;
+    p_stat->latency_avg = (p_queue->done_cnt == 0) ?
+                          0 : p_queue->latency_sum / p_queue->done_cnt;
+
+    am_int_cpu_unlock(key);
+
+    return AM_OK;
+}
+
+/******************************************************************************/
+
+/* ִһβʹõĶȴ */
+static int __i2c_calibrate_xfer (am_i2c_handle_t  handle,
+                                 uint16_t         addr,
+                                 uint8_t         *p_buf,
+                                 uint32_t         nbytes)
+{
+    am_i2c_transfer_t trans;
+    am_wait_t         trans_wait;
+    am_i2c_message_t  msg;
+    int               ret;
+
+    am_wait_init(&trans_wait);
+
+    am_i2c_mktrans(&trans, addr, AM_I2C_M_7BIT | AM_I2C_M_RD, p_buf, nbytes);
+    am_i2c_mkmsg(&msg, &trans, 1, __i2c_callback, &trans_wait);
+
+    ret = am_i2c_msg_start(handle, &msg);
+    if (ret != AM_OK) {
+        return ret;
+    }
+
+    am_wait_on(&trans_wait);
+
+    return msg.status;
+}
+
+/******************************************************************************/
+
+/*
+ * Եǰѯֵظʱ*p_count Ϊ 0 ʱٳ ticks ģ
+ * ضĴִ *p_count 
+ */
+static int __i2c_calibrate_run (am_i2c_handle_t  handle,
+                                uint16_t         addr,
+                                uint8_t         *p_buf,
+                                uint32_t         nbytes,
+                                am_tick_t        ticks,
+                                uint32_t        *p_count,
+                                am_tick_t       *p_ticks)
+{
+    am_tick_t start;
+    am_tick_t now;
+    uint32_t  count = 0;
+    int       ret;
+
+    /* ӽıؿʼʱһ */
+    start = am_sys_tick_get();
+    while ((now = am_sys_tick_get()) == start);
+    start = now;
+
+    do {
+        ret = __i2c_calibrate_xfer(handle, addr, p_buf, nbytes);
+        if (ret != AM_OK) {
+            return ret;
+        }
+        count++;
+        now = am_sys_tick_get();
+    } while ((*p_count != 0) ? (count < *p_count) : (now - start < ticks));
+
+    *p_count = count;
+    *p_ticks = now - start;
+
+    return AM_OK;
+}
+
+/******************************************************************************/
+int am_i2c_poll_calibrate (am_i2c_handle_t       handle,
+                           am_i2c_poll_ns_set_t  pfn_poll_ns_set,
+                           uint16_t              addr,
+                           uint8_t              *p_buf,
+                           uint32_t              nbytes,
+                           uint32_t              ms)
+{
+    am_tick_t ticks_int  = 0;
+    am_tick_t ticks_poll = 0;
+    uint32_t  count      = 0;
+    uint32_t  poll_ns;
+    uint64_t  ns;
+    int       ret;
+
+    if ((handle == NULL) || (pfn_poll_ns_set == NULL) ||
+        (p_buf == NULL)  || (nbytes == 0) || (ms == 0)) {
+        return -AM_EINVAL;
+    }
+
+    /* ֵΪ 0 ʱȫʹжϷʽΪֵʱȫѯ */
+    poll_ns = pfn_poll_ns_set(handle, 0);
+
+    ret = __i2c_calibrate_run(handle, addr, p_buf, nbytes,
+                              am_ms_to_ticks(ms), &count, &ticks_int);
+    if (ret == AM_OK) {
+        pfn_poll_ns_set(handle, 0xFFFFFFFF);
+        ret = __i2c_calibrate_run(handle, addr, p_buf, nbytes,
+                                  0, &count, &ticks_poll);
+    }
+
+    if (ret != AM_OK) {
+        pfn_poll_ns_set(handle, poll_ns);
+        return ret;
+    }
+
+    /* ַʽϴʱͬʱ֮ */
+    ns = 0;
+    if (ticks_int > ticks_poll) {
+        ns = (uint64_t)(ticks_int - ticks_poll) * 1000000000u /
+             am_sys_clkrate_get() / count;
+    }
+
+    /* Ϊֵ int Χʱȡֵ */
+    poll_ns = (ns > INT_MAX) ? INT_MAX : (uint32_t)ns;
+
+    pfn_poll_ns_set(handle, poll_ns);
+
+    return (int)poll_ns;
+}
+
 /* end of file */
@@ -0,0 +1,1211 @@
+/*******************************************************************************
+*                                 AMetal
+*                       ----------------------------
+*                       innovating embedded platform
+*
+* Copyright (c) 2001-2018 Guangzhou ZHIYUAN Electronics Co., Ltd.
+* All rights reserved.
+*
+* Contact information:
+* web site:    http://www.zlg.cn/
+*******************************************************************************/
+/**
+ * \file
+ * \brief Key-value store on MTD, append-only log with compaction
+ *
+ * Layout of an erase block:
+ *
+ *   block header (12 bytes) | record | record | ... | erased (0xFF)
+ *
+ * Layout of a record (aligned to 4 bytes):
+ *
+ *   key_len (1) | flags (1) | val_len (2) | crc (4) | key | value | pad
+ *
+ * The crc covers the first 4 bytes of the record header, the key and the
+ * value. The latest record of a key is the one in the block with the largest
+ * sequence number, and the largest offset in that block.
+ *
+ * \internal
+ * \par Modification history
+ * - 1.00 26-10-18  agent, first implementation.
+ * \endinternal
+ */
+#include "ametal.h"
+#include "am_kv.h"
+#include "string.h"
+
+/*******************************************************************************
+    Local defines
+*******************************************************************************/
+
+#define __KV_MAGIC            0x31564b41u    /* "AKV1" */
+
+#define __KV_BLK_HDR_SIZE     12
+#define __KV_REC_HDR_SIZE     8
+
+#define __KV_REC_SIZE(key_len, val_len) \
+    AM_ROUND_UP(__KV_REC_HDR_SIZE + (key_len) + (val_len), 4)
+
+/* the longest record, also the most space wasted at the end of a block */
+#define __KV_REC_MAX          __KV_REC_SIZE(AM_KV_KEY_MAX, AM_KV_VAL_MAX)
+
+#define __KV_FLAG_DEL         0x01           /* deleted (tombstone) record */
+
+#define __KV_ADDR_EMPTY       0xFFFFFFFFu    /* empty index entry          */
+#define __KV_ADDR_DEL         0x80000000u    /* the key has been deleted   */
+
+#define __KV_COPY_SIZE        64             /* stack buffer for copying   */
+
+/* block header */
+struct __kv_blk_hdr {
+    uint32_t  magic;
+    uint32_t  seq;
+    uint32_t  crc;
+};
+
+/* record header */
+struct __kv_rec_hdr {
+    uint8_t   key_len;
+    uint8_t   flags;
+    uint16_t  val_len;
+    uint32_t  crc;
+};
+
+/* record header with the key */
+struct __kv_rec {
+    struct __kv_rec_hdr  hdr;
+    char                 key[AM_KV_KEY_MAX];
+};
+
+/*******************************************************************************
+    Local functions
+*******************************************************************************/
+
+/* crc32 (poly 0x04c11db7, reflected), 4 bits per step, same as am_ftl */
+static uint32_t __kv_crc32 (uint32_t crc, const void *p_data, size_t len)
+{
+    static const uint32_t table[16] = {
+        0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac,
+        0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+        0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c,
+        0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c,
+    };
+
+    const uint8_t *p = (const uint8_t *)p_data;
+
+    while (len--) {
+        crc ^= *p++;
+        crc  = (crc >> 4) ^ table[crc & 0x0F];
+        crc  = (crc >> 4) ^ table[crc & 0x0F];
+    }
+
+    return crc;
+}
+
+/******************************************************************************/
+
+/* FNV-1a hash of the key */
+static uint32_t __kv_hash (const char *p_key, uint32_t key_len)
+{
+    uint32_t hash = 2166136261u;
+
+    while (key_len--) {
+        hash ^= (uint8_t)*p_key++;
+        hash *= 16777619u;
+    }
+
+    return hash ^ (hash >> 16);
+}
+
+/******************************************************************************/
+
+static uint32_t __kv_free_blocks_get (am_kv_serv_t *p_kv)
+{
+    uint32_t i;
+    uint32_t n = 0;
+
+    for (i = 0; i < p_kv->nblocks; i++) {
+        if (p_kv->p_blk[i].seq == 0) {
+            n++;
+        }
+    }
+
+    return n;
+}
+
+/******************************************************************************/
+
+/*
+ * the limit of the live bytes, two blocks are kept for the compaction and
+ * the end of each block may be too short for a record
+ */
+static uint32_t __kv_capacity_get (am_kv_serv_t *p_kv)
+{
+    return (p_kv->nblocks - 2) *
+           (p_kv->blk_size - __KV_BLK_HDR_SIZE - __KV_REC_MAX);
+}
+
+/******************************************************************************/
+
+/*
+ * read the record header and the key, the key is not '\0' terminated
+ *
+ * return AM_OK if it looks like a record, 1 if the space is erased
+ */
+static int __kv_rec_read (am_kv_serv_t    *p_kv,
+                          uint32_t         addr,
+                          struct __kv_rec *p_rec)
+{
+    uint32_t end = AM_ROUND_DOWN(addr, p_kv->blk_size) + p_kv->blk_size;
+    uint32_t len = sizeof(struct __kv_rec);
+    int      ret;
+
+    if (end - addr < __KV_REC_HDR_SIZE) {
+        return 1;
+    }
+
+    if (len > end - addr) {
+        len = end - addr;
+    }
+
+    ret = am_mtd_read(p_kv->mtd, addr, p_rec, len);
+    if (ret < 0) {
+        return ret;
+    }
+
+    if ((p_rec->hdr.key_len == 0xFF) && (p_rec->hdr.flags   == 0xFF) &&
+        (p_rec->hdr.val_len == 0xFFFF) && (p_rec->hdr.crc   == 0xFFFFFFFF)) {
+        return 1;
+    }
+
+    if ((p_rec->hdr.key_len == 0) || (p_rec->hdr.key_len > AM_KV_KEY_MAX) ||
+        (__KV_REC_SIZE(p_rec->hdr.key_len, p_rec->hdr.val_len) >
+                                                               end - addr)) {
+        return -AM_EBADMSG;
+    }
+
+    return AM_OK;
+}
+
+/******************************************************************************/
+
+/* check the crc of a record, the header and the key have been read */
+static int __kv_rec_check (am_kv_serv_t    *p_kv,
+                           uint32_t         addr,
+                           struct __kv_rec *p_rec)
+{
+    uint8_t  buf[__KV_COPY_SIZE];
+    uint32_t crc;
+    uint32_t len = p_rec->hdr.val_len;
+    uint32_t n;
+    int      ret;
+
+    crc = __kv_crc32(0xFFFFFFFF, &p_rec->hdr, 4);
+    crc = __kv_crc32(crc, p_rec->key, p_rec->hdr.key_len);
+
+    addr += __KV_REC_HDR_SIZE + p_rec->hdr.key_len;
+
+    while (len) {
+        n = (len > sizeof(buf)) ? sizeof(buf) : len;
+
+        ret = am_mtd_read(p_kv->mtd, addr, buf, n);
+        if (ret < 0) {
+            return ret;
+        }
+
+        crc   = __kv_crc32(crc, buf, n);
+        addr += n;
+        len  -= n;
+    }
+
+    return (crc == p_rec->hdr.crc) ? AM_OK : -AM_EBADMSG;
+}
+
+/******************************************************************************/
+
+/*
+ * find the index entry of the key, p_rec is filled if found
+ *
+ * return AM_OK if found, 1 if not found (*p_idx is the empty entry to use)
+ */
+static int __kv_index_find (am_kv_serv_t    *p_kv,
+                            const char      *p_key,
+                            uint32_t         key_len,
+                            uint32_t         hash,
+                            struct __kv_rec *p_rec,
+                            uint32_t        *p_idx_ret)
+{
+    struct am_kv_index *p_idx = p_kv->p_idx;
+
+    uint32_t mask = p_kv->p_info->nindex - 1;
+    uint32_t i    = hash & mask;
+    int      ret;
+
+    while (p_idx[i].addr != __KV_ADDR_EMPTY) {
+
+        if (p_idx[i].hash == hash) {
+            ret = __kv_rec_read(p_kv, p_idx[i].addr & ~__KV_ADDR_DEL, p_rec);
+            if (ret < 0) {
+                return ret;
+            }
+
+            if ((ret == AM_OK) && (p_rec->hdr.key_len == key_len) &&
+                (memcmp(p_rec->key, p_key, key_len) == 0)) {
+                *p_idx_ret = i;
+                return AM_OK;
+            }
+        }
+        i = (i + 1) & mask;
+    }
+
+    *p_idx_ret = i;
+
+    return 1;
+}
+
+/******************************************************************************/
+
+/* delete an index entry, the following entries are moved back (linear probe) */
+static void __kv_index_del (am_kv_serv_t *p_kv, uint32_t i)
+{
+    struct am_kv_index *p_idx = p_kv->p_idx;
+
+    uint32_t mask = p_kv->p_info->nindex - 1;
+    uint32_t j    = i;
+    uint32_t home;
+
+    for (;;) {
+        j = (j + 1) & mask;
+
+        if (p_idx[j].addr == __KV_ADDR_EMPTY) {
+            break;
+        }
+
+        /* the entry can stay if its home is cyclically in (i, j] */
+        home = p_idx[j].hash & mask;
+        if ((i <= j) ? ((i < home) && (home <= j)) :
+                       ((i < home) || (home <= j))) {
+            continue;
+        }
+
+        p_idx[i] = p_idx[j];
+        i        = j;
+    }
+
+    p_idx[i].addr = __KV_ADDR_EMPTY;
+    p_kv->nkeys--;
+}
+
+/******************************************************************************/
+
+/*
+ * a new record of the key has been written at addr, update the index
+ *
+ * found and idx are the results of __kv_index_find(), p_old is the old record
+ */
+static void __kv_index_update (am_kv_serv_t    *p_kv,
+                               am_bool_t        found,
+                               uint32_t         idx,
+                               uint32_t         hash,
+                               struct __kv_rec *p_old,
+                               uint32_t         addr,
+                               uint32_t         size,
+                               am_bool_t        is_del)
+{
+    struct am_kv_index *p_idx = p_kv->p_idx;
+
+    uint32_t old_size;
+    uint32_t old_addr;
+
+    if (found) {
+        old_addr = p_idx[idx].addr & ~__KV_ADDR_DEL;
+        old_size = __KV_REC_SIZE(p_old->hdr.key_len, p_old->hdr.val_len);
+
+        p_kv->p_blk[old_addr / p_kv->blk_size].live -= old_size;
+        p_kv->live                                  -= old_size;
+    } else {
+        p_idx[idx].hash = hash;
+        p_kv->nkeys++;
+    }
+
+    p_idx[idx].addr = is_del ? (addr | __KV_ADDR_DEL) : addr;
+
+    p_kv->p_blk[addr / p_kv->blk_size].live += size;
+    p_kv->live                              += size;
+}
+
+/******************************************************************************/
+
+/* erase a block, and it becomes a free block */
+static int __kv_blk_erase (am_kv_serv_t *p_kv, uint32_t blk)
+{
+    int ret;
+
+    ret = am_mtd_erase(p_kv->mtd, blk * p_kv->blk_size, p_kv->blk_size);
+    if (ret < 0) {
+        return ret;
+    }
+
+    p_kv->stat.erases++;
+
+    p_kv->p_blk[blk].seq  = 0;
+    p_kv->p_blk[blk].used = 0;
+    p_kv->p_blk[blk].live = 0;
+
+    return AM_OK;
+}
+
+/******************************************************************************/
+
+/* start a new active block */
+static int __kv_blk_open (am_kv_serv_t *p_kv)
+{
+    struct __kv_blk_hdr hdr;
+
+    uint32_t blk;
+    int      ret;
+
+    for (blk = 0; blk < p_kv->nblocks; blk++) {
+        if (p_kv->p_blk[blk].seq == 0) {
+            break;
+        }
+    }
+
+    if (blk == p_kv->nblocks) {
+        return -AM_ENOSPC;
+    }
+
+    /* not erased yet */
+    if (p_kv->p_blk[blk].used != 0) {
+        ret = __kv_blk_erase(p_kv, blk);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+
+    hdr.magic = __KV_MAGIC;
+    hdr.seq   = p_kv->seq + 1;
+    hdr.crc   = __kv_crc32(0xFFFFFFFF, &hdr, 8);
+
+    ret = am_mtd_write(p_kv->mtd, blk * p_kv->blk_size, &hdr, sizeof(hdr));
+    if (ret < 0) {
+
+        /* the header may be partly written, erase it before the next use */
+        p_kv->p_blk[blk].used = p_kv->blk_size;
+        return ret;
+    }
+
+    p_kv->stat.flash_bytes += sizeof(hdr);
+
+    p_kv->seq             = hdr.seq;
+    p_kv->p_blk[blk].seq  = hdr.seq;
+    p_kv->p_blk[blk].used = __KV_BLK_HDR_SIZE;
+    p_kv->p_blk[blk].live = 0;
+    p_kv->active          = blk;
+
+    return AM_OK;
+}
+
+/******************************************************************************/
+
+/*
+ * close the active block after a failed write, the records after the broken
+ * one can't be found by the mount scan, so the rest of the block is not used
+ */
+static void __kv_blk_close (am_kv_serv_t *p_kv)
+{
+    p_kv->p_blk[p_kv->active].used = p_kv->blk_size;
+    p_kv->active                   = -1;
+}
+
+/******************************************************************************/
+
+static int __kv_gc_step (am_kv_serv_t *p_kv, am_bool_t force);
+
+/*
+ * make sure the active block has space for a record, one free block is
+ * reserved for the compaction
+ *
+ * return AM_OK if the space is ready, or a negative error code
+ */
+static int __kv_space_get (am_kv_serv_t *p_kv, uint32_t size, am_bool_t is_gc)
+{
+    struct am_kv_block *p_blk;
+
+    uint32_t erases = p_kv->stat.erases;
+    int      ret;
+
+    if (p_kv->active >= 0) {
+        p_blk = &p_kv->p_blk[p_kv->active];
+        if (p_blk->used + size <= p_kv->blk_size) {
+            return AM_OK;
+        }
+    }
+
+    if (!is_gc) {
+        while (__kv_free_blocks_get(p_kv) < 2) {
+            ret = __kv_gc_step(p_kv, AM_TRUE);
+            if (ret < 0) {
+                return ret;
+            }
+            if ((ret == 0) || (p_kv->stat.erases - erases > p_kv->nblocks)) {
+                return -AM_ENOSPC;
+            }
+        }
+
+        /* the compaction may leave space in the active block */
+        if (p_kv->active >= 0) {
+            p_blk = &p_kv->p_blk[p_kv->active];
+            if (p_blk->used + size <= p_kv->blk_size) {
+                return AM_OK;
+            }
+        }
+    }
+
+    return __kv_blk_open(p_kv);
+}
+
+/******************************************************************************/
+
+/* append a record to the active block, return the address */
+static int __kv_rec_append (am_kv_serv_t    *p_kv,
+                            struct __kv_rec *p_rec,
+                            const void      *p_val,
+                            uint32_t        *p_addr)
+{
+    static const uint8_t pad[4] = {0xFF, 0xFF, 0xFF, 0xFF};
+
+    am_mtd_iovec_t iov[4];
+    uint32_t       size;
+    uint32_t       addr;
+    int            iovcnt = 0;
+    int            ret;
+
+    size = __KV_REC_SIZE(p_rec->hdr.key_len, p_rec->hdr.val_len);
+
+    ret = __kv_space_get(p_kv, size, AM_FALSE);
+    if (ret < 0) {
+        return ret;
+    }
+
+    p_rec->hdr.crc = __kv_crc32(0xFFFFFFFF, &p_rec->hdr, 4);
+    p_rec->hdr.crc = __kv_crc32(p_rec->hdr.crc, p_rec->key, p_rec->hdr.key_len);
+    p_rec->hdr.crc = __kv_crc32(p_rec->hdr.crc, p_val, p_rec->hdr.val_len);
+
+    iov[iovcnt].p_buf   = p_rec;
+    iov[iovcnt++].len   = __KV_REC_HDR_SIZE + p_rec->hdr.key_len;
+
+    if (p_rec->hdr.val_len) {
+        iov[iovcnt].p_buf = (void *)p_val;
+        iov[iovcnt++].len = p_rec->hdr.val_len;
+    }
+
+    if (size > __KV_REC_HDR_SIZE + p_rec->hdr.key_len + p_rec->hdr.val_len) {
+        iov[iovcnt].p_buf = (void *)pad;
+        iov[iovcnt++].len = size - (__KV_REC_HDR_SIZE +
+                                    p_rec->hdr.key_len + p_rec->hdr.val_len);
+    }
+
+    addr = p_kv->active * p_kv->blk_size + p_kv->p_blk[p_kv->active].used;
+
+    p_kv->p_blk[p_kv->active].used += size;
+
+    ret = am_mtd_writev(p_kv->mtd, addr, iov, iovcnt);
+    if (ret < 0) {
+        __kv_blk_close(p_kv);
+        return ret;
+    }
+
+    p_kv->stat.flash_bytes += size;
+
+    *p_addr = addr;
+
+    return AM_OK;
+}
+
+/******************************************************************************/
+
+/* copy a record to the active block (compaction), return the new address */
+static int __kv_rec_copy (am_kv_serv_t *p_kv,
+                          uint32_t      src,
+                          uint32_t      size,
+                          uint32_t     *p_addr)
+{
+    uint8_t  buf[__KV_COPY_SIZE];
+    uint32_t dst;
+    uint32_t n;
+    int      ret;
+
+    ret = __kv_space_get(p_kv, size, AM_TRUE);
+    if (ret < 0) {
+        return ret;
+    }
+
+    dst     = p_kv->active * p_kv->blk_size + p_kv->p_blk[p_kv->active].used;
+    *p_addr = dst;
+
+    p_kv->p_blk[p_kv->active].used += size;
+
+    while (size) {
+        n = (size > sizeof(buf)) ? sizeof(buf) : size;
+
+        ret = am_mtd_read(p_kv->mtd, src, buf, n);
+        if (ret < 0) {
+            __kv_blk_close(p_kv);
+            return ret;
+        }
+
+        ret = am_mtd_write(p_kv->mtd, dst, buf, n);
+        if (ret < 0) {
+            __kv_blk_close(p_kv);
+            return ret;
+        }
+
+        p_kv->stat.flash_bytes += n;
+
+        src  += n;
+        dst  += n;
+        size -= n;
+    }
+
+    p_kv->stat.gc_copies++;
+
+    return AM_OK;
+}
+
+/******************************************************************************/
+
+/* choose the block with the most stale data to compact */
+static int __kv_gc_victim_get (am_kv_serv_t *p_kv)
+{
+    struct am_kv_block *p_blk;
+
+    uint32_t i;
+    uint32_t dead;
+    uint32_t max    = 0;
+    int      victim = -1;
+
+    for (i = 0; i < p_kv->nblocks; i++) {
+        p_blk = &p_kv->p_blk[i];
+
+        if ((p_blk->seq == 0) || ((int)i == p_kv->active)) {
+            continue;
+        }
+
+        dead = p_blk->used - __KV_BLK_HDR_SIZE - p_blk->live;
+        if (dead > max) {
+            max    = dead;
+            victim = i;
+        }
+    }
+
+    return victim;
+}
+
+/******************************************************************************/
+
+/* find a block without live records besides the one being compacted */
+static int __kv_gc_empty_get (am_kv_serv_t *p_kv)
+{
+    uint32_t i;
+
+    for (i = 0; i < p_kv->nblocks; i++) {
+        if ((p_kv->p_blk[i].seq != 0)       &&
+            (p_kv->p_blk[i].live == 0)      &&
+            ((int)i != p_kv->active)        &&
+            ((int)i != p_kv->gc_blk)) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/******************************************************************************/
+
+/* whether there are blocks older than the block */
+static am_bool_t __kv_blk_older_exist (am_kv_serv_t *p_kv, uint32_t blk)
+{
+    uint32_t i;
+
+    for (i = 0; i < p_kv->nblocks; i++) {
+        if ((i != blk) && (p_kv->p_blk[i].seq != 0) &&
+            (p_kv->p_blk[i].seq < p_kv->p_blk[blk].seq)) {
+            return AM_TRUE;
+        }
+    }
+
+    return AM_FALSE;
+}
+
+/******************************************************************************/
+
+/*
+ * one step of the compaction: copy one live record or erase the block
+ *
+ * if force is AM_FALSE, only compact if free blocks are not enough
+ */
+static int __kv_gc_step (am_kv_serv_t *p_kv, am_bool_t force)
+{
+    struct __kv_rec  rec;
+    uint32_t         addr;
+    uint32_t         new_addr;
+    uint32_t         size;
+    uint32_t         hash;
+    uint32_t         idx;
+    int              ret;
+
+    if (p_kv->gc_blk < 0) {
+
+        if (!force && (__kv_free_blocks_get(p_kv) >= AM_KV_GC_FREE_BLOCKS)) {
+            return 0;
+        }
+
+        p_kv->gc_blk = __kv_gc_victim_get(p_kv);
+        if (p_kv->gc_blk < 0) {
+            return 0;
+        }
+        p_kv->gc_off = __KV_BLK_HDR_SIZE;
+    }
+
+    /* skip the stale records */
+    while (p_kv->gc_off < p_kv->p_blk[p_kv->gc_blk].used) {
+
+        addr = p_kv->gc_blk * p_kv->blk_size + p_kv->gc_off;
+
+        ret = __kv_rec_read(p_kv, addr, &rec);
+        if (ret < 0) {
+
+            /* broken record (power lost), the rest of the block is garbage */
+            if (ret == -AM_EBADMSG) {
+                break;
+            }
+            return ret;
+        }
+        if (ret > 0) {
+            break;
+        }
+
+        size = __KV_REC_SIZE(rec.hdr.key_len, rec.hdr.val_len);
+        hash = __kv_hash(rec.key, rec.hdr.key_len);
+        ret  = __kv_index_find(p_kv,
+                               rec.key,
+                               rec.hdr.key_len,
+                               hash,
+                              &rec,
+                              &idx);
+        if (ret < 0) {
+            return ret;
+        }
+
+        p_kv->gc_off += size;
+
+        if ((ret != AM_OK) ||
+            ((p_kv->p_idx[idx].addr & ~__KV_ADDR_DEL) != addr)) {
+            continue;
+        }
+
+        /* no older record can be revived, the deleted key can be dropped */
+        if ((p_kv->p_idx[idx].addr & __KV_ADDR_DEL) &&
+            !__kv_blk_older_exist(p_kv, p_kv->gc_blk)) {
+            p_kv->p_blk[p_kv->gc_blk].live -= size;
+            p_kv->live                     -= size;
+            __kv_index_del(p_kv, idx);
+            return 1;
+        }
+
+        ret = __kv_rec_copy(p_kv, addr, size, &new_addr);
+        if (ret < 0) {
+            p_kv->gc_off -= size;           /* copy it again in the next step */
+
+            /*
+             * the reserved free block has been used up because a block was
+             * closed by a write error, erase a block needing no copy first
+             */
+            if ((ret == -AM_ENOSPC) &&
+                ((ret = __kv_gc_empty_get(p_kv)) >= 0)) {
+                ret = __kv_blk_erase(p_kv, ret);
+                return (ret < 0) ? ret : 1;
+            }
+            return ret;
+        }
+
+        __kv_index_update(p_kv,
+                          AM_TRUE,
+                          idx,
+                          hash,
+                         &rec,
+                          new_addr,
+                          size,
+                         (p_kv->p_idx[idx].addr & __KV_ADDR_DEL) != 0);
+        return 1;
+    }
+
+    /* all live records have been copied */
+    ret = __kv_blk_erase(p_kv, p_kv->gc_blk);
+    if (ret < 0) {
+        return ret;
+    }
+
+    p_kv->gc_blk = -1;
+
+    return force ? 1 : (__kv_free_blocks_get(p_kv) < AM_KV_GC_FREE_BLOCKS);
+}
+
+/******************************************************************************/
+
+/* background compaction job */
+static void __kv_gc_job (void *p_arg)
+{
+    am_kv_serv_t *p_kv = (am_kv_serv_t *)p_arg;
+
+    if ((p_kv->gc_jobq != NULL) && (__kv_gc_step(p_kv, AM_FALSE) > 0)) {
+        am_jobq_post(p_kv->gc_jobq, &p_kv->gc_job);
+    }
+}
+
+/******************************************************************************/
+
+/* kick the background compaction if free blocks are not enough */
+static void __kv_gc_kick (am_kv_serv_t *p_kv)
+{
+    if (p_kv->gc_jobq == NULL) {
+        return;
+    }
+
+    if ((p_kv->gc_blk >= 0) ||
+        (__kv_free_blocks_get(p_kv) < AM_KV_GC_FREE_BLOCKS)) {
+        am_jobq_post(p_kv->gc_jobq, &p_kv->gc_job);
+    }
+}
+
+/******************************************************************************/
+
+/* replay the records of a block */
+static int __kv_blk_scan (am_kv_serv_t *p_kv, uint32_t blk)
+{
+    struct __kv_rec  rec;
+    struct __kv_rec  old;
+    uint32_t         off = __KV_BLK_HDR_SIZE;
+    uint32_t         addr;
+    uint32_t         size;
+    uint32_t         hash;
+    uint32_t         idx;
+    int              ret;
+
+    while (off < p_kv->blk_size) {
+
+        addr = blk * p_kv->blk_size + off;
+
+        ret = __kv_rec_read(p_kv, addr, &rec);
+        if (ret > 0) {
+            break;                          /* the end of the records */
+        }
+        if (ret == AM_OK) {
+            ret = __kv_rec_check(p_kv, addr, &rec);
+        }
+        if (ret == -AM_EBADMSG) {
+            off = p_kv->blk_size;           /* broken, don't append to it */
+            break;
+        }
+        if (ret < 0) {
+            return ret;
+        }
+
+        size = __KV_REC_SIZE(rec.hdr.key_len, rec.hdr.val_len);
+        hash = __kv_hash(rec.key, rec.hdr.key_len);
+        ret  = __kv_index_find(p_kv,
+                               rec.key,
+                               rec.hdr.key_len,
+                               hash,
+                              &old,
+                              &idx);
+        if (ret < 0) {
+            return ret;
+        }
+
+        /* keep at least one empty entry to end the probing */
+        if ((ret != AM_OK) && (p_kv->nkeys >= p_kv->p_info->nindex - 1)) {
+            return -AM_ENOMEM;
+        }
+
+        __kv_index_update(p_kv,
+                          ret == AM_OK,
+                          idx,
+                          hash,
+                         &old,
+                          addr,
+                          size,
+                          (rec.hdr.flags & __KV_FLAG_DEL) != 0);
+        off += size;
+    }
+
+    p_kv->p_blk[blk].used = off;
+
+    return AM_OK;
+}
+
+/******************************************************************************/
+
+static int __kv_mount (am_kv_serv_t *p_kv)
+{
+    struct __kv_blk_hdr hdr;
+
+    uint32_t blk;
+    uint32_t last = 0;
+    uint32_t next;
+    int      newest = -1;
+    int      ret;
+
+    for (blk = 0; blk < p_kv->nblocks; blk++) {
+
+        ret = am_mtd_read(p_kv->mtd, blk * p_kv->blk_size, &hdr, sizeof(hdr));
+        if (ret < 0) {
+            return ret;
+        }
+
+        p_kv->p_blk[blk].live = 0;
+
+        if ((hdr.magic == __KV_MAGIC) && (hdr.seq != 0) &&
+            (hdr.crc == __kv_crc32(0xFFFFFFFF, &hdr, 8))) {
+            p_kv->p_blk[blk].seq  = hdr.seq;
+            p_kv->p_blk[blk].used = __KV_BLK_HDR_SIZE;
+        } else {
+
+            /* free block, state unknown, erase it before use */
+            p_kv->p_blk[blk].seq  = 0;
+            p_kv->p_blk[blk].used = p_kv->blk_size;
+        }
+    }
+
+    /* replay the blocks from the oldest to the newest */
+    for (;;) {
+        next = 0xFFFFFFFF;
+
+        for (blk = 0; blk < p_kv->nblocks; blk++) {
+            if ((p_kv->p_blk[blk].seq > last) &&
+                (p_kv->p_blk[blk].seq < next)) {
+                next   = p_kv->p_blk[blk].seq;
+                newest = blk;
+            }
+        }
+
+        if (next == 0xFFFFFFFF) {
+            break;
+        }
+
+        ret = __kv_blk_scan(p_kv, newest);
+        if (ret < 0) {
+            return ret;
+        }
+
+        last = next;
+    }
+
+    p_kv->seq    = last;
+    p_kv->active = -1;
+
+    /* continue writing the newest block */
+    if ((newest >= 0) && (p_kv->p_blk[newest].used < p_kv->blk_size)) {
+        p_kv->active = newest;
+    }
+
+    return AM_OK;
+}
+
+/*******************************************************************************
+    Public functions
+*******************************************************************************/
+
+am_kv_handle_t am_kv_init (am_kv_serv_t       *p_kv,
+                           const am_kv_info_t *p_info,
+                           am_mtd_handle_t     mtd)
+{
+    uint32_t nblocks;
+    uint32_t i;
+
+    if ((p_kv == NULL) || (p_info == NULL) || (mtd == NULL) ||
+        (p_info->p_buf == NULL) || (p_info->nindex < 4) ||
+        ((p_info->nindex & (p_info->nindex - 1)) != 0)) {
+        return NULL;
+    }
+
+    /* records are written byte by byte */
+    if ((mtd->write_size != 1) || (mtd->erase_size == 0)) {
+        return NULL;
+    }
+
+    nblocks = mtd->size / mtd->erase_size;
+
+    if ((nblocks < 3) || (mtd->size > __KV_ADDR_DEL) ||
+        (__KV_REC_MAX * 2 > mtd->erase_size - __KV_BLK_HDR_SIZE) ||
+        (p_info->len < AM_KV_RAM_SIZE_GET(mtd->size,
+                                          mtd->erase_size,
+                                          p_info->nindex))) {
+        return NULL;
+    }
+
+    p_kv->mtd      = mtd;
+    p_kv->p_info   = p_info;
+    p_kv->nblocks  = nblocks;
+    p_kv->blk_size = mtd->erase_size;
+    p_kv->p_blk    = (struct am_kv_block *)p_info->p_buf;
+    p_kv->p_idx    = (struct am_kv_index *)(p_info->p_buf +
+                                nblocks * sizeof(struct am_kv_block));
+    p_kv->nkeys    = 0;
+    p_kv->live     = 0;
+    p_kv->seq      = 0;
+    p_kv->active   = -1;
+    p_kv->gc_blk   = -1;
+    p_kv->gc_off   = 0;
+    p_kv->gc_jobq  = NULL;
+
+    memset(&p_kv->stat, 0, sizeof(p_kv->stat));
+
+    for (i = 0; i < p_info->nindex; i++) {
+        p_kv->p_idx[i].addr = __KV_ADDR_EMPTY;
+    }
+
+    am_jobq_job_init(&p_kv->gc_job, __kv_gc_job, p_kv, 0);
+
+    if (__kv_mount(p_kv) != AM_OK) {
+        return NULL;
+    }
+
+    return p_kv;
+}
+
+/******************************************************************************/
+int am_kv_set (am_kv_handle_t  handle,
+               const char     *p_key,
+               const void     *p_val,
+               size_t          len)
+{
+    struct __kv_rec  rec;
+    struct __kv_rec  old;
+    uint32_t         key_len;
+    uint32_t         size;
+    uint32_t         old_size = 0;
+    uint32_t         hash;
+    uint32_t         addr;
+    uint32_t         idx;
+    int              ret;
+
+    if ((handle == NULL) || (p_key == NULL) || ((p_val == NULL) && len)) {
+        return -AM_EINVAL;
+    }
+
+    key_len = strlen(p_key);
+    if ((key_len == 0) || (key_len > AM_KV_KEY_MAX) || (len > AM_KV_VAL_MAX)) {
+        return -AM_EINVAL;
+    }
+
+    size = __KV_REC_SIZE(key_len, len);
+
+    hash = __kv_hash(p_key, key_len);
+    ret  = __kv_index_find(handle, p_key, key_len, hash, &old, &idx);
+    if (ret < 0) {
+        return ret;
+    }
+
+    if (ret == AM_OK) {
+        old_size = __KV_REC_SIZE(old.hdr.key_len, old.hdr.val_len);
+    } else if (handle->nkeys >= handle->p_info->nindex / 4 * 3) {
+        return -AM_ENOMEM;
+    }
+
+    if (handle->live - old_size + size > __kv_capacity_get(handle)) {
+        return -AM_ENOSPC;
+    }
+
+    rec.hdr.key_len = key_len;
+    rec.hdr.flags   = 0;
+    rec.hdr.val_len = len;
+    memcpy(rec.key, p_key, key_len);
+
+    ret = __kv_rec_append(handle, &rec, p_val, &addr);
+    if (ret < 0) {
+        return ret;
+    }
+
+    /* the compaction may have moved the old record */
+    ret = __kv_index_find(handle, p_key, key_len, hash, &old, &idx);
+    if (ret < 0) {
+        return ret;
+    }
+
+    __kv_index_update(handle,
+                      ret == AM_OK,
+                      idx,
+                      hash,
+                     &old,
+                      addr,
+                      size,
+                      AM_FALSE);
+
+    handle->stat.user_bytes += key_len + len;
+
+    __kv_gc_kick(handle);
+
+    return AM_OK;
+}
+
+/******************************************************************************/
+int am_kv_get (am_kv_handle_t  handle,
+               const char     *p_key,
+               void           *p_buf,
+               size_t          len)
+{
+    struct __kv_rec  rec;
+    uint32_t         key_len;
+    uint32_t         addr;
+    uint32_t         idx;
+    int              ret;
+
+    if ((handle == NULL) || (p_key == NULL) || ((p_buf == NULL) && len)) {
+        return -AM_EINVAL;
+    }
+
+    key_len = strlen(p_key);
+    if ((key_len == 0) || (key_len > AM_KV_KEY_MAX)) {
+        return -AM_EINVAL;
+    }
+
+    ret = __kv_index_find(handle,
+                          p_key,
+                          key_len,
+                          __kv_hash(p_key, key_len),
+                         &rec,
+                         &idx);
+    if (ret < 0) {
+        return ret;
+    }
+
+    if ((ret != AM_OK) || (handle->p_idx[idx].addr & __KV_ADDR_DEL)) {
+        return -AM_ENOENT;
+    }
+
+    addr = handle->p_idx[idx].addr + __KV_REC_HDR_SIZE + key_len;
+
+    if (len > rec.hdr.val_len) {
+        len = rec.hdr.val_len;
+    }
+
+    if (len) {
+        ret = am_mtd_read(handle->mtd, addr, p_buf, len);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+
+    return rec.hdr.val_len;
+}
+
+/******************************************************************************/
+int am_kv_del (am_kv_handle_t handle, const char *p_key)
+{
+    struct __kv_rec  rec;
+    struct __kv_rec  old;
+    uint32_t         key_len;
+    uint32_t         size;
+    uint32_t         hash;
+    uint32_t         addr;
+    uint32_t         idx;
+    int              ret;
+
+    if ((handle == NULL) || (p_key == NULL)) {
+        return -AM_EINVAL;
+    }
+
+    key_len = strlen(p_key);
+    if ((key_len == 0) || (key_len > AM_KV_KEY_MAX)) {
+        return -AM_EINVAL;
+    }
+
+    hash = __kv_hash(p_key, key_len);
+    ret  = __kv_index_find(handle, p_key, key_len, hash, &old, &idx);
+    if (ret < 0) {
+        return ret;
+    }
+
+    if ((ret != AM_OK) || (handle->p_idx[idx].addr & __KV_ADDR_DEL)) {
+        return -AM_ENOENT;
+    }
+
+    rec.hdr.key_len = key_len;
+    rec.hdr.flags   = __KV_FLAG_DEL;
+    rec.hdr.val_len = 0;
+    memcpy(rec.key, p_key, key_len);
+
+    size = __KV_REC_SIZE(key_len, 0);
+
+    ret = __kv_rec_append(handle, &rec, NULL, &addr);
+    if (ret < 0) {
+        return ret;
+    }
+
+    ret = __kv_index_find(handle, p_key, key_len, hash, &old, &idx);
+    if (ret < 0) {
+        return ret;
+    }
+
+    __kv_index_update(handle,
+                      ret == AM_OK,
+                      idx,
+                      hash,
+                     &old,
+                      addr,
+                      size,
+                      AM_TRUE);
+
+    __kv_gc_kick(handle);
+
+    return AM_OK;
+}
+
+/******************************************************************************/
+int am_kv_gc_jobq_set (am_kv_handle_t    handle,
+                       am_jobq_handle_t  jobq,
+                       uint16_t          pri)
+{
+    if (handle == NULL) {
+        return -AM_EINVAL;
+    }
+
+    am_jobq_job_init(&handle->gc_job, __kv_gc_job, handle, pri);
+
+    handle->gc_jobq = jobq;
+
+    __kv_gc_kick(handle);
+
+    return AM_OK;
+}
+
+/******************************************************************************/
+int am_kv_gc_step (am_kv_handle_t handle)
+{
+    if (handle == NULL) {
+        return -AM_EINVAL;
+    }
+
+    return __kv_gc_step(handle, AM_FALSE);
+}
+
+/******************************************************************************/
+int am_kv_stat_get (am_kv_handle_t handle, am_kv_stat_t *p_stat)
+{
+    if ((handle == NULL) || (p_stat == NULL)) {
+        return -AM_EINVAL;
+    }
+
+    *p_stat = handle->stat;
+
+    p_stat->nkeys       = handle->nkeys;
+    p_stat->live_bytes  = handle->live;
+    p_stat->capacity    = __kv_capacity_get(handle);
+    p_stat->free_blocks = __kv_free_blocks_get(handle);
+
+    return AM_OK;
+}
+
+/* end of file */
@@ -71,6 +71,35 @@ int am_mtd_erase (am_mtd_handle_t     handle,
     return ret;
 }
 
+/******************************************************************************/
+int am_mtd_erase_start (am_mtd_handle_t            handle,
+                        struct am_mtd_erase_info  *p_info)
+{
+    if ((handle == NULL) || (p_info == NULL) || (p_info->pfn_callback == NULL)) {
+        return -AM_EINVAL;
+    }
+
+    if ((p_info->addr > handle->size) ||
+        (p_info->len  > (handle->size - p_info->addr))) {
+        return -AM_EINVAL;
+    }
+
+    if (!(handle->flags & AM_MTD_FLAG_WRITEABLE)) {
+        return -AM_EROFS;
+    }
+
+    p_info->fail_addr = AM_MTD_ERASE_FAIL_ADDR_UNKNOWN;
+    p_info->state     = AM_MTD_ERASE_PENDING;
+
+    if ((handle->flags & AM_MTD_FLAG_NO_ERASE) || (p_info->len == 0)) {
+        p_info->state = AM_MTD_ERASE_DONE;
+        p_info->pfn_callback(p_info);
+        return AM_OK;
+    }
+
+    return handle->p_ops->pfn_mtd_erase(handle->p_drv, p_info);
+}
+
 int am_mtd_read (am_mtd_handle_t     handle,
                  uint32_t            addr,
                  void               *p_buf,
@@ -121,4 +150,141 @@ int am_mtd_write (am_mtd_handle_t     handle,
     return handle->p_ops->pfn_mtd_write(handle->p_drv, addr, p_buf, len);
 }
 
+/******************************************************************************/
+
+/* get the total length of the buffers */
+static int __mtd_iov_len_get (am_mtd_handle_t       handle,
+                              uint32_t              addr,
+                              const am_mtd_iovec_t *p_iov,
+                              int                   iovcnt,
+                              uint32_t             *p_len)
+{
+    uint32_t len = 0;
+    int      i;
+
+    if ((handle == NULL) || (p_iov == NULL) || (iovcnt < 0)) {
+        return -AM_EINVAL;
+    }
+
+    for (i = 0; i < iovcnt; i++) {
+        if ((p_iov[i].len != 0) && (p_iov[i].p_buf == NULL)) {
+            return -AM_EINVAL;
+        }
+
+        /* longer than the device, also the sum can't wrap */
+        if (p_iov[i].len > handle->size - len) {
+            return -AM_EINVAL;
+        }
+        len += p_iov[i].len;
+    }
+
+    /* the length is returned as int */
+    if ((addr > handle->size) || (len > (handle->size - addr)) ||
+        (len > 0x7FFFFFFF)) {
+        return -AM_EINVAL;
+    }
+
+    *p_len = len;
+
+    return AM_OK;
+}
+
+/******************************************************************************/
+int am_mtd_readv (am_mtd_handle_t       handle,
+                  uint32_t              addr,
+                  const am_mtd_iovec_t *p_iov,
+                  int                   iovcnt)
+{
+    uint32_t len;
+    int      ret;
+    int      i;
+
+    ret = __mtd_iov_len_get(handle, addr, p_iov, iovcnt, &len);
+
+    if (ret != AM_OK) {
+        return ret;
+    }
+
+    if (!len) {
+        return AM_OK;
+    }
+
+    if (handle->p_ops->pfn_mtd_readv) {
+        return handle->p_ops->pfn_mtd_readv(handle->p_drv, addr, p_iov, iovcnt);
+    }
+
+    /* the driver don't support, read one by one */
+    for (i = 0; i < iovcnt; i++) {
+
+        if (!p_iov[i].len) {
+            continue;
+        }
+
+        ret = handle->p_ops->pfn_mtd_read(handle->p_drv,
+                                          addr,
+                                          p_iov[i].p_buf,
+                                          p_iov[i].len);
+        if (ret < 0) {
+            return ret;
+        }
+
+        addr += p_iov[i].len;
+    }
+
+    return len;
+}
+
+/******************************************************************************/
+int am_mtd_writev (am_mtd_handle_t       handle,
+                   uint32_t              addr,
+                   const am_mtd_iovec_t *p_iov,
+                   int                   iovcnt)
+{
+    uint32_t len;
+    int      ret;
+    int      i;
+
+    ret = __mtd_iov_len_get(handle, addr, p_iov, iovcnt, &len);
+
+    if (ret != AM_OK) {
+        return ret;
+    }
+
+    if (!(handle->p_ops->pfn_mtd_write)         ||
+        !(handle->flags & AM_MTD_FLAG_WRITEABLE)) {
+        return -AM_EROFS;
+    }
+
+    if (!len) {
+        return AM_OK;
+    }
+
+    if (handle->p_ops->pfn_mtd_writev) {
+        return handle->p_ops->pfn_mtd_writev(handle->p_drv,
+                                             addr,
+                                             p_iov,
+                                             iovcnt);
+    }
+
+    /* the driver don't support, write one by one */
+    for (i = 0; i < iovcnt; i++) {
+
+        if (!p_iov[i].len) {
+            continue;
+        }
+
+        ret = handle->p_ops->pfn_mtd_write(handle->p_drv,
+                                           addr,
+                                           p_iov[i].p_buf,
+                                           p_iov[i].len);
+        if (ret < 0) {
+            return ret;
+        }
+
+        addr += p_iov[i].len;
+    }
+
+    return len;
+}
+
 /* end of file */
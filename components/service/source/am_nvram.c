@@ -31,14 +31,112 @@
 am_local am_nvram_dev_t           *__gp_nvram_dev_list = NULL;
 am_local const am_nvram_segment_t *__gp_seg_list       = NULL;
 
+/* increased when a device is unregistered, the opened handles check it */
+am_local uint32_t                  __g_nvram_dev_gen   = 0;
+
+#if AM_NVRAM_HASH_SIZE > 0
+
+#if (AM_NVRAM_HASH_SIZE & (AM_NVRAM_HASH_SIZE - 1)) != 0
+#error "AM_NVRAM_HASH_SIZE must be 0 or a power of 2"
+#endif
+
+/* hash table of the segments, segment index + 1, 0 means empty */
+am_local uint16_t                  __g_seg_hash[AM_NVRAM_HASH_SIZE];
+
+/* some segments are not in the hash table, search the list if not found */
+am_local am_bool_t                 __g_seg_hash_full   = AM_FALSE;
+
+#endif
+
 /*******************************************************************************
   local functions
 *******************************************************************************/
 
+#if AM_NVRAM_HASH_SIZE > 0
+
+/* FNV-1a hash of the name and unit */
+am_local uint32_t __nvram_hash (const char *p_name, int unit)
+{
+    uint32_t hash = 2166136261u;
+
+    while (*p_name) {
+        hash ^= (uint8_t)*p_name++;
+        hash *= 16777619u;
+    }
+
+    hash ^= (uint32_t)unit;
+    hash *= 16777619u;
+
+    return hash ^ (hash >> 16);
+}
+
+/******************************************************************************/
+
+/* build the hash table, the table is used at most 3/4 */
+am_local void __nvram_hash_build (void)
+{
+    const am_nvram_segment_t *p_seg = __gp_seg_list;
+
+    uint32_t idx;
+    uint32_t nsegs = 0;
+
+    memset(__g_seg_hash, 0, sizeof(__g_seg_hash));
+    __g_seg_hash_full = AM_FALSE;
+
+    while (p_seg && (p_seg->p_name)) {
+
+        if ((nsegs >= AM_NVRAM_HASH_SIZE / 4 * 3) || (nsegs >= 0xFFFF)) {
+            __g_seg_hash_full = AM_TRUE;
+            break;
+        }
+
+        /* linear probing, same segments are found in the list order */
+        idx = __nvram_hash(p_seg->p_name, p_seg->unit) &
+              (AM_NVRAM_HASH_SIZE - 1);
+
+        while (__g_seg_hash[idx] != 0) {
+            idx = (idx + 1) & (AM_NVRAM_HASH_SIZE - 1);
+        }
+
+        __g_seg_hash[idx] = (uint16_t)(++nsegs);
+        p_seg++;
+    }
+}
+
+#endif
+
+/******************************************************************************/
+
 am_local const am_nvram_segment_t *__nvram_segment_query (const char *p_name, int unit)
 {
     const am_nvram_segment_t *p_seg = __gp_seg_list;
 
+#if AM_NVRAM_HASH_SIZE > 0
+    uint32_t idx;
+
+    if ((p_seg == NULL) || (p_name == NULL)) {
+        return NULL;
+    }
+
+    idx = __nvram_hash(p_name, unit) & (AM_NVRAM_HASH_SIZE - 1);
+
+    while (__g_seg_hash[idx] != 0) {
+
+        p_seg = &__gp_seg_list[__g_seg_hash[idx] - 1];
+
+        if ((p_seg->unit == unit) && (strcmp(p_seg->p_name, p_name) == 0)) {
+            return p_seg;
+        }
+        idx = (idx + 1) & (AM_NVRAM_HASH_SIZE - 1);
+    }
+
+    if (!__g_seg_hash_full) {
+        return NULL;
+    }
+
+    p_seg = __gp_seg_list;
+#endif
+
     while (p_seg && (p_seg->p_name)) {
 
         if ((p_seg->unit == unit) && (strcmp(p_seg->p_name, p_name) == 0)) {
@@ -58,7 +156,9 @@ am_local am_nvram_dev_t *__nvram_dev_query (const char *p_name)
 
     while (p_dev && (p_dev->p_dev_name)) {
 
-        if (strcmp(p_dev->p_dev_name, p_name) == 0) {      /* find the device */
+        /* the segments and the driver usually share the same name string */
+        if ((p_dev->p_dev_name == p_name) ||
+            (strcmp(p_dev->p_dev_name, p_name) == 0)) {    /* find the device */
             return p_dev;
         }
         p_dev = p_dev->p_next;
@@ -69,28 +169,13 @@ am_local am_nvram_dev_t *__nvram_dev_query (const char *p_name)
 
 /******************************************************************************/
 
-am_local int __nvram_process (const char        *p_name,
-                              int                unit,
-                              uint8_t           *p_buf,
-                              int                offset,
-                              int                len,
-                              am_bool_t          is_get)
+am_local int __nvram_seg_process (const am_nvram_segment_t *p_seg,
+                                  const am_nvram_dev_t     *p_dev,
+                                  uint8_t                  *p_buf,
+                                  int                       offset,
+                                  int                       len,
+                                  am_bool_t                 is_get)
 {
-    const am_nvram_segment_t *p_seg = NULL;
-    const am_nvram_dev_t     *p_dev = NULL;
-
-    p_seg = __nvram_segment_query(p_name, unit);
-
-    if (p_seg == NULL) {     /* Can't find the segment */
-        return -AM_EINVAL;
-    }
-
-    p_dev = __nvram_dev_query(p_seg->p_dev_name);
-
-    if (p_dev == NULL) {     /* Can't find the device */
-        return -AM_ENODEV;
-    }
-
     /* no data will be read or written */
     if (len == 0) {
         return AM_OK;
@@ -126,6 +211,63 @@ am_local int __nvram_process (const char        *p_name,
     return -AM_EIO;
 }
 
+/******************************************************************************/
+
+am_local int __nvram_process (const char        *p_name,
+                              int                unit,
+                              uint8_t           *p_buf,
+                              int                offset,
+                              int                len,
+                              am_bool_t          is_get)
+{
+    const am_nvram_segment_t *p_seg = NULL;
+    const am_nvram_dev_t     *p_dev = NULL;
+
+    p_seg = __nvram_segment_query(p_name, unit);
+
+    if (p_seg == NULL) {     /* Can't find the segment */
+        return -AM_EINVAL;
+    }
+
+    p_dev = __nvram_dev_query(p_seg->p_dev_name);
+
+    if (p_dev == NULL) {     /* Can't find the device */
+        return -AM_ENODEV;
+    }
+
+    return __nvram_seg_process(p_seg, p_dev, p_buf, offset, len, is_get);
+}
+
+/******************************************************************************/
+
+am_local int __nvram_hdl_process (am_nvram_seg_handle_t *p_hdl,
+                                  uint8_t               *p_buf,
+                                  int                    offset,
+                                  int                    len,
+                                  am_bool_t              is_get)
+{
+    if ((p_hdl == NULL) || (p_hdl->p_seg == NULL)) {
+        return -AM_EINVAL;
+    }
+
+    /* some device has been unregistered, find the device again */
+    if ((p_hdl->p_dev == NULL) || (p_hdl->dev_gen != __g_nvram_dev_gen)) {
+        p_hdl->dev_gen = __g_nvram_dev_gen;
+        p_hdl->p_dev   = __nvram_dev_query(p_hdl->p_seg->p_dev_name);
+    }
+
+    if (p_hdl->p_dev == NULL) {
+        return -AM_ENODEV;
+    }
+
+    return __nvram_seg_process(p_hdl->p_seg,
+                               p_hdl->p_dev,
+                               p_buf,
+                               offset,
+                               len,
+                               is_get);
+}
+
 /*******************************************************************************
   public functions
 *******************************************************************************/
@@ -136,6 +278,12 @@ int am_nvram_init (const am_nvram_segment_t *p_seglist)
     __gp_nvram_dev_list = NULL;
     __gp_seg_list       = p_seglist;
 
+    __g_nvram_dev_gen++;
+
+#if AM_NVRAM_HASH_SIZE > 0
+    __nvram_hash_build();
+#endif
+
     return AM_OK;
 }
 /******************************************************************************/
@@ -184,6 +332,9 @@ int am_nvram_dev_unregister (am_nvram_dev_t *p_dev)
         if (p_head->p_next == p_dev) {
             p_head->p_next = p_dev->p_next;
             p_dev->p_next  = NULL;
+
+            /* the opened handles are out of date */
+            __g_nvram_dev_gen++;
             break;
         }
         p_head = p_head->p_next;
@@ -237,4 +388,49 @@ int am_nvram_size_get (char *p_name, int unit, size_t *p_size)
     return AM_OK;
 }
 
+/******************************************************************************/
+
+int am_nvram_open (am_nvram_seg_handle_t *p_hdl, const char *p_name, int unit)
+{
+    if ((p_hdl == NULL) || (p_name == NULL)) {
+        return -AM_EINVAL;
+    }
+
+    p_hdl->p_dev   = NULL;
+    p_hdl->dev_gen = __g_nvram_dev_gen;
+    p_hdl->p_seg   = __nvram_segment_query(p_name, unit);
+
+    if (p_hdl->p_seg == NULL) {     /* Can't find the segment */
+        return -AM_EINVAL;
+    }
+
+    p_hdl->p_dev = __nvram_dev_query(p_hdl->p_seg->p_dev_name);
+
+    if (p_hdl->p_dev == NULL) {     /* Can't find the device */
+        return -AM_ENODEV;
+    }
+
+    return AM_OK;
+}
+
+/******************************************************************************/
+
+int am_nvram_read (am_nvram_seg_handle_t *p_hdl,
+                   uint8_t               *p_buf,
+                   int                    offset,
+                   int                    len)
+{
+    return __nvram_hdl_process(p_hdl, p_buf, offset, len, AM_TRUE);
+}
+
+/******************************************************************************/
+
+int am_nvram_write (am_nvram_seg_handle_t *p_hdl,
+                    uint8_t               *p_buf,
+                    int                    offset,
+                    int                    len)
+{
+    return __nvram_hdl_process(p_hdl, p_buf, offset, len, AM_FALSE);
+}
+
 /* end of file */
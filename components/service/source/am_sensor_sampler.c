@@ -0,0 +1,330 @@
+/*******************************************************************************
+*                                 AMetal
+*                       ----------------------------
+*                       innovating embedded platform
+*
+* Copyright (c) 2001-2018 Guangzhou ZHIYUAN Electronics Co., Ltd.
+* All rights reserved.
+*
+* Contact information:
+* web site:    http://www.zlg.cn/
+*******************************************************************************/
+
+/**
+ * \file
+ * \brief ȷʵ
+ *
+ * \internal
+ * \par modification history:
+ * - 1.00 26-10-18  agent, first implementation
+ * \endinternal
+ */
+
+#include "am_common.h"
+#include "am_sensor_sampler.h"
+#include "am_system.h"
+#include "am_int.h"
+
+/*******************************************************************************
+  Local functions
+*******************************************************************************/
+
+/**
+ * \brief дһʱڲеã
+ */
+am_local void __sampler_put (am_sensor_sampler_t *p_sampler,
+                             am_tick_t            tick,
+                             am_sensor_handle_t   handle,
+                             int                  id,
+                             am_sensor_val_t     *p_val)
+{
+    am_sensor_sample_t *p_sample;
+    uint32_t            head = p_sampler->head;
+
+    if (head - p_sampler->tail > p_sampler->mask) {
+        p_sampler->overrun++;
+        return;
+    }
+
+    p_sample         = &p_sampler->p_buf[head & p_sampler->mask];
+    p_sample->tick   = tick;
+    p_sample->handle = handle;
+    p_sample->id     = id;
+    p_sample->val    = *p_val;
+
+    /* дɺٸд */
+    am_barrier();
+    p_sampler->head = head + 1;
+    p_sampler->nsamples++;
+}
+
+/**
+ * \brief һԴһβȫͨһζȡ
+ */
+am_local void __sampler_src_sample (am_sensor_sampler_t     *p_sampler,
+                                    am_sensor_sampler_src_t *p_src,
+                                    am_tick_t                tick)
+{
+    am_sensor_val_t val[AM_SENSOR_SAMPLER_CHAN_MAX];
+    int             i;
+
+    p_sampler->nreads++;
+
+    if (am_sensor_data_get(p_src->handle,
+                           p_src->p_ids,
+                           p_src->num,
+                           val) != AM_OK) {
+        p_sampler->err_cnt++;
+        return;
+    }
+
+    for (i = 0; i < p_src->num; i++) {
+        if (val[i].unit != AM_SENSOR_UNIT_INVALID) {
+            __sampler_put(p_sampler,
+                          tick,
+                          p_src->handle,
+                          p_src->p_ids[i],
+                         &val[i]);
+        }
+    }
+}
+
+/**
+ * \brief жӳִУеڵĲԴʱ
+ */
+am_local void __sampler_job (void *p_arg)
+{
+    am_sensor_sampler_t     *p_sampler = (am_sensor_sampler_t *)p_arg;
+    am_sensor_sampler_src_t *p_src;
+    struct am_list_head     *p_node;
+    am_tick_t                batch;
+    am_tick_t                now;
+    am_tick_t                wait;
+    am_tick_t                min_wait = (am_tick_t)-1;
+
+    if (!p_sampler->running) {
+        return;
+    }
+
+    batch = am_ms_to_ticks(AM_SENSOR_SAMPLER_BATCH_MS);
+    now   = am_sys_tick_get();
+
+    am_list_for_each(p_node, &p_sampler->src_list) {
+        p_src = am_list_entry(p_node, am_sensor_sampler_src_t, node);
+        wait  = am_sys_tick_diff(now, p_src->next_tick);
+
+        /* ѵڣǰ */
+        if ((int32_t)wait <= (int32_t)batch) {
+
+            __sampler_src_sample(p_sampler, p_src, now);
+
+            /* ̶ֹһٲ */
+            p_src->next_tick += p_src->period_ticks;
+            if ((int32_t)am_sys_tick_diff(now, p_src->next_tick) <= 0) {
+                p_src->next_tick = now + p_src->period_ticks;
+            }
+        }
+
+        wait = am_sys_tick_diff(now, p_src->next_tick);
+        if (wait < min_wait) {
+            min_wait = wait;
+        }
+    }
+
+    if (min_wait != (am_tick_t)-1) {
+        wait = am_ticks_to_ms(min_wait);
+        am_softimer_start(&p_sampler->timer, (wait == 0) ? 1 : wait);
+    }
+}
+
+/**
+ * \brief ȶʱصһδʵʲɲִ
+ */
+am_local void __sampler_timer_cb (void *p_arg)
+{
+    am_sensor_sampler_t *p_sampler = (am_sensor_sampler_t *)p_arg;
+
+    am_softimer_stop(&p_sampler->timer);
+    am_isr_defer_job_add(&p_sampler->job);
+}
+
+/*******************************************************************************
+  Public functions
+*******************************************************************************/
+
+am_err_t am_sensor_sampler_init (am_sensor_sampler_t *p_sampler,
+                                 am_sensor_sample_t  *p_buf,
+                                 uint32_t             nsamples)
+{
+    int ret;
+
+    if ((p_sampler == NULL) || (p_buf == NULL) ||
+        (nsamples == 0) || ((nsamples & (nsamples - 1)) != 0)) {
+        return -AM_EINVAL;
+    }
+
+    ret = am_softimer_init(&p_sampler->timer, __sampler_timer_cb, p_sampler);
+    if (ret != AM_OK) {
+        return ret;
+    }
+
+    am_isr_defer_job_init(&p_sampler->job, __sampler_job, p_sampler, 1);
+
+    am_list_head_init(&p_sampler->src_list);
+
+    p_sampler->p_buf    = p_buf;
+    p_sampler->mask     = nsamples - 1;
+    p_sampler->head     = 0;
+    p_sampler->tail     = 0;
+    p_sampler->running  = AM_FALSE;
+    p_sampler->nreads   = 0;
+    p_sampler->nsamples = 0;
+    p_sampler->overrun  = 0;
+    p_sampler->err_cnt  = 0;
+
+    return AM_OK;
+}
+
+/******************************************************************************/
+am_err_t am_sensor_sampler_add (am_sensor_sampler_t     *p_sampler,
+                                am_sensor_sampler_src_t *p_src,
+                                am_sensor_handle_t       handle,
+                                const int               *p_ids,
+                                int                      num,
+                                uint32_t                 period_ms)
+{
+    int key;
+
+    if ((p_sampler == NULL) || (p_src == NULL) || (handle == NULL) ||
+        (p_ids == NULL) || (num <= 0) || (num > AM_SENSOR_SAMPLER_CHAN_MAX) ||
+        (period_ms == 0)) {
+        return -AM_EINVAL;
+    }
+
+    p_src->handle       = handle;
+    p_src->p_ids        = p_ids;
+    p_src->num          = num;
+    p_src->period_ticks = am_ms_to_ticks(period_ms);
+    p_src->next_tick    = am_sys_tick_get();
+
+    key = am_int_cpu_lock();
+    am_list_add_tail(&p_src->node, &p_sampler->src_list);
+    am_int_cpu_unlock(key);
+
+    /* һΣ¼ĵʱ */
+    if (p_sampler->running) {
+        am_isr_defer_job_add(&p_sampler->job);
+    }
+
+    return AM_OK;
+}
+
+/******************************************************************************/
+am_err_t am_sensor_sampler_remove (am_sensor_sampler_t     *p_sampler,
+                                   am_sensor_sampler_src_t *p_src)
+{
+    int key;
+
+    if ((p_sampler == NULL) || (p_src == NULL)) {
+        return -AM_EINVAL;
+    }
+
+    key = am_int_cpu_lock();
+    am_list_del(&p_src->node);
+    am_int_cpu_unlock(key);
+
+    return AM_OK;
+}
+
+/******************************************************************************/
+am_err_t am_sensor_sampler_start (am_sensor_sampler_t *p_sampler)
+{
+    am_sensor_sampler_src_t *p_src;
+    struct am_list_head     *p_node;
+    am_tick_t                now;
+    int                      key;
+
+    if (p_sampler == NULL) {
+        return -AM_EINVAL;
+    }
+
+    now = am_sys_tick_get();
+
+    key = am_int_cpu_lock();
+    am_list_for_each(p_node, &p_sampler->src_list) {
+        p_src = am_list_entry(p_node, am_sensor_sampler_src_t, node);
+        p_src->next_tick = now;
+    }
+    p_sampler->running = AM_TRUE;
+    am_int_cpu_unlock(key);
+
+    am_isr_defer_job_add(&p_sampler->job);
+
+    return AM_OK;
+}
+
+/******************************************************************************/
+am_err_t am_sensor_sampler_stop (am_sensor_sampler_t *p_sampler)
+{
+    if (p_sampler == NULL) {
+        return -AM_EINVAL;
+    }
+
+    p_sampler->running = AM_FALSE;
+    am_softimer_stop(&p_sampler->timer);
+
+    return AM_OK;
+}
+
+/******************************************************************************/
+int am_sensor_sampler_read (am_sensor_sampler_t *p_sampler,
+                            am_sensor_sample_t  *p_samples,
+                            int                  max)
+{
+    uint32_t tail;
+    int      n = 0;
+
+    if ((p_sampler == NULL) || (p_samples == NULL)) {
+        return 0;
+    }
+
+    tail = p_sampler->tail;
+
+    while ((n < max) && (tail != p_sampler->head)) {
+
+        /* ȡдٶȡ */
+        am_barrier();
+        p_samples[n++] = p_sampler->p_buf[tail & p_sampler->mask];
+        tail++;
+    }
+
+    /* ݶȡɺͷſռ */
+    am_barrier();
+    p_sampler->tail = tail;
+
+    return n;
+}
+
+/******************************************************************************/
+am_err_t am_sensor_sampler_stat_get (am_sensor_sampler_t      *p_sampler,
+                                     am_sensor_sampler_stat_t *p_stat)
+{
+    int key;
+
+    if ((p_sampler == NULL) || (p_stat == NULL)) {
+        return -AM_EINVAL;
+    }
+
+    key = am_int_cpu_lock();
+
+    p_stat->nreads   = p_sampler->nreads;
+    p_stat->nsamples = p_sampler->nsamples;
+    p_stat->overrun  = p_sampler->overrun;
+    p_stat->err_cnt  = p_sampler->err_cnt;
+
+    am_int_cpu_unlock(key);
+
+    return AM_OK;
+}
+
+/* end of file */
@@ -22,6 +22,8 @@
 
 #include "am_spi.h"
 #include "am_wait.h"
+#include "am_system.h"
+#include <limits.h>
 
 /**
  * \brief SPIϢɻص
@@ -162,4 +164,124 @@ int am_spi_write_then_write (am_spi_device_t *p_dev,
     return spi_msg.status;
 }
 
+/**
+ * \brief ִһβʹõĴ䣬ȴ
+ */
+static int __spi_calibrate_xfer (am_spi_device_t *p_dev,
+                                 const void      *p_txbuf,
+                                 void            *p_rxbuf,
+                                 uint32_t         nbytes)
+{
+    am_spi_transfer_t trans;
+    am_wait_t         msg_wait;
+    am_spi_message_t  spi_msg;
+    int               ret;
+
+    am_wait_init(&msg_wait);
+
+    am_spi_msg_init(&spi_msg, __message_complete, (void *)&msg_wait);
+    am_spi_mktrans(&trans, p_txbuf, p_rxbuf, nbytes, 0, 0, 0, 0, 0);
+    am_spi_trans_add_tail(&spi_msg, &trans);
+
+    ret = am_spi_msg_start(p_dev, &spi_msg);
+    if (ret != AM_OK) {
+        return ret;
+    }
+
+    am_wait_on(&msg_wait);
+
+    return spi_msg.status;
+}
+
+/**
+ * \brief Եǰѯֵظ䲢ʱ
+ *
+ * *p_count Ϊ 0 ʱٳ ticks ģش *p_count 
+ */
+static int __spi_calibrate_run (am_spi_device_t *p_dev,
+                                const void      *p_txbuf,
+                                void            *p_rxbuf,
+                                uint32_t         nbytes,
+                                am_tick_t        ticks,
+                                uint32_t        *p_count,
+                                am_tick_t       *p_ticks)
+{
+    am_tick_t start;
+    am_tick_t now;
+    uint32_t  count = 0;
+    int       ret;
+
+    /* ӽıؿʼʱһ */
+    start = am_sys_tick_get();
+    while ((now = am_sys_tick_get()) == start);
+    start = now;
+
+    do {
+        ret = __spi_calibrate_xfer(p_dev, p_txbuf, p_rxbuf, nbytes);
+        if (ret != AM_OK) {
+            return ret;
+        }
+        count++;
+        now = am_sys_tick_get();
+    } while ((*p_count != 0) ? (count < *p_count) : (now - start < ticks));
+
+    *p_count = count;
+    *p_ticks = now - start;
+
+    return AM_OK;
+}
+
+/**
+ * \brief ʵϢԴΪѯֵͨ
+ */
+int am_spi_poll_calibrate (am_spi_device_t      *p_dev,
+                           am_spi_poll_ns_set_t  pfn_poll_ns_set,
+                           const void           *p_txbuf,
+                           void                 *p_rxbuf,
+                           uint32_t              nbytes,
+                           uint32_t              ms)
+{
+    am_tick_t ticks_int  = 0;
+    am_tick_t ticks_poll = 0;
+    uint32_t  count      = 0;
+    uint32_t  poll_ns;
+    uint64_t  ns;
+    int       ret;
+
+    if ((p_dev == NULL) || (pfn_poll_ns_set == NULL) ||
+        (nbytes == 0)   || (ms == 0)) {
+        return -AM_EINVAL;
+    }
+
+    /* ֵΪ 0 ʱȫѯͨΪֵʱȫѯ */
+    poll_ns = pfn_poll_ns_set(p_dev->handle, 0);
+
+    ret = __spi_calibrate_run(p_dev, p_txbuf, p_rxbuf, nbytes,
+                              am_ms_to_ticks(ms), &count, &ticks_int);
+    if (ret == AM_OK) {
+        pfn_poll_ns_set(p_dev->handle, 0xFFFFFFFF);
+        ret = __spi_calibrate_run(p_dev, p_txbuf, p_rxbuf, nbytes,
+                                  0, &count, &ticks_poll);
+    }
+
+    if (ret != AM_OK) {
+        pfn_poll_ns_set(p_dev->handle, poll_ns);
+        return ret;
+    }
+
+    /* ַʽϴʱͬʱ֮ */
+    ns = 0;
+    if (ticks_int > ticks_poll) {
+        ns = (uint64_t)(ticks_int - ticks_poll) * 1000000000u /
+             am_sys_clkrate_get() / count;
+    }
+
+    /* Ϊֵ int Χʱȡֵ */
+    poll_ns = (ns > INT_MAX) ? INT_MAX : (uint32_t)ns;
+
+    pfn_poll_ns_set(p_dev->handle, poll_ns);
+
+    return (int)poll_ns;
+}
+
 /* end of file */
@@ -36,17 +36,17 @@ static int __uart_rngbuf_txchar_get (void *p_arg, char *p_outchar)
 {
      am_uart_rngbuf_dev_t *p_dev = (am_uart_rngbuf_dev_t *)p_arg;
   
-     am_rngbuf_t            rb    = &(p_dev->tx_rngbuf);
+     am_rngbuf_spsc_t       rb    = &(p_dev->tx_rngbuf);
     
     /* Success pop one data from ring buffer */
   
-    if (am_rngbuf_getchar(rb, p_outchar) != 1) {
+    if (am_rngbuf_spsc_getchar(rb, p_outchar) != 1) {
         return -AM_EEMPTY;     /* No data to transmit,return -AM_EEMPTY */
     }
 
     /* ֽڷֵһصǿ */
     if ((AM_TRUE == p_dev->rx_trigger_enable) &&
-        (am_rngbuf_nbytes(rb) >= p_dev->tx_trigger_threshold)) {
+        (am_rngbuf_spsc_nbytes(rb) >= p_dev->tx_trigger_threshold)) {
 
         if (NULL != p_dev->pfn_tx_callback) {
             p_dev->pfn_tx_callback(p_dev->p_tx_arg);
@@ -62,10 +62,16 @@ static int __uart_rngbuf_txchar_get (void *p_arg, char *p_outchar)
 static int __uart_rngbuf_rxchar_put (void *p_arg, char inchar)
 {
     am_uart_rngbuf_dev_t *p_dev = (am_uart_rngbuf_dev_t *)p_arg;
-    am_rngbuf_t            rb    = &(p_dev->rx_rngbuf);
+    am_rngbuf_spsc_t       rb    = &(p_dev->rx_rngbuf);
 
-    /* ֽСֵ */
-    if (am_rngbuf_freebytes(rb) < p_dev->xoff_threshold) {
+    /* DMA ʱ DMA д룬лֽյ */
+    if (p_dev->p_dma_rx_funcs != NULL) {
+        return -AM_EPERM;
+    }
+
+    /* ֽСֵأѾʱظ֪ͨ */
+    if ((p_dev->flow_stat == AM_TRUE) &&
+        (am_rngbuf_spsc_freebytes(rb) < p_dev->xoff_threshold)) {
        
         /* Notify the other party continues to stop send */
         am_uart_ioctl(p_dev->handle, 
@@ -77,13 +83,13 @@ static int __uart_rngbuf_rxchar_put (void *p_arg, char inchar)
     
     am_wait_done(&p_dev->rx_wait);
 
-    if (am_rngbuf_putchar(rb, inchar) != 1) {
+    if (am_rngbuf_spsc_putchar(rb, inchar) != 1) {
         return -AM_EFULL;          /* No data to receive,return -AM_EFULL */
     }
 
     /* ֽڽֵһصǿ */
     if ((AM_TRUE == p_dev->rx_trigger_enable) &&
-        (am_rngbuf_nbytes(rb) >= p_dev->rx_trigger_threshold)) {
+        (am_rngbuf_spsc_nbytes(rb) >= p_dev->rx_trigger_threshold)) {
 
         if (NULL != p_dev->pfn_rx_callback) {
             p_dev->pfn_rx_callback(p_dev->p_rx_arg);
@@ -93,6 +99,109 @@ static int __uart_rngbuf_rxchar_put (void *p_arg, char inchar)
     return AM_OK;
 }
 
+/**
+ * \brief  DMA дݣжϣ
+ *
+ * DMA ʱ pos ΪСpos Сѷλ˵ DMA ѻƵ֪ͨ
+ * δʱһĩβʼݣĻ֪ͨ
+ */
+static uint32_t __uart_rngbuf_dma_rx_publish (am_uart_rngbuf_dev_t *p_dev,
+                                              uint32_t              pos)
+{
+    am_rngbuf_spsc_t rb = &(p_dev->rx_rngbuf);
+    uint32_t         n;
+
+    if (pos > rb->mask) {
+
+        /* ֮ǰ */
+        if (p_dev->dma_rx_wrapped) {
+            p_dev->dma_rx_wrapped = AM_FALSE;
+            return 0;
+        }
+        n = pos - p_dev->dma_rx_pos;
+
+    } else if (pos < p_dev->dma_rx_pos) {
+        n                     = rb->mask + 1 - p_dev->dma_rx_pos + pos;
+        p_dev->dma_rx_wrapped = AM_TRUE;
+
+    } else {
+        n = pos - p_dev->dma_rx_pos;
+    }
+
+    p_dev->dma_rx_pos = pos & rb->mask;
+
+    if (n != 0) {
+        am_rngbuf_spsc_publish(rb, n);
+    }
+
+    return n;
+}
+
+/**
+ * \brief DMA ֪ͨ DMA ƻ߿ʱже
+ */
+static void __uart_rngbuf_dma_rx_notify (void *p_arg, uint32_t pos)
+{
+    am_uart_rngbuf_dev_t *p_dev = (am_uart_rngbuf_dev_t *)p_arg;
+    am_rngbuf_spsc_t      rb    = &(p_dev->rx_rngbuf);
+    uint32_t              n;
+    int                   key;
+
+    key = am_int_cpu_lock();
+    n   = __uart_rngbuf_dma_rx_publish(p_dev, pos);
+    am_int_cpu_unlock(key);
+
+    if (n == 0) {
+        return;
+    }
+
+    /* ֽСֵأʱֽܴڻС */
+    if ((p_dev->flow_stat == AM_TRUE) &&
+        (am_rngbuf_spsc_nbytes(rb) > rb->mask + 1 - p_dev->xoff_threshold)) {
+
+        am_uart_ioctl(p_dev->handle,
+                      AM_UART_FLOWSTAT_RX_SET,
+                      (void *)AM_UART_FLOWSTAT_OFF);
+
+        p_dev->flow_stat = AM_FALSE;
+    }
+
+    am_wait_done(&p_dev->rx_wait);
+
+    /* ֽڽֵһصǿ */
+    if ((AM_TRUE == p_dev->rx_trigger_enable) &&
+        (am_rngbuf_spsc_nbytes(rb) >= p_dev->rx_trigger_threshold)) {
+
+        if (NULL != p_dev->pfn_rx_callback) {
+            p_dev->pfn_rx_callback(p_dev->p_rx_arg);
+        }
+    }
+}
+
+/**
+ * \brief жȡǰͬ DMA д뵫δ֪ͨݣ
+ */
+static void __uart_rngbuf_dma_rx_sync (am_uart_rngbuf_dev_t *p_dev)
+{
+    am_rngbuf_spsc_t rb = &(p_dev->rx_rngbuf);
+    uint32_t         nbytes;
+    int              key;
+
+    /* ȡ DMA λ뷢ͬһٽڣ֪ͨظ */
+    key = am_int_cpu_lock();
+    __uart_rngbuf_dma_rx_publish(
+        p_dev,
+        p_dev->p_dma_rx_funcs->pfn_rx_pos_get(p_dev->p_dma_rx_drv));
+    am_int_cpu_unlock(key);
+
+    /* ѱ DMA ǣ */
+    nbytes = am_rngbuf_spsc_nbytes(rb);
+    if (nbytes > rb->mask + 1) {
+        am_rngbuf_spsc_commit(rb, nbytes - (rb->mask + 1));
+        p_dev->dma_rx_overrun += nbytes - (rb->mask + 1);
+    }
+}
+
 /**
  * \brief UART send data.
  */
@@ -102,22 +211,22 @@ int am_uart_rngbuf_send (am_uart_rngbuf_handle_t  rngbuf_handle,
 {
     
     am_uart_rngbuf_dev_t *p_dev  = (am_uart_rngbuf_dev_t *)rngbuf_handle;
-    am_rngbuf_t            rb    = &(p_dev->tx_rngbuf);
+    am_rngbuf_spsc_t       rb    = &(p_dev->tx_rngbuf);
 
     uint32_t rb_ct, write_ct;
 
     uint32_t len = nbytes;
     
     while (len > 0) {
-        if (am_rngbuf_isfull(rb) == AM_TRUE) {
+        if (am_rngbuf_spsc_isfull(rb) == AM_TRUE) {
             continue;
         }
 
-        rb_ct    = am_rngbuf_freebytes(rb);
+        rb_ct    = am_rngbuf_spsc_freebytes(rb);
 
         write_ct = (rb_ct > len) ? len : rb_ct;
 
-        am_rngbuf_put(rb, (const char *)p_txbuf, write_ct);
+        am_rngbuf_spsc_put(rb, (const char *)p_txbuf, write_ct);
         
         p_txbuf += write_ct;
         
@@ -135,22 +244,26 @@ static void __uart_rngbuf_tx_flush (am_uart_rngbuf_dev_t *p_dev)
 {
     int key;
     
+    /* ͻΪжϣʱж */
     key = am_int_cpu_lock();
     
-    am_rngbuf_flush(&p_dev->tx_rngbuf);
+    am_rngbuf_spsc_flush(&p_dev->tx_rngbuf);
     
     am_int_cpu_unlock(key);
 }
 
 static void __uart_rngbuf_rx_flush (am_uart_rngbuf_dev_t *p_dev)
 {
-    int key;
-    
-    key = am_int_cpu_lock();
-    
-    am_rngbuf_flush(&p_dev->rx_rngbuf);
-    
-    am_int_cpu_unlock(key);
+    /*
+     * DMA ʱȷ DMA дݣʹ head  DMA дλñһ£
+     * Щݻ֪֮ͨбݷ
+     */
+    if (p_dev->p_dma_rx_funcs != NULL) {
+        __uart_rngbuf_dma_rx_sync(p_dev);
+    }
+
+    /* ջ߼Ϊж */
+    am_rngbuf_spsc_flush(&p_dev->rx_rngbuf);
 }
 
 /******************************************************************************/
@@ -166,11 +279,14 @@ int am_uart_rngbuf_ioctl (am_uart_rngbuf_handle_t   handle,
     switch (request) {
         
     case AM_UART_RNGBUF_NREAD :
-        *(int *)p_arg = am_rngbuf_nbytes(&p_dev->rx_rngbuf);
+        if (p_dev->p_dma_rx_funcs != NULL) {
+            __uart_rngbuf_dma_rx_sync(p_dev);
+        }
+        *(int *)p_arg = am_rngbuf_spsc_nbytes(&p_dev->rx_rngbuf);
         break;
     
     case AM_UART_RNGBUF_NWRITE :
-        *(int *)p_arg = am_rngbuf_nbytes(&p_dev->tx_rngbuf);
+        *(int *)p_arg = am_rngbuf_spsc_nbytes(&p_dev->tx_rngbuf);
         break;
     
     case AM_UART_RNGBUF_FLUSH :
@@ -196,6 +312,10 @@ int am_uart_rngbuf_ioctl (am_uart_rngbuf_handle_t   handle,
     case AM_UART_RNGBUF_RX_FLOW_ON_THR:
         p_dev->xon_threshold  = (int)p_arg;
         break;
+
+    case AM_UART_RNGBUF_RX_OVERRUN:
+        *(uint32_t *)p_arg = p_dev->dma_rx_overrun;
+        break;
     
     case AM_UART_MODE_SET :                   /* ģʽ̶ΪжģʽΪѯģʽ */
         ret = -AM_EINVAL;
@@ -219,14 +339,18 @@ int am_uart_rngbuf_receive (am_uart_rngbuf_handle_t   handle,
 {
     
     am_uart_rngbuf_dev_t *p_dev =  (am_uart_rngbuf_dev_t *)handle;
-    am_rngbuf_t            rb    = &(p_dev->rx_rngbuf);
+    am_rngbuf_spsc_t       rb    = &(p_dev->rx_rngbuf);
     
     uint32_t rb_ct, read_ct;
     uint32_t len = 0;                                /* ȡֽ      */
 
     while (nbytes > 0) {
-         
-        if (am_rngbuf_isempty(rb) == AM_TRUE) {     /* Ϊգõȴ */
+
+        if (p_dev->p_dma_rx_funcs != NULL) {
+            __uart_rngbuf_dma_rx_sync(p_dev);
+        }
+
+        if (am_rngbuf_spsc_isempty(rb) == AM_TRUE) {     /* Ϊգõȴ */
             
             if (p_dev->timeout_ms == AM_NO_WAIT) {
 
@@ -245,11 +369,11 @@ int am_uart_rngbuf_receive (am_uart_rngbuf_handle_t   handle,
             }
         }
 
-        rb_ct   = am_rngbuf_nbytes(rb);
+        rb_ct   = am_rngbuf_spsc_nbytes(rb);
 
         read_ct = (rb_ct > nbytes) ? nbytes : rb_ct;
 
-        am_rngbuf_get(rb, (char *)p_rxbuf, read_ct);
+        am_rngbuf_spsc_get(rb, (char *)p_rxbuf, read_ct);
         
         p_rxbuf += read_ct;
         nbytes  -= read_ct;
@@ -259,7 +383,7 @@ int am_uart_rngbuf_receive (am_uart_rngbuf_handle_t   handle,
         if (p_dev->flow_stat == AM_FALSE) {
             
             /* ֵֽ */
-            if (am_rngbuf_freebytes(rb) > p_dev->xon_threshold) {
+            if (am_rngbuf_spsc_freebytes(rb) > p_dev->xon_threshold) {
 
                 /* Notify the other party continues to send */ 
                 am_uart_ioctl(p_dev->handle, 
@@ -402,6 +526,101 @@ int am_uart_rngbuf_tx_trigger_disable (am_uart_rngbuf_handle_t  handle)
     return AM_OK;
 }
 
+/******************************************************************************/
+int am_uart_rngbuf_dma_rx_enable (am_uart_rngbuf_handle_t              handle,
+                                  const am_uart_rngbuf_dma_rx_funcs_t *p_funcs,
+                                  void                                *p_drv)
+{
+    am_uart_rngbuf_dev_t *p_dev = (am_uart_rngbuf_dev_t *)handle;
+    am_rngbuf_spsc_t      rb;
+    int                   ret;
+    int                   key;
+
+    if ((handle == NULL) || (p_funcs == NULL) ||
+        (p_funcs->pfn_rx_start == NULL) ||
+        (p_funcs->pfn_rx_pos_get == NULL) ||
+        (p_funcs->pfn_rx_stop == NULL)) {
+        return -AM_EINVAL;
+    }
+
+    if (p_dev->p_dma_rx_funcs != NULL) {
+        am_uart_rngbuf_dma_rx_disable(handle);
+    }
+
+    rb = &(p_dev->rx_rngbuf);
+
+    /*
+     * ʹֽڽջصݣջжڸλл
+     * DMA ǰд뻺DMA ӻʼд룬ջʹдλ
+     * head 
+     */
+    key = am_int_cpu_lock();
+
+    p_dev->p_dma_rx_drv   = p_drv;
+    p_dev->p_dma_rx_funcs = p_funcs;
+
+    rb->head              = 0;
+    rb->tail              = 0;
+    p_dev->dma_rx_pos     = 0;
+    p_dev->dma_rx_wrapped = AM_FALSE;
+    p_dev->dma_rx_overrun = 0;
+
+    am_int_cpu_unlock(key);
+
+    ret = p_funcs->pfn_rx_start(p_drv,
+                                (uint8_t *)rb->buf,
+                                rb->mask + 1,
+                                __uart_rngbuf_dma_rx_notify,
+                                (void *)p_dev);
+    if (ret != AM_OK) {
+        p_dev->p_dma_rx_funcs = NULL;
+        am_uart_ioctl(p_dev->handle, AM_UART_MODE_SET, (void *)AM_UART_MODE_INT);
+    }
+
+    return ret;
+}
+
+/******************************************************************************/
+int am_uart_rngbuf_dma_rx_disable (am_uart_rngbuf_handle_t  handle)
+{
+    am_uart_rngbuf_dev_t *p_dev = (am_uart_rngbuf_dev_t *)handle;
+
+    if (handle == NULL) {
+        return -AM_EINVAL;
+    }
+
+    if (p_dev->p_dma_rx_funcs == NULL) {
+        return AM_OK;
+    }
+
+    p_dev->p_dma_rx_funcs->pfn_rx_stop(p_dev->p_dma_rx_drv);
+
+    /* ֹͣǰд */
+    __uart_rngbuf_dma_rx_sync(p_dev);
+
+    p_dev->p_dma_rx_funcs = NULL;
+    p_dev->p_dma_rx_drv   = NULL;
+
+    /* ָֽжϽ */
+    am_uart_ioctl(p_dev->handle, AM_UART_MODE_SET, (void *)AM_UART_MODE_INT);
+
+    return AM_OK;
+}
+
+/******************************************************************************/
+
+/**
+ * \brief СȡΪ 2^n
+ */
+static uint32_t __uart_rngbuf_size_round (uint32_t size)
+{
+    while ((size & (size - 1)) != 0) {
+        size &= size - 1;                 /* λ 1 */
+    }
+
+    return size;
+}
+
 /******************************************************************************/
 am_uart_rngbuf_handle_t am_uart_rngbuf_init (am_uart_rngbuf_dev_t *p_dev,
                                             am_uart_handle_t       handle,
@@ -419,6 +638,10 @@ am_uart_rngbuf_handle_t am_uart_rngbuf_init (am_uart_rngbuf_dev_t *p_dev,
     if (txbuf_size == 0 || rxbuf_size == 0) {
         return NULL;
     }
+
+    /* λĴСΪ 2^n */
+    rxbuf_size = __uart_rngbuf_size_round(rxbuf_size);
+    txbuf_size = __uart_rngbuf_size_round(txbuf_size);
     
     p_dev->flow_stat = AM_TRUE;          /* ʼݽǴ򿪵 */
 
@@ -437,10 +660,15 @@ am_uart_rngbuf_handle_t am_uart_rngbuf_init (am_uart_rngbuf_dev_t *p_dev,
     p_dev->tx_trigger_threshold     = 0;
     p_dev->pfn_tx_callback          = NULL;
     p_dev->p_tx_arg                 = NULL;
+    p_dev->p_dma_rx_funcs           = NULL;
+    p_dev->p_dma_rx_drv             = NULL;
+    p_dev->dma_rx_pos               = 0;
+    p_dev->dma_rx_wrapped           = AM_FALSE;
+    p_dev->dma_rx_overrun           = 0;
 	
     /* Initialize the ring-buffer */
-    am_rngbuf_init(&(p_dev->rx_rngbuf), (char *)p_rxbuf, rxbuf_size);
-    am_rngbuf_init(&(p_dev->tx_rngbuf), (char *)p_txbuf, txbuf_size);
+    am_rngbuf_spsc_init(&(p_dev->rx_rngbuf), (char *)p_rxbuf, rxbuf_size);
+    am_rngbuf_spsc_init(&(p_dev->tx_rngbuf), (char *)p_txbuf, txbuf_size);
     
     am_uart_ioctl(handle, AM_UART_MODE_SET, (void *)AM_UART_MODE_INT);
     
@@ -87,4 +87,14 @@ int am_isr_defer_job_process (void)
     return am_jobq_process(__g_isr_defer_handle);
 }
 
+/******************************************************************************/
+int am_isr_defer_wait_poll (void *p_arg)
+{
+    if (__g_isr_defer_handle == NULL) {
+        return -AM_EPERM;
+    }
+
+    return am_jobq_process(__g_isr_defer_handle);
+}
+
 /* end of file */
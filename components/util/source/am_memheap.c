@@ -44,6 +44,247 @@
 
 void am_memheap_free(void *ptr);
 
+#if !AM_MEMHEAP_TLSF_EN
+
+/*******************************************************************************
+  һfirst-fit
+*******************************************************************************/
+
+static void __memheap_free_init (struct am_memheap *heap)
+{
+    struct am_memheap_item *item;
+
+    /* initialize the free list header */
+    item            = &(heap->free_header);
+    item->magic     = __MEMHEAP_MAGIC;
+    item->pool_ptr  = heap;
+    item->next      = NULL;
+    item->prev      = NULL;
+    item->next_free = item;
+    item->prev_free = item;
+
+    /* set the free list to free list header */
+    heap->free_list = item;
+}
+
+static void __memheap_free_insert (struct am_memheap      *heap,
+                                   struct am_memheap_item *item)
+{
+    item->next_free = heap->free_list->next_free;
+    item->prev_free = heap->free_list;
+    heap->free_list->next_free->prev_free = item;
+    heap->free_list->next_free            = item;
+}
+
+static void __memheap_free_remove (struct am_memheap      *heap,
+                                   struct am_memheap_item *item)
+{
+    (void)heap;
+
+    item->next_free->prev_free = item->prev_free;
+    item->prev_free->next_free = item->next_free;
+    item->next_free = NULL;
+    item->prev_free = NULL;
+}
+
+static struct am_memheap_item *__memheap_free_find (struct am_memheap *heap,
+                                                    uint32_t           size)
+{
+    struct am_memheap_item *header_ptr;
+
+    /* get the first free memory block */
+    header_ptr = heap->free_list->next_free;
+    while (header_ptr != heap->free_list) {
+
+        /* get current freed memory block size */
+        if (__MEMITEM_SIZE(header_ptr) >= size) {
+            return header_ptr;
+        }
+
+        /* move to next free memory block */
+        header_ptr = header_ptr->next_free;
+    }
+
+    return NULL;
+}
+
+#else /* AM_MEMHEAP_TLSF_EN */
+
+/*******************************************************************************
+  䣨TLSF
+
+  һ 2 ݴλ䣬ڶÿԵȷΪ __TLSF_SL_COUNT ݣ
+  С __TLSF_SMALL ֽڵĿȫһĵ 0 䲢 4 ֽڵȷ֡
+  ÿ (fl, sl) Ӧһλͼ¼ǿյ
+*******************************************************************************/
+
+#define __TLSF_SL_COUNT     (1u << AM_MEMHEAP_TLSF_SL_BITS)
+#define __TLSF_FL_SHIFT     (AM_MEMHEAP_TLSF_SL_BITS + 2)
+#define __TLSF_SMALL        (1u << __TLSF_FL_SHIFT)
+
+/* Чλλã0 ~ 31x Ϊ 0 */
+static int __tlsf_fls (uint32_t x)
+{
+    int n = 0;
+
+    if (x & 0xffff0000) { n += 16; x >>= 16; }
+    if (x & 0x0000ff00) { n +=  8; x >>=  8; }
+    if (x & 0x000000f0) { n +=  4; x >>=  4; }
+    if (x & 0x0000000c) { n +=  2; x >>=  2; }
+    if (x & 0x00000002) { n +=  1;           }
+
+    return n;
+}
+
+/* Чλλã0 ~ 31x Ϊ 0 */
+static int __tlsf_ffs (uint32_t x)
+{
+    return __tlsf_fls(x & (~x + 1));
+}
+
+/*  size ڵ */
+static void __tlsf_mapping (uint32_t size, int *p_fl, int *p_sl)
+{
+    int fl, sl;
+
+    if (size < __TLSF_SMALL) {
+        fl = 0;
+        sl = size / (__TLSF_SMALL / __TLSF_SL_COUNT);
+    } else {
+        fl = __tlsf_fls(size);
+        sl = (size >> (fl - AM_MEMHEAP_TLSF_SL_BITS)) ^ __TLSF_SL_COUNT;
+        fl = fl - __TLSF_FL_SHIFT + 1;
+
+        /* ΧĿͳһһ */
+        if (fl >= AM_MEMHEAP_TLSF_FL_COUNT) {
+            fl = AM_MEMHEAP_TLSF_FL_COUNT - 1;
+            sl = __TLSF_SL_COUNT - 1;
+        }
+    }
+
+    *p_fl = fl;
+    *p_sl = sl;
+}
+
+static void __memheap_free_init (struct am_memheap *heap)
+{
+    /* the free list header is not used by TLSF */
+    heap->free_list = NULL;
+    heap->fl_bitmap = 0;
+
+    memset(heap->sl_bitmap, 0, sizeof(heap->sl_bitmap));
+    memset(heap->tlsf_free, 0, sizeof(heap->tlsf_free));
+}
+
+static void __memheap_free_insert (struct am_memheap      *heap,
+                                   struct am_memheap_item *item)
+{
+    int fl, sl;
+
+    __tlsf_mapping(__MEMITEM_SIZE(item), &fl, &sl);
+
+    item->prev_free = NULL;
+    item->next_free = heap->tlsf_free[fl][sl];
+    if (item->next_free != NULL) {
+        item->next_free->prev_free = item;
+    }
+    heap->tlsf_free[fl][sl] = item;
+
+    heap->fl_bitmap     |= (1u << fl);
+    heap->sl_bitmap[fl] |= (1u << sl);
+}
+
+static void __memheap_free_remove (struct am_memheap      *heap,
+                                   struct am_memheap_item *item)
+{
+    int fl, sl;
+
+    __tlsf_mapping(__MEMITEM_SIZE(item), &fl, &sl);
+
+    if (item->next_free != NULL) {
+        item->next_free->prev_free = item->prev_free;
+    }
+
+    if (item->prev_free != NULL) {
+        item->prev_free->next_free = item->next_free;
+    } else {
+        heap->tlsf_free[fl][sl] = item->next_free;
+
+        if (heap->tlsf_free[fl][sl] == NULL) {
+            heap->sl_bitmap[fl] &= ~(1u << sl);
+            if (heap->sl_bitmap[fl] == 0) {
+                heap->fl_bitmap &= ~(1u << fl);
+            }
+        }
+    }
+
+    item->next_free = NULL;
+    item->prev_free = NULL;
+}
+
+static struct am_memheap_item *__memheap_free_find (struct am_memheap *heap,
+                                                    uint32_t           size)
+{
+    struct am_memheap_item *item;
+    uint32_t                bitmap;
+    uint32_t                round;
+    int                     fl, sl;
+
+    __tlsf_mapping(size, &fl, &sl);
+
+    /* ׸п㹻ֱʹãٶԸķָ */
+    item = heap->tlsf_free[fl][sl];
+    if ((item != NULL) && (__MEMITEM_SIZE(item) >= size)) {
+        return item;
+    }
+
+    /*
+     * һʼңȽ size ȡ±߽磬
+     * ȡпҪ
+     */
+    if (size >= __TLSF_SMALL) {
+        round = (1u << (__tlsf_fls(size) - AM_MEMHEAP_TLSF_SL_BITS)) - 1;
+        if (size + round < size) {
+            return NULL;
+        }
+        __tlsf_mapping(size + round, &fl, &sl);
+    } else {
+        sl++;
+    }
+
+    if (sl >= (int)__TLSF_SL_COUNT) {
+        bitmap = 0;
+    } else {
+        bitmap = heap->sl_bitmap[fl] & (~0u << sl);
+    }
+
+    if (bitmap == 0) {
+        if (fl + 1 >= AM_MEMHEAP_TLSF_FL_COUNT) {
+            return NULL;
+        }
+
+        bitmap = heap->fl_bitmap & (~0u << (fl + 1));
+        if (bitmap == 0) {
+            return NULL;
+        }
+
+        fl     = __tlsf_ffs(bitmap);
+        bitmap = heap->sl_bitmap[fl];
+    }
+
+    sl   = __tlsf_ffs(bitmap);
+    item = heap->tlsf_free[fl][sl];
+
+    /* һеĿСԼжһ */
+    if (__MEMITEM_SIZE(item) < size) {
+        return NULL;
+    }
+
+    return item;
+}
+
+#endif /* AM_MEMHEAP_TLSF_EN */
+
 /*
  * The initialized memory pool will be:
  * +-----------------------------------+--------------------------+
@@ -71,17 +312,8 @@ am_err_t am_memheap_init(struct am_memheap *memheap,
     memheap->available_size = memheap->pool_size - (2 * __MEMHEAP_SIZE);
     memheap->max_used_size  = memheap->pool_size - memheap->available_size;
 
-    /* initialize the free list header */
-    item            = &(memheap->free_header);
-    item->magic     = __MEMHEAP_MAGIC;
-    item->pool_ptr  = memheap;
-    item->next      = NULL;
-    item->prev      = NULL;
-    item->next_free = item;
-    item->prev_free = item;
-
-    /* set the free list to free list header */
-    memheap->free_list = item;
+    /* initialize the free list */
+    __memheap_free_init(memheap);
 
     /* initialize the first big memory block */
     item            = (struct am_memheap_item *)start_addr;
@@ -100,10 +332,7 @@ am_err_t am_memheap_init(struct am_memheap *memheap,
     memheap->block_list = item;
 
     /* place the big memory block to free list */
-    item->next_free = memheap->free_list->next_free;
-    item->prev_free = memheap->free_list;
-    memheap->free_list->next_free->prev_free = item;
-    memheap->free_list->next_free            = item;
+    __memheap_free_insert(memheap, item);
 
     /* move to the end of memory pool to build a small tailer block,
      * which prevents block merging
@@ -142,22 +371,13 @@ void *am_memheap_alloc(struct am_memheap *heap, uint32_t size)
     if (size < heap->available_size) {
 
         /* search on free list */
-        free_size = 0;
+        header_ptr = __memheap_free_find(heap, size);
 
-        /* get the first free memory block */
-        header_ptr = heap->free_list->next_free;
-        while (header_ptr != heap->free_list && free_size < size) {
+        /* determine if the memory is available. */
+        if (header_ptr != NULL) {
 
-            /* get current freed memory block size */
             free_size = __MEMITEM_SIZE(header_ptr);
-            if (free_size < size) {
-                /* move to next free memory block */
-                header_ptr = header_ptr->next_free;
-            }
-        }
 
-        /* determine if the memory is available. */
-        if (free_size >= size) {
             /* a block that satisfies the request has been found. */
 
             /* determine if the block needs to be split. */
@@ -175,6 +395,9 @@ void *am_memheap_alloc(struct am_memheap *heap, uint32_t size)
                           header_ptr->prev,
                           new_ptr));
 
+                /* remove header ptr from free list */
+                __memheap_free_remove(heap, header_ptr);
+
                 /* mark the new block as a memory block and freed. */
                 new_ptr->magic = __MEMHEAP_MAGIC;
 
@@ -187,17 +410,8 @@ void *am_memheap_alloc(struct am_memheap *heap, uint32_t size)
                 header_ptr->next->prev = new_ptr;
                 header_ptr->next       = new_ptr;
 
-                /* remove header ptr from free list */
-                header_ptr->next_free->prev_free = header_ptr->prev_free;
-                header_ptr->prev_free->next_free = header_ptr->next_free;
-                header_ptr->next_free = NULL;
-                header_ptr->prev_free = NULL;
-
                 /* insert new_ptr to free list */
-                new_ptr->next_free = heap->free_list->next_free;
-                new_ptr->prev_free = heap->free_list;
-                heap->free_list->next_free->prev_free = new_ptr;
-                heap->free_list->next_free            = new_ptr;
+                __memheap_free_insert(heap, new_ptr);
                 AM_DBGF(("new ptr: next_free 0x%08x, prev_free 0x%08x\n",
                          new_ptr->next_free,
                          new_ptr->prev_free));
@@ -223,10 +437,7 @@ void *am_memheap_alloc(struct am_memheap *heap, uint32_t size)
                          header_ptr->next_free,
                          header_ptr->prev_free));
 
-                header_ptr->next_free->prev_free = header_ptr->prev_free;
-                header_ptr->prev_free->next_free = header_ptr->next_free;
-                header_ptr->next_free = NULL;
-                header_ptr->prev_free = NULL;
+                __memheap_free_remove(heap, header_ptr);
             }
 
             /* Mark the allocated block as not available. */
@@ -326,8 +537,7 @@ void *am_memheap_realloc(struct am_memheap *heap, void *ptr, size_t newsize)
                          next_ptr->next_free,
                          next_ptr->prev_free));
 
-                next_ptr->next_free->prev_free = next_ptr->prev_free;
-                next_ptr->prev_free->next_free = next_ptr->next_free;
+                __memheap_free_remove(heap, next_ptr);
                 next_ptr->next->prev = next_ptr->prev;
                 next_ptr->prev->next = next_ptr->next;
 
@@ -351,10 +561,7 @@ void *am_memheap_realloc(struct am_memheap *heap, void *ptr, size_t newsize)
                 header_ptr->next       = next_ptr;
 
                 /* insert next_ptr to free list */
-                next_ptr->next_free = heap->free_list->next_free;
-                next_ptr->prev_free = heap->free_list;
-                heap->free_list->next_free->prev_free = next_ptr;
-                heap->free_list->next_free            = next_ptr;
+                __memheap_free_insert(heap, next_ptr);
                 AM_DBGF(("new ptr: next_free 0x%08x, prev_free 0x%08x",
                          next_ptr->next_free,
                          next_ptr->prev_free));
@@ -414,15 +621,11 @@ void *am_memheap_realloc(struct am_memheap *heap, void *ptr, size_t newsize)
         new_ptr->next   = free_ptr->next;
 
         /* remove free ptr from free list */
-        free_ptr->next_free->prev_free = free_ptr->prev_free;
-        free_ptr->prev_free->next_free = free_ptr->next_free;
+        __memheap_free_remove(heap, free_ptr);
     }
 
     /* insert the split block to free list */
-    new_ptr->next_free = heap->free_list->next_free;
-    new_ptr->prev_free = heap->free_list;
-    heap->free_list->next_free->prev_free = new_ptr;
-    heap->free_list->next_free            = new_ptr;
+    __memheap_free_insert(heap, new_ptr);
     AM_DBGF(("new free ptr: next_free 0x%08x, prev_free 0x%08x\n",
              new_ptr->next_free,
              new_ptr->prev_free));
@@ -439,13 +642,10 @@ void am_memheap_free(void *ptr)
 {
     struct am_memheap *heap;
     struct am_memheap_item *header_ptr, *new_ptr;
-    uint32_t insert_header;
 
 	/* NULL check */
 	if (ptr == NULL) return;
 
-    /* set initial status as OK */
-    insert_header = 1;
     new_ptr       = NULL;
     header_ptr    = (struct am_memheap_item *)
                     ((uint8_t *)ptr - __MEMHEAP_SIZE);
@@ -471,14 +671,15 @@ void am_memheap_free(void *ptr)
         /* adjust the available number of bytes. */
         heap->available_size = heap->available_size + __MEMHEAP_SIZE;
 
+        /* remove the previous neighbor from free list, it will grow */
+        __memheap_free_remove(heap, header_ptr->prev);
+
         /* yes, merge block with previous neighbor. */
         (header_ptr->prev)->next = header_ptr->next;
         (header_ptr->next)->prev = header_ptr->prev;
 
         /* move header pointer to previous. */
         header_ptr = header_ptr->prev;
-        /* don't insert header to free list */
-        insert_header = 0;
     }
 
     /* determine if the block can be merged with the next neighbor. */
@@ -496,20 +697,14 @@ void am_memheap_free(void *ptr)
         header_ptr->next    = new_ptr->next;
 
         /* remove new ptr from free list */
-        new_ptr->next_free->prev_free = new_ptr->prev_free;
-        new_ptr->prev_free->next_free = new_ptr->next_free;
+        __memheap_free_remove(heap, new_ptr);
     }
 
-    if (insert_header) {
-        /* no left merge, insert to free list */
-        header_ptr->next_free = heap->free_list->next_free;
-        header_ptr->prev_free = heap->free_list;
-        heap->free_list->next_free->prev_free = header_ptr;
-        heap->free_list->next_free            = header_ptr;
+    /* insert the merged block to free list */
+    __memheap_free_insert(heap, header_ptr);
 
-        AM_DBGF(("insert to free list: next_free 0x%08x, prev_free 0x%08x\n",
-                 header_ptr->next_free, header_ptr->prev_free));
-    }
+    AM_DBGF(("insert to free list: next_free 0x%08x, prev_free 0x%08x\n",
+             header_ptr->next_free, header_ptr->prev_free));
 }
 
 /* end of file */
@@ -0,0 +1,203 @@
+/*******************************************************************************
+*                                 AMetal
+*                       ----------------------------
+*                       innovating embedded platform
+*
+* Copyright (c) 2001-2018 Guangzhou ZHIYUAN Electronics Co., Ltd.
+* All rights reserved.
+*
+* Contact information:
+* web site:    http://www.zlg.cn/
+*******************************************************************************/
+
+/**
+ * \file
+ * \brief ̶Сڴʵ
+ *
+ * \internal
+ * \par modification history:
+ * - 1.00 26-10-18  agent, first implementation
+ * \endinternal
+ */
+
+#include "am_common.h"
+#include "am_mempool.h"
+#include "am_mem.h"
+#include "am_int.h"
+
+/******************************************************************************/
+static void __mempool_build (am_mempool_t *p_pool)
+{
+    uint8_t *p_blk = p_pool->p_start;
+    size_t   i;
+
+    /* ڴ鴮ɿָڿʼλ */
+    p_pool->p_free = NULL;
+    for (i = p_pool->nblks; i > 0; i--) {
+        p_blk = p_pool->p_start + (i - 1) * p_pool->blk_size;
+        *(void **)p_blk = p_pool->p_free;
+        p_pool->p_free  = p_blk;
+    }
+
+    p_pool->nfree    = p_pool->nblks;
+    p_pool->min_free = p_pool->nblks;
+    p_pool->fail_cnt = 0;
+}
+
+/******************************************************************************/
+am_err_t am_mempool_init (am_mempool_t *p_pool,
+                          void         *p_buf,
+                          size_t        buf_size,
+                          size_t        blk_size)
+{
+    if ((p_pool == NULL) || (p_buf == NULL) || (blk_size == 0)) {
+        return -AM_EINVAL;
+    }
+
+    /* 洢ռ밴ָС */
+    if (((uint32_t)p_buf & (sizeof(void *) - 1)) != 0) {
+        return -AM_EINVAL;
+    }
+
+    p_pool->p_start   = (uint8_t *)p_buf;
+    p_pool->blk_size  = AM_MEMPOOL_BLK_SIZE(blk_size);
+    p_pool->nblks     = buf_size / p_pool->blk_size;
+    p_pool->from_heap = AM_FALSE;
+
+    if (p_pool->nblks == 0) {
+        return -AM_EINVAL;
+    }
+
+    __mempool_build(p_pool);
+
+    return AM_OK;
+}
+
+/******************************************************************************/
+am_err_t am_mempool_create (am_mempool_t *p_pool,
+                            size_t        blk_size,
+                            size_t        nblks)
+{
+    void     *p_buf;
+    am_err_t  ret;
+
+    if ((p_pool == NULL) || (blk_size == 0) || (nblks == 0)) {
+        return -AM_EINVAL;
+    }
+
+    p_buf = am_mem_alloc(AM_MEMPOOL_BLK_SIZE(blk_size) * nblks);
+    if (p_buf == NULL) {
+        return -AM_ENOMEM;
+    }
+
+    ret = am_mempool_init(p_pool,
+                          p_buf,
+                          AM_MEMPOOL_BLK_SIZE(blk_size) * nblks,
+                          blk_size);
+    if (ret != AM_OK) {
+        am_mem_free(p_buf);
+        return ret;
+    }
+
+    p_pool->from_heap = AM_TRUE;
+
+    return AM_OK;
+}
+
+/******************************************************************************/
+void am_mempool_destroy (am_mempool_t *p_pool)
+{
+    if (p_pool == NULL) {
+        return;
+    }
+
+    if (p_pool->from_heap) {
+        am_mem_free(p_pool->p_start);
+    }
+
+    p_pool->p_free  = NULL;
+    p_pool->p_start = NULL;
+    p_pool->nblks   = 0;
+    p_pool->nfree   = 0;
+}
+
+/******************************************************************************/
+void *am_mempool_get (am_mempool_t *p_pool)
+{
+    void *p_blk;
+    int   key;
+
+    if (p_pool == NULL) {
+        return NULL;
+    }
+
+    key = am_int_cpu_lock();
+
+    p_blk = p_pool->p_free;
+    if (p_blk != NULL) {
+        p_pool->p_free = *(void **)p_blk;
+        p_pool->nfree--;
+        if (p_pool->nfree < p_pool->min_free) {
+            p_pool->min_free = p_pool->nfree;
+        }
+    } else {
+        p_pool->fail_cnt++;
+    }
+
+    am_int_cpu_unlock(key);
+
+    return p_blk;
+}
+
+/******************************************************************************/
+am_err_t am_mempool_put (am_mempool_t *p_pool, void *p_blk)
+{
+    size_t offset;
+    int    key;
+
+    if ((p_pool == NULL) || (p_blk == NULL) ||
+        ((uint8_t *)p_blk < p_pool->p_start)) {
+        return -AM_EINVAL;
+    }
+
+    /* ڴλڴ洢ռڣΪʼַ */
+    offset = (uint8_t *)p_blk - p_pool->p_start;
+    if ((offset >= p_pool->blk_size * p_pool->nblks) ||
+        ((offset % p_pool->blk_size) != 0)) {
+        return -AM_EINVAL;
+    }
+
+    key = am_int_cpu_lock();
+
+    *(void **)p_blk = p_pool->p_free;
+    p_pool->p_free  = p_blk;
+    p_pool->nfree++;
+
+    am_int_cpu_unlock(key);
+
+    return AM_OK;
+}
+
+/******************************************************************************/
+am_err_t am_mempool_stat_get (am_mempool_t *p_pool, am_mempool_stat_t *p_stat)
+{
+    int key;
+
+    if ((p_pool == NULL) || (p_stat == NULL)) {
+        return -AM_EINVAL;
+    }
+
+    key = am_int_cpu_lock();
+
+    p_stat->blk_size = p_pool->blk_size;
+    p_stat->nblks    = p_pool->nblks;
+    p_stat->nfree    = p_pool->nfree;
+    p_stat->max_used = p_pool->nblks - p_pool->min_free;
+    p_stat->fail_cnt = p_pool->fail_cnt;
+
+    am_int_cpu_unlock(key);
+
+    return AM_OK;
+}
+
+/* end of file */
@@ -239,4 +239,194 @@ void am_rngbuf_move_ahead (am_rngbuf_t rb, size_t n)
     rb->in = n;
 }
 
+/*******************************************************************************
+  /ߣSPSCλ
+*******************************************************************************/
+
+/******************************************************************************/
+int am_rngbuf_spsc_init (struct am_rngbuf_spsc *p_rb, char *p_buf, size_t size)
+{
+    /* СΪ 2^n */
+    if (size == 0 || (size & (size - 1)) != 0 || p_buf == NULL) {
+        return -AM_EINVAL;
+    }
+
+    p_rb->head = 0;
+    p_rb->tail = 0;
+    p_rb->mask = size - 1;
+    p_rb->buf  = p_buf;
+
+    return AM_OK;
+}
+
+/******************************************************************************/
+int am_rngbuf_spsc_putchar (am_rngbuf_spsc_t rb, const char data)
+{
+    uint32_t head = rb->head;
+
+    if (head - rb->tail > rb->mask) {
+        return 0;
+    }
+
+    /* ȶȡ tailд */
+    am_barrier();
+
+    rb->buf[head & rb->mask] = data;
+
+    /* дɺٸ head */
+    am_barrier();
+
+    rb->head = head + 1;
+
+    return 1;
+}
+
+/******************************************************************************/
+int am_rngbuf_spsc_getchar (am_rngbuf_spsc_t rb, char *p_data)
+{
+    uint32_t tail = rb->tail;
+
+    if (tail == rb->head) {
+        return 0;
+    }
+
+    /* ȶȡ headȡ */
+    am_barrier();
+
+    *p_data = rb->buf[tail & rb->mask];
+
+    /* ݶȡɺͷſռ */
+    am_barrier();
+
+    rb->tail = tail + 1;
+
+    return 1;
+}
+
+/******************************************************************************/
+size_t am_rngbuf_spsc_reserve (am_rngbuf_spsc_t rb, char **pp_space)
+{
+    uint32_t head  = rb->head;
+    uint32_t space = rb->mask + 1 - (head - rb->tail);
+    uint32_t index = head & rb->mask;
+
+    am_barrier();
+
+    *pp_space = &rb->buf[index];
+
+    /* ܿԽĩβ */
+    return min(space, rb->mask + 1 - index);
+}
+
+/******************************************************************************/
+void am_rngbuf_spsc_publish (am_rngbuf_spsc_t rb, size_t nbytes)
+{
+    am_barrier();
+
+    rb->head += nbytes;
+}
+
+/******************************************************************************/
+size_t am_rngbuf_spsc_peek (am_rngbuf_spsc_t rb, char **pp_data)
+{
+    uint32_t tail  = rb->tail;
+    uint32_t used  = rb->head - tail;
+    uint32_t index = tail & rb->mask;
+
+    am_barrier();
+
+    *pp_data = &rb->buf[index];
+
+    /* ܿԽĩβ */
+    return min(used, rb->mask + 1 - index);
+}
+
+/******************************************************************************/
+void am_rngbuf_spsc_commit (am_rngbuf_spsc_t rb, size_t nbytes)
+{
+    am_barrier();
+
+    rb->tail += nbytes;
+}
+
+/******************************************************************************/
+size_t am_rngbuf_spsc_put (am_rngbuf_spsc_t rb, const char *p_buf, size_t nbytes)
+{
+    char   *p_space;
+    size_t  len;
+    size_t  bytes_put = 0;
+
+    /* Σĩβʼд */
+    while (bytes_put < nbytes) {
+
+        len = am_rngbuf_spsc_reserve(rb, &p_space);
+        if (len == 0) {
+            break;
+        }
+
+        len = min(len, nbytes - bytes_put);
+        memcpy(p_space, p_buf + bytes_put, len);
+        am_rngbuf_spsc_publish(rb, len);
+
+        bytes_put += len;
+    }
+
+    return bytes_put;
+}
+
+/******************************************************************************/
+size_t am_rngbuf_spsc_get (am_rngbuf_spsc_t rb, char *p_buf, size_t nbytes)
+{
+    char   *p_data;
+    size_t  len;
+    size_t  bytes_got = 0;
+
+    /* Σĩβʼȡ */
+    while (bytes_got < nbytes) {
+
+        len = am_rngbuf_spsc_peek(rb, &p_data);
+        if (len == 0) {
+            break;
+        }
+
+        len = min(len, nbytes - bytes_got);
+        memcpy(p_buf + bytes_got, p_data, len);
+        am_rngbuf_spsc_commit(rb, len);
+
+        bytes_got += len;
+    }
+
+    return bytes_got;
+}
+
+/******************************************************************************/
+void am_rngbuf_spsc_flush (am_rngbuf_spsc_t rb)
+{
+    rb->tail = rb->head;
+}
+
+/******************************************************************************/
+am_bool_t am_rngbuf_spsc_isempty (am_rngbuf_spsc_t rb)
+{
+    return (am_bool_t)(rb->head == rb->tail);
+}
+
+/******************************************************************************/
+am_bool_t am_rngbuf_spsc_isfull (am_rngbuf_spsc_t rb)
+{
+    return (am_bool_t)(rb->head - rb->tail > rb->mask);
+}
+
+/******************************************************************************/
+size_t am_rngbuf_spsc_freebytes (am_rngbuf_spsc_t rb)
+{
+    return rb->mask + 1 - (rb->head - rb->tail);
+}
+
+/******************************************************************************/
+size_t am_rngbuf_spsc_nbytes (am_rngbuf_spsc_t rb)
+{
+    return rb->head - rb->tail;
+}
+
 /* end of file */
@@ -27,9 +27,6 @@
 /** \brief ʱӲʱƵʣʱƵʲΪ0 */
 static unsigned int __g_hwtimer_freq = 0;
 
-/** \brief ʱͷ */
-static struct am_list_head g_softimer_head;
-
 /******************************************************************************/
 static unsigned int __ms_to_ticks (unsigned int ms)
 {
@@ -39,6 +36,11 @@ static unsigned int __ms_to_ticks (unsigned int ms)
     return 0;
 }
 
+#if !AM_SOFTIMER_WHEEL_EN
+
+/** \brief ʱͷ */
+static struct am_list_head g_softimer_head;
+
 /******************************************************************************/
 static void __softimer_add (am_softimer_t *p_timer, unsigned int ticks)
 {
@@ -80,6 +82,26 @@ static void __softimer_remove (am_softimer_t *p_timer)
     am_list_del_init(&p_timer->node);
 }
 
+/******************************************************************************/
+static unsigned int __softimer_next_ticks (void)
+{
+    if (am_list_empty(&g_softimer_head)) {
+        return AM_SOFTIMER_TICKS_NONE;
+    }
+
+    /* ׽ڵ tick ֵΪһεڵ tick  */
+    return am_list_entry(g_softimer_head.next, am_softimer_t, node)->ticks;
+}
+
+/******************************************************************************/
+static void __softimer_skip (unsigned int ticks)
+{
+    /* ֤߱ ticks С׽ڵ tick ֵڼ޶ʱ */
+    if (!am_list_empty(&g_softimer_head)) {
+        am_list_entry(g_softimer_head.next, am_softimer_t, node)->ticks -= ticks;
+    }
+}
+
 /* ԳʼָƵʵøú  */
 void am_softimer_module_tick (void)
 {
@@ -153,6 +175,268 @@ int am_softimer_module_init (unsigned int clkrate)
     __g_hwtimer_freq = clkrate;
     return 0;
 }
+
+#else /* AM_SOFTIMER_WHEEL_EN */
+
+/*******************************************************************************
+  ֲʱʵ
+
+  0ÿ۶Ӧ 1  tick n (n >= 1)ÿ۶Ӧ n-1 תһȦʱ䡣
+  ʱڵľ tick ֵӦĲУֹͣΪ O(1) 
+  0ÿתһȦһ㵱ǰеĶʱ¶λ²㣨Ǩƣ
+*******************************************************************************/
+
+#define __WHEEL_L0_SIZE     (1u << AM_SOFTIMER_WHEEL_L0_BITS)
+#define __WHEEL_L0_MASK     (__WHEEL_L0_SIZE - 1)
+#define __WHEEL_LN_SIZE     (1u << AM_SOFTIMER_WHEEL_LN_BITS)
+#define __WHEEL_LN_MASK     (__WHEEL_LN_SIZE - 1)
+
+/** \brief  n (n >= 1)Ӧλ */
+#define __WHEEL_SHIFT(n)    (AM_SOFTIMER_WHEEL_L0_BITS + \
+                             ((n) - 1) * AM_SOFTIMER_WHEEL_LN_BITS)
+
+/** \brief ʱֱֿӶλ tick  */
+#define __WHEEL_MAX_TICKS   (1u << __WHEEL_SHIFT(AM_SOFTIMER_WHEEL_LEVELS))
+
+/** \brief 0Ĳ */
+static struct am_list_head __g_wheel_l0[__WHEEL_L0_SIZE];
+
+/** \brief 1㼰ϸĲ */
+static struct am_list_head __g_wheel_ln[AM_SOFTIMER_WHEEL_LEVELS - 1]
+                                       [__WHEEL_LN_SIZE];
+
+/** \brief һ tick ֵ */
+static unsigned int __g_wheel_jiffies = 0;
+
+/******************************************************************************/
+static void __softimer_wheel_place (am_softimer_t *p_timer)
+{
+    unsigned int         expires = p_timer->ticks;
+    unsigned int         idx     = expires - __g_wheel_jiffies;
+    struct am_list_head *p_slot;
+    int                  level;
+
+    if ((int)idx < 0) {
+
+        /* ѵڣһĲ */
+        p_slot = &__g_wheel_l0[__g_wheel_jiffies & __WHEEL_L0_MASK];
+
+    } else if (idx < __WHEEL_L0_SIZE) {
+        p_slot = &__g_wheel_l0[expires & __WHEEL_L0_MASK];
+
+    } else {
+
+        /* ʱַΧĶʱȷ߲㣬Ǩʱʵʵֵ¶λ */
+        if (idx >= __WHEEL_MAX_TICKS) {
+            idx     = __WHEEL_MAX_TICKS - 1;
+            expires = __g_wheel_jiffies + idx;
+        }
+
+        for (level = 1; idx >= (1u << __WHEEL_SHIFT(level + 1)); level++);
+
+        p_slot = &__g_wheel_ln[level - 1]
+                              [(expires >> __WHEEL_SHIFT(level)) &
+                               __WHEEL_LN_MASK];
+    }
+
+    am_list_add_tail(&p_timer->node, p_slot);
+}
+
+/******************************************************************************/
+static void __softimer_add (am_softimer_t *p_timer, unsigned int ticks)
+{
+    /*  ticks ε am_softimer_module_tick() ʱ */
+    p_timer->ticks = __g_wheel_jiffies + ticks - 1;
+
+    __softimer_wheel_place(p_timer);
+}
+
+/******************************************************************************/
+static void __softimer_remove (am_softimer_t *p_timer)
+{
+    if (am_list_empty(&p_timer->node) ) {         /* ڵδ         */
+        return ;
+    }
+
+    am_list_del_init(&p_timer->node);
+}
+
+/******************************************************************************/
+static unsigned int __softimer_next_ticks (void)
+{
+    unsigned int index = __g_wheel_jiffies & __WHEEL_L0_MASK;
+    unsigned int next  = AM_SOFTIMER_TICKS_NONE;
+    unsigned int i, j;
+
+    /* ߲ڶʱʱһε0תһȦǨƣʱ봦 */
+    for (i = 0; i < AM_SOFTIMER_WHEEL_LEVELS - 1; i++) {
+        for (j = 0; j < __WHEEL_LN_SIZE; j++) {
+            if (!am_list_empty(&__g_wheel_ln[i][j])) {
+                next = ((__WHEEL_L0_SIZE - index) & __WHEEL_L0_MASK) + 1;
+                break;
+            }
+        }
+        if (next != AM_SOFTIMER_TICKS_NONE) {
+            break;
+        }
+    }
+
+    /* 0ķǿղ */
+    for (i = 0; (i < __WHEEL_L0_SIZE) && (i + 1 < next); i++) {
+        if (!am_list_empty(&__g_wheel_l0[(index + i) & __WHEEL_L0_MASK])) {
+            next = i + 1;
+            break;
+        }
+    }
+
+    return next;
+}
+
+/******************************************************************************/
+static void __softimer_skip (unsigned int ticks)
+{
+    /* ֤߱ ticks С __softimer_next_ticks()ڼ޵ڼǨ */
+    __g_wheel_jiffies += ticks;
+}
+
+/* ԳʼָƵʵøú  */
+void am_softimer_module_tick (void)
+{
+    struct am_list_head *p_slot;
+    am_softimer_t       *p_timer;
+    struct am_list_head  expired;
+    unsigned int         index;
+    unsigned int         slot;
+    int                  level;
+
+    int old;
+
+    AM_INIT_LIST_HEAD(&expired);
+
+    old   = am_int_cpu_lock();
+    index = __g_wheel_jiffies & __WHEEL_L0_MASK;
+
+    /* 0תһȦϲ㵱ǰеĶʱǨ² */
+    if (index == 0) {
+        for (level = 1; level < AM_SOFTIMER_WHEEL_LEVELS; level++) {
+
+            slot   = (__g_wheel_jiffies >> __WHEEL_SHIFT(level)) &
+                     __WHEEL_LN_MASK;
+            p_slot = &__g_wheel_ln[level - 1][slot];
+
+            while (!am_list_empty(p_slot)) {
+                p_timer = am_list_entry(p_slot->next, am_softimer_t, node);
+                am_list_del(&p_timer->node);
+                __softimer_wheel_place(p_timer);
+
+                /* ÿǨһʱһжϣ֤жʱн */
+                am_int_cpu_unlock(old);
+                old = am_int_cpu_lock();
+            }
+
+            /* δתһȦǨƸ߲ */
+            if (slot != 0) {
+                break;
+            }
+        }
+    }
+
+    __g_wheel_jiffies++;
+
+    /*
+     * 0㵱ǰеĶʱȫڣʱٴΪ0
+     * Ķʱ¼뵱ǰ
+     */
+    am_list_splice_init(&__g_wheel_l0[index], &expired);
+
+    while (!am_list_empty(&expired)) {
+
+        p_timer = am_list_entry(expired.next, am_softimer_t, node);
+
+        /* ýڵ㱾ζʱʱ䵽ɾýڵ */
+        am_list_del_init(&p_timer->node);
+
+        /* Զʱ¼ʱ */
+        __softimer_add(p_timer, p_timer->repeat_ticks);
+
+        /* صʱ Ϊж */
+        am_int_cpu_unlock(old);
+
+        if (p_timer->timeout_callback ) {
+            p_timer->timeout_callback(p_timer->p_arg);
+        }
+
+        old = am_int_cpu_lock();
+    }
+
+    am_int_cpu_unlock(old);
+}
+
+int am_softimer_module_init (unsigned int clkrate)
+{
+    int i, j;
+
+    if ((clkrate == 0)) {
+
+        return -AM_EINVAL;
+    }
+
+    for (i = 0; i < (int)__WHEEL_L0_SIZE; i++) {
+        AM_INIT_LIST_HEAD(&__g_wheel_l0[i]);
+    }
+
+    for (i = 0; i < AM_SOFTIMER_WHEEL_LEVELS - 1; i++) {
+        for (j = 0; j < (int)__WHEEL_LN_SIZE; j++) {
+            AM_INIT_LIST_HEAD(&__g_wheel_ln[i][j]);
+        }
+    }
+
+    __g_wheel_jiffies = 0;
+    __g_hwtimer_freq  = clkrate;
+    return 0;
+}
+
+#endif /* AM_SOFTIMER_WHEEL_EN */
+
+/******************************************************************************/
+unsigned int am_softimer_module_next_ticks (void)
+{
+    unsigned int next;
+
+    int old = am_int_cpu_lock();
+    next = __softimer_next_ticks();
+    am_int_cpu_unlock(old);
+
+    return next;
+}
+
+/******************************************************************************/
+void am_softimer_module_tick_n (unsigned int n)
+{
+    unsigned int next;
+    int          old;
+
+    while (n > 0) {
+
+        old  = am_int_cpu_lock();
+        next = __softimer_next_ticks();
+
+        /* ʣ tick ûжʱڣֱ */
+        if (next > n) {
+            __softimer_skip(n);
+            am_int_cpu_unlock(old);
+            return;
+        }
+
+        /* ǰ tickڵ tick ̴ */
+        __softimer_skip(next - 1);
+        am_int_cpu_unlock(old);
+
+        am_softimer_module_tick();
+
+        n -= next;
+    }
+}
  
 /******************************************************************************/
 int am_softimer_init (am_softimer_t *p_timer, 
@@ -0,0 +1,375 @@
+/*******************************************************************************
+*                                 AMetal
+*                       ----------------------------
+*                       innovating embedded platform
+*
+* Copyright (c) 2001-2018 Guangzhou ZHIYUAN Electronics Co., Ltd.
+* All rights reserved.
+*
+* Contact information:
+* web site:    http://www.zlg.cn/
+*******************************************************************************/
+
+/**
+ * \file
+ * \brief Ƹ־
+ *
+ * λһ¼ĸʽ32λ֣
+ *
+ *     header | fmt | [timestamp] | arg ...
+ *
+ * header ĸ24λΪύ־8λ֡е info ͬ¼ͺֻ header
+ * 㣬еľݿǡύ־ͬԤռʱٽȽ
+ * ¼¼ header 㡣Ͷֻ tail != head ʱȡ headerύ־ʱ
+ * ¼дꡣ
+ *
+ * \internal
+ * \par modification history:
+ * - 1.00 26-10-18  agent, first implementation
+ * \endinternal
+ */
+
+#include "ametal.h"
+#include "am_trace.h"
+#include "am_int.h"
+#include "am_softimer.h"
+
+/*******************************************************************************
+  궨
+*******************************************************************************/
+
+#define __TRACE_SYNC          0xA5          /**< \brief ֡ʼֽ */
+
+#define __TRACE_HDR_COMMIT    0xA5A5A500u   /**< \brief ¼ύı־ */
+#define __TRACE_HDR_MASK      0xFFFFFF00u
+
+#define __TRACE_INFO_NARGS    0x0F          /**< \brief info еĲ */
+#define __TRACE_INFO_TS       0x10          /**< \brief info еʱ־ */
+
+/** \brief ¼ռõ */
+#define __TRACE_REC_WORDS(info) \
+    (2 + (((info) & __TRACE_INFO_TS) ? 1 : 0) + ((info) & __TRACE_INFO_NARGS))
+
+/** \brief ʧ¼ռõʱһ */
+#define __TRACE_LOST_WORDS    3
+
+/** \brief ֡ */
+#define __TRACE_FRAME_MAX     (2 + 4 + 4 + 4 * AM_TRACE_ARGS_MAX + 1)
+
+/*******************************************************************************
+  Ͷ
+*******************************************************************************/
+
+/**
+ * \brief ־豸
+ */
+typedef struct am_trace_dev {
+
+    /** \brief ־Ĵ */
+    am_uart_handle_t     handle;
+
+    /** \brief λNULL ʾδʼ */
+    volatile uint32_t   *p_buf;
+
+    /** \brief λСһ */
+    uint32_t             mask;
+
+    /** \brief һ¼Ԥλãֻٽ޸ */
+    volatile uint32_t    head;
+
+    /** \brief һͼ¼λãֻɷͶ޸ */
+    volatile uint32_t    tail;
+
+    /** \brief ļ¼ */
+    volatile uint32_t    lost;
+
+    /** \brief ȡʱĺ */
+    uint32_t           (*pfn_timestamp) (void);
+
+    /** \brief Ƿڷ */
+    volatile am_bool_t   tx_busy;
+
+    /** \brief ͼ¼ʱ */
+    am_softimer_t        timer;
+
+    /** \brief ڷ͵֡ */
+    uint8_t              frame[__TRACE_FRAME_MAX];
+
+    /** \brief ֡ĳ */
+    uint8_t              frame_len;
+
+    /** \brief ֡һ͵ֽ */
+    uint8_t              frame_pos;
+
+} am_trace_dev_t;
+
+/*******************************************************************************
+  ȫֱ
+*******************************************************************************/
+
+static am_trace_dev_t __g_trace_dev;
+
+/*******************************************************************************
+  غ
+*******************************************************************************/
+
+/**
+ * \brief ֡дһС32λ
+ */
+am_static_inline
+uint8_t *__trace_put_u32 (uint8_t *p_dst, uint32_t val)
+{
+    p_dst[0] = (uint8_t)val;
+    p_dst[1] = (uint8_t)(val >> 8);
+    p_dst[2] = (uint8_t)(val >> 16);
+    p_dst[3] = (uint8_t)(val >> 24);
+
+    return p_dst + 4;
+}
+
+/**
+ * \brief һύļ¼ȡ֡
+ *
+ * ¼ȡͷŻռ䣬ֽ֮֡ڷ
+ */
+static int __trace_frame_load (am_trace_dev_t *p_dev)
+{
+    uint32_t  tail = p_dev->tail;
+    uint32_t  hdr;
+    uint32_t  words, i;
+    uint8_t  *p_frame;
+    uint8_t   sum = 0;
+
+    if (tail == p_dev->head) {
+        return -AM_EEMPTY;
+    }
+
+    hdr = p_dev->p_buf[tail & p_dev->mask];
+    if ((hdr & __TRACE_HDR_MASK) != __TRACE_HDR_COMMIT) {
+        return -AM_EEMPTY;
+    }
+
+    words = __TRACE_REC_WORDS(hdr);
+
+    p_dev->frame[0] = __TRACE_SYNC;
+    p_dev->frame[1] = (uint8_t)hdr;
+    p_frame         = &p_dev->frame[2];
+
+    for (i = 1; i < words; i++) {
+        p_frame = __trace_put_u32(p_frame, p_dev->p_buf[(tail + i) & p_dev->mask]);
+    }
+
+    /* ύ־ͷſռ */
+    p_dev->p_buf[tail & p_dev->mask] = 0;
+    p_dev->tail = tail + words;
+
+    p_dev->frame_len = (uint8_t)(p_frame - p_dev->frame);
+    for (i = 0; i < p_dev->frame_len; i++) {
+        sum += p_dev->frame[i];
+    }
+    p_dev->frame[p_dev->frame_len++] = sum;
+    p_dev->frame_pos = 0;
+
+    return AM_OK;
+}
+
+/**
+ * \brief ڻȡַĻصڴжеã
+ */
+static int __trace_txchar_get (void *p_arg, char *p_char)
+{
+    am_trace_dev_t *p_dev = (am_trace_dev_t *)p_arg;
+
+    if ((p_dev->frame_pos >= p_dev->frame_len) &&
+        (__trace_frame_load(p_dev) != AM_OK)) {
+
+        /* ֮ύļ¼ʱ */
+        p_dev->tx_busy = AM_FALSE;
+        return -AM_EEMPTY;
+    }
+
+    *p_char = (char)p_dev->frame[p_dev->frame_pos++];
+
+    return AM_OK;
+}
+
+/**
+ * \brief Ԥλдһ¼header д
+ */
+am_static_inline
+void __trace_rec_put (am_trace_dev_t *p_dev,
+                      uint32_t        pos,
+                      uint32_t        info,
+                      const char     *p_fmt,
+                      const uint32_t *p_args,
+                      uint32_t        nargs)
+{
+    volatile uint32_t *p_buf = p_dev->p_buf;
+    uint32_t           mask  = p_dev->mask;
+    uint32_t           i     = pos + 1;
+
+    p_buf[i++ & mask] = (uint32_t)p_fmt;
+
+    if (info & __TRACE_INFO_TS) {
+        p_buf[i++ & mask] = p_dev->pfn_timestamp();
+    }
+
+    while (nargs--) {
+        p_buf[i++ & mask] = *p_args++;
+    }
+
+    p_buf[pos & mask] = __TRACE_HDR_COMMIT | info;
+}
+
+/**
+ * \brief д붪ʧ¼
+ *
+ * ¼һֱûµļ¼дʱʱд붪ʧ¼
+ */
+static void __trace_lost_put (am_trace_dev_t *p_dev)
+{
+    uint32_t pos, lost;
+    uint32_t key;
+
+    key  = am_int_cpu_lock();
+    pos  = p_dev->head;
+    lost = p_dev->lost;
+    if (lost && (pos + __TRACE_LOST_WORDS - p_dev->tail <= p_dev->mask + 1)) {
+        p_dev->p_buf[pos & p_dev->mask] = 0;
+        p_dev->head = pos + __TRACE_LOST_WORDS;
+        p_dev->lost = 0;
+    } else {
+        lost = 0;
+    }
+    am_int_cpu_unlock(key);
+
+    if (lost) {
+        __trace_rec_put(p_dev, pos, 1, NULL, &lost, 1);
+    }
+}
+
+/**
+ * \brief ʱصڿм¼ʱ
+ */
+static void __trace_kick (void *p_arg)
+{
+    am_trace_dev_t *p_dev = (am_trace_dev_t *)p_arg;
+
+    if (p_dev->lost) {
+        __trace_lost_put(p_dev);
+    }
+
+    if (!p_dev->tx_busy && (p_dev->tail != p_dev->head)) {
+        p_dev->tx_busy = AM_TRUE;
+        am_uart_tx_startup(p_dev->handle);
+    }
+}
+
+/*******************************************************************************
+  ⲿ
+*******************************************************************************/
+
+int am_trace_init (am_uart_handle_t   handle,
+                   uint32_t          *p_buf,
+                   uint32_t           size,
+                   uint32_t         (*pfn_timestamp) (void))
+{
+    am_trace_dev_t *p_dev = &__g_trace_dev;
+    uint32_t        i;
+    int             ret;
+
+    if ((NULL == handle) || (NULL == p_buf) ||
+        (size < 16) || ((size & (size - 1)) != 0)) {
+        return -AM_EINVAL;
+    }
+
+    for (i = 0; i < size; i++) {
+        p_buf[i] = 0;
+    }
+
+    p_dev->handle        = handle;
+    p_dev->mask          = size - 1;
+    p_dev->head          = 0;
+    p_dev->tail          = 0;
+    p_dev->lost          = 0;
+    p_dev->pfn_timestamp = pfn_timestamp;
+    p_dev->tx_busy       = AM_FALSE;
+    p_dev->frame_len     = 0;
+    p_dev->frame_pos     = 0;
+
+    ret = am_uart_ioctl(handle, AM_UART_MODE_SET, (void *)AM_UART_MODE_INT);
+    if (ret != AM_OK) {
+        return ret;
+    }
+
+    ret = am_uart_callback_set(handle,
+                               AM_UART_CALLBACK_TXCHAR_GET,
+                               (void *)__trace_txchar_get,
+                               p_dev);
+    if (ret != AM_OK) {
+        return ret;
+    }
+
+    ret = am_softimer_init(&p_dev->timer, __trace_kick, p_dev);
+    if (ret != AM_OK) {
+        return ret;
+    }
+
+    p_dev->p_buf = p_buf;
+
+    am_softimer_start(&p_dev->timer, AM_TRACE_KICK_MS);
+
+    return AM_OK;
+}
+
+/******************************************************************************/
+int am_trace_write (const char *p_fmt, const uint32_t *p_args, uint32_t nargs)
+{
+    am_trace_dev_t *p_dev = &__g_trace_dev;
+    uint32_t        info  = nargs;
+    uint32_t        words, need, pos, lost;
+    uint32_t        key;
+
+    if (NULL == p_dev->p_buf) {
+        return -AM_EPERM;
+    }
+
+    if (nargs > AM_TRACE_ARGS_MAX) {
+        return -AM_EINVAL;
+    }
+
+    if (p_dev->pfn_timestamp != NULL) {
+        info |= __TRACE_INFO_TS;
+    }
+    words = __TRACE_REC_WORDS(info);
+
+    /* Ԥռ䣬жļ¼ʱԤһʧ¼ */
+    key  = am_int_cpu_lock();
+    pos  = p_dev->head;
+    lost = p_dev->lost;
+    need = words + (lost ? __TRACE_LOST_WORDS : 0);
+    if (pos + need - p_dev->tail > p_dev->mask + 1) {
+        p_dev->lost = lost + 1;
+        am_int_cpu_unlock(key);
+        return -AM_ENOSPC;
+    }
+    /* ݣheader дǰͶ˲ύ־ */
+    p_dev->p_buf[pos & p_dev->mask] = 0;
+    if (lost) {
+        p_dev->p_buf[(pos + __TRACE_LOST_WORDS) & p_dev->mask] = 0;
+    }
+    p_dev->head = pos + need;
+    p_dev->lost = 0;
+    am_int_cpu_unlock(key);
+
+    if (lost) {
+        __trace_rec_put(p_dev, pos, 1, NULL, &lost, 1);
+        pos += __TRACE_LOST_WORDS;
+    }
+
+    __trace_rec_put(p_dev, pos, info, p_fmt, p_args, nargs);
+
+    return AM_OK;
+}
+
+/* end of file */
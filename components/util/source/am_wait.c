@@ -20,6 +20,8 @@
  * \endinternal
  */
 #include "am_wait.h"
+#include "am_int.h"
+#include "am_jobq.h"
 
 
 /******************************************************************************/
@@ -34,6 +36,68 @@
 #define __WAIT_STAT_WAIT_ON          1   /* ȴ״̬            */
 #define __WAIT_STAT_WAIT_ON_TIMEOUT  2   /* ȴ״̬ʱ   */
 
+/* ˯ָ */
+#if   defined (__CC_ARM)
+#define __WAIT_WFI()    __wfi()
+#define __WAIT_WFE()    __wfe()
+
+#elif defined (__ICCARM__)
+#define __WAIT_WFI()    asm volatile ("wfi")
+#define __WAIT_WFE()    asm volatile ("wfe")
+
+#elif defined (__GNUC__) && (defined (__arm__) || defined (__thumb__))
+#define __WAIT_WFI()    __asm__ volatile ("wfi" : : : "memory")
+#define __WAIT_WFE()    __asm__ volatile ("wfe" : : : "memory")
+
+#else
+#define __WAIT_WFI()
+#define __WAIT_WFE()
+#endif
+
+/******************************************************************************/
+
+/* ȴˣΪ NULL ʱæ */
+static const am_wait_backend_t *__gp_wait_backend = NULL;
+
+/******************************************************************************/
+
+/* ȴδʱĿд */
+static void __wait_idle (am_wait_t *p_wait)
+{
+    const am_wait_backend_t *p_backend = __gp_wait_backend;
+    int                      key;
+
+    if (p_backend == NULL) {
+        return;
+    }
+
+    if (p_backend->pfn_poll != NULL) {
+        p_backend->pfn_poll(p_backend->p_arg);
+    }
+
+    if (p_backend->pfn_sleep != NULL) {
+
+        /* жϺٴμ飬ڼ˯֮ */
+        key = am_int_cpu_lock();
+
+        if (p_wait->val == __WAIT_VAL_INIT) {
+            p_backend->pfn_sleep(p_backend->p_arg);
+        }
+
+        am_int_cpu_unlock(key);
+    }
+}
+
+/* ȴֵıѵȴ */
+static void __wait_wake (void)
+{
+    const am_wait_backend_t *p_backend = __gp_wait_backend;
+
+    if ((p_backend != NULL) && (p_backend->pfn_wake != NULL)) {
+        p_backend->pfn_wake(p_backend->p_arg);
+    }
+}
+
 /******************************************************************************/
 
 static void __timer_callback (void *p_arg)
@@ -43,6 +107,32 @@ static void __timer_callback (void *p_arg)
     p_wait->val = __WAIT_VAL_TIMEOUT;
     
     am_softimer_stop(&p_wait->timer);
+
+    __wait_wake();
+}
+
+/******************************************************************************/
+void am_wait_backend_set (const am_wait_backend_t *p_backend)
+{
+    __gp_wait_backend = p_backend;
+}
+
+/******************************************************************************/
+int am_wait_poll_jobq (void *p_arg)
+{
+    return am_jobq_process((am_jobq_handle_t)p_arg);
+}
+
+/******************************************************************************/
+void am_wait_sleep_wfi (void *p_arg)
+{
+    __WAIT_WFI();
+}
+
+/******************************************************************************/
+void am_wait_sleep_wfe (void *p_arg)
+{
+    __WAIT_WFE();
 }
 
 /******************************************************************************/
@@ -70,7 +160,9 @@ int am_wait_on (am_wait_t *p_wait)
     
     p_wait->stat = __WAIT_STAT_WAIT_ON;
     
-    while(p_wait->val == __WAIT_VAL_INIT);
+    while (p_wait->val == __WAIT_VAL_INIT) {
+        __wait_idle(p_wait);
+    }
     
     p_wait->val  = __WAIT_VAL_INIT;
     p_wait->stat = __WAIT_STAT_INIT;
@@ -86,6 +178,8 @@ int am_wait_done(am_wait_t *p_wait)
     
     p_wait->val  = __WAIT_VAL_DONE;
 
+    __wait_wake();
+
     return AM_OK;
 }
 
@@ -98,7 +192,9 @@ int am_wait_on_timeout(am_wait_t *p_wait, uint32_t timeout_ms)
     
     p_wait->stat = __WAIT_STAT_WAIT_ON_TIMEOUT;
     
-    while(p_wait->val == __WAIT_VAL_INIT);
+    while (p_wait->val == __WAIT_VAL_INIT) {
+        __wait_idle(p_wait);
+    }
     
     if (p_wait->val == __WAIT_VAL_DONE) {  /* ɹȵź */
         ret = AM_OK;
@@ -259,7 +259,7 @@ void demo_zm516x_network_entry (am_zm516x_handle_t zm516x_handle)
     AM_FOREVER {
 
 #ifdef MASTER_BORD_USE
-        if (am_rngbuf_nbytes(&zm516x_handle->uart_rngbuf_dev.rx_rngbuf)
+        if (am_rngbuf_spsc_nbytes(&zm516x_handle->uart_rngbuf_dev.rx_rngbuf)
                                                                     >= 20) {
             if (am_zm516x_receive(zm516x_handle, recv_buf, 20) > 0) {
                 AM_DBG_INFO(recv_buf);
@@ -282,7 +282,7 @@ void demo_zm516x_network_entry (am_zm516x_handle_t zm516x_handle)
             am_zm516x_send(zm516x_handle, "I'am Master\r\n", 14);
         }
 #else
-        if (am_rngbuf_nbytes(&zm516x_handle->uart_rngbuf_dev.rx_rngbuf) >= 14) {
+        if (am_rngbuf_spsc_nbytes(&zm516x_handle->uart_rngbuf_dev.rx_rngbuf) >= 14) {
             if (am_zm516x_receive(zm516x_handle, recv_buf, 14) > 0) {
                 AM_DBG_INFO(recv_buf);
             }
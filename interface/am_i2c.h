@@ -454,6 +454,172 @@ int am_i2c_read(am_i2c_device_t *p_dev,
                 uint32_t         sub_addr,
                 uint8_t         *p_buf, 
                 uint32_t         nbytes);
+
+/**
+ * \brief I2C 첽Уÿ I2C ʹһ
+ *
+ *     am_i2c_write()/am_i2c_read() ϢǰߣͬһϵĶ
+ * 豸ֻδ䣬֮ڿмʹ첽дʱ I2C 
+ * ϢкأһϢɵжֱһϢ߲
+ * СͬʱͳŶȼӳ٣Ŷӵɵʱ䣩
+ *
+ * \note ӦóӦֱӲýṹԱͳϢͨ am_i2c_queue_stat_get()
+ *       ȡ
+ */
+typedef struct am_i2c_queue {
+    am_i2c_handle_t  handle;       /**< \brief I2C׼          */
+    uint32_t         depth;        /**< \brief ǰŶӣڴ */
+    uint32_t         max_depth;    /**< \brief ʷŶ          */
+    uint32_t         done_cnt;     /**< \brief ɵ              */
+    uint32_t         err_cnt;      /**< \brief                 */
+    am_tick_t        latency_max;  /**< \brief ӳ٣ϵͳģ     */
+    am_tick_t        latency_sum;  /**< \brief ۼӳ٣ϵͳģ     */
+} am_i2c_queue_t;
+
+/**
+ * \brief I2C 첽ͳϢ
+ */
+typedef struct am_i2c_queue_stat {
+    uint32_t         depth;        /**< \brief ǰŶӣڴ */
+    uint32_t         max_depth;    /**< \brief ʷŶ          */
+    uint32_t         done_cnt;     /**< \brief ɵ              */
+    uint32_t         err_cnt;      /**< \brief                 */
+    am_tick_t        latency_max;  /**< \brief ӳ٣ϵͳģ     */
+    am_tick_t        latency_avg;  /**< \brief ƽӳ٣ϵͳģ     */
+} am_i2c_queue_stat_t;
+
+/**
+ * \brief I2C 첽ɻص
+ *
+ * \param[in] p_arg  : û
+ * \param[in] status :  am_i2c_message_t  status ͬ
+ */
+typedef void (*am_i2c_async_cb_t) (void *p_arg, int status);
+
+/**
+ * \brief I2C 첽ǰ뱣ЧܶΪֲ
+ *
+ * \note ӦóӦֱӲýṹԱ
+ */
+typedef struct am_i2c_async_trans {
+    am_i2c_message_t    msg;            /**< \brief ӦϢ      */
+    am_i2c_transfer_t   trans[2];       /**< \brief ӵַݴ    */
+    uint8_t             subaddr_buf[2]; /**< \brief ӵַ              */
+    am_i2c_queue_t     *p_queue;        /**< \brief 첽  */
+    am_tick_t           start_tick;     /**< \brief Ŷʱϵͳ    */
+    am_i2c_async_cb_t   pfn_done;       /**< \brief ɻص        */
+    void               *p_arg;          /**< \brief ɻص    */
+} am_i2c_async_trans_t;
+
+/**
+ * \brief ʼ I2C 첽
+ *
+ * \param[in] p_queue : ָ첽еָ
+ * \param[in] handle  : I2C׼
+ *
+ * \retval  AM_OK     : ʼɹ
+ * \retval -AM_EINVAL : 
+ */
+int am_i2c_queue_init (am_i2c_queue_t *p_queue, am_i2c_handle_t handle);
+
+/**
+ * \brief I2C 첽дݣŶӺ
+ *
+ * \param[in] p_queue  : ָ첽еָ룬ӻ߶Ӧ
+ * \param[in] p_trans  : ָ첽ָ
+ * \param[in] p_dev    : ָӻ豸ϢĽṹָ
+ * \param[in] sub_addr : ӻ豸ӵַ
+ * \param[in] p_buf    : ָݻ棬ǰ뱣Ч
+ * \param[in] nbytes   : ݻ泤
+ * \param[in] pfn_done : ɻصжеãΪ NULL
+ * \param[in] p_arg    : ɻص
+ *
+ * \retval  AM_OK      : Ŷӳɹ
+ * \retval -AM_EINVAL  : 
+ * \retval -AM_ENOTSUP : ӵַȲ֧
+ */
+int am_i2c_write_async (am_i2c_queue_t       *p_queue,
+                        am_i2c_async_trans_t *p_trans,
+                        am_i2c_device_t      *p_dev,
+                        uint32_t              sub_addr,
+                        const uint8_t        *p_buf,
+                        uint32_t              nbytes,
+                        am_i2c_async_cb_t     pfn_done,
+                        void                 *p_arg);
+
+/**
+ * \brief I2C 첽ݣŶӺ
+ *
+ * \param[in] p_queue  : ָ첽еָ룬ӻ߶Ӧ
+ * \param[in] p_trans  : ָ첽ָ
+ * \param[in] p_dev    : ָӻ豸ϢĽṹָ
+ * \param[in] sub_addr : ӻ豸ӵַ
+ * \param[in] p_buf    : ָݻ
+ * \param[in] nbytes   : ݻ泤
+ * \param[in] pfn_done : ɻصжеãΪ NULL
+ * \param[in] p_arg    : ɻص
+ *
+ * \retval  AM_OK      : Ŷӳɹ
+ * \retval -AM_EINVAL  : 
+ * \retval -AM_ENOTSUP : ӵַȲ֧
+ */
+int am_i2c_read_async (am_i2c_queue_t       *p_queue,
+                       am_i2c_async_trans_t *p_trans,
+                       am_i2c_device_t      *p_dev,
+                       uint32_t              sub_addr,
+                       uint8_t              *p_buf,
+                       uint32_t              nbytes,
+                       am_i2c_async_cb_t     pfn_done,
+                       void                 *p_arg);
+
+/**
+ * \brief ȡ I2C 첽еͳϢ
+ *
+ * \param[in]  p_queue : ָ첽еָ
+ * \param[out] p_stat  : ȡͳϢ
+ *
+ * \retval  AM_OK     : ȡɹ
+ * \retval -AM_EINVAL : 
+ */
+int am_i2c_queue_stat_get (am_i2c_queue_t *p_queue, am_i2c_queue_stat_t *p_stat);
+
+/**
+ * \brief ѯֵͨúԭֵns
+ *
+ * ֧ѯͨ I2C ṩ am_zlg_i2c_poll_ns_set()
+ */
+typedef uint32_t (*am_i2c_poll_ns_set_t) (am_i2c_handle_t handle,
+                                          uint32_t        poll_ns);
+
+/**
+ * \brief ʵϢԴΪѯֵͨ
+ *
+ * ȹرѯͨظ addr ȡ nbytes ֽ ms 룬ѯ
+ * ʽȡͬĴߺʱ֮ԴÿϢжϺͻѿ
+ * ʱʹϵͳĲӽıؿʼʱԼΪһĳԴ
+ *  ms ӦΪڵٱ
+ *
+ * \param[in]  handle          : I2C׼
+ * \param[in]  pfn_poll_ns_set : ѯֵú
+ * \param[in]  addr            : ʹõĴӻַ7λӦѡ޸
+ *                               Ĵӻ
+ * \param[out] p_buf           : ݻ
+ * \param[in]  nbytes          : ÿζȡֵֽΪһμĴʵĳ
+ * \param[in]  ms              : ÿַʽ̲ʱ䣨ms
+ *
+ * \retval >=0         : ʵnsΪѯֵ
+ * \retval -AM_EINVAL  : 
+ * \retval         : ֲֵ
+ *
+ * \note ڼ䲻Ӧʹø I2C 
+ */
+int am_i2c_poll_calibrate (am_i2c_handle_t       handle,
+                           am_i2c_poll_ns_set_t  pfn_poll_ns_set,
+                           uint16_t              addr,
+                           uint8_t              *p_buf,
+                           uint32_t              nbytes,
+                           uint32_t              ms);
+
 /** 
  * @}
  */
@@ -150,6 +150,21 @@ void am_isr_defer_job_init (am_isr_defer_job_t  *p_job,
  */
 int am_isr_defer_job_add (am_isr_defer_job_t *p_job);
 
+/**
+ * \brief ȴڼ䴦жӳҵȴ˵Э
+ *
+ *     úΪ am_wait_backend_t  pfn_poll am_wait_on() ͬȴ
+ * ڼ佫жӳҵٿתȴжӳҵУҵ
+ * úֱӷء
+ *
+ * \param[in] p_arg : δʹ
+ *
+ * \retval AM_OK     : 
+ * \retval -AM_EBUSY : ҵڴ
+ * \retval -AM_EPERM : isr deferģδȷʼ
+ */
+int am_isr_defer_wait_poll (void *p_arg);
+
 /** @}  */
 
 #ifdef __cplusplus
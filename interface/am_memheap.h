@@ -35,6 +35,37 @@ extern "C" {
  * @{
  */
 
+/**
+ * \name пʽãʱѡ
+ *
+ * Ĭʹõһ״䣨first-fitʱƬ
+ * ڱѡж AM_MEMHEAP_TLSF_EN Ϊ 1ʹ䣨TLSFʽ
+ * Спֱ AM_MEMHEAP_TLSF_FL_COUNT * (1 << AM_MEMHEAP_TLSF_SL_BITS)
+ * УλͼͷźʱΪ O(1)Ƭн硣
+ * @{
+ */
+
+/** \brief Ϊ1ʱʹ TLSF ʽп */
+#ifndef AM_MEMHEAP_TLSF_EN
+#define AM_MEMHEAP_TLSF_EN          0
+#endif
+
+/**
+ * \brief TLSF һ2ݴ䣩ĸ
+ *
+ *  2^(FL_COUNT + SL_BITS + 1) ֽڵĿпͳһһ
+ */
+#ifndef AM_MEMHEAP_TLSF_FL_COUNT
+#define AM_MEMHEAP_TLSF_FL_COUNT    16
+#endif
+
+/** \brief TLSF ڶλÿһԵȷΪ (1 << SL_BITS)  */
+#ifndef AM_MEMHEAP_TLSF_SL_BITS
+#define AM_MEMHEAP_TLSF_SL_BITS     3
+#endif
+
+/** @} */
+
 /**
  * \brief memory item on the memory heap
  */
@@ -66,7 +97,18 @@ typedef struct am_memheap
 
     struct am_memheap_item *free_list;          /**< free block list */
     struct am_memheap_item  free_header;        /**< free block list header */
- 
+
+#if AM_MEMHEAP_TLSF_EN
+    uint32_t                fl_bitmap;          /**< TLSF first level bitmap */
+
+    /** TLSF second level bitmaps */
+    uint32_t                sl_bitmap[AM_MEMHEAP_TLSF_FL_COUNT];
+
+    /** TLSF segregated free lists */
+    struct am_memheap_item *tlsf_free[AM_MEMHEAP_TLSF_FL_COUNT]
+                                     [1 << AM_MEMHEAP_TLSF_SL_BITS];
+#endif
+
 } am_memheap_t;
 
 /**
@@ -0,0 +1,217 @@
+/*******************************************************************************
+*                                 AMetal
+*                       ----------------------------
+*                       innovating embedded platform
+*
+* Copyright (c) 2001-2018 Guangzhou ZHIYUAN Electronics Co., Ltd.
+* All rights reserved.
+*
+* Contact information:
+* web site:    http://www.zlg.cn/
+*******************************************************************************/
+
+/**
+ * \file
+ * \brief ̶Сڴ
+ *
+ *     ڴعһСͬڴ飬ȡͷžΪ O(1) ҲҪ
+ * ĿͷϢƵͬСͨ֡ĳϡ
+ * ȡͷŲڲݹرжϣжʹá
+ *
+ *     ڴصĴ洢ռǾ̬ģʹ AM_MEMPOOL_DECL() 壩
+ * ҲԴϵͳз䣨ʹ am_mempool_create() 
+ *
+ * ʹñҪͷļ:
+ * \code
+ * #include "am_mempool.h"
+ * \endcode
+ *
+ * \par 
+ * \code
+ * AM_MEMPOOL_DECL_STATIC(g_frame_pool, sizeof(frame_t), 8);
+ *
+ * AM_MEMPOOL_INIT(g_frame_pool, sizeof(frame_t));
+ *
+ * frame_t *p_frame = (frame_t *)am_mempool_get(&g_frame_pool.pool);
+ * ...
+ * am_mempool_put(&g_frame_pool.pool, p_frame);
+ * \endcode
+ *
+ * \internal
+ * \par modification history:
+ * - 1.00 26-10-18  agent, first implementation
+ * \endinternal
+ */
+
+#ifndef __AM_MEMPOOL_H
+#define __AM_MEMPOOL_H
+
+#include "am_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  /* __cplusplus  */
+
+/**
+ * \addtogroup am_if_mempool
+ * \copydoc am_mempool.h
+ * @{
+ */
+
+/**
+ * \brief ڴʵʴСָС϶룬ҲСһָ룩
+ */
+#define AM_MEMPOOL_BLK_SIZE(blk_size)                                  \
+            AM_ROUND_UP(((blk_size) < sizeof(void *) ?                 \
+                         sizeof(void *) : (blk_size)), sizeof(void *))
+
+/**
+ * \brief ڴؽṹ壬ӦóӦֱӲṹԱ
+ */
+typedef struct am_mempool {
+    void      *p_free;        /**< \brief пָڿڣ */
+    uint8_t   *p_start;       /**< \brief 洢ռʼַ                 */
+    size_t     blk_size;      /**< \brief ڴСѶ룩             */
+    size_t     nblks;         /**< \brief ڴ                       */
+    size_t     nfree;         /**< \brief ǰп                     */
+    size_t     min_free;      /**< \brief ʷٿп                 */
+    uint32_t   fail_cnt;      /**< \brief ȡʧܵĴ                   */
+    am_bool_t  from_heap;     /**< \brief 洢ռǷϵͳз       */
+} am_mempool_t;
+
+/**
+ * \brief ڴͳϢ
+ */
+typedef struct am_mempool_stat {
+    size_t     blk_size;      /**< \brief ڴСѶ룩             */
+    size_t     nblks;         /**< \brief ڴ                       */
+    size_t     nfree;         /**< \brief ǰп                     */
+    size_t     max_used;      /**< \brief ʷͬʱʹõĿˮλ */
+    uint32_t   fail_cnt;      /**< \brief ȡʧܵĴ                   */
+} am_mempool_stat_t;
+
+/**
+ * \brief ʹָĴ洢ռʼڴ
+ *
+ * \param[in] p_pool   : ָڴ
+ * \param[in] p_buf    : 洢ռ䣬밴ָС
+ * \param[in] buf_size : 洢ռĴСֽ
+ * \param[in] blk_size : ڴС
+ *
+ * \retval AM_OK      : ʼɹ
+ * \retval -AM_EINVAL : Ч洢ռ䲻һڴδ룩
+ *
+ * \note ڴΪ buf_size / AM_MEMPOOL_BLK_SIZE(blk_size)
+ */
+am_err_t am_mempool_init (am_mempool_t *p_pool,
+                          void         *p_buf,
+                          size_t        buf_size,
+                          size_t        blk_size);
+
+/**
+ * \brief ϵͳз洢ռ䲢ʼڴ
+ *
+ * \param[in] p_pool   : ָڴ
+ * \param[in] blk_size : ڴС
+ * \param[in] nblks    : ڴ
+ *
+ * \retval AM_OK      : ɹ
+ * \retval -AM_EINVAL : Ч
+ * \retval -AM_ENOMEM : ϵͳѿռ䲻
+ */
+am_err_t am_mempool_create (am_mempool_t *p_pool,
+                            size_t        blk_size,
+                            size_t        nblks);
+
+/**
+ * \brief ڴأ洢ռϵͳз䣬ͷ
+ *
+ * \param[in] p_pool : ָڴ
+ *
+ * \return 
+ *
+ * \note ȷڴѹ黹
+ */
+void am_mempool_destroy (am_mempool_t *p_pool);
+
+/**
+ * \brief ڴлȡһڴ飨жеã
+ *
+ * \param[in] p_pool : ָڴ
+ *
+ * \return ڴ׵ַNULL޿пЧ
+ */
+void *am_mempool_get (am_mempool_t *p_pool);
+
+/**
+ * \brief ڴ黹ڴأжеã
+ *
+ * \param[in] p_pool : ָڴ
+ * \param[in] p_blk  :  am_mempool_get() ȡڴ
+ *
+ * \retval AM_OK      : 黹ɹ
+ * \retval -AM_EINVAL : ڴ鲻ڸڴ
+ */
+am_err_t am_mempool_put (am_mempool_t *p_pool, void *p_blk);
+
+/**
+ * \brief ȡڴصͳϢ
+ *
+ * \param[in]  p_pool : ָڴ
+ * \param[out] p_stat : ȡͳϢ
+ *
+ * \retval AM_OK      : ȡɹ
+ * \retval -AM_EINVAL : Ч
+ */
+am_err_t am_mempool_stat_get (am_mempool_t *p_pool, am_mempool_stat_t *p_stat);
+
+/**
+ * \brief ڴʵ̬洢ռ䣩
+ *
+ * \param[in] pool_name : ڴ
+ * \param[in] blk_size  : ڴС
+ * \param[in] nblks     : ڴ
+ *
+ * \note ֻģʹãʹ AM_MEMPOOL_DECL_STATIC() Ϊ̬
+ */
+#define AM_MEMPOOL_DECL(pool_name, blk_size, nblks)                            \
+            struct __mempoolinfo_##pool_name {                                 \
+                am_mempool_t  pool;                                            \
+                void         *buf[(AM_MEMPOOL_BLK_SIZE(blk_size) /             \
+                                   sizeof(void *)) * (nblks)];                 \
+            } pool_name;
+
+/**
+ * \brief ڴʵ̬
+ *
+ * \param[in] pool_name : ڴ
+ * \param[in] blk_size  : ڴС
+ * \param[in] nblks     : ڴ
+ */
+#define AM_MEMPOOL_DECL_STATIC(pool_name, blk_size, nblks)                     \
+            static AM_MEMPOOL_DECL(pool_name, blk_size, nblks)
+
+/**
+ * \brief ʼ AM_MEMPOOL_DECL()  AM_MEMPOOL_DECL_STATIC() ڴ
+ *
+ * \param[in] pool_name : ڴ
+ * \param[in] blk_size  : ڴС붨ʱһ
+ *
+ * \retval AM_OK      : ʼɹ
+ * \retval -AM_EINVAL : Ч
+ */
+#define AM_MEMPOOL_INIT(pool_name, blk_size)                                   \
+            am_mempool_init(&(pool_name.pool),                                 \
+                              pool_name.buf,                                   \
+                              sizeof(pool_name.buf),                           \
+                             (blk_size))
+
+/** @}  am_if_mempool */
+
+#ifdef __cplusplus
+}
+#endif  /* __cplusplus  */
+
+#endif  /* __AM_MEMPOOL_H */
+
+/* end of file */
@@ -48,6 +48,24 @@ extern "C" {
    
 #include "ametal.h"
 
+/**
+ * \name NVRAM ãʱѡ
+ * @{
+ */
+
+/**
+ * \brief 洢ɢбĴСΪ2ݣΪ0ʱʹɢб
+ *
+ * am_nvram_init() ʱ洢εֺ͵ԪŽɢбam_nvram_get() 
+ * am_nvram_set() Ҵ洢ʱȽϴ洢бɢбʹ 3/4
+ * Ĵ洢ԿͨȽҵÿռ2ֽ RAM
+ */
+#ifndef AM_NVRAM_HASH_SIZE
+#define AM_NVRAM_HASH_SIZE    64
+#endif
+
+/** @} */
+
 /** 
  * \brief 洢Ͷ
  *
@@ -103,6 +121,15 @@ typedef struct am_nvram_dev {
     struct am_nvram_dev             *p_next;     /**< \brief ָһ豸   */
 } am_nvram_dev_t;
 
+/**
+ * \brief Ѵ򿪵Ĵ洢Σ am_nvram_open() ʼӦóӦֱӲṹԱ
+ */
+typedef struct am_nvram_seg_handle {
+    const am_nvram_segment_t *p_seg;     /**< \brief 洢                    */
+    am_nvram_dev_t           *p_dev;     /**< \brief 洢Ĵ洢豸    */
+    uint32_t                  dev_gen;   /**< \brief 豸ʱ豸б汾  */
+} am_nvram_seg_handle_t;
+
 /**
  * \brief NVRAM ʼ
  * \param[in] p_seglist : ϵͳ洢б
@@ -215,6 +242,65 @@ int am_nvram_set (char *p_name, int unit, uint8_t *p_buf, int offset, int len);
  */
 int am_nvram_size_get (char *p_name, int unit, size_t *p_size);
 
+/**
+ * \brief һ洢
+ *
+ *     ʱҴ洢μĴ洢豸 \a p_hdl У֮ʹ
+ * am_nvram_read()  am_nvram_write() дô洢ʱֲٰң
+ * ҪƵͬһ洢εĳϡ洢豸ע󣬾´ζдʱ
+ * 豸
+ *
+ * \param[out] p_hdl  洢ξ
+ * \param[in]  p_name ʧԴ洢Ϣ
+ * \param[in]  unit   ʧԴ洢ϢĵԪ
+ *
+ * \retval AM_OK      ɹ
+ * \retval -AM_EINVAL ΪNULLָĴ洢β
+ * \retval -AM_ENODEV 洢Ĵ洢豸δע
+ *
+ * \par ʾ
+ * \code
+ *  #include "am_nvram.h"
+ *
+ *  am_nvram_seg_handle_t ip_hdl;
+ *  char                  ip[4];
+ *
+ *  am_nvram_open(&ip_hdl, "ip", 0);
+ *  am_nvram_read(&ip_hdl, &ip[0], 0, 4);   //  am_nvram_get("ip", 0, ...) ͬ
+ * \endcode
+ */
+int am_nvram_open (am_nvram_seg_handle_t *p_hdl, const char *p_name, int unit);
+
+/**
+ * \brief ȡѴ򿪵Ĵ洢
+ *
+ * \param[in]  p_hdl    am_nvram_open() 򿪵Ĵ洢
+ * \param[out] p_buf   ȡݻ
+ * \param[in]  offset  ڴ洢еƫ
+ * \param[in]  len     Ҫȡĳ
+ *
+ * \return  am_nvram_get() ͬ
+ */
+int am_nvram_read (am_nvram_seg_handle_t *p_hdl,
+                   uint8_t               *p_buf,
+                   int                    offset,
+                   int                    len);
+
+/**
+ * \brief дѴ򿪵Ĵ洢
+ *
+ * \param[in] p_hdl    am_nvram_open() 򿪵Ĵ洢
+ * \param[in] p_buf   дݻ
+ * \param[in] offset  ڴ洢еƫ
+ * \param[in] len     Ҫдĳ
+ *
+ * \return  am_nvram_set() ͬ
+ */
+int am_nvram_write (am_nvram_seg_handle_t *p_hdl,
+                    uint8_t               *p_buf,
+                    int                    offset,
+                    int                    len);
+
 /** @} am_if_nvram */
 
 #ifdef __cplusplus
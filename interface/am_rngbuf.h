@@ -154,6 +154,165 @@ size_t am_rngbuf_freebytes (am_rngbuf_t rb);
  */
 size_t am_rngbuf_nbytes (am_rngbuf_t rb);
 
+/**
+ * \name /ߣSPSCλ
+ *
+ * СΪ 2^nдλΪļֵдλֻ޸ģ
+ * λֻ޸ģʹڴϱ֤λõȺ˳ˣһ
+ * ߣжϣһߣͬʱʱرжϡ
+ *
+ * ߿ɵõĽӿڣputcharputreservepublishfreebytesisfull
+ * ߿ɵõĽӿڣgetchargetpeekcommitflushnbytesisempty
+ *
+ * reserve/publish  peek/commit 㿽ֱӻȡһ
+ * дɶ򣬲ɺٷͷţʵʹõֽ
+ * @{
+ */
+
+/**
+ * \brief SPSC λṹ
+ * \note ҪֱӲṹĳԱ
+ */
+struct am_rngbuf_spsc {
+    volatile uint32_t  head;    /**< \brief д޸ģ */
+    volatile uint32_t  tail;    /**< \brief ޸ģ */
+    uint32_t           mask;    /**< \brief С - 1           */
+    char              *buf;     /**< \brief                    */
+};
+
+/** \brief SPSC λ */
+typedef struct am_rngbuf_spsc *am_rngbuf_spsc_t;
+
+/**
+ * \brief ʼ SPSC λ
+ *
+ * \param[in] p_rb  : ҪʼĻλ
+ * \param[in] p_buf : λʹõĻռ
+ * \param[in] size  : СΪ 2^nȫռʹ
+ *
+ * \retval  AM_OK     : ʼ
+ * \retval -AM_EINVAL : ʼʧܣЧ
+ */
+int am_rngbuf_spsc_init (struct am_rngbuf_spsc *p_rb, char *p_buf, size_t size);
+
+/**
+ * \brief һֽڵ SPSC λߣ
+ * \param[in] rb   : ҪĻλ
+ * \param[in] data : Ҫŵֽ
+ * \retval 0 : ݴʧܣ
+ * \retval 1 : ݳɹ
+ */
+int am_rngbuf_spsc_putchar (am_rngbuf_spsc_t rb, const char data);
+
+/**
+ * \brief  SPSC λȡһֽݣߣ
+ * \param[in] rb     : ҪĻλ
+ * \param[in] p_data : ֽڵָ
+ * \retval 0 : ȡʧܣ
+ * \retval 1 : ݳɹȡ
+ */
+int am_rngbuf_spsc_getchar (am_rngbuf_spsc_t rb, char *p_data);
+
+/**
+ * \brief ֽڵ SPSC λߣ
+ * \param[in] rb     : ҪĻλ
+ * \param[in] p_buf  : Ҫŵλݻ
+ * \param[in] nbytes : Ҫŵλݸ
+ * \return ɹŵݸ
+ */
+size_t am_rngbuf_spsc_put (am_rngbuf_spsc_t rb, const char *p_buf, size_t nbytes);
+
+/**
+ * \brief  SPSC λȡݣߣ
+ * \param[in] rb     : ҪĻλ
+ * \param[in] p_buf  : ŻȡݵĻ
+ * \param[in] nbytes : Ҫȡݸ
+ * \return ɹȡݸ
+ */
+size_t am_rngbuf_spsc_get (am_rngbuf_spsc_t rb, char *p_buf, size_t nbytes);
+
+/**
+ * \brief ȡһĿдߣ㿽д
+ *
+ * \param[in]  rb       : ҪĻλ
+ * \param[out] pp_space : ȡĿд׵ַ
+ *
+ * \return дֽΪ 0 ʾ
+ *
+ * \note д am_rngbuf_spsc_publish() ǰ߲ɼ
+ */
+size_t am_rngbuf_spsc_reserve (am_rngbuf_spsc_t rb, char **pp_space);
+
+/**
+ * \brief дݣߣ
+ *
+ * \param[in] rb     : ҪĻλ
+ * \param[in] nbytes : ֽܴ am_rngbuf_spsc_freebytes() ֵ
+ *
+ * \return 
+ */
+void am_rngbuf_spsc_publish (am_rngbuf_spsc_t rb, size_t nbytes);
+
+/**
+ * \brief ȡһĿɶߣ㿽
+ *
+ * \param[in]  rb      : ҪĻλ
+ * \param[out] pp_data : ȡĿɶ׵ַ
+ *
+ * \return ɶֽΪ 0 ʾ
+ *
+ * \note ݴ am_rngbuf_spsc_commit() ͷſռ
+ */
+size_t am_rngbuf_spsc_peek (am_rngbuf_spsc_t rb, char **pp_data);
+
+/**
+ * \brief ͷѶȡռõĿռ䣨ߣ
+ *
+ * \param[in] rb     : ҪĻλ
+ * \param[in] nbytes : ͷŵֽܴ am_rngbuf_spsc_nbytes() ֵ
+ *
+ * \return 
+ */
+void am_rngbuf_spsc_commit (am_rngbuf_spsc_t rb, size_t nbytes);
+
+/**
+ * \brief  SPSC λߣ
+ * \param[in] rb : ҪĻλ
+ * \return 
+ * \note һգ豣֤ʱ߲ͬʱ
+ */
+void am_rngbuf_spsc_flush (am_rngbuf_spsc_t rb);
+
+/**
+ * \brief  SPSC λǷΪ
+ * \param[in] rb : ҪԵĻλ
+ * \return λշAM_TRUE, 򷵻AM_FALSE
+ */
+am_bool_t am_rngbuf_spsc_isempty (am_rngbuf_spsc_t rb);
+
+/**
+ * \brief  SPSC λǷ
+ * \param[in] rb : ҪԵĻλ
+ * \return λAM_TRUE, 򷵻AM_FALSE
+ */
+am_bool_t am_rngbuf_spsc_isfull (am_rngbuf_spsc_t rb);
+
+/**
+ * \brief ȡ SPSC λпռС
+ * \param[in] rb : ҪжϵĻλ
+ * \return λпռС
+ */
+size_t am_rngbuf_spsc_freebytes (am_rngbuf_spsc_t rb);
+
+/**
+ * \brief ȡ SPSC λֽڸ
+ * \param[in] rb : ҪжϵĻλ
+ * \return λֽڸ
+ */
+size_t am_rngbuf_spsc_nbytes (am_rngbuf_spsc_t rb);
+
+/** @} */
+
 /**
  * @} 
  */
@@ -0,0 +1,293 @@
+/*******************************************************************************
+*                                 AMetal
+*                       ----------------------------
+*                       innovating embedded platform
+*
+* Copyright (c) 2001-2018 Guangzhou ZHIYUAN Electronics Co., Ltd.
+* All rights reserved.
+*
+* Contact information:
+* web site:    http://www.zlg.cn/
+*******************************************************************************/
+
+/**
+ * \file
+ * \brief ȷ
+ *
+ *     õѯעĴÿȫͨ
+ * һ am_sensor_data_get() жȡɾݴ˺ϲΪһͻȡ
+ * ͬʱ뻷λӦóȡ
+ *
+ *     дһʱʱΪһεڵʱ䣬
+ * ͬһʱ̵ڵĴһλдϡʵʵ߶ȡжӳ
+ * am_isr_deferִУȷжӳģѳʼ
+ *
+ *     жӳд롢һȡд֮رжϡ
+ *
+ * ʹñҪͷļ:
+ * \code
+ * #include "am_sensor_sampler.h"
+ * \endcode
+ *
+ * \par 
+ * \code
+ * AM_SENSOR_SAMPLER_DECL_STATIC(g_sampler, 32);
+ *
+ * static am_sensor_sampler_src_t g_hts221_src;
+ * static const int               g_hts221_ids[] = {0, 1};
+ *
+ * AM_SENSOR_SAMPLER_INIT(g_sampler);
+ * am_sensor_sampler_add(&g_sampler.sampler,
+ *                       &g_hts221_src,
+ *                        hts221_handle,
+ *                        g_hts221_ids,
+ *                        2,
+ *                        100);
+ * am_sensor_sampler_start(&g_sampler.sampler);
+ *
+ * while (1) {
+ *     am_sensor_sample_t sample;
+ *
+ *     while (am_sensor_sampler_read(&g_sampler.sampler, &sample, 1) == 1) {
+ *         //  sample
+ *     }
+ * }
+ * \endcode
+ *
+ * \internal
+ * \par modification history:
+ * - 1.00 26-10-18  agent, first implementation
+ * \endinternal
+ */
+
+#ifndef __AM_SENSOR_SAMPLER_H
+#define __AM_SENSOR_SAMPLER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "am_common.h"
+#include "am_list.h"
+#include "am_softimer.h"
+#include "am_isr_defer.h"
+#include "am_sensor.h"
+
+/**
+ * \addtogroup am_if_sensor_sampler
+ * \copydoc am_sensor_sampler.h
+ * @{
+ */
+
+/**
+ * \name ãʱѡ
+ * @{
+ */
+
+/** \brief ÿһβͨ */
+#ifndef AM_SENSOR_SAMPLER_CHAN_MAX
+#define AM_SENSOR_SAMPLER_CHAN_MAX    4
+#endif
+
+/**
+ * \brief ǰʱ䴰ڣms
+ *
+ * һλʱ뵽ڲʱĴҲһԼٻѴ
+ * Ϊ0ʱѾڵĴ
+ */
+#ifndef AM_SENSOR_SAMPLER_BATCH_MS
+#define AM_SENSOR_SAMPLER_BATCH_MS    0
+#endif
+
+/** @} */
+
+/**
+ * \brief 
+ */
+typedef struct am_sensor_sample {
+    am_tick_t           tick;     /**< \brief ʱ̣ϵͳģ       */
+    am_sensor_handle_t  handle;   /**< \brief                  */
+    int                 id;       /**< \brief ͨ id                    */
+    am_sensor_val_t     val;      /**< \brief ֵ                     */
+} am_sensor_sample_t;
+
+/**
+ * \brief ԴעһӦóӦֱӲṹԱ
+ */
+typedef struct am_sensor_sampler_src {
+    struct am_list_head  node;           /**< \brief ڵ                 */
+    am_sensor_handle_t   handle;         /**< \brief                */
+    const int           *p_ids;          /**< \brief ͨ id б             */
+    int                  num;            /**< \brief ͨĿ                 */
+    am_tick_t            period_ticks;   /**< \brief ڣϵͳģ     */
+    am_tick_t            next_tick;      /**< \brief һβʱ           */
+} am_sensor_sampler_src_t;
+
+/**
+ * \brief ӦóӦֱӲṹԱ
+ */
+typedef struct am_sensor_sampler {
+    struct am_list_head    src_list;     /**< \brief Դ               */
+    am_sensor_sample_t    *p_buf;        /**< \brief            */
+    uint32_t               mask;         /**< \brief  - 1         */
+    volatile uint32_t      head;         /**< \brief д                 */
+    volatile uint32_t      tail;         /**< \brief                  */
+    am_softimer_t          timer;        /**< \brief ȶʱ               */
+    am_isr_defer_job_t     job;          /**< \brief                  */
+    am_bool_t              running;      /**< \brief Ƿ               */
+    uint32_t               nreads;       /**< \brief ȡ           */
+    uint32_t               nsamples;     /**< \brief д뻺Ĳ       */
+    uint32_t               overrun;      /**< \brief Ĳ     */
+    uint32_t               err_cnt;      /**< \brief ȡʧܵĴ           */
+} am_sensor_sampler_t;
+
+/**
+ * \brief ͳϢ
+ */
+typedef struct am_sensor_sampler_stat {
+    uint32_t  nreads;       /**< \brief ȡÿζȡһ */
+    uint32_t  nsamples;     /**< \brief д뻺Ĳ                   */
+    uint32_t  overrun;      /**< \brief Ĳ                 */
+    uint32_t  err_cnt;      /**< \brief ȡʧܵĴ                       */
+} am_sensor_sampler_stat_t;
+
+/**
+ * \brief ʼ
+ *
+ * \param[in] p_sampler : ָ
+ * \param[in] p_buf     : 
+ * \param[in] nsamples  : ɵĲΪ 2^n
+ *
+ * \retval AM_OK      : ʼɹ
+ * \retval -AM_EINVAL : Ч
+ * \retval -AM_EPERM  : ʱģδʼ
+ */
+am_err_t am_sensor_sampler_init (am_sensor_sampler_t *p_sampler,
+                                 am_sensor_sample_t  *p_buf,
+                                 uint32_t             nsamples);
+
+/**
+ * \brief עһԴ
+ *
+ * µĲԴһεʱ
+ *
+ * \param[in] p_sampler : ָ
+ * \param[in] p_src     : Դɵṩ洢ռ䣬עǰ뱣Ч
+ * \param[in] handle    : ӦͨӦʹ
+ * \param[in] p_ids     : ͨ id бעǰ뱣Ч
+ * \param[in] num       : ͨĿ AM_SENSOR_SAMPLER_CHAN_MAX
+ * \param[in] period_ms : ڣms
+ *
+ * \retval AM_OK      : עɹ
+ * \retval -AM_EINVAL : Ч
+ */
+am_err_t am_sensor_sampler_add (am_sensor_sampler_t     *p_sampler,
+                                am_sensor_sampler_src_t *p_src,
+                                am_sensor_handle_t       handle,
+                                const int               *p_ids,
+                                int                      num,
+                                uint32_t                 period_ms);
+
+/**
+ * \brief עһԴ
+ *
+ * \param[in] p_sampler : ָ
+ * \param[in] p_src     :  am_sensor_sampler_add() עĲԴ
+ *
+ * \retval AM_OK      : עɹ
+ * \retval -AM_EINVAL : Ч
+ */
+am_err_t am_sensor_sampler_remove (am_sensor_sampler_t     *p_sampler,
+                                   am_sensor_sampler_src_t *p_src);
+
+/**
+ * \brief ȣвԴеһβ
+ *
+ * \param[in] p_sampler : ָ
+ *
+ * \retval AM_OK      : ɹ
+ * \retval -AM_EINVAL : Ч
+ */
+am_err_t am_sensor_sampler_start (am_sensor_sampler_t *p_sampler);
+
+/**
+ * \brief ֹͣȣδȡĲ
+ *
+ * \param[in] p_sampler : ָ
+ *
+ * \retval AM_OK      : ֹͣɹ
+ * \retval -AM_EINVAL : Ч
+ */
+am_err_t am_sensor_sampler_stop (am_sensor_sampler_t *p_sampler);
+
+/**
+ * \brief ȡ
+ *
+ * \param[in]  p_sampler : ָ
+ * \param[out] p_samples : Ų
+ * \param[in]  max       : ȡĲ
+ *
+ * \return ʵʶȡĲ0 ʾΪ
+ */
+int am_sensor_sampler_read (am_sensor_sampler_t *p_sampler,
+                            am_sensor_sample_t  *p_samples,
+                            int                  max);
+
+/**
+ * \brief ȡͳϢ
+ *
+ * \param[in]  p_sampler : ָ
+ * \param[out] p_stat    : ȡͳϢ
+ *
+ * \retval AM_OK      : ȡɹ
+ * \retval -AM_EINVAL : Ч
+ */
+am_err_t am_sensor_sampler_stat_get (am_sensor_sampler_t      *p_sampler,
+                                     am_sensor_sampler_stat_t *p_stat);
+
+/**
+ * \brief ʵ
+ *
+ * \param[in] sampler_name : 
+ * \param[in] nsamples     : ɵĲΪ 2^n
+ *
+ * \note ֻģʹãʹ AM_SENSOR_SAMPLER_DECL_STATIC()
+ */
+#define AM_SENSOR_SAMPLER_DECL(sampler_name, nsamples)                         \
+            struct __sensor_samplerinfo_##sampler_name {                       \
+                am_sensor_sampler_t  sampler;                                  \
+                am_sensor_sample_t   buf[nsamples];                            \
+            } sampler_name;
+
+/**
+ * \brief ʵ̬
+ *
+ * \param[in] sampler_name : 
+ * \param[in] nsamples     : ɵĲ
+ */
+#define AM_SENSOR_SAMPLER_DECL_STATIC(sampler_name, nsamples)                  \
+            static AM_SENSOR_SAMPLER_DECL(sampler_name, nsamples)
+
+/**
+ * \brief ʼ AM_SENSOR_SAMPLER_DECL() Ĳ
+ *
+ * \param[in] sampler_name : 
+ *
+ * \retval AM_OK      : ʼɹ
+ * \retval -AM_EINVAL : Ч
+ * \retval -AM_EPERM  : ʱģδʼ
+ */
+#define AM_SENSOR_SAMPLER_INIT(sampler_name)                                   \
+            am_sensor_sampler_init(&(sampler_name.sampler),                    \
+                                     sampler_name.buf,                         \
+                                     AM_NELEMENTS(sampler_name.buf))
+
+/** @}  am_if_sensor_sampler */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __AM_SENSOR_SAMPLER_H */
+
+/* end of file */
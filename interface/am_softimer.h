@@ -40,12 +40,53 @@ extern "C" {
  * @{
  */
 
+/**
+ * \name ʱʵַʽãʱѡ
+ *
+ * Ĭʹòʵ֣ʱʱʱ붨ʱȡ
+ * ʱ϶࣬ڱѡж AM_SOFTIMER_WHEEL_EN Ϊ 1ʹ÷ֲ
+ * ʱʵֹ֣ͣʱĺʱΪ O(1)жʱн硣
+ * @{
+ */
+
+/** \brief Ϊ1ʱʹ÷ֲʱʵ֣Ϊ0ʱʹòʵ */
+#ifndef AM_SOFTIMER_WHEEL_EN
+#define AM_SOFTIMER_WHEEL_EN          0
+#endif
+
+/** \brief ʱֵ0λ0㹲 (1 << AM_SOFTIMER_WHEEL_L0_BITS)  */
+#ifndef AM_SOFTIMER_WHEEL_L0_BITS
+#define AM_SOFTIMER_WHEEL_L0_BITS     6
+#endif
+
+/** \brief ʱλÿ㹲 (1 << AM_SOFTIMER_WHEEL_LN_BITS)  */
+#ifndef AM_SOFTIMER_WHEEL_LN_BITS
+#define AM_SOFTIMER_WHEEL_LN_BITS     4
+#endif
+
+/**
+ * \brief ʱֲ0㣩
+ *
+ * ֱӶλʱ tick Ϊ
+ * 1 << (L0_BITS + (LEVELS - 1) * LN_BITS)ĬΪ 262144÷ΧĶʱ
+ * ȷ߲㣬ڲǨʱ¶λʱȻ׼ȷ
+ */
+#ifndef AM_SOFTIMER_WHEEL_LEVELS
+#define AM_SOFTIMER_WHEEL_LEVELS      4
+#endif
+
+/** @} */
+
 /**
  * \brief ʱṹ壬˱ҪϢ
  */
 struct am_softimer {
     struct am_list_head node;          /**< \brief γṹ           */
-    unsigned int        ticks;         /**< \brief ʣʱtickֵ             */
+
+    /**
+     * \brief ʣʱtickֵʵ֣ڵľtickֵʱʵ֣
+     */
+    unsigned int        ticks;
     unsigned int        repeat_ticks;  /**< \brief ظʱtick     */
     void (*timeout_callback)( void *); /**< \brief ʱʱ䵽ص         */
     void               *p_arg;         /**< \brief صĲ             */
@@ -68,6 +109,38 @@ int am_softimer_module_init (unsigned int clkrate);
  */
 void am_softimer_module_tick (void);
     
+/**
+ * \brief ޶ʱʱ am_softimer_module_next_ticks() ķֵ
+ */
+#define AM_SOFTIMER_TICKS_NONE   ((unsigned int)-1)
+
+/**
+ * \brief ȡһʱڻ am_softimer_module_tick() Ĵ
+ *
+ * ޵δtickless͹ƣʱɸݸֵһӲʱ
+ *  LPTMRWKTMRTĻʱ䣬Ѻ am_softimer_module_tick_n()
+ * ˯ڼ tick 谴̶Ƶʻѡ
+ *
+ * ʹʱʵֵ֣ʵʵĵʱ䣨ʱֲǨʱ̣
+ * ʵʵĵʱ䡣
+ *
+ * \return һεڵ tick СֵΪ1޶ʱʱ
+ *         AM_SOFTIMER_TICKS_NONE
+ */
+unsigned int am_softimer_module_next_ticks (void);
+
+/**
+ * \brief ʱЧͬ n  am_softimer_module_tick()
+ *
+ * ڼûжʱڵ tick ᱻֱʱ n ޹أֻڼ䵽ڵ
+ * ʱйءʱĵ˳ʱ tick ʱȫһ¡
+ *
+ * \param[in] n : Ҫ tick 
+ *
+ * \return 
+ */
+void am_softimer_module_tick_n (unsigned int n);
+
 /**
  * \brief ʼһʱ
  *
@@ -491,6 +491,43 @@ int am_spi_write_then_write (am_spi_device_t *p_dev,
                              const uint8_t   *p_txbuf1,
                              size_t           n_tx1);
 
+/**
+ * \brief ѯֵͨúԭֵns
+ *
+ * ֧ѯͨ SPI ṩ am_zlg_spi_dma_poll_ns_set()
+ */
+typedef uint32_t (*am_spi_poll_ns_set_t) (am_spi_handle_t handle,
+                                          uint32_t        poll_ns);
+
+/**
+ * \brief ʵϢԴΪѯֵͨ
+ *
+ * ȹرѯͨظִͬһ ms 룬ѯʽִͬ
+ * Ĵߺʱ֮ԴÿϢжϺͻѿʱʹ
+ * ϵͳĲӽıؿʼʱԼΪһĳԴ
+ * ms ӦΪڵٱ
+ *
+ * \param[in]  p_dev           : ʹõ SPI ӻ豸Ӧѡ޸
+ *                               豸
+ * \param[in]  pfn_poll_ns_set : ѯֵú
+ * \param[in]  p_txbuf         : ͻΪ NULL ʱ 0
+ * \param[out] p_rxbuf         : ջΪ NULL
+ * \param[in]  nbytes          : ÿδֵֽΪһμĴʵĳ
+ * \param[in]  ms              : ÿַʽ̲ʱ䣨ms
+ *
+ * \retval >=0         : ʵnsΪѯֵ
+ * \retval -AM_EINVAL  : 
+ * \retval         : ֲֵ
+ *
+ * \note ڼ䲻Ӧʹø SPI 
+ */
+int am_spi_poll_calibrate (am_spi_device_t      *p_dev,
+                           am_spi_poll_ns_set_t  pfn_poll_ns_set,
+                           const void           *p_txbuf,
+                           void                 *p_rxbuf,
+                           uint32_t              nbytes,
+                           uint32_t              ms);
+
 /** 
  * @} 
  */
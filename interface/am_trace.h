@@ -0,0 +1,199 @@
+/*******************************************************************************
+*                                 AMetal
+*                       ----------------------------
+*                       innovating embedded platform
+*
+* Copyright (c) 2001-2018 Guangzhou ZHIYUAN Electronics Co., Ltd.
+* All rights reserved.
+*
+* Contact information:
+* web site:    http://www.zlg.cn/
+*******************************************************************************/
+
+/**
+ * \file
+ * \brief Ƹ־ӳٸʽ
+ *
+ *     am_kprintf() ڵôʽַԲѯʽֽڷͣÿֽ
+ * Ҫȴڷɣжϻ״̬дӡʹϵͳͣ롣־
+ * ڵôֻ¼ʽַĵַΪʽIDԭʼ32λд RAM е
+ * λжϷʽں̨Щ¼ϵĽ빤߸ ELF ļ
+ * еĸʽַԭı tools/am_trace_decode/am_trace_decode.py
+ *
+ *     λжͬʱд룺дں̵ܶٽԤռ䣬ٽ
+ * д¼ݣд¼ͷΪύ־Ͷֻύļ¼
+ * ʱµļ¼֮һɹдļ¼֮ǰһʧ¼
+ *
+ * ͵ڵ֡ʽ£ֽݾΪСˣ
+ *
+ *     0xA5 | info (1) | fmt (4) | [timestamp (4)] | arg (4) ... | sum (1)
+ *
+ * - info  bit0 ~ bit3 Ϊbit4 Ϊ 1 ʾʱ
+ * - fmt ΪʽַĵַΪ 0 ʱʾʧ¼ΨһĲΪʧļ¼
+ * - sum Ϊ֮ǰֽ֮͵ĵ8λ
+ *
+ * ʹñҪͷļ:
+ * \code
+ * #include "am_trace.h"
+ * \endcode
+ *
+ * \par ʾ
+ * \code
+ *  #include "ametal.h"
+ *  #include "am_trace.h"
+ *
+ *  static uint32_t __g_trace_buf[256];
+ *
+ *  am_trace_init(uart_handle, __g_trace_buf, 256, NULL);
+ *
+ *  AM_TRACE2("adc ch%d = %d\n", ch, val);
+ * \endcode
+ *
+ * \note ʽַַ32λ¼%s ӦĲֻ
+ *       ַ֧64λ͸
+ * \note ־ʹõĴڲ am_kprintf() 
+ *
+ * \internal
+ * \par modification history:
+ * - 1.00 26-10-18  agent, first implementation
+ * \endinternal
+ */
+
+#ifndef __AM_TRACE_H
+#define __AM_TRACE_H
+
+#include "ametal.h"
+#include "am_uart.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \addtogroup am_if_trace
+ * \copydoc am_trace.h
+ * @{
+ */
+
+/**
+ * \brief һ¼Ĳʱѡ񣩣ܴ 15
+ *
+ * AM_TRACE0() ~ AM_TRACE6() ʹ6Ĳֱӵ am_trace_write()
+ */
+#ifndef AM_TRACE_ARGS_MAX
+#define AM_TRACE_ARGS_MAX     6
+#endif
+
+/**
+ * \brief Ƿдͼ¼ڣλmsʱѡ
+ *
+ * ڿʱ¼ȴʱʼ͡ʱнУд¼
+ * ʱʴڡ
+ */
+#ifndef AM_TRACE_KICK_MS
+#define AM_TRACE_KICK_MS      2
+#endif
+
+/**
+ * \name ¼־
+ *
+ * ͬļ¼ֱʹöӦĺ꣬תΪ uint32_t
+ * @{
+ */
+
+#define AM_TRACE0(fmt) \
+    (void)am_trace_write((fmt), NULL, 0)
+
+#define AM_TRACE1(fmt, a0) \
+    do { \
+        uint32_t __args[1] = {(uint32_t)(a0)}; \
+        (void)am_trace_write((fmt), __args, 1); \
+    } while (0)
+
+#define AM_TRACE2(fmt, a0, a1) \
+    do { \
+        uint32_t __args[2] = {(uint32_t)(a0), (uint32_t)(a1)}; \
+        (void)am_trace_write((fmt), __args, 2); \
+    } while (0)
+
+#define AM_TRACE3(fmt, a0, a1, a2) \
+    do { \
+        uint32_t __args[3] = {(uint32_t)(a0), (uint32_t)(a1), (uint32_t)(a2)}; \
+        (void)am_trace_write((fmt), __args, 3); \
+    } while (0)
+
+#define AM_TRACE4(fmt, a0, a1, a2, a3) \
+    do { \
+        uint32_t __args[4] = {(uint32_t)(a0), (uint32_t)(a1), \
+                              (uint32_t)(a2), (uint32_t)(a3)}; \
+        (void)am_trace_write((fmt), __args, 4); \
+    } while (0)
+
+#define AM_TRACE5(fmt, a0, a1, a2, a3, a4) \
+    do { \
+        uint32_t __args[5] = {(uint32_t)(a0), (uint32_t)(a1), \
+                              (uint32_t)(a2), (uint32_t)(a3), \
+                              (uint32_t)(a4)}; \
+        (void)am_trace_write((fmt), __args, 5); \
+    } while (0)
+
+#define AM_TRACE6(fmt, a0, a1, a2, a3, a4, a5) \
+    do { \
+        uint32_t __args[6] = {(uint32_t)(a0), (uint32_t)(a1), \
+                              (uint32_t)(a2), (uint32_t)(a3), \
+                              (uint32_t)(a4), (uint32_t)(a5)}; \
+        (void)am_trace_write((fmt), __args, 6); \
+    } while (0)
+
+/** @} */
+
+/**
+ * \brief ʼ־
+ *
+ * Ϊжģʽͼ¼ʱ
+ *
+ * \param[in] handle        : ־Ĵ
+ * \param[in] p_buf         : λ
+ * \param[in] size          : λĴС32λ֣2ݣ
+ *                            С 16
+ * \param[in] pfn_timestamp : ȡʱĺд¼ʱãΪ NULL ʱ
+ *                            ¼ʱ
+ *
+ * \retval AM_OK      : ɹ
+ * \retval -AM_EINVAL : 
+ * \retval        : ڻʱʧ
+ *
+ * \note ʱжϣϵͳģȼܸڸôжϵȼ
+ */
+int am_trace_init (am_uart_handle_t   handle,
+                   uint32_t          *p_buf,
+                   uint32_t           size,
+                   uint32_t         (*pfn_timestamp) (void));
+
+/**
+ * \brief дһټ¼же
+ *
+ * һʹ AM_TRACE0() ~ AM_TRACE6() ֱ꣬ӵøú
+ *
+ * \param[in] p_fmt  : ʽַַ
+ * \param[in] p_args : 
+ * \param[in] nargs  : ܴ AM_TRACE_ARGS_MAX
+ *
+ * \retval AM_OK       : ɹ
+ * \retval -AM_EPERM   : ־δʼ
+ * \retval -AM_EINVAL  : 
+ * \retval -AM_ENOSPC  : ¼
+ */
+int am_trace_write (const char *p_fmt, const uint32_t *p_args, uint32_t nargs);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __AM_TRACE_H */
+
+/* end of file */
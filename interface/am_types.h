@@ -79,6 +79,28 @@ typedef	 long		off_t;
 #endif /* __CC_ARM */
 /** @} */
 
+/**
+ * \brief ڴϣ֤ǰڴʲ
+ *
+ * жCPU  DMA ֮ݵĳ
+ */
+#if   defined (__CC_ARM)
+#define am_barrier()      __dmb(0xF)
+
+#elif defined (__ICCARM__)
+#define am_barrier()      asm volatile ("dmb" : : : "memory")
+
+#elif defined (__GNUC__)
+#if defined (__arm__) || defined (__thumb__)
+#define am_barrier()      __asm__ volatile ("dmb" : : : "memory")
+#else
+#define am_barrier()      __sync_synchronize()
+#endif
+
+#else
+#define am_barrier()
+#endif
+
 /** \todo  ݱѡ static ؼ */
 #define am_local    static
 
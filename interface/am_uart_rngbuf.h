@@ -70,8 +70,46 @@ extern "C" {
  */
 #define AM_UART_RNGBUF_RX_FLOW_ON_THR     0x0800
 
+/**
+ * \brief ȡ DMA ģʽ򻺳ֽΪuint32_tָ
+ */
+#define AM_UART_RNGBUF_RX_OVERRUN         0x0900
+
 /** @} */
 
+/**
+ * \brief DMA ֪ͨͣ DMA ƻ߿ʱ
+ *
+ * \param[in] p_arg :  DMA ʱĲ
+ * \param[in] pos   : DMA һдλã0 ~ size - 1DMA ƣɣʱ
+ *                    Ϊ size
+ */
+typedef void (*am_uart_rngbuf_dma_rx_notify_t) (void *p_arg, uint32_t pos);
+
+/**
+ * \brief DMA ɾĴṩ
+ *
+ *     DMA 蹤ѭģʽֱӽдջλĴ洢ռ䡣
+ * Ӧ DMA ƣɣ߿Уճʱʱ֪ͨģ
+ * ݣֽڵ rxchar_put ص
+ */
+typedef struct am_uart_rngbuf_dma_rx_funcs {
+
+    /** \brief ѭʽ DMA  */
+    int (*pfn_rx_start) (void                           *p_drv,
+                         uint8_t                        *p_buf,
+                         uint32_t                        size,
+                         am_uart_rngbuf_dma_rx_notify_t  pfn_notify,
+                         void                           *p_arg);
+
+    /** \brief ȡ DMA һдλã0 ~ size - 1 */
+    uint32_t (*pfn_rx_pos_get) (void *p_drv);
+
+    /** \brief ֹͣ DMA  */
+    int (*pfn_rx_stop) (void *p_drv);
+
+} am_uart_rngbuf_dma_rx_funcs_t;
+
 /**
  * \brief UARTring bufferжģʽ豸ṹ
  */
@@ -80,11 +118,11 @@ typedef struct am_uart_rngbuf_dev {
     /** \brief UART׼    */
     am_uart_handle_t  handle;
 
-    /** \brief ݻλ      */
-    struct am_rngbuf  rx_rngbuf;
+    /** \brief ݻλжд룬ȡ  */
+    struct am_rngbuf_spsc  rx_rngbuf;
 
-    /** \brief ݻλ      */
-    struct am_rngbuf  tx_rngbuf;
+    /** \brief ݻλд룬ж϶ȡ  */
+    struct am_rngbuf_spsc  tx_rngbuf;
     
     /** \brief ֽڸֵʱ  */
     uint32_t          xon_threshold;
@@ -125,6 +163,21 @@ typedef struct am_uart_rngbuf_dev {
     /** \brief ͻص */
     void             *p_tx_arg;
 
+    /** \brief DMA Ϊ NULL ʱʹֽжϽ */
+    const am_uart_rngbuf_dma_rx_funcs_t *p_dma_rx_funcs;
+
+    /** \brief DMA Ĳ */
+    void             *p_dma_rx_drv;
+
+    /** \brief ѷ DMA дλ */
+    uint32_t          dma_rx_pos;
+
+    /** \brief ǰδյӦĻ֪ͨ */
+    am_bool_t         dma_rx_wrapped;
+
+    /** \brief 򻺳ֽ */
+    uint32_t          dma_rx_overrun;
+
 } am_uart_rngbuf_dev_t;
 
 /** \brief UARTring bufferжģʽ׼Ͷ */
@@ -137,9 +190,11 @@ typedef struct am_uart_rngbuf_dev * am_uart_rngbuf_handle_t;
  * \param[in] p_dev      : UARTring bufferжģʽ豸ṹָ
  * \param[in] handle     : UART׼
  * \param[in] p_rxbuf    : ָջָ룬ʵֽջλ
- * \param[in] rxbuf_size : ջĴСС2^n
+ * \param[in] rxbuf_size : ջĴСС2^nֻʹòڸֵ
+ *                          2^n ֽڣ
  * \param[in] p_txbuf    : ָͻָ룬ʵַͻλ
- * \param[in] txbuf_size : ͻĴСС2^n
+ * \param[in] txbuf_size : ͻĴСС2^nֻʹòڸֵ
+ *                          2^n ֽڣ
  *
  * \return UARTring bufferжģʽ׼ֵΪNULL
  *         ʼʧ
@@ -175,6 +230,8 @@ am_uart_rngbuf_handle_t am_uart_rngbuf_init(am_uart_rngbuf_dev_t *p_dev,
  *                                               - AM_RNGBUF_UART_FLOWCTL_SW
  *            - AM_UART_RNGBUF_RX_FLOW_OFF_THR صֵֽ
  *            - AM_UART_RNGBUF_RX_FLOW_ON_THR  ֵֽ
+ *            - AM_UART_RNGBUF_RX_OVERRUN      DMA ֽΪ
+ *                                               uint32_tָ
  *
  * \param[in,out] p_arg : ָӦĲ
  *
@@ -294,6 +351,39 @@ int am_uart_rngbuf_tx_trigger_enable (am_uart_rngbuf_handle_t  handle);
  */
 int am_uart_rngbuf_tx_trigger_disable (am_uart_rngbuf_handle_t  handle);
 
+/**
+ * \brief ʹ DMA ģʽ
+ *
+ *     ʹܺջλĴ洢ռֱΪ DMA ѭյĿ꣬ DMA
+ * ƻ߿ʱ֪ͨģ飬ݰֽжϵĿ
+ * ڸ߲ʵĳϡ
+ *
+ * \param[in] handle  : UARTring bufferжģʽ׼
+ * \param[in] p_funcs : DMA ɾĴṩ
+ * \param[in] p_drv   : DMA Ĳ
+ *
+ * \retval AM_OK      : ʹܳɹ
+ * \retval -AM_EINVAL : 
+ * \retval        :  DMA ʧ
+ *
+ * \note DMA ֱд洢ռ䣬Ӧöȡʱδݻᱻǡʱģ
+ *       ݣֽͨ AM_UART_RNGBUF_RX_OVERRUN ȡ
+ *       ԰/ֵӲʹá
+ */
+int am_uart_rngbuf_dma_rx_enable (am_uart_rngbuf_handle_t              handle,
+                                  const am_uart_rngbuf_dma_rx_funcs_t *p_funcs,
+                                  void                                *p_drv);
+
+/**
+ * \brief  DMA ģʽָΪֽжϽ
+ *
+ * \param[in] handle : UARTring bufferжģʽ׼
+ *
+ * \retval AM_OK      : ܳɹ
+ * \retval -AM_EINVAL : 
+ */
+int am_uart_rngbuf_dma_rx_disable (am_uart_rngbuf_handle_t  handle);
+
 /**
  * @}
  */
@@ -18,6 +18,10 @@
  * Ҫȴĵط:am_wait_on(&wait);
  * Ҫ֮ǰȴĵطãam_wait_done(&wait);
  *
+ * Ĭ£ȴڼ CPU һֱѯȴֵæȣʹ
+ * am_wait_backend_set() õȴˣʹȴڼִжӳٵЭҵ
+ * ʹ CPU ˯ߣWFI/WFEֱжϷټȴֵ
+ *
  *
  * \internal
  * \par Modification History
@@ -58,6 +62,33 @@ typedef struct am_wait {
     uint8_t           stat;
 
 } am_wait_t;
+
+/**
+ * \brief ȴ
+ *
+ *     ȴδʱȵ pfn_poll Эҵȴδ㣬
+ * жϵ pfn_sleep ʹ CPU ˯ߡam_wait_done() ȴʱʱ
+ * pfn_wakeڻѻڲϵͳͬʵֵ˯ߡ
+ */
+typedef struct am_wait_backend {
+
+    /** \brief Эж״̬µãΪ NULL */
+    int  (*pfn_poll) (void *p_arg);
+
+    /**
+     * \brief ˯ߺж״̬µãΪ NULL
+     *
+     * жڼжϹʱ뷵أѣ WFI ָ
+     */
+    void (*pfn_sleep) (void *p_arg);
+
+    /** \brief ѺжеãΪ NULL */
+    void (*pfn_wake) (void *p_arg);
+
+    /** \brief ˺Ĳ */
+    void  *p_arg;
+
+} am_wait_backend_t;
     
  
 /** 
@@ -110,7 +141,59 @@ int am_wait_on_timeout(am_wait_t *p_wait, uint32_t timeout_ms);
  * \retval -AM_EINVAL ȴʧܣ
  */
 int am_wait_done(am_wait_t *p_wait);
- 
+
+/**
+ * \brief õȴˣеȴźЧ
+ *
+ * \param[in] p_backend : ָȴ˵ָ룬Ϊ NULL ʱָΪæ
+ *
+ * \return 
+ *
+ * \note ˽ṹʹڼ뱣ЧͨΪ const ȫֱ磬
+ *       ȴڼ䴦жӳҵҵʱʹ CPU ˯ߣ
+ * \code
+ * static const am_wait_backend_t __g_wait_backend = {
+ *     am_isr_defer_wait_poll,
+ *     am_wait_sleep_wfi,
+ *     NULL,
+ *     NULL
+ * };
+ *
+ * am_wait_backend_set(&__g_wait_backend);
+ * \endcode
+ */
+void am_wait_backend_set (const am_wait_backend_t *p_backend);
+
+/**
+ * \brief ȴ˵Эҵеҵ
+ *
+ * \param[in] p_arg : ҵоam_jobq_handle_t
+ *
+ * \return am_jobq_process() ķֵҵڴʱ -AM_EBUSY
+ */
+int am_wait_poll_jobq (void *p_arg);
+
+/**
+ * \brief ȴ˵˯ߺִ WFI ָжϹʱ
+ *
+ * \param[in] p_arg : δʹ
+ *
+ * \return 
+ */
+void am_wait_sleep_wfi (void *p_arg);
+
+/**
+ * \brief ȴ˵˯ߺִ WFE ָ¼ʱ
+ *
+ * \param[in] p_arg : δʹ
+ *
+ * \return 
+ *
+ * \attention ˯ʱжϴڹر״̬λ SCB->SCR  SEVONPEND λʹж
+ *            ʱ¼
+ */
+void am_wait_sleep_wfe (void *p_arg);
+
 
 /** 
  * @} 
@@ -39,6 +39,19 @@ extern "C" {
  * @{
  */
 
+/**
+ * \brief ѯͨĬֵλnsʱѡ
+ *
+ * ʱϴʱ䣨ӻֵַϢʹжϣ
+ *  am_i2c_msg_start() ѯʽͬɣڷǰϢ
+ * صֵӦжϷʽһϢжϺͻѿڳʼ
+ * ʹ am_i2c_poll_calibrate() ʵ⡣Ϊ 0 ʱرѯͨ
+ *
+ * Ĭֵ 400kHz ¿ɸǴӻַһֽڵļĴд
+ */
+#ifndef AM_LPC_I2C_POLL_NS
+#define AM_LPC_I2C_POLL_NS        50000
+#endif
 
 /**
  * \brief I2C controller configure parameter 
@@ -98,6 +111,9 @@ typedef struct am_lpc_i2c_dev {
 
     /** \brief ״̬                   */
     uint8_t                   state;
+
+    /** \brief ѯֵϴʱ䲻ֵnsϢѯʽ */
+    uint32_t                  poll_ns;
     
     /** \brief I2C controller configure parameter */
     const am_lpc_i2c_devinfo_t *p_devinfo;
@@ -127,6 +143,19 @@ am_i2c_handle_t am_lpc_i2c_init(am_lpc_i2c_dev_t           *p_dev,
  */
 void am_lpc_i2c_deinit (am_i2c_handle_t handle);
 
+/**
+ * \brief ѯֵͨ
+ *
+ * \param[in] handle  : I2C׼
+ * \param[in] poll_ns : ֵnsϴʱ䲻ֵϢѯʽ
+ *                      ͬɣΪ 0 ʱرѯͨ
+ *
+ * \return ԭֵns
+ *
+ * \note úΪ am_i2c_poll_calibrate() ֵú
+ */
+uint32_t am_lpc_i2c_poll_ns_set (am_i2c_handle_t handle, uint32_t poll_ns);
+
 
 
 /** @} */
@@ -40,6 +40,17 @@ extern "C" {
  * @{
  */
 
+/**
+ * \brief DMA ʱѡ
+ *
+ * һϢġִСͬĴ佨ΪһӺõ DMA 
+ * ÿ 1024 ݡDMA װеֻһ
+ * жϣֻһжϡֵʱΪ
+ */
+#ifndef AM_LPC84X_SPI_DMA_LINK_MAX
+#define AM_LPC84X_SPI_DMA_LINK_MAX        4
+#endif
+
 /**
  * \brief SPI 豸Ϣṹ
  */
@@ -82,19 +93,21 @@ typedef struct am_lpc84x_spi_dma_dev {
     uint32_t                   state;           /**< \brief SPI״̬״̬ */
 
     uint16_t                   rx_trash;        /**< \brief ݵʱձ */
-    uint32_t                   p_tx_buf_eot;    /**< \brief һ֡еһ */
+    uint32_t                   p_tx_buf_eot;    /**< \brief Ľ */
 
-    /** \brief SPIѡDMAģʽ,ʵʴݸ */
-    uint32_t                   dma_trans_num;
+    /** \brief ǰѽݸ */
+    uint32_t                   trans_pos;
 
-    /** \brief SPIѡDMAڵַƫ */
-    uint32_t                   dma_trans_count;
+    /** \brief ǰɵĴֽ */
+    uint32_t                   chain_nbytes;
 
-    /** \brief SPIѡDMAģʽ־(ڱ־δǷ1024) */
-    uint32_t                   dma_trans_flg;
+    /** \brief ͨһڽ */
+    __attribute__((aligned(16)))
+    am_lpc84x_dma_xfer_desc_t   tx_desc[AM_LPC84X_SPI_DMA_LINK_MAX + 1];
 
+    /** \brief ͨ */
     __attribute__((aligned(16)))
-    am_lpc84x_dma_xfer_desc_t   g_desc[3];  /**< \brief DMAͨ */
+    am_lpc84x_dma_xfer_desc_t   rx_desc[AM_LPC84X_SPI_DMA_LINK_MAX];
 
     am_lpc84x_dma_controller_t *p_ctr_tx;   /**< \brief DMAͨ */
     am_lpc84x_dma_controller_t *p_ctr_rx;   /**< \brief DMAͨ */
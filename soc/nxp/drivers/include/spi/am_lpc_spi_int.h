@@ -39,6 +39,18 @@ extern "C" {
  * @{
  */
  
+/**
+ * \brief ѯͨĬֵλnsʱѡ
+ *
+ * ʱϴʱ䲻ֵϢʹжϣ
+ * am_spi_msg_start() ѯʽͬɣڷǰϢɻص
+ * ֵӦжϷʽһϢжϺͻѿڳʼʹ
+ * am_spi_poll_calibrate() ʵ⡣Ϊ 0 ʱرѯͨ
+ */
+#ifndef AM_LPC_SPI_INT_POLL_NS
+#define AM_LPC_SPI_INT_POLL_NS    10000
+#endif
+
 /**
  * \brief SPI 豸Ϣṹ
  */
@@ -80,6 +92,9 @@ typedef struct am_lpc_spi_int_dev {
     am_bool_t                  busy;            /**< \brief SPIæʶ.        */
     uint32_t                   state;           /**< \brief SPI״̬״̬. */
 
+    /** \brief ѯֵϴʱ䲻ֵnsϢѯʽ */
+    uint32_t                   poll_ns;
+
 } am_lpc_spi_int_dev_t;
 
 /**
@@ -100,6 +115,19 @@ am_spi_handle_t am_lpc_spi_int_init (am_lpc_spi_int_dev_t           *p_dev,
  */
 void am_lpc_spi_int_deinit (am_spi_handle_t handle);
 
+/**
+ * \brief ѯֵͨ
+ *
+ * \param[in] handle  : SPI׼
+ * \param[in] poll_ns : ֵnsϴʱ䲻ֵϢѯʽ
+ *                      ͬɣΪ 0 ʱرѯͨ
+ *
+ * \return ԭֵns
+ *
+ * \note úΪ am_spi_poll_calibrate() ֵú
+ */
+uint32_t am_lpc_spi_int_poll_ns_set (am_spi_handle_t handle, uint32_t poll_ns);
+
 
 
 
@@ -354,13 +354,210 @@ static void __i2c_irq_handler (void *p_arg)
 
 /******************************************************************************/
 
+/**
+ * \brief жϢǷѯͨ
+ *
+ * дϴʱ䣨ÿ䰴һַֽڼ㣩֮Ͳѯֵ
+ * ʱ AM_TRUE10 λַϢԽ״̬
+ */
+static am_bool_t __i2c_msg_poll_check (am_lpc_i2c_dev_t *p_dev,
+                                       am_i2c_message_t *p_msg)
+{
+    am_i2c_transfer_t *p_trans;
+    uint32_t           byte_ns;
+    uint32_t           wire_ns = 0;
+    uint32_t           i;
+
+    if ((p_dev->poll_ns == 0) || (p_dev->p_devinfo->bus_speed == 0)) {
+        return AM_FALSE;
+    }
+
+    byte_ns = (1000000000u / p_dev->p_devinfo->bus_speed) * 9;
+
+    for (i = 0; i < p_msg->trans_num; i++) {
+        p_trans = &(p_msg->p_transfers[i]);
+
+        if (p_trans->flags & AM_I2C_ADDR_10BIT) {
+            return AM_FALSE;
+        }
+
+        if (p_trans->nbytes >= (p_dev->poll_ns - wire_ns) / byte_ns) {
+            return AM_FALSE;
+        }
+        wire_ns += (p_trans->nbytes + 1) * byte_ns;
+    }
+
+    return AM_TRUE;
+}
+
+/**
+ * \brief ѯȴ𣬷״̬
+ *
+ * \retval >=0     : ״̬AMHW_LPC_I2C_STAT_MSTRX ȣ
+ * \retval -AM_EIO : ٲöʧ/ֹͣʱ
+ */
+static int __i2c_poll_wait (am_lpc_i2c_dev_t *p_dev)
+{
+    amhw_lpc_i2c_t *p_hw_i2c = (amhw_lpc_i2c_t *)p_dev->p_devinfo->i2c_regbase;
+    uint32_t        stat;
+
+    while (1) {
+        stat = amhw_lpc_i2c_stat_get(p_hw_i2c);
+
+        if (stat & (AMHW_LPC_I2C_STAT_EVTIMEOUT  |
+                    AMHW_LPC_I2C_STAT_SCLTIMEOUT |
+                    AMHW_LPC_I2C_STAT_MSTARBLOSS |
+                    AMHW_LPC_I2C_STAT_MSTSSERR)) {
+
+            amhw_lpc_i2c_stat_clr(p_hw_i2c,
+                                  AMHW_LPC_I2C_STAT_EVTIMEOUT  |
+                                  AMHW_LPC_I2C_STAT_SCLTIMEOUT |
+                                  AMHW_LPC_I2C_STAT_MSTARBLOSS |
+                                  AMHW_LPC_I2C_STAT_MSTSSERR);
+
+            /* ʹܣλʱڲ߼ */
+            if (stat & (AMHW_LPC_I2C_STAT_EVTIMEOUT |
+                        AMHW_LPC_I2C_STAT_SCLTIMEOUT)) {
+                amhw_lpc_i2c_mode_disable(p_hw_i2c, AM_I2C_TIMEOUT_MODE);
+                amhw_lpc_i2c_mode_enable(p_hw_i2c, AM_I2C_TIMEOUT_MODE);
+            }
+            amhw_lpc_i2c_mode_disable(p_hw_i2c, AM_I2C_MASTER_MODE);
+            amhw_lpc_i2c_mode_enable(p_hw_i2c, AM_I2C_MASTER_MODE);
+
+            return -AM_EIO;
+        }
+
+        if (stat & AMHW_LPC_I2C_STAT_MSTPEND) {
+            return (int)(stat & AMHW_LPC_I2C_MASTER_STATE_MASK);
+        }
+    }
+}
+
+/**
+ * \brief ѯȴһַֽɣӦĴ״̬һ
+ */
+static int __i2c_poll_ack (am_lpc_i2c_dev_t *p_dev, am_i2c_transfer_t *p_trans)
+{
+    int ret = __i2c_poll_wait(p_dev);
+
+    if ((ret == AMHW_LPC_I2C_STAT_MSTNACKADDR) ||
+        (ret == AMHW_LPC_I2C_STAT_MSTNACKTX)) {
+
+        if (p_trans->flags & AM_I2C_M_IGNORE_NAK) {
+            return AM_OK;
+        }
+
+        if ((p_trans->flags & AM_I2C_M_RD) ||
+            (ret == AMHW_LPC_I2C_STAT_MSTNACKADDR)) {
+            return -AM_ENODEV;
+        }
+        return -AM_ENOENT;
+    }
+
+    return (ret < 0) ? ret : AM_OK;
+}
+
+/**
+ * \brief ѯʽͬһϢ
+ *
+ * źšAM_I2C_M_NOSTARTӦԼ״̬Ĵ״̬һ£ǰ
+ * ϢɻصǰѱϢռbusy λѯ
+ * ڼرճʱжϣʱѯ⣬жϽ״̬
+ */
+static void __i2c_msg_poll (am_lpc_i2c_dev_t *p_dev, am_i2c_message_t *p_msg)
+{
+    amhw_lpc_i2c_t    *p_hw_i2c = (amhw_lpc_i2c_t *)p_dev->p_devinfo->i2c_regbase;
+    am_i2c_transfer_t *p_trans;
+    am_bool_t          is_read;
+    am_bool_t          no_start;
+    uint32_t           i;
+    int                ret      = AM_OK;
+
+    p_dev->p_cur_msg = p_msg;
+    p_msg->status    = -AM_EINPROGRESS;
+    p_msg->done_num  = 0;
+
+    amhw_lpc_i2c_int_disable(p_hw_i2c, AMHW_LPC_I2C_INTENSET_EVTIMEOUT |
+                                       AMHW_LPC_I2C_INTENSET_SCLTIMEOUT);
+
+    for (p_trans = p_msg->p_transfers;
+         p_trans < p_msg->p_transfers + p_msg->trans_num;
+         p_trans++) {
+
+        p_dev->p_cur_trans = p_trans;
+
+        is_read  = (p_trans->flags & AM_I2C_M_RD) ? AM_TRUE : AM_FALSE;
+        no_start = ((p_trans->flags & AM_I2C_M_NOSTART) &&
+                    (p_trans != p_msg->p_transfers) &&
+                    ((p_trans->flags & AM_I2C_M_RD) ==
+                     ((p_trans - 1)->flags & AM_I2C_M_RD))) ? AM_TRUE : AM_FALSE;
+
+        /* ź + ӻַĵһַֽһ */
+        if (!no_start) {
+            amhw_lpc_i2c_mstdat_write(p_hw_i2c,
+                                      (uint8_t)((p_trans->addr << 1) |
+                                                (is_read ? 0x1 : 0x0)));
+            amhw_lpc_i2c_mst_start(p_hw_i2c);
+
+            ret = __i2c_poll_ack(p_dev, p_trans);
+            if (ret != AM_OK) {
+                break;
+            }
+        }
+
+        for (i = 0; i < p_trans->nbytes; i++) {
+            if (is_read) {
+                if ((i > 0) || no_start) {
+                    amhw_lpc_i2c_mst_continue(p_hw_i2c);
+
+                    ret = __i2c_poll_ack(p_dev, p_trans);
+                    if (ret != AM_OK) {
+                        break;
+                    }
+                }
+                p_trans->p_buf[i] = amhw_lpc_i2c_mstdat_read(p_hw_i2c);
+            } else {
+                amhw_lpc_i2c_mstdat_write(p_hw_i2c, p_trans->p_buf[i]);
+                amhw_lpc_i2c_mst_continue(p_hw_i2c);
+
+                ret = __i2c_poll_ack(p_dev, p_trans);
+                if (ret != AM_OK) {
+                    break;
+                }
+            }
+        }
+
+        if (ret != AM_OK) {
+            break;
+        }
+
+        p_msg->done_num++;
+    }
+
+    p_msg->status = ret;
+
+    if (p_dev->p_devinfo->timeout_ms != 0) {
+        amhw_lpc_i2c_int_enable(p_hw_i2c, AMHW_LPC_I2C_INTENSET_EVTIMEOUT |
+                                          AMHW_LPC_I2C_INTENSET_SCLTIMEOUT);
+    }
+
+    /* صϢɺ  */
+    if (p_msg->pfn_complete != NULL) {
+        p_msg->pfn_complete(p_msg->p_arg);
+    }
+
+    /* ֹͣ */
+    amhw_lpc_i2c_mst_stop(p_hw_i2c);
+}
+
 static int __i2c_msg_start (void *p_drv, am_i2c_message_t *p_msg)
 {
     am_lpc_i2c_dev_t *p_dev    = (am_lpc_i2c_dev_t *)p_drv;
 
-    amhw_lpc_i2c_t   *p_hw_i2c = (amhw_lpc_i2c_t *)p_dev->p_devinfo->i2c_regbase;
+    amhw_lpc_i2c_t   *p_hw_i2c = NULL;
 
-    int key;
+    am_bool_t is_poll;
+    int       key;
 
     if ( (p_dev              == NULL) ||
          (p_msg              == NULL) ||
@@ -370,6 +567,10 @@ static int __i2c_msg_start (void *p_drv, am_i2c_message_t *p_msg)
         return -AM_EINVAL;
     }
 
+    p_hw_i2c = (amhw_lpc_i2c_t *)p_dev->p_devinfo->i2c_regbase;
+
+    is_poll = __i2c_msg_poll_check(p_dev, p_msg);
+
     key = am_int_cpu_lock();
 
     /* ǰڴϢֻҪµϢ */
@@ -381,6 +582,35 @@ static int __i2c_msg_start (void *p_drv, am_i2c_message_t *p_msg)
 
         return AM_OK;
 
+    } else if (is_poll) {
+
+        /*
+         * ҶΪգϢֱѯʽɡڼжύ
+         * ϢڱϢ֮ɺٴж״̬
+         */
+        p_dev->busy = AM_TRUE;
+
+        am_int_cpu_unlock(key);
+
+        __i2c_msg_poll(p_dev, p_msg);
+
+        key = am_int_cpu_lock();
+        if (am_list_empty(&(p_dev->msg_list))) {
+            p_dev->p_cur_msg = NULL;
+            p_dev->busy      = AM_FALSE;
+            am_int_cpu_unlock(key);
+            return AM_OK;
+        }
+        am_int_cpu_unlock(key);
+
+        /* 򿪹ٲöʧ/ֹͣж */
+        amhw_lpc_i2c_int_enable(p_hw_i2c,
+                                   AMHW_LPC_I2C_INTENSET_MSTPEND    |
+                                   AMHW_LPC_I2C_INTENSET_MSTARBLOSS |
+                                   AMHW_LPC_I2C_INTENSET_MSTSSERR);
+
+        return AM_OK;
+
     } else {
 
 
@@ -419,6 +649,7 @@ am_i2c_handle_t am_lpc_i2c_init (am_lpc_i2c_dev_t           *p_dev,
     p_dev->p_cur_trans = NULL;
     p_dev->p_cur_msg   = NULL;
     p_dev->data_ptr    = 0;
+    p_dev->poll_ns     = AM_LPC_I2C_POLL_NS;
     p_dev->state       = __I2C_ST_IDLE;                   /* ʼΪ״̬ */
 
     if (p_devinfo->pfn_plfm_init) {
@@ -465,6 +696,24 @@ void am_lpc_i2c_deinit (am_i2c_handle_t handle)
     }
 }
 
+/**
+ * \brief ѯֵͨ
+ */
+uint32_t am_lpc_i2c_poll_ns_set (am_i2c_handle_t handle, uint32_t poll_ns)
+{
+    am_lpc_i2c_dev_t *p_dev = (am_lpc_i2c_dev_t *)handle;
+    uint32_t          old;
+
+    if (NULL == p_dev) {
+        return 0;
+    }
+
+    old            = p_dev->poll_ns;
+    p_dev->poll_ns = poll_ns;
+
+    return old;
+}
+
 /******************************************************************************/
 
 /*  ״̬ڲ״̬л */
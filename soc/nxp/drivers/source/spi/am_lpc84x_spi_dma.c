@@ -80,7 +80,6 @@ am_local void __spi_cs_off (am_lpc84x_spi_dma_dev_t *p_this, am_spi_device_t *p_
 am_local int  __spi_hard_init (am_lpc84x_spi_dma_dev_t *p_this);
 am_local int  __spi_config (am_lpc84x_spi_dma_dev_t *p_this);
 
-am_local int  __spi_dma_trans (am_lpc84x_spi_dma_dev_t *p_dev);
 am_local void __spi_dma_isr (void *p_arg, int stat);
 
 am_local int  __spi_mst_sm_event (am_lpc84x_spi_dma_dev_t *p_dev, uint32_t event);
@@ -267,16 +266,23 @@ int __spi_info_get (void *p_arg, am_spi_info_t *p_info)
     return AM_OK;
 }
 
+/**
+ * \brief ݸ9~16λռ2ֽ
+ */
+am_static_inline
+uint32_t __spi_trans_nwords (am_spi_transfer_t *p_trans)
+{
+    return (p_trans->bits_per_word > 8) ? (p_trans->nbytes / 2) :
+                                           p_trans->nbytes;
+}
 
+/**
+ * \brief 鴫Ϊ0ִСʹ豸Ĭֵ
+ */
 am_local
-int __spi_config (am_lpc84x_spi_dma_dev_t *p_this)
+int __spi_trans_check (am_lpc84x_spi_dma_dev_t *p_this,
+                       am_spi_transfer_t       *p_trans)
 {
-    amhw_lpc_spi_t  *p_hw_spi  = (amhw_lpc_spi_t *)(p_this->p_devinfo->spi_regbase);
-    am_spi_transfer_t  *p_trans   = p_this->p_cur_trans;
-
-    uint32_t                       mode_flag = 0;
-    uint32_t                       div_val;
-
     /* Ϊ0ʹĬϲֵ */
     if (p_trans->bits_per_word == 0) {
         p_trans->bits_per_word = p_this->p_cur_spi_dev->bits_per_word;
@@ -307,6 +313,26 @@ int __spi_config (am_lpc84x_spi_dma_dev_t *p_this)
         return -AM_ELOW;
     }
 
+    /* 9~16λݣֽΪ2 */
+    if ((p_trans->bits_per_word > 8) && (p_trans->nbytes % 2 != 0)) {
+        return -AM_EINVAL;
+    }
+
+    return AM_OK;
+}
+
+/**
+ * \brief ǰ SPI __spi_trans_check() 
+ */
+am_local
+int __spi_config (am_lpc84x_spi_dma_dev_t *p_this)
+{
+    amhw_lpc_spi_t  *p_hw_spi  = (amhw_lpc_spi_t *)(p_this->p_devinfo->spi_regbase);
+    am_spi_transfer_t  *p_trans   = p_this->p_cur_trans;
+
+    uint32_t                       mode_flag = 0;
+    uint32_t                       div_val;
+
     /**
      * õǰ豸ģʽ
      */
@@ -341,6 +367,9 @@ int __spi_config (am_lpc84x_spi_dma_dev_t *p_this)
     /* õ֡λ */
     amhw_lpc_spi_data_flen_set(p_hw_spi, p_trans->bits_per_word);
 
+    /* һµĽ־ÿݺͷƬѡ */
+    amhw_lpc_spi_txctl_clear(p_hw_spi, AMHW_LPC_SPI_TXDATCTL_EOT);
+
     /* ÷ƵֵSPI */
     div_val = (am_clk_rate_get(p_this->p_devinfo->clk_id) / p_trans->speed_hz);
     amhw_lpc_spi_div_set(p_hw_spi, div_val);
@@ -360,45 +389,58 @@ int __spi_config (am_lpc84x_spi_dma_dev_t *p_this)
     return AM_OK;
 }
 
-
-
+/**
+ * \brief DMA ж
+ *
+ * ֻдһжAʱȫյ
+ */
 am_local
 void __spi_dma_isr (void *p_arg, int stat)
 {
     am_lpc84x_spi_dma_dev_t  *p_this   = (am_lpc84x_spi_dma_dev_t *)p_arg;
     amhw_lpc_spi_t           *p_hw_spi = (amhw_lpc_spi_t *)(p_this->p_devinfo->spi_regbase);
+    am_spi_message_t         *p_msg    = p_this->p_cur_msg;
+    am_spi_transfer_t        *p_trans  = p_this->p_cur_trans;
+
+    /* ֻͨܶ͡һ */
+    if ((p_msg == NULL) || (p_msg->status != -AM_EINPROGRESS)) {
+        return;
+    }
 
     /* жA */
     if (stat == AM_LPC84X_DMA_STAT_INTA) {
 
-        if (p_this->dma_trans_flg == 1) {
-            p_this->dma_trans_num -= 1024;
-            p_this->dma_trans_count++;
+        /* ȴSPIݳ׷ͽ */
+        while(!(amhw_lpc_spi_stat_get(p_hw_spi) & AMHW_LPC_SPI_STAT_IDLE));
 
-            /* Ŵ䵱ǰtrans */
-            __spi_mst_sm_event(p_this, __SPI_EVT_DMA_TRANS_DATA);
+        /* ¼ɹֽ */
+        p_msg->actual_length += p_this->chain_nbytes;
 
-        /* ǰѾС1024ȣһжϲʱǰTran϶ */
-        } else {
+        /* ҪıƬѡһʼǰѡͨ */
+        if ((p_this->trans_pos == __spi_trans_nwords(p_trans)) &&
+            p_trans->cs_change &&
+            !am_list_empty(&(p_msg->transfers))) {
+            __spi_cs_off(p_this, p_this->p_cur_spi_dev);
+        }
 
-            /* ¼ɹֽ */
-            if (p_this->p_cur_trans->p_txbuf != NULL) {
-                p_this->p_cur_msg->actual_length += (p_this->p_cur_trans->nbytes)
-                                *(p_this->p_cur_spi_dev->bits_per_word < 9 ? 1 : 2);
-            }
+        /* һ */
+        __spi_mst_sm_event(p_this, __SPI_EVT_TRANS_LAUNCH);
 
-            /* һtrans */
-            __spi_mst_sm_event(p_this, __SPI_EVT_TRANS_LAUNCH);
+    } else if (stat == AM_LPC84X_DMA_STAT_INTERR) {
 
-            /* ȴSPIݳ׷ͽ */
-             while(!(amhw_lpc_spi_stat_get(p_hw_spi) & AMHW_LPC_SPI_STAT_IDLE));
-        }
+        /* һͨɣֹͣϢ */
+        am_lpc84x_dma_controller_abort(p_this->p_ctr_tx);
+        am_lpc84x_dma_controller_abort(p_this->p_ctr_rx);
+
+        p_msg->status = -AM_EIO;
+        __spi_mst_sm_event(p_this, __SPI_EVT_TRANS_LAUNCH);
 
     } else {
         /* жԴƥ */
     }
 }
 
+
 /**
  * \brief һ message бĩβ
  * \attention ô˺
@@ -451,13 +493,9 @@ int __spi_msg_start (void              *p_drv,
                      am_spi_message_t  *p_msg)
 {
     am_lpc84x_spi_dma_dev_t *p_this   = (am_lpc84x_spi_dma_dev_t *)p_drv;
-    amhw_lpc_spi_t   *p_hw_spi = (amhw_lpc_spi_t *)(p_this->p_devinfo->spi_regbase);
 
     int key;
 
-    p_this->p_cur_spi_dev  = p_dev;                         /* ǰ豸Ϣ */
-    p_this->p_cur_msg      = p_msg;                         /* ǰ豸Ϣ */
-
     /* 豸ЧԼ */
     if ((p_drv              == NULL) ||
         (p_dev              == NULL) ||
@@ -465,8 +503,7 @@ int __spi_msg_start (void              *p_drv,
         return -AM_EINVAL;
     }
 
-    /* ɽλ */
-    amhw_lpc_spi_txctl_clear(p_hw_spi, AMHW_LPC_SPI_TXDATCTL_EOT);
+    p_msg->p_spi_dev = p_dev;                               /* 豸Ϣ뵽Ϣ */
 
     key = am_int_cpu_lock();
 
@@ -488,273 +525,276 @@ int __spi_msg_start (void              *p_drv,
 
 
 /**
- * \brief  SPI ʹDMA
+ * \brief һڵķͨ͡
+ *
+ * \param[in] p_this  : SPI 豸
+ * \param[in] idx     : 
+ * \param[in] p_trans : Ĵ
+ * \param[in] pos     : ڴеʼ
+ * \param[in] nwords  : ڵݸ
+ * \param[in] last    : ǷΪһ
+ * \param[in] eot     : һǷɽд TXDATCTL
  */
 am_local
-int __spi_dma_trans (am_lpc84x_spi_dma_dev_t *p_dev)
+void __spi_link_build (am_lpc84x_spi_dma_dev_t *p_this,
+                       int                      idx,
+                       am_spi_transfer_t       *p_trans,
+                       uint32_t                 pos,
+                       uint32_t                 nwords,
+                       am_bool_t                last,
+                       am_bool_t                eot)
 {
-    am_lpc84x_spi_dma_dev_t             *p_this      = (am_lpc84x_spi_dma_dev_t *)p_dev;
-    const am_lpc84x_spi_dma_devinfo_t   *p_devinfo   = p_this->p_devinfo;
-    amhw_lpc_spi_t                      *p_hw_spi    = (amhw_lpc_spi_t *)(p_devinfo->spi_regbase);
-    am_spi_transfer_t                   *p_cur_trans = p_dev->p_cur_trans;
-    am_lpc84x_dma_controller_t          *p_ctr_tx    = p_this->p_ctr_tx;
-    am_lpc84x_dma_controller_t          *p_ctr_rx    = p_this->p_ctr_rx;
+    amhw_lpc_spi_t *p_hw_spi  = (amhw_lpc_spi_t *)(p_this->p_devinfo->spi_regbase);
+    uint32_t        width     = (p_trans->bits_per_word > 8) ? 2 : 1;
+    uint32_t        tx_nwords = eot ? (nwords - 1) : nwords;
+    uint32_t        tx_flags, rx_flags;
+    const void     *p_tx_buf;
+    void           *p_rx_buf;
 
-    const uint16_t                      *p_tx_buf    = NULL; /* ָûͻָ */
-          uint16_t                      *p_rx_buf    = NULL; /* ָûջָ */
+    tx_flags = AM_LPC84X_DMA_XFER_VALID        |    /* ǰͨЧ */
+               AM_LPC84X_DMA_XFER_SWTRIG       |    /*  */
+               AM_LPC84X_DMA_XFER_DSTINC_NOINC;     /* Ŀַ */
 
-          p_this->rx_trash      = 0;                         /* ݵʱձ */
-
-          p_this->p_tx_buf_eot = 0;                          /* һ֡еһ */
+    rx_flags = AM_LPC84X_DMA_XFER_VALID        |    /* ǰͨЧ */
+               AM_LPC84X_DMA_XFER_SWTRIG       |    /*  */
+               AM_LPC84X_DMA_XFER_SRCINC_NOINC;     /* Դַ */
 
+    /* DMAλ */
+    if (width == 2) {
+        tx_flags |= AM_LPC84X_DMA_XFER_WIDTH_16BIT;
+        rx_flags |= AM_LPC84X_DMA_XFER_WIDTH_16BIT;
+    } else {
+        tx_flags |= AM_LPC84X_DMA_XFER_WIDTH_8BIT;
+        rx_flags |= AM_LPC84X_DMA_XFER_WIDTH_8BIT;
+    }
 
+    /* к滹ʱһ־ */
+    if (last && !eot) {
+        tx_flags |= AM_LPC84X_DMA_XFER_CLRTRIG;
+    } else {
+        tx_flags |= AM_LPC84X_DMA_XFER_RELOAD;
+    }
 
-    uint8_t    eot_nbyte    = 0;    /* ͽֵֽ */
-    uint32_t   dma_flags[3] = {0};  /* DMAͨ */
+    /* ֻһжA */
+    if (last) {
+        rx_flags |= AM_LPC84X_DMA_XFER_CLRTRIG | AM_LPC84X_DMA_XFER_SETINTA;
+    } else {
+        rx_flags |= AM_LPC84X_DMA_XFER_RELOAD;
+    }
 
     /* ֻղ */
-    if (p_cur_trans->p_txbuf == NULL) {
-        if (p_cur_trans->flags & AM_SPI_READ_MOSI_HIGH) {
-            p_tx_buf = &__const_high;                       /* MOSIʱߵƽ */
+    if (p_trans->p_txbuf == NULL) {
+        if (p_trans->flags & AM_SPI_READ_MOSI_HIGH) {
+            p_tx_buf = &__const_high;                   /* MOSIʱߵƽ */
         } else {
-            p_tx_buf = &__const_low;                        /* MOSIʱ͵ƽ */
+            p_tx_buf = &__const_low;                    /* MOSIʱ͵ƽ */
         }
-        p_this->p_tx_buf_eot = AM_SBF(p_cur_trans->bits_per_word - 1, 24) |
-                       *((uint16_t *)p_tx_buf);
+        tx_flags |= AM_LPC84X_DMA_XFER_SRCINC_NOINC;    /* Դַ */
 
     /* ڷ */
     } else {
-        p_tx_buf = (const uint16_t *)p_cur_trans->p_txbuf; /* MOSIû */
-        if (p_cur_trans->bits_per_word > 8) {
-
-            /*
-             * SPIݿƼĴTXDATCTL16λ÷ݵĻ
-             * 24 ~ 27λôݿ, 20λôĽ(һδSPIͷƬѡź)
-             *
-             */
-            p_this->p_tx_buf_eot = AM_SBF(p_cur_trans->bits_per_word - 1, 24) |
-                           ((uint16_t *)p_tx_buf)[p_cur_trans->nbytes/2 - 1];
-        } else {
-            p_this->p_tx_buf_eot = AM_SBF(p_cur_trans->bits_per_word - 1, 24) |
-                           ((uint8_t *)p_tx_buf)[p_cur_trans->nbytes - 1];
-        }
+        p_tx_buf  = (const uint8_t *)p_trans->p_txbuf + pos * width;
+        tx_flags |= AM_LPC84X_DMA_XFER_SRCINC_1X;       /* Դַ */
     }
 
-    /* ֡һַǷƬѡźţӲƬѡ */
-    p_this->p_tx_buf_eot |= AMHW_LPC_SPI_TXDATCTL_EOT;
-
     /* ֻͲ */
-    if (p_cur_trans->p_rxbuf == NULL) {
-        p_rx_buf = &p_this->rx_trash ;                           /* ָ */
+    if (p_trans->p_rxbuf == NULL) {
+        p_rx_buf  = &p_this->rx_trash;                  /* ָ */
+        rx_flags |= AM_LPC84X_DMA_XFER_DSTINC_NOINC;    /* Ŀַ */
 
-      /* ڽ */
+    /* ڽ */
     } else {
-       p_rx_buf = p_cur_trans->p_rxbuf;                 /* ָûջ */
+        p_rx_buf  = (uint8_t *)p_trans->p_rxbuf + pos * width;
+        rx_flags |= AM_LPC84X_DMA_XFER_DSTINC_1X;       /* Ŀַ */
     }
 
-    /* DMAͨ */
-    dma_flags[0] = AM_LPC84X_DMA_XFER_VALID        |    /* ǰͨЧ */
-                   AM_LPC84X_DMA_XFER_RELOAD       |    /* ͨ */
-                   AM_LPC84X_DMA_XFER_SWTRIG       |    /*  */
-                   AM_LPC84X_DMA_XFER_DSTINC_NOINC;     /* Ŀַ */
-
-    /* DMAͽͨ */
-    dma_flags[1] = AM_LPC84X_DMA_XFER_VALID        |    /* ǰͨЧ */
-                   AM_LPC84X_DMA_XFER_SWTRIG       |    /*  */
-                   AM_LPC84X_DMA_XFER_CLRTRIG      |    /* ־ */
-                   AM_LPC84X_DMA_XFER_DSTINC_NOINC |    /* Ŀַ */
-                   AM_LPC84X_DMA_XFER_WIDTH_32BIT  |    /* ݿ32λ */
-                   AM_LPC84X_DMA_XFER_SRCINC_NOINC;     /* Դַ */
-
-
-    /* DMAͨ */
-    dma_flags[2] = AM_LPC84X_DMA_XFER_VALID        |      /* ǰЧ */
-                   AM_LPC84X_DMA_XFER_SWTRIG       |      /*  */
-                   AM_LPC84X_DMA_XFER_CLRTRIG      |      /* ־ */
-                   AM_LPC84X_DMA_XFER_SRCINC_NOINC |      /* Դַ */
-                   AM_LPC84X_DMA_XFER_SETINTA;            /* ʹжA */
-
-    /* DMAλ */
-    if (p_cur_trans->bits_per_word > 8) {
-        dma_flags[0] |= AM_LPC84X_DMA_XFER_WIDTH_16BIT;
-        dma_flags[2] |= AM_LPC84X_DMA_XFER_WIDTH_16BIT;
-        eot_nbyte     = 2;
-    } else {
-        dma_flags[0] |= AM_LPC84X_DMA_XFER_WIDTH_8BIT;
-        dma_flags[2] |= AM_LPC84X_DMA_XFER_WIDTH_8BIT;
-        eot_nbyte     = 1;
+    /* ֻһɽдʱûз */
+    if (tx_nwords != 0) {
+        am_lpc84x_dma_xfer_desc_build(&p_this->tx_desc[idx],
+                                      (uint32_t)p_tx_buf,
+                                      (uint32_t)&(p_hw_spi->txdat),
+                                      tx_nwords * width,
+                                      tx_flags);
     }
 
-    /* ͻЧ */
-    if (p_cur_trans->p_txbuf != NULL) {
-        dma_flags[0] |= AM_LPC84X_DMA_XFER_SRCINC_1X;      /* Դַ */
-    } else {
-        dma_flags[0] |= AM_LPC84X_DMA_XFER_SRCINC_NOINC;   /* Դַ */
-    }
-
-    /* ջЧ */
-    if (p_cur_trans->p_rxbuf != NULL) {
-        dma_flags[2] |= AM_LPC84X_DMA_XFER_DSTINC_1X;      /* Ŀַ */
-    } else {
-        dma_flags[2] |= AM_LPC84X_DMA_XFER_DSTINC_NOINC ;            /* Ŀַ   */
-    }
-
-    /* ֻһδʱ */
-    if (p_this->dma_trans_num == 1) {
-
-        /* ͨ */
-        am_lpc84x_dma_xfer_desc_build(&p_this->g_desc[0],                                  /*  */
-                                        (uint32_t)&p_this->p_tx_buf_eot,                             /* ԴBUFF */
-                                        (uint32_t)&(p_hw_spi->txdatctl),                     /* ĿBUFF */
-                                         4,                                                  /* TXֽ */
-                                         dma_flags[1]);                                      /*  */
-        /* RX */
-        if (p_cur_trans->p_rxbuf != NULL) {
-            /* RXͨ */
-            am_lpc84x_dma_xfer_desc_build(&p_this->g_desc[2],                                  /*  */
-                                            (uint32_t)&(p_hw_spi->rxdat),                        /* ԴBUFF */
-                                            (uint32_t)&p_rx_buf[p_this->dma_trans_count * 512 * eot_nbyte], /* ĿBUFF */
-                                            p_this->dma_trans_num * eot_nbyte,                   /* RXֽ */                                            dma_flags[2]);                                       /*  */
-        } else {
-
-            /* RXͨ */
-            am_lpc84x_dma_xfer_desc_build(&p_this->g_desc[2],                                  /*  */
-                                            (uint32_t)&(p_hw_spi->rxdat),                        /* ԴBUFF */
-                                            (uint32_t)p_rx_buf,                                  /* ĿBUFF */
-                                            p_this->dma_trans_num * eot_nbyte,                   /* TXֽ */
-                                            dma_flags[2]);
-
-        }
-
-        p_this->dma_trans_flg = 0;
-
-    /* Ͷδʱ */
-    } else {
-
-         /* 䳬1024ʱ */
-         if (p_this->dma_trans_num > 1024) {
-
-             /* TX */
-             if (p_cur_trans->p_txbuf != NULL) {
-                 /* TXͨ */
-                 am_lpc84x_dma_xfer_desc_build(&p_this->g_desc[0],                                    /* .  */
-                                                  (uint32_t)&p_tx_buf[p_this->dma_trans_count * 512 * eot_nbyte],  /* ԴBUFF */
-                                                  (uint32_t)&(p_hw_spi->txdat),                         /* ĿBUFF */
-                                                  1024 *  eot_nbyte,                                    /* TXֽ */
-                                                  dma_flags[0]);                                        /*  */
-             } else {
-
-                 /* TXͨ */
-                 am_lpc84x_dma_xfer_desc_build(&p_this->g_desc[0],                                    /* .  */
-                                                  (uint32_t)p_tx_buf,                                   /* ԴBUFF */
-                                                  (uint32_t)&(p_hw_spi->txdat),                         /* ĿBUFF */
-                                                  1024 *  eot_nbyte,                                    /* TXֽ */
-                                                  dma_flags[0]);
-
-             }
-
-             /* RX */
-             if (p_cur_trans->p_rxbuf != NULL) {
-
-                 /* RXͨ */
-                 am_lpc84x_dma_xfer_desc_build(&p_this->g_desc[2],                                    /*  */
-                                                 (uint32_t)&(p_hw_spi->rxdat),                          /* ԴBUFF */
-                                                 (uint32_t)&p_rx_buf[p_this->dma_trans_count * 512 * eot_nbyte],   /* ĿBUFF */
-                                                  1024 *  eot_nbyte,                                    /* RXֽ */
-                                                  dma_flags[2]);                                        /*  */
-             } else {
-                 /* RXͨ */
-                 am_lpc84x_dma_xfer_desc_build(&p_this->g_desc[2],                                      /*  */
-                                                 (uint32_t)&(p_hw_spi->rxdat),                            /* ԴBUFF */
-                                                 (uint32_t)p_rx_buf,                                      /* ĿBUFF */
-                                                  1024 *  eot_nbyte,                                      /* RXֽ */
-                                                  dma_flags[2]);                                          /*  */
-
-             }
+    am_lpc84x_dma_xfer_desc_build(&p_this->rx_desc[idx],
+                                  (uint32_t)&(p_hw_spi->rxdat),
+                                  (uint32_t)p_rx_buf,
+                                  nwords * width,
+                                  rx_flags);
+}
 
-             /*Ǵ䳤ȴ1024,ʱҪ */
-             p_this->dma_trans_flg = 1;
+/**
+ * \brief ϢȡһݣӺõ DMA 
+ *
+ * һഫ 1024 ݣϳĴΪڡִС
+ * һ䲻ͬĴ䡢ԼʣһҪ
+ * ıƬѡĴ֮ҪͷƬѡʱһͬ
+ * ־ɽд TXDATCTLд TXDATƬѡб
+ * Ч
+ *
+ * \return 0ʾϢûݣʾ
+ */
+am_local
+int __spi_chain_build (am_lpc84x_spi_dma_dev_t *p_this)
+{
+    amhw_lpc_spi_t    *p_hw_spi = (amhw_lpc_spi_t *)(p_this->p_devinfo->spi_regbase);
+    am_spi_message_t  *p_msg    = p_this->p_cur_msg;
+    am_spi_transfer_t *p_trans  = p_this->p_cur_trans;
+    am_spi_transfer_t *p_first  = NULL;
+    am_spi_transfer_t *p_next;
+    uint32_t           pos      = p_this->trans_pos;
+    am_bool_t          eot      = AM_FALSE;
+    int                n        = 0;
+    int                ntx;
+    int                ret;
+    int                i;
+
+    am_spi_transfer_t *link_trans[AM_LPC84X_SPI_DMA_LINK_MAX];
+    uint32_t           link_pos[AM_LPC84X_SPI_DMA_LINK_MAX];
+    uint32_t           link_nwords[AM_LPC84X_SPI_DMA_LINK_MAX];
+
+    p_this->chain_nbytes = 0;
+
+    while (n < AM_LPC84X_SPI_DMA_LINK_MAX) {
+
+        /* ǰȫȡһ */
+        if ((p_trans == NULL) || (pos == __spi_trans_nwords(p_trans))) {
+
+            if (am_list_empty(&(p_msg->transfers))) {
+                break;
+            }
 
-         } else { /* Сڻ1024ʱ  */
+            p_next = am_list_entry(p_msg->transfers.next,
+                                   am_spi_transfer_t,
+                                   trans_node);
 
-             /* TX */
-             if (p_cur_trans->p_txbuf != NULL) {
-                 /* TXͨ */
-                 am_lpc84x_dma_xfer_desc_build(&p_this->g_desc[0],                                    /*  */
-                                                  (uint32_t)&p_tx_buf[p_this->dma_trans_count * 512 * eot_nbyte],  /* ԴBUFF */
-                                                  (uint32_t)&(p_hw_spi->txdat),                         /* ĿBUFF */
-                                                  p_this->dma_trans_num * eot_nbyte - eot_nbyte,        /* TXֽ */
-                                                  dma_flags[0]);                                        /*  */
-             } else {
+            /* ĴǰĴɺٴϢڴ˽ */
+            ret = __spi_trans_check(p_this, p_next);
+            if (ret != AM_OK) {
+                if (n == 0) {
+                    return ret;
+                }
+                eot = AM_TRUE;
+                break;
+            }
 
-                 /* TXͨ */
-                 am_lpc84x_dma_xfer_desc_build(&p_this->g_desc[0],                                    /* .  */
-                                                  (uint32_t)p_tx_buf,                                   /* ԴBUFF */
-                                                  (uint32_t)&(p_hw_spi->txdat),                         /* ĿBUFF */
-                                                  p_this->dma_trans_num * eot_nbyte - eot_nbyte,        /* TXֽ */
-                                                  dma_flags[0]);
+            /* ִСʲͬҪ SPI */
+            if ((p_first != NULL) &&
+                ((p_next->bits_per_word != p_first->bits_per_word) ||
+                 (p_next->speed_hz      != p_first->speed_hz))) {
+                break;
+            }
 
-             }
+            p_trans             = __spi_trans_out(p_msg);
+            p_this->p_cur_trans = p_trans;
+            pos                 = 0;
+        }
 
-             /* ͨ */
-             am_lpc84x_dma_xfer_desc_build(&p_this->g_desc[1],              /*  */
-                                             (uint32_t)&p_this->p_tx_buf_eot,         /* ԴBUFF */
-                                             (uint32_t)&(p_hw_spi->txdatctl), /* ĿBUFF */
-                                              4,                              /* TXֽ */
-                                              dma_flags[1]);                  /*  */
+        if (p_first == NULL) {
+            p_first = p_trans;
+        }
 
-             /* RX */
-             if (p_cur_trans->p_rxbuf != NULL) {
+        link_trans[n]  = p_trans;
+        link_pos[n]    = pos;
+        link_nwords[n] = __spi_trans_nwords(p_trans) - pos;
+        if (link_nwords[n] > 1024) {
+            link_nwords[n] = 1024;
+        }
+        pos += link_nwords[n];
+        n++;
 
+        if (pos == __spi_trans_nwords(p_trans)) {
+            p_this->chain_nbytes += p_trans->nbytes;
 
-                 /* RXͨ */
-                 am_lpc84x_dma_xfer_desc_build(&p_this->g_desc[2],                                    /*  */
-                                                 (uint32_t)&(p_hw_spi->rxdat),                          /* ԴBUFF */
-                                                 (uint32_t)&p_rx_buf[p_this->dma_trans_count * 512 * eot_nbyte],   /* ĿBUFF */
-                                                 p_this->dma_trans_num * eot_nbyte,                     /* TXֽ */
-                                                 dma_flags[2]);
+            /* ҪıƬѡĴ */
+            if (p_trans->cs_change) {
+                eot = AM_TRUE;
+                break;
+            }
+        }
+    }
 
-             } else {
-                 /* RXͨ */
-                 am_lpc84x_dma_xfer_desc_build(&p_this->g_desc[2],                                      /*  */
-                                                 (uint32_t)&(p_hw_spi->rxdat),                            /* ԴBUFF */
-                                                 (uint32_t)p_rx_buf,                                      /* ĿBUFF */
-                                                 p_this->dma_trans_num * eot_nbyte,                       /* TXֽ */
-                                                 dma_flags[2]);                                           /*  */
+    p_this->trans_pos = pos;
 
-             }
+    if (n == 0) {
+        return 0;
+    }
 
+    /* Ϣһ */
+    if ((pos == __spi_trans_nwords(p_trans)) &&
+        am_list_empty(&(p_msg->transfers))) {
+        eot = AM_TRUE;
+    }
 
-             p_this->dma_trans_flg = 0;
+    for (i = 0; i < n; i++) {
+        __spi_link_build(p_this,
+                         i,
+                         link_trans[i],
+                         link_pos[i],
+                         link_nwords[i],
+                         (i == n - 1),
+                         (i == n - 1) && eot);
+    }
+    ntx = n;
 
-         }
+    /* ͨһ֮ */
+    if (eot) {
+        if (link_nwords[n - 1] == 1) {
+            ntx--;
+        }
 
+        if (p_trans->p_txbuf == NULL) {
+            p_this->p_tx_buf_eot = (p_trans->flags & AM_SPI_READ_MOSI_HIGH) ?
+                                   __const_high : __const_low;
+        } else if (p_trans->bits_per_word > 8) {
+            p_this->p_tx_buf_eot = ((const uint16_t *)p_trans->p_txbuf)[pos - 1];
+        } else {
+            p_this->p_tx_buf_eot = ((const uint8_t *)p_trans->p_txbuf)[pos - 1];
+        }
+        p_this->p_tx_buf_eot |= AM_SBF(p_trans->bits_per_word - 1, 24) |
+                                AMHW_LPC_SPI_TXDATCTL_EOT;
+
+        am_lpc84x_dma_xfer_desc_build(&p_this->tx_desc[ntx],
+                                      (uint32_t)&p_this->p_tx_buf_eot,
+                                      (uint32_t)&(p_hw_spi->txdatctl),
+                                      4,
+                                      AM_LPC84X_DMA_XFER_VALID        |
+                                      AM_LPC84X_DMA_XFER_SWTRIG       |
+                                      AM_LPC84X_DMA_XFER_CLRTRIG      |
+                                      AM_LPC84X_DMA_XFER_DSTINC_NOINC |
+                                      AM_LPC84X_DMA_XFER_WIDTH_32BIT  |
+                                      AM_LPC84X_DMA_XFER_SRCINC_NOINC);
+        ntx++;
+    }
 
-         if (p_this->dma_trans_flg == 0) {
-             /* DMAӷͨ */
-             am_lpc84x_dma_xfer_desc_link(&p_this->g_desc[0], &p_this->g_desc[1]);
-         }
-    }
-
-//    if (amhw_lpc84x_dma_chan_periph_is_enable(AMHW_LPC84X_DMA, p_ctr_tx->chan))
-
+    /*  */
+    for (i = 0; i < ntx - 1; i++) {
+        am_lpc84x_dma_xfer_desc_link(&p_this->tx_desc[i], &p_this->tx_desc[i + 1]);
+    }
+    for (i = 0; i < n - 1; i++) {
+        am_lpc84x_dma_xfer_desc_link(&p_this->rx_desc[i], &p_this->rx_desc[i + 1]);
+    }
 
-    /* λƬѡź */
-    __spi_cs_on(p_this, p_this->p_cur_spi_dev);
+    return n;
+}
 
-    /* DMA䣬Ͽʼ */
-    am_lpc84x_dma_xfer_desc_startup(p_ctr_rx,
-                                    &p_this->g_desc[2],
+/**
+ * \brief е DMA װ
+ */
+am_local
+void __spi_chain_start (am_lpc84x_spi_dma_dev_t *p_this)
+{
+    /* ͨⶪʧ */
+    am_lpc84x_dma_xfer_desc_startup(p_this->p_ctr_rx,
+                                    &p_this->rx_desc[0],
                                     __spi_dma_isr,
                                     (void *)p_this);
 
-    /* DMA䣬Ͽʼ */
-    am_lpc84x_dma_xfer_desc_startup(p_ctr_tx,
-                                    &p_this->g_desc[0],
-                  __spi_dma_isr,
+    am_lpc84x_dma_xfer_desc_startup(p_this->p_ctr_tx,
+                                    &p_this->tx_desc[0],
+                                    __spi_dma_isr,
                                     (void *)p_this);
-    return AM_OK;
-
 }
 
 /******************************************************************************/
@@ -811,9 +851,12 @@ int __spi_mst_sm_event (am_lpc84x_spi_dma_dev_t *p_dev, uint32_t event)
             key = am_int_cpu_lock();
             p_cur_msg          = __spi_msg_out(p_dev);
             p_dev->p_cur_msg   = p_cur_msg;
+            p_dev->p_cur_trans = NULL;
+            p_dev->trans_pos   = 0;
 
             if (p_cur_msg) {
-                p_cur_msg->status = -AM_EINPROGRESS;
+                p_cur_msg->status        = -AM_EINPROGRESS;
+                p_cur_msg->actual_length = 0;
             } else {
                 /* ж */
                 amhw_lpc_spi_int_disable(p_hw_spi,
@@ -833,6 +876,8 @@ int __spi_mst_sm_event (am_lpc84x_spi_dma_dev_t *p_dev, uint32_t event)
                 break;
             } else {
 
+                p_dev->p_cur_spi_dev = p_cur_msg->p_spi_dev;
+
                 /* ֱӽһ״̬ʼһ䣬˴break */
                 __SPI_NEXT_STATE(__SPI_ST_TRANS_START, __SPI_EVT_TRANS_LAUNCH);
 
@@ -845,15 +890,22 @@ int __spi_mst_sm_event (am_lpc84x_spi_dma_dev_t *p_dev, uint32_t event)
         case __SPI_ST_TRANS_START:  /* 俪ʼ */
         {
             am_spi_message_t  *p_cur_msg   = p_dev->p_cur_msg;
+            int                nlinks      = 0;
 
             if (event != __SPI_EVT_TRANS_LAUNCH) {
                 return -AM_EINVAL;  /* 俪ʼ״̬ȴϢ */
             }
 
-            /* ǰϢ */
-            if (am_list_empty(&(p_cur_msg->transfers))) {
+            /* ȡһ */
+            if (p_cur_msg->status == -AM_EINPROGRESS) {
+                nlinks = __spi_chain_build(p_dev);
+                if (nlinks < 0) {
+                    p_cur_msg->status = nlinks;
+                }
+            }
 
-                p_cur_msg->actual_length = 0;
+            /* ǰϢ */
+            if (nlinks <= 0) {
 
                 /* Ϣڴ */
                 if (p_cur_msg->status == -AM_EINPROGRESS) {
@@ -871,22 +923,12 @@ int __spi_mst_sm_event (am_lpc84x_spi_dma_dev_t *p_dev, uint32_t event)
                 __SPI_NEXT_STATE(__SPI_ST_MSG_START, __SPI_EVT_TRANS_LAUNCH);
 
             } else {
-                /* ȡһ䣬ȷô伴 */
-                am_spi_transfer_t *p_cur_trans = __spi_trans_out(p_cur_msg);
-                p_dev->p_cur_trans             = p_cur_trans;
 
-                /* SPI */
+                /* ִСֻͬһ */
                 __spi_config(p_dev);
 
-                /* DMAݳ */
-                if (p_cur_trans->bits_per_word > 8) {
-                    p_dev->dma_trans_num = p_cur_trans->nbytes / 2;
-                } else {
-                    p_dev->dma_trans_num = p_cur_trans->nbytes;
-                }
-
-                p_dev->dma_trans_flg = 0;
-                p_dev->dma_trans_count = 0;
+                /* λƬѡź */
+                __spi_cs_on(p_dev, p_dev->p_cur_spi_dev);
 
                 /* һ״̬ʹDMA */
                __SPI_NEXT_STATE(__SPI_ST_DMA_TRANS_DATA, __SPI_EVT_DMA_TRANS_DATA);
@@ -900,17 +942,11 @@ int __spi_mst_sm_event (am_lpc84x_spi_dma_dev_t *p_dev, uint32_t event)
                 return -AM_EINVAL;  /* ״̬ȴϢǷ */
             }
 
-            if (p_dev->dma_trans_num > 1024) {
-                /* һ״̬Ƿ״̬ */
-                __SPI_NEXT_STATE(__SPI_ST_DMA_TRANS_DATA, __SPI_EVT_NONE);
-            } else {
-                 /* һ״̬»ȡһtransд  */
-                __SPI_NEXT_STATE(__SPI_ST_TRANS_START, __SPI_EVT_NONE);
-            }
-
+            /* ɺص俪ʼ״̬ */
+            __SPI_NEXT_STATE(__SPI_ST_TRANS_START, __SPI_EVT_NONE);
 
-            /* ʹDMA */
-            __spi_dma_trans(p_dev);
+            /* ֻʱһж */
+            __spi_chain_start(p_dev);
 
             break;
         }
@@ -957,9 +993,8 @@ am_spi_handle_t am_lpc84x_spi_dma_init (am_lpc84x_spi_dma_dev_t           *p_dev
     p_dev->p_cur_msg        = NULL;
     p_dev->p_cur_trans      = NULL;
 
-    p_dev->dma_trans_count = 0;
-    p_dev->dma_trans_flg   = 0;
-    p_dev->dma_trans_num   = 0;
+    p_dev->trans_pos        = 0;
+    p_dev->chain_nbytes     = 0;
 
     p_dev->state            = __SPI_ST_IDLE;     /* ʼΪ״̬ */
 
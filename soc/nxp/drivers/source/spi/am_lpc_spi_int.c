@@ -509,6 +509,158 @@ struct am_spi_transfer *__spi_trans_out (am_spi_message_t *msg)
     }
 }
 
+/**
+ * \brief жϢǷѯͨ
+ *
+ * дϴʱ֮Ͳѯֵʱ AM_TRUEϢ
+ * Խ״̬
+ */
+am_local
+am_bool_t __spi_msg_poll_check (am_lpc_spi_int_dev_t *p_this,
+                                am_spi_device_t      *p_dev,
+                                am_spi_message_t     *p_msg)
+{
+    am_spi_transfer_t   *p_trans;
+    struct am_list_head *p_node;
+    uint32_t             clk_rate;
+    uint32_t             speed;
+    uint32_t             bits;
+    uint32_t             word_ns;
+    uint32_t             nwords;
+    uint32_t             wire_ns = 0;
+
+    if ((p_this->poll_ns == 0) || am_list_empty(&(p_msg->transfers))) {
+        return AM_FALSE;
+    }
+
+    clk_rate = am_clk_rate_get(p_this->p_devinfo->clk_id);
+
+    am_list_for_each(p_node, &(p_msg->transfers)) {
+        p_trans = am_list_entry(p_node, am_spi_transfer_t, trans_node);
+        speed   = (p_trans->speed_hz != 0) ? p_trans->speed_hz :
+                                             p_dev->max_speed_hz;
+        bits    = (p_trans->bits_per_word != 0) ? p_trans->bits_per_word :
+                                                  p_dev->bits_per_word;
+
+        if ((bits < 4) || (bits > 16) ||
+            (speed > clk_rate) || (speed < clk_rate / 65536) ||
+            (p_trans->nbytes == 0) ||
+            ((p_trans->p_txbuf == NULL) && (p_trans->p_rxbuf == NULL))) {
+            return AM_FALSE;
+        }
+
+        word_ns = (1000000000u / speed) * bits;
+        nwords  = (bits <= 8) ? p_trans->nbytes : (p_trans->nbytes / 2);
+
+        if (nwords > (p_this->poll_ns - wire_ns) / word_ns) {
+            return AM_FALSE;
+        }
+        wire_ns += nwords * word_ns;
+    }
+
+    return AM_TRUE;
+}
+
+/**
+ * \brief ѯʽշһ
+ *
+ * ÿֶȴɣ֤ʱȫƳȥƬѡ
+ */
+am_local
+void __spi_poll_rw (am_lpc_spi_int_dev_t *p_this, am_spi_transfer_t *p_trans)
+{
+    amhw_lpc_spi_t *p_hw_spi = (amhw_lpc_spi_t *)(p_this->p_devinfo->spi_regbase);
+    const uint8_t  *p_tx     = (const uint8_t *)p_trans->p_txbuf;
+    uint8_t        *p_rx     = (uint8_t *)p_trans->p_rxbuf;
+    uint32_t        size     = (p_trans->bits_per_word <= 8) ? 1 : 2;
+    uint16_t        data;
+    uint32_t        i;
+
+    amhw_lpc_spi_txctl_clear(p_hw_spi, AMHW_LPC_SPI_TXDATCTL_RX_IGNORE);
+
+    for (i = 0; i + size <= p_trans->nbytes; i += size) {
+
+        data = 0x0000;
+        if (p_tx != NULL) {
+            data = (size == 1) ? p_tx[i] : *(const uint16_t *)(p_tx + i);
+        }
+
+        while ((amhw_lpc_spi_stat_get(p_hw_spi) & AMHW_LPC_SPI_STAT_TXRDY) == 0);
+
+        /* һֵĴ */
+        if (i + size >= p_trans->nbytes) {
+            amhw_lpc_spi_txctl_set(p_hw_spi, AMHW_LPC_SPI_TXDATCTL_EOT);
+        } else {
+            amhw_lpc_spi_txctl_clear(p_hw_spi, AMHW_LPC_SPI_TXDATCTL_EOT);
+        }
+
+        amhw_lpc_spi_txdat_write(p_hw_spi, data);
+
+        while ((amhw_lpc_spi_stat_get(p_hw_spi) & AMHW_LPC_SPI_STAT_RXRDY) == 0);
+
+        if (size == 1) {
+            data = amhw_lpc_spi_rxdata_8bit_read(p_hw_spi);
+        } else {
+            data = amhw_lpc_spi_rxdata_16bit_read(p_hw_spi);
+        }
+
+        if (p_rx != NULL) {
+            if (size == 1) {
+                p_rx[i] = (uint8_t)data;
+            } else {
+                *(uint16_t *)(p_rx + i) = data;
+            }
+        }
+
+        p_this->p_cur_msg->actual_length += size;
+    }
+}
+
+/**
+ * \brief ѯʽͬһϢ
+ *
+ * ƬѡԼ״̬ĴжϷʽһ£ǰϢɻصǰ
+ * ѱϢռbusy λ
+ */
+am_local
+void __spi_msg_poll (am_lpc_spi_int_dev_t *p_this, am_spi_message_t *p_msg)
+{
+    am_spi_transfer_t *p_trans;
+    int                ret;
+
+    p_this->p_cur_msg     = p_msg;
+    p_this->p_cur_spi_dev = p_msg->p_spi_dev;
+
+    p_msg->status        = -AM_EINPROGRESS;
+    p_msg->actual_length = 0;
+
+    while ((p_trans = __spi_trans_out(p_msg)) != NULL) {
+
+        p_this->p_cur_trans = p_trans;
+
+        ret = __spi_config(p_this);
+        if (ret != AM_OK) {
+            p_msg->status = ret;
+            break;
+        }
+
+        __spi_cs_on(p_this, p_this->p_cur_spi_dev);
+
+        __spi_poll_rw(p_this, p_trans);
+    }
+
+    if (p_msg->status == -AM_EINPROGRESS) {
+        p_msg->status = AM_OK;
+    }
+
+    if (p_msg->pfn_complete != NULL) {
+        p_msg->pfn_complete(p_msg->p_arg);
+    }
+
+    /* Ƭѡر */
+    __spi_cs_off(p_this, p_this->p_cur_spi_dev);
+}
+
 /**
  * \brief SPI ݺ
  */
@@ -518,15 +670,10 @@ int __spi_msg_start (void              *p_drv,
                      am_spi_message_t  *p_msg)
 {
     am_lpc_spi_int_dev_t *p_this   = (am_lpc_spi_int_dev_t *)p_drv;
-    amhw_lpc_spi_t      *p_hw_spi  = (amhw_lpc_spi_t *)(p_this->p_devinfo->spi_regbase);
-
-    int key;
-
-    p_this->p_cur_spi_dev  = p_dev;                         /* ǰ豸Ϣ */
-    p_this->p_cur_msg      = p_msg;                         /* ǰ豸Ϣ */
-    p_this->nbytes_to_recv = 0;                             /* ַ0 */
-    p_this->data_ptr       = 0;                             /* ѽַ0 */
+    amhw_lpc_spi_t       *p_hw_spi;
 
+    am_bool_t is_poll;
+    int       key;
 
     /* 豸ЧԼ */
     if ((p_drv              == NULL) ||
@@ -535,8 +682,15 @@ int __spi_msg_start (void              *p_drv,
         return -AM_EINVAL;
     }
 
-    /* ɽλ */
-    amhw_lpc_spi_txctl_clear(p_hw_spi, AMHW_LPC_SPI_TXDATCTL_EOT);
+    p_hw_spi = (amhw_lpc_spi_t *)(p_this->p_devinfo->spi_regbase);
+
+    /*
+     * 豸Ϣ뵽ϢУæʱϢҪŶӣڴ˴д
+     * ǰ豸͵ǰϢ
+     */
+    p_msg->p_spi_dev = p_dev;
+
+    is_poll = __spi_msg_poll_check(p_this, p_dev, p_msg);
 
     key = am_int_cpu_lock();
 
@@ -545,7 +699,31 @@ int __spi_msg_start (void              *p_drv,
         __spi_msg_in(p_this, p_msg);
         am_int_cpu_unlock(key);
         return AM_OK;
+    } else if (is_poll) {
+
+        /*
+         * ҶΪգϢֱѯʽɡڼжύ
+         * ϢڱϢ֮ɺ״̬
+         */
+        p_this->busy = AM_TRUE;
+        am_int_cpu_unlock(key);
+
+        __spi_msg_poll(p_this, p_msg);
+
+        key = am_int_cpu_lock();
+        if (am_list_empty(&(p_this->msg_list))) {
+            p_this->busy = AM_FALSE;
+            am_int_cpu_unlock(key);
+            return AM_OK;
+        }
+        am_int_cpu_unlock(key);
+
+        return __spi_mst_sm_event(p_this, __SPI_EVT_TRANS_LAUNCH);
     } else {
+
+        /* ɽλ */
+        amhw_lpc_spi_txctl_clear(p_hw_spi, AMHW_LPC_SPI_TXDATCTL_EOT);
+
         p_this->busy = AM_TRUE;
         __spi_msg_in(p_this, p_msg);
         p_msg->status = -AM_EISCONN; /* Ŷ */
@@ -616,7 +794,9 @@ int __spi_mst_sm_event (am_lpc_spi_int_dev_t *p_dev, uint32_t event)
             p_dev->p_cur_msg   = p_cur_msg;
 
             if (p_cur_msg) {
-                p_cur_msg->status = -AM_EINPROGRESS;
+                p_cur_msg->status        = -AM_EINPROGRESS;
+                p_cur_msg->actual_length = 0;
+                p_dev->p_cur_spi_dev     = p_cur_msg->p_spi_dev;
             } else {
                 /* ж */
                 amhw_lpc_spi_int_disable(p_hw_spi,
@@ -658,8 +838,6 @@ int __spi_mst_sm_event (am_lpc_spi_int_dev_t *p_dev, uint32_t event)
             /* ǰϢ */
             if (am_list_empty(&(p_cur_msg->transfers))) {
 
-                p_cur_msg->actual_length = 0;
-
                 /* Ϣڴ */
                 if (p_cur_msg->status == -AM_EINPROGRESS) {
                     p_cur_msg->status = AM_OK;
@@ -854,6 +1032,7 @@ am_spi_handle_t am_lpc_spi_int_init (am_lpc_spi_int_dev_t           *p_dev,
     p_dev->p_cur_trans      = NULL;
     p_dev->data_ptr         = 0;
     p_dev->nbytes_to_recv   = 0;
+    p_dev->poll_ns          = AM_LPC_SPI_INT_POLL_NS;
     p_dev->state            = __SPI_ST_IDLE;     /* ʼΪ״̬ */
 
     am_list_head_init(&(p_dev->msg_list));
@@ -900,4 +1079,23 @@ void am_lpc_spi_int_deinit (am_spi_handle_t handle)
         p_dev->p_devinfo->pfn_plfm_deinit();
     }
 }
+
+/**
+ * \brief ѯֵͨ
+ */
+uint32_t am_lpc_spi_int_poll_ns_set (am_spi_handle_t handle, uint32_t poll_ns)
+{
+    am_lpc_spi_int_dev_t *p_dev = (am_lpc_spi_int_dev_t *)handle;
+    uint32_t              old;
+
+    if (NULL == p_dev) {
+        return 0;
+    }
+
+    old            = p_dev->poll_ns;
+    p_dev->poll_ns = poll_ns;
+
+    return old;
+}
+
 /* end of file */
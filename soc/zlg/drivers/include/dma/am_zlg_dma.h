@@ -96,6 +96,9 @@ typedef struct am_zlg_dma_dev {
 /**
  * \brief DMAͨ
  *
+ * ǰͨϴδжϱ־ֻͨ am_zlg_dma_isr_connect()
+ * жϷͨʹܴжϣδӵֻͨܲѯʣֽ
+ *
  * \param[in] chan  : DMA ͨţֵΪDMA_CHAN_* (#DMA_CHAN_1)  (#DMA_CHAN_UART1_TX)
  *
  * \retval AM_OK    : óɹ
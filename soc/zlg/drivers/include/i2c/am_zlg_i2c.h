@@ -43,6 +43,20 @@ extern "C" {
  * @{
  */
 
+/**
+ * \brief ѯͨĬֵλnsʱѡ
+ *
+ * ʱϴʱ䣨ӻֵַϢʹжϣ
+ *  am_i2c_msg_start() ѯʽͬɣڷǰϢ
+ * صֵӦжϷʽһϢжϺͻѿڳʼ
+ * ʹ am_i2c_poll_calibrate() ʵ⡣Ϊ 0 ʱرѯͨ
+ *
+ * Ĭֵ 400kHz ¿ɸǴӻַһֽڵļĴд
+ */
+#ifndef AM_ZLG_I2C_POLL_NS
+#define AM_ZLG_I2C_POLL_NS        50000
+#endif
+
 /**
  * \brief I2C豸Ϣṹ
  */
@@ -123,6 +137,9 @@ typedef struct am_zlg_i2c_dev {
     /** \brief Ƿж״̬ */
     volatile am_bool_t                      is_abort;
 
+    /** \brief ѯֵϴʱ䲻ֵnsϢѯʽ */
+    uint32_t                                poll_ns;
+
     /** \brief ָI2C豸Ϣָ */
     const am_zlg_i2c_devinfo_t             *p_devinfo;
 
@@ -148,6 +165,19 @@ am_i2c_handle_t am_zlg_i2c_init (am_zlg_i2c_dev_t           *p_dev,
  */
 void am_zlg_i2c_deinit (am_i2c_handle_t handle);
 
+/**
+ * \brief ѯֵͨ
+ *
+ * \param[in] handle  : I2C׼
+ * \param[in] poll_ns : ֵnsϴʱ䲻ֵϢѯʽ
+ *                      ͬɣΪ 0 ʱرѯͨ
+ *
+ * \return ԭֵns
+ *
+ * \note úΪ am_i2c_poll_calibrate() ֵú
+ */
+uint32_t am_zlg_i2c_poll_ns_set (am_i2c_handle_t handle, uint32_t poll_ns);
+
 /** @} */
 
 #ifdef __cplusplus
@@ -38,6 +38,16 @@ extern "C" {
  * @{
  */
 
+/**
+ * \brief ʱÿʱѡ
+ *
+ * ÿرΪ9λ֡ռ4ֽڡʹ DMA ʱ豸ṹ
+ * һͬʱһ顣
+ */
+#ifndef AM_ZLG_ILI9341_3WIRE_BUF_PIXELS
+#define AM_ZLG_ILI9341_3WIRE_BUF_PIXELS    32
+#endif
+
 /**
  * \brief ili9341߽ӿϢ
  */
@@ -76,6 +86,9 @@ typedef struct am_zlg_ili9341_intfc_3wire_devinfo {
     /** \brief SPI ٶȣ 24Mhz */
     uint32_t           speed_hz;
 
+    /** \brief SPIDMAͨţΪ -1 ʱͲʹ DMA */
+    int                dma_chan_tx;
+
 }am_zlg_ili9341_intfc_3wire_devinfo_t;
 
 /**
@@ -89,6 +102,9 @@ typedef struct am_zlg_ili9341_intfc_3wire_dev {
     /** \brief ߽ӿڵĽӿϢ */
     const am_zlg_ili9341_intfc_3wire_devinfo_t *p_devinfo;
 
+    /** \brief ͵ı뻺 */
+    uint8_t  buf[2][AM_ZLG_ILI9341_3WIRE_BUF_PIXELS * 4];
+
 }am_zlg_ili9341_intfc_3wire_dev_t;
 
 /**
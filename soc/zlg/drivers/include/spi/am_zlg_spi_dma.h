@@ -47,6 +47,42 @@ extern "C" {
 /** \brief ֹͣģʽSPI */
 #define AM_ZLG_SPI_DMA_CFG_WIAT_DIS       (AM_BIT(28) | AM_SBF(1,3))
 
+/**
+ * \brief DMA 󳤶ȣʱѡ
+ *
+ * һϢġִСͬĴԤȽ DMA һ
+ * ÿĽ DMA жֱװһ
+ * SPIɺŻص״ֵ̬ʱΪ
+ *
+ * \note  DMA ûӣɢ/ۼܣͨĴ͵ַ
+ *       ֻ CPU ڴɺװأÿһνжϣ
+ *       ޷ֻڽʱжϡͨжϷ
+ *       жϡ
+ */
+#ifndef AM_ZLG_SPI_DMA_LINK_MAX
+#define AM_ZLG_SPI_DMA_LINK_MAX           4
+#endif
+
+/**
+ * \brief ѯͨĬֵλnsʱѡ
+ *
+ * ʱϴʱ䲻ֵϢʹ DMA жϣ
+ * am_spi_msg_start() ѯʽͬɣڷǰϢɻص
+ * ֵӦһ DMA жϺͻѿڳʼʹ
+ * am_spi_poll_calibrate() ʵ⡣Ϊ 0 ʱرѯͨ
+ */
+#ifndef AM_ZLG_SPI_DMA_POLL_NS
+#define AM_ZLG_SPI_DMA_POLL_NS            10000
+#endif
+
+/**
+ * \brief DMA еһ
+ */
+typedef struct am_zlg_spi_dma_link {
+    amhw_zlg_dma_xfer_desc_t  desc[2];  /**< \brief ͨ͡ */
+    am_spi_transfer_t        *p_trans;  /**< \brief ӦĴ */
+} am_zlg_spi_dma_link_t;
+
 /**
  * \brief SPI 豸Ϣṹ
  */
@@ -76,9 +112,6 @@ typedef struct am_zlg_spi_dma_dev {
     const am_zlg_spi_dma_devinfo_t *p_devinfo;  /**< \brief SPI豸Ϣָ */
     struct am_list_head             msg_list;   /**< \brief SPIϢ */
 
-    /** \brief ָ SPI жҪʹõϢ */
-    am_spi_message_t           *p_isr_msg;
-
     /** \brief ָSPIϢṹָ,ͬһʱֻܴһϢ */
     am_spi_message_t           *p_cur_msg;
 
@@ -94,7 +127,17 @@ typedef struct am_zlg_spi_dma_dev {
     am_bool_t                   busy;           /**< \brief SPIæʶ         */
     uint32_t                    state;          /**< \brief SPI״̬״̬ */
 
-    amhw_zlg_dma_xfer_desc_t    g_desc[2];      /**< \brief DMAͨ */
+    /** \brief ǰ DMA  */
+    am_zlg_spi_dma_link_t       link[AM_ZLG_SPI_DMA_LINK_MAX];
+
+    uint8_t                     nlinks;         /**< \brief  */
+    uint8_t                     link_idx;       /**< \brief ڴ */
+
+    uint32_t                    dummy_tx;       /**< \brief ֻʱ͵ */
+    uint32_t                    dummy_rx;       /**< \brief ֻʱ */
+
+    /** \brief ѯֵϴʱ䲻ֵnsϢѯʽ */
+    uint32_t                    poll_ns;
 
 } am_zlg_spi_dma_dev_t;
 
@@ -118,6 +161,19 @@ am_spi_handle_t am_zlg_spi_dma_init (am_zlg_spi_dma_dev_t           *p_dev,
  */
 void am_zlg_spi_dma_deinit (am_spi_handle_t handle);
 
+/**
+ * \brief ѯֵͨ
+ *
+ * \param[in] handle  : SPI׼
+ * \param[in] poll_ns : ֵnsϴʱ䲻ֵϢѯʽ
+ *                      ͬɣΪ 0 ʱرѯͨ
+ *
+ * \return ԭֵns
+ *
+ * \note úΪ am_spi_poll_calibrate() ֵú
+ */
+uint32_t am_zlg_spi_dma_poll_ns_set (am_spi_handle_t handle, uint32_t poll_ns);
+
 /**
  * @}
  */
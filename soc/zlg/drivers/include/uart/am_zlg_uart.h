@@ -28,6 +28,8 @@ extern "C" {
 #endif
 
 #include "am_uart.h"
+#include "am_uart_rngbuf.h"
+#include "am_zlg_dma.h"
 #include "hw/amhw_zlg_uart.h"
 
 /**
@@ -119,10 +121,25 @@ typedef struct am_zlg_uart_dev {
 
     am_bool_t rs485_en;                     /**< \brief Ƿʹ 485 ģʽ */
 
+    /** \brief DMA 豸δʹ DMA ʱΪ NULL */
+    struct am_zlg_uart_dma_rx   *p_dma_rx;
+
     const am_zlg_uart_devinfo_t *p_devinfo; /**< \brief ָ豸Ϣָ */
 
 } am_zlg_uart_dev_t;
 
+/**
+ * \brief  DMA ѭ豸 am_uart_rngbuf  DMA ģʽ
+ */
+typedef struct am_zlg_uart_dma_rx {
+    am_zlg_uart_dev_t              *p_uart_dev; /**< \brief 豸     */
+    int                             dma_chan;   /**< \brief DMA ͨ   */
+    uint32_t                        size;       /**< \brief ջС */
+    amhw_zlg_dma_xfer_desc_t        desc;       /**< \brief DMA  */
+    am_uart_rngbuf_dma_rx_notify_t  pfn_notify; /**< \brief ֪ͨ     */
+    void                           *p_arg;      /**< \brief ֪ͨ */
+} am_zlg_uart_dma_rx_t;
+
 /**
  * \brief ʼUARTUART׼
  *
@@ -141,6 +158,31 @@ am_uart_handle_t am_zlg_uart_init(am_zlg_uart_dev_t              *p_dev,
  */
 void am_zlg_uart_deinit (am_zlg_uart_dev_t *p_dev);
 
+/**
+ * \brief ʹ UARTring bufferжģʽʹ DMA ѭ
+ *
+ *     DMA ѭʽֱӽдջλɣƣճʱ
+ * ߿УʱݣֽڲжϡջС
+ *  32768 ֽڡ
+ *
+ * \param[in] rngbuf_handle : UARTring bufferжģʽ׼
+ *                             p_uart_dev Ӧ UART ׼ʼ
+ * \param[in] p_dma_rx      :  DMA ѭ豸
+ * \param[in] p_uart_dev    : 豸
+ * \param[in] dma_chan      : ڽնӦ DMA ͨ
+ *
+ * \retval AM_OK      : ʹܳɹ
+ * \retval -AM_EINVAL : 
+ * \retval -AM_EPERM  : DMA ͨжѱռ
+ * \retval -AM_EIO    : DMA ͨʧ
+ *
+ * \note  am_uart_rngbuf_dma_rx_disable() ɻָΪֽжϽ
+ */
+int am_zlg_uart_rngbuf_dma_rx_enable (am_uart_rngbuf_handle_t  rngbuf_handle,
+                                      am_zlg_uart_dma_rx_t    *p_dma_rx,
+                                      am_zlg_uart_dev_t       *p_uart_dev,
+                                      int                      dma_chan);
+
 /**
  * @}
  */
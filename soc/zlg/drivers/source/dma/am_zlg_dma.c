@@ -162,6 +162,16 @@ int am_zlg_dma_xfer_desc_chan_cfg (amhw_zlg_dma_xfer_desc_t      *p_desc,
     return AM_OK;
 }
 
+/* ͨȫжϱ־ */
+static void __dma_chan_flag_clear (amhw_zlg_dma_t *p_hw_dma, int chan)
+{
+    amhw_zlg_dma_chan_flag_clear(p_hw_dma,
+                                 AMHW_ZLG_DMA_CHAN_GLOBAL_INT_FLAG(chan) |
+                                 AMHW_ZLG_DMA_CHAN_TX_COMP_FLAG(chan)    |
+                                 AMHW_ZLG_DMA_CHAN_TX_HALF_FLAG(chan)    |
+                                 AMHW_ZLG_DMA_CHAN_TX_ERR_FLAG(chan));
+}
+
 /* ֹͣͨ */
 int am_zlg_dma_chan_start (int chan)
 {
@@ -169,9 +179,19 @@ int am_zlg_dma_chan_start (int chan)
 
     amhw_zlg_dma_t *p_hw_dma = (amhw_zlg_dma_t *)p_dma_devinfo->dma_reg_base;
 
-    amhw_zlg_dma_chan_int_enable(p_hw_dma,
-                                 AMHW_ZLG_DMA_CHAN_INT_TX_CMP_MASK,
-                                 chan);
+    /* ϴδı־ʹжϺ󱨴 */
+    __dma_chan_flag_clear(p_hw_dma, chan);
+
+    /* δжϷֻͨѯʣֽķͨж */
+    if (__dma_int_map[chan] != __INT_NOT_CONNECTED) {
+        amhw_zlg_dma_chan_int_enable(p_hw_dma,
+                                     AMHW_ZLG_DMA_CHAN_INT_TX_CMP_MASK,
+                                     chan);
+    } else {
+        amhw_zlg_dma_chan_int_disable(p_hw_dma,
+                                      AMHW_ZLG_DMA_CHAN_INT_TX_CMP_MASK,
+                                      chan);
+    }
     amhw_zlg_dma_chan_enable(p_hw_dma, chan, AM_TRUE);
 
     return AM_OK;
@@ -189,6 +209,9 @@ int am_zlg_dma_chan_stop (int chan)
                                   chan);
     amhw_zlg_dma_chan_enable(p_hw_dma, chan, AM_FALSE);
 
+    /* жϴͨɱ־ֹͣͨӦ־ */
+    __dma_chan_flag_clear(p_hw_dma, chan);
+
     return AM_OK;
 }
 
@@ -206,6 +229,12 @@ static void __dma_int_handler (void *p_arg)
     void                  *p_isr_arg;
 
     for (i = 0 ; i < AMHW_ZLG_DMA_CHAN_CNT ; i++) {
+
+        /* δӵͨûʹжϣɱ־´ʱ */
+        if (__dma_int_map[i] == __INT_NOT_CONNECTED) {
+            continue;
+        }
+
         if (amhw_zlg_dma_chan_stat_check(p_hw_dma , AMHW_ZLG_DMA_CHAN_TX_COMP_FLAG(i))) {
             if (amhw_zlg_dma_chan_stat_check(p_hw_dma , AMHW_ZLG_DMA_CHAN_TX_HALF_FLAG(i))) {
                 amhw_zlg_dma_chan_flag_clear(p_hw_dma, AMHW_ZLG_DMA_CHAN_TX_HALF_FLAG(i));
@@ -28,6 +28,7 @@
 #include "ametal.h"
 #include "am_clk.h"
 #include "am_int.h"
+#include "am_system.h"
 #include "am_zlg_i2c.h"
 #include "hw/amhw_zlg_i2c.h"
 
@@ -143,6 +144,25 @@ am_local int __i2c_hard_re_init (am_zlg_i2c_dev_t *p_dev)
     return __i2c_hard_init(p_dev);
 }
 
+/** \brief ³ʼ I2C Ӳôӻַ7λ */
+am_local void __i2c_tar_set (am_zlg_i2c_dev_t *p_dev, uint16_t addr)
+{
+    amhw_zlg_i2c_t *p_hw_i2c = (amhw_zlg_i2c_t *)p_dev->p_devinfo->i2c_regbase;
+
+    __i2c_hard_re_init(p_dev);
+
+    amhw_zlg_i2c_disable(p_hw_i2c);
+
+    /* 豸ַ */
+    amhw_zlg_i2c_tar_set(p_hw_i2c, addr);
+
+    /* 7bitַʽ */
+    amhw_zlg_i2c_con_clear(p_hw_i2c,
+                           AMHW_ZLG_I2C_7BITADDR_MASTER);
+
+    amhw_zlg_i2c_enable(p_hw_i2c);
+}
+
 /**
  * \brief ³ʼ I2C
  *
@@ -368,10 +388,176 @@ static void __i2c_irq_handler (void *p_arg)
 
 /******************************************************************************/
 
+/**
+ * \brief жϢǷѯͨ
+ *
+ * д䣨ӻַֽڣϴʱ֮Ͳѯֵʱ AM_TRUE
+ * ֻͬһ 7 λַӻϢϢԽ״̬
+ */
+am_local am_bool_t __i2c_msg_poll_check (am_zlg_i2c_dev_t *p_dev,
+                                         am_i2c_message_t *p_msg)
+{
+    am_i2c_transfer_t *p_trans;
+    uint32_t           byte_ns;
+    uint32_t           nbytes;
+    uint32_t           wire_ns = 0;
+    uint16_t           i;
+
+    if (p_dev->poll_ns == 0) {
+        return AM_FALSE;
+    }
+
+    /* ÿֽ 8 λݼ 1 λӦ */
+    byte_ns = (1000000000u / p_dev->p_devinfo->speed) * 9;
+
+    for (i = 0; i < p_msg->trans_num; i++) {
+        p_trans = &p_msg->p_transfers[i];
+
+        if ((p_trans->flags & AM_I2C_ADDR_10BIT) ||
+            (p_trans->addr != p_msg->p_transfers[0].addr) ||
+            (p_trans->nbytes == 0)) {
+            return AM_FALSE;
+        }
+
+        nbytes = p_trans->nbytes + 1;
+        if (nbytes > (p_dev->poll_ns - wire_ns) / byte_ns) {
+            return AM_FALSE;
+        }
+        wire_ns += nbytes * byte_ns;
+    }
+
+    return AM_TRUE;
+}
+
+/**
+ * \brief ѯȴ״̬־ic_statusԭʼжϱ־λ
+ *
+ * \retval  AM_OK        : ־λ
+ * \retval -AM_EIO       : ֹӻӦ
+ * \retval -AM_ETIMEDOUT : ʱ
+ */
+am_local int __i2c_poll_wait (am_zlg_i2c_dev_t *p_dev,
+                              uint32_t          status,
+                              uint32_t          intr,
+                              am_tick_t         start)
+{
+    amhw_zlg_i2c_t *p_hw_i2c   = (amhw_zlg_i2c_t *)p_dev->p_devinfo->i2c_regbase;
+    uint32_t        timeout_ms = p_dev->p_devinfo->timeout_ms;
+    uint32_t        raw;
+
+    while (1) {
+        raw = amhw_zlg_i2c_raw_intr_stat_get(p_hw_i2c);
+
+        if (raw & AMHW_ZLG_INT_FLAG_TX_ABRT) {
+            return -AM_EIO;
+        }
+
+        if ((raw & intr) ||
+            (amhw_zlg_i2c_status_get(p_hw_i2c) & status)) {
+            return AM_OK;
+        }
+
+        if ((timeout_ms != 0) &&
+            (am_ticks_to_ms(am_sys_tick_get() - start) > timeout_ms)) {
+            return -AM_ETIMEDOUT;
+        }
+    }
+}
+
+/**
+ * \brief ѯʽͬһϢ
+ *
+ * һֽڸֹͣȴֹͣϢɻصʱ
+ * 볬ʱͬ³ʼָߡǰѱϢ
+ * ռbusy λ
+ */
+am_local void __i2c_msg_poll (am_zlg_i2c_dev_t *p_dev, am_i2c_message_t *p_msg)
+{
+    amhw_zlg_i2c_t    *p_hw_i2c = (amhw_zlg_i2c_t *)p_dev->p_devinfo->i2c_regbase;
+    am_i2c_transfer_t *p_trans;
+    am_i2c_transfer_t *p_end    = p_msg->p_transfers + p_msg->trans_num;
+    am_tick_t          start    = am_sys_tick_get();
+    uint32_t           cmd;
+    uint32_t           i;
+    int                ret      = AM_OK;
+
+    p_dev->p_cur_msg  = p_msg;
+    p_msg->status     = -AM_EINPROGRESS;
+    p_msg->done_num   = 0;
+
+    if (p_msg->p_transfers[0].addr != p_dev->slave_addr) {
+        __i2c_tar_set(p_dev, p_msg->p_transfers[0].addr);
+    }
+
+    /* һϢֹֹͣ־ */
+    amhw_zlg_i2c_clr_intr_get(p_hw_i2c);
+
+    for (p_trans = p_msg->p_transfers;
+         (p_trans < p_end) && (ret == AM_OK);
+         p_trans++) {
+
+        for (i = 0; i < p_trans->nbytes; i++) {
+
+            if (p_trans->flags & AM_I2C_M_RD) {
+                cmd = 0x0100;
+            } else {
+                cmd = p_trans->p_buf[i];
+            }
+
+            /* һֽڷͺֹͣ */
+            if ((p_trans == p_end - 1) && (i == p_trans->nbytes - 1)) {
+                cmd |= 0x0200;
+            }
+
+            ret = __i2c_poll_wait(p_dev, AMHW_ZLG_STATUS_FLAG_TFNF, 0, start);
+            if (ret != AM_OK) {
+                break;
+            }
+
+            amhw_zlg_i2c_dat_write(p_hw_i2c, cmd);
+
+            if (p_trans->flags & AM_I2C_M_RD) {
+                ret = __i2c_poll_wait(p_dev, AMHW_ZLG_STATUS_FLAG_RFNE, 0, start);
+                if (ret != AM_OK) {
+                    break;
+                }
+                p_trans->p_buf[i] = amhw_zlg_i2c_dat_read(p_hw_i2c);
+            }
+        }
+
+        if (ret == AM_OK) {
+            p_msg->done_num++;
+        }
+    }
+
+    if (ret == AM_OK) {
+        ret = __i2c_poll_wait(p_dev, 0, AMHW_ZLG_INT_FLAG_STOP_DET, start);
+    }
+
+    if (ret == AM_OK) {
+        p_dev->slave_addr = p_msg->p_transfers[0].addr;
+        amhw_zlg_i2c_clr_intr_get(p_hw_i2c);
+    } else {
+        p_dev->slave_addr = 0;
+        __i2c_hard_re_init(p_dev);
+
+        if (p_dev->p_devinfo->pfn_bus_clean) {
+            p_dev->p_devinfo->pfn_bus_clean();
+        }
+    }
+
+    p_msg->status = ret;
+
+    if (p_msg->pfn_complete != NULL) {
+        p_msg->pfn_complete(p_msg->p_arg);
+    }
+}
+
 static int __i2c_msg_start (void *p_drv, am_i2c_message_t *p_msg)
 {
     am_zlg_i2c_dev_t *p_dev    = (am_zlg_i2c_dev_t *)p_drv;
     amhw_zlg_i2c_t   *p_hw_i2c = (amhw_zlg_i2c_t *)p_dev->p_devinfo->i2c_regbase;
+    am_bool_t         is_poll;
     int key;
 
     if ( (p_dev              == NULL) ||
@@ -382,6 +568,8 @@ static int __i2c_msg_start (void *p_drv, am_i2c_message_t *p_msg)
         return -AM_EINVAL;
     }
 
+    is_poll = __i2c_msg_poll_check(p_dev, p_msg);
+
     key = am_int_cpu_lock();
 
     /* ǰڴϢֻҪµϢ */
@@ -393,6 +581,31 @@ static int __i2c_msg_start (void *p_drv, am_i2c_message_t *p_msg)
 
         return AM_OK;
 
+    } else if (is_poll) {
+
+        /*
+         * ҶΪգϢֱѯʽɡڼжύ
+         * ϢڱϢ֮ɺ״̬
+         */
+        p_dev->busy = AM_TRUE;
+        am_int_cpu_unlock(key);
+
+        __i2c_msg_poll(p_dev, p_msg);
+
+        key = am_int_cpu_lock();
+        if (am_list_empty(&(p_dev->msg_list))) {
+            p_dev->p_cur_msg = NULL;
+            p_dev->busy      = AM_FALSE;
+            am_int_cpu_unlock(key);
+            return AM_OK;
+        }
+        am_int_cpu_unlock(key);
+
+        /* ж */
+        amhw_zlg_i2c_intr_mask_clear(p_hw_i2c, 0xfff);
+
+        return __i2c_mst_sm_event(p_dev, __I2C_EVT_MSG_LAUNCH);
+
     } else {
         p_dev->busy = AM_TRUE;
         __i2c_msg_in(p_dev, p_msg);
@@ -440,6 +653,7 @@ am_i2c_handle_t am_zlg_i2c_init (am_zlg_i2c_dev_t           *p_dev,
     }
 
     p_dev->is_abort = AM_FALSE;
+    p_dev->poll_ns  = AM_ZLG_I2C_POLL_NS;
 
     if (p_devinfo->pfn_plfm_init) {
         p_devinfo->pfn_plfm_init();
@@ -493,6 +707,24 @@ void am_zlg_i2c_deinit (am_i2c_handle_t handle)
     }
 }
 
+/**
+ * \brief ѯֵͨ
+ */
+uint32_t am_zlg_i2c_poll_ns_set (am_i2c_handle_t handle, uint32_t poll_ns)
+{
+    am_zlg_i2c_dev_t *p_dev = (am_zlg_i2c_dev_t *)handle;
+    uint32_t          old;
+
+    if (NULL == p_dev) {
+        return 0;
+    }
+
+    old            = p_dev->poll_ns;
+    p_dev->poll_ns = poll_ns;
+
+    return old;
+}
+
 /******************************************************************************/
 
 /*  ״̬ڲ״̬л */
@@ -694,18 +926,7 @@ static int __i2c_mst_sm_event (am_zlg_i2c_dev_t *p_dev, uint32_t event)
             }
 
             if (p_cur_trans->addr != p_dev->slave_addr) {
-                __i2c_hard_re_init(p_dev);
-
-                amhw_zlg_i2c_disable(p_hw_i2c);
-
-                /* 豸ַ */
-                amhw_zlg_i2c_tar_set(p_hw_i2c, p_cur_trans->addr);
-
-                /* 7bitַʽ */
-                amhw_zlg_i2c_con_clear(p_hw_i2c,
-                                       AMHW_ZLG_I2C_7BITADDR_MASTER);
-
-                amhw_zlg_i2c_enable(p_hw_i2c);
+                __i2c_tar_set(p_dev, p_cur_trans->addr);
             }
 
             amhw_zlg_i2c_intr_mask_set(p_hw_i2c,
@@ -22,8 +22,98 @@
 
 #include "am_clk.h"
 #include "am_gpio.h"
+#include "am_zlg_dma.h"
 #include "am_zlg_ili9341_3wire_spi.h"
 
+/**
+ * \brief һֽڱΪ9λ֡ռֽ
+ *
+ * SPI λȷͣȷ͵һλ/ѡλΪλǰݡ
+ */
+am_static_inline
+void __zlg_ili9341_3wire_frame_encode (uint8_t *p_out, uint8_t data, uint8_t is_data)
+{
+    uint32_t temp;
+
+    /* ʽ */
+    data = ( data >> 4) | ( data << 4 );
+    data = ((data >> 2) & 0X33) | ( (data << 2) & 0XCC);
+    data = ((data >> 1) & 0X55) | ( (data << 1) & 0XAA);
+
+    temp = ((uint32_t)data << 1) | is_data;
+
+    p_out[0] = (uint8_t)temp;
+    p_out[1] = (uint8_t)(temp >> 8);
+}
+
+/**
+ * \brief  count 16λݱ뵽 p_outÿռ4ֽ
+ */
+static void __zlg_ili9341_3wire_u16_encode (uint8_t        *p_out,
+                                            const uint16_t *p_buf,
+                                            uint32_t        count)
+{
+    while (count--) {
+        __zlg_ili9341_3wire_frame_encode(p_out,     (uint8_t)(*p_buf >> 8), 1);
+        __zlg_ili9341_3wire_frame_encode(p_out + 2, (uint8_t)(*p_buf),      1);
+        p_out += 4;
+        p_buf++;
+    }
+}
+
+/**
+ * \brief ѯʽͱݣֻڷ FIFO ʱȴ
+ */
+static void __zlg_ili9341_3wire_bytes_write (amhw_zlg_spi_t *p_hw_spi,
+                                             const uint8_t  *p_data,
+                                             uint32_t        nbytes)
+{
+    while (nbytes--) {
+        while (amhw_zlg_spi_reg_cstat_get(p_hw_spi) &
+               AMHW_ZLG_SPI_CSTAT_TX_FULL);
+        amhw_zlg_spi_tx_data8_put(p_hw_spi, *p_data++);
+    }
+}
+
+/**
+ * \brief  DMA ͱ
+ */
+static void __zlg_ili9341_3wire_dma_start (am_zlg_ili9341_intfc_3wire_dev_t *p_dev,
+                                           const uint8_t                    *p_data,
+                                           uint32_t                          nbytes)
+{
+    const am_zlg_ili9341_intfc_3wire_devinfo_t *p_devinfo = p_dev->p_devinfo;
+    amhw_zlg_dma_xfer_desc_t                    desc;
+
+    /* ͨʹʱ޸Ĵֹͣһδ */
+    am_zlg_dma_chan_stop(p_devinfo->dma_chan_tx);
+
+    am_zlg_dma_xfer_desc_build(&desc,
+                               (uint32_t)p_data,
+                               (uint32_t)(&(p_devinfo->spi_reg_base->txreg)),
+                               nbytes,
+                               AMHW_ZLG_DMA_CHAN_PRIORITY_HIGH         |
+                               AMHW_ZLG_DMA_CHAN_MEM_SIZE_8BIT         |
+                               AMHW_ZLG_DMA_CHAN_PER_SIZE_8BIT         |
+                               AMHW_ZLG_DMA_CHAN_MEM_ADD_INC_ENABLE    |
+                               AMHW_ZLG_DMA_CHAN_PER_ADD_INC_DISABLE   |
+                               AMHW_ZLG_DMA_CHAN_CIRCULAR_MODE_DISABLE);
+
+    am_zlg_dma_xfer_desc_chan_cfg(&desc,
+                                  AMHW_ZLG_DMA_MER_TO_PER,
+                                  p_devinfo->dma_chan_tx);
+
+    am_zlg_dma_chan_start(p_devinfo->dma_chan_tx);
+}
+
+/**
+ * \brief ȴ DMA ȫд뷢 FIFO
+ */
+static void __zlg_ili9341_3wire_dma_wait (am_zlg_ili9341_intfc_3wire_dev_t *p_dev)
+{
+    while (am_zlg_dma_tran_data_get(p_dev->p_devinfo->dma_chan_tx) != 0);
+}
+
 /**
  * \brief 8λ
  */
@@ -32,21 +122,16 @@ static  int __zlg_ili9341_3wire_cmd_write (void *p_drv, uint8_t cmd)
     amhw_zlg_spi_t *p_spi_reg_base  =
       (( am_zlg_ili9341_intfc_3wire_dev_t *) p_drv)->p_devinfo->spi_reg_base;
 
-    uint32_t temp = 0;
-
-    /* ʽ */
-    cmd = ( cmd >> 4) | ( cmd << 4 );
-    cmd = ((cmd >> 2) & 0X33) | ( (cmd << 2) & 0XCC);
-    cmd = ((cmd >> 1) & 0X55) | ( (cmd << 1) & 0XAA);
+    uint8_t frame[2];
 
-    temp = cmd;
     /*  */
-    temp <<=1 ;
+    __zlg_ili9341_3wire_frame_encode(frame, cmd, 0);
 
     /* д */
-    p_spi_reg_base->txreg = temp;
-    p_spi_reg_base->txreg = temp >> 8;
-    while ( 0 == ( p_spi_reg_base->cstat & 0x01) );
+    amhw_zlg_spi_tx_data8_put(p_spi_reg_base, frame[0]);
+    amhw_zlg_spi_tx_data8_put(p_spi_reg_base, frame[1]);
+    while (0 == (amhw_zlg_spi_reg_cstat_get(p_spi_reg_base) &
+                 AMHW_ZLG_SPI_CSTAT_TX_EMPTY));
 
     return AM_OK;
 }
@@ -59,21 +144,16 @@ static int __zlg_ili9341_3wire_data_u8_write (void *p_drv,uint8_t data)
     amhw_zlg_spi_t *p_spi_reg_base = (( am_zlg_ili9341_intfc_3wire_dev_t *) \
                        p_drv)->p_devinfo->spi_reg_base;
 
-   uint32_t temp = 0;
+    uint8_t frame[2];
 
-   /* ʽ */
-   data = ( data >> 4) | ( data << 4 );
-   data = ((data >> 2) & 0X33) | ( (data << 2) & 0XCC);
-   data = ((data >> 1) & 0X55) | ( (data << 1) & 0XAA);
-
-   temp = data;
-   /*  */
-    temp = ( temp << 1 ) | 0X1 ;
+    /*  */
+    __zlg_ili9341_3wire_frame_encode(frame, data, 1);
 
     /* д */
-    p_spi_reg_base->txreg = temp;
-    p_spi_reg_base->txreg = temp >> 8;
-    while ( 0 == ( p_spi_reg_base->cstat & 0x01) );
+    amhw_zlg_spi_tx_data8_put(p_spi_reg_base, frame[0]);
+    amhw_zlg_spi_tx_data8_put(p_spi_reg_base, frame[1]);
+    while (0 == (amhw_zlg_spi_reg_cstat_get(p_spi_reg_base) &
+                 AMHW_ZLG_SPI_CSTAT_TX_EMPTY));
 
     return AM_OK;
 }
@@ -86,37 +166,142 @@ static int __zlg_ili9341_3wire_data_u16_write(void *p_drv,uint16_t data)
     amhw_zlg_spi_t *p_spi_reg_base = (( am_zlg_ili9341_intfc_3wire_dev_t *) \
                        p_drv)->p_devinfo->spi_reg_base;
 
-    uint32_t temp = 0;
-    uint8_t data1 = (uint8_t)(data >> 8);
-    uint8_t data2 = (uint8_t) data;
+    uint8_t frame[4];
 
-    /* ʽ */
-    data1 = ( data1 >> 4) | ( data1 << 4 );
-    data1 = ((data1 >> 2) & 0X33) | ( (data1 << 2) & 0XCC);
-    data1 = ((data1 >> 1) & 0X55) | ( (data1 << 1) & 0XAA);
-
-    temp = data1;
-    /*  */
-    temp = ( temp << 1 ) | 0X1 ;
+    __zlg_ili9341_3wire_u16_encode(frame, &data, 1);
 
     /* д */
-    p_spi_reg_base->txreg = temp;
-    p_spi_reg_base->txreg = temp >> 8;
-    while ( 0 == ( p_spi_reg_base->cstat & 0x01) );
+    amhw_zlg_spi_tx_data8_put(p_spi_reg_base, frame[0]);
+    amhw_zlg_spi_tx_data8_put(p_spi_reg_base, frame[1]);
+    while (0 == (amhw_zlg_spi_reg_cstat_get(p_spi_reg_base) &
+                 AMHW_ZLG_SPI_CSTAT_TX_EMPTY));
 
-    /* ʽ */
-    data2 = ( data2 >> 4) | ( data2 << 4 );
-    data2 = ((data2 >> 2) & 0X33) | ( (data2 << 2) & 0XCC);
-    data2 = ((data2 >> 1) & 0X55) | ( (data2 << 1) & 0XAA);
+    amhw_zlg_spi_tx_data8_put(p_spi_reg_base, frame[2]);
+    amhw_zlg_spi_tx_data8_put(p_spi_reg_base, frame[3]);
+    while (0 == (amhw_zlg_spi_reg_cstat_get(p_spi_reg_base) &
+                 AMHW_ZLG_SPI_CSTAT_TX_EMPTY));
 
-    temp = data2; /* Ҫtemp */
-    /*  */
-    temp = ( temp << 1 ) | 0X1 ;
+    return AM_OK;
+}
 
-    /* д */
-    p_spi_reg_base->txreg = temp;
-    p_spi_reg_base->txreg = temp >> 8;
-    while ( 0 == ( p_spi_reg_base->cstat & 0x01) );
+/**
+ * \brief Ͷ16λ
+ *
+ * ݷֿ룬ʹ DMA ʱһͬʱһ飬ֻڷ FIFO ʱ
+ * ȴַʽ֡ȴɡ
+ */
+static int __zlg_ili9341_3wire_data_u16_write_buf (void           *p_drv,
+                                                   const uint16_t *p_buf,
+                                                   uint32_t        count)
+{
+    am_zlg_ili9341_intfc_3wire_dev_t *p_dev    = (am_zlg_ili9341_intfc_3wire_dev_t *)p_drv;
+    amhw_zlg_spi_t                   *p_hw_spi = p_dev->p_devinfo->spi_reg_base;
+
+    am_bool_t use_dma = (p_dev->p_devinfo->dma_chan_tx >= 0) ? AM_TRUE : AM_FALSE;
+    am_bool_t dma_run = AM_FALSE;
+    uint32_t  idx     = 0;
+    uint32_t  n;
+
+    if (NULL == p_buf) {
+        return -AM_EINVAL;
+    }
+
+    if (use_dma) {
+        amhw_zlg_spi_dma_enable(p_hw_spi, AM_TRUE);
+    }
+
+    while (count > 0) {
+        n = (count > AM_ZLG_ILI9341_3WIRE_BUF_PIXELS) ?
+            AM_ZLG_ILI9341_3WIRE_BUF_PIXELS : count;
+
+        __zlg_ili9341_3wire_u16_encode(p_dev->buf[idx], p_buf, n);
+
+        if (use_dma) {
+            if (dma_run) {
+                __zlg_ili9341_3wire_dma_wait(p_dev);
+            }
+            __zlg_ili9341_3wire_dma_start(p_dev, p_dev->buf[idx], n * 4);
+            dma_run = AM_TRUE;
+            idx ^= 1;
+        } else {
+            __zlg_ili9341_3wire_bytes_write(p_hw_spi, p_dev->buf[idx], n * 4);
+        }
+
+        p_buf += n;
+        count -= n;
+    }
+
+    if (dma_run) {
+        __zlg_ili9341_3wire_dma_wait(p_dev);
+        am_zlg_dma_chan_stop(p_dev->p_devinfo->dma_chan_tx);
+    }
+
+    if (use_dma) {
+        amhw_zlg_spi_dma_enable(p_hw_spi, AM_FALSE);
+    }
+
+    while (0 == (amhw_zlg_spi_reg_cstat_get(p_hw_spi) &
+
+                 AMHW_ZLG_SPI_CSTAT_TX_EMPTY));
+
+    return AM_OK;
+}
+
+/**
+ * \brief ظͶͬ16λ
+ *
+ * ֻһ飬֮ظ͸ÿ顣
+ */
+static int __zlg_ili9341_3wire_data_u16_fill (void *p_drv, uint16_t data, uint32_t count)
+{
+    am_zlg_ili9341_intfc_3wire_dev_t *p_dev    = (am_zlg_ili9341_intfc_3wire_dev_t *)p_drv;
+    amhw_zlg_spi_t                   *p_hw_spi = p_dev->p_devinfo->spi_reg_base;
+
+    am_bool_t use_dma = (p_dev->p_devinfo->dma_chan_tx >= 0) ? AM_TRUE : AM_FALSE;
+    uint32_t  i;
+    uint32_t  n;
+
+    if (count == 0) {
+        return AM_OK;
+    }
+
+    n = (count > AM_ZLG_ILI9341_3WIRE_BUF_PIXELS) ?
+        AM_ZLG_ILI9341_3WIRE_BUF_PIXELS : count;
+
+    __zlg_ili9341_3wire_u16_encode(p_dev->buf[0], &data, 1);
+    for (i = 1; i < n; i++) {
+        p_dev->buf[0][i * 4 + 0] = p_dev->buf[0][0];
+        p_dev->buf[0][i * 4 + 1] = p_dev->buf[0][1];
+        p_dev->buf[0][i * 4 + 2] = p_dev->buf[0][2];
+        p_dev->buf[0][i * 4 + 3] = p_dev->buf[0][3];
+    }
+
+    if (use_dma) {
+        amhw_zlg_spi_dma_enable(p_hw_spi, AM_TRUE);
+    }
+
+    while (count > 0) {
+        n = (count > AM_ZLG_ILI9341_3WIRE_BUF_PIXELS) ?
+            AM_ZLG_ILI9341_3WIRE_BUF_PIXELS : count;
+
+        if (use_dma) {
+            __zlg_ili9341_3wire_dma_start(p_dev, p_dev->buf[0], n * 4);
+            __zlg_ili9341_3wire_dma_wait(p_dev);
+        } else {
+            __zlg_ili9341_3wire_bytes_write(p_hw_spi, p_dev->buf[0], n * 4);
+        }
+
+        count -= n;
+    }
+
+    if (use_dma) {
+        am_zlg_dma_chan_stop(p_dev->p_devinfo->dma_chan_tx);
+        amhw_zlg_spi_dma_enable(p_hw_spi, AM_FALSE);
+    }
+
+    while (0 == (amhw_zlg_spi_reg_cstat_get(p_hw_spi) &
+
+                 AMHW_ZLG_SPI_CSTAT_TX_EMPTY));
 
     return AM_OK;
 }
@@ -127,6 +312,8 @@ static struct am_ili9341_drv_funcs __g_ili9341_funcs = {
         __zlg_ili9341_3wire_data_u16_write,
         NULL,
         NULL,
+        __zlg_ili9341_3wire_data_u16_write_buf,
+        __zlg_ili9341_3wire_data_u16_fill,
 };
 
 /**
@@ -28,6 +28,7 @@ includes
 #include "am_int.h"
 #include "am_gpio.h"
 #include "am_clk.h"
+#include "am_delay.h"
 #include "am_zlg_dma.h"
 #include "hw/amhw_zlg_spi.h"
 #include "am_zlg_spi_dma.h"
@@ -309,179 +310,260 @@ int __spi_hard_init (am_zlg_spi_dma_dev_t *p_this)
     amhw_zlg_spi_rx_enable(p_hw_spi, AM_TRUE);
     amhw_zlg_spi_module_enable(p_hw_spi, AM_TRUE);
 
-    amhw_zlg_spi_int_open(p_hw_spi, AM_TRUE);
-    amhw_zlg_spi_int_enable(p_hw_spi, AMHW_ZLG_SPI_INTSTAT_TXEPT_FALG);
-
     return AM_OK;
 }
 
+/**
+ * \brief ݵԪһ֡ڻռãֽ
+ */
+am_static_inline
+uint32_t __spi_word_size (uint8_t bits_per_word)
+{
+    return (bits_per_word <= 8) ? 1 : ((bits_per_word <= 16) ? 2 : 4);
+}
+
+/**
+ * \brief 鴫δõĲʹ豸Ĭֵ
+ */
 am_local
-void __spi_isr (void *p_arg)
+int __spi_trans_check (am_zlg_spi_dma_dev_t *p_this,
+                       am_spi_transfer_t    *p_trans)
 {
-    am_zlg_spi_dma_dev_t *p_dev    = (am_zlg_spi_dma_dev_t *)p_arg;
-    amhw_zlg_spi_t       *p_hw_spi = (amhw_zlg_spi_t *)(p_dev->p_devinfo->spi_reg_base);
+    /* Ϊ0ʹĬϲֵ */
+    if (p_trans->bits_per_word == 0) {
+        p_trans->bits_per_word = p_this->p_cur_spi_dev->bits_per_word;
+    }
 
-    uint32_t spi_status = (uint32_t)amhw_zlg_spi_reg_cstat_get(p_hw_spi);
+    if (p_trans->speed_hz == 0) {
+        p_trans->speed_hz = p_this->p_cur_spi_dev->max_speed_hz;
+    }
 
-    /* ж */
-    if((spi_status & AMHW_ZLG_SPI_CSTAT_TX_EMPTY)) {
-        amhw_zlg_spi_int_flag_clr(p_hw_spi, AMHW_ZLG_SPI_INTSTAT_TXEPT_FALG);
+    /* ֽЧԼ */
+    if (p_trans->bits_per_word > 32 || p_trans->bits_per_word < 1) {
+        return -AM_EINVAL;
+    }
 
-        if ((p_dev != NULL) &&
-            (p_dev->p_isr_msg != NULL) &&
-            (p_dev->p_isr_msg->pfn_complete != NULL)) {
-            p_dev->p_isr_msg->pfn_complete(p_dev->p_isr_msg->p_arg);
-        }
+    /* ÷ƵֵЧԼ */
+    if (p_trans->speed_hz > __SPI_MAXSPEED_GET(p_hw_spi) ||
+        p_trans->speed_hz < __SPI_MINSPEED_GET(p_hw_spi)) {
+        return -AM_EINVAL;
+    }
+
+    /* ͺͽջЧԼ */
+    if ((p_trans->p_txbuf == NULL) && (p_trans->p_rxbuf == NULL)) {
+        return -AM_EINVAL;
+    }
 
-        /* Ƭѡر */
-        __spi_cs_off(p_dev, p_dev->p_cur_spi_dev);
+    /* ֽ */
+    if (p_trans->nbytes == 0) {
+        return -AM_ELOW;
+    }
 
-        p_dev->busy = AM_FALSE;
+    /* ֽΪݵԪҲ DMA δĳ */
+    if ((p_trans->nbytes % __spi_word_size(p_trans->bits_per_word) != 0) ||
+        (p_trans->nbytes > 0xFFFF)) {
+        return -AM_EINVAL;
     }
+
+    return AM_OK;
 }
 
+/**
+ * \brief һ DMA ݿݵԪһ
+ */
 am_local
-void __dma_isr (void *p_arg, uint32_t stat)
+void __spi_link_build (am_zlg_spi_dma_dev_t  *p_this,
+                       am_zlg_spi_dma_link_t *p_link,
+                       am_spi_transfer_t     *p_trans)
 {
-    am_zlg_spi_dma_dev_t *p_this   = (am_zlg_spi_dma_dev_t *)p_arg;
+    amhw_zlg_spi_t *p_hw_spi = (amhw_zlg_spi_t *)(p_this->p_devinfo->spi_reg_base);
+    uint32_t        flags;
 
-    /* жϷ */
-    if (stat == AM_ZLG_DMA_INT_NORMAL)
-    {
-        /* ¼ɹֽ */
-        if (p_this->p_cur_trans->p_txbuf != NULL) {
-            p_this->p_cur_msg->actual_length += (p_this->p_cur_trans->nbytes)
-                            *(p_this->p_cur_spi_dev->bits_per_word < 9 ? 1 : 2);
-        }
+    flags = AMHW_ZLG_DMA_CHAN_PRIORITY_HIGH       |  /* жȼ  */
+            AMHW_ZLG_DMA_CHAN_PER_ADD_INC_DISABLE |  /* ַ */
+            AMHW_ZLG_DMA_CHAN_CIRCULAR_MODE_DISABLE; /* رѭģʽ */
 
-        /*  */
-        __spi_mst_sm_event(p_this, __SPI_EVT_TRANS_LAUNCH);
+    /* DMAλ */
+    switch (__spi_word_size(p_trans->bits_per_word)) {
+
+    case 1:
+        flags |= AMHW_ZLG_DMA_CHAN_MEM_SIZE_8BIT |
+                 AMHW_ZLG_DMA_CHAN_PER_SIZE_8BIT;
+        break;
+
+    case 2:
+        flags |= AMHW_ZLG_DMA_CHAN_MEM_SIZE_16BIT |
+                 AMHW_ZLG_DMA_CHAN_PER_SIZE_16BIT;
+        break;
+
+    default:
+        flags |= AMHW_ZLG_DMA_CHAN_MEM_SIZE_32BIT |
+                 AMHW_ZLG_DMA_CHAN_PER_SIZE_32BIT;
+        break;
+    }
+
+    /* ͨ޷ʱظ dummy_tx */
+    if (p_trans->p_txbuf != NULL) {
+        am_zlg_dma_xfer_desc_build(&p_link->desc[0],
+                                    (uint32_t)(p_trans->p_txbuf),
+                                    (uint32_t)(&(p_hw_spi->txreg)),
+                                    p_trans->nbytes,
+                                    flags | AMHW_ZLG_DMA_CHAN_MEM_ADD_INC_ENABLE);
+    } else {
+        am_zlg_dma_xfer_desc_build(&p_link->desc[0],
+                                    (uint32_t)(&p_this->dummy_tx),
+                                    (uint32_t)(&(p_hw_spi->txreg)),
+                                    p_trans->nbytes,
+                                    flags | AMHW_ZLG_DMA_CHAN_MEM_ADD_INC_DISABLE);
+    }
 
+    /* ͨ޽ջʱ dummy_rx */
+    if (p_trans->p_rxbuf != NULL) {
+        am_zlg_dma_xfer_desc_build(&p_link->desc[1],
+                                    (uint32_t)(&(p_hw_spi->rxreg)),
+                                    (uint32_t)(p_trans->p_rxbuf),
+                                    p_trans->nbytes,
+                                    flags | AMHW_ZLG_DMA_CHAN_MEM_ADD_INC_ENABLE);
     } else {
-        /* жԴƥ */
+        am_zlg_dma_xfer_desc_build(&p_link->desc[1],
+                                    (uint32_t)(&(p_hw_spi->rxreg)),
+                                    (uint32_t)(&p_this->dummy_rx),
+                                    p_trans->nbytes,
+                                    flags | AMHW_ZLG_DMA_CHAN_MEM_ADD_INC_DISABLE);
     }
+
+    p_link->p_trans = p_trans;
 }
 
 /**
- * \brief SPI ʹDMA
+ * \brief ϢȡһĴ䣬 DMA 
+ *
+ * ִСһ䲻ͬĴҪ SPIӸô俪ʼһ
+ * 
+ *
+ * \return ĳȣ0ʾϢûд䣬ʾ
  */
 am_local
-int __spi_dma_trans (am_zlg_spi_dma_dev_t *p_dev)
+int __spi_chain_build (am_zlg_spi_dma_dev_t *p_this)
 {
-    am_zlg_spi_dma_dev_t           *p_this      = (am_zlg_spi_dma_dev_t *)p_dev;
-    const am_zlg_spi_dma_devinfo_t *p_devinfo   = p_this->p_devinfo;
-    amhw_zlg_spi_t                 *p_hw_spi    = (amhw_zlg_spi_t *)(p_devinfo->spi_reg_base);
-    am_spi_transfer_t              *p_cur_trans = p_dev->p_cur_trans;
-
-    const void     *p_txbuf     = NULL;
-    static uint16_t tx_rx_trans = 0; 
-    uint32_t   dma_flags[2]     = {0};  /* DMAͨ */
-
-    /* DMAжϷ */
-    am_zlg_dma_isr_connect(p_this->p_devinfo->dma_chan_tx, 
-                           __dma_isr, 
-                           (void *)p_this);
-
-    /* DMAͨ */
-    dma_flags[0] =  AMHW_ZLG_DMA_CHAN_PRIORITY_HIGH         |  /* жȼ  */
-                    AMHW_ZLG_DMA_CHAN_MEM_SIZE_8BIT         |  /* ڴݿ1ֽ */
-                    AMHW_ZLG_DMA_CHAN_PER_SIZE_8BIT         |  /* ݿ1ֽ */
-                    AMHW_ZLG_DMA_CHAN_PER_ADD_INC_DISABLE   |  /* ַ */
-                    AMHW_ZLG_DMA_CHAN_CIRCULAR_MODE_DISABLE ;  /* رѭģʽ */
-
-    /* DMAͨ */
-    dma_flags[1] = AMHW_ZLG_DMA_CHAN_PRIORITY_HIGH         |  /* жȼ  */
-                   AMHW_ZLG_DMA_CHAN_MEM_SIZE_8BIT         |  /* ڴݿ1ֽ */
-                   AMHW_ZLG_DMA_CHAN_PER_SIZE_8BIT         |  /* ݿ1ֽ */
-                   AMHW_ZLG_DMA_CHAN_PER_ADD_INC_DISABLE   |  /* ַ */
-                   AMHW_ZLG_DMA_CHAN_CIRCULAR_MODE_DISABLE ;  /* رѭģʽ */
-
-    /* DMAλ */
-    if (p_cur_trans->bits_per_word > 8) {
-        dma_flags[0] |= AMHW_ZLG_DMA_CHAN_MEM_SIZE_8BIT;
-        dma_flags[0] |= AMHW_ZLG_DMA_CHAN_PER_SIZE_8BIT;
-        dma_flags[1] |= AMHW_ZLG_DMA_CHAN_MEM_SIZE_8BIT;
-        dma_flags[1] |= AMHW_ZLG_DMA_CHAN_PER_SIZE_8BIT;
-    } else {
-        dma_flags[0] |= AMHW_ZLG_DMA_CHAN_MEM_SIZE_8BIT;
-        dma_flags[0] |= AMHW_ZLG_DMA_CHAN_PER_SIZE_8BIT;
-        dma_flags[1] |= AMHW_ZLG_DMA_CHAN_MEM_SIZE_8BIT;
-        dma_flags[1] |= AMHW_ZLG_DMA_CHAN_PER_SIZE_8BIT;
-    }
+    am_spi_message_t  *p_msg   = p_this->p_cur_msg;
+    am_spi_transfer_t *p_first = NULL;
+    am_spi_transfer_t *p_trans;
+    int                n       = 0;
+    int                ret;
+
+    while ((n < AM_ZLG_SPI_DMA_LINK_MAX) &&
+           !am_list_empty(&(p_msg->transfers))) {
+
+        p_trans = am_list_entry(p_msg->transfers.next,
+                                am_spi_transfer_t,
+                                trans_node);
+
+        /* ĴǰĴɺٴ */
+        ret = __spi_trans_check(p_this, p_trans);
+        if (ret != AM_OK) {
+            if (n == 0) {
+                return ret;
+            }
+            break;
+        }
 
-    /* ֻͲ */
-    if (p_cur_trans->p_rxbuf == NULL) {
+        if ((p_first != NULL) &&
+            ((p_trans->bits_per_word != p_first->bits_per_word) ||
+             (p_trans->speed_hz      != p_first->speed_hz))) {
+            break;
+        }
 
-        /* ڴַ */
-        dma_flags[1] |= AMHW_ZLG_DMA_CHAN_MEM_ADD_INC_DISABLE;
+        __spi_link_build(p_this, &p_this->link[n], __spi_trans_out(p_msg));
 
-        /* ͨ */
-        am_zlg_dma_xfer_desc_build(&(p_this->g_desc[1]),            /* ͨ */
-                                    (uint32_t)(&(p_hw_spi->rxreg)), /* Դ׵ַ */
-                                    (uint32_t)(&tx_rx_trans),       /* ĿĻ׵ַ */
-                                     p_cur_trans->nbytes,           /* ֽ */
-                                     dma_flags[1]);                 /*  */
+        if (p_first == NULL) {
+            p_first = p_trans;
+        }
+        n++;
+    }
 
-    /* ڽ */
-    } else {
+    return n;
+}
 
-        /* ڴַ */
-        dma_flags[1] |= AMHW_ZLG_DMA_CHAN_MEM_ADD_INC_ENABLE;
+/**
+ * \brief еһ
+ */
+am_local
+void __spi_link_start (am_zlg_spi_dma_dev_t  *p_this,
+                       am_zlg_spi_dma_link_t *p_link)
+{
+    const am_zlg_spi_dma_devinfo_t *p_devinfo = p_this->p_devinfo;
 
-        /* ͨ */ 
-        am_zlg_dma_xfer_desc_build(&(p_this->g_desc[1]),              /* ͨ */
-                                    (uint32_t)(&(p_hw_spi->rxreg)),   /* Դ׵ַ */
-                                    (uint32_t)(p_cur_trans->p_rxbuf), /* ĿĻ׵ַ */
-                                     p_cur_trans->nbytes,             /* ֽ */
-                                     dma_flags[1]);                   /*  */
-    }
+    /* ͨʹʱ޸Ĵֹͣһʹõͨ */
+    am_zlg_dma_chan_stop(p_devinfo->dma_chan_tx);
+    am_zlg_dma_chan_stop(p_devinfo->dma_chan_rx);
 
-    if (p_cur_trans->p_txbuf == NULL) {
+    am_zlg_dma_xfer_desc_chan_cfg(&p_link->desc[0],
+                                   AMHW_ZLG_DMA_MER_TO_PER,  /* ڴ浽 */
+                                   p_devinfo->dma_chan_tx);
 
-        tx_rx_trans = 0;
-        p_txbuf = &tx_rx_trans;
+    am_zlg_dma_xfer_desc_chan_cfg(&p_link->desc[1],
+                                   AMHW_ZLG_DMA_PER_TO_MER,  /* 赽ڴ */
+                                   p_devinfo->dma_chan_rx);
 
-        /* ڴַ */
-        dma_flags[0] |= AMHW_ZLG_DMA_CHAN_MEM_ADD_INC_DISABLE;
+    /* ͨⶪʧ */
+    am_zlg_dma_chan_start(p_devinfo->dma_chan_rx);
+    am_zlg_dma_chan_start(p_devinfo->dma_chan_tx);
+}
 
-        /* ͨ */
-        am_zlg_dma_xfer_desc_build(&(p_this->g_desc[0]),             /* ͨ */
-                                    (uint32_t)(p_txbuf),             /* Դ׵ַ */
-                                    (uint32_t)(&(p_hw_spi->txreg)),  /* ĿĻ׵ַ */
-                                    p_cur_trans->nbytes,             /* ֽ */
-                                    dma_flags[0]);                   /*  */
-    } else {
-        p_txbuf = p_cur_trans->p_txbuf;
+/**
+ * \brief  DMA ж
+ *
+ * ʱѾȫƳлдʱֱһ䣬
+ * ɺٽ״̬DMA һֻڴװء
+ */
+am_local
+void __dma_isr (void *p_arg, uint32_t stat)
+{
+    am_zlg_spi_dma_dev_t  *p_this  = (am_zlg_spi_dma_dev_t *)p_arg;
+    am_zlg_spi_dma_link_t *p_link  = &p_this->link[p_this->link_idx];
+    am_spi_transfer_t     *p_trans = p_link->p_trans;
 
-        /* ڴַ */
-        dma_flags[0] |= AMHW_ZLG_DMA_CHAN_MEM_ADD_INC_ENABLE;
+    p_this->p_cur_trans = p_trans;
 
-        /* ͨ */
-        am_zlg_dma_xfer_desc_build(&(p_this->g_desc[0]),             /* ͨ */
-                                    (uint32_t)((uint8_t *)p_txbuf),  /* Դ׵ַ */
-                                    (uint32_t)(&(p_hw_spi->txreg)),  /* ĿĻ׵ַ */
-                                    p_cur_trans->nbytes,             /* ֽ */
-                                    dma_flags[0]);                   /*  */
+    if (stat != AM_ZLG_DMA_INT_NORMAL) {
+        p_this->p_cur_msg->status = -AM_EIO;
+        __spi_mst_sm_event(p_this, __SPI_EVT_TRANS_LAUNCH);
+        return;
     }
 
-    if (am_zlg_dma_xfer_desc_chan_cfg(&(p_this->g_desc[0]),
-                                        AMHW_ZLG_DMA_MER_TO_PER,  /* ڴ浽 */
-                                        p_this->p_devinfo->dma_chan_tx) == AM_ERROR) {
-        return AM_ERROR;
+    /* ¼ɹֽ */
+    p_this->p_cur_msg->actual_length += p_trans->nbytes;
+
+    if (p_trans->delay_usecs != 0) {
+        am_udelay(p_trans->delay_usecs);
     }
 
-    if (am_zlg_dma_xfer_desc_chan_cfg(&(p_this->g_desc[1]),
-                                        AMHW_ZLG_DMA_PER_TO_MER,  /* 赽ڴ */
-                                        p_this->p_devinfo->dma_chan_rx) == AM_ERROR) {
-        return AM_ERROR;
+    /* лд䣬ƬѡЧǸôҪıƬѡ */
+    if (++p_this->link_idx < p_this->nlinks) {
+
+        if (p_trans->cs_change) {
+            __spi_cs_off(p_this, p_this->p_cur_spi_dev);
+            __spi_cs_on(p_this, p_this->p_cur_spi_dev);
+        }
+
+        __spi_link_start(p_this, p_link + 1);
+        return;
     }
 
-    am_zlg_dma_chan_start(p_this->p_devinfo->dma_chan_rx);
-    am_zlg_dma_chan_start(p_this->p_devinfo->dma_chan_tx);
+    /* һʼǰѡͨ */
+    if (p_trans->cs_change &&
+        !am_list_empty(&(p_this->p_cur_msg->transfers))) {
+        __spi_cs_off(p_this, p_this->p_cur_spi_dev);
+    }
 
-    return AM_OK;
+    /*  */
+    __spi_mst_sm_event(p_this, __SPI_EVT_TRANS_LAUNCH);
 }
 
+/**
+ * \brief ǰ SPI __spi_trans_check() 
+ */
 am_local
 int __spi_config (am_zlg_spi_dma_dev_t *p_this)
 {
@@ -491,36 +573,6 @@ int __spi_config (am_zlg_spi_dma_dev_t *p_this)
 
     uint32_t  mode_flag = 0;
 
-    /* Ϊ0ʹĬϲֵ */
-    if (p_trans->bits_per_word == 0) {
-        p_trans->bits_per_word = p_this->p_cur_spi_dev->bits_per_word;
-    }
-
-    if (p_trans->speed_hz == 0) {
-        p_trans->speed_hz = p_this->p_cur_spi_dev->max_speed_hz;
-    }
-
-    /* ֽЧԼ */
-    if (p_trans->bits_per_word > 32 || p_trans->bits_per_word < 1) {
-        return -AM_EINVAL;
-    }
-
-    /* ÷ƵֵЧԼ */
-    if (p_trans->speed_hz > __SPI_MAXSPEED_GET(p_hw_spi) ||
-        p_trans->speed_hz < __SPI_MINSPEED_GET(p_hw_spi)) {
-        return -AM_EINVAL;
-    }
-
-    /* ͺͽջЧԼ */
-    if ((p_trans->p_txbuf == NULL) && (p_trans->p_rxbuf == NULL)) {
-        return -AM_EINVAL;
-    }
-
-    /* ֽ */
-    if (p_trans->nbytes == 0) {
-        return -AM_ELOW;
-    }
-
     /**
      * õǰ豸ģʽ
      */
@@ -541,14 +593,16 @@ int __spi_config (am_zlg_spi_dma_dev_t *p_this)
     /* Ϊģʽ */
     amhw_zlg_spi_mode_sel(p_hw_spi, AMHW_ZLG_SPI_MODE_MASTER);
 
-    if (p_this->p_cur_spi_dev->bits_per_word > 8) {
+    if (p_trans->bits_per_word > 8) {
         amhw_zlg_spi_valid_data_sel(p_hw_spi, AMHW_ZLG_SPI_VALID_DATA_32BIT);
         amhw_zlg_spi_first_bit_sel(p_hw_spi, AMHW_ZLG_SPI_DATA_LSB);
-        if (p_this->p_cur_spi_dev->bits_per_word == 32) {
+        if (p_trans->bits_per_word == 32) {
             amhw_zlg_spi_extlen_set(p_hw_spi, 0);
         } else {
-            amhw_zlg_spi_extlen_set(p_hw_spi, p_this->p_cur_spi_dev->bits_per_word);
+            amhw_zlg_spi_extlen_set(p_hw_spi, p_trans->bits_per_word);
         }
+    } else {
+        amhw_zlg_spi_valid_data_sel(p_hw_spi, AMHW_ZLG_SPI_VALID_DATA_8BIT);
     }
 
     if (p_trans->speed_hz > (72000000 / 5)) {
@@ -569,6 +623,179 @@ int __spi_config (am_zlg_spi_dma_dev_t *p_this)
     return AM_OK;
 }
 
+/**
+ * \brief жϢǷѯͨ
+ *
+ * дϴʱ֮Ͳѯֵʱ AM_TRUEϢ
+ * Խ״̬䷵ش״̬
+ */
+am_local
+am_bool_t __spi_msg_poll_check (am_zlg_spi_dma_dev_t *p_this,
+                                am_spi_device_t      *p_dev,
+                                am_spi_message_t     *p_msg)
+{
+    am_spi_transfer_t   *p_trans;
+    struct am_list_head *p_node;
+    uint32_t             speed;
+    uint32_t             byte_ns;
+    uint32_t             wire_ns = 0;
+
+    if ((p_this->poll_ns == 0) || am_list_empty(&(p_msg->transfers))) {
+        return AM_FALSE;
+    }
+
+    am_list_for_each(p_node, &(p_msg->transfers)) {
+        p_trans = am_list_entry(p_node, am_spi_transfer_t, trans_node);
+        speed   = (p_trans->speed_hz != 0) ? p_trans->speed_hz :
+                                             p_dev->max_speed_hz;
+
+        if ((speed < __SPI_MINSPEED_GET(p_hw_spi)) ||
+            (speed > __SPI_MAXSPEED_GET(p_hw_spi))) {
+            return AM_FALSE;
+        }
+
+        byte_ns = (1000000000u / speed) * 8;
+
+        if (p_trans->nbytes > (p_this->poll_ns - wire_ns) / byte_ns) {
+            return AM_FALSE;
+        }
+        wire_ns += p_trans->nbytes * byte_ns;
+    }
+
+    return AM_TRUE;
+}
+
+/**
+ * \brief ѯʽշһ
+ */
+am_local
+void __spi_poll_rw (am_zlg_spi_dma_dev_t *p_this, am_spi_transfer_t *p_trans)
+{
+    amhw_zlg_spi_t *p_hw_spi = (amhw_zlg_spi_t *)(p_this->p_devinfo->spi_reg_base);
+    const uint8_t  *p_tx     = (const uint8_t *)p_trans->p_txbuf;
+    uint8_t        *p_rx     = (uint8_t *)p_trans->p_rxbuf;
+    uint32_t        size     = __spi_word_size(p_trans->bits_per_word);
+    uint32_t        data;
+    uint32_t        i;
+
+    for (i = 0; i < p_trans->nbytes; i += size) {
+
+        data = p_this->dummy_tx;
+        if (p_tx != NULL) {
+            if (size == 1) {
+                data = p_tx[i];
+            } else if (size == 2) {
+                data = *(const uint16_t *)(p_tx + i);
+            } else {
+                data = *(const uint32_t *)(p_tx + i);
+            }
+        }
+
+        while (amhw_zlg_spi_reg_cstat_get(p_hw_spi) & AMHW_ZLG_SPI_CSTAT_TX_FULL);
+
+        if (size == 1) {
+            amhw_zlg_spi_tx_data8_put(p_hw_spi, (uint8_t)data);
+        } else {
+            amhw_zlg_spi_tx_data32_put(p_hw_spi, data);
+        }
+
+        while (!(amhw_zlg_spi_reg_cstat_get(p_hw_spi) & AMHW_ZLG_SPI_CSTAT_RXVAL));
+
+        if (size == 1) {
+            data = amhw_zlg_spi_rx_data8_get(p_hw_spi);
+        } else {
+            data = amhw_zlg_spi_rx_data32_get(p_hw_spi);
+        }
+
+        if (p_rx != NULL) {
+            if (size == 1) {
+                p_rx[i] = (uint8_t)data;
+            } else if (size == 2) {
+                *(uint16_t *)(p_rx + i) = (uint16_t)data;
+            } else {
+                *(uint32_t *)(p_rx + i) = data;
+            }
+        }
+    }
+}
+
+/**
+ * \brief ѯʽͬһϢ
+ *
+ * Ƭѡcs_changedelay_usecs Լ״̬Ĵ DMA ʽһ£ǰ
+ * ϢɻصǰѱϢռbusy λ
+ */
+am_local
+void __spi_msg_poll (am_zlg_spi_dma_dev_t *p_this, am_spi_message_t *p_msg)
+{
+    am_spi_transfer_t *p_trans;
+    am_spi_transfer_t *p_last = NULL;
+    am_bool_t          cs_on  = AM_FALSE;
+    int                ret;
+
+    p_this->p_cur_msg     = p_msg;
+    p_this->p_cur_trans   = NULL;
+    p_this->p_cur_spi_dev = p_msg->p_spi_dev;
+
+    p_msg->status        = -AM_EINPROGRESS;
+    p_msg->actual_length = 0;
+
+    while ((p_trans = __spi_trans_out(p_msg)) != NULL) {
+
+        ret = __spi_trans_check(p_this, p_trans);
+        if (ret != AM_OK) {
+            p_msg->status = ret;
+            break;
+        }
+
+        p_this->p_cur_trans = p_trans;
+
+        /* ִСһͬʱ */
+        if ((p_last == NULL) ||
+            (p_trans->bits_per_word != p_last->bits_per_word) ||
+            (p_trans->speed_hz      != p_last->speed_hz)) {
+            __spi_config(p_this);
+        }
+
+        if (!cs_on) {
+            __spi_cs_on(p_this, p_this->p_cur_spi_dev);
+            cs_on = AM_TRUE;
+        }
+
+        __spi_poll_rw(p_this, p_trans);
+
+        p_msg->actual_length += p_trans->nbytes;
+
+        if (p_trans->delay_usecs != 0) {
+            am_udelay(p_trans->delay_usecs);
+        }
+
+        if (p_trans->cs_change && !am_list_empty(&(p_msg->transfers))) {
+            __spi_cs_off(p_this, p_this->p_cur_spi_dev);
+            cs_on = AM_FALSE;
+        }
+
+        p_last = p_trans;
+    }
+
+    if (p_msg->status == -AM_EINPROGRESS) {
+        p_msg->status = AM_OK;
+    }
+
+    /* һ cs_change ʱƬѡֱһϢ */
+    if ((p_msg->status == AM_OK) &&
+        (p_last != NULL) &&
+        (p_last->cs_change)) {
+        p_this->p_tgl_dev = p_this->p_cur_spi_dev;
+    } else {
+        __spi_cs_off(p_this, p_this->p_cur_spi_dev);
+    }
+
+    if (p_msg->pfn_complete != NULL) {
+        p_msg->pfn_complete(p_msg->p_arg);
+    }
+}
+
 /**
  * \brief SPI ݺ
  */
@@ -579,7 +806,8 @@ int __spi_msg_start (void              *p_drv,
 {
     am_zlg_spi_dma_dev_t *p_this = (am_zlg_spi_dma_dev_t *)p_drv;
 
-    int key;
+    am_bool_t is_poll;
+    int       key;
 
     /* 豸ЧԼ */
     if ((p_drv              == NULL) ||
@@ -589,9 +817,8 @@ int __spi_msg_start (void              *p_drv,
     }
 
     p_msg->p_spi_dev       = p_dev; /* 豸Ϣ뵽Ϣ */
-    p_this->p_cur_msg      = p_msg; /* ǰ豸Ϣ */
-    p_this->nbytes_to_recv = 0;     /* ַ0 */
-    p_this->data_ptr       = 0;     /* ѽַ0 */
+
+    is_poll = __spi_msg_poll_check(p_this, p_dev, p_msg);
 
     key = am_int_cpu_lock();
 
@@ -600,6 +827,26 @@ int __spi_msg_start (void              *p_drv,
         __spi_msg_in(p_this, p_msg);
         am_int_cpu_unlock(key);
         return AM_OK;
+    } else if (is_poll) {
+
+        /*
+         * ҶΪգϢֱѯʽɡڼжύ
+         * ϢڱϢ֮ɺ״̬
+         */
+        p_this->busy = AM_TRUE;
+        am_int_cpu_unlock(key);
+
+        __spi_msg_poll(p_this, p_msg);
+
+        key = am_int_cpu_lock();
+        if (am_list_empty(&(p_this->msg_list))) {
+            p_this->busy = AM_FALSE;
+            am_int_cpu_unlock(key);
+            return AM_OK;
+        }
+        am_int_cpu_unlock(key);
+
+        return __spi_mst_sm_event(p_this, __SPI_EVT_TRANS_LAUNCH);
     } else {
         p_this->busy = AM_TRUE;
         __spi_msg_in(p_this, p_msg);
@@ -664,9 +911,13 @@ int __spi_mst_sm_event (am_zlg_spi_dma_dev_t *p_dev, uint32_t event)
             key = am_int_cpu_lock();
             p_cur_msg          = __spi_msg_out(p_dev);
             p_dev->p_cur_msg   = p_cur_msg;
+            p_dev->p_cur_trans = NULL;
 
             if (p_cur_msg) {
-                p_cur_msg->status = -AM_EINPROGRESS;
+                p_cur_msg->status        = -AM_EINPROGRESS;
+                p_cur_msg->actual_length = 0;
+            } else {
+                p_dev->busy = AM_FALSE;
             }
             am_int_cpu_unlock(key);
 
@@ -690,36 +941,50 @@ int __spi_mst_sm_event (am_zlg_spi_dma_dev_t *p_dev, uint32_t event)
         case __SPI_ST_TRANS_START:  /* 俪ʼ */
         {
             am_spi_message_t *p_cur_msg = p_dev->p_cur_msg;
-
-            p_dev->p_isr_msg = p_cur_msg;
+            int               nlinks    = 0;
 
             if (event != __SPI_EVT_TRANS_LAUNCH) {
                 return -AM_EINVAL;  /* 俪ʼ״̬ȴϢ */
             }
 
-            /* ǰϢ */
-            if (am_list_empty(&(p_cur_msg->transfers))) {
+            /* ȡһ */
+            if (p_cur_msg->status == -AM_EINPROGRESS) {
+                nlinks = __spi_chain_build(p_dev);
+                if (nlinks < 0) {
+                    p_cur_msg->status = nlinks;
+                }
+            }
 
-                p_cur_msg->actual_length = 0;
+            /* ǰϢ */
+            if (nlinks <= 0) {
 
                 /* Ϣڴ */
                 if (p_cur_msg->status == -AM_EINPROGRESS) {
                     p_cur_msg->status = AM_OK;
                 }
 
+                /* һ cs_change ʱƬѡֱһϢ */
+                if ((p_cur_msg->status == AM_OK) &&
+                    (p_dev->p_cur_trans != NULL) &&
+                    (p_dev->p_cur_trans->cs_change)) {
+                    p_dev->p_tgl_dev = p_dev->p_cur_spi_dev;
+                } else {
+                    __spi_cs_off(p_dev, p_dev->p_cur_spi_dev);
+                }
+
+                if (p_cur_msg->pfn_complete != NULL) {
+                    p_cur_msg->pfn_complete(p_cur_msg->p_arg);
+                }
+
                 __SPI_NEXT_STATE(__SPI_ST_MSG_START, __SPI_EVT_TRANS_LAUNCH);
 
             } else {
 
-                /* ȡһ䣬ȷô伴 */
-                am_spi_transfer_t *p_cur_trans = __spi_trans_out(p_cur_msg);
-                p_dev->p_cur_trans             = p_cur_trans;
-
-                /* reset current data pointer */
-                p_dev->data_ptr       = 0;
-                p_dev->nbytes_to_recv = 0;
+                p_dev->nlinks      = nlinks;
+                p_dev->link_idx    = 0;
+                p_dev->p_cur_trans = p_dev->link[0].p_trans;
 
-                /* SPI */
+                /* ִСֻͬһ */
                 __spi_config(p_dev);
 
                 /* CSѡͨ */
@@ -737,11 +1002,11 @@ int __spi_mst_sm_event (am_zlg_spi_dma_dev_t *p_dev, uint32_t event)
                 return -AM_EINVAL;  /* ״̬ȴϢǷ */
             }
 
-            /* һ״̬Ƿ״̬ */
+            /* ɺص俪ʼ״̬ */
             __SPI_NEXT_STATE(__SPI_ST_TRANS_START, __SPI_EVT_NONE);
 
-            /* ʹDMA */
-            __spi_dma_trans(p_dev);
+            /* ĵһ䣬ഫ DMA ж */
+            __spi_link_start(p_dev, &p_dev->link[0]);
 
             break;
         }
@@ -789,6 +1054,10 @@ am_spi_handle_t am_zlg_spi_dma_init (am_zlg_spi_dma_dev_t           *p_dev,
     p_dev->p_cur_trans      = NULL;
     p_dev->data_ptr         = 0;
     p_dev->nbytes_to_recv   = 0;
+    p_dev->nlinks           = 0;
+    p_dev->link_idx         = 0;
+    p_dev->dummy_tx         = 0;
+    p_dev->poll_ns          = AM_ZLG_SPI_DMA_POLL_NS;
     p_dev->state            = __SPI_ST_IDLE;     /* ʼΪ״̬ */
 
     am_list_head_init(&(p_dev->msg_list));
@@ -797,8 +1066,8 @@ am_spi_handle_t am_zlg_spi_dma_init (am_zlg_spi_dma_dev_t           *p_dev,
         return NULL;
     }
 
-    am_int_connect(p_dev->p_devinfo->inum, __spi_isr, (void *)p_dev);
-    am_int_enable(p_dev->p_devinfo->inum);
+    /* ʱֻʹýͨж */
+    am_zlg_dma_isr_connect(p_devinfo->dma_chan_rx, __dma_isr, (void *)p_dev);
 
     return &(p_dev->spi_serve);
 }
@@ -821,14 +1090,35 @@ void am_zlg_spi_dma_deinit (am_spi_handle_t handle)
     /*  SPI */
     amhw_zlg_spi_module_enable(p_hw_spi, AM_FALSE);
 
-    am_int_disable(p_dev->p_devinfo->inum);
-    am_int_disconnect(p_dev->p_devinfo->inum, __spi_isr, (void *)p_dev);
+    am_zlg_dma_chan_stop(p_dev->p_devinfo->dma_chan_tx);
+    am_zlg_dma_chan_stop(p_dev->p_devinfo->dma_chan_rx);
+    am_zlg_dma_isr_disconnect(p_dev->p_devinfo->dma_chan_rx,
+                              __dma_isr,
+                              (void *)p_dev);
 
     if (p_dev->p_devinfo->pfn_plfm_deinit) {
         p_dev->p_devinfo->pfn_plfm_deinit();
     }
 }
 
+/**
+ * \brief ѯֵͨ
+ */
+uint32_t am_zlg_spi_dma_poll_ns_set (am_spi_handle_t handle, uint32_t poll_ns)
+{
+    am_zlg_spi_dma_dev_t *p_dev = (am_zlg_spi_dma_dev_t *)handle;
+    uint32_t              old;
+
+    if (NULL == p_dev) {
+        return 0;
+    }
+
+    old            = p_dev->poll_ns;
+    p_dev->poll_ns = poll_ns;
+
+    return old;
+}
+
 /**
  * \brief SPIٶ
  *
@@ -374,6 +374,160 @@ int __uart_opt_set (am_zlg_uart_dev_t *p_dev, uint32_t options)
     return (AM_OK);
 }
 
+/*******************************************************************************
+  UART DMA circular receive
+*******************************************************************************/
+
+/**
+ * \brief ȡ DMA һдλ
+ */
+static uint32_t __uart_dma_rx_pos_get (void *p_drv)
+{
+    am_zlg_uart_dma_rx_t *p_dma_rx = (am_zlg_uart_dma_rx_t *)p_drv;
+    uint32_t              remain   = am_zlg_dma_tran_data_get(p_dma_rx->dma_chan);
+
+    /* ѭģʽʣƺΪ sizeӦʼλ */
+    return (p_dma_rx->size - remain) % p_dma_rx->size;
+}
+
+/**
+ * \brief DMA жϷѭģʽ´ɼƵʼ
+ */
+static void __uart_dma_rx_isr (void *p_arg, uint32_t flag)
+{
+    am_zlg_uart_dma_rx_t *p_dma_rx = (am_zlg_uart_dma_rx_t *)p_arg;
+
+    if (flag == AM_ZLG_DMA_INT_NORMAL) {
+        p_dma_rx->pfn_notify(p_dma_rx->p_arg, p_dma_rx->size);
+    }
+}
+
+/**
+ * \brief ѭʽ DMA 
+ */
+static int __uart_dma_rx_start (void                           *p_drv,
+                                uint8_t                        *p_buf,
+                                uint32_t                        size,
+                                am_uart_rngbuf_dma_rx_notify_t  pfn_notify,
+                                void                           *p_arg)
+{
+    am_zlg_uart_dma_rx_t *p_dma_rx  = (am_zlg_uart_dma_rx_t *)p_drv;
+    am_zlg_uart_dev_t    *p_dev     = p_dma_rx->p_uart_dev;
+    amhw_zlg_uart_t      *p_hw_uart = (amhw_zlg_uart_t *)p_dev->p_devinfo->uart_reg_base;
+    uint32_t              flags;
+    int                   key;
+
+    /*
+     * DMA Ϊ 16 λջСΪ 2 ݣΪ 32768
+     *  am_zlg_uart_rngbuf_dma_rx_enable() ˵һ
+     */
+    if ((size == 0) || (size > 32768)) {
+        return -AM_EINVAL;
+    }
+
+    p_dma_rx->size       = size;
+    p_dma_rx->pfn_notify = pfn_notify;
+    p_dma_rx->p_arg      = p_arg;
+
+    flags = AMHW_ZLG_DMA_CHAN_PRIORITY_HIGH        |
+            AMHW_ZLG_DMA_CHAN_MEM_SIZE_8BIT        |
+            AMHW_ZLG_DMA_CHAN_PER_SIZE_8BIT        |
+            AMHW_ZLG_DMA_CHAN_MEM_ADD_INC_ENABLE   |
+            AMHW_ZLG_DMA_CHAN_PER_ADD_INC_DISABLE  |
+            AMHW_ZLG_DMA_CHAN_CIRCULAR_MODE_ENABLE;
+
+    if (am_zlg_dma_isr_connect(p_dma_rx->dma_chan,
+                               __uart_dma_rx_isr,
+                               (void *)p_dma_rx) != AM_OK) {
+        return -AM_EPERM;
+    }
+
+    am_zlg_dma_xfer_desc_build(&p_dma_rx->desc,
+                               (uint32_t)(&(p_hw_uart->rdr)),
+                               (uint32_t)p_buf,
+                               size,
+                               flags);
+
+    if (am_zlg_dma_xfer_desc_chan_cfg(&p_dma_rx->desc,
+                                      AMHW_ZLG_DMA_PER_TO_MER,
+                                      (uint8_t)p_dma_rx->dma_chan) != AM_OK) {
+        am_zlg_dma_isr_disconnect(p_dma_rx->dma_chan,
+                                  __uart_dma_rx_isr,
+                                  (void *)p_dma_rx);
+        return -AM_EIO;
+    }
+
+    key = am_int_cpu_lock();
+
+    /*  DMA ȡرսжϣýճʱжϼ߿ */
+    amhw_zlg_uart_int_disable(p_hw_uart, AMHW_ZLG_UART_INT_RX_VAL_ENABLE);
+    p_dev->p_dma_rx = p_dma_rx;
+
+    amhw_zlg_uart_int_flag_clr(p_hw_uart, AMHW_ZLG_UART_INT_TIME_OUT_FLAG_CLR);
+    amhw_zlg_uart_int_enable(p_hw_uart, AMHW_ZLG_UART_INT_TIME_OUT_ENABLE);
+    amhw_zlg_uart_dma_mode_enable(p_hw_uart, AM_TRUE);
+
+    am_zlg_dma_chan_start(p_dma_rx->dma_chan);
+
+    am_int_cpu_unlock(key);
+
+    return AM_OK;
+}
+
+/**
+ * \brief ֹͣ DMA գֹͣ DMA дλñֲ
+ */
+static int __uart_dma_rx_stop (void *p_drv)
+{
+    am_zlg_uart_dma_rx_t *p_dma_rx  = (am_zlg_uart_dma_rx_t *)p_drv;
+    am_zlg_uart_dev_t    *p_dev     = p_dma_rx->p_uart_dev;
+    amhw_zlg_uart_t      *p_hw_uart = (amhw_zlg_uart_t *)p_dev->p_devinfo->uart_reg_base;
+    int                   key;
+
+    key = am_int_cpu_lock();
+
+    am_zlg_dma_chan_stop(p_dma_rx->dma_chan);
+
+    amhw_zlg_uart_int_disable(p_hw_uart, AMHW_ZLG_UART_INT_TIME_OUT_ENABLE);
+    amhw_zlg_uart_dma_mode_enable(p_hw_uart, AM_FALSE);
+    p_dev->p_dma_rx = NULL;
+
+    am_int_cpu_unlock(key);
+
+    am_zlg_dma_isr_disconnect(p_dma_rx->dma_chan,
+                              __uart_dma_rx_isr,
+                              (void *)p_dma_rx);
+
+    return AM_OK;
+}
+
+/** \brief DMA  */
+static const am_uart_rngbuf_dma_rx_funcs_t __g_uart_dma_rx_funcs = {
+    __uart_dma_rx_start,
+    __uart_dma_rx_pos_get,
+    __uart_dma_rx_stop,
+};
+
+/**
+ * \brief ʹ UARTring bufferжģʽʹ DMA ѭ
+ */
+int am_zlg_uart_rngbuf_dma_rx_enable (am_uart_rngbuf_handle_t  rngbuf_handle,
+                                      am_zlg_uart_dma_rx_t    *p_dma_rx,
+                                      am_zlg_uart_dev_t       *p_uart_dev,
+                                      int                      dma_chan)
+{
+    if ((rngbuf_handle == NULL) || (p_dma_rx == NULL) || (p_uart_dev == NULL)) {
+        return -AM_EINVAL;
+    }
+
+    p_dma_rx->p_uart_dev = p_uart_dev;
+    p_dma_rx->dma_chan   = dma_chan;
+
+    return am_uart_rngbuf_dma_rx_enable(rngbuf_handle,
+                                        &__g_uart_dma_rx_funcs,
+                                        (void *)p_dma_rx);
+}
+
 /*******************************************************************************
   UART interrupt request handler
 *******************************************************************************/
@@ -440,7 +594,19 @@ void __uart_irq_handler (void *p_arg)
 
     uint32_t uart_int_stat        = amhw_zlg_uart_int_flag_get(p_hw_uart);
 
-    if (amhw_zlg_uart_int_flag_check(p_hw_uart,AMHW_ZLG_UART_INT_RX_VAL_FLAG) == AM_TRUE) {
+    /* DMA ģʽ£ճʱ߿Уʱ֪ͨѽյ */
+    if ((p_dev->p_dma_rx != NULL) &&
+        ((uart_int_stat & AMHW_ZLG_UART_INT_TIME_OUT_FLAG) != 0)) {
+
+        amhw_zlg_uart_int_flag_clr(p_hw_uart, AMHW_ZLG_UART_INT_TIME_OUT_FLAG_CLR);
+
+        p_dev->p_dma_rx->pfn_notify(p_dev->p_dma_rx->p_arg,
+                                    __uart_dma_rx_pos_get(p_dev->p_dma_rx));
+    }
+
+    /* DMA ģʽ½ DMA ȡ */
+    if ((p_dev->p_dma_rx == NULL) &&
+        (amhw_zlg_uart_int_flag_check(p_hw_uart,AMHW_ZLG_UART_INT_RX_VAL_FLAG) == AM_TRUE)) {
          __uart_irq_rx_handler(p_dev);
     } else if (amhw_zlg_uart_int_flag_check(p_hw_uart,AMHW_ZLG_UART_INT_TX_EMPTY_FLAG) == AM_TRUE) {
         __uart_irq_tx_handler(p_dev);
@@ -526,6 +692,7 @@ am_uart_handle_t am_zlg_uart_init (am_zlg_uart_dev_t           *p_dev,
                                ~(AMHW_ZLG_UART_INT_TX_EMPTY_ENABLE |
                                  AMHW_ZLG_UART_INT_RX_VAL_ENABLE);
     p_dev->rs485_en          = AM_FALSE;
+    p_dev->p_dma_rx          = NULL;
 
     /* ȡݳѡ */
     tmp = p_devinfo->cfg_flags;
@@ -612,6 +779,10 @@ void am_zlg_uart_deinit (am_zlg_uart_dev_t *p_dev)
     p_dev->uart_serv.p_funcs   = NULL;
     p_dev->uart_serv.p_drv     = NULL;
 
+    if (p_dev->p_dma_rx != NULL) {
+        __uart_dma_rx_stop(p_dev->p_dma_rx);
+    }
+
     if (p_dev->channel_mode == AM_UART_MODE_INT) {
 
         /* ĬΪѯģʽ */
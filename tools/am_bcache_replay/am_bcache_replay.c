@@ -0,0 +1,355 @@
+/*******************************************************************************
+*                                 AMetal
+*                       ----------------------------
+*                       innovating embedded platform
+*
+* Copyright (c) 2001-2018 Guangzhou ZHIYUAN Electronics Co., Ltd.
+* All rights reserved.
+*
+* Contact information:
+* web site:    http://www.zlg.cn/
+*******************************************************************************/
+
+/**
+ * \file
+ * \brief access trace replay for am_bcache (host program)
+ *
+ * Each trace is replayed twice over a RAM MTD device which counts its read
+ * transactions: once directly, like a driver without the cache does one
+ * FAST_READ or I2C random read per call, and once through
+ * am_bcache_mtd_init(). The data read in both passes is checked against a
+ * reference copy of the device.
+ *
+ * A trace is a text file with one operation per line ('#' starts a comment):
+ * \code
+ * dev   <size> <page>     device size and page size, the default cache block
+ * r     <addr> <len>      read
+ * w     <addr> <len>      write (the data is random)
+ * e     <addr> <len>      erase, aligned to 4 KiB
+ * reset                   power cycle, the cache starts cold
+ * \endcode
+ *
+ * The traces in traces/ are:
+ *  - config_ep24c02.trc: the configuration code on a 256-byte EEPROM, using
+ *    the segment layout of am_servconf_nvram.c, with polled fields;
+ *  - log_mx25l1606.trc: 64-byte log records dumped and appended on NOR;
+ *  - random_mx25l1606.trc: a hot header with random reads over the device.
+ *
+ * build (from the root of the repository):
+ * \code
+ * gcc -std=gnu99 -O2 -Iinterface -Icomponents/service/include                \
+ *     -Isoc/zlg/zlg217 tools/am_bcache_replay/am_bcache_replay.c             \
+ *     components/service/source/am_bcache.c                                  \
+ *     components/service/source/am_mtd.c                                     \
+ *     components/service/source/am_nvram.c -o am_bcache_replay
+ * for t in config_ep24c02 log_mx25l1606 random_mx25l1606; do
+ *     ./am_bcache_replay tools/am_bcache_replay/traces/$t.trc
+ * done
+ * ./am_bcache_replay trace [nblks] [ra_blks] [blk_size]
+ * \endcode
+ *
+ * The cache has 32 blocks of the page size and reads ahead 4 blocks by
+ * default. The exit status is 0 if no error is found.
+ *
+ * \internal
+ * \par modification history:
+ * - 1.00 26-10-18  agent, first implementation
+ * \endinternal
+ */
+
+#include "ametal.h"
+#include "am_bcache.h"
+#include "am_int.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define __SIM_SIZE_MAX     (16u << 20)
+#define __SIM_ERASE_SIZE   4096
+#define __SIM_LEN_MAX      4096
+
+static uint8_t       *__g_flash;
+static uint8_t       *__g_ref;
+static uint32_t       __g_size;
+
+static unsigned long  __g_rd_trans;
+static unsigned long  __g_rd_bytes;
+static unsigned long  __g_wr_trans;
+static unsigned long  __g_errs;
+
+uint32_t am_int_cpu_lock (void)
+{
+    return 0;
+}
+
+void am_int_cpu_unlock (uint32_t key)
+{
+    (void)key;
+}
+
+/*******************************************************************************
+  RAM MTD device
+*******************************************************************************/
+
+static int __dev_erase (void *p_drv, struct am_mtd_erase_info *p_info)
+{
+    (void)p_drv;
+
+    memset(&__g_flash[p_info->addr], 0xFF, p_info->len);
+    p_info->state = AM_MTD_ERASE_DONE;
+
+    return AM_OK;
+}
+
+static int __dev_read (void *p_drv, uint32_t addr, void *p_buf, uint32_t len)
+{
+    (void)p_drv;
+
+    __g_rd_trans++;
+    __g_rd_bytes += len;
+    memcpy(p_buf, &__g_flash[addr], len);
+
+    return len;
+}
+
+static int __dev_write (void       *p_drv,
+                        uint32_t    addr,
+                        const void *p_buf,
+                        uint32_t    len)
+{
+    (void)p_drv;
+
+    __g_wr_trans++;
+    memcpy(&__g_flash[addr], p_buf, len);
+
+    return len;
+}
+
+/* a contiguous read into several buffers is one bus transaction */
+static int __dev_readv (void                 *p_drv,
+                        uint32_t              addr,
+                        const am_mtd_iovec_t *p_iov,
+                        int                   iovcnt)
+{
+    uint32_t len = 0;
+    int      i;
+
+    (void)p_drv;
+
+    __g_rd_trans++;
+    for (i = 0; i < iovcnt; i++) {
+        memcpy(p_iov[i].p_buf, &__g_flash[addr + len], p_iov[i].len);
+        len += p_iov[i].len;
+    }
+    __g_rd_bytes += len;
+
+    return len;
+}
+
+static const struct am_mtd_ops __g_dev_ops = {
+    __dev_erase,
+    __dev_read,
+    __dev_write,
+    __dev_readv,
+    NULL,
+};
+
+static am_mtd_serv_t __g_dev = {
+    AM_MTD_TYPE_NOR_FLASH,
+    AM_MTD_FLAG_WRITEABLE,
+    0,
+    __SIM_ERASE_SIZE,
+    1,
+    1,
+    &__g_dev_ops,
+    NULL
+};
+
+/*******************************************************************************
+  replay
+*******************************************************************************/
+
+typedef struct __replay_res {
+    unsigned long  ops;
+    unsigned long  reads;
+    unsigned long  rd_trans;
+    unsigned long  rd_bytes;
+    unsigned long  wr_trans;
+} __replay_res_t;
+
+/* replay the trace on mtd, p_cache is invalidated on "reset" if not NULL */
+static int __replay (FILE           *p_fp,
+                     am_mtd_handle_t mtd,
+                     am_bcache_t    *p_cache,
+                     __replay_res_t *p_res)
+{
+    static uint8_t           buf[__SIM_LEN_MAX];
+    char                     line[128];
+    char                     op[16];
+    long                     addr, len;
+    unsigned long            lineno = 0;
+    int                      n;
+    uint32_t                 i;
+
+    rewind(p_fp);
+    srand(1);
+    memset(p_res, 0, sizeof(*p_res));
+    for (i = 0; i < __g_size; i++) {
+        __g_flash[i] = __g_ref[i] = (uint8_t)(i * 7 + (i >> 8));
+    }
+    __g_rd_trans = __g_rd_bytes = __g_wr_trans = 0;
+
+    while (fgets(line, sizeof(line), p_fp) != NULL) {
+        lineno++;
+        n = sscanf(line, "%15s %li %li", op, &addr, &len);
+        if ((n <= 0) || (op[0] == '#') || (strcmp(op, "dev") == 0)) {
+            continue;
+        }
+        if (strcmp(op, "reset") == 0) {
+            if (p_cache != NULL) {
+                am_bcache_invalidate_all(p_cache);
+            }
+            continue;
+        }
+        if ((n != 3) || (len <= 0) || (len > __SIM_LEN_MAX) ||
+            (addr < 0) || (addr >= (long)__g_size) ||
+            (len > (long)__g_size - addr)) {
+            printf("line %lu: bad operation\n", lineno);
+            return -1;
+        }
+
+        p_res->ops++;
+        switch (op[0]) {
+
+        case 'r':
+            p_res->reads++;
+            if ((am_mtd_read(mtd, addr, buf, len) != (int)len) ||
+                (memcmp(buf, &__g_ref[addr], len) != 0)) {
+                printf("line %lu: read %lx+%ld differs\n", lineno, addr, len);
+                __g_errs++;
+            }
+            break;
+
+        case 'w':
+            for (i = 0; i < (uint32_t)len; i++) {
+                buf[i] = (uint8_t)rand();
+            }
+            memcpy(&__g_ref[addr], buf, len);
+            if (am_mtd_write(mtd, addr, buf, len) != (int)len) {
+                printf("line %lu: write failed\n", lineno);
+                __g_errs++;
+            }
+            break;
+
+        case 'e':
+            memset(&__g_ref[addr], 0xFF, len);
+            if (am_mtd_erase(mtd, addr, len) != AM_OK) {
+                printf("line %lu: erase failed\n", lineno);
+                __g_errs++;
+            }
+            break;
+
+        default:
+            printf("line %lu: unknown operation %s\n", lineno, op);
+            return -1;
+        }
+    }
+
+    p_res->rd_trans = __g_rd_trans;
+    p_res->rd_bytes = __g_rd_bytes;
+    p_res->wr_trans = __g_wr_trans;
+
+    return 0;
+}
+
+int main (int argc, char **argv)
+{
+    FILE                  *p_fp;
+    char                   line[128];
+    long                   size = 0, page = 0;
+    uint32_t               nblks, ra_blks;
+    static am_bcache_info_t info;
+    static am_bcache_t     cache;
+    static am_mtd_serv_t   top;
+    am_mtd_handle_t        mtd;
+    am_bcache_stat_t       stat;
+    __replay_res_t         raw, cached;
+
+    if (argc < 2) {
+        printf("usage: %s trace [nblks] [ra_blks] [blk_size]\n", argv[0]);
+        return 2;
+    }
+    if ((p_fp = fopen(argv[1], "r")) == NULL) {
+        perror(argv[1]);
+        return 2;
+    }
+    while (fgets(line, sizeof(line), p_fp) != NULL) {
+        if (sscanf(line, "dev %li %li", &size, &page) == 2) {
+            break;
+        }
+    }
+    if ((size <= 0) || (size > (long)__SIM_SIZE_MAX) || (page <= 0)) {
+        printf("%s: no valid \"dev <size> <page>\" line\n", argv[1]);
+        return 2;
+    }
+
+    nblks         = (argc > 2) ? strtoul(argv[2], NULL, 0) : 32;
+    ra_blks       = (argc > 3) ? strtoul(argv[3], NULL, 0) : 4;
+    info.blk_size = (argc > 4) ? strtoul(argv[4], NULL, 0) :
+                                   (uint32_t)page;
+    info.ra_blks  = ra_blks;
+    info.len      = AM_BCACHE_RAM_SIZE_GET(nblks, info.blk_size);
+    info.p_buf    = malloc(info.len);
+
+    __g_size       = size;
+    __g_flash      = malloc(size);
+    __g_ref        = malloc(size);
+    __g_dev.size   = size;
+    if (size < __SIM_ERASE_SIZE) {
+        __g_dev.erase_size = size;
+    }
+
+    /* without the cache */
+    if (__replay(p_fp, &__g_dev, NULL, &raw) != 0) {
+        return 2;
+    }
+
+    /* with the cache */
+    mtd = am_bcache_mtd_init(&cache, &info, &__g_dev, &top);
+    if (mtd == NULL) {
+        printf("am_bcache_mtd_init failed\n");
+        return 2;
+    }
+    if (__replay(p_fp, mtd, &cache, &cached) != 0) {
+        return 2;
+    }
+    am_bcache_stat_get(&cache, &stat);
+    fclose(p_fp);
+
+    printf("%s: %lu ops, %lu reads, cache %u x %u bytes, read-ahead %u\n",
+           argv[1], raw.ops, raw.reads, (unsigned)nblks,
+           (unsigned)info.blk_size, (unsigned)ra_blks);
+    printf("  read transactions: %lu -> %lu (%.1f%% saved), "
+           "bytes read: %lu -> %lu\n",
+           raw.rd_trans, cached.rd_trans,
+           raw.rd_trans ? 100.0 * ((double)raw.rd_trans - cached.rd_trans) /
+                          raw.rd_trans : 0.0,
+           raw.rd_bytes, cached.rd_bytes);
+    printf("  write transactions: %lu -> %lu\n", raw.wr_trans, cached.wr_trans);
+    printf("  hits %u, misses %u, read-ahead %u (hit %u), invalidated %u\n",
+           (unsigned)stat.hits, (unsigned)stat.misses, (unsigned)stat.ra_blks,
+           (unsigned)stat.ra_hits, (unsigned)stat.invalidates);
+    if (stat.dev_reads != cached.rd_trans) {
+        printf("  dev_reads %u does not match the device\n",
+               (unsigned)stat.dev_reads);
+        __g_errs++;
+    }
+    if (raw.wr_trans != cached.wr_trans) {
+        __g_errs++;
+    }
+    printf("  errs=%lu\n", __g_errs);
+
+    return __g_errs ? 1 : 0;
+}
+
+/* end of file */
@@ -0,0 +1,322 @@
+/*******************************************************************************
+*                                 AMetal
+*                       ----------------------------
+*                       innovating embedded platform
+*
+* Copyright (c) 2001-2018 Guangzhou ZHIYUAN Electronics Co., Ltd.
+* All rights reserved.
+*
+* Contact information:
+* web site:    http://www.zlg.cn/
+*******************************************************************************/
+
+/**
+ * \file
+ * \brief conformance test of the software CRC tables and engines (host program)
+ *
+ * For every CRC model in the list below (the common models of the CRC
+ * catalogue, widths 4 to 32):
+ *  - a bit-by-bit reference gives the check value of "123456789", which
+ *    must match the catalogue value;
+ *  - the byte-wise table engine (am_crc_table_create()) and, for widths
+ *    above 8, the slicing-by-4 and slicing-by-8 engines
+ *    (am_crc_table_slice_create()) must give the reference result for
+ *    random data at every start offset 0..15 and lengths 0..300, also when
+ *    the data is fed in several am_crc_cal() calls of random size.
+ *
+ * Every constant table in am_crc_table_def.c is compared entry by entry
+ * with the table created at run time for the same width, poly and refin,
+ * and must have the right number of subtables.
+ *
+ * build (from the root of the repository):
+ * \code
+ * gcc -std=gnu99 -O2 -Iinterface -Isoc/zlg/zlg217                        \
+ *     -Icomponents/service/include                                       \
+ *     tools/am_crc_conform/am_crc_conform.c                              \
+ *     components/service/source/am_crc_soft.c                            \
+ *     components/service/source/am_crc_table_def.c -o am_crc_conform
+ * ./am_crc_conform [trials]
+ * \endcode
+ *
+ * The exit status is 0 if no error is found.
+ *
+ * \internal
+ * \par modification history:
+ * - 1.00 26-10-18  agent, first implementation
+ * \endinternal
+ */
+
+#include "am_crc_soft.h"
+#include "am_crc_table_def.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** \brief a CRC model with its check value over "123456789" */
+typedef struct __crc_model {
+    const char *name;
+    uint8_t     width;
+    uint32_t    poly;
+    uint32_t    init;
+    am_bool_t   refin;
+    am_bool_t   refout;
+    uint32_t    xorout;
+    uint32_t    check;
+} __crc_model_t;
+
+static const __crc_model_t __g_models[] = {
+    {"CRC-4/G-704",       4,  0x3,        0x0,        1, 1, 0x0,        0x7},
+    {"CRC-5/EPC-C1G2",    5,  0x09,       0x09,       0, 0, 0x00,       0x00},
+    {"CRC-5/G-704",       5,  0x15,       0x00,       1, 1, 0x00,       0x07},
+    {"CRC-5/USB",         5,  0x05,       0x1f,       1, 1, 0x1f,       0x19},
+    {"CRC-6/G-704",       6,  0x03,       0x00,       1, 1, 0x00,       0x06},
+    {"CRC-7/MMC",         7,  0x09,       0x00,       0, 0, 0x00,       0x75},
+    {"CRC-8/SMBUS",       8,  0x07,       0x00,       0, 0, 0x00,       0xf4},
+    {"CRC-8/ROHC",        8,  0x07,       0xff,       1, 1, 0x00,       0xd0},
+    {"CRC-8/MAXIM-DOW",   8,  0x31,       0x00,       1, 1, 0x00,       0xa1},
+    {"CRC-10/ATM",        10, 0x233,      0x000,      0, 0, 0x000,      0x199},
+    {"CRC-11/FLEXRAY",    11, 0x385,      0x01a,      0, 0, 0x000,      0x5a3},
+    {"CRC-12/DECT",       12, 0x80f,      0x000,      0, 0, 0x000,      0xf5b},
+    {"CRC-12/UMTS",       12, 0x80f,      0x000,      0, 1, 0x000,      0xdaf},
+    {"CRC-15/CAN",        15, 0x4599,     0x0000,     0, 0, 0x0000,     0x059e},
+    {"CRC-16/ARC",        16, 0x8005,     0x0000,     1, 1, 0x0000,     0xbb3d},
+    {"CRC-16/MODBUS",     16, 0x8005,     0xffff,     1, 1, 0x0000,     0x4b37},
+    {"CRC-16/USB",        16, 0x8005,     0xffff,     1, 1, 0xffff,     0xb4c8},
+    {"CRC-16/MAXIM-DOW",  16, 0x8005,     0x0000,     1, 1, 0xffff,     0x44c2},
+    {"CRC-16/KERMIT",     16, 0x1021,     0x0000,     1, 1, 0x0000,     0x2189},
+    {"CRC-16/IBM-SDLC",   16, 0x1021,     0xffff,     1, 1, 0xffff,     0x906e},
+    {"CRC-16/XMODEM",     16, 0x1021,     0x0000,     0, 0, 0x0000,     0x31c3},
+    {"CRC-16/IBM-3740",   16, 0x1021,     0xffff,     0, 0, 0x0000,     0x29b1},
+    {"CRC-16/GENIBUS",    16, 0x1021,     0xffff,     0, 0, 0xffff,     0xd64e},
+    {"CRC-16/DNP",        16, 0x3d65,     0x0000,     1, 1, 0xffff,     0xea82},
+    {"CRC-16/EN-13757",   16, 0x3d65,     0x0000,     0, 0, 0xffff,     0xc2b7},
+    {"CRC-24/OPENPGP",    24, 0x864cfb,   0xb704ce,   0, 0, 0x000000,   0x21cf02},
+    {"CRC-24/FLEXRAY-A",  24, 0x5d6dcb,   0xfedcba,   0, 0, 0x000000,   0x7979bd},
+    {"CRC-32/ISO-HDLC",   32, 0x04c11db7, 0xffffffff, 1, 1, 0xffffffff, 0xcbf43926},
+    {"CRC-32/JAMCRC",     32, 0x04c11db7, 0xffffffff, 1, 1, 0x00000000, 0x340bc6d9},
+    {"CRC-32/BZIP2",      32, 0x04c11db7, 0xffffffff, 0, 0, 0xffffffff, 0xfc891918},
+    {"CRC-32/MPEG-2",     32, 0x04c11db7, 0xffffffff, 0, 0, 0x00000000, 0x0376e6e7},
+    {"CRC-32/CKSUM",      32, 0x04c11db7, 0x00000000, 0, 0, 0xffffffff, 0x765e7680},
+    {"CRC-32/ISCSI",      32, 0x1edc6f41, 0xffffffff, 1, 1, 0xffffffff, 0xe3069283},
+};
+
+/** \brief a constant table with the parameters it was generated for */
+typedef struct __crc_def {
+    const char           *name;
+    const am_crc_table_t *p_table;
+    uint8_t               width;
+    uint32_t              poly;
+    am_bool_t             refin;
+    uint8_t               slices;
+} __crc_def_t;
+
+static const __crc_def_t __g_defs[] = {
+    {"4_03_ref",          &g_crc_table_4_03_ref,           4,  0x03,       1, 1},
+    {"5_09",              &g_crc_table_5_09,               5,  0x09,       0, 1},
+    {"5_15_ref",          &g_crc_table_5_15_ref,           5,  0x15,       1, 1},
+    {"5_05_ref",          &g_crc_table_5_05_ref,           5,  0x05,       1, 1},
+    {"6_03_ref",          &g_crc_table_6_03_ref,           6,  0x03,       1, 1},
+    {"7_09",              &g_crc_table_7_09,               7,  0x09,       0, 1},
+    {"8_07",              &g_crc_table_8_07,               8,  0x07,       0, 1},
+    {"8_07_ref",          &g_crc_table_8_07_ref,           8,  0x07,       1, 1},
+    {"8_31_ref",          &g_crc_table_8_31_ref,           8,  0x31,       1, 1},
+    {"16_8005_ref",       &g_crc_table_16_8005_ref,        16, 0x8005,     1, 1},
+    {"16_1021_ref",       &g_crc_table_16_1021_ref,        16, 0x1021,     1, 1},
+    {"16_1021",           &g_crc_table_16_1021,            16, 0x1021,     0, 1},
+    {"16_3d65_ref",       &g_crc_table_16_3d65_ref,        16, 0x3d65,     1, 1},
+    {"32_04c11db7_ref",   &g_crc_table_32_04c11db7_ref,    32, 0x04c11db7, 1, 1},
+    {"32_04c11db7",       &g_crc_table_32_04c11db7,        32, 0x04c11db7, 0, 1},
+    {"16_8005_ref_s4",    &g_crc_table_16_8005_ref_s4,     16, 0x8005,     1, 4},
+    {"16_1021_ref_s4",    &g_crc_table_16_1021_ref_s4,     16, 0x1021,     1, 4},
+    {"16_1021_s4",        &g_crc_table_16_1021_s4,         16, 0x1021,     0, 4},
+    {"32_04c11db7_ref_s8",&g_crc_table_32_04c11db7_ref_s8, 32, 0x04c11db7, 1, 8},
+    {"32_04c11db7_s8",    &g_crc_table_32_04c11db7_s8,     32, 0x04c11db7, 0, 8},
+};
+
+static uint32_t __g_table_data[8 * 256];
+static uint8_t  __g_data[16 + 300];
+static int      __g_errs = 0;
+
+static uint32_t __reflect (uint32_t v, int n)
+{
+    uint32_t r = 0;
+    int      i;
+
+    for (i = 0; i < n; i++) {
+        r = (r << 1) | ((v >> i) & 1);
+    }
+    return r;
+}
+
+/* bit-by-bit reference, straight from the model definition */
+static uint32_t __crc_ref (const __crc_model_t *p_m, const uint8_t *p, size_t n)
+{
+    uint32_t mask = (p_m->width == 32) ? 0xffffffffu :
+                                         ((1u << p_m->width) - 1);
+    uint32_t top  = 1u << (p_m->width - 1);
+    uint32_t crc  = p_m->init;
+    uint8_t  c;
+    size_t   i;
+    int      b;
+
+    for (i = 0; i < n; i++) {
+        c = p_m->refin ? (uint8_t)__reflect(p[i], 8) : p[i];
+        for (b = 7; b >= 0; b--) {
+            if (((crc & top) != 0) ^ ((c >> b) & 1)) {
+                crc = ((crc << 1) ^ p_m->poly) & mask;
+            } else {
+                crc = (crc << 1) & mask;
+            }
+        }
+    }
+    if (p_m->refout) {
+        crc = __reflect(crc, p_m->width);
+    }
+    return (crc ^ p_m->xorout) & mask;
+}
+
+/* run a table engine, the data is split into random chunks if chunked */
+static int __crc_soft (const am_crc_table_t *p_table,
+                       const __crc_model_t  *p_m,
+                       const uint8_t        *p,
+                       size_t                n,
+                       int                   chunked,
+                       uint32_t             *p_val)
+{
+    am_crc_soft_t    crc;
+    am_crc_handle_t  handle = am_crc_soft_init(&crc, p_table);
+    am_crc_pattern_t pattern;
+    size_t           k;
+
+    pattern.width     = p_m->width;
+    pattern.poly      = p_m->poly;
+    pattern.initvalue = p_m->init;
+    pattern.refin     = p_m->refin;
+    pattern.refout    = p_m->refout;
+    pattern.xorout    = p_m->xorout;
+
+    if ((handle == NULL) || (am_crc_init(handle, &pattern) != AM_OK)) {
+        return -1;
+    }
+    while (n > 0) {
+        k = chunked ? (size_t)(rand() % 20) : n;
+        if (k > n) {
+            k = n;
+        }
+        am_crc_cal(handle, p, k);
+        p += k;
+        n -= k;
+    }
+    return am_crc_final(handle, p_val);
+}
+
+static void __test_model (const __crc_model_t *p_m, int trials)
+{
+    static const uint8_t check_str[]  = "123456789";
+    static const int     slice_tab[3] = {1, 4, 8};
+    am_crc_table_t       table;
+    uint32_t             ref, val;
+    int                  i, slices, t, off, n, chunked;
+
+    ref = __crc_ref(p_m, check_str, 9);
+    if (ref != p_m->check) {
+        printf("%s: reference check %x, catalogue %x\n",
+               p_m->name, (unsigned)ref, (unsigned)p_m->check);
+        __g_errs++;
+    }
+
+    for (i = 0; i < 3; i++) {
+        slices = slice_tab[i];
+        if (slices == 1) {
+            t = am_crc_table_create(&table, p_m->width, p_m->poly, p_m->refin,
+                                    __g_table_data);
+        } else if (p_m->width > 8) {
+            t = am_crc_table_slice_create(&table, p_m->width, p_m->poly,
+                                          p_m->refin, slices, __g_table_data);
+        } else {
+            break;
+        }
+        if (t != AM_OK) {
+            printf("%s: table with %d slices not created\n", p_m->name, slices);
+            __g_errs++;
+            continue;
+        }
+
+        if ((__crc_soft(&table, p_m, check_str, 9, 0, &val) != AM_OK) ||
+            (val != p_m->check)) {
+            printf("%s: slices %d: check %x, expected %x\n",
+                   p_m->name, slices, (unsigned)val, (unsigned)p_m->check);
+            __g_errs++;
+        }
+
+        for (t = 0; t < trials; t++) {
+            off     = t % 16;
+            n       = rand() % 301;
+            chunked = t & 1;
+            ref     = __crc_ref(p_m, __g_data + off, n);
+            if ((__crc_soft(&table, p_m, __g_data + off, n, chunked, &val) !=
+                 AM_OK) || (val != ref)) {
+                printf("%s: slices %d offset %d len %d chunked %d: %x, "
+                       "expected %x\n", p_m->name, slices, off, n, chunked,
+                       (unsigned)val, (unsigned)ref);
+                __g_errs++;
+                break;
+            }
+        }
+    }
+}
+
+static void __test_def (const __crc_def_t *p_def)
+{
+    am_crc_table_t table;
+    size_t         size = (p_def->width <= 8) ? 1 : (p_def->width <= 16) ? 2 : 4;
+    int            ret;
+
+    if (p_def->slices == 1) {
+        ret = am_crc_table_create(&table, p_def->width, p_def->poly,
+                                  p_def->refin, __g_table_data);
+    } else {
+        ret = am_crc_table_slice_create(&table, p_def->width, p_def->poly,
+                                        p_def->refin, p_def->slices,
+                                        __g_table_data);
+    }
+
+    if ((ret != AM_OK) ||
+        (p_def->p_table->width != p_def->width) ||
+        (p_def->p_table->poly  != p_def->poly)  ||
+        (p_def->p_table->refin != p_def->refin) ||
+        (p_def->p_table->slices != p_def->slices) ||
+        (memcmp(p_def->p_table->p_data, __g_table_data,
+                size * 256 * p_def->slices) != 0)) {
+        printf("g_crc_table_%s: differs from the generated table\n",
+               p_def->name);
+        __g_errs++;
+    }
+}
+
+int main (int argc, char **argv)
+{
+    int    trials = (argc > 1) ? atoi(argv[1]) : 2000;
+    size_t i;
+
+    srand(1);
+    for (i = 0; i < sizeof(__g_data); i++) {
+        __g_data[i] = (uint8_t)rand();
+    }
+
+    for (i = 0; i < AM_NELEMENTS(__g_models); i++) {
+        __test_model(&__g_models[i], trials);
+    }
+
+    for (i = 0; i < AM_NELEMENTS(__g_defs); i++) {
+        __test_def(&__g_defs[i]);
+    }
+
+    printf("%u models, %u constant tables, errs=%d\n",
+           (unsigned)AM_NELEMENTS(__g_models), (unsigned)AM_NELEMENTS(__g_defs),
+           __g_errs);
+
+    return __g_errs ? 1 : 0;
+}
+
+/* end of file */
@@ -0,0 +1,436 @@
+/*******************************************************************************
+*                                 AMetal
+*                       ----------------------------
+*                       innovating embedded platform
+*
+* Copyright (c) 2001-2018 Guangzhou ZHIYUAN Electronics Co., Ltd.
+* All rights reserved.
+*
+* Contact information:
+* web site:    http://www.zlg.cn/
+*******************************************************************************/
+
+/**
+ * \file
+ * \brief timed AT24C64 model for am_ep24cxx (host program)
+ *
+ * The I2C controller is replaced by a model of an AT24C64 on a 400 kHz bus
+ * (22.5 us per byte with ACK, 5 us per START/STOP):
+ *  - a page write wraps inside its 32-byte page, like the chip, so a write
+ *    split at the wrong place corrupts data;
+ *  - after the STOP of a write the chip is busy for tWR and NAKs its address,
+ *    the message fails and costs only the address byte.
+ * Time is virtual and advances with the bus and with am_mdelay().
+ *
+ * Three workloads of 1 KiB each are written, with the real tWR of the chip
+ * set to 3.5 ms and 5 ms (the datasheet maximum):
+ *  - one 1 KiB write from an unaligned address;
+ *  - 256 sequential 4-byte writes;
+ *  - 128 scattered 8-byte writes.
+ * Each is run with ACK polling, and with ACK polling and a 4-page write
+ * buffer (am_ep24cxx_sync() at the end). The "fixed" column is the time the
+ * old driver took for the same page writes: the bus time plus twr + 1 ms
+ * (6 ms) after each page. The content of the chip is checked after each
+ * workload, and the timed flush of the write buffer is checked at the end.
+ *
+ * build (from the root of the repository):
+ * \code
+ * gcc -std=gnu99 -O2 -Iinterface -Icomponents/drivers/include                 \
+ *     -Icomponents/service/include -Icomponents/util/include                 \
+ *     -Isoc/zlg/zlg217 tools/am_ep24cxx_model/am_ep24cxx_model.c             \
+ *     components/drivers/source/nvram/am_ep24cxx.c                           \
+ *     components/service/source/am_i2c.c -o am_ep24cxx_model
+ * ./am_ep24cxx_model
+ * \endcode
+ *
+ * The exit status is 0 if no error is found.
+ *
+ * \internal
+ * \par modification history:
+ * - 1.00 26-10-18  agent, first implementation
+ * \endinternal
+ */
+
+#include "ametal.h"
+#include "am_ep24cxx.h"
+#include "am_i2c.h"
+#include "am_wait.h"
+#include "am_softimer.h"
+#include "am_jobq.h"
+#include "am_system.h"
+#include "am_delay.h"
+#include "am_int.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define __EE_SIZE       8192
+#define __EE_PAGE       32
+#define __EE_TWR_MS     5             /* twr of the type, used by the driver */
+
+#define __BUS_BYTE_US   22.5          /* 9 bits at 400 kHz */
+#define __BUS_SS_US     5.0           /* START and STOP */
+
+static double         __g_now_us;
+static double         __g_twr_us;
+static double         __g_busy_until_us;
+static double         __g_bus_us;            /* without the ACK polls */
+
+static uint8_t        __g_ee[__EE_SIZE];
+static uint8_t        __g_ref[__EE_SIZE];
+static uint32_t       __g_ptr;
+
+static unsigned long  __g_page_writes;
+static unsigned long  __g_naks;
+static unsigned long  __g_errs;
+
+/*******************************************************************************
+  AT24C64 model
+*******************************************************************************/
+
+static int __i2c_msg_start (void *p_drv, am_i2c_message_t *p_msg)
+{
+    am_i2c_transfer_t *p_trans;
+    uint32_t           base, off, k;
+    double             t0 = __g_now_us;
+    int                i;
+
+    (void)p_drv;
+
+    __g_now_us += __BUS_SS_US;
+
+    for (i = 0; i < p_msg->trans_num; i++) {
+        p_trans = &p_msg->p_transfers[i];
+
+        /* the device address, NAK while programming */
+        if (!(p_trans->flags & AM_I2C_M_NOSTART)) {
+            __g_now_us += __BUS_BYTE_US;
+            if (__g_now_us < __g_busy_until_us) {
+                __g_naks++;
+                p_msg->status = -AM_ENODEV;
+                p_msg->pfn_complete(p_msg->p_arg);
+                return AM_OK;
+            }
+        }
+        __g_now_us += __BUS_BYTE_US * p_trans->nbytes;
+
+        if (p_trans->flags & AM_I2C_M_RD) {
+            for (k = 0; k < p_trans->nbytes; k++) {
+                p_trans->p_buf[k] = __g_ee[__g_ptr];
+                __g_ptr = (__g_ptr + 1) % __EE_SIZE;
+            }
+        } else if (!(p_trans->flags & AM_I2C_M_NOSTART)) {
+
+            /* the two address bytes */
+            __g_ptr = ((p_trans->p_buf[0] << 8) | p_trans->p_buf[1]) %
+                      __EE_SIZE;
+        } else {
+
+            /* data of a write, wraps inside the page */
+            base = __g_ptr & ~(__EE_PAGE - 1);
+            off  = __g_ptr &  (__EE_PAGE - 1);
+            for (k = 0; k < p_trans->nbytes; k++) {
+                __g_ee[base + off] = p_trans->p_buf[k];
+                off = (off + 1) & (__EE_PAGE - 1);
+            }
+            __g_ptr           = base + off;
+            __g_busy_until_us = __g_now_us + __BUS_SS_US + __g_twr_us;
+            __g_page_writes++;
+        }
+    }
+
+    /* a single one-byte read is an ACK poll */
+    if ((p_msg->trans_num != 1) ||
+        !(p_msg->p_transfers[0].flags & AM_I2C_M_RD) ||
+        (p_msg->p_transfers[0].nbytes != 1)) {
+        __g_bus_us += __g_now_us - t0;
+    }
+
+    p_msg->status = AM_OK;
+    p_msg->pfn_complete(p_msg->p_arg);
+
+    return AM_OK;
+}
+
+static struct am_i2c_drv_funcs __g_i2c_funcs = {
+    __i2c_msg_start
+};
+
+static am_i2c_serv_t __g_i2c = {&__g_i2c_funcs, NULL};
+
+/*******************************************************************************
+  platform stubs
+*******************************************************************************/
+
+uint32_t am_int_cpu_lock (void)
+{
+    return 0;
+}
+
+void am_int_cpu_unlock (uint32_t key)
+{
+    (void)key;
+}
+
+am_tick_t am_sys_tick_get (void)
+{
+    return (am_tick_t)(__g_now_us / 1000);
+}
+
+am_tick_t am_ms_to_ticks (unsigned int ms)
+{
+    return ms;
+}
+
+unsigned long am_sys_clkrate_get (void)
+{
+    return 1000;
+}
+
+void am_mdelay (uint32_t nms)
+{
+    __g_now_us += nms * 1000.0;
+}
+
+/* the model completes every message before returning */
+int am_wait_init (am_wait_t *p_wait)
+{
+    (void)p_wait;
+
+    return AM_OK;
+}
+
+int am_wait_on (am_wait_t *p_wait)
+{
+    (void)p_wait;
+
+    return AM_OK;
+}
+
+int am_wait_done (am_wait_t *p_wait)
+{
+    (void)p_wait;
+
+    return AM_OK;
+}
+
+/* the flush timer and job are run by hand */
+static am_bool_t      __g_timer_on;
+static am_jobq_job_t *__g_job_posted;
+
+int am_softimer_init (am_softimer_t *p_timer, am_pfnvoid_t p_func, void *p_arg)
+{
+    p_timer->timeout_callback = p_func;
+    p_timer->p_arg            = p_arg;
+
+    return AM_OK;
+}
+
+void am_softimer_start (am_softimer_t *p_timer, unsigned int ms)
+{
+    (void)p_timer;
+    (void)ms;
+
+    __g_timer_on = AM_TRUE;
+}
+
+void am_softimer_stop (am_softimer_t *p_timer)
+{
+    (void)p_timer;
+
+    __g_timer_on = AM_FALSE;
+}
+
+void am_jobq_job_init (am_jobq_job_t *p_job,
+                       am_pfnvoid_t   func,
+                       void          *p_arg,
+                       uint16_t       pri)
+{
+    (void)pri;
+
+    p_job->func  = func;
+    p_job->p_arg = p_arg;
+}
+
+int am_jobq_post (am_jobq_handle_t handle, am_jobq_job_t *p_job)
+{
+    (void)handle;
+
+    __g_job_posted = p_job;
+
+    return AM_OK;
+}
+
+int am_nvram_dev_register (am_nvram_dev_t *p_dev)
+{
+    (void)p_dev;
+
+    return AM_OK;
+}
+
+int am_nvram_dev_unregister (am_nvram_dev_t *p_dev)
+{
+    (void)p_dev;
+
+    return AM_OK;
+}
+
+/*******************************************************************************
+  workloads
+*******************************************************************************/
+
+static const am_ep24cxx_devinfo_t __g_devinfo = {
+    0x50,
+    AM_EP24CXX_AT24C64
+};
+
+static am_ep24cxx_dev_t __g_dev;
+static uint8_t          __g_wbuf[AM_EP24CXX_WBUF_SIZE_GET(AM_EP24CXX_AT24C64, 4)];
+
+static void __check (const char *p_what)
+{
+    if (memcmp(__g_ee, __g_ref, __EE_SIZE) != 0) {
+        printf("%s: the chip content differs\n", p_what);
+        __g_errs++;
+    }
+}
+
+static void __write (am_ep24cxx_handle_t handle,
+                     int                 addr,
+                     uint8_t            *p_buf,
+                     int                 len)
+{
+    if (am_ep24cxx_write(handle, addr, p_buf, len) != AM_OK) {
+        printf("write %d+%d failed\n", addr, len);
+        __g_errs++;
+    }
+    memcpy(&__g_ref[addr], p_buf, len);
+}
+
+static void __run (am_ep24cxx_handle_t handle,
+                   int                 workload,
+                   am_bool_t           wbuf,
+                   double             *p_kbs,
+                   double             *p_fixed_kbs,
+                   unsigned long      *p_pages)
+{
+    uint8_t       buf[1024];
+    double        t0     = __g_now_us;
+    unsigned long pages0 = __g_page_writes;
+    double        bus0   = __g_bus_us;
+    double        dt;
+    int           i, addr;
+
+    for (i = 0; i < (int)sizeof(buf); i++) {
+        buf[i] = (uint8_t)rand();
+    }
+
+    switch (workload) {
+
+    case 0:
+        __write(handle, 1024 + 7, buf, 1024);
+        break;
+
+    case 1:
+        for (i = 0; i < 256; i++) {
+            __write(handle, 2048 + 7 + i * 4, &buf[i * 4], 4);
+        }
+        break;
+
+    default:
+        for (i = 0; i < 128; i++) {
+            addr = 4096 + (rand() % 256) * 8;
+            __write(handle, addr, &buf[i * 8], 8);
+        }
+        break;
+    }
+
+    if (wbuf) {
+        am_ep24cxx_sync(handle);
+    }
+
+    /* let the last write cycle finish, both drivers wait for it */
+    if (__g_busy_until_us > __g_now_us) {
+        __g_now_us = __g_busy_until_us;
+    }
+
+    dt           = __g_now_us - t0;
+    *p_pages     = __g_page_writes - pages0;
+    *p_kbs       = 1.0 / (dt / 1e6);
+    *p_fixed_kbs = 1.0 / ((__g_bus_us - bus0 +
+                           (*p_pages) * (__EE_TWR_MS + 1) * 1000.0) / 1e6);
+
+    __check(wbuf ? "write buffer" : "ack polling");
+}
+
+int main (void)
+{
+    static const char  *names[] = {
+        "1 KiB in one write",
+        "256 x 4 B sequential",
+        "128 x 8 B scattered",
+    };
+    am_ep24cxx_handle_t handle;
+    double              kbs, kbs_wbuf, fixed, fixed_wbuf;
+    unsigned long       pages, pages_wbuf;
+    uint8_t             x[3] = {1, 2, 3};
+    int                 tw, w;
+
+    printf("%-22s %-6s %14s %14s %18s\n", "workload", "tWR",
+           "fixed delay", "ack polling", "ack polling+wbuf");
+
+    for (tw = 0; tw < 2; tw++) {
+        __g_twr_us = tw ? 5000 : 3500;
+
+        for (w = 0; w < 3; w++) {
+            memset(__g_ee,  0xFF, sizeof(__g_ee));
+            memset(__g_ref, 0xFF, sizeof(__g_ref));
+
+            srand(w + 1);
+            handle = am_ep24cxx_init(&__g_dev, &__g_devinfo, &__g_i2c);
+            __run(handle, w, AM_FALSE, &kbs, &fixed, &pages);
+            am_ep24cxx_deinit(handle);
+
+            srand(w + 1);
+            handle = am_ep24cxx_init(&__g_dev, &__g_devinfo, &__g_i2c);
+            am_ep24cxx_wbuf_init(handle, __g_wbuf, sizeof(__g_wbuf), 20,
+                                 (am_jobq_handle_t)1);
+            __run(handle, w, AM_TRUE, &kbs_wbuf, &fixed_wbuf, &pages_wbuf);
+            am_ep24cxx_deinit(handle);
+
+            printf("%-22s %4.1fms %8.2f KiB/s %8.2f KiB/s %8.2f KiB/s "
+                   "(pages %lu -> %lu)\n",
+                   names[w], __g_twr_us / 1000, fixed, kbs, kbs_wbuf,
+                   pages, pages_wbuf);
+        }
+    }
+
+    /* the timed flush: timer -> job -> page write */
+    handle = am_ep24cxx_init(&__g_dev, &__g_devinfo, &__g_i2c);
+    am_ep24cxx_wbuf_init(handle, __g_wbuf, sizeof(__g_wbuf), 20,
+                         (am_jobq_handle_t)1);
+    __g_job_posted = NULL;
+    __write(handle, 10, x, sizeof(x));
+    if (!__g_timer_on) {
+        printf("flush timer not started\n");
+        __g_errs++;
+    }
+    __g_dev.flush_timer.timeout_callback(__g_dev.flush_timer.p_arg);
+    if (__g_job_posted == NULL) {
+        printf("flush job not posted\n");
+        __g_errs++;
+    } else {
+        __g_job_posted->func(__g_job_posted->p_arg);
+    }
+    if ((__g_dev.ndirty != 0) || __g_timer_on) {
+        printf("buffer not flushed by the job\n");
+        __g_errs++;
+    }
+    __check("timed flush");
+
+    printf("naks %lu, errs=%lu\n", __g_naks, __g_errs);
+
+    return __g_errs ? 1 : 0;
+}
+
+/* end of file */
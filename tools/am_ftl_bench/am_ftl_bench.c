@@ -0,0 +1,595 @@
+/*******************************************************************************
+*                                 AMetal
+*                       ----------------------------
+*                       innovating embedded platform
+*
+* Copyright (c) 2001-2018 Guangzhou ZHIYUAN Electronics Co., Ltd.
+* All rights reserved.
+*
+* Contact information:
+* web site:    http://www.zlg.cn/
+*******************************************************************************/
+
+/**
+ * \file
+ * \brief flash operation counts of am_ftl (host program)
+ *
+ * The MTD functions are replaced by a simulated NOR flash in RAM (2 MiB,
+ * 4 KiB erase blocks) that counts the read, program and erase operations.
+ * The FTL uses 256-byte logical blocks and 3 log blocks. All data read back
+ * is checked against a reference copy, also after a remount.
+ *
+ * Benchmarks, selected by the first argument:
+ *  - l2p: 30000 random reads and writes, one third of them on 64 hot
+ *    logical blocks, without the L2P cache, with a 64-entry cache and with
+ *    a full map. The MTD reads per operation are printed for this phase.
+ *    Then the flash is remounted, which clears the cache, and 32 hot blocks
+ *    are read once (cold) and 32 times more (warm), the MTD reads per
+ *    am_ftl_read() are printed for both.
+ *  - gc: 60000 writes in short runs on random logical blocks, without and
+ *    with the background merge (am_ftl_gc_jobq_set()). Between two writes
+ *    the idle loop runs up to 8, 16 or 32 queued merge steps (a merge is
+ *    about 20 steps in this setup). The latency of each
+ *    am_ftl_write() is estimated from its flash operations with the typical
+ *    timing of a SPI NOR flash (4 KiB erase 45 ms, page program 0.7 ms,
+ *    read 0.05 ms), p50, p99, p99.9 and max are printed.
+ *  - wear: 1000000 skewed writes (99.9% on 3 physical blocks worth of
+ *    logical blocks) with the erase count table, without and with static
+ *    wear leveling. Every 20000 writes the power is cut while a free block
+ *    is being tagged after its erase: the block info is left with the magic
+ *    number and only the low 2 bytes of the erase count (e.g. 0xFFFF02B9),
+ *    then the flash is remounted. The histogram of the real erase counts,
+ *    am_ftl_wear_stat_get() and the number of torn counts reported invalid
+ *    are printed. A torn count in the statistics is an error.
+ *  - multi: 1920 sequential logical blocks written to a formatted flash with
+ *    am_ftl_write_blocks() and read back with am_ftl_read_blocks(), 1 to 64
+ *    blocks per call. The MTD calls per block and the throughput estimated
+ *    with the timing of a 50 MHz SPI NOR flash (0.16 us per byte
+ *    transferred, program 30 us + 2.5 us per byte in each page, 4 KiB erase
+ *    45 ms) are printed, with 1 us per command (the bus only) and 20 us per
+ *    command (the driver and transfer setup of a small MCU).
+ *
+ * build (from the root of the repository):
+ * \code
+ * gcc -std=gnu99 -O2 -Iinterface -Icomponents/service/include            \
+ *     -Icomponents/util/include -Isoc/zlg/zlg217                         \
+ *     tools/am_ftl_bench/am_ftl_bench.c                                  \
+ *     components/service/source/am_ftl.c -o am_ftl_bench
+ * ./am_ftl_bench l2p
+ * ./am_ftl_bench gc
+ * ./am_ftl_bench wear [writes]
+ * ./am_ftl_bench multi
+ * \endcode
+ *
+ * The exit status is 0 if no error is found.
+ *
+ * \internal
+ * \par modification history:
+ * - 1.00 26-10-18  agent, first implementation
+ * \endinternal
+ */
+
+#include "am_ftl.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*******************************************************************************
+  simulated flash
+*******************************************************************************/
+
+#define __SIM_CHIP_SIZE      (2 * 1024 * 1024)
+#define __SIM_ERASE_SIZE     4096
+
+static uint8_t       __g_flash[__SIM_CHIP_SIZE];
+static am_mtd_serv_t __g_mtd = {
+    AM_MTD_TYPE_NOR_FLASH, 0, __SIM_CHIP_SIZE, __SIM_ERASE_SIZE, 1, 256,
+    NULL, NULL
+};
+
+/* flash operation counters */
+static unsigned long __g_reads;
+static unsigned long __g_writes;
+static unsigned long __g_erases;
+static unsigned long __g_read_bytes;
+static unsigned long __g_write_bytes;
+static unsigned long __g_write_pages;     /* pages touched by the writes */
+
+/* real erase count of each block */
+static uint32_t      __g_block_erases[__SIM_CHIP_SIZE / __SIM_ERASE_SIZE];
+
+int am_mtd_erase (am_mtd_handle_t handle, uint32_t addr, uint32_t len)
+{
+    __g_erases++;
+    __g_block_erases[addr / __SIM_ERASE_SIZE]++;
+    memset(&__g_flash[addr], 0xFF, len);
+
+    return AM_OK;
+}
+
+int am_mtd_read (am_mtd_handle_t handle, uint32_t addr, void *p_buf, uint32_t len)
+{
+    __g_reads++;
+    __g_read_bytes += len;
+    memcpy(p_buf, &__g_flash[addr], len);
+
+    return len;
+}
+
+int am_mtd_write (am_mtd_handle_t  handle,
+                  uint32_t         addr,
+                  const void      *p_buf,
+                  uint32_t         len)
+{
+    const uint8_t *p = (const uint8_t *)p_buf;
+    uint32_t       i;
+
+    __g_writes++;
+    __g_write_bytes += len;
+    __g_write_pages += (addr + len - 1) / 256 - addr / 256 + 1;
+    for (i = 0; i < len; i++) {
+        if ((__g_flash[addr + i] & p[i]) != p[i]) {
+            printf("bug: program 0x%02x over 0x%02x at 0x%x\n",
+                   p[i], __g_flash[addr + i], (unsigned)(addr + i));
+            exit(2);
+        }
+        __g_flash[addr + i] &= p[i];
+    }
+
+    return len;
+}
+
+/* the job queue holds the gc job only */
+static am_jobq_job_t *__g_job_pending;
+
+void am_jobq_job_init (am_jobq_job_t  *p_job,
+                       void          (*pfn_func) (void *),
+                       void           *p_arg,
+                       uint16_t        pri)
+{
+    p_job->func  = pfn_func;
+    p_job->p_arg = p_arg;
+    p_job->pri   = pri;
+    p_job->flags = 0;
+}
+
+int am_jobq_post (am_jobq_handle_t handle, am_jobq_job_t *p_job)
+{
+    if (__g_job_pending != NULL) {
+        return -AM_EBUSY;
+    }
+    __g_job_pending = p_job;
+
+    return AM_OK;
+}
+
+/* run up to max queued jobs, as the idle loop does */
+static void __jobq_idle (int max)
+{
+    am_jobq_job_t *p_job;
+
+    while ((max-- > 0) && ((p_job = __g_job_pending) != NULL)) {
+        __g_job_pending = NULL;
+        p_job->func(p_job->p_arg);
+    }
+}
+
+int am_nvram_dev_register (am_nvram_dev_t *p_dev)
+{
+    return AM_OK;
+}
+
+/*******************************************************************************
+  FTL setup and reference data
+*******************************************************************************/
+
+#define __SIM_LBS            256
+#define __SIM_NLOG           3
+#define __SIM_NLBN           2000
+
+static uint8_t       __g_ram[AM_FTL_RAM_SIZE_GET(__SIM_CHIP_SIZE,
+                                                 __SIM_ERASE_SIZE,
+                                                 __SIM_LBS,
+                                                 __SIM_NLOG)];
+static am_ftl_l2p_t  __g_l2p[__SIM_CHIP_SIZE / __SIM_LBS];
+static am_ftl_info_t __g_info;
+static am_ftl_serv_t __g_ftl;
+
+static uint8_t       __g_ref[__SIM_NLBN][__SIM_LBS];
+static unsigned      __g_nlbn;
+static int           __g_errs = 0;
+
+/* format the flash and mount */
+static am_ftl_handle_t __ftl_create (size_t l2p_num)
+{
+    am_ftl_handle_t handle;
+
+    memset(__g_flash, 0xFF, sizeof(__g_flash));
+    memset(__g_block_erases, 0, sizeof(__g_block_erases));
+    memset(__g_ref, 0, sizeof(__g_ref));
+    memset(&__g_info, 0, sizeof(__g_info));
+
+    __g_info.p_buf          = __g_ram;
+    __g_info.len            = sizeof(__g_ram);
+    __g_info.logic_blk_size = __SIM_LBS;
+    __g_info.nb_log_blocks  = __SIM_NLOG;
+    __g_info.p_l2p          = l2p_num ? __g_l2p : NULL;
+    __g_info.l2p_num        = l2p_num;
+
+    __g_job_pending = NULL;
+
+    handle = am_ftl_init(&__g_ftl, &__g_info, &__g_mtd);
+    if (handle == NULL) {
+        printf("init failed\n");
+        exit(1);
+    }
+
+    __g_nlbn = am_ftl_max_lbn_get(handle);
+    if (__g_nlbn > __SIM_NLBN) {
+        __g_nlbn = __SIM_NLBN;
+    }
+
+    return handle;
+}
+
+static void __ftl_write (am_ftl_handle_t handle, unsigned lbn)
+{
+    uint8_t buf[__SIM_LBS];
+
+    memset(buf, rand(), sizeof(buf));
+    buf[0] = (uint8_t)lbn;
+    if (am_ftl_write(handle, lbn, buf) < 0) {
+        printf("lbn %u: write failed\n", lbn);
+        __g_errs++;
+        return;
+    }
+    memcpy(__g_ref[lbn], buf, sizeof(buf));
+}
+
+static void __ftl_check (am_ftl_handle_t handle, unsigned lbn)
+{
+    uint8_t buf[__SIM_LBS];
+
+    if ((am_ftl_read(handle, lbn, buf) < 0) ||
+        (memcmp(buf, __g_ref[lbn], sizeof(buf)) != 0)) {
+        printf("lbn %u: read back differs\n", lbn);
+        __g_errs++;
+    }
+}
+
+/*******************************************************************************
+  benchmarks
+*******************************************************************************/
+
+static void __bench_l2p_one (size_t l2p_num)
+{
+    am_ftl_handle_t handle = __ftl_create(l2p_num);
+    unsigned long   r0, r1, r2, r3;
+    unsigned        lbn;
+    int             it;
+
+    srand(1);
+    r0 = __g_reads;
+    for (it = 0; it < 30000; it++) {
+        lbn = rand() % __g_nlbn;
+        if (rand() % 3 == 0) {
+            lbn %= 64;
+        }
+        if (rand() % 2) {
+            __ftl_write(handle, lbn);
+        } else {
+            __ftl_check(handle, lbn);
+        }
+    }
+    r1 = __g_reads;
+
+    /* remount, which also clears the cache, and verify everything */
+    handle = am_ftl_init(&__g_ftl, &__g_info, &__g_mtd);
+    for (lbn = 0; lbn < __g_nlbn; lbn++) {
+        __ftl_check(handle, lbn);
+    }
+
+    handle = am_ftl_init(&__g_ftl, &__g_info, &__g_mtd);
+    r2 = __g_reads;
+    for (it = 0; it < 32; it++) {
+        __ftl_check(handle, it);
+    }
+    r3 = __g_reads;
+    for (it = 0; it < 1024; it++) {
+        __ftl_check(handle, it % 32);
+    }
+
+    printf("l2p entries %4u: MTD reads per op %.2f, per hot read cold %.2f "
+           "warm %.2f\n", (unsigned)l2p_num, (r1 - r0) / 30000.0,
+           (r3 - r2) / 32.0, (__g_reads - r3) / 1024.0);
+}
+
+static void __bench_l2p (void)
+{
+    __bench_l2p_one(0);
+    __bench_l2p_one(64);
+    __bench_l2p_one(AM_NELEMENTS(__g_l2p));
+}
+
+#define __GC_WRITES    60000
+
+static double __g_lat[__GC_WRITES];
+
+static int __double_cmp (const void *p_a, const void *p_b)
+{
+    double a = *(const double *)p_a;
+    double b = *(const double *)p_b;
+
+    return (a < b) ? -1 : (a > b);
+}
+
+/* idle_steps: merge steps run between two writes, 0 without background gc */
+static void __bench_gc_one (int idle_steps)
+{
+    am_ftl_handle_t handle = __ftl_create(0);
+    unsigned long   r, w, e;
+    unsigned        lbn, run = 0, left = 0;
+    int             it;
+
+    if (idle_steps) {
+        am_ftl_gc_jobq_set(handle, (am_jobq_handle_t)&__g_job_pending, 7);
+    }
+
+    srand(11);
+    for (it = 0; it < __GC_WRITES; it++) {
+
+        /* short runs of writes in the same 15 logical blocks */
+        if (left == 0) {
+            run  = rand() % (__g_nlbn / 15);
+            left = 1 + rand() % 12;
+        }
+        left--;
+        lbn = run * 15 + rand() % 15;
+
+        r = __g_reads;
+        w = __g_writes;
+        e = __g_erases;
+        __ftl_write(handle, lbn);
+        __g_lat[it] = (__g_erases - e) * 45.0 + (__g_writes - w) * 0.7 +
+                      (__g_reads - r) * 0.05;
+
+        __jobq_idle(idle_steps);
+    }
+
+    __jobq_idle(1000000);
+    for (lbn = 0; lbn < __g_nlbn; lbn++) {
+        __ftl_check(handle, lbn);
+    }
+
+    qsort(__g_lat, __GC_WRITES, sizeof(__g_lat[0]), __double_cmp);
+    printf("idle steps %2d: write latency p50 %6.2f ms, p99 %6.2f ms, "
+           "p99.9 %6.2f ms, max %6.2f ms, erases %lu\n", idle_steps,
+           __g_lat[__GC_WRITES / 2], __g_lat[__GC_WRITES * 99 / 100],
+           __g_lat[__GC_WRITES * 999 / 1000], __g_lat[__GC_WRITES - 1],
+           __g_erases);
+}
+
+static void __bench_gc (void)
+{
+    static const int idle_steps[] = {0, 8, 16, 32};
+    int              i;
+
+    for (i = 0; i < AM_NELEMENTS(idle_steps); i++) {
+        __g_erases = 0;
+        __bench_gc_one(idle_steps[i]);
+    }
+}
+
+#define __WEAR_CUT_WRITES    20000
+
+static uint32_t __g_wear[__SIM_CHIP_SIZE / __SIM_ERASE_SIZE];
+
+/*
+ * power cut while the block info of a free block is written after its erase:
+ * the magic number and the low 2 bytes of the erase count are programmed
+ */
+static int __wear_tear (am_ftl_serv_t *p_ftl)
+{
+    uint8_t  *p_bci;
+    unsigned  pbn, i;
+
+    for (i = 0; i < p_ftl->nb_blocks; i++) {
+        pbn = rand() % p_ftl->nb_blocks;
+        if (p_ftl->p_free[pbn >> 5] & (1ul << (pbn & 0x1F))) {
+            break;
+        }
+    }
+    if (i == p_ftl->nb_blocks) {
+        return 0;
+    }
+
+    /* the layout of the block info: magic, 4 types, lbn1, lbn2, count */
+    p_bci = &__g_flash[pbn * __SIM_ERASE_SIZE];
+    memset(&p_bci[4], 0xFF, __SIM_ERASE_SIZE - 4);
+    p_bci[12] = (uint8_t)__g_block_erases[pbn];
+    p_bci[13] = (uint8_t)(__g_block_erases[pbn] >> 8);
+
+    return 1;
+}
+
+static void __bench_wear_one (uint32_t wl_threshold, long writes)
+{
+    am_ftl_handle_t    handle = __ftl_create(0);
+    am_ftl_wear_stat_t stat;
+    uint32_t           count, max = 0;
+    unsigned           hist[10] = {0};
+    unsigned           lbn, pbn, invalid = 0, torn = 0;
+    long               it;
+    int                ret;
+
+    __g_info.p_wear       = __g_wear;
+    __g_info.wl_threshold = wl_threshold;
+    handle = am_ftl_init(&__g_ftl, &__g_info, &__g_mtd);
+
+    srand(5);
+    for (lbn = 0; lbn < __g_nlbn; lbn++) {
+        __ftl_write(handle, lbn);
+    }
+
+    for (it = 1; it <= writes; it++) {
+        lbn = (rand() % 1000 < 999) ? rand() % 45 : rand() % __g_nlbn;
+        __ftl_write(handle, lbn);
+
+        if (it % __WEAR_CUT_WRITES == 0) {
+            torn  += __wear_tear(&__g_ftl);
+            handle = am_ftl_init(&__g_ftl, &__g_info, &__g_mtd);
+        }
+    }
+
+    for (lbn = 0; lbn < __g_nlbn; lbn++) {
+        __ftl_check(handle, lbn);
+    }
+
+    /* the histogram of the real counts */
+    for (pbn = 0; pbn < __g_ftl.nb_blocks; pbn++) {
+        if (__g_block_erases[pbn] > max) {
+            max = __g_block_erases[pbn];
+        }
+    }
+    for (pbn = 0; pbn < __g_ftl.nb_blocks; pbn++) {
+        hist[(uint64_t)__g_block_erases[pbn] * 10 / (max + 1)]++;
+
+        ret = am_ftl_wear_get(handle, pbn, &count);
+        if (ret == -AM_EBADMSG) {
+            invalid++;
+        } else if ((ret != AM_OK) || (count > __g_erases)) {
+            printf("pbn %u: erase count %u (%d)\n", pbn, (unsigned)count, ret);
+            __g_errs++;
+        }
+    }
+
+    am_ftl_wear_stat_get(handle, 100000, &stat);
+    if ((stat.max > __g_erases) || (stat.invalid != invalid)) {
+        printf("bad statistics: max %u invalid %u\n",
+               (unsigned)stat.max, (unsigned)stat.invalid);
+        __g_errs++;
+    }
+
+    printf("wl_threshold %2u: %ld writes, %lu erases, %u torn, %u still "
+           "invalid\n", (unsigned)wl_threshold, writes, __g_erases, torn,
+           invalid);
+    printf("  stat: min %u max %u mean %u remain %u remain_ideal %u\n",
+           (unsigned)stat.min, (unsigned)stat.max, (unsigned)stat.mean,
+           (unsigned)stat.remain, (unsigned)stat.remain_ideal);
+    printf("  real counts 0..%u in 10 bins:", (unsigned)max);
+    for (it = 0; it < 10; it++) {
+        printf(" %u", hist[it]);
+    }
+    printf("\n");
+}
+
+static void __bench_wear (long writes)
+{
+    __g_erases = 0;
+    __bench_wear_one(0, writes);
+    __g_erases = 0;
+    __bench_wear_one(32, writes);
+}
+
+#define __MULTI_BLOCKS    1920
+
+/* the time of the flash operations counted so far on a SPI NOR flash, in us */
+static double __sim_time_us (double cmd_us)
+{
+    return (__g_reads + __g_writes) * cmd_us +
+           (__g_read_bytes + __g_write_bytes) * 0.16 +
+           __g_write_pages * 30.0 + __g_write_bytes * 2.5 +
+           __g_erases * 45000.0;
+}
+
+static void __bench_multi_one (unsigned int nblks)
+{
+    static uint8_t  buf[64 * __SIM_LBS];
+    am_ftl_handle_t handle = __ftl_create(0);
+    unsigned long   w0, r0;
+    double          t0[2], t1[2], t2[2];
+    unsigned        lbn, k;
+
+    srand(nblks);
+
+    w0    = __g_writes;
+    t0[0] = __sim_time_us(1.0);
+    t0[1] = __sim_time_us(20.0);
+    for (lbn = 0; lbn < __MULTI_BLOCKS; lbn += nblks) {
+        for (k = 0; k < nblks; k++) {
+            memset(&buf[k * __SIM_LBS], rand(), __SIM_LBS);
+            buf[k * __SIM_LBS] = (uint8_t)(lbn + k);
+            memcpy(__g_ref[lbn + k], &buf[k * __SIM_LBS], __SIM_LBS);
+        }
+        if (am_ftl_write_blocks(handle, lbn, buf, nblks) < 0) {
+            printf("lbn %u: write failed\n", lbn);
+            __g_errs++;
+        }
+    }
+
+    r0    = __g_reads;
+    t1[0] = __sim_time_us(1.0);
+    t1[1] = __sim_time_us(20.0);
+    for (lbn = 0; lbn < __MULTI_BLOCKS; lbn += nblks) {
+        if (am_ftl_read_blocks(handle, lbn, buf, nblks) < 0) {
+            printf("lbn %u: read failed\n", lbn);
+            __g_errs++;
+        }
+        for (k = 0; k < nblks; k++) {
+            if (memcmp(&buf[k * __SIM_LBS], __g_ref[lbn + k], __SIM_LBS) != 0) {
+                printf("lbn %u: read back differs\n", lbn + k);
+                __g_errs++;
+            }
+        }
+    }
+    t2[0] = __sim_time_us(1.0);
+    t2[1] = __sim_time_us(20.0);
+
+    printf("%2u blocks per call: write %4.2f calls/block %3.0f/%3.0f KiB/s, "
+           "read %4.2f calls/block %4.0f/%4.0f KiB/s\n", nblks,
+           (double)(__g_writes - w0) / __MULTI_BLOCKS,
+           __MULTI_BLOCKS * __SIM_LBS / 1024.0 / ((t1[0] - t0[0]) * 1e-6),
+           __MULTI_BLOCKS * __SIM_LBS / 1024.0 / ((t1[1] - t0[1]) * 1e-6),
+           (double)(__g_reads - r0) / __MULTI_BLOCKS,
+           __MULTI_BLOCKS * __SIM_LBS / 1024.0 / ((t2[0] - t1[0]) * 1e-6),
+           __MULTI_BLOCKS * __SIM_LBS / 1024.0 / ((t2[1] - t1[1]) * 1e-6));
+}
+
+static void __bench_multi (void)
+{
+    static const unsigned int nblks[] = {1, 2, 4, 8, 16, 32, 64};
+    int                       i;
+
+    printf("throughput with 1 us / 20 us per command\n");
+    for (i = 0; i < AM_NELEMENTS(nblks); i++) {
+        __bench_multi_one(nblks[i]);
+    }
+}
+
+/*******************************************************************************
+  main
+*******************************************************************************/
+
+int main (int argc, char **argv)
+{
+    const char *p_mode = (argc > 1) ? argv[1] : "l2p";
+
+    if (strcmp(p_mode, "l2p") == 0) {
+        __bench_l2p();
+    } else if (strcmp(p_mode, "gc") == 0) {
+        __bench_gc();
+    } else if (strcmp(p_mode, "wear") == 0) {
+        __bench_wear((argc > 2) ? atol(argv[2]) : 1000000);
+    } else if (strcmp(p_mode, "multi") == 0) {
+        __bench_multi();
+    } else {
+        printf("usage: %s l2p|gc|wear [writes]|multi\n", argv[0]);
+        return 1;
+    }
+
+    printf("errs=%d\n", __g_errs);
+
+    return __g_errs ? 1 : 0;
+}
+
+/* end of file */
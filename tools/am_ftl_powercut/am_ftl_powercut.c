@@ -0,0 +1,422 @@
+/*******************************************************************************
+*                                 AMetal
+*                       ----------------------------
+*                       innovating embedded platform
+*
+* Copyright (c) 2001-2018 Guangzhou ZHIYUAN Electronics Co., Ltd.
+* All rights reserved.
+*
+* Contact information:
+* web site:    http://www.zlg.cn/
+*******************************************************************************/
+
+/**
+ * \file
+ * \brief power-cut, write-error and mount-time simulator for am_ftl (host program)
+ *
+ * The MTD functions are replaced by a simulated NOR flash in RAM (512 KiB,
+ * 4 KiB erase blocks): erasing sets the bytes to 0xFF and programming can only
+ * clear bits. As on a real NOR flash, a 1 bit programmed over a 0 bit leaves
+ * it 0: a merge step retried after a failed write programs the same sector
+ * tag again, with the later fields still 0xFF. Whether the result is right
+ * is checked by reading the data back.
+ *
+ * Every round runs random am_ftl_write(), am_ftl_gc_step() and
+ * am_ftl_checkpoint() calls, then remounts and checks all logical blocks
+ * against a reference model:
+ *  - power cut: after a random number of flash operations the current write
+ *    is torn at a random byte and the round stops at once;
+ *  - write error: a write programs a random part of the data and returns
+ *    -AM_EIO, the round continues without remounting, so the FTL must keep
+ *    its tables consistent and retry the interrupted merge later.
+ * A logical block may hold the data of any interrupted or failed
+ * am_ftl_write() after its last successful write, or the data of that
+ * write. Any other difference is an error.
+ *
+ * The test runs without and with checkpoints (4 blocks). For each, the MTD
+ * reads, the bytes read and the host time of the remounts are printed,
+ * separately for the mounts which loaded a checkpoint (fast) and the mounts
+ * which scanned all blocks (full). The estimated time on a 50 MHz single SPI
+ * NOR flash assumes 1 us per read command plus 160 ns per byte.
+ *
+ * build (from the root of the repository):
+ * \code
+ * gcc -std=gnu99 -O1 -g -Iinterface -Icomponents/service/include       \
+ *     -Icomponents/util/include -Isoc/zlg/zlg217                        \
+ *     tools/am_ftl_powercut/am_ftl_powercut.c                           \
+ *     components/service/source/am_ftl.c -o am_ftl_powercut
+ * ./am_ftl_powercut [rounds] [seed]
+ * \endcode
+ *
+ * The exit status is 0 if no error is found.
+ *
+ * \internal
+ * \par modification history:
+ * - 1.00 26-10-18  agent, first implementation
+ * \endinternal
+ */
+
+#include "am_ftl.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+#include <time.h>
+
+/*******************************************************************************
+  simulated flash
+*******************************************************************************/
+
+#define __SIM_CHIP_SIZE      (512 * 1024)
+#define __SIM_ERASE_SIZE     4096
+
+static uint8_t       __g_flash[__SIM_CHIP_SIZE];
+static am_mtd_serv_t __g_mtd = {
+    AM_MTD_TYPE_NOR_FLASH, 0, __SIM_CHIP_SIZE, __SIM_ERASE_SIZE, 1, 256,
+    NULL, NULL
+};
+
+static long     __g_cut_cnt   = -1;   /* flash operations before power cut */
+static long     __g_fail_cnt  = -1;   /* writes before a write error       */
+static int      __g_injected  = 0;    /* an error was injected in this op  */
+static jmp_buf  __g_cut_jb;
+
+static unsigned long __g_reads;       /* MTD read calls                    */
+static unsigned long __g_read_bytes;  /* bytes read                        */
+
+/* count down a flash operation, cut the power when reached */
+static void __sim_op (void)
+{
+    if ((__g_cut_cnt >= 0) && (__g_cut_cnt-- == 0)) {
+        longjmp(__g_cut_jb, 1);
+    }
+}
+
+/* program len bytes, only 1 -> 0 is possible */
+static void __sim_program (uint32_t addr, const uint8_t *p_buf, uint32_t len)
+{
+    uint32_t i;
+
+    for (i = 0; i < len; i++) {
+        __g_flash[addr + i] &= p_buf[i];
+    }
+}
+
+int am_mtd_erase (am_mtd_handle_t handle, uint32_t addr, uint32_t len)
+{
+    __sim_op();
+    memset(&__g_flash[addr], 0xFF, len);
+
+    return AM_OK;
+}
+
+int am_mtd_read (am_mtd_handle_t handle, uint32_t addr, void *p_buf, uint32_t len)
+{
+    __g_reads++;
+    __g_read_bytes += len;
+    memcpy(p_buf, &__g_flash[addr], len);
+
+    return len;
+}
+
+int am_mtd_write (am_mtd_handle_t  handle,
+                  uint32_t         addr,
+                  const void      *p_buf,
+                  uint32_t         len)
+{
+    if (addr + len > __SIM_CHIP_SIZE) {
+        printf("bug: write 0x%x, %u bytes out of the chip\n",
+               (unsigned)addr, (unsigned)len);
+        exit(2);
+    }
+
+    /* torn by a power cut */
+    if (__g_cut_cnt == 0) {
+        __sim_program(addr, p_buf, rand() % (len + 1));
+        longjmp(__g_cut_jb, 1);
+    }
+    __sim_op();
+
+    if ((__g_fail_cnt >= 0) && (__g_fail_cnt-- == 0)) {
+        __sim_program(addr, p_buf, rand() % (len + 1));
+        __g_injected = 1;
+        return -AM_EIO;
+    }
+
+    __sim_program(addr, p_buf, len);
+
+    return len;
+}
+
+void am_jobq_job_init (am_jobq_job_t  *p_job,
+                       void          (*pfn_func) (void *),
+                       void           *p_arg,
+                       uint16_t        pri)
+{
+}
+
+int am_jobq_post (am_jobq_handle_t handle, am_jobq_job_t *p_job)
+{
+    return AM_OK;
+}
+
+int am_nvram_dev_register (am_nvram_dev_t *p_dev)
+{
+    return AM_OK;
+}
+
+/*******************************************************************************
+  reference model
+*******************************************************************************/
+
+#define __SIM_LBS            256
+#define __SIM_NLOG           3
+#define __SIM_NLBN           200
+#define __SIM_NHOT           8
+
+static uint8_t       __g_ram[AM_FTL_RAM_SIZE_GET(__SIM_CHIP_SIZE,
+                                                 __SIM_ERASE_SIZE,
+                                                 __SIM_LBS,
+                                                 __SIM_NLOG)];
+static am_ftl_l2p_t  __g_l2p[64];
+static am_ftl_info_t __g_info;
+static am_ftl_serv_t __g_ftl;
+static unsigned      __g_nlbn;
+
+/* the data known to be saved, a block never written reads as 0 */
+static uint8_t __g_ref[__SIM_NLBN][__SIM_LBS];
+
+#define __SIM_NALT           16
+
+/* the data of the interrupted or failed writes, may be saved or not */
+static uint8_t __g_alt[__SIM_NLBN][__SIM_NALT][__SIM_LBS];
+static int     __g_alt_num[__SIM_NLBN];
+
+/* check all logical blocks after a remount, the uncertain ones are settled */
+static int __verify (am_ftl_handle_t handle)
+{
+    uint8_t  buf[__SIM_LBS];
+    int      errs = 0;
+    unsigned lbn;
+    int      k;
+
+    for (lbn = 0; lbn < __g_nlbn; lbn++) {
+        if (am_ftl_read(handle, lbn, buf) < 0) {
+            printf("lbn %u: read failed\n", lbn);
+            errs++;
+            continue;
+        }
+
+        for (k = 0; k < __g_alt_num[lbn]; k++) {
+            if (memcmp(buf, __g_alt[lbn][k], __SIM_LBS) == 0) {
+                break;
+            }
+        }
+
+        if (memcmp(buf, __g_ref[lbn], __SIM_LBS) == 0) {
+            /* the old data is kept */
+        } else if (k < __g_alt_num[lbn]) {
+            memcpy(__g_ref[lbn], __g_alt[lbn][k], __SIM_LBS);
+        } else {
+            printf("lbn %u: read back differs (%02x %02x, expect %02x %02x)\n",
+                   lbn, buf[0], buf[1], __g_ref[lbn][0], __g_ref[lbn][1]);
+            errs++;
+        }
+        __g_alt_num[lbn] = 0;
+    }
+
+    return errs;
+}
+
+/*******************************************************************************
+  one configuration
+*******************************************************************************/
+
+/* mount statistics */
+struct __mount_stat {
+    unsigned long count;
+    unsigned long reads;
+    unsigned long bytes;
+    double        seconds;
+};
+
+static double __now_get (void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/*
+ * mount and count the flash reads. a full scan reads the block info of every
+ * block, a mount which loaded a checkpoint reads much less
+ */
+static am_ftl_handle_t __mount (struct __mount_stat *p_fast,
+                                struct __mount_stat *p_full)
+{
+    struct __mount_stat *p_stat;
+    am_ftl_handle_t      handle;
+    unsigned long        r0 = __g_reads;
+    unsigned long        b0 = __g_read_bytes;
+    double               t0 = __now_get();
+
+    handle = am_ftl_init(&__g_ftl, &__g_info, &__g_mtd);
+    if (handle == NULL) {
+        printf("mount failed\n");
+        exit(1);
+    }
+
+    p_stat = (__g_reads - r0 < __SIM_CHIP_SIZE / __SIM_ERASE_SIZE) ? p_fast :
+                                                                     p_full;
+    p_stat->count++;
+    p_stat->reads   += __g_reads - r0;
+    p_stat->bytes   += __g_read_bytes - b0;
+    p_stat->seconds += __now_get() - t0;
+
+    return handle;
+}
+
+static void __mount_stat_print (const char *p_name, struct __mount_stat *p_stat)
+{
+    unsigned long n = p_stat->count ? p_stat->count : 1;
+
+    printf("  %s mounts %4lu: %6lu reads %7lu bytes, %.2f ms on SPI NOR, "
+           "%.1f us host\n", p_name, p_stat->count, p_stat->reads / n,
+           p_stat->bytes / n,
+           (p_stat->reads * 1e-3 + p_stat->bytes * 160e-6) / n,
+           p_stat->seconds * 1e6 / n);
+}
+
+static int __run (size_t ckpt_blocks, int rounds)
+{
+    struct __mount_stat fast = {0}, full = {0};
+    am_ftl_handle_t     handle;
+    uint8_t             buf[__SIM_LBS];
+    unsigned            lbn;
+    int                 round, it, ret, e;
+
+    /* changed between setjmp() and longjmp() */
+    volatile int  errs   = 0;
+    volatile int  apierr = 0;
+    volatile int  cuts   = 0;
+    volatile int  fails  = 0;
+    volatile long ops    = 0;
+
+    memset(__g_flash, 0xFF, sizeof(__g_flash));
+    memset(__g_ref, 0, sizeof(__g_ref));
+    memset(__g_alt_num, 0, sizeof(__g_alt_num));
+    memset(&__g_info, 0, sizeof(__g_info));
+
+    __g_info.p_buf          = __g_ram;
+    __g_info.len            = sizeof(__g_ram);
+    __g_info.logic_blk_size = __SIM_LBS;
+    __g_info.nb_log_blocks  = __SIM_NLOG;
+    __g_info.p_l2p          = __g_l2p;
+    __g_info.l2p_num        = AM_NELEMENTS(__g_l2p);
+    __g_info.ckpt_blocks    = ckpt_blocks;
+
+    handle   = __mount(&fast, &full);
+    __g_nlbn = am_ftl_max_lbn_get(handle);
+    if (__g_nlbn > __SIM_NLBN) {
+        __g_nlbn = __SIM_NLBN;
+    }
+
+    for (round = 0; round < rounds; round++) {
+
+        /* 1/4 power cut, 1/4 write errors, 1/4 both, 1/4 none */
+        __g_cut_cnt  = (round & 1) ? rand() % 1500 : -1;
+        __g_fail_cnt = (round & 2) ? rand() % 300 : -1;
+
+        if (setjmp(__g_cut_jb) == 0) {
+
+            for (it = 0; it < 400; it++) {
+                lbn = rand() % __g_nlbn;
+                if (rand() % 2) {
+                    lbn %= __SIM_NHOT;              /* some hot blocks */
+                }
+
+                memset(buf, rand(), sizeof(buf));
+                buf[0] = (uint8_t)lbn;
+                buf[1] = (uint8_t)round;
+                buf[2] = (uint8_t)it;
+
+                if (__g_alt_num[lbn] == __SIM_NALT) {
+                    continue;
+                }
+                memcpy(__g_alt[lbn][__g_alt_num[lbn]++], buf, sizeof(buf));
+                __g_injected = 0;
+
+                ret = am_ftl_write(handle, lbn, buf);
+                if (ret >= 0) {
+                    memcpy(__g_ref[lbn], buf, sizeof(buf));
+                    __g_alt_num[lbn] = 0;
+                }
+
+                if (rand() % 4 == 0) {
+                    ret = (ret < 0) ? ret : am_ftl_gc_step(handle);
+                }
+                if ((rand() % 100 == 0) && (ckpt_blocks != 0)) {
+                    ret = (ret < 0) ? ret : am_ftl_checkpoint(handle);
+                }
+
+                if (ret < 0) {
+                    if (__g_injected) {
+                        fails++;
+                    } else {
+                        printf("round %d: lbn %u, unexpected error %d\n",
+                               round, lbn, ret);
+                        apierr++;
+                    }
+                }
+
+                ops++;
+            }
+
+            /* a clean shutdown */
+            if ((round % 8 == 0) && (ckpt_blocks != 0)) {
+                am_ftl_checkpoint(handle);
+            }
+        } else {
+            cuts++;
+        }
+
+        __g_cut_cnt  = -1;
+        __g_fail_cnt = -1;
+
+        handle = __mount(&fast, &full);
+
+        e = __verify(handle);
+        if (e) {
+            printf("round %d: %d errors\n", round, e);
+            errs += e;
+        }
+    }
+
+    printf("ckpt_blocks=%u rounds=%d cuts=%d write_errors=%d ops=%ld errs=%d "
+           "apierr=%d\n", (unsigned)ckpt_blocks, rounds, cuts, fails, ops,
+           errs, apierr);
+    __mount_stat_print("fast", &fast);
+    __mount_stat_print("full", &full);
+
+    return errs + apierr;
+}
+
+/*******************************************************************************
+  main
+*******************************************************************************/
+
+int main (int argc, char **argv)
+{
+    int rounds = (argc > 1) ? atoi(argv[1]) : 1000;
+    int errs;
+
+    srand((argc > 2) ? atoi(argv[2]) : 3);
+
+    errs  = __run(0, rounds);
+    errs += __run(4, rounds);
+
+    return errs ? 1 : 0;
+}
+
+/* end of file */
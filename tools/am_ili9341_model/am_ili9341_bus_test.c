@@ -0,0 +1,484 @@
+/*******************************************************************************
+*                                 AMetal
+*                       ----------------------------
+*                       innovating embedded platform
+*
+* Copyright (c) 2001-2018 Guangzhou ZHIYUAN Electronics Co., Ltd.
+* All rights reserved.
+*
+* Contact information:
+* web site:    http://www.zlg.cn/
+*******************************************************************************/
+
+/**
+ * \file
+ * \brief mock-bus test of the bulk and DMA paths of am_ili9341 on the ZLG
+ *        3-wire interface (host program)
+ *
+ * am_zlg_ili9341_3wire_spi.c is included in this file with its data and
+ * status register accessors redirected to a bus model, the am_zlg_dma API is
+ * replaced by a DMA model. The bus model rebuilds the 9-bit frames from the
+ * pairs of bytes written to the data register, decodes the column, page and
+ * memory write commands of the ILI9341 and keeps a 240 x 320 GRAM. am_ili9341.c
+ * is the real one.
+ *
+ * Each drawing runs on three configurations of the same interface:
+ *  - per pixel: the bulk operations removed from the function table, so
+ *    am_ili9341 writes every pixel with pfn_ili9341_data_u16_write, which is
+ *    the behaviour before the bulk operations;
+ *  - FIFO: bulk operations without DMA (dma_chan_tx is -1);
+ *  - DMA: bulk operations with the double buffered DMA.
+ * The GRAM of the FIFO and the DMA runs must be the same as the per pixel
+ * run. The DMA model only reads a buffer when the driver polls the
+ * remaining count or starts the next transfer, so a buffer encoded again
+ * before the transfer completed shows up as wrong pixels. Writing the data
+ * register while a DMA transfer is pending, stopping a channel with data
+ * left and starting one with the DMA request of the SPI disabled are
+ * reported as errors.
+ *
+ * The output is, for each drawing, the number of bytes on the bus, the
+ * number of data register writes by the CPU and of DMA transfers.
+ *
+ * build (from the root of the repository):
+ * \code
+ * gcc -std=gnu99 -O2 -no-pie -Wno-int-to-pointer-cast                       \
+ *     -Wno-pointer-to-int-cast -Iinterface -Isoc/zlg/zlg217                 \
+ *     -Isoc/zlg/drivers/include -Isoc/zlg/drivers/include/spi               \
+ *     -Isoc/zlg/drivers/include/spi/hw -Isoc/zlg/drivers/include/dma        \
+ *     -Isoc/zlg/drivers/include/ili9341 -Isoc/zlg/drivers/source/ili9341    \
+ *     -Icomponents/drivers/include                                          \
+ *     tools/am_ili9341_model/am_ili9341_bus_test.c                          \
+ *     components/drivers/source/lcd/am_ili9341.c -o am_ili9341_bus_test
+ * ./am_ili9341_bus_test
+ * \endcode
+ *
+ * The exit status is 0 if no error is found.
+ *
+ * \internal
+ * \par modification history:
+ * - 1.00 26-10-18  agent, first implementation
+ * \endinternal
+ */
+
+#include "ametal.h"
+#include "am_gpio.h"
+#include "am_clk.h"
+#include "am_delay.h"
+#include "am_ili9341.h"
+#include "hw/amhw_zlg_spi.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void     __bus_tx (uint8_t data);
+static uint32_t __bus_cstat (void);
+
+#define amhw_zlg_spi_tx_data8_put(p, d)  __bus_tx(d)
+#define amhw_zlg_spi_reg_cstat_get(p)    __bus_cstat()
+
+#include "am_zlg_ili9341_3wire_spi.c"
+
+#define __LCD_W         240
+#define __LCD_H         320
+
+#define __CHAN_TX       2
+
+static unsigned long  __g_errs;
+
+/*******************************************************************************
+  platform
+*******************************************************************************/
+
+int am_gpio_pin_cfg (int pin, uint32_t flags)
+{
+    return AM_OK;
+}
+
+int am_gpio_set (int pin, int value)
+{
+    return AM_OK;
+}
+
+int am_clk_enable (am_clk_id_t clk_id)
+{
+    return AM_OK;
+}
+
+int am_clk_rate_get (am_clk_id_t clk_id)
+{
+    return 72000000;
+}
+
+void am_mdelay (uint32_t nms)
+{
+}
+
+void am_udelay (uint32_t nus)
+{
+}
+
+/*******************************************************************************
+  bus: 9-bit frames and the ILI9341 GRAM
+*******************************************************************************/
+
+static uint16_t __g_gram[__LCD_H][__LCD_W];
+
+static uint8_t  __g_cmd;
+static uint8_t  __g_arg[4];
+static int      __g_narg;
+static int      __g_sc, __g_ec, __g_sp, __g_ep;
+static int      __g_cx, __g_cy;
+static int      __g_half;          /* first byte of a pixel received */
+static uint8_t  __g_hi;
+
+static int      __g_frame_half;    /* first byte of a 9-bit frame received */
+static uint8_t  __g_frame_lo;
+
+static unsigned long __g_bus_bytes;
+static unsigned long __g_cpu_writes;
+static unsigned long __g_dma_xfers;
+
+static uint8_t __bit_reverse (uint8_t data)
+{
+    data = (data >> 4) | (data << 4);
+    data = ((data >> 2) & 0x33) | ((data << 2) & 0xCC);
+    data = ((data >> 1) & 0x55) | ((data << 1) & 0xAA);
+
+    return data;
+}
+
+static void __gram_pixel (uint16_t color)
+{
+    if ((__g_cx < __LCD_W) && (__g_cy < __LCD_H)) {
+        __g_gram[__g_cy][__g_cx] = color;
+    }
+    if (++__g_cx > __g_ec) {
+        __g_cx = __g_sc;
+        if (++__g_cy > __g_ep) {
+            __g_cy = __g_sp;
+        }
+    }
+}
+
+/* one decoded frame: a command or a data byte */
+static void __lcd_frame (uint8_t data, int is_data)
+{
+    if (!is_data) {
+        __g_cmd  = data;
+        __g_narg = 0;
+        __g_half = 0;
+        if (data == 0x2C) {
+            __g_cx = __g_sc;
+            __g_cy = __g_sp;
+        }
+        return;
+    }
+
+    switch (__g_cmd) {
+
+    /* the start is taken after two bytes, the cursor only sends the start */
+    case 0x2A:
+    case 0x2B:
+        if (__g_narg < 4) {
+            __g_arg[__g_narg++] = data;
+        }
+        if (__g_narg == 2) {
+            if (__g_cmd == 0x2A) {
+                __g_sc = (__g_arg[0] << 8) | __g_arg[1];
+            } else {
+                __g_sp = (__g_arg[0] << 8) | __g_arg[1];
+            }
+        } else if (__g_narg == 4) {
+            if (__g_cmd == 0x2A) {
+                __g_ec = (__g_arg[2] << 8) | __g_arg[3];
+            } else {
+                __g_ep = (__g_arg[2] << 8) | __g_arg[3];
+            }
+        }
+        break;
+
+    case 0x2C:
+        if (__g_half) {
+            __gram_pixel((__g_hi << 8) | data);
+        } else {
+            __g_hi = data;
+        }
+        __g_half = !__g_half;
+        break;
+
+    default:
+        break;
+    }
+}
+
+/* the frame is sent low byte first, bit 0 selects data or command */
+static void __bus_byte (uint8_t byte)
+{
+    uint32_t frame;
+
+    __g_bus_bytes++;
+
+    if (!__g_frame_half) {
+        __g_frame_lo   = byte;
+        __g_frame_half = 1;
+        return;
+    }
+    __g_frame_half = 0;
+
+    frame = __g_frame_lo | ((uint32_t)byte << 8);
+    __lcd_frame(__bit_reverse((uint8_t)(frame >> 1)), frame & 1);
+}
+
+/*******************************************************************************
+  DMA: the buffer is read when the driver waits for it
+*******************************************************************************/
+
+static amhw_zlg_spi_t  __g_spi_regs;    /* -no-pie keeps it below 4 GB */
+
+static const uint8_t  *__gp_dma_src;
+static uint32_t        __g_dma_left;
+static uint32_t        __g_dma_cfg_nbytes;
+static const uint8_t  *__gp_dma_cfg_src;
+
+static void __dma_complete (void)
+{
+    while (__g_dma_left) {
+        __bus_byte(*__gp_dma_src++);
+        __g_dma_left--;
+    }
+}
+
+int am_zlg_dma_xfer_desc_build (amhw_zlg_dma_xfer_desc_t *p_desc,
+                                uint32_t                  src_addr,
+                                uint32_t                  dst_addr,
+                                uint32_t                  nbytes,
+                                uint32_t                  flags)
+{
+    p_desc->xfercfg  = flags;
+    p_desc->src_addr = src_addr;
+    p_desc->dst_addr = dst_addr;
+    p_desc->nbytes   = nbytes;
+
+    return AM_OK;
+}
+
+int am_zlg_dma_xfer_desc_chan_cfg (amhw_zlg_dma_xfer_desc_t     *p_desc,
+                                   amhw_zlg_dma_transfer_type_t  type,
+                                   uint8_t                       chan)
+{
+    if (__g_dma_left != 0) {
+        printf("DMA reconfigured with %u bytes left\n", (unsigned)__g_dma_left);
+        __g_errs++;
+    }
+    if ((type != AMHW_ZLG_DMA_MER_TO_PER) ||
+        (p_desc->dst_addr != (uint32_t)(uintptr_t)&__g_spi_regs.txreg)) {
+        printf("DMA not to the SPI data register\n");
+        __g_errs++;
+    }
+    __gp_dma_cfg_src   = (const uint8_t *)(uintptr_t)p_desc->src_addr;
+    __g_dma_cfg_nbytes = p_desc->nbytes;
+
+    return AM_OK;
+}
+
+int am_zlg_dma_chan_start (int chan)
+{
+    if (!(__g_spi_regs.gctl & (1u << 9))) {
+        printf("DMA started with the SPI DMA request disabled\n");
+        __g_errs++;
+    }
+    __gp_dma_src  = __gp_dma_cfg_src;
+    __g_dma_left  = __g_dma_cfg_nbytes;
+    __g_dma_xfers++;
+
+    return AM_OK;
+}
+
+int am_zlg_dma_chan_stop (int chan)
+{
+    if (__g_dma_left != 0) {
+        printf("DMA stopped with %u bytes left\n", (unsigned)__g_dma_left);
+        __g_errs++;
+        __g_dma_left = 0;
+    }
+    return AM_OK;
+}
+
+uint16_t am_zlg_dma_tran_data_get (int chan)
+{
+    __dma_complete();
+
+    return 0;
+}
+
+/*******************************************************************************
+  SPI data and status register
+*******************************************************************************/
+
+static void __bus_tx (uint8_t data)
+{
+    if (__g_dma_left != 0) {
+        printf("data register written with a DMA transfer pending\n");
+        __g_errs++;
+    }
+    __g_cpu_writes++;
+    __bus_byte(data);
+}
+
+static uint32_t __bus_cstat (void)
+{
+    return AMHW_ZLG_SPI_CSTAT_TX_EMPTY;
+}
+
+/*******************************************************************************
+  test
+*******************************************************************************/
+
+enum {
+    __CFG_PIXEL = 0,
+    __CFG_FIFO,
+    __CFG_DMA,
+    __CFG_NUM
+};
+
+static const char *__g_cfg_name[__CFG_NUM] = {"per pixel", "FIFO", "DMA"};
+
+static am_zlg_ili9341_intfc_3wire_devinfo_t __g_intfc_info;
+static am_zlg_ili9341_intfc_3wire_dev_t     __g_intfc_dev;
+static am_ili9341_devinfo_t                 __g_lcd_info = {0, 1, 0};
+static am_ili9341_dev_t                     __g_lcd_dev;
+static am_ili9341_handle_t                  __g_lcd;
+
+static struct am_ili9341_drv_funcs          __g_funcs_bulk;
+
+static uint16_t __g_img[40 * 30];
+static uint16_t __g_fb_buf[96 * 24];
+static uint16_t __g_ref[__LCD_H][__LCD_W];
+
+static void __cfg_set (int cfg)
+{
+    __g_intfc_info.dma_chan_tx = (cfg == __CFG_DMA) ? __CHAN_TX : -1;
+
+    __g_ili9341_funcs = __g_funcs_bulk;
+    if (cfg == __CFG_PIXEL) {
+        __g_ili9341_funcs.pfn_ili9341_data_u16_write_buf = NULL;
+        __g_ili9341_funcs.pfn_ili9341_data_u16_fill      = NULL;
+    }
+}
+
+static void __draw (int id)
+{
+    am_ili9341_fb_t fb;
+
+    am_ili9341_back_color_set(__g_lcd, 0x1234);
+    am_ili9341_point_color_set(__g_lcd, 0xF800);
+
+    switch (id) {
+
+    case 0:  am_ili9341_clear(__g_lcd);                                   break;
+    case 1:  am_ili9341_color_fill(__g_lcd, 10, 20, 109, 69, 0x07E0);     break;
+    case 2:  am_ili9341_draw_line(__g_lcd, 5, 100, 200, 100);             break;
+    case 3:  am_ili9341_draw_line(__g_lcd, 50, 10, 50, 300);              break;
+    case 4:  am_ili9341_draw_line(__g_lcd, 10, 10, 200, 90);              break;
+    case 5:  am_ili9341_draw_line(__g_lcd, 200, 10, 180, 300);            break;
+    case 6:  am_ili9341_draw_rectangle(__g_lcd, 20, 30, 150, 200);        break;
+    case 7:  am_ili9341_draw_circle(__g_lcd, 120, 160, 60);               break;
+    case 8:  am_ili9341_show_char(__g_lcd, 30, 40, 'A', 24, 1);           break;
+    case 9:  am_ili9341_show_char(__g_lcd, 30, 40, 'A', 24, 0);           break;
+    case 10: am_ili9341_show_num(__g_lcd, 10, 10, 12345, 6, 16);          break;
+    case 11: am_ili9341_show_string(__g_lcd, 0, 0, 16, 240, 64,
+                                    "Hello, AMetal 0123");                break;
+    case 12: am_ili9341_area_draw_color(__g_lcd, 5, 5, 44, 34,
+                                        (uint8_t *)__g_img, 2, 0);        break;
+
+    /* more than one chunk, with a partial last chunk */
+    case 13: am_ili9341_color_fill(__g_lcd, 0, 0, 36, 2, 0xABCD);         break;
+
+    case 14:
+        am_ili9341_fb_attach(__g_lcd, &fb, __g_fb_buf, 100, 100, 96, 24);
+        am_ili9341_show_num(__g_lcd, 100, 104, 987654, 8, 16);
+        am_ili9341_fb_flush(__g_lcd);
+        am_ili9341_show_num(__g_lcd, 100, 104, 987655, 8, 16);
+        am_ili9341_fb_detach(__g_lcd);
+        break;
+
+    default:
+        break;
+    }
+}
+
+static const char *__g_draw_name[] = {
+    "clear", "fill 100x50", "hline", "vline", "line diag", "line steep",
+    "rect", "circle r60", "char 24 overlay", "char 24 opaque", "num 16",
+    "string 16", "area 40x30", "fill 37x3", "fb num flush"
+};
+
+int main (void)
+{
+    unsigned long bytes[__CFG_NUM], writes[__CFG_NUM], xfers[__CFG_NUM];
+    int           id, cfg, diff, x, y;
+
+    for (x = 0; x < (int)AM_NELEMENTS(__g_img); x++) {
+        __g_img[x] = x * 37;
+    }
+
+    __g_intfc_info.spi_reg_base = &__g_spi_regs;
+    __g_intfc_info.speed_hz     = 18000000;
+    __g_intfc_info.dma_chan_tx  = -1;
+
+    am_ili9341_init(&__g_lcd_dev, &__g_lcd_info,
+                    am_zlg_ili9341_intfc_3wire_init(&__g_intfc_dev,
+                                                    &__g_intfc_info));
+    __g_lcd        = &__g_lcd_dev;
+    __g_funcs_bulk = __g_ili9341_funcs;
+
+    printf("%-16s %-28s %-28s %s\n", "",
+           "per pixel: bytes / writes", "FIFO: bytes / writes",
+           "DMA: bytes / writes / DMA");
+
+    for (id = 0; id < (int)AM_NELEMENTS(__g_draw_name); id++) {
+        for (cfg = 0; cfg < __CFG_NUM; cfg++) {
+            __cfg_set(cfg);
+            memset(__g_gram, 0, sizeof(__g_gram));
+            __g_bus_bytes = __g_cpu_writes = __g_dma_xfers = 0;
+
+            __draw(id);
+
+            if (__g_frame_half || __g_dma_left) {
+                printf("%s: frame or DMA transfer left over\n", __g_cfg_name[cfg]);
+                __g_errs++;
+            }
+
+            bytes[cfg]  = __g_bus_bytes;
+            writes[cfg] = __g_cpu_writes;
+            xfers[cfg]  = __g_dma_xfers;
+
+            if (cfg == __CFG_PIXEL) {
+                memcpy(__g_ref, __g_gram, sizeof(__g_ref));
+                continue;
+            }
+
+            diff = 0;
+            for (y = 0; y < __LCD_H; y++) {
+                for (x = 0; x < __LCD_W; x++) {
+                    diff += (__g_gram[y][x] != __g_ref[y][x]);
+                }
+            }
+            if (diff) {
+                printf("%s %s: %d pixels differ from the per pixel run\n",
+                       __g_draw_name[id], __g_cfg_name[cfg], diff);
+                __g_errs++;
+            }
+        }
+
+        printf("%-16s %8lu / %-17lu %8lu / %-17lu %8lu / %lu / %lu\n",
+               __g_draw_name[id], bytes[0], writes[0], bytes[1], writes[1],
+               bytes[2], writes[2], xfers[2]);
+    }
+
+    printf("errs=%lu\n", __g_errs);
+
+    return __g_errs ? 1 : 0;
+}
+
+/* end of file */
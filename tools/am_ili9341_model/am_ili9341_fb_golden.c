@@ -0,0 +1,484 @@
+/*******************************************************************************
+*                                 AMetal
+*                       ----------------------------
+*                       innovating embedded platform
+*
+* Copyright (c) 2001-2018 Guangzhou ZHIYUAN Electronics Co., Ltd.
+* All rights reserved.
+*
+* Contact information:
+* web site:    http://www.zlg.cn/
+*******************************************************************************/
+
+/**
+ * \file
+ * \brief golden image test of the partial framebuffer of am_ili9341
+ *        (host program)
+ *
+ * am_ili9341.c runs on a GRAM model behind the interface functions: the
+ * column, page and memory write commands are decoded and the pixels are
+ * stored in a 240 x 320 GRAM, every byte on the bus is counted.
+ *
+ * A small user interface (a 6-digit counter, a status string that crosses
+ * the right edge of the framebuffer and a gauge bar) is drawn for 60
+ * frames, once directly to the panel and once through a 120 x 64
+ * framebuffer that is flushed after each frame. The top left 136 x 72
+ * pixels of the GRAM after frames 0, 1, 2 and 59 are compared with the PPM
+ * images in the golden directory, for both runs. The images are only
+ * written with -w, from the direct run, a differing image is written to the
+ * current directory as <name>_<run>.fail.ppm to be viewed.
+ *
+ * Then 200 random sequences of lines, circles, fills, characters, points
+ * and blits, part of them crossing the edge of a framebuffer at a random
+ * place, are drawn directly and through the framebuffer with flushes at
+ * random points, the GRAM must be the same.
+ *
+ * The output is the number of bus bytes per frame of both runs and of a
+ * frame that changes nothing.
+ *
+ * build and run with several dirty rectangle numbers (from the root of the
+ * repository):
+ * \code
+ * for n in 1 2 4 8; do
+ *     gcc -std=gnu99 -O2 -Iinterface -Isoc/zlg/zlg217                       \
+ *         -Icomponents/drivers/include -DAM_ILI9341_FB_DIRTY_NUM=$n          \
+ *         tools/am_ili9341_model/am_ili9341_fb_golden.c                      \
+ *         components/drivers/source/lcd/am_ili9341.c -o am_ili9341_fb_golden \
+ *     && ./am_ili9341_fb_golden tools/am_ili9341_model/golden
+ * done
+ * \endcode
+ *
+ * The exit status is 0 if no error is found.
+ *
+ * \internal
+ * \par modification history:
+ * - 1.00 26-10-18  agent, first implementation
+ * \endinternal
+ */
+
+#include "ametal.h"
+#include "am_gpio.h"
+#include "am_delay.h"
+#include "am_ili9341.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define __LCD_W         240
+#define __LCD_H         320
+
+#define __IMG_W         136         /* golden image, top left of the GRAM */
+#define __IMG_H         72
+
+#define __FRAMES        60
+
+static unsigned long __g_errs;
+
+/*******************************************************************************
+  platform
+*******************************************************************************/
+
+int am_gpio_pin_cfg (int pin, uint32_t flags)
+{
+    return AM_OK;
+}
+
+int am_gpio_set (int pin, int value)
+{
+    return AM_OK;
+}
+
+void am_mdelay (uint32_t nms)
+{
+}
+
+/*******************************************************************************
+  GRAM
+*******************************************************************************/
+
+static uint16_t      __g_gram[__LCD_H][__LCD_W];
+
+static uint8_t       __g_cmd;
+static uint8_t       __g_arg[4];
+static int           __g_narg;
+static int           __g_sc, __g_ec, __g_sp, __g_ep;
+static int           __g_cx, __g_cy;
+static int           __g_half;
+static uint8_t       __g_hi;
+
+static unsigned long __g_bytes;
+
+static void __gram_pixel (uint16_t color)
+{
+    if ((__g_cx < __LCD_W) && (__g_cy < __LCD_H)) {
+        __g_gram[__g_cy][__g_cx] = color;
+    }
+    if (++__g_cx > __g_ec) {
+        __g_cx = __g_sc;
+        if (++__g_cy > __g_ep) {
+            __g_cy = __g_sp;
+        }
+    }
+}
+
+static void __gram_byte (uint8_t data)
+{
+    __g_bytes++;
+
+    switch (__g_cmd) {
+
+    /* the start is taken after two bytes, the cursor only sends the start */
+    case 0x2A:
+    case 0x2B:
+        if (__g_narg < 4) {
+            __g_arg[__g_narg++] = data;
+        }
+        if (__g_narg == 2) {
+            if (__g_cmd == 0x2A) {
+                __g_sc = (__g_arg[0] << 8) | __g_arg[1];
+            } else {
+                __g_sp = (__g_arg[0] << 8) | __g_arg[1];
+            }
+        } else if (__g_narg == 4) {
+            if (__g_cmd == 0x2A) {
+                __g_ec = (__g_arg[2] << 8) | __g_arg[3];
+            } else {
+                __g_ep = (__g_arg[2] << 8) | __g_arg[3];
+            }
+        }
+        break;
+
+    case 0x2C:
+        if (__g_half) {
+            __gram_pixel((__g_hi << 8) | data);
+        } else {
+            __g_hi = data;
+        }
+        __g_half = !__g_half;
+        break;
+
+    default:
+        break;
+    }
+}
+
+static int __lcd_cmd (void *p_drv, uint8_t cmd)
+{
+    __g_bytes++;
+    __g_cmd  = cmd;
+    __g_narg = 0;
+    __g_half = 0;
+    if (cmd == 0x2C) {
+        __g_cx = __g_sc;
+        __g_cy = __g_sp;
+    }
+    return AM_OK;
+}
+
+static int __lcd_u8 (void *p_drv, uint8_t data)
+{
+    __gram_byte(data);
+
+    return AM_OK;
+}
+
+static int __lcd_u16 (void *p_drv, uint16_t data)
+{
+    __gram_byte(data >> 8);
+    __gram_byte(data);
+
+    return AM_OK;
+}
+
+static int __lcd_u16_buf (void *p_drv, const uint16_t *p_buf, uint32_t count)
+{
+    while (count--) {
+        __lcd_u16(p_drv, *p_buf++);
+    }
+    return AM_OK;
+}
+
+static int __lcd_u16_fill (void *p_drv, uint16_t data, uint32_t count)
+{
+    while (count--) {
+        __lcd_u16(p_drv, data);
+    }
+    return AM_OK;
+}
+
+static struct am_ili9341_drv_funcs __g_funcs = {
+    __lcd_cmd,
+    __lcd_u8,
+    __lcd_u16,
+    NULL,
+    NULL,
+    __lcd_u16_buf,
+    __lcd_u16_fill,
+};
+
+static am_ili9341_serv_t    __g_serv    = {&__g_funcs, NULL};
+static am_ili9341_devinfo_t __g_devinfo = {0, 1, 0};
+static am_ili9341_dev_t     __g_dev;
+
+/*******************************************************************************
+  PPM
+*******************************************************************************/
+
+static uint8_t __g_img[__IMG_H * __IMG_W * 3];
+static uint8_t __g_file[sizeof(__g_img) + 32];
+
+static int __img_make (void)
+{
+    uint8_t  *p = __g_img;
+    uint16_t  c;
+    int       x, y;
+
+    for (y = 0; y < __IMG_H; y++) {
+        for (x = 0; x < __IMG_W; x++) {
+            c    = __g_gram[y][x];
+            *p++ = (c >> 11) << 3;
+            *p++ = ((c >> 5) & 0x3F) << 2;
+            *p++ = (c & 0x1F) << 3;
+        }
+    }
+    return sprintf((char *)__g_file, "P6\n%d %d\n255\n", __IMG_W, __IMG_H);
+}
+
+static void __img_write (const char *p_path)
+{
+    int   len = __img_make();
+    FILE *p_f = fopen(p_path, "wb");
+
+    if (p_f == NULL) {
+        printf("cannot write %s\n", p_path);
+        __g_errs++;
+        return;
+    }
+    fwrite(__g_file, 1, len, p_f);
+    fwrite(__g_img, 1, sizeof(__g_img), p_f);
+    fclose(p_f);
+}
+
+static void __img_check (const char *p_dir, const char *p_name, const char *p_run)
+{
+    char   path[256];
+    int    len = __img_make();
+    size_t n   = 0;
+    FILE  *p_f;
+
+    sprintf(path, "%s/%s.ppm", p_dir, p_name);
+    p_f = fopen(path, "rb");
+    if (p_f != NULL) {
+        n = fread(__g_file + len, 1, sizeof(__g_file) - len, p_f);
+        fclose(p_f);
+    }
+
+    /* the expected header is at the start of __g_file, the file after it */
+    if ((n != (size_t)len + sizeof(__g_img)) ||
+        memcmp(__g_file, __g_file + len, len) ||
+        memcmp(__g_file + len + len, __g_img, sizeof(__g_img))) {
+        printf("%s %s: differs from %s\n", p_run, p_name, path);
+        sprintf(path, "%s_%s.fail.ppm", p_name, p_run);
+        __img_write(path);
+        __g_errs++;
+    }
+}
+
+/*******************************************************************************
+  drawing
+*******************************************************************************/
+
+/* one frame: a counter, a status string and a gauge bar */
+static void __frame (am_ili9341_handle_t handle, int i)
+{
+    char str[32];
+
+    am_ili9341_point_color_set(handle, 0xFFE0);
+    am_ili9341_show_num(handle, 8, 8, 1000 + i * 7, 6, 24);
+
+    sprintf(str, "T=%02d.%dC", 20 + i % 5, i % 10);
+    am_ili9341_point_color_set(handle, 0x07FF);
+    am_ili9341_show_string(handle, 8, 36, 16, 120, 16, str);
+
+    am_ili9341_color_fill(handle, 8, 56, 8 + (i * 13) % 100, 60, 0x07E0);
+    am_ili9341_color_fill(handle, 9 + (i * 13) % 100, 56, 108, 60, 0x0000);
+}
+
+static int __rnd (int n)
+{
+    return rand() % n;
+}
+
+static void __random_draw (am_ili9341_handle_t handle)
+{
+    static uint16_t img[20 * 10];
+
+    int x0 = __rnd(__LCD_W), y0 = __rnd(__LCD_H);
+    int x1 = __rnd(__LCD_W), y1 = __rnd(__LCD_H);
+    int t, i;
+
+    am_ili9341_point_color_set(handle, __rnd(65536));
+
+    switch (__rnd(6)) {
+
+    case 0:
+        am_ili9341_draw_line(handle, x0, y0, x1, y1);
+        break;
+
+    case 1:
+        if (x0 > x1) {
+            t = x0; x0 = x1; x1 = t;
+        }
+        if (y0 > y1) {
+            t = y0; y0 = y1; y1 = t;
+        }
+        am_ili9341_color_fill(handle, x0, y0, x1, y1, __rnd(65536));
+        break;
+
+    case 2:
+        am_ili9341_draw_circle(handle, 40 + __rnd(160), 40 + __rnd(240),
+                               __rnd(38));
+        break;
+
+    case 3:
+        am_ili9341_show_char(handle, __rnd(__LCD_W - 12), __rnd(__LCD_H - 24),
+                             ' ' + __rnd(95), 24, __rnd(2));
+        break;
+
+    case 4:
+        am_ili9341_draw_point(handle, x0, y0, __rnd(65536));
+        break;
+
+    default:
+        for (i = 0; i < (int)AM_NELEMENTS(img); i++) {
+            img[i] = __rnd(65536);
+        }
+        x0 = __rnd(__LCD_W - 20);
+        y0 = __rnd(__LCD_H - 10);
+        am_ili9341_area_draw_color(handle, x0, y0, x0 + 19, y0 + 9,
+                                   (uint8_t *)img, 2, 0);
+        break;
+    }
+}
+
+static uint16_t        __g_ref[__LCD_H][__LCD_W];
+static uint16_t        __g_fb_buf[120 * 80];
+static am_ili9341_fb_t __g_fb;
+
+int main (int argc, char **argv)
+{
+    static const int frame_chk[] = {0, 1, 2, __FRAMES - 1};
+
+    am_ili9341_handle_t handle;
+    const char         *p_dir;
+    am_bool_t           write = AM_FALSE;
+    unsigned long       bytes_direct = 0, bytes_fb = 0;
+    char                name[32];
+    int                 i, k, seed, fx, fy;
+
+    if ((argc > 2) && (strcmp(argv[1], "-w") == 0)) {
+        write = AM_TRUE;
+        argv++;
+        argc--;
+    }
+    if (argc != 2) {
+        printf("usage: %s [-w] golden_dir\n", argv[0]);
+        return 1;
+    }
+    p_dir = argv[1];
+
+    handle = am_ili9341_init(&__g_dev, &__g_devinfo, &__g_serv);
+    am_ili9341_back_color_set(handle, 0x0010);
+
+    /* direct drawing */
+    am_ili9341_clear(handle);
+    for (i = 0, k = 0; i < __FRAMES; i++) {
+        __g_bytes = 0;
+        __frame(handle, i);
+        bytes_direct += __g_bytes;
+
+        if (i == frame_chk[k]) {
+            sprintf(name, "frame_%02d", i);
+            if (write) {
+                char path[256];
+
+                sprintf(path, "%s/%s.ppm", p_dir, name);
+                __img_write(path);
+            } else {
+                __img_check(p_dir, name, "direct");
+            }
+            k++;
+        }
+    }
+    memcpy(__g_ref, __g_gram, sizeof(__g_ref));
+
+    /* through a 120 x 64 framebuffer, the string crosses its right edge */
+    memset(__g_gram, 0xAA, sizeof(__g_gram));
+    am_ili9341_clear(handle);
+    am_ili9341_fb_attach(handle, &__g_fb, __g_fb_buf, 0, 0, 120, 64);
+    for (i = 0, k = 0; i < __FRAMES; i++) {
+        __g_bytes = 0;
+        __frame(handle, i);
+        am_ili9341_fb_flush(handle);
+        bytes_fb += __g_bytes;
+
+        if (i == frame_chk[k]) {
+            sprintf(name, "frame_%02d", i);
+            __img_check(p_dir, name, "fb");
+            k++;
+        }
+    }
+    if (memcmp(__g_ref, __g_gram, sizeof(__g_ref))) {
+        printf("framebuffer run differs from the direct run\n");
+        __g_errs++;
+    }
+
+    __g_bytes = 0;
+    __frame(handle, __FRAMES - 1);
+    am_ili9341_fb_flush(handle);
+    am_ili9341_fb_detach(handle);
+
+    printf("AM_ILI9341_FB_DIRTY_NUM=%d\n", AM_ILI9341_FB_DIRTY_NUM);
+    printf("bus bytes per frame: direct %lu, framebuffer %lu, "
+           "unchanged frame %lu\n",
+           bytes_direct / __FRAMES, bytes_fb / __FRAMES, __g_bytes);
+
+    /* random drawings, part of them crossing the framebuffer edge */
+    for (seed = 1; seed <= 200; seed++) {
+        srand(seed);
+        memset(__g_gram, 0, sizeof(__g_gram));
+        am_ili9341_clear(handle);
+        for (k = 0; k < 40; k++) {
+            __random_draw(handle);
+        }
+        memcpy(__g_ref, __g_gram, sizeof(__g_ref));
+
+        srand(seed);
+        fx = __rnd(120);
+        fy = __rnd(200);
+        srand(seed);
+        memset(__g_gram, 0, sizeof(__g_gram));
+        am_ili9341_clear(handle);
+        am_ili9341_fb_attach(handle, &__g_fb, __g_fb_buf, fx, fy, 120, 80);
+        am_ili9341_fb_flush(handle);
+        for (k = 0; k < 40; k++) {
+            __random_draw(handle);
+            if (k % 7 == 6) {
+                am_ili9341_fb_flush(handle);
+            }
+        }
+        am_ili9341_fb_detach(handle);
+
+        if (memcmp(__g_ref, __g_gram, sizeof(__g_ref))) {
+            printf("random drawing %d: framebuffer at (%d, %d) differs\n",
+                   seed, fx, fy);
+            __g_errs++;
+        }
+    }
+
+    printf("errs=%lu\n", __g_errs);
+
+    return __g_errs ? 1 : 0;
+}
+
+/* end of file */
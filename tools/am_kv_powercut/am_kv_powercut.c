@@ -0,0 +1,367 @@
+/*******************************************************************************
+*                                 AMetal
+*                       ----------------------------
+*                       innovating embedded platform
+*
+* Copyright (c) 2001-2018 Guangzhou ZHIYUAN Electronics Co., Ltd.
+* All rights reserved.
+*
+* Contact information:
+* web site:    http://www.zlg.cn/
+*******************************************************************************/
+
+/**
+ * \file
+ * \brief power-cut and write-error simulator for am_kv (host program)
+ *
+ * The MTD functions are replaced by a simulated NOR flash in RAM: erasing sets
+ * the bytes to 0xFF and programming can only clear bits, programming a bit
+ * back to 1 is reported as a bug of am_kv.
+ *
+ * Every round runs random set/del/gc operations, then remounts and checks all
+ * keys against a reference model:
+ *  - power cut: after a random number of flash operations the current write
+ *    is torn at a random byte and the round stops at once;
+ *  - write error: a write programs a random part of the data and returns
+ *    -AM_EIO, the round continues without remounting.
+ * The key being changed by an interrupted or failed operation may hold the
+ * old or the new value, any other difference is an error.
+ *
+ * build (from the root of the repository):
+ * \code
+ * gcc -std=gnu99 -O1 -g -Iinterface -Icomponents/service/include       \
+ *     -Icomponents/util/include -Isoc/zlg/zlg217                        \
+ *     tools/am_kv_powercut/am_kv_powercut.c                             \
+ *     components/service/source/am_kv.c -o am_kv_powercut
+ * ./am_kv_powercut [rounds] [seed]
+ * \endcode
+ *
+ * The exit status is 0 if no error is found.
+ *
+ * \internal
+ * \par modification history:
+ * - 1.00 26-10-18  agent, first implementation
+ * \endinternal
+ */
+
+#include "am_kv.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+
+/*******************************************************************************
+  simulated flash
+*******************************************************************************/
+
+#define __SIM_CHIP_SIZE      (64 * 1024)
+#define __SIM_ERASE_SIZE     4096
+
+static uint8_t       __g_flash[__SIM_CHIP_SIZE];
+static am_mtd_serv_t __g_mtd = {
+    AM_MTD_TYPE_NOR_FLASH, 0, __SIM_CHIP_SIZE, __SIM_ERASE_SIZE, 1, 256,
+    NULL, NULL
+};
+
+static long     __g_cut_cnt   = -1;   /* flash operations before power cut */
+static long     __g_fail_cnt  = -1;   /* writes before a write error       */
+static int      __g_injected  = 0;    /* an error was injected in this op  */
+static jmp_buf  __g_cut_jb;
+
+/* count down a flash operation, cut the power when reached */
+static void __sim_op (void)
+{
+    if ((__g_cut_cnt >= 0) && (__g_cut_cnt-- == 0)) {
+        longjmp(__g_cut_jb, 1);
+    }
+}
+
+/* program len bytes, only 1 -> 0 is possible */
+static void __sim_program (uint32_t addr, const uint8_t *p_buf, uint32_t len)
+{
+    uint32_t i;
+
+    for (i = 0; i < len; i++) {
+        if ((__g_flash[addr + i] & p_buf[i]) != p_buf[i]) {
+            printf("bug: program 0x%02x over 0x%02x at 0x%x\n",
+                   p_buf[i], __g_flash[addr + i], (unsigned)(addr + i));
+            exit(2);
+        }
+        __g_flash[addr + i] &= p_buf[i];
+    }
+}
+
+int am_mtd_erase (am_mtd_handle_t handle, uint32_t addr, uint32_t len)
+{
+    __sim_op();
+    memset(&__g_flash[addr], 0xFF, len);
+
+    return AM_OK;
+}
+
+int am_mtd_read (am_mtd_handle_t handle, uint32_t addr, void *p_buf, uint32_t len)
+{
+    memcpy(p_buf, &__g_flash[addr], len);
+
+    return len;
+}
+
+int am_mtd_write (am_mtd_handle_t  handle,
+                  uint32_t         addr,
+                  const void      *p_buf,
+                  uint32_t         len)
+{
+    if ((addr + len > __SIM_CHIP_SIZE) ||
+        (addr / __SIM_ERASE_SIZE != (addr + len - 1) / __SIM_ERASE_SIZE)) {
+        printf("bug: write 0x%x, %u bytes crosses a block\n",
+               (unsigned)addr, (unsigned)len);
+        exit(2);
+    }
+
+    /* torn by a power cut */
+    if (__g_cut_cnt == 0) {
+        __sim_program(addr, p_buf, rand() % (len + 1));
+        longjmp(__g_cut_jb, 1);
+    }
+    __sim_op();
+
+    if ((__g_fail_cnt >= 0) && (__g_fail_cnt-- == 0)) {
+        __sim_program(addr, p_buf, rand() % (len + 1));
+        __g_injected = 1;
+        return -AM_EIO;
+    }
+
+    __sim_program(addr, p_buf, len);
+
+    return len;
+}
+
+int am_mtd_writev (am_mtd_handle_t       handle,
+                   uint32_t              addr,
+                   const am_mtd_iovec_t *p_iov,
+                   int                   iovcnt)
+{
+    uint8_t  buf[__SIM_ERASE_SIZE];
+    uint32_t len = 0;
+    int      i;
+
+    /* a single program operation, may be torn at any byte */
+    for (i = 0; i < iovcnt; i++) {
+        memcpy(&buf[len], p_iov[i].p_buf, p_iov[i].len);
+        len += p_iov[i].len;
+    }
+
+    return am_mtd_write(handle, addr, buf, len);
+}
+
+void am_jobq_job_init (am_jobq_job_t  *p_job,
+                       void          (*pfn_func) (void *),
+                       void           *p_arg,
+                       uint16_t        pri)
+{
+}
+
+int am_jobq_post (am_jobq_handle_t handle, am_jobq_job_t *p_job)
+{
+    return AM_OK;
+}
+
+/*******************************************************************************
+  reference model
+*******************************************************************************/
+
+#define __SIM_NKEYS      60
+#define __SIM_VAL_MAX    80
+#define __SIM_NINDEX     256
+
+static uint8_t      __g_ram[AM_KV_RAM_SIZE_GET(__SIM_CHIP_SIZE,
+                                               __SIM_ERASE_SIZE,
+                                               __SIM_NINDEX)];
+static am_kv_info_t __g_info = {__g_ram, sizeof(__g_ram), __SIM_NINDEX};
+static am_kv_serv_t __g_kv;
+
+/* the value known to be saved, len -1 means the key doesn't exist */
+static uint8_t __g_ref[__SIM_NKEYS][__SIM_VAL_MAX];
+static int     __g_ref_len[__SIM_NKEYS];
+
+/* the value of an interrupted or failed operation, may be saved or not */
+static uint8_t __g_alt[__SIM_NKEYS][__SIM_VAL_MAX];
+static int     __g_alt_len[__SIM_NKEYS];
+static int     __g_alt_valid[__SIM_NKEYS];
+
+static void __key_name (char *p_buf, int k)
+{
+    sprintf(p_buf, "key_%d_%s", k, (k % 3) ? "x" : "longer_name");
+}
+
+static int __val_match (const uint8_t *p_val, int len, const uint8_t *p_exp, int exp_len)
+{
+    if (exp_len < 0) {
+        return len == -AM_ENOENT;
+    }
+    return (len == exp_len) && (memcmp(p_val, p_exp, len) == 0);
+}
+
+/* check all keys after a remount, the uncertain keys are settled */
+static int __verify (am_kv_handle_t handle)
+{
+    char    name[40];
+    uint8_t val[__SIM_VAL_MAX];
+    int     errs = 0;
+    int     k, len;
+
+    for (k = 0; k < __SIM_NKEYS; k++) {
+        __key_name(name, k);
+        len = am_kv_get(handle, name, val, sizeof(val));
+
+        if (__val_match(val, len, __g_ref[k], __g_ref_len[k])) {
+            /* the old value is kept */
+        } else if (__g_alt_valid[k] &&
+                   __val_match(val, len, __g_alt[k], __g_alt_len[k])) {
+            __g_ref_len[k] = __g_alt_len[k];
+            memcpy(__g_ref[k], __g_alt[k], sizeof(__g_ref[k]));
+        } else {
+            printf("key %d: got %d, expect %d\n", k, len, __g_ref_len[k]);
+            errs++;
+        }
+        __g_alt_valid[k] = 0;
+    }
+
+    return errs;
+}
+
+/* the operation on key k succeeded */
+static void __commit (int k, const uint8_t *p_val, int len)
+{
+    __g_ref_len[k]   = len;
+    __g_alt_valid[k] = 0;
+    if (len > 0) {
+        memcpy(__g_ref[k], p_val, len);
+    }
+}
+
+/* the operation on key k may or may not be saved */
+static void __uncertain (int k, const uint8_t *p_val, int len)
+{
+    __g_alt_len[k]   = len;
+    __g_alt_valid[k] = 1;
+    if (len > 0) {
+        memcpy(__g_alt[k], p_val, len);
+    }
+}
+
+/*******************************************************************************
+  main
+*******************************************************************************/
+
+int main (int argc, char **argv)
+{
+    int  rounds = (argc > 1) ? atoi(argv[1]) : 2000;
+    int  round, it, k, len, i, ret, e;
+
+    /* changed between setjmp() and longjmp() */
+    volatile int  errs   = 0;
+    volatile int  apierr = 0;
+    volatile int  cuts   = 0;
+    volatile int  fails  = 0;
+    volatile long ops    = 0;
+
+    char            name[40];
+    uint8_t         val[__SIM_VAL_MAX];
+    am_kv_handle_t  handle;
+    am_kv_stat_t    stat;
+
+    srand((argc > 2) ? atoi(argv[2]) : 3);
+    memset(__g_flash, 0xFF, sizeof(__g_flash));
+
+    for (k = 0; k < __SIM_NKEYS; k++) {
+        __g_ref_len[k] = -1;
+    }
+
+    handle = am_kv_init(&__g_kv, &__g_info, &__g_mtd);
+    if (handle == NULL) {
+        printf("init failed\n");
+        return 1;
+    }
+
+    for (round = 0; round < rounds; round++) {
+
+        /* 1/4 power cut, 1/4 write errors, 1/4 both, 1/4 none */
+        __g_cut_cnt  = (round & 1) ? rand() % 400 : -1;
+        __g_fail_cnt = (round & 2) ? rand() % 100 : -1;
+
+        if (setjmp(__g_cut_jb) == 0) {
+
+            for (it = 0; it < 300; it++) {
+                k = rand() % __SIM_NKEYS;
+                if (rand() % 2) {
+                    k %= 6;                         /* some hot keys */
+                }
+                __key_name(name, k);
+                __g_injected = 0;
+
+                if (rand() % 8 == 0) {
+                    __uncertain(k, NULL, -1);
+                    ret = am_kv_del(handle, name);
+                    if (ret == AM_OK) {
+                        __commit(k, NULL, -1);
+                    }
+                } else {
+                    len = rand() % ((k < 6) ? 8 : (__SIM_VAL_MAX - 10));
+                    for (i = 0; i < len; i++) {
+                        val[i] = (uint8_t)rand();
+                    }
+                    __uncertain(k, val, len);
+                    ret = am_kv_set(handle, name, val, len);
+                    if (ret == AM_OK) {
+                        __commit(k, val, len);
+                    }
+                }
+
+                if ((ret != AM_OK) && (ret != -AM_ENOENT)) {
+                    if (__g_injected) {
+                        fails++;
+                    } else {
+                        printf("round %d: key %d, unexpected error %d\n",
+                               round, k, ret);
+                        apierr++;
+                    }
+                }
+
+                ops++;
+
+                if (rand() % 5 == 0) {
+                    am_kv_gc_step(handle);
+                }
+            }
+        } else {
+            cuts++;
+        }
+
+        __g_cut_cnt  = -1;
+        __g_fail_cnt = -1;
+
+        handle = am_kv_init(&__g_kv, &__g_info, &__g_mtd);
+        if (handle == NULL) {
+            printf("round %d: remount failed\n", round);
+            return 1;
+        }
+
+        e = __verify(handle);
+        if (e) {
+            printf("round %d: %d errors\n", round, e);
+            errs += e;
+        }
+    }
+
+    am_kv_stat_get(handle, &stat);
+    printf("rounds=%d cuts=%d write_errors=%d ops=%ld errs=%d apierr=%d "
+           "keys=%u live=%u capacity=%u free_blocks=%u\n",
+           rounds, cuts, fails, ops, errs, apierr,
+           (unsigned)stat.nkeys, (unsigned)stat.live_bytes,
+           (unsigned)stat.capacity, (unsigned)stat.free_blocks);
+
+    return (errs || apierr) ? 1 : 0;
+}
+
+/* end of file */
@@ -0,0 +1,368 @@
+/*******************************************************************************
+*                                 AMetal
+*                       ----------------------------
+*                       innovating embedded platform
+*
+* Copyright (c) 2001-2018 Guangzhou ZHIYUAN Electronics Co., Ltd.
+* All rights reserved.
+*
+* Contact information:
+* web site:    http://www.zlg.cn/
+*******************************************************************************/
+
+/**
+ * \file
+ * \brief write amplification of am_kv and the am_ftl NVRAM path (host program)
+ *
+ * Two simulated NOR flashes of 64 KiB with 4 KiB erase blocks are used, one
+ * holds an am_kv store, the other an am_ftl (256-byte logical blocks, 3 log
+ * blocks) registered as an NVRAM device with am_ftl_nvram_init(). The same
+ * updates are applied to both:
+ *  - counters: 8 counters of 4 bytes, a random one is updated each time;
+ *  - records:  16 configuration records of 16 to 64 bytes, a random one is
+ *    rewritten each time.
+ * With am_kv each counter or record is a key, with am_ftl each is an NVRAM
+ * segment (all in the first logical blocks, as in a board segment table).
+ *
+ * The output is the number of bytes programmed and blocks erased per update
+ * and the write amplification (bytes programmed / bytes of payload). The
+ * values read back from both stores are checked at the end, and am_kv is
+ * remounted and checked again.
+ *
+ * build (from the root of the repository):
+ * \code
+ * gcc -std=gnu99 -O2 -Iinterface -Icomponents/service/include                \
+ *     -Icomponents/util/include -Isoc/zlg/zlg217                             \
+ *     tools/am_kv_wa/am_kv_wa.c components/service/source/am_kv.c            \
+ *     components/service/source/am_ftl.c                                     \
+ *     components/service/source/am_nvram.c -o am_kv_wa
+ * ./am_kv_wa [updates] [seed]
+ * \endcode
+ *
+ * The exit status is 0 if no error is found.
+ *
+ * \internal
+ * \par modification history:
+ * - 1.00 26-10-18  agent, first implementation
+ * \endinternal
+ */
+
+#include "am_kv.h"
+#include "am_ftl.h"
+#include "am_nvram.h"
+#include "am_int.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define __SIM_CHIP_SIZE      (64 * 1024)
+#define __SIM_ERASE_SIZE     4096
+
+#define __FTL_LBS            256
+#define __FTL_NLOG           3
+
+#define __NCOUNTERS          8
+#define __NRECORDS           16
+#define __RECORD_MAX         64
+
+/*******************************************************************************
+  simulated flash, one per store
+*******************************************************************************/
+
+typedef struct __sim_flash {
+    am_mtd_serv_t  mtd;                   /* the handle points here */
+    uint8_t        data[__SIM_CHIP_SIZE];
+    unsigned long  wr_bytes;
+    unsigned long  erases;
+} __sim_flash_t;
+
+static __sim_flash_t __g_kv_flash;
+static __sim_flash_t __g_ftl_flash;
+
+static unsigned long __g_errs;
+
+static void __sim_init (__sim_flash_t *p_sim)
+{
+    memset(p_sim, 0, sizeof(*p_sim));
+    memset(p_sim->data, 0xFF, sizeof(p_sim->data));
+    p_sim->mtd.type           = AM_MTD_TYPE_NOR_FLASH;
+    p_sim->mtd.size           = __SIM_CHIP_SIZE;
+    p_sim->mtd.erase_size     = __SIM_ERASE_SIZE;
+    p_sim->mtd.write_size     = 1;
+    p_sim->mtd.write_buf_size = 256;
+}
+
+int am_mtd_erase (am_mtd_handle_t handle, uint32_t addr, uint32_t len)
+{
+    __sim_flash_t *p_sim = (__sim_flash_t *)handle;
+
+    p_sim->erases += len / __SIM_ERASE_SIZE;
+    memset(&p_sim->data[addr], 0xFF, len);
+
+    return AM_OK;
+}
+
+int am_mtd_read (am_mtd_handle_t  handle,
+                 uint32_t         addr,
+                 void            *p_buf,
+                 uint32_t         len)
+{
+    __sim_flash_t *p_sim = (__sim_flash_t *)handle;
+
+    memcpy(p_buf, &p_sim->data[addr], len);
+
+    return len;
+}
+
+/* programming only clears bits */
+int am_mtd_write (am_mtd_handle_t  handle,
+                  uint32_t         addr,
+                  const void      *p_buf,
+                  uint32_t         len)
+{
+    __sim_flash_t *p_sim = (__sim_flash_t *)handle;
+    uint32_t       i;
+
+    p_sim->wr_bytes += len;
+    for (i = 0; i < len; i++) {
+        p_sim->data[addr + i] &= ((const uint8_t *)p_buf)[i];
+    }
+
+    return len;
+}
+
+int am_mtd_writev (am_mtd_handle_t       handle,
+                   uint32_t              addr,
+                   const am_mtd_iovec_t *p_iov,
+                   int                   iovcnt)
+{
+    int len = 0;
+    int i;
+
+    for (i = 0; i < iovcnt; i++) {
+        am_mtd_write(handle, addr + len, p_iov[i].p_buf, p_iov[i].len);
+        len += p_iov[i].len;
+    }
+
+    return len;
+}
+
+/*******************************************************************************
+  platform stubs, compaction and GC run in the foreground
+*******************************************************************************/
+
+uint32_t am_int_cpu_lock (void)
+{
+    return 0;
+}
+
+void am_int_cpu_unlock (uint32_t key)
+{
+    (void)key;
+}
+
+void am_jobq_job_init (am_jobq_job_t  *p_job,
+                       am_pfnvoid_t    func,
+                       void           *p_arg,
+                       uint16_t        pri)
+{
+    (void)pri;
+
+    p_job->func  = func;
+    p_job->p_arg = p_arg;
+}
+
+int am_jobq_post (am_jobq_handle_t handle, am_jobq_job_t *p_job)
+{
+    (void)handle;
+    (void)p_job;
+
+    return AM_OK;
+}
+
+/*******************************************************************************
+  stores
+*******************************************************************************/
+
+static uint8_t        __g_kv_ram[AM_KV_RAM_SIZE_GET(__SIM_CHIP_SIZE,
+                                                    __SIM_ERASE_SIZE, 64)];
+static am_kv_info_t   __g_kv_info = {__g_kv_ram, sizeof(__g_kv_ram), 64};
+static am_kv_serv_t   __g_kv;
+
+static uint8_t        __g_ftl_ram[AM_FTL_RAM_SIZE_GET(__SIM_CHIP_SIZE,
+                                                      __SIM_ERASE_SIZE,
+                                                      __FTL_LBS,
+                                                      __FTL_NLOG)];
+static am_ftl_info_t  __g_ftl_info;
+static am_ftl_serv_t  __g_ftl;
+static am_nvram_dev_t __g_ftl_nvram;
+
+static char __g_ftl_name[] = "ftl";
+
+/* the segments of both workloads, one segment per counter or record */
+static char __g_cnt_name[] = "counter";
+static char __g_rec_name[] = "record";
+
+static am_nvram_segment_t __g_segs[__NCOUNTERS + __NRECORDS + 1];
+
+static uint32_t __g_rec_size[__NRECORDS];
+static uint8_t  __g_ref[__NCOUNTERS + __NRECORDS][__RECORD_MAX];
+
+static void __segs_build (void)
+{
+    uint32_t addr = 0;
+    int      i;
+
+    for (i = 0; i < __NCOUNTERS; i++) {
+        __g_segs[i].p_name     = __g_cnt_name;
+        __g_segs[i].unit       = i;
+        __g_segs[i].seg_addr   = addr;
+        __g_segs[i].seg_size   = 4;
+        __g_segs[i].p_dev_name = __g_ftl_name;
+        addr += 4;
+    }
+    for (i = 0; i < __NRECORDS; i++) {
+        __g_rec_size[i] = 16 + (i * 16) % 64;
+        __g_segs[__NCOUNTERS + i].p_name     = __g_rec_name;
+        __g_segs[__NCOUNTERS + i].unit       = i;
+        __g_segs[__NCOUNTERS + i].seg_addr   = addr;
+        __g_segs[__NCOUNTERS + i].seg_size   = __g_rec_size[i];
+        __g_segs[__NCOUNTERS + i].p_dev_name = __g_ftl_name;
+        addr += __g_rec_size[i];
+    }
+}
+
+static void __key_get (char *p_key, int idx)
+{
+    if (idx < __NCOUNTERS) {
+        sprintf(p_key, "cnt%d", idx);
+    } else {
+        sprintf(p_key, "rec%d", idx - __NCOUNTERS);
+    }
+}
+
+static void __stores_create (am_kv_handle_t *p_kv)
+{
+    __sim_init(&__g_kv_flash);
+    __sim_init(&__g_ftl_flash);
+
+    *p_kv = am_kv_init(&__g_kv, &__g_kv_info, &__g_kv_flash.mtd);
+
+    memset(&__g_ftl_info, 0, sizeof(__g_ftl_info));
+    __g_ftl_info.p_buf          = __g_ftl_ram;
+    __g_ftl_info.len            = sizeof(__g_ftl_ram);
+    __g_ftl_info.logic_blk_size = __FTL_LBS;
+    __g_ftl_info.nb_log_blocks  = __FTL_NLOG;
+
+    am_nvram_init(__g_segs);
+    if ((*p_kv == NULL) ||
+        (am_ftl_init(&__g_ftl, &__g_ftl_info, &__g_ftl_flash.mtd) == NULL) ||
+        (am_ftl_nvram_init(&__g_ftl, &__g_ftl_nvram, __g_ftl_name) != AM_OK)) {
+        printf("init failed\n");
+        exit(2);
+    }
+}
+
+static void __verify (am_kv_handle_t kv, int first, int num, const char *p_what)
+{
+    uint8_t buf[__RECORD_MAX];
+    char    key[16];
+    int     i, len;
+
+    for (i = first; i < first + num; i++) {
+        len = (i < __NCOUNTERS) ? 4 : __g_rec_size[i - __NCOUNTERS];
+        __key_get(key, i);
+        if ((am_kv_get(kv, key, buf, sizeof(buf)) != len) ||
+            (memcmp(buf, __g_ref[i], len) != 0)) {
+            printf("%s: am_kv %s differs\n", p_what, key);
+            __g_errs++;
+        }
+        /* the FTL read path returns what am_mtd_read() returns */
+        memset(buf, 0, sizeof(buf));
+        if ((am_nvram_get(__g_segs[i].p_name, __g_segs[i].unit,
+                          buf, 0, len) < 0) ||
+            (memcmp(buf, __g_ref[i], len) != 0)) {
+            printf("%s: am_ftl %s differs\n", p_what, key);
+            __g_errs++;
+        }
+    }
+}
+
+/*******************************************************************************
+  benchmark
+*******************************************************************************/
+
+static void __bench (const char *p_name, int first, int num, long updates)
+{
+    am_kv_handle_t kv;
+    uint8_t        val[__RECORD_MAX];
+    char           key[16];
+    unsigned long  payload = 0;
+    long           n;
+    int            i, k, len;
+
+    __stores_create(&kv);
+
+    for (n = 0; n < updates; n++) {
+        i   = first + rand() % num;
+        len = (i < __NCOUNTERS) ? 4 : __g_rec_size[i - __NCOUNTERS];
+        for (k = 0; k < len; k++) {
+            val[k] = (uint8_t)rand();
+        }
+        memcpy(__g_ref[i], val, len);
+        payload += len;
+
+        __key_get(key, i);
+        if (am_kv_set(kv, key, val, len) != AM_OK) {
+            printf("am_kv_set %s failed\n", key);
+            __g_errs++;
+        }
+        if (am_nvram_set(__g_segs[i].p_name, __g_segs[i].unit,
+                         val, 0, len) != AM_OK) {
+            printf("am_nvram_set %s failed\n", key);
+            __g_errs++;
+        }
+    }
+
+    __verify(kv, first, num, p_name);
+
+    printf("%s: %ld updates, %.1f payload bytes each\n",
+           p_name, updates, (double)payload / updates);
+    printf("  am_kv : %7.1f B programmed/update, WA %5.1f, "
+           "%6.4f erases/update\n",
+           (double)__g_kv_flash.wr_bytes / updates,
+           (double)__g_kv_flash.wr_bytes / payload,
+           (double)__g_kv_flash.erases / updates);
+    printf("  am_ftl: %7.1f B programmed/update, WA %5.1f, "
+           "%6.4f erases/update\n",
+           (double)__g_ftl_flash.wr_bytes / updates,
+           (double)__g_ftl_flash.wr_bytes / payload,
+           (double)__g_ftl_flash.erases / updates);
+
+    /* the records survive a remount */
+    kv = am_kv_init(&__g_kv, &__g_kv_info, &__g_kv_flash.mtd);
+    if (kv == NULL) {
+        printf("%s: am_kv remount failed\n", p_name);
+        __g_errs++;
+        return;
+    }
+    __verify(kv, first, num, p_name);
+}
+
+int main (int argc, char **argv)
+{
+    long     updates = (argc > 1) ? atol(argv[1]) : 100000;
+    unsigned seed    = (argc > 2) ? strtoul(argv[2], NULL, 0) : 1;
+
+    srand(seed);
+    __segs_build();
+
+    __bench("counters", 0, __NCOUNTERS, updates);
+    __bench("records", __NCOUNTERS, __NRECORDS, updates);
+
+    printf("errs=%lu\n", __g_errs);
+
+    return __g_errs ? 1 : 0;
+}
+
+/* end of file */
@@ -0,0 +1,178 @@
+/*******************************************************************************
+*                                 AMetal
+*                       ----------------------------
+*                       innovating embedded platform
+*
+* Copyright (c) 2001-2018 Guangzhou ZHIYUAN Electronics Co., Ltd.
+* All rights reserved.
+*
+* Contact information:
+* web site:    http://www.zlg.cn/
+*******************************************************************************/
+
+/**
+ * \file
+ * \brief random alloc/realloc/free stress test for am_memheap (host program)
+ *
+ * Up to 2000 blocks are allocated, resized and freed in random order. Most
+ * requests are small, one in eight is up to 4000 bytes, so the heap gets
+ * fragmented. Every block is filled with a pattern derived from its slot,
+ * and the pattern is checked before each free or realloc, so overlapping
+ * blocks or a realloc that loses data are reported.
+ *
+ * At the end all blocks are freed and a single block of almost the whole
+ * heap is requested, which only succeeds if all free blocks were merged.
+ *
+ * build and run both free-block modes (from the root of the repository):
+ * \code
+ * for tlsf in 0 1; do
+ *     gcc -std=gnu99 -O2 -Iinterface -Isoc/zlg/zlg217                    \
+ *         -DAM_MEMHEAP_TLSF_EN=$tlsf                                     \
+ *         tools/am_memheap_stress/am_memheap_stress.c                    \
+ *         components/util/source/am_memheap.c -o am_memheap_stress       \
+ *     && ./am_memheap_stress [ops] [seed]
+ * done
+ * \endcode
+ *
+ * The output lists the failed allocations (heap full) and the host time per
+ * operation, which includes filling and checking the blocks. The exit status
+ * is 0 if no error is found.
+ *
+ * \internal
+ * \par modification history:
+ * - 1.00 26-10-18  agent, first implementation
+ * \endinternal
+ */
+
+#include "am_memheap.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define __SIM_HEAP_SIZE    (256 * 1024)
+#define __SIM_NBLKS        2000
+
+/* the final request leaves room for the block headers */
+#define __SIM_BIG_SIZE     (__SIM_HEAP_SIZE - 200)
+
+static uint64_t       __g_pool[__SIM_HEAP_SIZE / 8];
+static unsigned char *__g_blk[__SIM_NBLKS];
+static size_t         __g_len[__SIM_NBLKS];
+
+static size_t __size_get (void)
+{
+    return rand() % ((rand() % 8 == 0) ? 4000 : 200) + 1;
+}
+
+static void __fill (int i, size_t from, size_t to)
+{
+    size_t k;
+
+    for (k = from; k < to; k++) {
+        __g_blk[i][k] = (unsigned char)(i + k);
+    }
+}
+
+static int __check (int i, size_t len)
+{
+    size_t k;
+
+    for (k = 0; k < len; k++) {
+        if (__g_blk[i][k] != (unsigned char)(i + k)) {
+            printf("block %d: corrupted at byte %u\n", i, (unsigned)k);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int main (int argc, char **argv)
+{
+    long               ops   = (argc > 1) ? atol(argv[1]) : 3000000;
+    unsigned long      fails = 0;
+    struct am_memheap  heap;
+    unsigned char     *p;
+    size_t             n;
+    clock_t            t0;
+    double             secs;
+    long               it;
+    int                i;
+
+    srand((argc > 2) ? atoi(argv[2]) : 3);
+
+    if (am_memheap_init(&heap, "stress", __g_pool, sizeof(__g_pool)) != AM_OK) {
+        printf("init failed\n");
+        return 1;
+    }
+
+    t0 = clock();
+
+    for (it = 0; it < ops; it++) {
+        i = rand() % __SIM_NBLKS;
+
+        if (__g_blk[i] == NULL) {
+            n = __size_get();
+            p = am_memheap_alloc(&heap, n);
+            if (p == NULL) {
+                fails++;
+                continue;
+            }
+            if (am_memheap_memsize(&heap, p) < n) {
+                printf("block %d: memsize smaller than requested\n", i);
+                return 1;
+            }
+            __g_blk[i] = p;
+            __g_len[i] = n;
+            __fill(i, 0, n);
+            continue;
+        }
+
+        if (__check(i, __g_len[i]) != 0) {
+            return 1;
+        }
+
+        if (rand() % 4 == 0) {
+            n = __size_get();
+            p = am_memheap_realloc(&heap, __g_blk[i], n);
+            if (p == NULL) {
+                fails++;                      /* the old block is kept */
+                continue;
+            }
+            __g_blk[i] = p;
+            if (__check(i, (n < __g_len[i]) ? n : __g_len[i]) != 0) {
+                return 1;
+            }
+            if (n > __g_len[i]) {
+                __fill(i, __g_len[i], n);
+            }
+            __g_len[i] = n;
+        } else {
+            am_memheap_free(__g_blk[i]);
+            __g_blk[i] = NULL;
+        }
+    }
+
+    secs = (double)(clock() - t0) / CLOCKS_PER_SEC;
+
+    for (i = 0; i < __SIM_NBLKS; i++) {
+        if (__g_blk[i] != NULL) {
+            if (__check(i, __g_len[i]) != 0) {
+                return 1;
+            }
+            am_memheap_free(__g_blk[i]);
+        }
+    }
+
+    p = am_memheap_alloc(&heap, __SIM_BIG_SIZE);
+
+    printf("tlsf=%d ops=%ld fails=%lu %.1f ns/op available=%u/%u "
+           "coalesced=%s\n",
+           AM_MEMHEAP_TLSF_EN, ops, fails, secs * 1e9 / ops,
+           (unsigned)heap.available_size, (unsigned)heap.pool_size,
+           p ? "yes" : "no");
+
+    return (p != NULL) ? 0 : 1;
+}
+
+/* end of file */
@@ -0,0 +1,241 @@
+/*******************************************************************************
+*                                 AMetal
+*                       ----------------------------
+*                       innovating embedded platform
+*
+* Copyright (c) 2001-2018 Guangzhou ZHIYUAN Electronics Co., Ltd.
+* All rights reserved.
+*
+* Contact information:
+* web site:    http://www.zlg.cn/
+*******************************************************************************/
+
+/**
+ * \file
+ * \brief functional test and get/put timing for am_mempool (host program)
+ *
+ * The test covers a static pool (AM_MEMPOOL_DECL_STATIC) and a pool created
+ * from the heap:
+ *  - every block can be taken once, the next get fails and is counted;
+ *  - blocks lie inside the storage, are aligned and do not overlap;
+ *  - putting a pointer that is not a block start is rejected;
+ *  - random get/put keeps the free count, the high-water mark and the block
+ *    contents consistent with a reference model.
+ *
+ * Then the host time of a get/put pair is compared with malloc/free.
+ *
+ * build (from the root of the repository):
+ * \code
+ * gcc -std=gnu99 -O2 -Iinterface -Isoc/zlg/zlg217                        \
+ *     tools/am_mempool_test/am_mempool_test.c                            \
+ *     components/util/source/am_mempool.c -o am_mempool_test
+ * ./am_mempool_test
+ * \endcode
+ *
+ * The exit status is 0 if no error is found.
+ *
+ * \internal
+ * \par modification history:
+ * - 1.00 26-10-18  agent, first implementation
+ * \endinternal
+ */
+
+#include "am_mempool.h"
+#include "am_mem.h"
+#include "am_int.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define __TEST_BLK_SIZE    13
+#define __TEST_NBLKS       64
+#define __TEST_BENCH_OPS   10000000
+
+#define __TEST_CHECK(cond)                                                 \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            printf("line %d: check failed: %s\n", __LINE__, #cond);        \
+            __g_errs++;                                                    \
+        }                                                                  \
+    } while (0)
+
+AM_MEMPOOL_DECL_STATIC(__g_static_pool, __TEST_BLK_SIZE, __TEST_NBLKS);
+
+static int __g_errs = 0;
+
+uint32_t am_int_cpu_lock (void)
+{
+    return 0;
+}
+
+void am_int_cpu_unlock (uint32_t key)
+{
+    (void)key;
+}
+
+void *am_mem_alloc (size_t size)
+{
+    return malloc(size);
+}
+
+void am_mem_free (void *p_mem)
+{
+    free(p_mem);
+}
+
+/* take all blocks, check their placement, give them back */
+static void __test_exhaust (am_mempool_t *p_pool, size_t nblks)
+{
+    void              *blk[__TEST_NBLKS];
+    am_mempool_stat_t  stat;
+    uint8_t           *p;
+    size_t             size = AM_MEMPOOL_BLK_SIZE(__TEST_BLK_SIZE);
+    size_t             i, j;
+
+    for (i = 0; i < nblks; i++) {
+        blk[i] = am_mempool_get(p_pool);
+        __TEST_CHECK(blk[i] != NULL);
+        if (blk[i] == NULL) {
+            return;
+        }
+        p = (uint8_t *)blk[i];
+        __TEST_CHECK(((uintptr_t)p % sizeof(void *)) == 0);
+        __TEST_CHECK((p >= p_pool->p_start) &&
+                     (p + size <= p_pool->p_start + nblks * size));
+        for (j = 0; j < i; j++) {
+            __TEST_CHECK(blk[j] != blk[i]);
+        }
+        memset(p, (int)i, size);
+    }
+
+    __TEST_CHECK(am_mempool_get(p_pool) == NULL);
+    __TEST_CHECK(am_mempool_put(p_pool, (uint8_t *)blk[0] + 1) == -AM_EINVAL);
+    __TEST_CHECK(am_mempool_put(p_pool, p_pool->p_start + nblks * size) ==
+                 -AM_EINVAL);
+
+    for (i = 0; i < nblks; i++) {
+        p = (uint8_t *)blk[i];
+        __TEST_CHECK((p[0] == (uint8_t)i) && (p[size - 1] == (uint8_t)i));
+        __TEST_CHECK(am_mempool_put(p_pool, blk[i]) == AM_OK);
+    }
+
+    __TEST_CHECK(am_mempool_stat_get(p_pool, &stat) == AM_OK);
+    __TEST_CHECK(stat.blk_size == size);
+    __TEST_CHECK(stat.nblks == nblks);
+    __TEST_CHECK(stat.nfree == nblks);
+    __TEST_CHECK(stat.max_used == nblks);
+    __TEST_CHECK(stat.fail_cnt == 1);
+}
+
+/* random get/put against a reference model */
+static void __test_random (am_mempool_t *p_pool, size_t nblks, long ops)
+{
+    uint8_t           *blk[__TEST_NBLKS];
+    size_t             used = 0, max_used, i;
+    am_mempool_stat_t  stat;
+    long               it;
+
+    am_mempool_stat_get(p_pool, &stat);
+    max_used = stat.max_used;
+
+    for (it = 0; it < ops; it++) {
+        if ((used < nblks) && ((used == 0) || (rand() % 2))) {
+            blk[used] = am_mempool_get(p_pool);
+            __TEST_CHECK(blk[used] != NULL);
+            if (blk[used] == NULL) {
+                return;
+            }
+            memset(blk[used], (int)(it & 0xFF), __TEST_BLK_SIZE);
+            blk[used][0] = (uint8_t)used;
+            used++;
+            if (used > max_used) {
+                max_used = used;
+            }
+        } else {
+            i = rand() % used;
+            __TEST_CHECK(blk[i][0] == (uint8_t)i);
+            __TEST_CHECK(am_mempool_put(p_pool, blk[i]) == AM_OK);
+            if (i != --used) {
+                blk[i]    = blk[used];
+                blk[i][0] = (uint8_t)i;
+            }
+        }
+
+        if ((it & 1023) == 0) {
+            am_mempool_stat_get(p_pool, &stat);
+            __TEST_CHECK(stat.nfree == nblks - used);
+            __TEST_CHECK(stat.max_used == max_used);
+        }
+    }
+
+    while (used) {
+        __TEST_CHECK(am_mempool_put(p_pool, blk[--used]) == AM_OK);
+    }
+}
+
+/* host ns per get/put pair, keeping a few blocks in use */
+static void __bench (am_mempool_t *p_pool)
+{
+    void    *blk[4];
+    clock_t  t0;
+    double   pool_ns, heap_ns;
+    long     it;
+    int      i;
+
+    t0 = clock();
+    for (it = 0; it < __TEST_BENCH_OPS; it++) {
+        for (i = 0; i < 4; i++) {
+            blk[i] = am_mempool_get(p_pool);
+        }
+        for (i = 3; i >= 0; i--) {
+            am_mempool_put(p_pool, blk[i]);
+        }
+    }
+    pool_ns = (double)(clock() - t0) * 1e9 / CLOCKS_PER_SEC /
+              (4.0 * __TEST_BENCH_OPS);
+
+    t0 = clock();
+    for (it = 0; it < __TEST_BENCH_OPS; it++) {
+        for (i = 0; i < 4; i++) {
+            blk[i] = malloc(__TEST_BLK_SIZE);
+            *(volatile char *)blk[i] = 0;
+        }
+        for (i = 3; i >= 0; i--) {
+            free(blk[i]);
+        }
+    }
+    heap_ns = (double)(clock() - t0) * 1e9 / CLOCKS_PER_SEC /
+              (4.0 * __TEST_BENCH_OPS);
+
+    printf("get+put %.1f ns, malloc+free %.1f ns\n", pool_ns, heap_ns);
+}
+
+int main (void)
+{
+    am_mempool_t pool;
+
+    srand(1);
+
+    __TEST_CHECK(AM_MEMPOOL_INIT(__g_static_pool, __TEST_BLK_SIZE) == AM_OK);
+    __test_exhaust(&__g_static_pool.pool, __TEST_NBLKS);
+    __test_random(&__g_static_pool.pool, __TEST_NBLKS, 1000000);
+
+    __TEST_CHECK(am_mempool_create(&pool, __TEST_BLK_SIZE, __TEST_NBLKS / 2) ==
+                 AM_OK);
+    __test_exhaust(&pool, __TEST_NBLKS / 2);
+    __test_random(&pool, __TEST_NBLKS / 2, 1000000);
+    am_mempool_destroy(&pool);
+
+    __TEST_CHECK(am_mempool_init(&pool, __g_static_pool.buf, 1,
+                                 __TEST_BLK_SIZE) == -AM_EINVAL);
+    __TEST_CHECK(am_mempool_get(NULL) == NULL);
+
+    __bench(&__g_static_pool.pool);
+
+    printf("errs=%d\n", __g_errs);
+
+    return __g_errs ? 1 : 0;
+}
+
+/* end of file */
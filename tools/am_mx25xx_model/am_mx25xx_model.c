@@ -0,0 +1,616 @@
+/*******************************************************************************
+*                                 AMetal
+*                       ----------------------------
+*                       innovating embedded platform
+*
+* Copyright (c) 2001-2018 Guangzhou ZHIYUAN Electronics Co., Ltd.
+* All rights reserved.
+*
+* Contact information:
+* web site:    http://www.zlg.cn/
+*******************************************************************************/
+
+/**
+ * \file
+ * \brief timed flash model for the am_mx25xx async program/erase (host program)
+ *
+ * The SPI controller is replaced by a timed MX25L1606E model (2 MiB, typical
+ * tPP 1.4 ms, tSE 60 ms, tBE 0.7 s, tCE 14 s, each with +/-20% jitter, 20 MHz
+ * SPI with 3 us per message). Time is virtual: SPI message completions and
+ * softimer expiries (on 1 ms ticks) are events run in time order.
+ *
+ * The model rejects a program or erase without WEL or while busy, and a read
+ * while busy, like the device ignores them. The CPU time is counted as:
+ *  - synchronous calls: the whole wall time, the driver spins on the status;
+ *  - async calls: 5 us per message completion, 2 us per softimer callback and
+ *    0.8 us per byte moved by the SPI interrupt.
+ *
+ * Every run erases 16 sectors, writes 64 KiB and erases 2 blocks, first with
+ * the synchronous calls then with am_mx25xx_erase_async()/_write_async(), and
+ * checks the data, that a synchronous call returns -AM_EBUSY while an async
+ * operation is in flight, and the am_mtd_erase_start() path.
+ *
+ * build (from the root of the repository):
+ * \code
+ * gcc -std=gnu99 -O2 -Iinterface -Icomponents/drivers/include                 \
+ *     -Icomponents/service/include -Isoc/zlg/zlg217                          \
+ *     tools/am_mx25xx_model/am_mx25xx_model.c                                \
+ *     components/drivers/source/flash/am_mx25xx.c                            \
+ *     components/service/source/am_mtd.c                                     \
+ *     components/service/source/am_spi.c -o am_mx25xx_model
+ * ./am_mx25xx_model [rounds] [seed]
+ * \endcode
+ *
+ * The exit status is 0 if no error is found.
+ *
+ * \internal
+ * \par modification history:
+ * - 1.00 26-10-18  agent, first implementation
+ * \endinternal
+ */
+
+#include "am_mx25xx.h"
+#include "am_mtd.h"
+#include "am_wait.h"
+#include "am_int.h"
+#include "am_system.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define __SIM_CHIP_SIZE    (2u << 20)
+#define __SIM_EVENTS_MAX   16
+
+/* event types */
+#define __SIM_EV_SPI       0
+#define __SIM_EV_TIMER     1
+
+typedef struct __sim_event {
+    double  t_us;
+    int     type;
+    void   *p_obj;
+} __sim_event_t;
+
+static __sim_event_t  __g_ev[__SIM_EVENTS_MAX];
+static int            __g_nev;
+
+static double         __g_now_us;
+static double         __g_cpu_us;
+static double         __g_bus_us;
+static double         __g_bus_free_us;
+static unsigned long  __g_rdsr;
+static am_bool_t      __g_async;
+static unsigned long  __g_errs;
+
+/* flash state */
+static uint8_t        __g_flash[__SIM_CHIP_SIZE];
+static double         __g_busy_until_us;
+static am_bool_t      __g_wel;
+
+/*******************************************************************************
+  virtual time
+*******************************************************************************/
+
+static void __ev_add (double t_us, int type, void *p_obj)
+{
+    if (__g_nev == __SIM_EVENTS_MAX) {
+        printf("event queue full\n");
+        exit(2);
+    }
+    __g_ev[__g_nev].t_us  = t_us;
+    __g_ev[__g_nev].type  = type;
+    __g_ev[__g_nev].p_obj = p_obj;
+    __g_nev++;
+}
+
+static void __ev_del (void *p_obj)
+{
+    int i;
+
+    for (i = 0; i < __g_nev; i++) {
+        if (__g_ev[i].p_obj == p_obj) {
+            __g_ev[i--] = __g_ev[--__g_nev];
+        }
+    }
+}
+
+/* run the earliest event, the time in between is CPU time if spinning */
+static void __ev_run_one (void)
+{
+    __sim_event_t ev;
+    int           i, k = 0;
+
+    if (__g_nev == 0) {
+        printf("nothing to wait for\n");
+        exit(2);
+    }
+    for (i = 1; i < __g_nev; i++) {
+        if (__g_ev[i].t_us < __g_ev[k].t_us) {
+            k = i;
+        }
+    }
+    ev          = __g_ev[k];
+    __g_ev[k]   = __g_ev[--__g_nev];
+
+    if (ev.t_us > __g_now_us) {
+        if (!__g_async) {
+            __g_cpu_us += ev.t_us - __g_now_us;
+        }
+        __g_now_us = ev.t_us;
+    }
+
+    if (ev.type == __SIM_EV_SPI) {
+        am_spi_message_t *p_msg = (am_spi_message_t *)ev.p_obj;
+
+        if (__g_async) {
+            __g_cpu_us += 5;
+        }
+        p_msg->status = AM_OK;
+        p_msg->pfn_complete(p_msg->p_arg);
+    } else {
+        am_softimer_t *p_timer = (am_softimer_t *)ev.p_obj;
+
+        if (__g_async) {
+            __g_cpu_us += 2;
+        }
+        p_timer->timeout_callback(p_timer->p_arg);
+    }
+}
+
+/*******************************************************************************
+  MX25L1606E model
+*******************************************************************************/
+
+static double __jitter (double t_us)
+{
+    return t_us * (0.8 + 0.4 * rand() / (double)RAND_MAX);
+}
+
+static int __spi_msg_start (void             *p_drv,
+                            am_spi_device_t  *p_dev,
+                            am_spi_message_t *p_msg)
+{
+    struct am_list_head *p_node;
+    am_spi_transfer_t   *p_trans;
+    uint8_t              cmd[4] = {0};
+    uint32_t             addr   = 0;
+    uint32_t             off    = 0;
+    uint32_t             nbytes = 0;
+    uint32_t             i, size;
+    am_bool_t            first  = AM_TRUE;
+    am_bool_t            busy;
+    double               start, dur;
+
+    (void)p_drv;
+    (void)p_dev;
+
+    start = (__g_now_us > __g_bus_free_us) ? __g_now_us : __g_bus_free_us;
+    busy  = start < __g_busy_until_us;
+
+    am_list_for_each(p_node, &p_msg->transfers) {
+        p_trans = am_list_entry(p_node, am_spi_transfer_t, trans_node);
+        nbytes += p_trans->nbytes;
+
+        /* the first transfer holds the command and the address */
+        if (first) {
+            memcpy(cmd, p_trans->p_txbuf, p_trans->nbytes > 4 ? 4 : p_trans->nbytes);
+            addr  = ((uint32_t)cmd[1] << 16) | (cmd[2] << 8) | cmd[3];
+            first = AM_FALSE;
+            continue;
+        }
+
+        switch (cmd[0]) {
+
+        case 0x05:                                          /* RDSR */
+            ((uint8_t *)p_trans->p_rxbuf)[0] = (busy ? 0x01 : 0) |
+                                               (__g_wel ? 0x02 : 0);
+            __g_rdsr++;
+            break;
+
+        case 0x03:                                          /* READ */
+        case 0x0B:                                          /* FAST_READ */
+            if (busy) {
+                printf("read at %06x while busy\n", (unsigned)addr);
+                __g_errs++;
+            }
+            memcpy(p_trans->p_rxbuf, &__g_flash[(addr + off) % __SIM_CHIP_SIZE],
+                   p_trans->nbytes);
+            off += p_trans->nbytes;
+            break;
+
+        case 0x02:                                          /* PP */
+            if (busy || !__g_wel) {
+                break;
+            }
+            for (i = 0; i < p_trans->nbytes; i++) {
+                uint32_t pa = (addr & ~0xFFu) | ((addr + off + i) & 0xFFu);
+
+                __g_flash[pa] &= ((const uint8_t *)p_trans->p_txbuf)[i];
+            }
+            off += p_trans->nbytes;
+            break;
+
+        case 0x9F:                                          /* RDID */
+            ((uint8_t *)p_trans->p_rxbuf)[0] = 0xC2;
+            ((uint8_t *)p_trans->p_rxbuf)[1] = 0x20;
+            ((uint8_t *)p_trans->p_rxbuf)[2] = 0x15;
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    switch (cmd[0]) {
+
+    case 0x06:                                              /* WREN */
+        if (!busy) {
+            __g_wel = AM_TRUE;
+        }
+        break;
+
+    case 0x04:                                              /* WRDI */
+        if (!busy) {
+            __g_wel = AM_FALSE;
+        }
+        break;
+
+    case 0x02:
+        if (busy || !__g_wel) {
+            printf("page program at %06x rejected\n", (unsigned)addr);
+            __g_errs++;
+            break;
+        }
+        __g_busy_until_us = start + nbytes * 0.4 + __jitter(1400);
+        __g_wel           = AM_FALSE;
+        break;
+
+    case 0x20:                                              /* SE */
+    case 0x52:                                              /* BE */
+    case 0xD8:
+    case 0x60:                                              /* CE */
+    case 0xC7:
+        if (busy || !__g_wel) {
+            printf("erase %02x at %06x rejected\n", cmd[0], (unsigned)addr);
+            __g_errs++;
+            break;
+        }
+        if (cmd[0] == 0x20) {
+            size = 4096;
+            __g_busy_until_us = start + __jitter(60000);
+        } else if ((cmd[0] == 0x52) || (cmd[0] == 0xD8)) {
+            size = 65536;
+            __g_busy_until_us = start + __jitter(700000);
+        } else {
+            size = __SIM_CHIP_SIZE;
+            addr = 0;
+            __g_busy_until_us = start + __jitter(14000000);
+        }
+        memset(&__g_flash[addr & ~(size - 1)], 0xFF, size);
+        __g_wel = AM_FALSE;
+        break;
+
+    default:
+        break;
+    }
+
+    /* 20 MHz SPI plus the per-message overhead */
+    dur              = 3 + nbytes * 0.4;
+    __g_bus_free_us  = start + dur;
+    __g_bus_us      += dur;
+    if (__g_async) {
+        __g_cpu_us += nbytes * 0.8;
+    }
+    __ev_add(__g_bus_free_us, __SIM_EV_SPI, p_msg);
+
+    return AM_OK;
+}
+
+static int __spi_setup (void *p_drv, am_spi_device_t *p_dev)
+{
+    (void)p_drv;
+    (void)p_dev;
+
+    return AM_OK;
+}
+
+static struct am_spi_drv_funcs __g_spi_funcs = {
+    NULL,
+    __spi_setup,
+    __spi_msg_start,
+};
+
+static am_spi_serv_t __g_spi = {&__g_spi_funcs, NULL};
+
+/*******************************************************************************
+  platform stubs
+*******************************************************************************/
+
+int am_gpio_pin_cfg (int pin, uint32_t flags)
+{
+    (void)pin;
+    (void)flags;
+
+    return AM_OK;
+}
+
+uint32_t am_int_cpu_lock (void)
+{
+    return 0;
+}
+
+void am_int_cpu_unlock (uint32_t key)
+{
+    (void)key;
+}
+
+am_tick_t am_sys_tick_get (void)
+{
+    return (am_tick_t)(__g_now_us / 1000);
+}
+
+am_tick_t am_ms_to_ticks (unsigned int ms)
+{
+    return ms;
+}
+
+unsigned long am_sys_clkrate_get (void)
+{
+    return 1000;
+}
+
+int am_softimer_init (am_softimer_t *p_timer, am_pfnvoid_t p_func, void *p_arg)
+{
+    p_timer->timeout_callback = p_func;
+    p_timer->p_arg            = p_arg;
+
+    return AM_OK;
+}
+
+/* the timer expires on a 1 ms tick */
+void am_softimer_start (am_softimer_t *p_timer, unsigned int ms)
+{
+    __ev_del(p_timer);
+    __ev_add(((long)(__g_now_us / 1000) + ms) * 1000.0, __SIM_EV_TIMER, p_timer);
+}
+
+void am_softimer_stop (am_softimer_t *p_timer)
+{
+    __ev_del(p_timer);
+}
+
+int am_wait_init (am_wait_t *p_wait)
+{
+    p_wait->val = 0;
+
+    return AM_OK;
+}
+
+int am_wait_done (am_wait_t *p_wait)
+{
+    p_wait->val = 1;
+
+    return AM_OK;
+}
+
+int am_wait_on (am_wait_t *p_wait)
+{
+    while (!p_wait->val) {
+        __ev_run_one();
+    }
+    p_wait->val = 0;
+
+    return AM_OK;
+}
+
+/*******************************************************************************
+  measurement
+*******************************************************************************/
+
+static const am_mx25xx_devinfo_t __g_devinfo = {
+    AM_SPI_MODE_0,
+    0,
+    20000000,
+    AM_MX25XX_MX25L1606
+};
+
+static am_mx25xx_dev_t    __g_dev;
+static volatile am_bool_t __g_done;
+static int                __g_result;
+
+static double             __g_t0, __g_cpu0, __g_bus0;
+static unsigned long      __g_rdsr0;
+
+static uint8_t            __g_src[65536];
+static uint8_t            __g_rd[65536];
+
+static void __async_done (void *p_arg, int result)
+{
+    (void)p_arg;
+
+    __g_done   = AM_TRUE;
+    __g_result = result;
+}
+
+static void __async_wait (const char *p_what)
+{
+    while (!__g_done) {
+        __ev_run_one();
+    }
+    if (__g_result != AM_OK) {
+        printf("%s: result %d\n", p_what, __g_result);
+        __g_errs++;
+    }
+}
+
+/* let the device finish, then start a measurement */
+static void __mark (am_bool_t async)
+{
+    if (__g_busy_until_us > __g_now_us) {
+        __g_now_us = __g_busy_until_us;
+    }
+    __g_async = async;
+    __g_t0    = __g_now_us;
+    __g_cpu0  = __g_cpu_us;
+    __g_bus0  = __g_bus_us;
+    __g_rdsr0 = __g_rdsr;
+}
+
+static void __report (const char *p_what, double bytes)
+{
+    double wall = __g_now_us - __g_t0;
+    double cpu  = __g_cpu_us - __g_cpu0;
+
+    printf("%-24s wall %8.1f ms  cpu %8.1f ms (%5.1f%%)  bus %7.2f ms  "
+           "rdsr %6lu", p_what, wall / 1000, cpu / 1000, 100 * cpu / wall,
+           (__g_bus_us - __g_bus0) / 1000, __g_rdsr - __g_rdsr0);
+    if (bytes) {
+        printf("  %6.1f KiB/s", bytes / 1024 / (wall / 1e6));
+    }
+    printf("\n");
+}
+
+static void __check_erased (uint32_t addr, uint32_t len)
+{
+    uint32_t i;
+
+    for (i = addr; i < addr + len; i++) {
+        if (__g_flash[i] != 0xFF) {
+            printf("%06x not erased\n", (unsigned)i);
+            __g_errs++;
+            return;
+        }
+    }
+}
+
+static void __check_read (am_mx25xx_handle_t handle, uint32_t addr)
+{
+    __mark(AM_FALSE);
+    am_mx25xx_read(handle, addr, __g_rd, sizeof(__g_rd));
+    if (memcmp(__g_rd, __g_src, sizeof(__g_rd)) != 0) {
+        printf("data at %06x differs\n", (unsigned)addr);
+        __g_errs++;
+    }
+}
+
+static void __mtd_erase_done (struct am_mtd_erase_info *p_info)
+{
+    (void)p_info;
+
+    __g_done = AM_TRUE;
+}
+
+int main (int argc, char **argv)
+{
+    int                      rounds = (argc > 1) ? atoi(argv[1]) : 2;
+    unsigned                 seed   = (argc > 2) ? strtoul(argv[2], NULL, 0) : 1;
+    am_mx25xx_handle_t       handle;
+    am_mtd_handle_t          mtd;
+    static am_mtd_serv_t     mtd_serv;
+    struct am_mtd_erase_info info;
+    int                      round;
+    uint32_t                 i;
+
+    srand(seed);
+    memset(__g_flash, 0xFF, sizeof(__g_flash));
+    for (i = 0; i < sizeof(__g_src); i++) {
+        __g_src[i] = (uint8_t)rand();
+    }
+
+    handle = am_mx25xx_init(&__g_dev, &__g_devinfo, &__g_spi);
+    if (handle == NULL) {
+        printf("init failed\n");
+        return 1;
+    }
+
+    for (round = 0; round < rounds; round++) {
+
+        printf("round %d\n", round);
+
+        /* synchronous: the driver spins on the status register */
+        __mark(AM_FALSE);
+        am_mx25xx_erase(handle, 0, 16 * 4096);
+        __report("sync erase 16 sectors", 0);
+        __check_erased(0, 16 * 4096);
+
+        __mark(AM_FALSE);
+        am_mx25xx_write(handle, 0, __g_src, sizeof(__g_src));
+        __report("sync write 64 KiB", sizeof(__g_src));
+        __check_read(handle, 0);
+
+        __mark(AM_FALSE);
+        am_mx25xx_erase(handle, 0x10000, 2 * 65536);
+        __report("sync erase 2 blocks", 0);
+        __check_erased(0x10000, 2 * 65536);
+
+        /* async: WIP is polled from the softimer */
+        __mark(AM_TRUE);
+        __g_done = AM_FALSE;
+        if (am_mx25xx_erase_async(handle, 0x40000, 16 * 4096,
+                                  __async_done, NULL) != AM_OK) {
+            printf("erase_async failed to start\n");
+            __g_errs++;
+        }
+        __async_wait("erase_async");
+        __report("async erase 16 sectors", 0);
+        __check_erased(0x40000, 16 * 4096);
+
+        __mark(AM_TRUE);
+        __g_done = AM_FALSE;
+        if (am_mx25xx_write_async(handle, 0x40000, __g_src, sizeof(__g_src),
+                                  __async_done, NULL) != AM_OK) {
+            printf("write_async failed to start\n");
+            __g_errs++;
+        }
+        if (am_mx25xx_write(handle, 0, __g_src, 1) != -AM_EBUSY) {
+            printf("sync write during async write not refused\n");
+            __g_errs++;
+        }
+        __async_wait("write_async");
+        __report("async write 64 KiB", sizeof(__g_src));
+        __check_read(handle, 0x40000);
+
+        __mark(AM_TRUE);
+        __g_done = AM_FALSE;
+        am_mx25xx_erase_async(handle, 0x50000, 2 * 65536, __async_done, NULL);
+        __async_wait("erase_async");
+        __report("async erase 2 blocks", 0);
+        __check_erased(0x50000, 2 * 65536);
+
+        printf("estimated ms: page %u, sector %u, block %u\n",
+               (unsigned)__g_dev.est_ms[0], (unsigned)__g_dev.est_ms[1],
+               (unsigned)__g_dev.est_ms[2]);
+
+        /* dirty the areas again for the next round */
+        memset(__g_flash, 0, 0x70000);
+    }
+
+    /* the MTD erase with a callback goes through the async path */
+    mtd = am_mx25xx_mtd_init(handle, &mtd_serv, 0);
+    memset(&info, 0, sizeof(info));
+    info.addr         = 0;
+    info.len          = 0x2000;
+    info.pfn_callback = __mtd_erase_done;
+    __mark(AM_TRUE);
+    __g_done = AM_FALSE;
+    if ((am_mtd_erase_start(mtd, &info) != AM_OK) ||
+        (info.state != AM_MTD_ERASE_PROCESSING)) {
+        printf("am_mtd_erase_start: state %x\n", info.state);
+        __g_errs++;
+    }
+    while (!__g_done) {
+        __ev_run_one();
+    }
+    if (info.state != AM_MTD_ERASE_DONE) {
+        printf("am_mtd_erase_start: final state %x\n", info.state);
+        __g_errs++;
+    }
+    __check_erased(0, 0x2000);
+    __report("mtd erase_start 2 sect", 0);
+
+    printf("errs=%lu\n", __g_errs);
+
+    return __g_errs ? 1 : 0;
+}
+
+/* end of file */
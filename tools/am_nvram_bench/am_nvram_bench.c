@@ -0,0 +1,249 @@
+/*******************************************************************************
+*                                 AMetal
+*                       ----------------------------
+*                       innovating embedded platform
+*
+* Copyright (c) 2001-2018 Guangzhou ZHIYUAN Electronics Co., Ltd.
+* All rights reserved.
+*
+* Contact information:
+* web site:    http://www.zlg.cn/
+*******************************************************************************/
+
+/**
+ * \file
+ * \brief segment lookup benchmark for am_nvram (host program)
+ *
+ * Two RAM devices are registered and segment tables of 16, 48 and 200
+ * segments are used in turn. Each segment has a 4-byte read in round-robin
+ * order, first by name with am_nvram_get(), then through a handle from
+ * am_nvram_open() with am_nvram_read(). The output is the host time and the
+ * number of strcmp() calls per access (am_nvram.c is built with strcmp
+ * renamed to a counting wrapper). With AM_NVRAM_HASH_SIZE 0 the lookup is
+ * the linear scan, which is the behaviour before the hash table.
+ *
+ * The test also checks the data read by name and by handle, a missing
+ * segment, and that a handle whose device was unregistered fails with
+ * -AM_ENODEV and works again once the device is registered again.
+ *
+ * build and run with several hash sizes (from the root of the repository):
+ * \code
+ * for hash in 0 64 256; do
+ *     gcc -std=gnu99 -O2 -Iinterface -Isoc/zlg/zlg217                        \
+ *         -DAM_NVRAM_HASH_SIZE=$hash -Dstrcmp=am_nvram_bench_strcmp          \
+ *         tools/am_nvram_bench/am_nvram_bench.c                              \
+ *         components/service/source/am_nvram.c -o am_nvram_bench            \
+ *     && ./am_nvram_bench [accesses]
+ * done
+ * \endcode
+ *
+ * The exit status is 0 if no error is found.
+ *
+ * \internal
+ * \par modification history:
+ * - 1.00 26-10-18  agent, first implementation
+ * \endinternal
+ */
+
+#include "ametal.h"
+#include "am_nvram.h"
+#include "am_int.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* string.h declared the counting wrapper, the wrapper uses the real one */
+#undef strcmp
+int strcmp (const char *p_s1, const char *p_s2);
+
+#define __BENCH_NSEGS_MAX   200
+#define __BENCH_SEG_SIZE    16
+
+static unsigned long      __g_strcmp;
+static unsigned long      __g_errs;
+
+static uint8_t            __g_mem[2][__BENCH_NSEGS_MAX * __BENCH_SEG_SIZE];
+
+static am_nvram_segment_t __g_segs[__BENCH_NSEGS_MAX + 1];
+static char               __g_names[__BENCH_NSEGS_MAX][24];
+
+/* shared by the devices and the segments, like string literals in a board */
+static char __g_dev0_name[] = "fm24c02";
+static char __g_dev1_name[] = "ep24c64";
+
+int am_nvram_bench_strcmp (const char *p_s1, const char *p_s2)
+{
+    __g_strcmp++;
+
+    return strcmp(p_s1, p_s2);
+}
+
+uint32_t am_int_cpu_lock (void)
+{
+    return 0;
+}
+
+void am_int_cpu_unlock (uint32_t key)
+{
+    (void)key;
+}
+
+/*******************************************************************************
+  RAM devices
+*******************************************************************************/
+
+static int __ram_get (void *p_drv, int offset, uint8_t *p_buf, int len)
+{
+    memcpy(p_buf, (uint8_t *)p_drv + offset, len);
+
+    return AM_OK;
+}
+
+static int __ram_set (void *p_drv, int offset, uint8_t *p_buf, int len)
+{
+    memcpy((uint8_t *)p_drv + offset, p_buf, len);
+
+    return AM_OK;
+}
+
+static const struct am_nvram_drv_funcs __g_ram_funcs = {
+    __ram_get,
+    __ram_set
+};
+
+static am_nvram_dev_t __g_dev0 = {__g_dev0_name, &__g_ram_funcs, __g_mem[0]};
+static am_nvram_dev_t __g_dev1 = {__g_dev1_name, &__g_ram_funcs, __g_mem[1]};
+
+/*******************************************************************************
+  benchmark
+*******************************************************************************/
+
+static double __ns_get (void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* names like the parameter code uses, half of them with several units */
+static void __segs_build (int nsegs)
+{
+    static const char *prefix[] = {
+        "sys_param_", "net_cfg_", "calib_chan_", "user_pref_"
+    };
+    int i;
+
+    for (i = 0; i < nsegs; i++) {
+        sprintf(__g_names[i], "%s%d", prefix[i % 4], i);
+        __g_segs[i].p_name     = __g_names[i];
+        __g_segs[i].unit       = (i < nsegs / 2) ? 0 : i % 4;
+        __g_segs[i].seg_addr   = i * __BENCH_SEG_SIZE;
+        __g_segs[i].seg_size   = __BENCH_SEG_SIZE;
+        __g_segs[i].p_dev_name = (i & 1) ? __g_dev1_name : __g_dev0_name;
+    }
+    memset(&__g_segs[nsegs], 0, sizeof(__g_segs[nsegs]));
+
+    for (i = 0; i < nsegs; i++) {
+        memset(&__g_mem[i & 1][i * __BENCH_SEG_SIZE], i, __BENCH_SEG_SIZE);
+    }
+}
+
+static void __check (int i, const uint8_t *p_buf, const char *p_what)
+{
+    if ((p_buf[0] != (uint8_t)i) || (p_buf[3] != (uint8_t)i)) {
+        printf("%s: segment %d read %02x\n", p_what, i, p_buf[0]);
+        __g_errs++;
+    }
+}
+
+static void __bench (int nsegs, long n)
+{
+    static am_nvram_seg_handle_t handle[__BENCH_NSEGS_MAX];
+    uint8_t                      buf[4];
+    double                       t0, t_name, t_handle;
+    unsigned long                cmp_name, cmp_handle;
+    long                         k;
+    int                          i;
+
+    /* am_nvram_init() starts with an empty device list */
+    __segs_build(nsegs);
+    am_nvram_init(__g_segs);
+    am_nvram_dev_register(&__g_dev0);
+    am_nvram_dev_register(&__g_dev1);
+
+    __g_strcmp = 0;
+    t0 = __ns_get();
+    for (k = 0; k < n; k++) {
+        i = k % nsegs;
+        if (am_nvram_get(__g_names[i], __g_segs[i].unit,
+                         buf, 0, 4) != AM_OK) {
+            __g_errs++;
+        }
+        __check(i, buf, "am_nvram_get");
+    }
+    t_name   = (__ns_get() - t0) / n;
+    cmp_name = __g_strcmp;
+
+    for (i = 0; i < nsegs; i++) {
+        if (am_nvram_open(&handle[i], __g_names[i],
+                          __g_segs[i].unit) != AM_OK) {
+            printf("am_nvram_open %s failed\n", __g_names[i]);
+            __g_errs++;
+        }
+    }
+
+    __g_strcmp = 0;
+    t0 = __ns_get();
+    for (k = 0; k < n; k++) {
+        i = k % nsegs;
+        if (am_nvram_read(&handle[i], buf, 0, 4) != AM_OK) {
+            __g_errs++;
+        }
+        __check(i, buf, "am_nvram_read");
+    }
+    t_handle   = (__ns_get() - t0) / n;
+    cmp_handle = __g_strcmp;
+
+    printf("%3d segments: by name %6.1f ns %5.2f strcmp, "
+           "by handle %5.1f ns %4.2f strcmp\n",
+           nsegs, t_name, (double)cmp_name / n,
+           t_handle, (double)cmp_handle / n);
+
+    /* stale handles are looked up again, not used */
+    am_nvram_dev_unregister(&__g_dev1);
+    if (am_nvram_read(&handle[1], buf, 0, 4) != -AM_ENODEV) {
+        printf("handle used after its device was unregistered\n");
+        __g_errs++;
+    }
+    am_nvram_dev_register(&__g_dev1);
+    buf[0] = 0;
+    if (am_nvram_read(&handle[1], buf, 0, 4) != AM_OK) {
+        printf("handle not usable after re-register\n");
+        __g_errs++;
+    }
+    __check(1, buf, "re-register");
+
+    if (am_nvram_get("missing", 0, buf, 0, 1) != -AM_EINVAL) {
+        printf("missing segment found\n");
+        __g_errs++;
+    }
+}
+
+int main (int argc, char **argv)
+{
+    long n = (argc > 1) ? atol(argv[1]) : 2000000;
+
+    printf("AM_NVRAM_HASH_SIZE=%d\n", AM_NVRAM_HASH_SIZE);
+    __bench(16, n);
+    __bench(48, n);
+    __bench(200, n);
+
+    printf("errs=%lu\n", __g_errs);
+
+    return __g_errs ? 1 : 0;
+}
+
+/* end of file */
@@ -0,0 +1,629 @@
+/*******************************************************************************
+*                                 AMetal
+*                       ----------------------------
+*                       innovating embedded platform
+*
+* Copyright (c) 2001-2018 Guangzhou ZHIYUAN Electronics Co., Ltd.
+* All rights reserved.
+*
+* Contact information:
+* web site:    http://www.zlg.cn/
+*******************************************************************************/
+
+/**
+ * \file
+ * \brief ordering model and latency benchmark of the polled fast path of
+ *        am_zlg_i2c (host program)
+ *
+ * am_zlg_i2c.c is included in this file with its data, status and interrupt
+ * register accessors redirected to the model of a 256-byte EEPROM-like slave
+ * at address 0x50 (the first written byte is the register pointer), the
+ * address 0x33 is not acknowledged. A byte on the bus takes 9 bit times, the
+ * controller raises TX_EMPTY and RX_FULL, and STOP_DET when a command with
+ * the stop bit is sent or the transmit FIFO runs empty. Time is kept in
+ * microseconds of a model clock: an interrupt 0.8 us, a register access
+ * 0.05 us and the wakeup of the waiting task 1 us. The system tick is 1 ms
+ * of the model clock. am_i2c.c, am_wait.c and am_softimer.c are the real
+ * ones, the wait backend runs the model until no interrupt is pending.
+ *
+ * The checks are:
+ *  - a short message submitted while an interrupt message is in flight is
+ *    queued behind it;
+ *  - a long and a short message submitted from an "interrupt" while a
+ *    message is being polled complete after it, in submission order;
+ *  - a message submitted from the completion callback of a polled message;
+ *  - a NACK on the polled path gives -AM_EIO and the next message works;
+ *  - a polled register write reaches the slave.
+ *
+ * The benchmark prints the latency of a write 1 + read n message from
+ * am_i2c_msg_start() to the wakeup of the waiting task, for the interrupt
+ * path, the polled path and the default threshold, and the threshold
+ * measured by am_i2c_poll_calibrate().
+ *
+ * build (from the root of the repository):
+ * \code
+ * gcc -std=gnu99 -O2 -no-pie -Wno-int-to-pointer-cast                       \
+ *     -Wno-pointer-to-int-cast -Iinterface -Isoc/zlg/zlg217                 \
+ *     -Isoc/zlg/drivers/include -Isoc/zlg/drivers/include/i2c               \
+ *     -Isoc/zlg/drivers/source/i2c                                          \
+ *     tools/am_poll_model/am_zlg_i2c_poll_model.c                           \
+ *     components/service/source/am_i2c.c                                    \
+ *     components/util/source/am_wait.c                                     \
+ *     components/util/source/am_softimer.c                                  \
+ *     components/util/source/am_jobq.c -o am_zlg_i2c_poll_model
+ * ./am_zlg_i2c_poll_model
+ * \endcode
+ *
+ * The exit status is 0 if no error is found.
+ *
+ * \internal
+ * \par modification history:
+ * - 1.00 26-10-18  agent, first implementation
+ * \endinternal
+ */
+
+#include "ametal.h"
+#include "am_i2c.h"
+#include "am_wait.h"
+#include "am_int.h"
+#include "am_clk.h"
+#include "am_system.h"
+#include "hw/amhw_zlg_i2c.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void     __i2c_dat_write (uint32_t cmd);
+static uint8_t  __i2c_dat_read (void);
+static uint32_t __i2c_status (void);
+static uint32_t __i2c_raw (void);
+static void     __i2c_mask_set (uint32_t flags);
+static void     __i2c_mask_clr (uint32_t flags);
+static uint8_t  __i2c_clr (void);
+static void     __i2c_tar (uint32_t addr);
+static void     __i2c_reset (void);
+
+#define amhw_zlg_i2c_dat_write(p, c)          __i2c_dat_write(c)
+#define amhw_zlg_i2c_dat_read(p)              __i2c_dat_read()
+#define amhw_zlg_i2c_status_get(p)            __i2c_status()
+#define amhw_zlg_i2c_raw_intr_stat_get(p)     __i2c_raw()
+#define amhw_zlg_i2c_intr_stat_get(p)         (__i2c_raw() & __g_mask)
+#define amhw_zlg_i2c_intr_mask_set(p, f)      __i2c_mask_set(f)
+#define amhw_zlg_i2c_intr_mask_clear(p, f)    __i2c_mask_clr(f)
+#define amhw_zlg_i2c_clr_intr_get(p)          __i2c_clr()
+#define amhw_zlg_i2c_tar_set(p, a)            __i2c_tar(a)
+#define amhw_zlg_i2c_disable(p)               __i2c_reset()
+
+static uint32_t __g_mask;
+
+#include "am_zlg_i2c.c"
+
+#define __SLAVE_ADDR    0x50
+#define __NACK_ADDR     0x33
+
+#define __T_IRQ         0.8       /* interrupt entry, exit and dispatch */
+#define __T_REG         0.05      /* one register or tick read */
+#define __T_WAKE        1.0       /* wakeup of the waiting task */
+
+static double         __g_now;    /* model clock (us) */
+static double         __g_t_byte; /* 9 bit times (us) */
+static unsigned long  __g_errs;
+static unsigned long  __g_irqs;
+
+static int            __g_order[16];
+static int            __g_norder;
+
+static void         (*__gpfn_poll_hook) (void);
+
+/*******************************************************************************
+  platform
+*******************************************************************************/
+
+static am_pfnvoid_t   __gpfn_irq;
+static void          *__gp_irq_arg;
+
+uint32_t am_int_cpu_lock (void)
+{
+    return 0;
+}
+
+void am_int_cpu_unlock (uint32_t key)
+{
+    (void)key;
+}
+
+int am_int_connect (int inum, am_pfnvoid_t pfn_isr, void *p_arg)
+{
+    __gpfn_irq   = pfn_isr;
+    __gp_irq_arg = p_arg;
+
+    return AM_OK;
+}
+
+int am_int_disconnect (int inum, am_pfnvoid_t pfn_isr, void *p_arg)
+{
+    return AM_OK;
+}
+
+int am_int_enable (int inum)
+{
+    return AM_OK;
+}
+
+int am_int_disable (int inum)
+{
+    return AM_OK;
+}
+
+int am_clk_rate_get (am_clk_id_t clk_id)
+{
+    return 48000000;
+}
+
+am_tick_t am_sys_tick_get (void)
+{
+    __g_now += __T_REG;
+
+    return (am_tick_t)(__g_now / 1000);
+}
+
+unsigned long am_sys_clkrate_get (void)
+{
+    return 1000;
+}
+
+am_tick_t am_ms_to_ticks (unsigned int ms)
+{
+    return ms;
+}
+
+unsigned int am_ticks_to_ms (am_tick_t ticks)
+{
+    return ticks;
+}
+
+/*******************************************************************************
+  I2C controller and slave
+*******************************************************************************/
+
+static uint32_t __g_raw = AMHW_ZLG_INT_FLAG_TX_EMPTY;
+static uint32_t __g_tar;
+static int      __g_active;
+static int      __g_last_rd;
+static int      __g_ptr_next;      /* next written byte is the pointer */
+
+static uint8_t  __g_rxq[64];
+static int      __g_rx_head;
+static int      __g_rx_tail;
+
+static uint8_t  __g_mem[256];
+static uint8_t  __g_ptr;
+
+static void __i2c_reset (void)
+{
+    __g_active = 0;
+}
+
+static void __i2c_tar (uint32_t addr)
+{
+    __g_tar = addr;
+}
+
+static void __i2c_dat_write (uint32_t cmd)
+{
+    int rd = !!(cmd & 0x100);
+
+    __g_now += __T_REG;
+
+    /* repeated start and address on a change of direction */
+    if (__g_active && (rd != __g_last_rd)) {
+        __g_now += __g_t_byte;
+    }
+    __g_last_rd = rd;
+
+    /* start and address */
+    if (!__g_active) {
+        __g_active    = 1;
+        __g_ptr_next  = 1;
+        __g_now      += __g_t_byte;
+        if (__g_tar == __NACK_ADDR) {
+            __g_raw    |= AMHW_ZLG_INT_FLAG_TX_ABRT | AMHW_ZLG_INT_FLAG_STOP_DET;
+            __g_active  = 0;
+            return;
+        }
+    }
+
+    __g_now += __g_t_byte;
+    if (rd) {
+        __g_rxq[__g_rx_tail++ & 63]  = __g_mem[__g_ptr++];
+        __g_raw                     |= AMHW_ZLG_INT_FLAG_RX_FULL;
+        __g_ptr_next                 = 1;
+    } else if (__g_ptr_next) {
+        __g_ptr      = (uint8_t)cmd;
+        __g_ptr_next = 0;
+    } else {
+        __g_mem[__g_ptr++] = (uint8_t)cmd;
+    }
+    __g_raw |= AMHW_ZLG_INT_FLAG_TX_EMPTY;
+
+    if (cmd & 0x200) {
+        __g_raw    |= AMHW_ZLG_INT_FLAG_STOP_DET;
+        __g_active  = 0;
+    }
+
+    /* an interrupt arriving while the message is polled */
+    if (__gpfn_poll_hook != NULL) {
+        void (*pfn_hook) (void) = __gpfn_poll_hook;
+
+        __gpfn_poll_hook = NULL;
+        pfn_hook();
+    }
+}
+
+static uint8_t __i2c_dat_read (void)
+{
+    uint8_t data = __g_rxq[__g_rx_head++ & 63];
+
+    __g_now += __T_REG;
+    if (__g_rx_head == __g_rx_tail) {
+        __g_raw &= ~AMHW_ZLG_INT_FLAG_RX_FULL;
+    }
+    return data;
+}
+
+static uint32_t __i2c_status (void)
+{
+    __g_now += __T_REG;
+
+    return AMHW_ZLG_STATUS_FLAG_TFNF |
+           ((__g_rx_head != __g_rx_tail) ? AMHW_ZLG_STATUS_FLAG_RFNE : 0);
+}
+
+static uint32_t __i2c_raw (void)
+{
+    __g_now += __T_REG;
+
+    return __g_raw;
+}
+
+static void __i2c_mask_set (uint32_t flags)
+{
+    __g_mask |= flags;
+}
+
+static void __i2c_mask_clr (uint32_t flags)
+{
+    __g_mask &= ~flags;
+}
+
+static uint8_t __i2c_clr (void)
+{
+    __g_raw &= ~(AMHW_ZLG_INT_FLAG_STOP_DET | AMHW_ZLG_INT_FLAG_TX_ABRT);
+
+    return 0;
+}
+
+/*
+ * runs the hardware until no interrupt is pending, the controller sends a
+ * stop by itself when the transmit FIFO runs empty
+ */
+static void __hw_run (void)
+{
+    int guard;
+
+    for (guard = 0; guard < 100000; guard++) {
+        if (__g_active &&
+            !(__g_raw & __g_mask & ~AMHW_ZLG_INT_FLAG_STOP_DET) &&
+            !(__g_raw & AMHW_ZLG_INT_FLAG_RX_FULL)) {
+            __g_raw    |= AMHW_ZLG_INT_FLAG_STOP_DET;
+            __g_active  = 0;
+        }
+        if (!(__g_raw & __g_mask)) {
+            return;
+        }
+        __g_irqs++;
+        __g_now += __T_IRQ;
+        __gpfn_irq(__gp_irq_arg);
+    }
+
+    printf("interrupt storm: raw %x mask %x\n",
+           (unsigned)__g_raw, (unsigned)__g_mask);
+    exit(1);
+}
+
+/* the waiting task sleeps until the interrupt, then is woken up */
+static void __wait_sleep (void *p_arg)
+{
+    __hw_run();
+    __g_now += __T_WAKE;
+}
+
+static const am_wait_backend_t __g_wait_backend = {
+    NULL,
+    __wait_sleep,
+    NULL,
+    NULL
+};
+
+/*******************************************************************************
+  ordering
+*******************************************************************************/
+
+/* the registers not redirected to the model, -no-pie keeps it below 4 GB */
+static amhw_zlg_i2c_t       __g_regs;
+
+static am_zlg_i2c_dev_t     __g_dev;
+static am_zlg_i2c_devinfo_t __g_devinfo;
+static am_i2c_handle_t      __g_handle;
+
+typedef struct {
+    am_i2c_message_t  msg;
+    am_i2c_transfer_t trans[2];
+    uint8_t           reg;
+    uint8_t           buf[32];
+} __msg_t;
+
+static __msg_t __g_q[8];
+
+static void __complete (void *p_arg)
+{
+    if (__g_norder < (int)AM_NELEMENTS(__g_order)) {
+        __g_order[__g_norder++] = (int)(intptr_t)p_arg;
+    }
+}
+
+/* register read: write the pointer, read n bytes */
+static void __msg_build (__msg_t *p_m, int id, uint16_t addr, uint8_t reg, int n)
+{
+    p_m->reg = reg;
+    am_i2c_mktrans(&p_m->trans[0], addr, AM_I2C_M_WR, &p_m->reg, 1);
+    am_i2c_mktrans(&p_m->trans[1], addr, AM_I2C_M_RD, p_m->buf, n);
+    am_i2c_mkmsg(&p_m->msg, p_m->trans, 2, __complete, (void *)(intptr_t)id);
+}
+
+static void __msg_check (__msg_t *p_m, int n)
+{
+    if ((p_m->msg.status != AM_OK) || (p_m->msg.done_num != 2) ||
+        memcmp(p_m->buf, __g_mem + p_m->reg, n)) {
+        printf("message %d: status %d, data %s\n",
+               (int)(intptr_t)p_m->msg.p_arg, p_m->msg.status,
+               memcmp(p_m->buf, __g_mem + p_m->reg, n) ? "bad" : "ok");
+        __g_errs++;
+    }
+}
+
+static void __order_check (const char *p_name, const int *p_expect, int n)
+{
+    int ok = (__g_norder == n);
+    int i;
+
+    for (i = 0; ok && (i < n); i++) {
+        ok = (__g_order[i] == p_expect[i]);
+    }
+
+    printf("%-50s %s, order:", p_name, ok ? "ok " : "BAD");
+    for (i = 0; i < __g_norder; i++) {
+        printf(" %d", __g_order[i]);
+    }
+    printf("\n");
+
+    if (!ok) {
+        __g_errs++;
+    }
+}
+
+/* a long and a short message from an interrupt */
+static void __isr_submit (void)
+{
+    __msg_build(&__g_q[2], 2, __SLAVE_ADDR, 0, 16);
+    am_i2c_msg_start(__g_handle, &__g_q[2].msg);
+    __msg_build(&__g_q[3], 3, __SLAVE_ADDR, 1, 1);
+    am_i2c_msg_start(__g_handle, &__g_q[3].msg);
+}
+
+static void __callback_submit (void *p_arg)
+{
+    __complete(p_arg);
+    __msg_build(&__g_q[5], 5, __SLAVE_ADDR, 2, 1);
+    am_i2c_msg_start(__g_handle, &__g_q[5].msg);
+}
+
+static void __order_test (void)
+{
+    static const int expect_busy[]     = {0, 1};
+    static const int expect_isr[]      = {1, 2, 3};
+    static const int expect_callback[] = {4, 5};
+
+    am_i2c_transfer_t trans;
+    am_i2c_message_t  msg;
+    uint8_t           wr[3] = {0x20, 0xAA, 0x55};
+    __msg_t           m, m2;
+
+    /* write 1 + read 1 (90 us) is polled, write 1 + read 16 (428 us) not */
+    am_zlg_i2c_poll_ns_set(__g_handle, 100000);
+
+    __g_norder = 0;
+    __msg_build(&__g_q[0], 0, __SLAVE_ADDR, 0, 16);
+    am_i2c_msg_start(__g_handle, &__g_q[0].msg);
+    __msg_build(&__g_q[1], 1, __SLAVE_ADDR, 1, 1);
+    am_i2c_msg_start(__g_handle, &__g_q[1].msg);
+    __order_check("short message behind an interrupt message", expect_busy, 0);
+    __hw_run();
+    __order_check("  ... after the interrupt message", expect_busy, 2);
+    __msg_check(&__g_q[0], 16);
+    __msg_check(&__g_q[1], 1);
+
+    __g_norder = 0;
+    __msg_build(&__g_q[1], 1, __SLAVE_ADDR, 4, 1);
+    __gpfn_poll_hook = __isr_submit;
+    am_i2c_msg_start(__g_handle, &__g_q[1].msg);
+    __hw_run();
+    __order_check("long + short from an ISR during a polled message",
+                  expect_isr, 3);
+    __msg_check(&__g_q[1], 1);
+    __msg_check(&__g_q[2], 16);
+    __msg_check(&__g_q[3], 1);
+
+    __g_norder = 0;
+    __msg_build(&__g_q[4], 4, __SLAVE_ADDR, 9, 1);
+    __g_q[4].msg.pfn_complete = __callback_submit;
+    am_i2c_msg_start(__g_handle, &__g_q[4].msg);
+    __hw_run();
+    __order_check("message from the callback of a polled message",
+                  expect_callback, 2);
+    __msg_check(&__g_q[5], 1);
+
+    __g_norder = 0;
+    __msg_build(&m, 6, __NACK_ADDR, 0, 1);
+    am_i2c_msg_start(__g_handle, &m.msg);
+    __hw_run();
+    __msg_build(&m2, 7, __SLAVE_ADDR, 3, 1);
+    am_i2c_msg_start(__g_handle, &m2.msg);
+    __hw_run();
+    printf("%-50s %s, status %d then %d\n", "NACK on a polled message",
+           ((m.msg.status == -AM_EIO) && (__g_norder == 2)) ? "ok " : "BAD",
+           m.msg.status, m2.msg.status);
+    if ((m.msg.status != -AM_EIO) || (__g_norder != 2)) {
+        __g_errs++;
+    }
+    __msg_check(&m2, 1);
+
+    am_i2c_mktrans(&trans, __SLAVE_ADDR, AM_I2C_M_WR, wr, 3);
+    am_i2c_mkmsg(&msg, &trans, 1, __complete, (void *)8);
+    am_i2c_msg_start(__g_handle, &msg);
+    __hw_run();
+    printf("%-50s %s\n", "polled register write",
+           ((__g_mem[0x20] == 0xAA) && (__g_mem[0x21] == 0x55) &&
+            (msg.status == AM_OK)) ? "ok " : "BAD");
+    if ((__g_mem[0x20] != 0xAA) || (__g_mem[0x21] != 0x55) ||
+        (msg.status != AM_OK)) {
+        __g_errs++;
+    }
+
+    if (__g_dev.busy) {
+        printf("controller still busy\n");
+        __g_errs++;
+    }
+}
+
+/*******************************************************************************
+  latency
+*******************************************************************************/
+
+/* from am_i2c_msg_start() to the wakeup of the waiting task */
+static double __latency (int n, uint32_t poll_ns, unsigned long *p_irqs)
+{
+    am_wait_t wait;
+    __msg_t   m;
+
+    am_zlg_i2c_poll_ns_set(__g_handle, poll_ns);
+    am_wait_init(&wait);
+    __msg_build(&m, 0, __SLAVE_ADDR, 7, n);
+    m.msg.pfn_complete = (am_pfnvoid_t)am_wait_done;
+    m.msg.p_arg        = &wait;
+
+    __g_now  = 0;
+    __g_irqs = 0;
+    am_i2c_msg_start(__g_handle, &m.msg);
+    am_wait_on(&wait);
+
+    if ((m.msg.status != AM_OK) || memcmp(m.buf, __g_mem + 7, n)) {
+        printf("read %d: status %d or data bad\n", n, m.msg.status);
+        __g_errs++;
+    }
+
+    *p_irqs = __g_irqs;
+
+    return __g_now;
+}
+
+static void __init (uint32_t speed)
+{
+    __g_devinfo.i2c_regbase = (uint32_t)(uintptr_t)&__g_regs;
+    __g_devinfo.speed       = speed;
+    __g_devinfo.timeout_ms  = 0;
+    __g_t_byte              = 9e6 / speed;
+    __g_handle              = am_zlg_i2c_init(&__g_dev, &__g_devinfo);
+}
+
+static void __latency_bench (uint32_t speed)
+{
+    static const int n[] = {1, 2, 4, 8};
+    unsigned long    irq_int, irq_poll, irq_def;
+    double           t_int, t_poll, t_def;
+    int              i;
+
+    __init(speed);
+
+    printf("\n%u kHz  write 1 + read n  int (us) irqs  poll (us) irqs  "
+           "default %u ns (us)\n", (unsigned)(speed / 1000),
+           (unsigned)AM_ZLG_I2C_POLL_NS);
+    for (i = 0; i < (int)AM_NELEMENTS(n); i++) {
+        t_int  = __latency(n[i], 0, &irq_int);
+        t_poll = __latency(n[i], 0xFFFFFFFF, &irq_poll);
+        t_def  = __latency(n[i], AM_ZLG_I2C_POLL_NS, &irq_def);
+        printf("        n = %d %16.1f %4lu %10.1f %4lu %14.1f (%s)\n",
+               n[i], t_int, irq_int, t_poll, irq_poll, t_def,
+               irq_def ? "int" : "poll");
+    }
+}
+
+static void __calibrate_bench (void)
+{
+    am_i2c_transfer_t trans;
+    am_i2c_message_t  msg;
+    am_wait_t         wait;
+    uint8_t           buf[4];
+    double            t[2];
+    int               p, ret;
+
+    __init(400000);
+
+    /* the same read 1 message as the calibration */
+    for (p = 0; p < 2; p++) {
+        am_zlg_i2c_poll_ns_set(__g_handle, p ? 0xFFFFFFFF : 0);
+        am_wait_init(&wait);
+        am_i2c_mktrans(&trans, __SLAVE_ADDR, AM_I2C_M_RD, buf, 1);
+        am_i2c_mkmsg(&msg, &trans, 1, (am_pfnvoid_t)am_wait_done, &wait);
+        __g_now = 0;
+        am_i2c_msg_start(__g_handle, &msg);
+        am_wait_on(&wait);
+        t[p] = __g_now;
+    }
+
+    ret = am_i2c_poll_calibrate(__g_handle, am_zlg_i2c_poll_ns_set,
+                                __SLAVE_ADDR, buf, 1, 1000);
+
+    printf("\ncalibrate (read 1, 1000 ms): %d ns, model difference %.0f ns\n",
+           ret, (t[0] - t[1]) * 1000);
+
+    if ((ret < 0) || (ret != (int)__g_dev.poll_ns) ||
+        (ret < (t[0] - t[1]) * 1000 * 0.9) ||
+        (ret > (t[0] - t[1]) * 1000 * 1.1)) {
+        printf("calibration out of range\n");
+        __g_errs++;
+    }
+}
+
+int main (void)
+{
+    int i;
+
+    for (i = 0; i < 256; i++) {
+        __g_mem[i] = rand();
+    }
+
+    am_wait_backend_set(&__g_wait_backend);
+
+    __init(400000);
+    __order_test();
+    __latency_bench(400000);
+    __latency_bench(100000);
+    __calibrate_bench();
+
+    printf("errs=%lu\n", __g_errs);
+
+    return __g_errs ? 1 : 0;
+}
+
+/* end of file */
@@ -0,0 +1,681 @@
+/*******************************************************************************
+*                                 AMetal
+*                       ----------------------------
+*                       innovating embedded platform
+*
+* Copyright (c) 2001-2018 Guangzhou ZHIYUAN Electronics Co., Ltd.
+* All rights reserved.
+*
+* Contact information:
+* web site:    http://www.zlg.cn/
+*******************************************************************************/
+
+/**
+ * \file
+ * \brief ordering model and latency benchmark of the polled fast path of
+ *        am_zlg_spi_dma (host program)
+ *
+ * am_zlg_spi_dma.c is included in this file with its data register and
+ * status accessors redirected to a loopback SPI model, the am_zlg_dma API is
+ * replaced by a DMA model that copies the data and raises the completion
+ * interrupt of the channels with a connected ISR. Time is kept in
+ * microseconds of a model clock: a byte takes 8 / speed, a DMA channel
+ * setup 0.3 us, an interrupt 0.5 us, a polled word 0.1 us of CPU time and
+ * the wakeup of the waiting task 1 us. The system tick is 1 ms of the model
+ * clock. am_spi.c, am_wait.c and am_softimer.c are the real ones, the wait
+ * backend runs the model until the pending interrupts are served.
+ *
+ * The ordering checks are:
+ *  - a short message submitted while a DMA message is in flight is queued
+ *    behind it;
+ *  - a long and a short message submitted from an "interrupt" while a
+ *    message is being polled complete after it, in submission order;
+ *  - a message submitted from the completion callback of a polled message;
+ *  - the same message (cs_change inside and at the end, 8/16/32-bit words)
+ *    gives the same data and chip select sequence on both paths.
+ *
+ * The benchmark prints the latency from am_spi_msg_start() to the wakeup of
+ * the waiting task, for the DMA path, the polled path and the default
+ * threshold, and the threshold measured by am_spi_poll_calibrate().
+ *
+ * build (from the root of the repository):
+ * \code
+ * gcc -std=gnu99 -O2 -no-pie -Wno-int-to-pointer-cast                       \
+ *     -Wno-pointer-to-int-cast -Iinterface -Isoc/zlg/zlg217                 \
+ *     -Isoc/zlg/drivers/include -Isoc/zlg/drivers/include/spi               \
+ *     -Isoc/zlg/drivers/include/dma -Isoc/zlg/drivers/source/spi            \
+ *     tools/am_poll_model/am_zlg_spi_poll_model.c                           \
+ *     components/service/source/am_spi.c                                    \
+ *     components/util/source/am_wait.c                                     \
+ *     components/util/source/am_softimer.c                                  \
+ *     components/util/source/am_jobq.c -o am_zlg_spi_poll_model
+ * ./am_zlg_spi_poll_model
+ * \endcode
+ *
+ * The exit status is 0 if no error is found.
+ *
+ * \internal
+ * \par modification history:
+ * - 1.00 26-10-18  agent, first implementation
+ * \endinternal
+ */
+
+#include "ametal.h"
+#include "am_spi.h"
+#include "am_wait.h"
+#include "am_int.h"
+#include "am_clk.h"
+#include "am_gpio.h"
+#include "am_system.h"
+#include "hw/amhw_zlg_spi.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+static void     __spi_tx (uint32_t data);
+static uint32_t __spi_rx (void);
+static uint32_t __spi_cstat (void);
+static void     __spi_baud (void);
+
+#define amhw_zlg_spi_baud_rate_set(p, d) (__spi_baud(), amhw_zlg_spi_baud_rate_set(p, d))
+#define amhw_zlg_spi_tx_data8_put(p, d)  __spi_tx(d)
+#define amhw_zlg_spi_tx_data32_put(p, d) __spi_tx(d)
+#define amhw_zlg_spi_rx_data8_get(p)     ((uint8_t)__spi_rx())
+#define amhw_zlg_spi_rx_data32_get(p)    __spi_rx()
+#define amhw_zlg_spi_reg_cstat_get(p)    __spi_cstat()
+
+#include "am_zlg_spi_dma.c"
+
+#define __CHAN_TX       2
+#define __CHAN_RX       1
+
+#define __T_IRQ         0.5       /* interrupt entry, exit and dispatch */
+#define __T_DMA_CFG     0.3       /* setup of one DMA channel */
+#define __T_POLL        0.1       /* CPU time of one polled word */
+#define __T_WAKE        1.0       /* wakeup of the waiting task */
+#define __T_REG         0.05      /* one register or tick read */
+
+static double         __g_now;    /* model clock (us) */
+static double         __g_t_byte; /* wire time of one byte (us) */
+static unsigned long  __g_errs;
+static unsigned long  __g_irqs;
+
+static char           __g_trace[1024];
+static int            __g_trace_len;
+
+static int            __g_order[16];
+static int            __g_norder;
+
+static void         (*__gpfn_poll_hook) (void);
+
+static uint8_t       *__g_tx;
+static uint8_t       *__g_rx;
+
+static void __trace (const char *p_str)
+{
+    if (__g_trace_len < (int)sizeof(__g_trace) - 16) {
+        __g_trace_len += sprintf(__g_trace + __g_trace_len, "%s ", p_str);
+    }
+}
+
+/*******************************************************************************
+  platform
+*******************************************************************************/
+
+uint32_t am_int_cpu_lock (void)
+{
+    return 0;
+}
+
+void am_int_cpu_unlock (uint32_t key)
+{
+    (void)key;
+}
+
+int am_int_connect (int inum, am_pfnvoid_t pfn_isr, void *p_arg)
+{
+    return AM_OK;
+}
+
+int am_int_disconnect (int inum, am_pfnvoid_t pfn_isr, void *p_arg)
+{
+    return AM_OK;
+}
+
+int am_int_enable (int inum)
+{
+    return AM_OK;
+}
+
+int am_int_disable (int inum)
+{
+    return AM_OK;
+}
+
+int am_gpio_pin_cfg (int pin, uint32_t flags)
+{
+    return AM_OK;
+}
+
+/* only the level changes of the chip select are traced */
+int am_gpio_set (int pin, int value)
+{
+    static int level = -1;
+
+    if (value != level) {
+        __trace(value ? "cs1" : "cs0");
+        level = value;
+    }
+    return AM_OK;
+}
+
+int am_clk_rate_get (am_clk_id_t clk_id)
+{
+    return 72000000;
+}
+
+void am_udelay (uint32_t us)
+{
+    __g_now += us;
+}
+
+am_tick_t am_sys_tick_get (void)
+{
+    __g_now += __T_REG;
+
+    return (am_tick_t)(__g_now / 1000);
+}
+
+unsigned long am_sys_clkrate_get (void)
+{
+    return 1000;
+}
+
+am_tick_t am_ms_to_ticks (unsigned int ms)
+{
+    return ms;
+}
+
+unsigned int am_ticks_to_ms (am_tick_t ticks)
+{
+    return ticks;
+}
+
+/*******************************************************************************
+  SPI data register: loopback, one word in flight
+*******************************************************************************/
+
+static uint32_t __g_shift;
+static int      __g_rxval;
+
+static void __spi_baud (void)
+{
+    __g_now += 1.5;
+}
+
+static void __spi_tx (uint32_t data)
+{
+    __g_shift  = data;
+    __g_rxval  = 1;
+    __g_now   += __g_t_byte + __T_POLL;
+
+    /* an interrupt arriving while the message is polled */
+    if (__gpfn_poll_hook != NULL) {
+        void (*pfn_hook) (void) = __gpfn_poll_hook;
+
+        __gpfn_poll_hook = NULL;
+        pfn_hook();
+    }
+}
+
+static uint32_t __spi_rx (void)
+{
+    __g_rxval = 0;
+
+    return __g_shift;
+}
+
+static uint32_t __spi_cstat (void)
+{
+    return __g_rxval ? AMHW_ZLG_SPI_CSTAT_RXVAL : AMHW_ZLG_SPI_CSTAT_TX_EMPTY;
+}
+
+/*******************************************************************************
+  DMA
+*******************************************************************************/
+
+static struct {
+    amhw_zlg_dma_xfer_desc_t  desc;
+    int                       run;
+    am_zlg_pfn_dma_isr_t      pfn_isr;
+    void                     *p_arg;
+} __g_chan[8];
+
+static int    __g_dma_pending;
+static double __g_dma_done;
+
+int am_zlg_dma_xfer_desc_build (amhw_zlg_dma_xfer_desc_t *p_desc,
+                                uint32_t                  src_addr,
+                                uint32_t                  dst_addr,
+                                uint32_t                  nbytes,
+                                uint32_t                  flags)
+{
+    p_desc->xfercfg  = flags;
+    p_desc->src_addr = src_addr;
+    p_desc->dst_addr = dst_addr;
+    p_desc->nbytes   = nbytes;
+
+    return AM_OK;
+}
+
+int am_zlg_dma_xfer_desc_chan_cfg (amhw_zlg_dma_xfer_desc_t     *p_desc,
+                                   amhw_zlg_dma_transfer_type_t  type,
+                                   uint8_t                       chan)
+{
+    __g_chan[chan].desc  = *p_desc;
+    __g_now             += __T_DMA_CFG;
+
+    return AM_OK;
+}
+
+int am_zlg_dma_isr_connect (int chan, am_zlg_pfn_dma_isr_t pfn_isr, void *p_arg)
+{
+    __g_chan[chan].pfn_isr = pfn_isr;
+    __g_chan[chan].p_arg   = p_arg;
+
+    return AM_OK;
+}
+
+int am_zlg_dma_isr_disconnect (int chan, am_zlg_pfn_dma_isr_t pfn_isr, void *p_arg)
+{
+    __g_chan[chan].pfn_isr = NULL;
+
+    return AM_OK;
+}
+
+int am_zlg_dma_chan_stop (int chan)
+{
+    __g_chan[chan].run = 0;
+
+    return AM_OK;
+}
+
+int am_zlg_dma_chan_start (int chan)
+{
+    __g_chan[chan].run = 1;
+
+    if (__g_chan[__CHAN_TX].run && __g_chan[__CHAN_RX].run) {
+        __g_dma_pending = 1;
+        __g_dma_done    = __g_now + __g_chan[__CHAN_TX].desc.nbytes * __g_t_byte;
+        __trace("dma");
+    }
+    return AM_OK;
+}
+
+static void __dma_copy (void)
+{
+    amhw_zlg_dma_xfer_desc_t *p_tx = &__g_chan[__CHAN_TX].desc;
+    amhw_zlg_dma_xfer_desc_t *p_rx = &__g_chan[__CHAN_RX].desc;
+
+    uint8_t  *p_src = (uint8_t *)(uintptr_t)p_tx->src_addr;
+    uint8_t  *p_dst = (uint8_t *)(uintptr_t)p_rx->dst_addr;
+    int       width = 1 << ((p_tx->xfercfg >> 10) & 3);
+    int       sinc  = p_tx->xfercfg & AMHW_ZLG_DMA_CHAN_MEM_ADD_INC_ENABLE;
+    int       dinc  = p_rx->xfercfg & AMHW_ZLG_DMA_CHAN_MEM_ADD_INC_ENABLE;
+    uint32_t  i;
+
+    for (i = 0; i < p_tx->nbytes; i += width) {
+        memcpy(p_dst + (dinc ? i : 0), p_src + (sinc ? i : 0), width);
+    }
+    __g_chan[__CHAN_TX].run = 0;
+    __g_chan[__CHAN_RX].run = 0;
+}
+
+/* runs the hardware until no interrupt is pending */
+static void __hw_run (void)
+{
+    while (__g_dma_pending) {
+        __g_dma_pending = 0;
+        if (__g_dma_done > __g_now) {
+            __g_now = __g_dma_done;
+        }
+        __dma_copy();
+
+        /* only channels with an ISR have the completion interrupt enabled */
+        if (__g_chan[__CHAN_TX].pfn_isr != NULL) {
+            __g_irqs++;
+            __g_now += __T_IRQ;
+            __g_chan[__CHAN_TX].pfn_isr(__g_chan[__CHAN_TX].p_arg,
+                                        AM_ZLG_DMA_INT_NORMAL);
+        }
+        if (__g_chan[__CHAN_RX].pfn_isr != NULL) {
+            __g_irqs++;
+            __g_now += __T_IRQ;
+            __g_chan[__CHAN_RX].pfn_isr(__g_chan[__CHAN_RX].p_arg,
+                                        AM_ZLG_DMA_INT_NORMAL);
+        }
+    }
+}
+
+/* the waiting task sleeps until the interrupt, then is woken up */
+static void __wait_sleep (void *p_arg)
+{
+    __hw_run();
+    __g_now += __T_WAKE;
+}
+
+static const am_wait_backend_t __g_wait_backend = {
+    NULL,
+    __wait_sleep,
+    NULL,
+    NULL
+};
+
+/*******************************************************************************
+  ordering
+*******************************************************************************/
+
+static am_zlg_spi_dma_dev_t     *__gp_dev;
+static am_zlg_spi_dma_devinfo_t  __g_devinfo;
+static am_spi_device_t           __g_spi_dev;
+static am_spi_handle_t           __g_handle;
+
+typedef struct {
+    am_spi_message_t  msg;
+    am_spi_transfer_t trans[4];
+} __msg_t;
+
+static __msg_t __g_q[8];
+
+static void __complete (void *p_arg)
+{
+    char buf[16];
+
+    if (__g_norder < (int)AM_NELEMENTS(__g_order)) {
+        __g_order[__g_norder++] = (int)(intptr_t)p_arg;
+    }
+    sprintf(buf, "done%d", (int)(intptr_t)p_arg);
+    __trace(buf);
+}
+
+static void __msg_build (__msg_t *p_m, int id, int nbytes, int offset)
+{
+    am_spi_msg_init(&p_m->msg, __complete, (void *)(intptr_t)id);
+    am_spi_mktrans(&p_m->trans[0],
+                   __g_tx + offset, __g_rx + offset, nbytes, 0, 0, 0, 0, 0);
+    am_spi_trans_add_tail(&p_m->msg, &p_m->trans[0]);
+}
+
+static void __msg_check (__msg_t *p_m, int nbytes, int offset)
+{
+    if ((p_m->msg.status != AM_OK) ||
+        (p_m->msg.actual_length != (uint32_t)nbytes) ||
+        memcmp(__g_rx + offset, __g_tx + offset, nbytes)) {
+        printf("message %d: status %d, %u bytes, data %s\n",
+               (int)(intptr_t)p_m->msg.p_arg, p_m->msg.status,
+               (unsigned)p_m->msg.actual_length,
+               memcmp(__g_rx + offset, __g_tx + offset, nbytes) ? "bad" : "ok");
+        __g_errs++;
+    }
+}
+
+static void __order_check (const char *p_name, const int *p_expect, int n)
+{
+    int ok = (__g_norder == n);
+    int i;
+
+    for (i = 0; ok && (i < n); i++) {
+        ok = (__g_order[i] == p_expect[i]);
+    }
+
+    printf("%-50s %s, order:", p_name, ok ? "ok " : "BAD");
+    for (i = 0; i < __g_norder; i++) {
+        printf(" %d", __g_order[i]);
+    }
+    printf("\n");
+
+    if (!ok) {
+        __g_errs++;
+    }
+}
+
+/* a long and a short message from an interrupt */
+static void __isr_submit (void)
+{
+    __msg_build(&__g_q[2], 2, 64, 200);
+    am_spi_msg_start(&__g_spi_dev, &__g_q[2].msg);
+    __msg_build(&__g_q[3], 3, 1, 300);
+    am_spi_msg_start(&__g_spi_dev, &__g_q[3].msg);
+}
+
+static void __callback_submit (void *p_arg)
+{
+    __complete(p_arg);
+    __msg_build(&__g_q[5], 5, 2, 400);
+    am_spi_msg_start(&__g_spi_dev, &__g_q[5].msg);
+}
+
+static void __order_test (void)
+{
+    static const int expect_busy[]     = {0, 1};
+    static const int expect_isr[]      = {1, 2, 3};
+    static const int expect_callback[] = {4, 5};
+
+    am_zlg_spi_dma_poll_ns_set(__g_handle, 10000);
+
+    __g_norder = 0;
+    __msg_build(&__g_q[0], 0, 64, 0);
+    am_spi_msg_start(&__g_spi_dev, &__g_q[0].msg);
+    __msg_build(&__g_q[1], 1, 1, 100);
+    am_spi_msg_start(&__g_spi_dev, &__g_q[1].msg);
+    __order_check("short message behind a DMA message", expect_busy, 0);
+    __hw_run();
+    __order_check("  ... after the DMA message", expect_busy, 2);
+    __msg_check(&__g_q[0], 64, 0);
+    __msg_check(&__g_q[1], 1, 100);
+
+    __g_norder = 0;
+    __msg_build(&__g_q[1], 1, 2, 100);
+    __gpfn_poll_hook = __isr_submit;
+    am_spi_msg_start(&__g_spi_dev, &__g_q[1].msg);
+    __hw_run();
+    __order_check("long + short from an ISR during a polled message",
+                  expect_isr, 3);
+    __msg_check(&__g_q[1], 2, 100);
+    __msg_check(&__g_q[2], 64, 200);
+    __msg_check(&__g_q[3], 1, 300);
+
+    __g_norder = 0;
+    __msg_build(&__g_q[4], 4, 1, 500);
+    __g_q[4].msg.pfn_complete = __callback_submit;
+    am_spi_msg_start(&__g_spi_dev, &__g_q[4].msg);
+    __hw_run();
+    __order_check("message from the callback of a polled message",
+                  expect_callback, 2);
+    __msg_check(&__g_q[5], 2, 400);
+
+    if (__gp_dev->busy) {
+        printf("controller still busy\n");
+        __g_errs++;
+    }
+}
+
+/* the same message on the DMA and the polled path */
+static void __path_test (void)
+{
+    static const char *name[] = {"dma", "poll"};
+    char               trace[2][sizeof(__g_trace)];
+    __msg_t            m, m2;
+    int                p, ok;
+    char              *p_src, *p_dst;
+
+    for (p = 0; p < 2; p++) {
+        am_zlg_spi_dma_poll_ns_set(__g_handle, p ? 0xFFFFFFFF : 0);
+
+        am_spi_msg_init(&m.msg, __complete, (void *)9);
+        am_spi_mktrans(&m.trans[0], __g_tx,     __g_rx,      2, 1,  8, 0, 0, 0);
+        am_spi_mktrans(&m.trans[1], __g_tx + 2, __g_rx + 2,  4, 0, 16, 0, 0, 0);
+        am_spi_mktrans(&m.trans[2], __g_tx + 6, __g_rx + 8,  8, 0, 32, 0, 0, 0);
+        am_spi_mktrans(&m.trans[3], NULL,       __g_rx + 16, 1, 1,  8, 0, 0, 0);
+        am_spi_trans_add_tail(&m.msg, &m.trans[0]);
+        am_spi_trans_add_tail(&m.msg, &m.trans[1]);
+        am_spi_trans_add_tail(&m.msg, &m.trans[2]);
+        am_spi_trans_add_tail(&m.msg, &m.trans[3]);
+
+        memset(__g_rx, 0, 32);
+        __g_trace_len = 0;
+        __g_trace[0]  = '\0';
+        am_spi_msg_start(&__g_spi_dev, &m.msg);
+        __hw_run();
+
+        /* cs_change on the last transfer keeps the chip selected */
+        __msg_build(&m2, 10, 1, 600);
+        am_spi_msg_start(&__g_spi_dev, &m2.msg);
+        __hw_run();
+
+        ok = !memcmp(__g_rx, __g_tx, 6) && !memcmp(__g_rx + 8, __g_tx + 6, 8) &&
+             (m.msg.actual_length == 15) && (m.msg.status == AM_OK);
+        if (!ok) {
+            __g_errs++;
+        }
+
+        /* the DMA starts are not visible on the pins */
+        p_dst = trace[p];
+        for (p_src = strtok(__g_trace, " "); p_src; p_src = strtok(NULL, " ")) {
+            if (strcmp(p_src, "dma") != 0) {
+                p_dst += sprintf(p_dst, "%s ", p_src);
+            }
+        }
+        printf("%-4s data %s, pins: %s\n", name[p], ok ? "ok " : "BAD", trace[p]);
+    }
+
+    if (strcmp(trace[0], trace[1]) != 0) {
+        printf("chip select sequence differs between the paths\n");
+        __g_errs++;
+    }
+}
+
+/*******************************************************************************
+  latency
+*******************************************************************************/
+
+/* from am_spi_msg_start() to the wakeup of the waiting task */
+static double __latency (int nbytes, uint32_t poll_ns, unsigned long *p_irqs)
+{
+    am_wait_t wait;
+    __msg_t   m;
+
+    am_zlg_spi_dma_poll_ns_set(__g_handle, poll_ns);
+    am_wait_init(&wait);
+    am_spi_msg_init(&m.msg, (am_pfnvoid_t)am_wait_done, &wait);
+    am_spi_mktrans(&m.trans[0], __g_tx, __g_rx, nbytes, 0, 0, 0, 0, 0);
+    am_spi_trans_add_tail(&m.msg, &m.trans[0]);
+
+    memset(__g_rx, 0, nbytes);
+    __g_now  = 0;
+    __g_irqs = 0;
+    am_spi_msg_start(&__g_spi_dev, &m.msg);
+    am_wait_on(&wait);
+
+    if ((m.msg.status != AM_OK) || memcmp(__g_rx, __g_tx, nbytes)) {
+        printf("%d bytes: status %d or data bad\n", nbytes, m.msg.status);
+        __g_errs++;
+    }
+
+    *p_irqs = __g_irqs;
+
+    return __g_now;
+}
+
+static void __latency_bench (uint32_t speed)
+{
+    static const int nbytes[] = {1, 2, 4, 8, 16, 32, 64};
+    unsigned long    irq_dma, irq_poll, irq_def;
+    double           t_dma, t_poll, t_def;
+    int              i;
+
+    __g_t_byte = 8e6 / speed;
+    am_spi_mkdev(&__g_spi_dev, __g_handle, 8, AM_SPI_MODE_0, speed, 1, NULL);
+    am_spi_setup(&__g_spi_dev);
+
+    printf("\n%.1f MHz  bytes  dma (us) irqs  poll (us) irqs  "
+           "default %u ns (us)\n", speed / 1e6, (unsigned)AM_ZLG_SPI_DMA_POLL_NS);
+    for (i = 0; i < (int)AM_NELEMENTS(nbytes); i++) {
+        t_dma  = __latency(nbytes[i], 0, &irq_dma);
+        t_poll = __latency(nbytes[i], 0xFFFFFFFF, &irq_poll);
+        t_def  = __latency(nbytes[i], AM_ZLG_SPI_DMA_POLL_NS, &irq_def);
+        printf("         %5d %9.2f %4lu %10.2f %4lu %14.2f (%s)\n",
+               nbytes[i], t_dma, irq_dma, t_poll, irq_poll, t_def,
+               irq_def ? "dma" : "poll");
+    }
+}
+
+static void __calibrate_bench (void)
+{
+    unsigned long irqs;
+    double        diff;
+    int           ret;
+
+    __g_t_byte = 1.0;
+    am_spi_mkdev(&__g_spi_dev, __g_handle, 8, AM_SPI_MODE_0, 8000000, 1, NULL);
+    am_spi_setup(&__g_spi_dev);
+
+    diff = __latency(2, 0, &irqs) - __latency(2, 0xFFFFFFFF, &irqs);
+
+    ret = am_spi_poll_calibrate(&__g_spi_dev, am_zlg_spi_dma_poll_ns_set,
+                                __g_tx, __g_rx, 2, 1000);
+
+    printf("\ncalibrate (2 bytes, 1000 ms): %d ns, model difference %.0f ns\n",
+           ret, diff * 1000);
+
+    if ((ret < 0) || (ret != (int)__gp_dev->poll_ns) ||
+        (ret < diff * 1000 * 0.9) || (ret > diff * 1000 * 1.1)) {
+        printf("calibration out of range\n");
+        __g_errs++;
+    }
+}
+
+int main (void)
+{
+    uint8_t *p_low;
+    int      i;
+
+    /* the drivers keep buffer addresses in 32-bit registers */
+    p_low = mmap(NULL, 1 << 20, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_32BIT, -1, 0);
+    if (p_low == MAP_FAILED) {
+        printf("mmap failed\n");
+        return 1;
+    }
+    __gp_dev = (am_zlg_spi_dma_dev_t *)(p_low + 4096);
+    __g_tx   = p_low + 65536;
+    __g_rx   = p_low + 131072;
+
+    for (i = 0; i < 4096; i++) {
+        __g_tx[i] = rand();
+    }
+
+    am_wait_backend_set(&__g_wait_backend);
+
+    __g_devinfo.spi_reg_base = (uint32_t)(uintptr_t)p_low;
+    __g_devinfo.dma_chan_tx  = __CHAN_TX;
+    __g_devinfo.dma_chan_rx  = __CHAN_RX;
+    __g_handle = am_zlg_spi_dma_init(__gp_dev, &__g_devinfo);
+
+    __g_t_byte = 1.0;
+    am_spi_mkdev(&__g_spi_dev, __g_handle, 8, AM_SPI_MODE_0, 8000000, 1, NULL);
+    am_spi_setup(&__g_spi_dev);
+
+    __order_test();
+    __path_test();
+    __latency_bench(8000000);
+    __latency_bench(1000000);
+    __calibrate_bench();
+
+    printf("errs=%lu\n", __g_errs);
+
+    return __g_errs ? 1 : 0;
+}
+
+/* end of file */
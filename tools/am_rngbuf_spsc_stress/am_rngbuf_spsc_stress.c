@@ -0,0 +1,266 @@
+/*******************************************************************************
+*                                 AMetal
+*                       ----------------------------
+*                       innovating embedded platform
+*
+* Copyright (c) 2001-2018 Guangzhou ZHIYUAN Electronics Co., Ltd.
+* All rights reserved.
+*
+* Contact information:
+* web site:    http://www.zlg.cn/
+*******************************************************************************/
+
+/**
+ * \file
+ * \brief two-thread stress test and throughput for am_rngbuf_spsc (host program)
+ *
+ * A producer thread writes a numbered byte sequence into a 256-byte SPSC
+ * ring buffer, switching between am_rngbuf_spsc_putchar(), reserve/publish
+ * and am_rngbuf_spsc_put(). The consumer thread reads it back with
+ * am_rngbuf_spsc_getchar(), peek/commit and am_rngbuf_spsc_get() and checks
+ * every byte. The two threads run truly in parallel on a multi-core host,
+ * which is a harder test of the index/barrier ordering than an ISR and a
+ * task on one core.
+ *
+ * The same transfer is then repeated with block put/get through the SPSC
+ * buffer and through the locking am_rngbuf with a mutex around each call,
+ * and the throughput of both is printed.
+ *
+ * build (from the root of the repository):
+ * \code
+ * gcc -std=gnu99 -O2 -pthread -Iinterface -Isoc/zlg/zlg217               \
+ *     tools/am_rngbuf_spsc_stress/am_rngbuf_spsc_stress.c                \
+ *     components/util/source/am_rngbuf.c -o am_rngbuf_spsc_stress
+ * ./am_rngbuf_spsc_stress [bytes]
+ * \endcode
+ *
+ * The exit status is 0 if no error is found.
+ *
+ * \internal
+ * \par modification history:
+ * - 1.00 26-10-18  agent, first implementation
+ * \endinternal
+ */
+
+#include "am_rngbuf.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+#define __TEST_BUF_SIZE    256
+#define __TEST_BLK_MAX     37
+
+static struct am_rngbuf_spsc  __g_spsc;
+static struct am_rngbuf       __g_rb;
+static pthread_mutex_t        __g_lock = PTHREAD_MUTEX_INITIALIZER;
+static char                   __g_storage[__TEST_BUF_SIZE];
+static unsigned long          __g_total;
+static volatile unsigned long __g_errs;
+
+static double __now_get (void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* producer: all three write paths in turn */
+static void *__mixed_producer (void *p_arg)
+{
+    unsigned long i = 0, last;
+    size_t        n, k;
+    char         *p;
+    char          tmp[__TEST_BLK_MAX];
+
+    (void)p_arg;
+
+    while (i < __g_total) {
+        last = i;
+        switch (i % 3) {
+
+        case 0:
+            if (am_rngbuf_spsc_putchar(&__g_spsc, (char)i) == 1) {
+                i++;
+            }
+            break;
+
+        case 1:
+            n = am_rngbuf_spsc_reserve(&__g_spsc, &p);
+            if (n > __g_total - i) {
+                n = __g_total - i;
+            }
+            if (n > 5) {
+                n = 5;
+            }
+            for (k = 0; k < n; k++) {
+                p[k] = (char)(i + k);
+            }
+            am_rngbuf_spsc_publish(&__g_spsc, n);
+            i += n;
+            break;
+
+        default:
+            n = (__g_total - i < __TEST_BLK_MAX) ? __g_total - i : __TEST_BLK_MAX;
+            for (k = 0; k < n; k++) {
+                tmp[k] = (char)(i + k);
+            }
+            i += am_rngbuf_spsc_put(&__g_spsc, tmp, n);
+            break;
+        }
+        if (i == last) {
+            sched_yield();                    /* full, let the consumer run */
+        }
+    }
+
+    return NULL;
+}
+
+/* consumer: all three read paths in turn, every byte checked */
+static void __mixed_consumer (void)
+{
+    unsigned long j = 0, last;
+    size_t        n, k;
+    char         *p;
+    char          c, tmp[50];
+
+    while (j < __g_total) {
+        last = j;
+        switch (j % 3) {
+
+        case 0:
+            if (am_rngbuf_spsc_getchar(&__g_spsc, &c) == 1) {
+                if (c != (char)j) {
+                    __g_errs++;
+                }
+                j++;
+            }
+            break;
+
+        case 1:
+            n = am_rngbuf_spsc_peek(&__g_spsc, &p);
+            for (k = 0; k < n; k++) {
+                if (p[k] != (char)(j + k)) {
+                    __g_errs++;
+                }
+            }
+            am_rngbuf_spsc_commit(&__g_spsc, n);
+            j += n;
+            break;
+
+        default:
+            n = am_rngbuf_spsc_get(&__g_spsc, tmp, sizeof(tmp));
+            for (k = 0; k < n; k++) {
+                if (tmp[k] != (char)(j + k)) {
+                    __g_errs++;
+                }
+            }
+            j += n;
+            break;
+        }
+        if (j == last) {
+            sched_yield();                    /* empty, let the producer run */
+        }
+    }
+}
+
+static void *__block_producer (void *p_arg)
+{
+    unsigned long i = 0;
+    int           locked = (p_arg != NULL);
+    size_t        n, k;
+    char          tmp[__TEST_BLK_MAX];
+
+    while (i < __g_total) {
+        n = (__g_total - i < __TEST_BLK_MAX) ? __g_total - i : __TEST_BLK_MAX;
+        for (k = 0; k < n; k++) {
+            tmp[k] = (char)(i + k);
+        }
+        if (locked) {
+            pthread_mutex_lock(&__g_lock);
+            n = am_rngbuf_put(&__g_rb, tmp, n);
+            pthread_mutex_unlock(&__g_lock);
+        } else {
+            n = am_rngbuf_spsc_put(&__g_spsc, tmp, n);
+        }
+        if (n == 0) {
+            sched_yield();
+        }
+        i += n;
+    }
+
+    return NULL;
+}
+
+static void __block_consumer (int locked)
+{
+    unsigned long j = 0;
+    size_t        n, k;
+    char          tmp[64];
+
+    while (j < __g_total) {
+        if (locked) {
+            pthread_mutex_lock(&__g_lock);
+            n = am_rngbuf_get(&__g_rb, tmp, sizeof(tmp));
+            pthread_mutex_unlock(&__g_lock);
+        } else {
+            n = am_rngbuf_spsc_get(&__g_spsc, tmp, sizeof(tmp));
+        }
+        if (n == 0) {
+            sched_yield();
+        }
+        for (k = 0; k < n; k++) {
+            if (tmp[k] != (char)(j + k)) {
+                __g_errs++;
+            }
+        }
+        j += n;
+    }
+}
+
+/* run one producer/consumer pair, return MB/s */
+static double __run (void *(*pfn_producer) (void *),
+                     void  (*pfn_consumer) (int),
+                     int     locked)
+{
+    pthread_t th;
+    double    t0 = __now_get();
+
+    pthread_create(&th, NULL, pfn_producer, locked ? &__g_lock : NULL);
+    pfn_consumer(locked);
+    pthread_join(th, NULL);
+
+    return __g_total / (__now_get() - t0) / 1e6;
+}
+
+static void __mixed_consumer_run (int locked)
+{
+    (void)locked;
+    __mixed_consumer();
+}
+
+int main (int argc, char **argv)
+{
+    double spsc, lock;
+
+    __g_total = (argc > 1) ? strtoul(argv[1], NULL, 0) : 50000000ul;
+
+    am_rngbuf_spsc_init(&__g_spsc, __g_storage, sizeof(__g_storage));
+    __run(__mixed_producer, __mixed_consumer_run, 0);
+    printf("mixed paths: %lu bytes, errs=%lu\n", __g_total, __g_errs);
+
+    am_rngbuf_spsc_init(&__g_spsc, __g_storage, sizeof(__g_storage));
+    spsc = __run(__block_producer, __block_consumer, 0);
+
+    am_rngbuf_init(&__g_rb, __g_storage, sizeof(__g_storage));
+    lock = __run(__block_producer, __block_consumer, 1);
+
+    printf("block put/get: spsc %.1f MB/s, am_rngbuf + mutex %.1f MB/s, "
+           "errs=%lu\n", spsc, lock, __g_errs);
+
+    return __g_errs ? 1 : 0;
+}
+
+/* end of file */
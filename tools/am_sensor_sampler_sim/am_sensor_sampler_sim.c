@@ -0,0 +1,316 @@
+/*******************************************************************************
+*                                 AMetal
+*                       ----------------------------
+*                       innovating embedded platform
+*
+* Copyright (c) 2001-2018 Guangzhou ZHIYUAN Electronics Co., Ltd.
+* All rights reserved.
+*
+* Contact information:
+* web site:    http://www.zlg.cn/
+*******************************************************************************/
+
+/**
+ * \file
+ * \brief schedule simulator for am_sensor_sampler (host program)
+ *
+ * Several simulated sensors with different periods and channel counts are
+ * sampled on a 1 ms system tick. The real am_softimer runs the scheduling
+ * timer, the isr_defer job is run right after the tick in which it was
+ * added. The simulated drivers encode the sensor, channel and read tick in
+ * each value, so the consumer, which drains the buffer now and then, can
+ * check every sample. The test also checks that:
+ *  - the k-th read of a source happens at its k-th due tick, or at most
+ *    AM_SENSOR_SAMPLER_BATCH_MS earlier, so the rate does not drift;
+ *  - channels flagged invalid by the driver are skipped, failed reads are
+ *    counted and produce no samples;
+ *  - a source removed in the middle of the run is no longer read, and is
+ *    read again from the tick it is added back.
+ *
+ * The output compares the number of timer wakeups with the number of
+ * sensor reads (one wakeup per read with a timer per sensor), and the
+ * number of bus reads with the number of samples (one read per channel
+ * without the batched data_get).
+ *
+ * build and run with and without a batch window (from the root of the
+ * repository):
+ * \code
+ * for batch in 0 3; do
+ *     gcc -std=gnu99 -O2 -Iinterface -Isoc/zlg/zlg217                    \
+ *         -DAM_SENSOR_SAMPLER_BATCH_MS=$batch                            \
+ *         tools/am_sensor_sampler_sim/am_sensor_sampler_sim.c            \
+ *         components/service/source/am_sensor_sampler.c                  \
+ *         components/util/source/am_softimer.c -o am_sensor_sampler_sim  \
+ *     && ./am_sensor_sampler_sim [ticks]
+ * done
+ * \endcode
+ *
+ * The exit status is 0 if no error is found.
+ *
+ * \internal
+ * \par modification history:
+ * - 1.00 26-10-18  agent, first implementation
+ * \endinternal
+ */
+
+#include "am_sensor_sampler.h"
+#include "am_system.h"
+#include "am_int.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define __SIM_NSENSORS     6
+#define __SIM_BUF_SIZE     256
+#define __SIM_DRAIN_TICKS  50
+
+/* the source removed at ticks/2 and added back at 3 * ticks/4 */
+#define __SIM_REMOVED      2
+
+/* per-sensor setup */
+static const unsigned int __g_period[__SIM_NSENSORS] = {10, 20, 25, 50, 7, 100};
+static const int          __g_nchans[__SIM_NSENSORS] = { 2,  1,  4,  3, 1,   2};
+
+static const int __g_ids[AM_SENSOR_SAMPLER_CHAN_MAX] = {0, 1, 2, 3};
+
+static am_tick_t              __g_now;
+static am_isr_defer_job_t    *__g_job_pending;
+
+static unsigned long          __g_bus_reads;
+static unsigned long          __g_chan_reads;
+static unsigned long          __g_fail_reads;
+static unsigned long          __g_invalid;
+static unsigned long          __g_wakeups;
+static unsigned long          __g_errs;
+
+/* model: first due tick and read count of each source in the current run */
+static am_tick_t              __g_first[__SIM_NSENSORS];
+static unsigned long          __g_reads[__SIM_NSENSORS];
+static am_bool_t              __g_active[__SIM_NSENSORS];
+
+/* samples still expected by the consumer */
+static unsigned long          __g_expected;
+
+/*******************************************************************************
+  platform stubs
+*******************************************************************************/
+
+am_tick_t am_sys_tick_get (void)
+{
+    return __g_now;
+}
+
+am_tick_t am_ms_to_ticks (unsigned int ms)
+{
+    return ms;
+}
+
+unsigned int am_ticks_to_ms (am_tick_t ticks)
+{
+    return ticks;
+}
+
+uint32_t am_int_cpu_lock (void)
+{
+    return 0;
+}
+
+void am_int_cpu_unlock (uint32_t key)
+{
+    (void)key;
+}
+
+void am_isr_defer_job_init (am_isr_defer_job_t *p_job,
+                            am_pfnvoid_t        func,
+                            void               *p_arg,
+                            uint16_t            pri)
+{
+    p_job->func  = func;
+    p_job->p_arg = p_arg;
+    p_job->pri   = pri;
+    p_job->flags = 0;
+}
+
+int am_isr_defer_job_add (am_isr_defer_job_t *p_job)
+{
+    __g_job_pending = p_job;
+    return AM_OK;
+}
+
+/*******************************************************************************
+  simulated sensors
+*******************************************************************************/
+
+static am_err_t __sensor_data_get (void            *p_drv,
+                                   const int       *p_ids,
+                                   int              num,
+                                   am_sensor_val_t *p_buf)
+{
+    int           s = (int)(long)p_drv;
+    am_tick_t     due;
+    unsigned long k = __g_reads[s]++;
+    int           i;
+
+    __g_bus_reads++;
+    __g_chan_reads += num;
+
+    if (!__g_active[s]) {
+        printf("sensor %d: read at %lu while removed\n", s, (unsigned long)__g_now);
+        __g_errs++;
+    }
+
+    /* the k-th read belongs to the k-th due tick, batching may read early */
+    due = __g_first[s] + k * __g_period[s];
+    if ((__g_now > due) || (due - __g_now > AM_SENSOR_SAMPLER_BATCH_MS)) {
+        printf("sensor %d: read %lu at %lu, due at %lu\n",
+               s, k, (unsigned long)__g_now, (unsigned long)due);
+        __g_errs++;
+    }
+
+    /* every 97th read of sensor 1 fails */
+    if ((s == 1) && (k % 97 == 96)) {
+        __g_fail_reads++;
+        return -AM_EIO;
+    }
+
+    for (i = 0; i < num; i++) {
+
+        /* channel 3 of sensor 2 is invalid on odd reads */
+        if ((s == 2) && (p_ids[i] == 3) && (k & 1)) {
+            p_buf[i].val  = 0;
+            p_buf[i].unit = AM_SENSOR_UNIT_INVALID;
+            __g_invalid++;
+            continue;
+        }
+        p_buf[i].val  = (int32_t)((__g_now << 8) | (s << 4) | p_ids[i]);
+        p_buf[i].unit = 0;
+        __g_expected++;
+    }
+
+    return AM_OK;
+}
+
+static const struct am_sensor_drv_funcs __g_sensor_funcs = {
+    NULL,                   /* pfn_type_get */
+    __sensor_data_get,
+    NULL,                   /* pfn_enable */
+    NULL,                   /* pfn_disable */
+    NULL,                   /* pfn_attr_set */
+    NULL,                   /* pfn_attr_get */
+    NULL,                   /* pfn_trigger_cfg */
+    NULL,                   /* pfn_trigger_on */
+    NULL,                   /* pfn_trigger_off */
+};
+
+static am_sensor_serv_t        __g_sensor[__SIM_NSENSORS];
+static am_sensor_sampler_src_t __g_src[__SIM_NSENSORS];
+
+AM_SENSOR_SAMPLER_DECL_STATIC(__g_sampler, __SIM_BUF_SIZE);
+
+/*******************************************************************************
+  consumer
+*******************************************************************************/
+
+static void __drain (void)
+{
+    am_sensor_sample_t buf[64];
+    int                n, i, s;
+    uint32_t           v;
+
+    while ((n = am_sensor_sampler_read(&__g_sampler.sampler, buf, 64)) > 0) {
+        for (i = 0; i < n; i++) {
+            s = (int)(buf[i].handle - __g_sensor);
+            v = (uint32_t)buf[i].val.val;
+            if ((s < 0) || (s >= __SIM_NSENSORS) ||
+                (buf[i].id >= __g_nchans[s]) ||
+                (v != (((uint32_t)buf[i].tick << 8) | (s << 4) | buf[i].id))) {
+                printf("bad sample: sensor %d id %d tick %lu val %08x\n",
+                       s, buf[i].id, (unsigned long)buf[i].tick, (unsigned)v);
+                __g_errs++;
+            }
+            __g_expected--;
+        }
+    }
+}
+
+static void __src_add (int s)
+{
+    __g_first[s]  = __g_now;
+    __g_reads[s]  = 0;
+    __g_active[s] = AM_TRUE;
+    if (am_sensor_sampler_add(&__g_sampler.sampler, &__g_src[s], &__g_sensor[s],
+                              __g_ids, __g_nchans[s], __g_period[s]) != AM_OK) {
+        printf("sensor %d: add failed\n", s);
+        __g_errs++;
+    }
+}
+
+int main (int argc, char **argv)
+{
+    unsigned long            ticks = (argc > 1) ? strtoul(argv[1], NULL, 0) :
+                                                  600000;
+    am_sensor_sampler_stat_t stat;
+    am_isr_defer_job_t      *p_job;
+    int                      s;
+
+    am_softimer_module_init(1000);
+    AM_SENSOR_SAMPLER_INIT(__g_sampler);
+
+    for (s = 0; s < __SIM_NSENSORS; s++) {
+        __g_sensor[s].p_funcs = &__g_sensor_funcs;
+        __g_sensor[s].p_drv   = (void *)(long)s;
+        __src_add(s);
+    }
+    am_sensor_sampler_start(&__g_sampler.sampler);
+
+    for (;;) {
+        while ((p_job = __g_job_pending) != NULL) {
+            __g_job_pending = NULL;
+            __g_wakeups++;
+            p_job->func(p_job->p_arg);
+        }
+
+        if (__g_now % __SIM_DRAIN_TICKS == 0) {
+            __drain();
+        }
+
+        if (__g_now == ticks / 2) {
+            am_sensor_sampler_remove(&__g_sampler.sampler, &__g_src[__SIM_REMOVED]);
+            __g_active[__SIM_REMOVED] = AM_FALSE;
+        } else if ((__g_now == ticks / 4 * 3) && !__g_active[__SIM_REMOVED]) {
+            __src_add(__SIM_REMOVED);
+            continue;                         /* the added source is due now */
+        }
+
+        if (__g_now == ticks) {
+            break;
+        }
+
+        __g_now++;
+        am_softimer_module_tick();
+    }
+
+    __drain();
+    am_sensor_sampler_stat_get(&__g_sampler.sampler, &stat);
+
+    if (__g_expected != 0) {
+        printf("%lu samples lost\n", __g_expected);
+        __g_errs++;
+    }
+    if ((stat.nreads != __g_bus_reads) || (stat.err_cnt != __g_fail_reads) ||
+        (stat.overrun != 0)) {
+        printf("stat: reads %u errors %u overrun %u\n",
+               (unsigned)stat.nreads, (unsigned)stat.err_cnt,
+               (unsigned)stat.overrun);
+        __g_errs++;
+    }
+
+    printf("batch=%d ticks=%lu wakeups=%lu sensor reads=%lu channels=%lu "
+           "samples=%u invalid=%lu failed=%lu errs=%lu\n",
+           AM_SENSOR_SAMPLER_BATCH_MS, ticks, __g_wakeups, __g_bus_reads,
+           __g_chan_reads, (unsigned)stat.nsamples, __g_invalid, __g_fail_reads,
+           __g_errs);
+
+    return __g_errs ? 1 : 0;
+}
+
+/* end of file */
@@ -0,0 +1,251 @@
+/*******************************************************************************
+*                                 AMetal
+*                       ----------------------------
+*                       innovating embedded platform
+*
+* Copyright (c) 2001-2018 Guangzhou ZHIYUAN Electronics Co., Ltd.
+* All rights reserved.
+*
+* Contact information:
+* web site:    http://www.zlg.cn/
+*******************************************************************************/
+
+/**
+ * \file
+ * \brief expiry simulator for am_softimer (host program)
+ *
+ * A set of periodic timers is started with random periods (short ones and
+ * long ones beyond the direct range of the timing wheel). Their callbacks
+ * randomly stop or restart some timers, and the main loop does the same
+ * between ticks. Every expiry is checked against a reference model that
+ * knows when each timer is due, so a timer that fires early, late or not at
+ * all is reported.
+ *
+ * With a non-zero step argument, the simulator skips ticks like a tickless
+ * idle loop: it asks am_softimer_module_next_ticks() for the next deadline
+ * and calls am_softimer_module_tick_n() with a random chunk no longer than
+ * that. The reported deadline is also checked against the model: it must not
+ * be later than the real one, and with the delta list it must be exact.
+ *
+ * build and run both backends (from the root of the repository):
+ * \code
+ * for wheel in 0 1; do
+ *     gcc -std=gnu99 -O2 -Iinterface -Isoc/zlg/zlg217                    \
+ *         -DAM_SOFTIMER_WHEEL_EN=$wheel                                  \
+ *         tools/am_softimer_sim/am_softimer_sim.c                        \
+ *         components/util/source/am_softimer.c -o am_softimer_sim        \
+ *     && ./am_softimer_sim [ticks] [seed] [step]
+ * done
+ * \endcode
+ *
+ * The output lists the number of expiries and a checksum over the (tick,
+ * timer index) pairs. The checksum does not depend on the order of the
+ * expiries within one tick, so it is the same for both backends with the
+ * same arguments, with step 0 (one tick call per tick) or not. The exit
+ * status is 0 if no error is found.
+ *
+ * \internal
+ * \par modification history:
+ * - 1.00 26-10-18  agent, first implementation
+ * \endinternal
+ */
+
+#include "am_softimer.h"
+#include "am_int.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define __SIM_NTIMERS     3000
+
+static am_softimer_t __g_timer[__SIM_NTIMERS];
+
+/* tick of the next expiry of each timer, 0 means stopped */
+static unsigned long __g_due[__SIM_NTIMERS];
+static unsigned long __g_period[__SIM_NTIMERS];
+
+static unsigned long __g_now;        /* number of ticks processed */
+static unsigned long __g_fired;
+static unsigned long __g_errs;
+static unsigned long __g_sum;
+
+uint32_t am_int_cpu_lock (void)
+{
+    return 0;
+}
+
+void am_int_cpu_unlock (uint32_t key)
+{
+    (void)key;
+}
+
+/* random period: mostly short, sometimes beyond the wheel range */
+static unsigned int __period_get (void)
+{
+    return (rand() % 3 == 0) ? rand() % 400000 : rand() % 3000;
+}
+
+/* start a timer, clkrate is 1000 so ms is the tick count (at least 1) */
+static void __timer_start (int i, unsigned int ms)
+{
+    am_softimer_start(&__g_timer[i], ms);
+    __g_period[i] = (ms > 0) ? ms : 1;
+    __g_due[i]    = __g_now + __g_period[i];
+}
+
+static void __timer_stop (int i)
+{
+    am_softimer_stop(&__g_timer[i]);
+    __g_due[i] = 0;
+}
+
+static void __timer_callback (void *p_arg)
+{
+    int      i = (int)(long)p_arg;
+    unsigned h;
+
+    if (__g_due[i] != __g_now) {
+        printf("timer %d: fired at %lu, due at %lu\n", i, __g_now, __g_due[i]);
+        __g_errs++;
+    }
+
+    /* the order within one tick may differ between the backends */
+    h  = (unsigned)(__g_now * 2246822519u + i * 3266489917u);
+    h ^= h >> 15;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+
+    __g_fired++;
+    __g_sum += h;
+
+    /* periodic: due again after its period */
+    __g_due[i] = __g_now + __g_period[i];
+
+    /* stop or restart some timers from the callback */
+    h  = (unsigned)(i * 2654435761u ^ __g_now * 40503u);
+    h ^= h >> 13;
+    h *= 0x5bd1e995;
+    h ^= h >> 15;
+    if (h % 7 == 0) {
+        __timer_stop(i);
+    } else if (h % 5 == 0) {
+        __timer_start(i, (h >> 8) % 5000);
+    }
+}
+
+/* the main loop changes a random timer now and then */
+static void __timer_poke (void)
+{
+    int i = rand() % __SIM_NTIMERS;
+
+    if (rand() % 2) {
+        __timer_stop(i);
+    } else {
+        __timer_start(i, rand() % 300000);
+    }
+}
+
+/* check the deadline reported by am_softimer_module_next_ticks() */
+static void __check_next (unsigned int next)
+{
+    unsigned long min = 0;
+    int           i;
+
+    for (i = 0; i < __SIM_NTIMERS; i++) {
+        if (__g_due[i] && ((min == 0) || (__g_due[i] < min))) {
+            min = __g_due[i];
+        }
+    }
+
+    if (min == 0) {
+        if (next != AM_SOFTIMER_TICKS_NONE) {
+            printf("tick %lu: next %u, no timer running\n", __g_now, next);
+            __g_errs++;
+        }
+    } else if ((next == AM_SOFTIMER_TICKS_NONE) || (next == 0) ||
+               (__g_now + next > min) ||
+               (!AM_SOFTIMER_WHEEL_EN && (__g_now + next != min))) {
+        printf("tick %lu: next %u, due in %lu\n", __g_now, next, min - __g_now);
+        __g_errs++;
+    }
+}
+
+/* no running timer may be overdue at the end */
+static void __check_overdue (void)
+{
+    int i;
+
+    for (i = 0; i < __SIM_NTIMERS; i++) {
+        if (__g_due[i] && (__g_due[i] <= __g_now)) {
+            printf("timer %d: due at %lu, never fired\n", i, __g_due[i]);
+            __g_errs++;
+        }
+    }
+}
+
+int main (int argc, char **argv)
+{
+    unsigned long ticks = (argc > 1) ? strtoul(argv[1], NULL, 0) : 700000;
+    unsigned long step  = (argc > 3) ? strtoul(argv[3], NULL, 0) : 0;
+    unsigned long n, poke, calls = 0;
+    unsigned long lcg   = 7;
+    unsigned int  next;
+    int           i;
+
+    srand((argc > 2) ? atoi(argv[2]) : 1);
+
+    am_softimer_module_init(1000);
+
+    for (i = 0; i < __SIM_NTIMERS; i++) {
+        am_softimer_init(&__g_timer[i], __timer_callback, (void *)(long)i);
+        __timer_start(i, __period_get());
+    }
+
+    while (__g_now < ticks) {
+        if (step == 0) {
+            __g_now++;
+            am_softimer_module_tick();
+        } else {
+
+            /*
+             * no timer expires before the reported deadline, so a chunk up to
+             * it only fires timers at its last tick, where __g_now is right
+             */
+            next = am_softimer_module_next_ticks();
+            if ((calls++ % 64) == 0) {
+                __check_next(next);
+            }
+
+            /* own generator, rand() gives the same pokes as with step 0 */
+            lcg  = (lcg * 1103515245u + 12345u) & 0x7FFFFFFFu;
+            poke = 1300 - __g_now % 1300;
+            n    = (lcg >> 8) % step + 1;
+            if (n > poke) {
+                n = poke;
+            }
+            if (n > ticks - __g_now) {
+                n = ticks - __g_now;
+            }
+            if ((next != AM_SOFTIMER_TICKS_NONE) && (n > next)) {
+                n = next;
+            }
+
+            __g_now += n;
+            am_softimer_module_tick_n((unsigned int)n);
+        }
+
+        if (__g_now % 1300 == 0) {
+            __timer_poke();
+        }
+    }
+
+    __check_overdue();
+
+    printf("wheel=%d ticks=%lu calls=%lu expiries=%lu checksum=%08lx "
+           "errs=%lu\n",
+           AM_SOFTIMER_WHEEL_EN, __g_now, (step == 0) ? __g_now : calls,
+           __g_fired, __g_sum & 0xFFFFFFFFul, __g_errs);
+
+    return __g_errs ? 1 : 0;
+}
+
+/* end of file */
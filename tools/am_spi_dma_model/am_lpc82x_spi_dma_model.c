@@ -0,0 +1,626 @@
+/*******************************************************************************
+*                                 AMetal
+*                       ----------------------------
+*                       innovating embedded platform
+*
+* Copyright (c) 2001-2018 Guangzhou ZHIYUAN Electronics Co., Ltd.
+* All rights reserved.
+*
+* Contact information:
+* web site:    http://www.zlg.cn/
+*******************************************************************************/
+
+/**
+ * \file
+ * \brief DMA/SPI model and message latency benchmark for am_lpc82x_spi_dma
+ *        (host program)
+ *
+ * The DMA driver API is replaced by a model of the LPC82x DMA: a channel
+ * runs its descriptor, loads the linked descriptor when RELOAD is set and
+ * raises the interrupt of the channel at the end of a descriptor with SETINTA.
+ * The SPI is a loopback: a frame written to TXDAT takes the control bits of
+ * TXCTL, a frame written to TXDATCTL also updates TXCTL, and the received
+ * frame is the transmitted one. SSEL is asserted by the first frame and
+ * released after a frame with EOT.
+ *
+ * Time is virtual: 30 MHz PCLK, SPI at 10 MHz, 1.2 us per interrupt (entry,
+ * DMA dispatch, callback) and 0.7 us per DMA channel start. Building the
+ * descriptors is not counted.
+ *
+ * The benchmark sends messages of 1 to 16 transfers of 4 bytes, one message
+ * with all transfers and, for comparison, one message per transfer. It prints
+ * the interrupts, the DMA channel starts, the SSEL assertions and the latency
+ * from am_spi_msg_start() to the completion callback. It also runs
+ * write_then_read (1 + 16 bytes), a 3000-byte read split into 1024-frame
+ * descriptors, 16-bit words, a cs_change in the middle of a message and a
+ * change of speed between transfers. The loopback data, actual_length, the
+ * status and the SSEL pattern are checked.
+ *
+ * build (from the root of the repository):
+ * \code
+ * gcc -std=gnu99 -O2 -no-pie -Wno-int-to-pointer-cast                        \
+ *     -Wno-pointer-to-int-cast -Itools/am_spi_dma_model/host -Iinterface     \
+ *     -Isoc/nxp/drivers/include/spi -Isoc/nxp/drivers/include/dma           \
+ *     -Isoc/nxp/drivers/include -Isoc/nxp/lpc824                             \
+ *     tools/am_spi_dma_model/am_lpc82x_spi_dma_model.c                       \
+ *     soc/nxp/drivers/source/spi/am_lpc82x_spi_dma.c                         \
+ *     -o am_lpc82x_spi_dma_model
+ * ./am_lpc82x_spi_dma_model
+ * \endcode
+ *
+ * The driver stores addresses in 32-bit descriptors, so the model runs in the
+ * low 4 GiB (-no-pie and MAP_32BIT). am_lpc84x_spi_dma.c is the same driver.
+ * The exit status is 0 if no error is found.
+ *
+ * \internal
+ * \par modification history:
+ * - 1.00 26-10-18  agent, first implementation
+ * \endinternal
+ */
+
+#define _GNU_SOURCE
+#include "ametal.h"
+#include "am_spi.h"
+#include "am_int.h"
+#include "am_gpio.h"
+#include "am_clk.h"
+#include "am_lpc82x_dma.h"
+#include "am_lpc82x_spi_dma.h"
+#include "hw/amhw_lpc_spi.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#define __SIM_PCLK          30000000
+#define __SIM_SPEED         10000000
+#define __SIM_T_IRQ         1.2         /* us per interrupt */
+#define __SIM_T_DMA_START   0.7         /* us per DMA channel start */
+
+#define __SIM_CHAN_TX       1
+#define __SIM_CHAN_RX       0
+
+#define __SIM_FRAMES_MAX    4096
+
+/* a DMA channel */
+typedef struct __sim_chan {
+    am_lpc82x_dma_xfer_desc_t    desc;     /* the descriptor being run */
+    uint32_t                     done;     /* elements done in desc */
+    am_bool_t                    active;
+    am_lpc82x_dma_complete_cb_t  pfn_cb;
+    void                        *p_arg;
+} __sim_chan_t;
+
+static am_lpc82x_dma_controller_t __g_ctr[2];
+static __sim_chan_t               __g_chan[2];
+static am_bool_t                  __g_pending;
+
+static amhw_lpc_spi_t            *__gp_spi;
+
+static double                     __g_now_us;
+static unsigned long              __g_irqs;
+static unsigned long              __g_dma_starts;
+static unsigned long              __g_ssel_asserts;
+static am_bool_t                  __g_ssel;
+static unsigned long              __g_completes;
+static unsigned long              __g_errs;
+
+/* frames between the TX and RX channels (the SPI holds one frame) */
+static uint32_t                   __g_fifo[__SIM_FRAMES_MAX];
+static int                        __g_fifo_in, __g_fifo_out;
+
+/* SSEL pattern: 'x' for a frame with SSEL asserted, '|' for a release */
+static char                       __g_ssel_log[__SIM_FRAMES_MAX * 2];
+static int                        __g_ssel_len;
+
+/*******************************************************************************
+  host stubs
+*******************************************************************************/
+
+uint32_t am_int_cpu_lock (void)
+{
+    return 0;
+}
+
+void am_int_cpu_unlock (uint32_t key)
+{
+    (void)key;
+}
+
+int am_gpio_set (int pin, int value)
+{
+    (void)pin;
+    (void)value;
+
+    return AM_OK;
+}
+
+int am_gpio_pin_cfg (int pin, uint32_t flags)
+{
+    (void)pin;
+    (void)flags;
+
+    return AM_OK;
+}
+
+int am_clk_rate_get (am_clk_id_t clk_id)
+{
+    (void)clk_id;
+
+    return __SIM_PCLK;
+}
+
+/*******************************************************************************
+  LPC82x DMA model
+*******************************************************************************/
+
+am_lpc82x_dma_controller_t *am_lpc82x_dma_controller_get (uint8_t  chan,
+                                                          uint32_t opt)
+{
+    (void)opt;
+
+    __g_ctr[chan].chan = chan;
+
+    return &__g_ctr[chan];
+}
+
+int am_lpc82x_dma_controller_abort (am_lpc82x_dma_controller_t *p_ctr)
+{
+    __g_chan[p_ctr->chan].active = AM_FALSE;
+
+    return AM_OK;
+}
+
+int am_lpc82x_dma_controller_release (am_lpc82x_dma_controller_t *p_ctr)
+{
+    (void)p_ctr;
+
+    return AM_OK;
+}
+
+/* the same as the driver: the addresses are the end addresses */
+int am_lpc82x_dma_xfer_desc_build (am_lpc82x_dma_xfer_desc_t *p_desc,
+                                   uint32_t                   src_addr,
+                                   uint32_t                   dst_addr,
+                                   uint32_t                   nbytes,
+                                   uint32_t                   flags)
+{
+    uint32_t width = 1u << AM_BITS_GET(flags, 8, 2);
+
+    if (!AM_ALIGNED(src_addr, width) || !AM_ALIGNED(dst_addr, width) ||
+        !AM_ALIGNED(nbytes, width) || (nbytes == 0) ||
+        (nbytes / width > 1024)) {
+        printf("bad descriptor: %u bytes of %u\n", (unsigned)nbytes,
+               (unsigned)width);
+        __g_errs++;
+        return -AM_EINVAL;
+    }
+
+    AM_BITS_SET(flags, 16, 10, nbytes / width - 1);
+    p_desc->xfercfg      = flags;
+    p_desc->src_end_addr = AM_BITS_GET(flags, 12, 2) ?
+                           src_addr + nbytes - width : src_addr;
+    p_desc->dst_end_addr = AM_BITS_GET(flags, 14, 2) ?
+                           dst_addr + nbytes - width : dst_addr;
+    p_desc->link         = 0;
+
+    return AM_OK;
+}
+
+int am_lpc82x_dma_xfer_desc_link (am_lpc82x_dma_xfer_desc_t *p_desc,
+                                  am_lpc82x_dma_xfer_desc_t *p_next)
+{
+    if (!AM_ALIGNED(p_next, 16)) {
+        printf("descriptor %p not 16-byte aligned\n", (void *)p_next);
+        __g_errs++;
+        return -AM_EINVAL;
+    }
+    p_desc->link = (uint32_t)(uintptr_t)p_next;
+
+    return AM_OK;
+}
+
+int am_lpc82x_dma_xfer_desc_startup (am_lpc82x_dma_controller_t  *p_ctr,
+                                     am_lpc82x_dma_xfer_desc_t   *p_desc,
+                                     am_lpc82x_dma_complete_cb_t  pfn_callback,
+                                     void                        *p_arg)
+{
+    __sim_chan_t *p_chan = &__g_chan[p_ctr->chan];
+
+    __g_now_us += __SIM_T_DMA_START;
+    __g_dma_starts++;
+
+    p_chan->desc   = *p_desc;
+    p_chan->done   = 0;
+    p_chan->active = AM_TRUE;
+    p_chan->pfn_cb = pfn_callback;
+    p_chan->p_arg  = p_arg;
+
+    __g_pending = AM_TRUE;
+
+    return AM_OK;
+}
+
+static uint32_t __desc_count (const am_lpc82x_dma_xfer_desc_t *p_desc)
+{
+    return AM_BITS_GET(p_desc->xfercfg, 16, 10) + 1;
+}
+
+static uint32_t __desc_width (const am_lpc82x_dma_xfer_desc_t *p_desc)
+{
+    return 1u << AM_BITS_GET(p_desc->xfercfg, 8, 2);
+}
+
+/* address of element i, end addresses count back from the last element */
+static uint32_t __desc_addr (const am_lpc82x_dma_xfer_desc_t *p_desc,
+                             uint32_t end, int inc_shift, uint32_t i)
+{
+    uint32_t width = __desc_width(p_desc);
+    uint32_t n     = __desc_count(p_desc);
+
+    if (AM_BITS_GET(p_desc->xfercfg, inc_shift, 2) == 0) {
+        return end;
+    }
+
+    return end - (n - 1 - i) * width;
+}
+
+/*
+ * finish the element of a channel, return AM_TRUE if the channel stopped;
+ * the interrupt is raised after both channels moved the frame
+ */
+static am_bool_t __chan_step (__sim_chan_t *p_chan, am_bool_t *p_int)
+{
+    am_lpc82x_dma_xfer_desc_t *p_next;
+
+    if (++p_chan->done < __desc_count(&p_chan->desc)) {
+        return AM_FALSE;
+    }
+
+    if (p_chan->desc.xfercfg & AM_LPC82X_DMA_XFER_SETINTA) {
+        *p_int = AM_TRUE;
+    }
+
+    if (p_chan->desc.xfercfg & AM_LPC82X_DMA_XFER_RELOAD) {
+        p_next = (am_lpc82x_dma_xfer_desc_t *)(uintptr_t)p_chan->desc.link;
+        if ((p_next == NULL) || !AM_ALIGNED(p_next, 16) ||
+            !(p_next->xfercfg & AM_LPC82X_DMA_XFER_VALID)) {
+            printf("reload from a bad descriptor %p\n", (void *)p_next);
+            __g_errs++;
+            p_chan->active = AM_FALSE;
+            return AM_TRUE;
+        }
+        p_chan->desc = *p_next;
+        p_chan->done = 0;
+        return AM_FALSE;
+    }
+
+    p_chan->active = AM_FALSE;
+
+    return AM_TRUE;
+}
+
+/* run the channels and the SPI until no channel can move */
+static void __sim_run (void)
+{
+    __sim_chan_t *p_tx = &__g_chan[__SIM_CHAN_TX];
+    __sim_chan_t *p_rx = &__g_chan[__SIM_CHAN_RX];
+    am_bool_t     int_rx, int_tx;
+    uint32_t      addr, val, ctl, bits;
+
+    while (__g_pending) {
+        __g_pending = AM_FALSE;
+
+        /* the DMA interrupt handler is entered after the request */
+        while (p_tx->active || p_rx->active) {
+            int_rx = int_tx = AM_FALSE;
+
+            /* TX: one element to TXDAT or TXDATCTL makes a frame */
+            if (p_tx->active) {
+                addr = __desc_addr(&p_tx->desc, p_tx->desc.src_end_addr,
+                                   12, p_tx->done);
+                if (__desc_width(&p_tx->desc) == 4) {
+                    val = *(uint32_t *)(uintptr_t)addr;
+                } else if (__desc_width(&p_tx->desc) == 2) {
+                    val = *(uint16_t *)(uintptr_t)addr;
+                } else {
+                    val = *(uint8_t *)(uintptr_t)addr;
+                }
+
+                if (p_tx->desc.dst_end_addr ==
+                    (uint32_t)(uintptr_t)&__gp_spi->txdatctl) {
+                    __gp_spi->txctl = val & AMHW_LPC_SPI_TXDATCTL_MASK;
+                } else if (p_tx->desc.dst_end_addr !=
+                           (uint32_t)(uintptr_t)&__gp_spi->txdat) {
+                    printf("TX channel writes %x\n",
+                           (unsigned)p_tx->desc.dst_end_addr);
+                    __g_errs++;
+                }
+                ctl  = __gp_spi->txctl;
+                bits = AM_BITS_GET(ctl, 24, 4) + 1;
+
+                if (!__g_ssel) {
+                    __g_ssel = AM_TRUE;
+                    __g_ssel_asserts++;
+                }
+                __g_ssel_log[__g_ssel_len++] = 'x';
+                __g_now_us += (double)bits * (__gp_spi->div + 1) *
+                              1e6 / __SIM_PCLK;
+                if (ctl & AMHW_LPC_SPI_TXDATCTL_EOT) {
+                    __g_ssel = AM_FALSE;
+                    __g_ssel_log[__g_ssel_len++] = '|';
+                }
+
+                __g_fifo[__g_fifo_in++] = val & ((1u << bits) - 1);
+                __chan_step(p_tx, &int_tx);
+            }
+
+            /* RX: reads the received frame from RXDAT */
+            if (p_rx->active) {
+                if (__g_fifo_out == __g_fifo_in) {
+                    printf("RX channel waits for a frame, TX stopped\n");
+                    __g_errs++;
+                    p_rx->active = AM_FALSE;
+                    break;
+                }
+                if (p_rx->desc.src_end_addr !=
+                    (uint32_t)(uintptr_t)&__gp_spi->rxdat) {
+                    __g_errs++;
+                }
+                val  = __g_fifo[__g_fifo_out++];
+                addr = __desc_addr(&p_rx->desc, p_rx->desc.dst_end_addr,
+                                   14, p_rx->done);
+                if (__desc_width(&p_rx->desc) == 2) {
+                    *(uint16_t *)(uintptr_t)addr = val;
+                } else {
+                    *(uint8_t *)(uintptr_t)addr = val;
+                }
+                __chan_step(p_rx, &int_rx);
+            } else if (__g_fifo_out != __g_fifo_in) {
+                printf("frame received with no RX descriptor\n");
+                __g_errs++;
+                __g_fifo_out = __g_fifo_in;
+            }
+
+            if (int_tx) {
+                __g_irqs++;
+                __g_now_us += __SIM_T_IRQ;
+                __gp_spi->stat |= AMHW_LPC_SPI_STAT_IDLE;
+                p_tx->pfn_cb(p_tx->p_arg, AM_LPC82X_DMA_STAT_INTA);
+            }
+            if (int_rx) {
+                __g_irqs++;
+                __g_now_us += __SIM_T_IRQ;
+                __gp_spi->stat |= AMHW_LPC_SPI_STAT_IDLE;
+                p_rx->pfn_cb(p_rx->p_arg, AM_LPC82X_DMA_STAT_INTA);
+            }
+        }
+    }
+
+    __g_fifo_in = __g_fifo_out = 0;
+}
+
+/*******************************************************************************
+  benchmark
+*******************************************************************************/
+
+static void __complete (void *p_arg)
+{
+    (void)p_arg;
+
+    __g_completes++;
+}
+
+static void __counters_clear (void)
+{
+    __g_now_us       = 0;
+    __g_irqs         = 0;
+    __g_dma_starts   = 0;
+    __g_ssel_asserts = 0;
+    __g_completes    = 0;
+    __g_ssel_len     = 0;
+}
+
+/* run one message and check its status and length */
+static void __msg_run (am_spi_device_t  *p_dev,
+                       am_spi_message_t *p_msg,
+                       uint32_t          len,
+                       const char       *p_name)
+{
+    unsigned long completes = __g_completes;
+
+    am_spi_msg_start(p_dev, p_msg);
+    __sim_run();
+
+    if ((__g_completes != completes + 1) || (p_msg->status != AM_OK) ||
+        (p_msg->actual_length != len)) {
+        printf("%s: status %d, actual_length %u of %u, %lu completions\n",
+               p_name, p_msg->status, (unsigned)p_msg->actual_length,
+               (unsigned)len, __g_completes - completes);
+        __g_errs++;
+    }
+}
+
+static void __check (const void *p_a, const void *p_b, size_t n,
+                     const char *p_name)
+{
+    if (memcmp(p_a, p_b, n) != 0) {
+        printf("%s: loopback data differs\n", p_name);
+        __g_errs++;
+    }
+}
+
+static void __check_ssel (const char *p_expect, const char *p_name)
+{
+    __g_ssel_log[__g_ssel_len] = '\0';
+    if (strcmp(__g_ssel_log, p_expect) != 0) {
+        printf("%s: SSEL %s, expected %s\n", p_name, __g_ssel_log, p_expect);
+        __g_errs++;
+    }
+}
+
+int main (void)
+{
+    static const int                   ks[] = {1, 2, 4, 8, 16};
+    static am_lpc82x_spi_dma_devinfo_t info;
+    am_lpc82x_spi_dma_dev_t           *p_spi_dev;
+    am_spi_handle_t                    handle;
+    am_spi_device_t                    dev;
+    am_spi_message_t                   msg[16];
+    am_spi_transfer_t                  trans[16];
+    uint8_t                           *p_low, *p_tx, *p_rx;
+    uint16_t                          *p_tx16, *p_rx16;
+    double                             t_one, t_many;
+    unsigned long                      irq_one, irq_many;
+    char                               name[48];
+    int                                i, c, k;
+
+    p_low = mmap(NULL, 1 << 20, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_32BIT, -1, 0);
+    if (p_low == MAP_FAILED) {
+        perror("mmap");
+        return 2;
+    }
+    __gp_spi  = (amhw_lpc_spi_t *)p_low;
+    p_spi_dev = (am_lpc82x_spi_dma_dev_t *)(p_low + 4096);
+    p_tx      = p_low + 65536;
+    p_rx      = p_low + 131072;
+    p_tx16    = (uint16_t *)p_tx;
+    p_rx16    = (uint16_t *)p_rx;
+
+    __gp_spi->stat        = AMHW_LPC_SPI_STAT_IDLE;
+    info.spi_regbase      = (uint32_t)(uintptr_t)__gp_spi;
+    info.dma_chan_tx      = __SIM_CHAN_TX;
+    info.dma_chan_rx      = __SIM_CHAN_RX;
+
+    handle = am_lpc82x_spi_dma_init(p_spi_dev, &info);
+    am_spi_mkdev(&dev, handle, 8, AM_SPI_MODE_0, __SIM_SPEED, 0, NULL);
+    am_spi_setup(&dev);
+
+    for (i = 0; i < 65536; i++) {
+        p_tx[i] = (uint8_t)rand();
+    }
+
+    printf("%-22s %13s %13s %8s %18s\n", "", "interrupts", "DMA starts",
+           "SSEL", "latency (us)");
+    printf("%-22s %6s %6s %6s %6s %8s %8s %8s\n", "transfers of 4 bytes",
+           "1 msg", "k msgs", "1 msg", "k msgs", "1 msg", "1 msg", "k msgs");
+
+    for (c = 0; c < (int)AM_NELEMENTS(ks); c++) {
+        k = ks[c];
+
+        /* one message of k transfers */
+        memset(p_rx, 0, 64);
+        __counters_clear();
+        am_spi_msg_init(&msg[0], __complete, NULL);
+        for (i = 0; i < k; i++) {
+            am_spi_mktrans(&trans[i], p_tx + i * 4, p_rx + i * 4, 4,
+                           0, 8, 0, 0, 0);
+            am_spi_trans_add_tail(&msg[0], &trans[i]);
+        }
+        sprintf(name, "%d transfers", k);
+        __msg_run(&dev, &msg[0], k * 4, name);
+        __check(p_rx, p_tx, k * 4, name);
+        t_one   = __g_now_us;
+        irq_one = __g_irqs;
+        {
+            unsigned long starts = __g_dma_starts, ssel = __g_ssel_asserts;
+
+            /* k messages of one transfer */
+            memset(p_rx, 0, 64);
+            __counters_clear();
+            for (i = 0; i < k; i++) {
+                am_spi_msg_init(&msg[i], __complete, NULL);
+                am_spi_mktrans(&trans[i], p_tx + i * 4, p_rx + i * 4, 4,
+                               0, 8, 0, 0, 0);
+                am_spi_trans_add_tail(&msg[i], &trans[i]);
+                __msg_run(&dev, &msg[i], 4, name);
+            }
+            __check(p_rx, p_tx, k * 4, name);
+            t_many   = __g_now_us;
+            irq_many = __g_irqs;
+
+            printf("%-22s %6lu %6lu %6lu %6lu %8lu %8.1f %8.1f\n", name,
+                   irq_one, irq_many, starts, __g_dma_starts, ssel,
+                   t_one, t_many);
+        }
+    }
+
+    /* write_then_read: 1-byte command, 16 bytes read */
+    memset(p_rx, 0, 64);
+    __counters_clear();
+    am_spi_msg_init(&msg[0], __complete, NULL);
+    am_spi_mktrans(&trans[0], p_tx, NULL, 1, 0, 8, 0, 0, 0);
+    am_spi_mktrans(&trans[1], NULL, p_rx, 16, 0, 8, 0, 0, 0);
+    am_spi_trans_add_tail(&msg[0], &trans[0]);
+    am_spi_trans_add_tail(&msg[0], &trans[1]);
+    __msg_run(&dev, &msg[0], 17, "write_then_read");
+    __check_ssel("xxxxxxxxxxxxxxxxx|", "write_then_read");
+    printf("%-22s %6lu %13lu %8lu %8.1f\n", "write_then_read 1+16",
+           __g_irqs, __g_dma_starts, __g_ssel_asserts, __g_now_us);
+
+    /* 3000 bytes, three descriptors of at most 1024 frames */
+    memset(p_rx, 0, 4096);
+    __counters_clear();
+    am_spi_msg_init(&msg[0], __complete, NULL);
+    am_spi_mktrans(&trans[0], p_tx, p_rx, 3000, 0, 8, 0, 0, 0);
+    am_spi_trans_add_tail(&msg[0], &trans[0]);
+    __msg_run(&dev, &msg[0], 3000, "3000 bytes");
+    __check(p_rx, p_tx, 3000, "3000 bytes");
+    printf("%-22s %6lu %13lu %8lu %8.1f\n", "3000 bytes",
+           __g_irqs, __g_dma_starts, __g_ssel_asserts, __g_now_us);
+
+    /* 16-bit words use 16-bit DMA */
+    memset(p_rx, 0, 64);
+    __counters_clear();
+    for (i = 0; i < 8; i++) {
+        p_tx16[i] = 0xA000 + i * 0x111;
+    }
+    am_spi_msg_init(&msg[0], __complete, NULL);
+    am_spi_mktrans(&trans[0], p_tx16, p_rx16, 8, 0, 16, 0, 0, 0);
+    am_spi_mktrans(&trans[1], p_tx16 + 4, p_rx16 + 4, 8, 0, 16, 0, 0, 0);
+    am_spi_trans_add_tail(&msg[0], &trans[0]);
+    am_spi_trans_add_tail(&msg[0], &trans[1]);
+    __msg_run(&dev, &msg[0], 16, "16-bit");
+    __check(p_rx16, p_tx16, 16, "16-bit");
+    __check_ssel("xxxxxxxx|", "16-bit");
+    printf("%-22s %6lu %13lu %8lu %8.1f\n", "16-bit 2 x 4 words",
+           __g_irqs, __g_dma_starts, __g_ssel_asserts, __g_now_us);
+
+    /* cs_change releases SSEL after the first transfer only */
+    memset(p_rx, 0, 64);
+    __counters_clear();
+    am_spi_msg_init(&msg[0], __complete, NULL);
+    am_spi_mktrans(&trans[0], p_tx, p_rx, 2, 1, 8, 0, 0, 0);
+    am_spi_mktrans(&trans[1], p_tx + 2, p_rx + 2, 2, 0, 8, 0, 0, 0);
+    am_spi_mktrans(&trans[2], p_tx + 4, p_rx + 4, 2, 0, 8, 0, 0, 0);
+    for (i = 0; i < 3; i++) {
+        am_spi_trans_add_tail(&msg[0], &trans[i]);
+    }
+    __msg_run(&dev, &msg[0], 6, "cs_change");
+    __check(p_rx, p_tx, 6, "cs_change");
+    __check_ssel("xx|xxxx|", "cs_change");
+    printf("%-22s %6lu %13lu %8lu %8.1f\n", "cs_change 2|2+2",
+           __g_irqs, __g_dma_starts, __g_ssel_asserts, __g_now_us);
+
+    /* a new speed starts a new chain, SSEL stays asserted */
+    memset(p_rx, 0, 64);
+    __counters_clear();
+    am_spi_msg_init(&msg[0], __complete, NULL);
+    am_spi_mktrans(&trans[0], p_tx, p_rx, 2, 0, 8, 0, __SIM_SPEED, 0);
+    am_spi_mktrans(&trans[1], p_tx + 2, p_rx + 2, 2, 0, 8, 0, __SIM_SPEED / 2,
+                   0);
+    am_spi_trans_add_tail(&msg[0], &trans[0]);
+    am_spi_trans_add_tail(&msg[0], &trans[1]);
+    __msg_run(&dev, &msg[0], 4, "speed change");
+    __check(p_rx, p_tx, 4, "speed change");
+    __check_ssel("xxxx|", "speed change");
+    printf("%-22s %6lu %13lu %8lu %8.1f\n", "speed change 2+2",
+           __g_irqs, __g_dma_starts, __g_ssel_asserts, __g_now_us);
+
+    printf("errs=%lu\n", __g_errs);
+
+    return __g_errs ? 1 : 0;
+}
+
+/* end of file */
@@ -0,0 +1,34 @@
+/*******************************************************************************
+*                                 AMetal
+*                       ----------------------------
+*                       innovating embedded platform
+*
+* Copyright (c) 2001-2018 Guangzhou ZHIYUAN Electronics Co., Ltd.
+* All rights reserved.
+*
+* Contact information:
+* web site:    http://www.zlg.cn/
+*******************************************************************************/
+
+/**
+ * \file
+ * \brief host replacement of the LPC82x chip header for the DMA/SPI model
+ *
+ * am_lpc82x_spi_dma.c only needs the common types and the DMA channel options
+ * from the chip header, the real one pulls in the CMSIS core headers.
+ *
+ * \internal
+ * \par modification history:
+ * - 1.00 26-10-18  agent, first implementation
+ * \endinternal
+ */
+
+#ifndef __AM_LPC82X_H
+#define __AM_LPC82X_H
+
+#include "ametal.h"
+#include "lpc82x_dma_chan.h"
+
+#endif /* __AM_LPC82X_H */
+
+/* end of file */
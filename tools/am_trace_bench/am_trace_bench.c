@@ -0,0 +1,485 @@
+/*******************************************************************************
+*                                 AMetal
+*                       ----------------------------
+*                       innovating embedded platform
+*
+* Copyright (c) 2001-2018 Guangzhou ZHIYUAN Electronics Co., Ltd.
+* All rights reserved.
+*
+* Contact information:
+* web site:    http://www.zlg.cn/
+*******************************************************************************/
+
+/**
+ * \file
+ * \brief cost per log call of am_trace (host program)
+ *
+ * am_trace.c runs against a mock UART that only takes bytes when it is
+ * drained, so the log calls are timed alone. Each macro AM_TRACE0() ..
+ * AM_TRACE6() is called in batches with and without a timestamp, and the
+ * best batch gives the host time (and TSC cycles on x86) per call. The same
+ * line through am_kprintf() with an output that drops the characters gives
+ * the formatting cost alone; the time that line takes on the wire at 115200
+ * baud, where am_kprintf() waits for every byte, is printed next to it.
+ *
+ * am_int_cpu_lock() is a compiler barrier here. On a Cortex-M it is a few
+ * instructions (mrs/cpsid/msr), so count a few cycles more per call there.
+ * Host cycles are not Cortex-M cycles; compare the macros with each other
+ * and with am_kprintf(), not with the numbers of a target.
+ *
+ * After every batch the ring is drained and each frame is checked: sync
+ * byte, info, format address, timestamp, arguments and checksum. A call
+ * with more than AM_TRACE_ARGS_MAX arguments must fail with -AM_EINVAL.
+ *
+ * build (from the root of the repository; -no-pie keeps the format strings
+ * below 4 GB, the record stores their address in 32 bits):
+ * \code
+ * gcc -std=gnu99 -O2 -no-pie -Iinterface -Icomponents/util/include           \
+ *     -Isoc/zlg/zlg217                                                       \
+ *     tools/am_trace_bench/am_trace_bench.c                                  \
+ *     components/util/source/am_trace.c                                      \
+ *     components/util/source/am_kprintf.c                                    \
+ *     components/util/source/am_koutput.c                                    \
+ *     components/util/source/am_vfprintf_do.c -o am_trace_bench              \
+ * && ./am_trace_bench [rounds]
+ * \endcode
+ *
+ * The exit status is 0 if no error is found.
+ *
+ * \internal
+ * \par modification history:
+ * - 1.00 26-10-18  agent, first implementation
+ * \endinternal
+ */
+
+#include "ametal.h"
+#include "am_trace.h"
+#include "am_uart.h"
+#include "am_int.h"
+#include "am_softimer.h"
+#include "am_vdebug.h"
+#include "am_koutput.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define __BENCH_TSC         1
+#else
+#define __BENCH_TSC         0
+#endif
+
+#define __BENCH_BATCH       256             /* calls per timed batch */
+#define __BENCH_RING_SIZE   (1 << 13)       /* words, holds one batch */
+#define __BENCH_OUT_SIZE    (1 << 16)
+
+static unsigned long        __g_errs;
+
+static uint32_t             __g_ring[__BENCH_RING_SIZE];
+
+static am_pfnvoid_t         __g_kick;
+static void                *__g_kick_arg;
+
+static am_uart_txchar_get_t __g_txchar_get;
+static void                *__g_txchar_arg;
+static am_bool_t            __g_tx_on;
+
+static uint8_t              __g_out[__BENCH_OUT_SIZE];
+static size_t               __g_out_len;
+
+static uint32_t             __g_ts;
+
+/*******************************************************************************
+  platform stubs
+*******************************************************************************/
+
+uint32_t am_int_cpu_lock (void)
+{
+    __asm__ volatile ("" ::: "memory");
+
+    return 0;
+}
+
+void am_int_cpu_unlock (uint32_t key)
+{
+    (void)key;
+    __asm__ volatile ("" ::: "memory");
+}
+
+int am_softimer_init (am_softimer_t *p_timer, am_pfnvoid_t p_func, void *p_arg)
+{
+    (void)p_timer;
+    __g_kick     = p_func;
+    __g_kick_arg = p_arg;
+
+    return AM_OK;
+}
+
+void am_softimer_start (am_softimer_t *p_timer, unsigned int ms)
+{
+    (void)p_timer;
+    (void)ms;
+}
+
+static uint32_t __ts_get (void)
+{
+    return __g_ts++;
+}
+
+/*******************************************************************************
+  mock UART
+*******************************************************************************/
+
+static void __uart_byte (void)
+{
+    char c;
+
+    if (__g_txchar_get(__g_txchar_arg, &c) != AM_OK) {
+        __g_tx_on = AM_FALSE;
+        return;
+    }
+    if (__g_out_len < sizeof(__g_out)) {
+        __g_out[__g_out_len] = (uint8_t)c;
+    }
+    __g_out_len++;
+}
+
+static int __uart_ioctl (void *p_drv, int request, void *p_arg)
+{
+    (void)p_drv;
+    (void)request;
+    (void)p_arg;
+
+    return AM_OK;
+}
+
+static int __uart_tx_startup (void *p_drv)
+{
+    (void)p_drv;
+    __g_tx_on = AM_TRUE;
+    __uart_byte();
+
+    return AM_OK;
+}
+
+static int __uart_callback_set (void *p_drv,
+                                int   callback_type,
+                                void *pfn_callback,
+                                void *p_arg)
+{
+    (void)p_drv;
+    if (callback_type == AM_UART_CALLBACK_TXCHAR_GET) {
+        __g_txchar_get = (am_uart_txchar_get_t)pfn_callback;
+        __g_txchar_arg = p_arg;
+    }
+
+    return AM_OK;
+}
+
+static int __uart_poll_getchar (void *p_drv, char *p_inchar)
+{
+    (void)p_drv;
+    (void)p_inchar;
+
+    return -AM_EAGAIN;
+}
+
+static int __uart_poll_putchar (void *p_drv, char outchar)
+{
+    (void)p_drv;
+    (void)outchar;
+
+    return AM_OK;
+}
+
+static struct am_uart_drv_funcs __g_uart_funcs = {
+    __uart_ioctl,
+    __uart_tx_startup,
+    __uart_callback_set,
+    __uart_poll_getchar,
+    __uart_poll_putchar,
+};
+
+static am_uart_serv_t __g_uart = {&__g_uart_funcs, NULL};
+
+/* the kick timer and the UART interrupt, until the ring is empty */
+static void __drain (void)
+{
+    __g_out_len = 0;
+    for (;;) {
+        __g_kick(__g_kick_arg);
+        if (!__g_tx_on) {
+            break;
+        }
+        while (__g_tx_on) {
+            __uart_byte();
+        }
+    }
+}
+
+/* am_kprintf() output that drops the characters */
+static int __null_fputc (const char c, void *p_fil)
+{
+    (void)c;
+    (void)p_fil;
+
+    return 1;
+}
+
+static int __null_fputs (const char *p_s, void *p_fil)
+{
+    (void)p_fil;
+
+    return (int)strlen(p_s);
+}
+
+/*******************************************************************************
+  frame check
+*******************************************************************************/
+
+static uint32_t __u32_get (const uint8_t *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/* every call of the batch used args[k] = i * 16 + k and the same format */
+static void __frames_check (const char *p_fmt,
+                            int         nargs,
+                            am_bool_t   ts,
+                            uint32_t    ts0)
+{
+    size_t  pos = 0;
+    size_t  len;
+    uint8_t sum;
+    int     i, k;
+
+    if (__g_out_len > sizeof(__g_out)) {
+        printf("%d args: output overflow\n", nargs);
+        __g_errs++;
+        return;
+    }
+
+    for (i = 0; i < __BENCH_BATCH; i++) {
+        const uint8_t *p = &__g_out[pos];
+
+        len = 2 + 4 + (ts ? 4 : 0) + 4 * nargs + 1;
+        if (pos + len > __g_out_len) {
+            printf("%d args: %d of %d frames\n", nargs, i, __BENCH_BATCH);
+            __g_errs++;
+            return;
+        }
+        for (sum = 0, k = 0; k < (int)len - 1; k++) {
+            sum += p[k];
+        }
+        if ((p[0] != 0xA5) ||
+            (p[1] != (nargs | (ts ? 0x10 : 0))) ||
+            (__u32_get(p + 2) != (uint32_t)(uintptr_t)p_fmt) ||
+            (ts && (__u32_get(p + 6) != ts0 + i)) ||
+            (sum != p[len - 1])) {
+            printf("%d args: frame %d header\n", nargs, i);
+            __g_errs++;
+            return;
+        }
+        for (k = 0; k < nargs; k++) {
+            if (__u32_get(p + len - 1 - 4 * (nargs - k)) !=
+                (uint32_t)(i * 16 + k)) {
+                printf("%d args: frame %d arg %d\n", nargs, i, k);
+                __g_errs++;
+                return;
+            }
+        }
+        pos += len;
+    }
+    if (pos != __g_out_len) {
+        printf("%d args: %u extra bytes\n", nargs, (unsigned)(__g_out_len - pos));
+        __g_errs++;
+    }
+}
+
+/*******************************************************************************
+  benchmark
+*******************************************************************************/
+
+static double __ns_get (void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static uint64_t __tsc_get (void)
+{
+#if __BENCH_TSC
+    return __builtin_ia32_rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static const char __g_fmt[7][32] = {
+    "tick\n",
+    "adc %d\n",
+    "adc ch%d = %d\n",
+    "%d %d %d\n",
+    "%d %d %d %d\n",
+    "%d %d %d %d %d\n",
+    "%d %d %d %d %d %d\n",
+};
+
+/* one batch of the macro with nargs arguments */
+static void __batch (int nargs)
+{
+    const char *p_fmt = __g_fmt[nargs];
+    uint32_t    i;
+
+    switch (nargs) {
+
+    case 0:
+        for (i = 0; i < __BENCH_BATCH; i++) {
+            AM_TRACE0(p_fmt);
+        }
+        break;
+
+    case 1:
+        for (i = 0; i < __BENCH_BATCH; i++) {
+            AM_TRACE1(p_fmt, i * 16);
+        }
+        break;
+
+    case 2:
+        for (i = 0; i < __BENCH_BATCH; i++) {
+            AM_TRACE2(p_fmt, i * 16, i * 16 + 1);
+        }
+        break;
+
+    case 3:
+        for (i = 0; i < __BENCH_BATCH; i++) {
+            AM_TRACE3(p_fmt, i * 16, i * 16 + 1, i * 16 + 2);
+        }
+        break;
+
+    case 4:
+        for (i = 0; i < __BENCH_BATCH; i++) {
+            AM_TRACE4(p_fmt, i * 16, i * 16 + 1, i * 16 + 2, i * 16 + 3);
+        }
+        break;
+
+    case 5:
+        for (i = 0; i < __BENCH_BATCH; i++) {
+            AM_TRACE5(p_fmt, i * 16, i * 16 + 1, i * 16 + 2, i * 16 + 3,
+                      i * 16 + 4);
+        }
+        break;
+
+    default:
+        for (i = 0; i < __BENCH_BATCH; i++) {
+            AM_TRACE6(p_fmt, i * 16, i * 16 + 1, i * 16 + 2, i * 16 + 3,
+                      i * 16 + 4, i * 16 + 5);
+        }
+        break;
+    }
+}
+
+static void __bench (am_bool_t ts, int rounds)
+{
+    double   t0, t, best_ns;
+    uint64_t c0, c, best_cyc;
+    uint32_t ts0;
+    int      nargs, r;
+
+    am_trace_init(&__g_uart, __g_ring, __BENCH_RING_SIZE,
+                  ts ? __ts_get : NULL);
+
+    printf("%s timestamp:\n", ts ? "with" : "without");
+    for (nargs = 0; nargs <= 6; nargs++) {
+        best_ns  = 1e30;
+        best_cyc = ~0ull;
+        for (r = 0; r < rounds; r++) {
+            ts0 = __g_ts;
+            t0  = __ns_get();
+            c0  = __tsc_get();
+            __batch(nargs);
+            c   = __tsc_get() - c0;
+            t   = __ns_get() - t0;
+            if (t < best_ns) {
+                best_ns = t;
+            }
+            if (c < best_cyc) {
+                best_cyc = c;
+            }
+            __drain();
+            __frames_check(__g_fmt[nargs], nargs, ts, ts0);
+        }
+        printf("  AM_TRACE%d %6.1f ns", nargs, best_ns / __BENCH_BATCH);
+        if (__BENCH_TSC) {
+            printf(" %6.1f cycles", (double)best_cyc / __BENCH_BATCH);
+        }
+        printf(", %2d bytes on the wire\n",
+               2 + 4 + (ts ? 4 : 0) + 4 * nargs + 1);
+    }
+}
+
+static void __kprintf_bench (int rounds)
+{
+    double   t0, t, best_ns = 1e30;
+    uint64_t c0, c, best_cyc = ~0ull;
+    int      len = 0;
+    int      i, r;
+
+    am_koutput_set(NULL, __null_fputc, __null_fputs);
+
+    for (r = 0; r < rounds; r++) {
+        t0 = __ns_get();
+        c0 = __tsc_get();
+        for (i = 0; i < __BENCH_BATCH; i++) {
+            len = am_kprintf(__g_fmt[2], i * 16, i * 16 + 1);
+        }
+        c = __tsc_get() - c0;
+        t = __ns_get() - t0;
+        if (t < best_ns) {
+            best_ns = t;
+        }
+        if (c < best_cyc) {
+            best_cyc = c;
+        }
+    }
+
+    printf("am_kprintf (same line as AM_TRACE2, format only):\n");
+    printf("  %6.1f ns", best_ns / __BENCH_BATCH);
+    if (__BENCH_TSC) {
+        printf(" %6.1f cycles", (double)best_cyc / __BENCH_BATCH);
+    }
+    printf(", then %d bytes polled out, %.0f us at 115200 baud\n",
+           len, len * 10 * 1e6 / 115200);
+}
+
+int main (int argc, char **argv)
+{
+    int      rounds = (argc > 1) ? atoi(argv[1]) : 200;
+    uint32_t args[AM_TRACE_ARGS_MAX + 1] = {0};
+
+    if (rounds < 1) {
+        rounds = 1;
+    }
+
+    printf("AM_TRACE_ARGS_MAX=%d, %d calls per batch, best of %d\n",
+           AM_TRACE_ARGS_MAX, __BENCH_BATCH, rounds);
+    __bench(AM_FALSE, rounds);
+    __bench(AM_TRUE, rounds);
+    __kprintf_bench(rounds);
+
+    if (am_trace_write(__g_fmt[0], args, AM_TRACE_ARGS_MAX + 1) !=
+        -AM_EINVAL) {
+        printf("%d arguments accepted\n", AM_TRACE_ARGS_MAX + 1);
+        __g_errs++;
+    }
+
+    printf("errs=%lu\n", __g_errs);
+
+    return __g_errs ? 1 : 0;
+}
+
+/* end of file */
@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+"""Decode an am_trace binary stream using the format strings in an ELF file.
+
+The stream is the raw data received from the trace UART, the ELF file is the
+image running on the target (its format strings are looked up by address).
+Frames with a bad checksum are skipped until the next valid frame.
+
+usage:
+    python3 am_trace_decode.py firmware.axf capture.bin > trace.txt
+
+modification history:
+- 1.00 26-10-18  agent, first implementation
+"""
+import re, struct, sys
+
+class Elf:
+    def __init__(self, path):
+        d = open(path, 'rb').read()
+        assert d[:4] == b'\x7fELF'
+        is64 = d[4] == 2
+        e = '<'
+        if is64:
+            shoff, = struct.unpack_from(e + 'Q', d, 0x28)
+            shentsize, shnum = struct.unpack_from(e + 'HH', d, 0x3A)
+        else:
+            shoff, = struct.unpack_from(e + 'I', d, 0x20)
+            shentsize, shnum = struct.unpack_from(e + 'HH', d, 0x2E)
+        self.secs = []
+        for i in range(shnum):
+            o = shoff + i * shentsize
+            if is64:
+                _, typ, _, addr, off, size = struct.unpack_from(e + 'IIQQQQ', d, o)
+            else:
+                _, typ, _, addr, off, size = struct.unpack_from(e + 'IIIIII', d, o)
+            if typ == 1 and addr:          # SHT_PROGBITS with an address
+                self.secs.append((addr, size, d[off:off + size]))
+
+    def string(self, addr):
+        for a, n, data in self.secs:
+            if a <= addr < a + n:
+                s = data[addr - a:]
+                return s[:s.index(b'\0')].decode('latin-1')
+        return None
+
+SPEC = re.compile(r'%([-+ #0]*)(\d*)(?:\.(\d+))?(?:hh|h|ll|l|z|j|t)?([diouxXcsp%])')
+
+def render(elf, fmt, args):
+    it = iter(args)
+    def sub(m):
+        flags, width, prec, conv = m.groups()
+        if conv == '%':
+            return '%'
+        v = next(it, 0)
+        spec = '%' + flags + width + ('.' + prec if prec else '')
+        if conv in 'di':
+            return (spec + 'd') % (v - (1 << 32) if v & 0x80000000 else v)
+        if conv == 'u':
+            return (spec + 'd') % v
+        if conv == 'c':
+            return (spec + 'c') % chr(v & 0xFF)
+        if conv == 's':
+            s = elf.string(v)
+            return (spec + 's') % (s if s is not None else '<0x%08x>' % v)
+        if conv == 'p':
+            return (spec + 's') % ('0x%08x' % v)
+        return (spec + conv) % v
+    return SPEC.sub(sub, fmt)
+
+def frames(data):
+    i, bad = 0, 0
+    while i + 3 <= len(data):
+        if data[i] != 0xA5:
+            i += 1; bad += 1; continue
+        info = data[i + 1]
+        n = info & 0x0F
+        ts = 1 if info & 0x10 else 0
+        ln = 2 + 4 + 4 * ts + 4 * n + 1
+        if (info & 0xE0) or i + ln > len(data) or sum(data[i:i + ln - 1]) & 0xFF != data[i + ln - 1]:
+            i += 1; bad += 1; continue
+        words = struct.unpack_from('<%dI' % (1 + ts + n), data, i + 2)
+        yield words[0], (words[1] if ts else None), list(words[1 + ts:])
+        i += ln
+    if bad:
+        sys.stderr.write('skipped %d bytes while resynchronising\n' % bad)
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit('usage: am_trace_decode.py <elf> <stream.bin>')
+    elf = Elf(sys.argv[1])
+    out = sys.stdout
+    for fmt, ts, args in frames(open(sys.argv[2], 'rb').read()):
+        if fmt == 0:
+            out.write('<%u records lost>\n' % args[0])
+            continue
+        s = elf.string(fmt)
+        if s is None:
+            s = '<unknown format 0x%08x>' % fmt + ' %u' * len(args) + '\n'
+        if ts is not None:
+            out.write('[%10u] ' % ts)
+        out.write(render(elf, s, args))
+
+if __name__ == '__main__':
+    main()
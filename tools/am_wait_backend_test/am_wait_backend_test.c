@@ -0,0 +1,331 @@
+/*******************************************************************************
+*                                 AMetal
+*                       ----------------------------
+*                       innovating embedded platform
+*
+* Copyright (c) 2001-2018 Guangzhou ZHIYUAN Electronics Co., Ltd.
+* All rights reserved.
+*
+* Contact information:
+* web site:    http://www.zlg.cn/
+*******************************************************************************/
+
+/**
+ * \file
+ * \brief host test of the am_wait backends (host program)
+ *
+ * Interrupts are modelled with threads: am_int_cpu_lock() takes a global
+ * mutex, and an "interrupt" thread takes the same mutex around its work, so
+ * it cannot run while the waiter has interrupts locked. A tick thread calls
+ * am_softimer_module_tick() every millisecond the same way.
+ *
+ * The sleep backend is built on a condition variable, which is how a host
+ * or OS port would use the wake hook: pfn_sleep waits on the condition
+ * (releasing the interrupt lock like WFI with PRIMASK set wakes on a pending
+ * interrupt), pfn_wake signals it. The tests are:
+ *  - busy wait (no backend): am_wait_done() from the interrupt thread;
+ *  - poll backend with am_wait_poll_jobq(): the interrupt thread posts a job
+ *    that calls am_wait_done(), the waiter runs it from pfn_poll;
+ *  - sleep/wake backend: many waits completed at random moments by the
+ *    interrupt thread. A wakeup lost between the check and the sleep would
+ *    hang the waiter, which the watchdog reports;
+ *  - sleep/wake backend with am_wait_on_timeout(): completed and expired
+ *    waits, the expiry wakes the sleeper from the softimer callback.
+ *
+ * build (from the root of the repository):
+ * \code
+ * gcc -std=gnu99 -O2 -pthread -Iinterface -Isoc/zlg/zlg217               \
+ *     tools/am_wait_backend_test/am_wait_backend_test.c                  \
+ *     components/util/source/am_wait.c                                   \
+ *     components/util/source/am_softimer.c                               \
+ *     components/util/source/am_jobq.c -o am_wait_backend_test
+ * ./am_wait_backend_test [waits]
+ * \endcode
+ *
+ * The exit status is 0 if no error is found.
+ *
+ * \internal
+ * \par modification history:
+ * - 1.00 26-10-18  agent, first implementation
+ * \endinternal
+ */
+
+#include "am_wait.h"
+#include "am_jobq.h"
+#include "am_int.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+
+/*******************************************************************************
+  interrupt model
+*******************************************************************************/
+
+static pthread_mutex_t  __g_int_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t   __g_int_cond  = PTHREAD_COND_INITIALIZER;
+static pthread_t        __g_int_owner;
+static int              __g_int_depth = 0;
+
+/* the lock nests like the real one */
+uint32_t am_int_cpu_lock (void)
+{
+    if ((__g_int_depth > 0) && pthread_equal(__g_int_owner, pthread_self())) {
+        __g_int_depth++;
+    } else {
+        pthread_mutex_lock(&__g_int_mutex);
+        __g_int_owner = pthread_self();
+        __g_int_depth = 1;
+    }
+    return 0;
+}
+
+void am_int_cpu_unlock (uint32_t key)
+{
+    (void)key;
+
+    if (--__g_int_depth == 0) {
+        pthread_mutex_unlock(&__g_int_mutex);
+    }
+}
+
+/*******************************************************************************
+  backends
+*******************************************************************************/
+
+static volatile unsigned long __g_polls;
+static volatile unsigned long __g_sleeps;
+static volatile unsigned long __g_wakes;
+
+/* sleep with the interrupt lock held, an "interrupt" ends the sleep */
+static void __cond_sleep (void *p_arg)
+{
+    int depth = __g_int_depth;
+
+    (void)p_arg;
+
+    if (depth != 1) {
+        printf("sleep with nested lock (depth %d)\n", depth);
+        exit(1);
+    }
+
+    __g_sleeps++;
+    __g_int_depth = 0;
+    pthread_cond_wait(&__g_int_cond, &__g_int_mutex);
+    __g_int_owner = pthread_self();
+    __g_int_depth = depth;
+}
+
+static void __cond_wake (void *p_arg)
+{
+    (void)p_arg;
+
+    __g_wakes++;
+    pthread_cond_broadcast(&__g_int_cond);
+}
+
+static int __count_poll (void *p_arg)
+{
+    __g_polls++;
+    return am_wait_poll_jobq(p_arg);
+}
+
+AM_JOBQ_QUEUE_DECL_STATIC(__g_jobq, 4);
+
+static am_wait_backend_t __g_poll_backend  = {__count_poll, NULL, NULL, NULL};
+
+static const am_wait_backend_t __g_sleep_backend = {
+    NULL,
+    __cond_sleep,
+    __cond_wake,
+    NULL
+};
+
+/*******************************************************************************
+  interrupt and tick threads
+*******************************************************************************/
+
+static am_wait_t      __g_wait;
+static am_jobq_job_t  __g_job;
+
+static volatile int   __g_req;         /* 1: done, 2: post job, 3: exit */
+static volatile int   __g_stop;
+
+static void __job_func (void *p_arg)
+{
+    am_wait_done((am_wait_t *)p_arg);
+}
+
+/* random short delay, sometimes none, so done lands anywhere in the wait */
+static void __jitter (unsigned *p_seed)
+{
+    volatile int n = rand_r(p_seed) % 2000;
+
+    if (n < 300) {
+        return;
+    }
+    if (n < 400) {
+        sched_yield();
+    }
+    while (n-- > 0) {
+    }
+}
+
+static void *__int_thread (void *p_arg)
+{
+    unsigned seed = 1;
+
+    (void)p_arg;
+
+    for (;;) {
+        while (__g_req == 0) {
+            sched_yield();
+        }
+        if (__g_req == 3) {
+            return NULL;
+        }
+
+        __jitter(&seed);
+
+        am_int_cpu_lock();
+        if (__g_req == 1) {
+            am_wait_done(&__g_wait);
+        } else {
+            am_jobq_post(&__g_jobq.jobq_queue, &__g_job);
+        }
+        __g_req = 0;
+        am_int_cpu_unlock(0);
+    }
+}
+
+static void *__tick_thread (void *p_arg)
+{
+    (void)p_arg;
+
+    while (!__g_stop) {
+        usleep(1000);
+        am_int_cpu_lock();
+        am_softimer_module_tick();
+        am_int_cpu_unlock(0);
+    }
+    return NULL;
+}
+
+static void __watchdog (int sig)
+{
+    (void)sig;
+
+    printf("timeout: a waiter did not wake up (sleeps %lu, wakes %lu)\n",
+           __g_sleeps, __g_wakes);
+    _exit(2);
+}
+
+/*******************************************************************************
+  tests
+*******************************************************************************/
+
+static int __g_errs = 0;
+
+/* request the interrupt thread to act and wait for it */
+static int __wait_for (int req, uint32_t timeout_ms)
+{
+    __g_req = req;
+    return timeout_ms ? am_wait_on_timeout(&__g_wait, timeout_ms) :
+                        am_wait_on(&__g_wait);
+}
+
+static void __drain (void)
+{
+    while (__g_req != 0) {
+        sched_yield();
+    }
+}
+
+int main (int argc, char **argv)
+{
+    long      waits = (argc > 1) ? atol(argv[1]) : 100000;
+    long      i;
+    int       ret, expired = 0;
+    pthread_t int_th, tick_th;
+
+    signal(SIGALRM, __watchdog);
+
+    am_softimer_module_init(1000);
+    AM_JOBQ_QUEUE_INIT(__g_jobq);
+    am_jobq_job_init(&__g_job, __job_func, &__g_wait, 0);
+    am_wait_init(&__g_wait);
+    __g_poll_backend.p_arg = &__g_jobq.jobq_queue;
+
+    pthread_create(&int_th, NULL, __int_thread, NULL);
+    pthread_create(&tick_th, NULL, __tick_thread, NULL);
+
+    /* busy wait */
+    alarm(30);
+    am_wait_backend_set(NULL);
+    for (i = 0; i < waits / 10; i++) {
+        if (__wait_for(1, 0) != AM_OK) {
+            __g_errs++;
+        }
+        __drain();
+    }
+    printf("busy wait:  %ld waits\n", i);
+
+    /* poll backend, completion comes from a job run by pfn_poll */
+    alarm(30);
+    am_wait_backend_set(&__g_poll_backend);
+    for (i = 0; i < waits / 10; i++) {
+        if (__wait_for(2, 0) != AM_OK) {
+            __g_errs++;
+        }
+        __drain();
+    }
+    printf("jobq poll:  %ld waits, %lu polls\n", i, __g_polls);
+
+    /* sleep/wake backend */
+    alarm(60);
+    am_wait_backend_set(&__g_sleep_backend);
+    for (i = 0; i < waits; i++) {
+        if (__wait_for(1, 0) != AM_OK) {
+            __g_errs++;
+        }
+        __drain();
+    }
+    printf("sleep/wake: %ld waits, %lu sleeps, %lu wakes\n",
+           i, __g_sleeps, __g_wakes);
+
+    /* sleep/wake backend with timeouts */
+    alarm(60);
+    for (i = 0; i < 200; i++) {
+        if (i % 2) {
+            ret = __wait_for(1, 1000);
+            if (ret != AM_OK) {
+                printf("wait %ld: %d, expected AM_OK\n", i, ret);
+                __g_errs++;
+            }
+            __drain();
+        } else {
+            ret = am_wait_on_timeout(&__g_wait, 2);
+            if (ret == -AM_ETIME) {
+                expired++;
+            } else {
+                printf("wait %ld: %d, expected -AM_ETIME\n", i, ret);
+                __g_errs++;
+            }
+        }
+    }
+    printf("timeouts:   %ld waits, %d expired\n", i, expired);
+
+    alarm(0);
+    __g_req  = 3;
+    __g_stop = 1;
+    pthread_join(int_th, NULL);
+    pthread_join(tick_th, NULL);
+
+    printf("errs=%d\n", __g_errs);
+
+    return __g_errs ? 1 : 0;
+}
+
+/* end of file */